@@ -0,0 +1,82 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _ASYNC_TEXTURE_LOADER_H_
+#define _ASYNC_TEXTURE_LOADER_H_
+
+#include <string>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "Image.h"
+#include "CompressedTextureCache.h"
+
+namespace sgct_core
+{
+
+/*!
+    Decodes texture files on a worker thread. Requests are handled in order and at most maxPending decoded
+    textures wait for the render thread, which bounds the memory used by textures in flight.
+*/
+class AsyncTextureLoader
+{
+public:
+    struct Request
+    {
+        std::string mName;
+        std::string mPath;
+        int mMipmapLevels;
+        std::string mCacheDirectory; //empty if the compressed texture cache isn't used
+    };
+
+    struct Result
+    {
+        Result();
+        ~Result();
+
+        Request mRequest;
+        bool mSuccess;
+        bool mCompressed;
+        Image * mImagePtr;
+        CompressedTexture mCompressedTexture;
+
+    private:
+        Result(const Result & r) = delete;
+        const Result & operator=(const Result & rhs) = delete;
+    };
+
+    AsyncTextureLoader(std::size_t maxPending = 2);
+    ~AsyncTextureLoader();
+
+    void request(const Request & req);
+    void cancel(const std::string & name);
+    void stop();
+    Result * popResult();
+    bool isIdle();
+
+private:
+    void work();
+
+    AsyncTextureLoader(const AsyncTextureLoader & atl) = delete;
+    const AsyncTextureLoader & operator=(const AsyncTextureLoader & rhs) = delete;
+
+private:
+    std::size_t mMaxPending;
+    std::thread * mThreadPtr;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<Request> mRequests;
+    std::deque<Result *> mResults;
+    std::string mActiveName;
+    bool mRunning;
+};
+
+}
+
+#endif
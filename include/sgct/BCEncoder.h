@@ -0,0 +1,47 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _BC_ENCODER_H_
+#define _BC_ENCODER_H_
+
+#include <cstddef>
+
+namespace sgct_core
+{
+
+/*!
+    CPU encoder for the block compressed texture formats. Each 4x4 block is fitted along the principal axis
+    of its colors followed by one least squares refinement (BC1), alpha and single channel blocks use the
+    channel range. Images are encoded in memory order so the result can be uploaded like the uncompressed data.
+
+    - BC1 (DXT1): RGB, 8 bytes per block
+    - BC3 (DXT5): RGBA, 16 bytes per block
+    - BC4 (RGTC1): R, 8 bytes per block
+    - BC5 (RGTC2): RG, 16 bytes per block
+*/
+class BCEncoder
+{
+public:
+    enum Format { BC1 = 0, BC3, BC4, BC5 };
+
+    static Format getFormatForChannels(std::size_t channels);
+    static std::size_t getBlockSize(Format format);
+    static std::size_t getCompressedSize(Format format, std::size_t width, std::size_t height);
+    static bool encode(Format format, const unsigned char * src, std::size_t width, std::size_t height, std::size_t channels,
+        bool isBGR, unsigned char * dst, std::size_t numberOfThreads = 0);
+
+    static void encodeBC1Block(const unsigned char * rgb, unsigned char * dst);
+    static void encodeChannelBlock(const unsigned char * values, unsigned char * dst);
+
+private:
+    static void encodeRows(Format format, const unsigned char * src, std::size_t width, std::size_t height, std::size_t channels,
+        bool isBGR, unsigned char * dst, std::size_t firstBlockRow, std::size_t lastBlockRow);
+};
+
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _CAPTURE_STREAM_H_
+#define _CAPTURE_STREAM_H_
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <stdio.h>
+
+#include "SGCTNetwork.h" //SGCT_SOCKET
+
+namespace sgct_core
+{
+
+/*!
+    Sequential sink for captured frames. Frames are converted to I420 and written as one YUV4MPEG2 (Y4M) stream
+    instead of one image file per frame. The target can be:
+    - a file or an existing named pipe (for instance a fifo read by ffmpeg)
+    - "unix:<path>" a local socket (not on Windows)
+    - "tcp:<port>" a socket on the loopback interface
+
+    On sockets the Y4M stream header and each frame are sent as separate messages, each prefixed with its size as
+    a 32-bit little endian integer. The consumer must be listening before the capture starts.
+
+    Frames are converted in parallel on the capture threads. Each frame reserves a sequence number on the render
+    thread, and the writes are serialized in that order, so the stream is always in frame order.
+*/
+class CaptureStream
+{
+public:
+    enum TargetType { FILE_TARGET = 0, UNIX_SOCKET_TARGET, TCP_SOCKET_TARGET };
+
+    CaptureStream();
+    ~CaptureStream();
+
+    bool open(const std::string & target, int width, int height, int frameRate, const std::string & comment = std::string());
+    void close();
+    bool isOpen();
+
+    unsigned long long reserveFrame();
+    void writeFrame(unsigned long long sequence, const unsigned char * data, std::size_t channels, bool isBGR, bool flipVertical,
+        std::vector<unsigned char> & buffer);
+    void skipFrame(unsigned long long sequence);
+
+    unsigned long long getWrittenFrames();
+    unsigned long long getDroppedFrames();
+    inline int getWidth() const { return mWidth; }
+    inline int getHeight() const { return mHeight; }
+
+    static TargetType getTargetType(const std::string & target);
+
+private:
+    bool write(const unsigned char * data, std::size_t size);
+    bool openSocket(TargetType type, const std::string & address);
+    void closeTarget();
+    void waitForTurn(std::unique_lock<std::mutex> & lock, unsigned long long sequence);
+    void finishTurn();
+
+    CaptureStream(const CaptureStream & cs) = delete;
+    const CaptureStream & operator=(const CaptureStream & rhs) = delete;
+
+private:
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::string mTarget;
+    TargetType mType;
+    FILE * mFile;
+    SGCT_SOCKET mSocket;
+    bool mWinsockStarted; //WSAStartup succeeded and needs a matching WSACleanup, windows only
+    int mWidth;
+    int mHeight;
+    bool mOpen;
+    bool mFailed;
+    unsigned long long mNextReserved;
+    unsigned long long mNextWrite;
+    std::atomic<unsigned long long> mWrittenFrames; //read without the lock, which is held while writing
+    std::atomic<unsigned long long> mDroppedFrames;
+};
+
+}
+
+#endif
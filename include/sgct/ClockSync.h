@@ -0,0 +1,81 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _CLOCK_SYNC_H_
+#define _CLOCK_SYNC_H_
+
+#include <mutex>
+#include <cstddef>
+
+namespace sgct_core
+{
+
+/*!
+    Estimates the offset and drift of the local clock to the master clock from request/reply time stamps, like NTP.
+    A slave stamps a request when it is sent (t0) and the reply when it arrives (t3), the master stamps when it
+    received the request (t1) and sent the reply (t2). The offset of a sample is ((t1 - t0) + (t2 - t3)) / 2 with an
+    error of at most half its round trip time (t3 - t0) - (t2 - t1), so only the samples with the shortest round
+    trips of the latest ones are used. The drift is the slope of a line fitted to their offsets.
+
+    The class has no network dependencies and all functions may be called from any thread.
+*/
+class ClockSync
+{
+public:
+    struct Quality
+    {
+        bool mSynchronized; //true once enough samples have been received
+        double mOffset; //master time minus local time now, in seconds
+        double mDrift; //rate of change of the offset, 1e-6 is one ppm
+        double mRoundTripTime; //shortest round trip of the used samples, in seconds
+        double mJitter; //standard deviation of the used offsets around the fitted line, in seconds
+        double mErrorBound; //half the round trip time of the used samples plus the jitter, in seconds
+        std::size_t mNumberOfSamples;
+    };
+
+    ClockSync();
+
+    void addSample(double t0, double t1, double t2, double t3);
+    void reset();
+
+    double toMasterTime(double localTime);
+    Quality getQuality(double localTime);
+    std::size_t getNumberOfSamples();
+
+    static const std::size_t MaxSamples = 64;
+    static const std::size_t MinSamples = 4; //before the offset is used
+    static const double MaxDrift;
+
+private:
+    struct Sample
+    {
+        double mTime; //local time of the middle of the round trip
+        double mOffset;
+        double mRoundTripTime;
+    };
+
+    void estimate();
+
+    std::mutex mMutex;
+    Sample mSamples[MaxSamples];
+    std::size_t mNumberOfSamples; //ever added, the latest MaxSamples are kept
+
+    //offset(t) = mOffset + mDrift * (t - mReferenceTime)
+    bool mSynchronized;
+    double mReferenceTime;
+    double mOffset;
+    double mDrift;
+    double mRoundTripTime;
+    double mJitter;
+    std::size_t mUsedSamples;
+
+    double mLastMasterTime; //keeps toMasterTime from going backwards when the estimate changes
+};
+
+}
+
+#endif
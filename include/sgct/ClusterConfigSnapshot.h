@@ -0,0 +1,44 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _CLUSTER_CONFIG_SNAPSHOT_H_
+#define _CLUSTER_CONFIG_SNAPSHOT_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#ifndef SGCT_DONT_USE_EXTERNAL
+    #include <external/tinyxml2.h>
+#else
+    #include <tinyxml2.h>
+#endif
+
+namespace sgct_core
+{
+
+/*!
+    Compact binary form of a parsed cluster configuration that the master sends to the slaves.
+
+    The snapshot stores the configuration element tree with all names and values in a shared string table,
+    so the slaves get exactly what the master parsed without reading and tokenizing the xml file. Comments
+    and formatting are not stored which means that the hash only changes when the configuration does.
+
+    The snapshot starts with the SGCT version of the node that created it, nodes running another version
+    refuse it.
+*/
+class ClusterConfigSnapshot
+{
+public:
+    static bool encode(const tinyxml2::XMLDocument & xmlDoc, std::vector<char> & snapshot);
+    static bool decode(const char * data, std::size_t size, tinyxml2::XMLDocument & xmlDoc, std::string & errorMsg);
+    static unsigned long long hash(const std::vector<char> & snapshot);
+};
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _COMPRESSED_TEXTURE_CACHE_H_
+#define _COMPRESSED_TEXTURE_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "BCEncoder.h"
+
+namespace sgct_core
+{
+
+class Image;
+
+/*!
+    Block compressed texture with an optional mip chain, ready for glCompressedTexImage2D.
+*/
+class CompressedTexture
+{
+public:
+    CompressedTexture();
+
+    BCEncoder::Format mFormat;
+    std::size_t mWidth;
+    std::size_t mHeight;
+    std::size_t mChannels;
+    std::vector< std::vector<unsigned char> > mLevels;
+};
+
+/*!
+    On-disk cache of block compressed textures (*.sgctbc). Entries are keyed by the source path, its modification
+    time and size, the number of mip levels and the encoder version, so a changed source or setting results in a new
+    entry. The cache can be filled offline (see the sgct_texturecachebuilder tool) or on first load, and since entries
+    are published by renaming a complete temporary file the directory can be shared by all cluster nodes.
+*/
+class CompressedTextureCache
+{
+public:
+    static std::string getCacheFilename(const std::string & cacheDirectory, const std::string & source, int mipmapLevels);
+    static bool load(const std::string & cacheDirectory, const std::string & source, int mipmapLevels, CompressedTexture & texture);
+    static bool build(const std::string & cacheDirectory, const std::string & source, int mipmapLevels, CompressedTexture & texture);
+    static bool compress(Image & img, int mipmapLevels, CompressedTexture & texture);
+    static bool store(const std::string & cacheDirectory, const std::string & source, int mipmapLevels, const CompressedTexture & texture);
+};
+
+}
+
+#endif
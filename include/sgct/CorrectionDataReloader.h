@@ -0,0 +1,111 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _CORRECTION_DATA_RELOADER_H_
+#define _CORRECTION_DATA_RELOADER_H_
+
+#include "Viewport.h"
+#include "FileWatcher.h"
+#include <vector>
+#include <set>
+#include <mutex>
+#include <thread>
+
+namespace sgct
+{
+class SGCTWindow;
+}
+
+namespace sgct_core
+{
+
+class NetworkManager;
+class SGCTNetwork;
+
+/*!
+    Reloads warping meshes, blend masks, black level masks and overlays while the cluster is running.
+
+    The changed files are parsed on a background thread into a second copy of the data (Viewport::prepareReload),
+    so the render loop never waits for a parser. The new data replaces the old at a frame boundary and all nodes
+    switch on the same sync frame:
+
+    1. The master starts a reload when a watched file changes, when Engine::reloadCorrectionData is called on
+       any node, or when a slave asks for it. It sends a prepare message to all slaves.
+    2. Each node parses the files that changed since they were loaded (all files if the reload is forced) and
+       a slave sends a ready message to the master when done.
+    3. When all slaves are ready the master sends a commit message with a sync frame a few frames ahead. Each node
+       uploads the new data and releases the old right before rendering that frame.
+
+    Files are compared by modification time and size, so every node picks up its own copy of a file.
+*/
+class CorrectionDataReloader
+{
+public:
+    //! Reload messages on the sync connections, the value is the force flag or the sync frame of a commit
+    enum MessageType { RequestMessage = 0, PrepareMessage, ReadyMessage, CommitMessage };
+
+    CorrectionDataReloader();
+    ~CorrectionDataReloader();
+
+    void addViewport(Viewport * vpPtr, sgct::SGCTWindow * winPtr);
+    void setWatching(bool state);
+    void request(bool force);
+    bool update(NetworkManager * netPtr);
+    void stop();
+    void receiveMessage(int type, unsigned int generation, int value, int connectionId);
+
+    //! \returns true if a reload is in progress
+    bool isBusy();
+
+private:
+    enum State { Idle = 0, Preparing, Prepared, Committed };
+
+    struct Entry
+    {
+        Viewport * mViewportPtr;
+        sgct::SGCTWindow * mWindowPtr;
+        float mWindowAspectRatio;
+        glm::ivec2 mFramebufferResolution;
+    };
+
+    void startPreparing(bool force);
+    void joinWorker();
+    void work(bool force);
+    static bool isFrameReached(int frame, int targetFrame);
+
+    CorrectionDataReloader(const CorrectionDataReloader & cdr) = delete;
+    const CorrectionDataReloader & operator=(const CorrectionDataReloader & rhs) = delete;
+
+private:
+    std::vector<Entry> mEntries;
+    FileWatcher mWatcher;
+    std::thread * mWorkerPtr;
+    std::mutex mMutex;
+
+    State mState;
+    unsigned int mGeneration;
+    bool mRequested;
+    bool mForce;
+    std::size_t mNumberOfReloadedFiles;
+
+    //master
+    std::vector<SGCTNetwork *> mPendingConnections;
+    std::set<int> mReadyConnections;
+    int mFramesUntilApply;
+
+    //slave
+    bool mHasPrepare;
+    unsigned int mPrepareGeneration;
+    bool mPrepareForce;
+    bool mReadySent;
+    bool mHasCommit;
+    int mCommitFrame;
+};
+
+}
+
+#endif
@@ -9,6 +9,10 @@
 #define _CORRECTION_MESH_H_
 
 #include "ogl_headers.h"
+#include "CorrectionMeshCache.h"
+#include "CorrectionMeshLayout.h"
+#include "WarpLookupTable.h"
+#include <glm/glm.hpp>
 
 namespace sgct_core
 {
@@ -32,6 +36,7 @@ namespace sgct_core
         unsigned int mNumberOfVertices;
         unsigned int mNumberOfIndices;
         unsigned int mMeshData[3];
+        CorrectionMeshLayout mLayout;
     };
     
     class Viewport;
@@ -49,10 +54,20 @@ namespace sgct_core
         CorrectionMesh();
         ~CorrectionMesh();
         bool readAndGenerateMesh(std::string meshPath, Viewport * parent, MeshHint hint = NO_HINT);
+        bool parseMesh(const std::string & meshPath, Viewport * parent, MeshHint hint, float windowAspectRatio, const glm::ivec2 & framebufferResolution);
+        void uploadMesh(Viewport * parent);
+        void swap(CorrectionMesh & other);
         void render(const MeshType & mt);
         static MeshHint parseHint(const std::string & hintStr);
+
+        //! \returns true if the warp mesh is replaced by a lookup texture
+        inline bool hasLookupTexture() const { return mLookupTexture != GL_FALSE; }
+        inline unsigned int getLookupTexture() const { return mLookupTexture; }
         
     private:
+        CorrectionMesh(const CorrectionMesh & cm) = delete;
+        const CorrectionMesh & operator=(const CorrectionMesh & rhs) = delete;
+
         enum MeshFormat { NO_FMT = 0, DOMEPROJECTION_FMT, SCALEABLE_FMT, SCISS_FMT, SKYSKAN_FMT, PAULBOURKE_FMT, OBJ_FMT, MPCDI_FMT};
 
         bool readAndGenerateDomeProjectionMesh(const std::string & meshPath, Viewport * parent);
@@ -62,11 +77,16 @@ namespace sgct_core
         bool readAndGeneratePaulBourkeMesh(const std::string & meshPath, Viewport * parent);
         bool readAndGenerateOBJMesh(const std::string & meshPath, Viewport * parent);
         bool readAndGenerateMpcdiMesh(const std::string & meshPath, Viewport* parent);
-        bool readMeshBuffer(float* dest, unsigned int& idx, char* src,
-                            const size_t srcSize_bytes, const int readSize_bytes);
+        bool readCachedMesh(const std::string & cacheFilename, const std::string & meshPath, unsigned long long parameterHash);
+        unsigned long long getParameterHash(const std::string & meshPath, MeshFormat meshFmt, Viewport * parent);
+        void applyCacheProperties(Viewport * parent);
+        void fitFrustumToMesh(Viewport * parent);
+        bool decimateMesh();
+        bool bakeLookupTable(const std::string & meshPath, bool useCache, unsigned long long parameterHash, Viewport * parent);
         void setupSimpleMesh(CorrectionMeshGeometry * geomPtr, Viewport * parent);
         void setupMaskMesh(Viewport * parent, bool flip_x, bool flip_y);
         void createMesh(CorrectionMeshGeometry * geomPtr);
+        void createMesh(CorrectionMeshGeometry * geomPtr, const CorrectionMeshVertex * vertices, const unsigned int * indices);
         void exportMesh(const std::string & exportMeshPath);
         void cleanUp();
         inline void clamp(float & val, const float max, const float min);
@@ -77,6 +97,13 @@ namespace sgct_core
         unsigned int * mTempIndices;
         
         CorrectionMeshGeometry mGeometries[3];
+        CorrectionMeshCache::Properties mCacheProperties;
+        CorrectionMeshCache mCachedMesh;
+        float mWindowAspectRatio;
+        int mFramebufferResolution[2];
+        unsigned int mGridSize[2]; //columns and rows of meshes parsed as a regular grid, zero otherwise
+        WarpLookupTable mLookupTable; //baked by parseMesh and released when uploaded
+        unsigned int mLookupTexture;
     };
     
 } //sgct_core
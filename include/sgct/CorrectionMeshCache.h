@@ -0,0 +1,75 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _CORRECTION_MESH_CACHE_H_
+#define _CORRECTION_MESH_CACHE_H_
+
+#include <string>
+#include "MappedFile.h"
+
+namespace sgct_core
+{
+
+struct CorrectionMeshVertex;
+
+/*!
+    Compiled warp meshes (*.sgctmesh). An entry holds the vertices and indices exactly as they are uploaded by
+    CorrectionMesh (already transformed to the viewport), so loading it is a memory mapping and no parsing.
+
+    Entries are keyed by the source path and a hash of the parameters used to generate them (format, viewport
+    position and size, ...). The source size, modification time and content hash are stored in the entry, and an
+    entry is only used if the source is unchanged. Entries are written to a temporary file and renamed into place.
+*/
+class CorrectionMeshCache
+{
+public:
+    //! Side effects of a parser that must be repeated when the mesh is loaded from the cache
+    struct Properties
+    {
+        Properties();
+
+        unsigned int mGeometryType;
+        bool mHasViewPlane;
+        float mUserPosition[3];
+        float mFov[4]; //up, down, left, right
+        float mRotation[4]; //w, x, y, z
+        bool mFisheyeIgnoreAspect;
+    };
+
+    CorrectionMeshCache();
+    ~CorrectionMeshCache();
+
+    bool open(const std::string & filename, const std::string & source, unsigned long long parameterHash);
+    void close();
+    //! \returns true if a valid entry is mapped
+    inline bool isOpen() const { return mVertices != nullptr; }
+
+    inline const Properties & getProperties() const { return mProperties; }
+    inline const CorrectionMeshVertex * getVertices() const { return mVertices; }
+    inline const unsigned int * getIndices() const { return mIndices; }
+    inline unsigned int getNumberOfVertices() const { return mNumberOfVertices; }
+    inline unsigned int getNumberOfIndices() const { return mNumberOfIndices; }
+
+    static std::string getCacheFilename(const std::string & cacheDirectory, const std::string & source, unsigned long long parameterHash);
+    static bool store(const std::string & filename, const std::string & source, unsigned long long parameterHash, const Properties & properties,
+        const CorrectionMeshVertex * vertices, unsigned int numberOfVertices, const unsigned int * indices, unsigned int numberOfIndices);
+
+private:
+    CorrectionMeshCache(const CorrectionMeshCache & cmc) = delete;
+    const CorrectionMeshCache & operator=(const CorrectionMeshCache & rhs) = delete;
+
+    MappedFile mFile;
+    Properties mProperties;
+    const CorrectionMeshVertex * mVertices;
+    const unsigned int * mIndices;
+    unsigned int mNumberOfVertices;
+    unsigned int mNumberOfIndices;
+};
+
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _CORRECTION_MESH_DECIMATOR_H_
+#define _CORRECTION_MESH_DECIMATOR_H_
+
+#include "CorrectionMesh.h"
+#include <vector>
+#include <cstddef>
+
+namespace sgct_core
+{
+
+/*!
+    Error bounded simplification of warping meshes that are regular grids of columns x rows vertices in row
+    major order with two triangles per cell, which is what most calibration formats produce.
+
+    The grid is split recursively into rectangular blocks. A block is drawn with a few large triangles if the
+    positions and texture coordinates of all its vertices are within half the error of an affine map over the
+    block, measured in pixels of the framebuffer. Since any triangulation of the block vertices then stays within
+    the same band, the decimated mesh differs from the original by at most the error at each grid point.
+
+    - the mesh border and the borders of holes keep all their vertices
+    - blocks with different vertex colors (blend regions) keep the original cells
+    - vertices on the edge of a block that are used by a neighbouring block are included, so there are no cracks
+*/
+class CorrectionMeshDecimator
+{
+public:
+    struct ErrorReport
+    {
+        std::size_t mSamples;
+        std::size_t mUncoveredSamples;
+        double mMaxError;
+        double mMeanError;
+        double mP99Error;
+    };
+
+    static bool decimateGrid(const CorrectionMeshVertex * vertices, unsigned int columns, unsigned int rows,
+        const unsigned int * indices, unsigned int numberOfIndices, float maxError, int width, int height,
+        std::vector<CorrectionMeshVertex> & outVertices, std::vector<unsigned int> & outIndices);
+
+    static ErrorReport measureError(const CorrectionMeshVertex * vertices, unsigned int numberOfVertices,
+        const unsigned int * indices, unsigned int numberOfIndices,
+        const CorrectionMeshVertex * decimatedVertices, unsigned int numberOfDecimatedVertices,
+        const unsigned int * decimatedIndices, unsigned int numberOfDecimatedIndices, int width, int height);
+};
+
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _CORRECTION_MESH_LAYOUT_H_
+#define _CORRECTION_MESH_LAYOUT_H_
+
+#include <vector>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+namespace sgct_core
+{
+
+struct CorrectionMeshVertex;
+
+/*!
+    Compact vertex buffer layout of an uploaded correction mesh. CorrectionMeshVertex is 32 bytes, but the warp
+    pass rarely needs that much:
+
+    - positions in [-1, 1] are stored as normalized 16-bit integers and texture coordinates in [0, 1] as
+      normalized unsigned 16-bit integers if the rounding error stays below a quarter of a framebuffer pixel
+    - colors are stored as normalized bytes, or not at all if every vertex is white
+    - indices are 16-bit if there are fewer than 65536 vertices
+
+    The attributes are normalized by OpenGL so the shaders still get the same floats. A mesh with no color
+    stream is drawn with a constant white color. The smallest layout is 8 bytes per vertex.
+*/
+class CorrectionMeshLayout
+{
+public:
+    enum AttributeFormat { NoAttribute = 0, Float, Snorm16, Unorm16, Unorm8 };
+
+    CorrectionMeshLayout();
+
+    void choose(const CorrectionMeshVertex * vertices, unsigned int numberOfVertices, const glm::ivec2 & framebufferResolution,
+        bool allowNormalizedCoordinates);
+    void packVertices(const CorrectionMeshVertex * vertices, unsigned int numberOfVertices, std::vector<unsigned char> & buffer) const;
+    void packIndices(const unsigned int * indices, unsigned int numberOfIndices, std::vector<unsigned char> & buffer) const;
+
+    static unsigned int getAttributeSize(AttributeFormat format, unsigned int components);
+
+    AttributeFormat mPositionFormat;
+    AttributeFormat mTexCoordFormat;
+    AttributeFormat mColorFormat;
+    unsigned int mPositionOffset;
+    unsigned int mTexCoordOffset;
+    unsigned int mColorOffset;
+    unsigned int mStride;
+    unsigned int mIndexSize; //bytes per index, 2 or 4
+};
+
+}
+
+#endif
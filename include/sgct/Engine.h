@@ -18,6 +18,11 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #include "SphericalMirrorProjection.h"
 #include "SpoutOutputProjection.h"
 #include "Touch.h"
+#include "CorrectionDataReloader.h"
+#include "TimerQueue.h"
+#include "SharedDataTypes.h"
+#include "MetricsServer.h"
+#include "FrameRecording.h"
 
 #define MAX_UNIFORM_LOCATIONS 16
 #define NUMBER_OF_SHADERS 8
@@ -86,15 +91,26 @@ public:
     enum TextureIndexes { LeftEye = 0, RightEye, Intermediate, FX1, FX2, Depth, Normals, Positions };
     enum RenderTarget { WindowBuffer, NonLinearBuffer };
     enum ViewportTypes { MainViewport, SubViewport };
+    //! The different kinds of timers created by createTimer
+    enum TimerType
+    {
+        /// Runs only on the master and is checked at the end of every frame
+        Master_Timer = 0,
+        /// Scheduled by the master and fired in the same frame on every node with frame lock, see createTimer
+        Synchronized_Timer,
+        /// Runs on every node and is checked against the cluster clock at the end of every frame
+        Cluster_Clock_Timer
+    };
 
 private:
     enum SyncStage { PreStage = 0, PostStage };
     enum BufferMode { BackBuffer = 0, BackBufferBlack, RenderToTexture };
     enum ViewportSpace { ScreenSpace = 0, FBOSpace };
-    enum ShaderIndexes { FBOQuadShader = 0, FXAAShader, OverlayShader };
+    enum ShaderIndexes { FBOQuadShader = 0, FXAAShader, OverlayShader, WarpLookupShader };
     enum ShaderLocIndexes { MonoTex = 0,
             OverlayTex,
-            SizeX, SizeY, FXAA_SUBPIX_TRIM, FXAA_SUBPIX_OFFSET, FXAA_Texture };
+            SizeX, SizeY, FXAA_SUBPIX_TRIM, FXAA_SUBPIX_OFFSET, FXAA_Texture,
+            WarpLookupRect };
 
 public:
     Engine( int& argc, char**& argv );
@@ -169,6 +185,12 @@ public:
         -numberOfCaptureThreads command line argument.
     */
     void takeScreenshot() { mTakeScreenshot = true; }
+    void setTracing(bool state);
+    bool exportTrace(const std::string & filename, bool includeSlaves = true);
+    void setStatisticsFunction(sgct_cppxeleven::function<void(const sgct_core::Statistics::Report &)> fn);
+    void setStatisticsLogFile(const std::string & filename);
+    void setStatisticsWindow(std::size_t numberOfFrames, double reportInterval = 1.0);
+    sgct_core::Statistics::Report getStatisticsReport();
     void setScreenShotNumber(unsigned int number);
     unsigned int getScreenShotNumber();
     void invokeScreenShotCallback1(sgct_core::Image * imPtr, std::size_t winIndex, sgct_core::ScreenCapture::EyeIndex ei, unsigned int type);
@@ -177,6 +199,7 @@ public:
     void setScreenShotCallback(void(*fnPtr)(unsigned char *, std::size_t, sgct_core::ScreenCapture::EyeIndex, unsigned int type));
 
     std::size_t createTimer( double millisec, void(*fnPtr)(std::size_t) );
+    std::size_t createTimer( double millisec, void(*fnPtr)(std::size_t), TimerType type );
     void stopTimer(std::size_t id);
 
     //set callback functions
@@ -254,8 +277,14 @@ public:
     void invokeUpdateCallbackForDataTransfer(bool connected, int clientId);
     void invokeAcknowledgeCallbackForDataTransfer(int packageId, int clientId);
 
+    //warping mesh and mask reload functions
+    void reloadCorrectionData(bool force = false);
+    void invokeCorrectionDataReloadCallback(int type, unsigned int generation, int value, int clientId);
+
     //GLFW wrapped functions
     static double getTime();
+    static double getClusterTime();
+    static sgct_core::ClockSync::Quality getClusterClockQuality();
     static int getKey( std::size_t winIndex, int key );
     static int getMouseButton( std::size_t winIndex, int button );
     static void getMousePos( std::size_t winIndex, double * xPos, double * yPos );
@@ -395,11 +424,18 @@ private:
     bool initNetwork();
     bool initWindows();
     void initOGL();
+    void initSimulation();
+    void renderSimulation();
+    bool replayFrame();
+    bool readReplayCommand();
     void clean();
     void clearAllCallbacks();
 
     bool frameLock(SyncStage stage);
     void calculateFPS(double timestamp);
+    void applyStatisticsSettings();
+    void publishMetrics(double time);
+    std::string getNodeFilePath(const std::string & path);
     void parseArguments( int& argc, char**& argv );
     void renderDisplayInfo();
     void printNodeInfo(unsigned int nodeId);
@@ -410,6 +446,7 @@ private:
     void draw();
     void drawOverlays();
     void renderFBOTexture();
+    void renderViewportMesh(sgct_core::Viewport * vpPtr, sgct_core::CorrectionMesh::MeshType mt);
     void renderPostFX(TextureIndexes ti );
     void renderViewports(TextureIndexes ti);
     void render2D();
@@ -422,6 +459,10 @@ private:
     void prepareBuffer(TextureIndexes ti);
     void updateRenderingTargets(TextureIndexes ti);
     void updateTimers(double timeStamp);
+    void fireTimers(sgct_core::TimerQueue & timers, const std::vector<std::size_t> & ids);
+    void encodeSynchronizedTimers();
+    void decodeSynchronizedTimers();
+    void takeSynchronizedTimers();
     void loadShaders();
     void setAndClearBuffer(BufferMode mode);
     void waitForAllWindowsInSwapGroupToOpen();
@@ -527,11 +568,44 @@ private:
     sgct_core::ReadConfig        * mConfig;
     sgct_core::Statistics        * mStatistics;
     sgct_core::SGCTNode            * mThisNode;
+    sgct_core::CorrectionDataReloader * mCorrectionDataReloader;
 
     std::thread * mThreadPtr;
 
     std::string configFilename;
     std::string mLogfilePath;
+    std::string mTraceFilePath; //written on exit if set by -trace
+    std::string mStatsLogPath; //set by -statsLog
+    std::size_t mStatsWindow; //set by -statsWindow
+    double mStatsReportInterval;
+    sgct_cppxeleven::function<void(const sgct_core::Statistics::Report &)> mStatsReportFnPtr;
+    double mClockSyncTestDelays[3]; //set by -clockSyncDelay and -clockSyncJitter
+
+    //headless simulation of this node, set by --Simulate and the -sim arguments
+    bool mSimulation;
+    double mSimDrawTime;
+    unsigned int mSimFrames; //0 runs until terminated
+    unsigned int mSimStallInterval; //every n:th frame the draw stalls
+    double mSimStallDuration;
+    double mSimLatency; //of the sync connections
+    double mSimBandwidth; //bytes per second, 0 is unlimited
+
+    //health metrics served over http, set by -metricsPort
+    sgct_core::MetricsServer * mMetricsServer;
+    int mMetricsPort; //0 if disabled
+    double mMetricsPublishTime;
+    sgct_core::MetricsServer::Snapshot mMetricsSnapshot; //reused between publications
+
+    //recording of the sync stream on the master set by -record, and its replay set by -replay
+    sgct_core::FrameRecorder * mFrameRecorder;
+    sgct_core::FrameReplay * mFrameReplay;
+    std::string mRecordPath;
+    std::string mReplayPath;
+    unsigned int mReplayStartFrame;
+    bool mReplayStep; //wait for the console before every frame
+    unsigned long long mReplayFrames;
+    unsigned long long mReplayBytes;
+    double mReplayDecodeTime; //seconds in SharedData::decode
     int mRunning;
     bool mInitialized;
     std::string mAAInfo;
@@ -539,15 +613,16 @@ private:
     unsigned int mFrameCounter;
     unsigned int mShotCounter;
 
-    typedef struct  {
-        std::size_t mId;
-        double mLastFired;
-        double mInterval;
-        timerCallbackFn mCallback;
-    } TimerInformation;
-
-    std::vector<TimerInformation> mTimers; //< stores all active timers
+    sgct_core::TimerQueue mTimers; //< master timers
+    sgct_core::TimerQueue mSynchronizedTimers; //< scheduled by the master, kept on slaves for the callbacks
+    sgct_core::TimerQueue mClusterClockTimers;
     std::size_t mTimerID; //< the timer created next will use this ID
+    std::size_t mSynchronizedTimerID; //< numbered separately to get the same ids on every node
+    SharedVector<uint64_t> mFiredTimersSync; //< ids of the synchronized timers that fire in this sync frame
+    std::vector<std::size_t> mPendingTimers; //< synchronized timers of the sync frames not yet taken by the frame lock
+    std::vector<std::size_t> mFiredTimers; //< synchronized timers to fire at the end of the frame
+    std::vector<std::size_t> mExpiredTimers;
+    std::mutex mTimerMutex; //< decoding the sync frame adds to mPendingTimers from the network thread
 
     RunMode mRunMode;
     std::string mGLSLVersion;
@@ -0,0 +1,69 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _FILE_WATCHER_H_
+#define _FILE_WATCHER_H_
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+namespace sgct_core
+{
+
+/*!
+    Watches a set of files for changes on a background thread. On Linux the directories of the files are watched
+    with inotify, so files that are replaced by renaming a new version into place (which most editors and copy
+    tools do) are detected. Other platforms, and files in directories that can't be watched, for instance because
+    they don't exist yet, are polled by comparing the modification time and size of the files twice a second.
+
+    A change is reported once the files have been quiet for a short while, so a file that is written in several
+    steps only causes one reload.
+*/
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    void addFile(const std::string & path);
+    bool start();
+    void stop();
+    bool hasChanged();
+
+    //! \returns true if the watcher thread is running
+    inline bool isRunning() const { return mThreadPtr != nullptr; }
+
+private:
+    struct WatchedFile
+    {
+        std::string mPath;
+        std::string mDirectory;
+        std::string mName;
+        int mWatch; //the inotify watch of the directory, -1 if the file is polled
+        unsigned long long mTime;
+        unsigned long long mSize;
+    };
+
+    void work();
+    bool pollStamps();
+
+    FileWatcher(const FileWatcher & fw) = delete;
+    const FileWatcher & operator=(const FileWatcher & rhs) = delete;
+
+private:
+    std::vector<WatchedFile> mFiles;
+    std::thread * mThreadPtr;
+    std::atomic<bool> mRunning;
+    std::atomic<bool> mChanged;
+    int mNotifyFd;
+};
+
+}
+
+#endif
@@ -79,6 +79,8 @@ public:
     const signed long getStrokeSize() const;
     void setStrokeSize(signed long size);
 
+    static bool getPixelData(FT_Library lib, FT_Face face, FT_Fixed strokeSize, int & width, int & height, unsigned char ** pixels, GlyphData * gd);
+
 public:
 
     /*! Less then Font comparison operator */
@@ -93,8 +95,6 @@ private:
     void createCharacter(wchar_t c);
     bool createGlyph(wchar_t c, FontFaceData * FFDPtr);
     unsigned int generateTexture(int width, int height, unsigned char * data);
-
-    bool getPixelData(FT_Face face, int & width, int & height, unsigned char ** pixels, GlyphData * gd);
     
     std::string mName;                // Holds the font name
     float mHeight;                    // Holds the height of the font.
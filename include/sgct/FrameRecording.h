@@ -0,0 +1,178 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _FRAME_RECORDING_H_
+#define _FRAME_RECORDING_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <stdio.h>
+
+namespace sgct_core
+{
+
+/*!
+    A record of the sync stream as it was received by the slaves.
+*/
+struct FrameRecord
+{
+    enum Type { SyncFrame = 0, ExternalControl, DataTransfer };
+
+    Type mType;
+    unsigned int mFrame; //packages belong to the first sync frame encoded after they were received
+    double mTime; //the time of the master when recorded
+    int mPackageId; //data transfer only
+    int mClientId; //the connection the package was received on, -1 for sync frames
+    unsigned char * mData; //the data as passed to the decode callback, aligned like a new[] buffer and valid until the next read
+    std::size_t mSize;
+};
+
+/*!
+    Records the sync stream of the master to an append-only file for replay with FrameReplay. Every encoded shared
+    data frame is recorded as the slaves pass it to SharedData::decode, together with the external control and data
+    transfer packages in the order they arrived between the frames.
+
+    The records are collected in chunks of consecutive frames, which are compressed and written by a background
+    thread so that the render loop never waits for the disk. The file is:
+    - a header: "SGCTREC\0", the version and a reserved 32-bit field
+    - the chunks: a header with the first and last frame, the number of records and the compressed and uncompressed
+      size, followed by the zlib compressed records. Each record is a 32-byte header followed by its data, padded
+      to a multiple of 16 bytes so that the data is aligned when the chunk is decompressed
+    - on close, an index with the offset and frames of every chunk and a footer pointing at it
+
+    A file that wasn't closed, for instance after a crash, lacks the index but can still be replayed since the
+    reader rebuilds the index from the chunk headers. All values are in the byte order of the master.
+*/
+class FrameRecorder
+{
+public:
+    FrameRecorder();
+    ~FrameRecorder();
+
+    bool open(const std::string & path, int compressionLevel = 1);
+    void close();
+    bool isOpen();
+
+    void recordSyncFrame(unsigned int frame, double time, const unsigned char * data, std::size_t size);
+    void recordExternalControl(double time, const char * data, std::size_t size, int clientId);
+    void recordDataTransfer(double time, const void * data, std::size_t size, int packageId, int clientId);
+
+    unsigned long long getNumberOfFrames();
+    unsigned long long getWrittenBytes();
+
+private:
+    FrameRecorder(const FrameRecorder & rhs) = delete;
+    const FrameRecorder & operator=(const FrameRecorder & rhs) = delete;
+
+    struct Chunk
+    {
+        unsigned int mFirstFrame;
+        unsigned int mLastFrame;
+        unsigned int mRecords;
+        std::vector<unsigned char> mData;
+        std::size_t mFramesEnd; //the size and records up to the latest frame
+        unsigned int mFramesRecords;
+    };
+
+    struct IndexEntry
+    {
+        unsigned long long mOffset;
+        unsigned int mFirstFrame;
+        unsigned int mLastFrame;
+        unsigned int mRecords;
+    };
+
+    void append(FrameRecord::Type type, unsigned int frame, double time, int packageId, int clientId,
+        const void * data, std::size_t size);
+    void writeChunks();
+    bool writeChunk(Chunk & chunk, std::vector<unsigned char> & compressed);
+    bool writeIndex();
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::thread * mWriterThread;
+    bool mTerminate;
+
+    std::string mPath;
+    FILE * mFile;
+    int mCompressionLevel;
+    bool mOpen;
+    bool mFailed;
+
+    Chunk mCurrentChunk; //collecting records on the calling threads
+    std::deque<Chunk> mPendingChunks; //full chunks waiting for the writer thread
+    unsigned int mNextFrame;
+
+    //used by the writer thread only, until it has been joined
+    std::vector<IndexEntry> mIndex;
+    unsigned long long mOffset;
+
+    std::atomic<unsigned long long> mFrames;
+    std::atomic<unsigned long long> mWrittenBytes;
+};
+
+/*!
+    Reads a file written by FrameRecorder. The records are read in the order they were recorded, starting at any frame.
+    Seeking looks up the chunk of the frame in the index with a binary search and decompresses only that chunk.
+
+    The class is not thread safe.
+*/
+class FrameReplay
+{
+public:
+    FrameReplay();
+    ~FrameReplay();
+
+    bool open(const std::string & path);
+    void close();
+    inline bool isOpen() const { return mFile != nullptr; }
+
+    bool seek(unsigned int frame);
+    bool next(FrameRecord & record);
+
+    //! \returns the first recorded frame
+    unsigned int getFirstFrame() const { return mIndex.empty() ? 0 : mIndex.front().mFirstFrame; }
+    //! \returns the last recorded frame
+    unsigned int getLastFrame() const { return mIndex.empty() ? 0 : mIndex.back().mLastFrame; }
+    //! \returns the number of chunks in the file
+    std::size_t getNumberOfChunks() const { return mIndex.size(); }
+
+private:
+    FrameReplay(const FrameReplay & rhs) = delete;
+    const FrameReplay & operator=(const FrameReplay & rhs) = delete;
+
+    struct IndexEntry
+    {
+        unsigned long long mOffset;
+        unsigned int mFirstFrame;
+        unsigned int mLastFrame;
+        unsigned int mRecords;
+    };
+
+    bool readIndex();
+    bool rebuildIndex();
+    bool loadChunk(std::size_t chunk);
+
+    std::string mPath;
+    FILE * mFile;
+    unsigned long long mFileSize;
+    std::vector<IndexEntry> mIndex;
+
+    std::size_t mCurrentChunk; //the size of the index if no chunk is loaded
+    std::vector<unsigned char> mChunk;
+    std::vector<unsigned char> mCompressed;
+    std::size_t mPos;
+};
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _GPU_TIMER_H_
+#define _GPU_TIMER_H_
+
+#include "ogl_headers.h"
+#include <vector>
+#include <cstddef>
+
+namespace sgct_core
+{
+
+/*!
+    Measures the GPU time of the render passes with timestamp queries. The queries of a frame are read back when
+    the frame slot is reused a few frames later, so the CPU never waits for the GPU. If the results of a frame still
+    aren't available by then the frame is dropped instead.
+
+    The measured zones are added to the "GPU" track of the Tracer, with the times moved to the clock of
+    sgct::Engine::getTime, and the total of the latest measured frame is returned by getFrameTime.
+
+    Query objects aren't shared between OpenGL contexts, so zones are only measured while the context that was
+    current in init is current. The class is not thread safe and is used by the render thread only.
+*/
+class GPUTimer
+{
+public:
+    struct Zone
+    {
+        const char * mName;
+        int mArgument; //window, viewport or face index, -1 if none
+        double mStart; //seconds, in the clock of sgct::Engine::getTime
+        double mEnd;
+    };
+
+    /*! Get the GPUTimer instance */
+    static GPUTimer * instance()
+    {
+        if (mInstance == nullptr)
+            mInstance = new GPUTimer();
+        return mInstance;
+    }
+
+    /*! Destroy the GPUTimer */
+    static void destroy()
+    {
+        if (mInstance != nullptr)
+        {
+            delete mInstance;
+            mInstance = nullptr;
+        }
+    }
+
+    //! \returns true between beginFrame and endFrame, cheap enough to call for every zone
+    static inline bool isMeasuring() { return mMeasuring; }
+
+    bool init(std::size_t framesInFlight);
+    void deinit();
+    void beginFrame();
+    void endFrame();
+    int beginZone(const char * name, int argument);
+    void endZone(int zone);
+
+    //! \returns true if timestamp queries are supported and init has been called
+    bool isInitialized() const { return !mFrames.empty(); }
+    //! \returns the GPU time of the latest measured frame in seconds, -1 until the first frame is read back
+    double getFrameTime() const { return mFrameTime; }
+    //! \returns the zones of the latest measured frame, the first zone is the whole frame
+    const std::vector<Zone> & getZones() const { return mZones; }
+    //! \returns the number of frames that were dropped because their queries weren't done when the slot was reused
+    unsigned long long getNumberOfDroppedFrames() const { return mDroppedFrames; }
+
+private:
+    GPUTimer();
+    ~GPUTimer();
+
+    GPUTimer(const GPUTimer & rhs) = delete;
+    const GPUTimer & operator=(const GPUTimer & rhs) = delete;
+
+    struct PendingZone
+    {
+        const char * mName;
+        int mArgument;
+        std::size_t mBeginQuery;
+        std::size_t mEndQuery;
+    };
+
+    struct Frame
+    {
+        std::vector<GLuint> mQueries; //grows to the most queries used by a frame, never shrinks
+        std::size_t mUsedQueries;
+        std::vector<PendingZone> mZones;
+        double mTime; //cpu time when the frame began
+        GLint64 mTimestamp; //gpu time when the frame began
+    };
+
+    std::size_t issueQuery();
+    void readBack(Frame & frame);
+
+    static GPUTimer * mInstance;
+    static bool mMeasuring;
+
+    std::vector<Frame> mFrames;
+    std::size_t mCurrentFrame;
+    void * mContext; //the GLFW context owning the queries
+    std::vector<Zone> mZones;
+    double mFrameTime;
+    unsigned long long mDroppedFrames;
+};
+
+/*!
+    Measures the GPU time of the commands issued from construction to destruction if a frame is being measured.
+*/
+class GPUTraceZone
+{
+public:
+    explicit GPUTraceZone(const char * name, int argument = -1)
+        : mZone(GPUTimer::isMeasuring() ? GPUTimer::instance()->beginZone(name, argument) : -1) {}
+
+    ~GPUTraceZone()
+    {
+        if (mZone >= 0)
+            GPUTimer::instance()->endZone(mZone);
+    }
+
+private:
+    GPUTraceZone(const GPUTraceZone & rhs) = delete;
+    const GPUTraceZone & operator=(const GPUTraceZone & rhs) = delete;
+
+    int mZone;
+};
+
+}
+
+#endif
@@ -62,6 +62,28 @@ public:
     unsigned char getSampleAt(std::size_t x, std::size_t y, ChannelType c);
     void setSampleAt(unsigned char val, std::size_t x, std::size_t y, ChannelType c);
     float getInterpolatedSampleAt(float x, float y, ChannelType c);
+
+    //whole image pixel format conversions
+    void swapRedBlue();
+    bool addAlphaChannel(unsigned char alpha = 255);
+    bool removeAlphaChannel();
+    void flipVertical();
+    bool convertBytesPerChannel(std::size_t bpc);
+    bool premultiplyAlpha();
+    bool resample(std::size_t width, std::size_t height);
+
+    //raw pixel kernels (SSE2/AVX2/NEON if enabled by the compiler, scalar otherwise)
+    static void swapRedBlue(unsigned char * data, std::size_t pixels, std::size_t channels, std::size_t bpc = 1);
+    static void packRGBAToRGB(const unsigned char * src, unsigned char * dst, std::size_t pixels);
+    static void unpackRGBToRGBA(const unsigned char * src, unsigned char * dst, std::size_t pixels, unsigned char alpha = 255);
+    static void flipRows(unsigned char * data, std::size_t rowSize, std::size_t rows);
+    static void convert8To16(const unsigned char * src, unsigned short * dst, std::size_t count);
+    static void convert16To8(const unsigned short * src, unsigned char * dst, std::size_t count);
+    static void premultiplyAlpha(unsigned char * data, std::size_t pixels);
+    static void resampleBilinear(const unsigned char * src, std::size_t srcWidth, std::size_t srcHeight,
+        unsigned char * dst, std::size_t dstWidth, std::size_t dstHeight, std::size_t channels);
+    static void convertToI420(const unsigned char * src, std::size_t width, std::size_t height, std::size_t channels,
+        bool isBGR, bool flipVertical, unsigned char * dstY, unsigned char * dstU, unsigned char * dstV);
     
 
     void setDataPtr(unsigned char * dPtr);
@@ -78,6 +100,7 @@ private:
     bool decodeTGARLE(FILE * fp);
     bool decodeTGARLE(unsigned char * data, std::size_t len);
     std::size_t getTGAPackageLength(unsigned char * row, std::size_t pos, bool rle);
+    bool replaceData(unsigned char * data, std::size_t channels, std::size_t bpc, std::size_t width, std::size_t height);
     
 private:
     bool mExternalData;
@@ -0,0 +1,51 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+#include <string>
+#include <vector>
+
+namespace sgct_core
+{
+
+/*!
+    Read-only view of a whole file. The file is memory mapped (mmap or a Windows file mapping) so that large
+    meshes and caches can be used without copying them, and read into memory if mapping isn't possible.
+*/
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const std::string & path);
+    void close();
+
+    //! \returns the file contents or nullptr if the file is empty or not open
+    inline const unsigned char * getData() const { return mData; }
+    //! \returns the size of the file in bytes
+    inline std::size_t getSize() const { return mSize; }
+    //! \returns true if the contents are memory mapped and not a copy
+    inline bool isMapped() const { return mMapped; }
+
+private:
+    MappedFile(const MappedFile & mf) = delete;
+    const MappedFile & operator=(const MappedFile & rhs) = delete;
+
+    const unsigned char * mData;
+    std::size_t mSize;
+    bool mMapped;
+    void * mFileHandle;
+    void * mMappingHandle;
+    std::vector<unsigned char> mBuffer;
+};
+
+}
+
+#endif
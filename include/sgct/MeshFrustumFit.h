@@ -0,0 +1,44 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _MESH_FRUSTUM_FIT_H_
+#define _MESH_FRUSTUM_FIT_H_
+
+#include <glm/glm.hpp>
+
+namespace sgct_core
+{
+
+struct CorrectionMeshVertex;
+
+/*!
+    Computes the projection plane a correction mesh actually samples. Meshes that come with a view plane (SCISS
+    and SkySkan) map their texture coordinates linearly over the tangents of the field of view in the file, but
+    usually only use part of the image. The fitted field of view covers just the texture coordinates in use, so
+    no pixels are rendered that are never shown.
+
+    The functions only read the arguments they are given and have no OpenGL or engine dependencies, so meshes
+    can be fitted on any thread. The viewport applies the result to its own frustums when the mesh is uploaded.
+*/
+class MeshFrustumFit
+{
+public:
+    struct Bounds
+    {
+        float mFov[4]; //up, down, left, right in degrees
+        float mTexCoordRect[4]; //s min, t min, s max, t max within the viewport, [0, 1]
+    };
+
+    static bool compute(const CorrectionMeshVertex * vertices, unsigned int numberOfVertices, const float fov[4],
+        const glm::vec4 & area, Bounds & bounds);
+    static void remapTexCoords(CorrectionMeshVertex * vertices, unsigned int numberOfVertices, const glm::vec4 & area,
+        const Bounds & bounds);
+};
+
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _MESH_TEXT_READER_H_
+#define _MESH_TEXT_READER_H_
+
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+namespace sgct_core
+{
+
+/*!
+    Line based tokenizer for the text warping mesh formats. The file is memory mapped and scanned in place
+    without allocating per line or per token.
+
+    The functions replace a sscanf call on a line read by fgets and follow the same rules, so a format like
+    "%f %f %u" is read with readFloat(), readFloat() and readUInt() in sequence:
+    - lines end after a newline or after maxLineLength - 1 characters, like fgets with a buffer of that size
+    - conversions skip leading white space, whitespace in a literal matches any amount of white space
+    - a conversion that fails leaves the position undefined, call restart() before trying another pattern
+    - numbers are converted with the same rounding as the C library, so the values are bit-identical
+
+    Plain decimal numbers are converted directly. Other input (hexadecimal, inf, nan, very long numbers or
+    values that can't be rounded exactly with double precision) falls back to sscanf on a copy of the line.
+*/
+class MeshTextReader
+{
+public:
+    MeshTextReader(std::size_t maxLineLength = 1024);
+
+    bool open(const std::string & path);
+    void open(const char * data, std::size_t size);
+    void close();
+
+    bool nextLine();
+    //! Restart scanning at the beginning of the current line. Always true so that it can begin a chain of conversions.
+    inline bool restart() { mPos = mLineBegin; return true; }
+
+    bool match(const char * literal);
+    bool readFloat(float & value);
+    bool readDouble(double & value);
+    bool readUInt(unsigned int & value);
+    bool readInt(int & value);
+    bool readWord(char * buffer, std::size_t bufferSize);
+    bool skipFloat();
+    bool skipInt();
+
+    //! \returns the total number of bytes of the text
+    inline std::size_t getSize() const { return static_cast<std::size_t>(mEnd - mBegin); }
+
+private:
+    void skipSpace();
+    int fallbackScan(const char * format, void * value);
+
+    MeshTextReader(const MeshTextReader & mtr) = delete;
+    const MeshTextReader & operator=(const MeshTextReader & rhs) = delete;
+
+    MappedFile mFile;
+    std::size_t mMaxLineLength;
+    const char * mBegin;
+    const char * mEnd;
+    const char * mLineBegin;
+    const char * mLineEnd;
+    const char * mPos;
+    std::vector<char> mScratch;
+};
+
+}
+
+#endif
@@ -15,10 +15,19 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #include "helpers/SGCTCPPEleven.h"
 
 #include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdio.h>
 
 #define TIME_BUFFER_SIZE 9
 #define LOG_FILENAME_BUFFER_SIZE 1024 //include path
 
+namespace sgct_core
+{
+    class MessageRing;
+}
+
 namespace sgct //simple graphics cluster toolkit
 {
 
@@ -29,6 +38,11 @@ public:
         Different notify levels for messages
     */
     enum NotifyLevel { NOTIFY_ERROR = 0, NOTIFY_IMPORTANT, NOTIFY_VERSION_INFO, NOTIFY_INFO, NOTIFY_WARNING, NOTIFY_DEBUG, NOTIFY_ALL };
+
+    /*!
+        What an asynchronous print does when the message ring is full
+    */
+    enum OverflowPolicy { DROP_MESSAGE = 0, BLOCK_CALLER };
     
     /*! Get the MessageHandler instance */
     static MessageHandler * instance()
@@ -71,6 +85,13 @@ public:
 #ifdef __LOAD_CPP11_FUN__
     void setLogCallback(sgct_cppxeleven::function<void(const char *)> fn);
 #endif
+    void setAsyncLogging(bool state, std::size_t numberOfRecords = 4096);
+    bool getAsyncLogging();
+    void setAsyncOverflowPolicy(OverflowPolicy policy);
+    void setAsyncFlushInterval(double seconds);
+    void setAsyncFlushLevel(NotifyLevel nl);
+    unsigned long long getNumberOfDroppedMessages();
+    void flush();
     const char * getTimeOfDayStr();
     inline std::size_t getDataSize() { return mBuffer.size(); }
 
@@ -84,8 +105,15 @@ private:
     const MessageHandler & operator=(const MessageHandler & rhs) = delete;
 
     // Don't implement these, should give compile warning if used
-    void printv(const char *fmt, va_list ap);
+    void printv(NotifyLevel nl, const char *fmt, va_list ap);
+    void printAsync(NotifyLevel nl, const char *fmt, va_list ap);
+    void writeMessage(const char * buffer, bool keepFileOpen);
     void logToFile(const char * buffer);
+    void writeToOpenLogFile(const char * buffer);
+    void formatTimeOfDay(char * buffer);
+    void startWriter(std::size_t numberOfRecords);
+    void stopWriter();
+    void writerLoop();
 
 private:
 #ifdef __LOAD_CPP11_FUN__
@@ -115,6 +143,26 @@ private:
     std::string mFilename;
     size_t mMaxMessageSize;
     size_t mCombinedMessageSize;
+
+    //asynchronous logging, messages are formatted by the caller and written by one writer thread
+    sgct_core::MessageRing * mRing;
+    std::thread * mWriterThread;
+    std::mutex mWriterMutex;
+    std::condition_variable mWriterCondition;
+    std::condition_variable mFlushedCondition;
+    std::atomic<bool> mAsync;
+    std::atomic<bool> mWriterRunning;
+    std::atomic<bool> mWriterSleeping;
+    std::atomic<bool> mFlushRequested;
+    std::atomic<int> mActiveProducers;
+    std::atomic<int> mOverflowPolicy;
+    std::atomic<int> mFlushLevel;
+    std::atomic<int> mFlushIntervalMs;
+    std::atomic<unsigned long long> mDroppedMessages;
+    std::atomic<unsigned long long> mPushedMessages;
+    unsigned long long mWrittenMessages; //guarded by mWriterMutex
+    FILE * mLogFile; //only used by the writer thread
+    std::string mLogFileName;
 };
 
 }
@@ -0,0 +1,66 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _MESSAGE_RING_H_
+#define _MESSAGE_RING_H_
+
+#include <atomic>
+#include <string>
+#include <cstddef>
+
+namespace sgct_core
+{
+
+/*!
+    Bounded multi producer, single consumer queue of log messages used by the asynchronous MessageHandler. The
+    records are allocated once, producers claim consecutive records with a compare and swap and never lock, and
+    a message longer than one record is spread over several so that messages are never interleaved.
+
+    Every record has a sequence number that tells whose turn it is: a record at position p is free for the
+    producer of p when its sequence is p and ready for the consumer when it is p + 1. The consumer releases
+    records in order, so the last record of a claim being free means that the whole claim is.
+*/
+class MessageRing
+{
+public:
+    //! text bytes per record, a record is 256 bytes
+    static const std::size_t RecordTextSize = 240;
+    //! longer messages are truncated
+    static const std::size_t MaxRecordsPerMessage = 64;
+
+    explicit MessageRing(std::size_t numberOfRecords);
+    ~MessageRing();
+
+    bool push(int level, const char * text, std::size_t length, bool block);
+    bool pop(int & level, std::string & text);
+    bool isEmpty() const;
+    inline std::size_t getCapacity() const { return mMask + 1; }
+
+private:
+    MessageRing(const MessageRing & rhs) = delete;
+    const MessageRing & operator=(const MessageRing & rhs) = delete;
+
+    struct Record
+    {
+        std::atomic<std::size_t> mSequence;
+        int mLevel;
+        unsigned short mNumberOfRecords; //records of the message, set on the first one
+        unsigned short mLength;
+        char mText[RecordTextSize];
+    };
+
+    Record * mRecords;
+    std::size_t mMask;
+    char mPad0[64];
+    std::atomic<std::size_t> mEnqueuePosition;
+    char mPad1[64];
+    std::atomic<std::size_t> mDequeuePosition; //only written by the consumer
+};
+
+}
+
+#endif
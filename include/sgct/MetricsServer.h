@@ -0,0 +1,95 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _METRICS_SERVER_H_
+#define _METRICS_SERVER_H_
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "SGCTNetwork.h" //SGCT_SOCKET
+#include "Statistics.h"
+
+namespace sgct_core
+{
+
+/*!
+    A minimal HTTP server on the loopback interface that serves the health of the node in the Prometheus text
+    format, for scraping unattended installations. Any GET request for / or /metrics is answered with the metrics.
+
+    The render thread publishes a snapshot of the metrics now and then. Publishing only tries to take the lock, and
+    a snapshot is skipped if the server is copying the previous one, so the render thread never waits for it. The
+    age of the snapshot is served as well, which shows if the render loop has stalled.
+*/
+class MetricsServer
+{
+public:
+    struct Connection
+    {
+        int mId;
+        std::string mType;
+        std::string mAddress;
+        std::string mPort;
+        bool mConnected;
+        unsigned long long mBytesSent;
+        unsigned long long mBytesReceived;
+        unsigned long long mMessagesSent;
+        unsigned long long mMessagesReceived;
+        double mLoopTime; //seconds from sending sync data until the reply, sync connections only
+    };
+
+    struct Snapshot
+    {
+        Snapshot();
+
+        double mTime; //when the snapshot was taken, -1 if it hasn't been published
+        int mNodeId;
+        bool mMaster;
+        unsigned long long mFrameNumber;
+        Statistics::Report mReport;
+        double mGPUFrameTime; //-1 if not measured
+        unsigned long long mGPUDroppedFrames;
+        double mTrackingSamplingTime; //-1 without tracking
+        unsigned int mCapturePendingFrames;
+        unsigned long long mCaptureDroppedFrames;
+        unsigned long long mDroppedLogMessages;
+        unsigned long long mDroppedTraceEvents;
+        std::vector<Connection> mConnections;
+    };
+
+    MetricsServer();
+    ~MetricsServer();
+
+    bool start(int port);
+    void stop();
+    bool publish(const Snapshot & snapshot);
+
+    static void format(const Snapshot & snapshot, double time, std::string & text);
+
+private:
+    MetricsServer(const MetricsServer & rhs) = delete;
+    const MetricsServer & operator=(const MetricsServer & rhs) = delete;
+
+    void serve();
+    void handleClient(SGCT_SOCKET client);
+    void closeSocket(SGCT_SOCKET & lSocket);
+
+    SGCT_SOCKET mListenSocket;
+    int mPort;
+    std::thread * mThread;
+    std::atomic<bool> mTerminate;
+
+    std::mutex mSnapshotMutex;
+    Snapshot mSnapshot;
+};
+
+}
+
+#endif
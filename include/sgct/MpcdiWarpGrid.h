@@ -0,0 +1,61 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _MPCDI_WARP_GRID_H_
+#define _MPCDI_WARP_GRID_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace sgct_core
+{
+
+/*!
+    MPCDI geometry warp field. The PFM file stores an x and y correction and an error value per grid point,
+    only the corrections are kept (8 bytes per point).
+
+    The PFM data can be decoded incrementally as it arrives, for instance from the unzip stream of an .mpcdi
+    package, so the file never has to be buffered as a whole.
+*/
+class MpcdiWarpGrid
+{
+public:
+    MpcdiWarpGrid();
+
+    void reset();
+    bool decode(const char * data, std::size_t size);
+    bool finish();
+    bool readFile(const std::string & path);
+    void swap(MpcdiWarpGrid & other);
+
+    //! \returns true if no complete grid is stored
+    inline bool isEmpty() const { return mCorrections.empty() || !mComplete; }
+    inline unsigned int getColumns() const { return mColumns; }
+    inline unsigned int getRows() const { return mRows; }
+    //! \returns the x and y correction of each grid point in raster order, starting at the upper left corner
+    inline const float * getCorrections() const { return mCorrections.data(); }
+
+private:
+    bool parseHeader();
+
+    std::string mHeader;
+    std::vector<float> mCorrections;
+    unsigned char mPending[12]; //the part of a point that continues in the next block
+    std::size_t mPendingSize;
+    std::size_t mPointsRead;
+    unsigned int mColumns;
+    unsigned int mRows;
+    bool mHeaderDone;
+    bool mSwapBytes;
+    bool mComplete;
+    bool mFailed;
+};
+
+}
+
+#endif
@@ -10,10 +10,14 @@ For conditions of distribution and use, see copyright notice in sgct.h
 
 #include "SGCTNetwork.h"
 #include "Statistics.h"
+#include "ClockSync.h"
 #include <vector>
 #include <string>
 #include <atomic>
 #include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <random>
 
 namespace sgct_core
 {
@@ -51,6 +55,16 @@ public:
     void transferData(const void * data, int length, int packageId, std::size_t nodeIndex);
     void transferData(const void * data, int length, int packageId, SGCTNetwork * connection);
     void setDataTransferCompression(bool state, int level = 1);
+    static bool prepareTransferData(const void * data, char ** bufferPtr, int & length, int packageId, bool compress, int compressionLevel);
+    bool setConfigurationSnapshot(const std::vector<char> & snapshot);
+    bool waitForConfigurationSnapshot(std::vector<char> & snapshot);
+    bool requestTraces(double timeout);
+
+    double getClusterTime();
+    ClockSync::Quality getClockSyncQuality();
+    void setClockSyncInterval(double interval);
+    void setClockSyncTestDelays(double requestDelay, double replyDelay, double jitter);
+    void setSyncTestLink(double latency, double bandwidth);
 
     unsigned int getActiveConnectionsCount();
     unsigned int getActiveSyncConnectionsCount();
@@ -68,7 +82,11 @@ private:
     void getHostInfo();
     void updateConnectionStatus(SGCTNetwork * connection);
     void setAllNodesConnected();
-    bool prepareTransferData(const void * data, char ** bufferPtr, int & length, int packageId);
+    void receiveConfigurationSnapshot(const char * data, int length);
+    void receiveTrace(SGCTNetwork * connection, const char * data, int length, int requestId);
+    void receiveClockSync(SGCTNetwork * connection, const char * data, int length, int requestId);
+    void clockSyncLoop();
+    double getClockSyncTestDelay(double delay, std::minstd_rand & random);
 
 public:
     static std::condition_variable gCond;
@@ -93,6 +111,33 @@ private:
     unsigned int mNumberOfActiveConnections;
     unsigned int mNumberOfActiveSyncConnections;
     unsigned int mNumberOfActiveDataTransferConnections;
+
+    std::vector<char> mConfigurationMessage; //compressed snapshot sent by the master to connecting slaves
+    std::vector<char> mConfigurationSnapshot; //snapshot received by a slave
+    bool mConfigurationReceived;
+    bool mConfigurationFailed; //the snapshot couldn't be uncompressed or is corrupt
+    std::mutex mConfigurationMutex;
+    std::condition_variable mConfigurationCond;
+
+    int32_t mTraceRequestId;
+    unsigned int mTraceReplies; //replies to the latest request
+    double mTraceRequestTime;
+    std::mutex mTraceMutex;
+    std::condition_variable mTraceCond;
+
+    //slaves estimate the master clock from requests sent by their own thread
+    ClockSync mClockSync;
+    std::thread * mClockSyncThread;
+    bool mClockSyncRunning;
+    int32_t mClockSyncRequestId;
+    double mClockSyncRequestTimes[16]; //send times of the latest requests, indexed by the request id
+    double mClockSyncInterval;
+    double mClockSyncTestDelays[3]; //request, reply and jitter, added on loopback to test the estimate
+    std::minstd_rand mClockSyncRandom[2];
+    std::mutex mClockSyncMutex;
+    std::condition_variable mClockSyncCond;
+
+    double mSyncTestLink[2]; //latency and bandwidth of the sync connections, see SGCTNetwork::setTestLink
 };
 
 }
@@ -30,6 +30,11 @@ public:
     ~ReadConfig();
 
     bool isValid() { return valid; }
+    //! \returns true if only the cluster and nodes have been read and the rest comes from a configuration snapshot
+    bool isSnapshotPending() { return mSnapshotPending; }
+    bool parseContents();
+    bool createSnapshot(std::vector<char> & snapshot);
+    bool parseSnapshot(const std::vector<char> & snapshot);
     static glm::quat parseOrientationNode(tinyxml2::XMLElement* element);
     static glm::quat parseMpcdiOrientationNode(const float yaw, const float pitch, const float roll);
 
@@ -38,10 +43,15 @@ private:
     bool readAndParseXMLFile();
     bool readAndParseXMLString();
     bool readAndParseXML(tinyxml2::XMLDocument& xmlDoc);
+    bool readAndParseXMLCluster(tinyxml2::XMLDocument& xmlDoc);
+    bool readAndParseXMLContents(tinyxml2::XMLDocument& xmlDoc);
+    bool verifySnapshotNodes(tinyxml2::XMLDocument& xmlDoc);
     sgct::SGCTWindow::StereoMode getStereoType( std::string type );
     sgct::SGCTWindow::ColorBitDepth getBufferColorBitDepth(std::string type);
 
     bool valid;
+    bool mSnapshotPending;
+    tinyxml2::XMLDocument mXmlDoc;
     std::string xmlFileName;
     std::string mErrorMsg;
 };
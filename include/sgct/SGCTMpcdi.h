@@ -10,9 +10,12 @@
 
 #include <string>
 #include <vector>
+#include <atomic>
 #include <glm/glm.hpp>
 #include "SGCTWindow.h"
 #include "SGCTNode.h"
+#include "Viewport.h"
+#include "MpcdiWarpGrid.h"
 #include "external/unzip.h"
 #include "external/zip.h"
 #ifndef SGCT_DONT_USE_EXTERNAL
@@ -24,33 +27,31 @@
 namespace sgct_core //simple graphics cluster toolkit
 {
 
+//! Location of a file inside the .mpcdi archive, files are only decompressed when they are used
+struct MpcdiArchiveEntry {
+    std::string filename;
+    unz_file_pos position;
+    unsigned long size;
+};
+
 struct MpcdiSubFiles {
-    enum mpcdiSubFileTypes {
-        mpcdiXml = 0,
-        mpcdiPfm,
-        mpcdi_nRequiredFiles //Leave at end
-    };
-    bool hasFound[mpcdi_nRequiredFiles];
-    std::string extension[mpcdi_nRequiredFiles];
-    std::string filename[mpcdi_nRequiredFiles];
-    int size[mpcdi_nRequiredFiles];
-    char* buffer[mpcdi_nRequiredFiles];
+    bool hasXml;
+    std::string xmlFilename;
+    std::vector<char> xmlBuffer; //the xml is parsed from memory, all other files are streamed
+    std::vector<MpcdiArchiveEntry> entries;
 
-    MpcdiSubFiles() {
-        for (int i = 0; i < mpcdi_nRequiredFiles; ++i) {
-            hasFound[i] = false;
-            buffer[i] = nullptr;
-        }
-		extension[mpcdiXml] = "xml";
-		extension[mpcdiPfm] = "pfm";
-    }
+    MpcdiSubFiles() : hasXml(false) {}
+};
 
-    ~MpcdiSubFiles() {
-        for (int i = 0; i < mpcdi_nRequiredFiles; ++i) {
-            if( buffer[i] != nullptr )
-                delete buffer[i];
-        }
-    }
+//! A warp field or mask that is decoded from the archive after the xml has been parsed
+struct MpcdiSubFileTask {
+    std::string path;
+    std::size_t entryIndex;
+    Viewport * viewportPtr;
+    Viewport::DataType type;
+    MpcdiWarpGrid grid;
+    Image * imagePtr;
+    bool status;
 };
 
 struct MpcdiRegion {
@@ -94,9 +95,18 @@ private:
     bool readAndParseXML_geoWarpFile(tinyxml2::XMLElement* element[],
              const char* val[], sgct::SGCTWindow& tmpWin,
              std::string filesetRegionId);
+    bool readAndParseXML_maskFile(tinyxml2::XMLElement* element[],
+             sgct::SGCTWindow& tmpWin, std::string filesetRegionId,
+             Viewport::DataType type);
+    Viewport * findRegionViewport(sgct::SGCTWindow& tmpWin, const std::string & regionId);
+    bool addSubFileTask(const std::string & path, Viewport * vpPtr, Viewport::DataType type);
     bool openZipFile(FILE* cfgFile, const std::string cfgFilePath, unzFile* zipfile);
     bool processSubFiles(std::string filename, unzFile* zipfile,
              unz_file_info& file_info);
+    bool readXmlFile(unzFile* zipfile, unz_file_info& file_info);
+    bool decodeSubFiles();
+    void decodeSubFileTasks();
+    bool decodeSubFile(unzFile zipfile, MpcdiSubFileTask & task);
     bool doesStringHaveSuffix(const std::string &str, const std::string &suffix);
     bool checkAttributeForExpectedValue(tinyxml2::XMLElement* elem,
              const std::string attrRequired, const std::string tagDescription,
@@ -106,6 +116,9 @@ private:
     MpcdiSubFiles mMpcdiSubFileContents;
     std::vector<MpcdiRegion*> mBufferRegions;
     std::vector<MpcdiWarp*> mWarp;
+    std::vector<MpcdiSubFileTask> mSubFileTasks;
+    std::atomic<std::size_t> mNextSubFileTask;
+    std::string mFilename;
     std::string mErrorMsg;
 };
 
@@ -9,6 +9,7 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #define _SGCT_NETWORK
 #include <string>
 #include <vector>
+#include <deque>
 #include <stdint.h>
 #include "helpers/SGCTCPPEleven.h"
 
@@ -38,7 +39,7 @@ class SGCTNetwork
 {
 public:
     //ASCII device control chars = 17, 18, 19 & 20
-    enum PackageHeaderId { DefaultId = 0, Ack = 6, DataId = 17, ConnectedId = 18, DisconnectId = 19, CompressedDataId = 21 };
+    enum PackageHeaderId { DefaultId = 0, Ack = 6, DataId = 17, ConnectedId = 18, DisconnectId = 19, CompressedDataId = 21, ConfigurationId = 22, ReloadId = 23, TraceId = 24, ClockSyncId = 25 };
     enum ConnectionTypes { SyncConnection = 0, ExternalASCIIConnection, ExternalRawConnection, DataTransfer };
     enum ReceivedIndex { Current = 0, Previous };
 
@@ -53,7 +54,13 @@ public:
     void setUpdateFunction(sgct_cppxeleven::function<void (SGCTNetwork *)> callback);
     void setConnectedFunction(sgct_cppxeleven::function<void (void)> callback);
     void setAcknowledgeFunction(sgct_cppxeleven::function<void(int, int)> callback);
+    void setConfigurationFunction(sgct_cppxeleven::function<void (const char*, int, int)> callback);
+    void setReloadFunction(sgct_cppxeleven::function<void (int, unsigned int, int, int)> callback);
+    void setTraceFunction(sgct_cppxeleven::function<void (SGCTNetwork *, const char*, int, int)> callback);
+    void setClockSyncFunction(sgct_cppxeleven::function<void (SGCTNetwork *, const char*, int, int)> callback);
 #endif
+    void setConnectMessage(const std::vector<char> & message);
+    void setTestLink(double latency, double bandwidth);
     void setBufferSize(uint32_t newSize);
     void setConnectedStatus(bool state);
     void setOptions(SGCT_SOCKET * socketPtr);
@@ -68,10 +75,18 @@ public:
     int getSendFrame(ReceivedIndex ri = Current);
     int getRecvFrame(ReceivedIndex ri);
     double getLoopTime();
+    unsigned long long getBytesSent() const { return mBytesSent.load(); }
+    unsigned long long getBytesReceived() const { return mBytesReceived.load(); }
+    unsigned long long getMessagesSent() const { return mMessagesSent.load(); }
+    unsigned long long getMessagesReceived() const { return mMessagesReceived.load(); }
     bool isUpdated();
     void setRecvFrame(int i);
     void sendData(const void * data, int length);
     void sendStr(std::string msg);
+    void sendReloadMessage(int type, unsigned int generation, int32_t value);
+    void sendTraceRequest(int32_t requestId);
+    void sendClockSyncRequest(int32_t requestId);
+    void sendClockSyncReply(int32_t requestId, double receiveTime, double sendTime);
     static int getLastError();
     static _ssize_t receiveData(SGCT_SOCKET & lsocket, char * buffer, int length, int flags);
     static int32_t parseInt32(char * str);
@@ -90,6 +105,10 @@ public:
     sgct_cppxeleven::function< void(SGCTNetwork *) > mUpdateCallbackFn;
     sgct_cppxeleven::function< void(void) > mConnectedCallbackFn;
     sgct_cppxeleven::function< void(int, int) > mAcknowledgeCallbackFn;
+    sgct_cppxeleven::function< void(const char*, int, int) > mConfigurationCallbackFn;
+    sgct_cppxeleven::function< void(int, unsigned int, int, int) > mReloadCallbackFn;
+    sgct_cppxeleven::function< void(SGCTNetwork *, const char*, int, int) > mTraceCallbackFn;
+    sgct_cppxeleven::function< void(SGCTNetwork *, const char*, int, int) > mClockSyncCallbackFn;
 #endif
 
 private:
@@ -97,6 +116,8 @@ private:
     int readSyncMessage(char * _header, int32_t & _syncFrameNumber, uint32_t & _dataSize, uint32_t & _uncompressedDataSize);
     int readDataTransferMessage(char * _header, int32_t & _packageId, uint32_t & _dataSize, uint32_t & _uncompressedDataSize);
     int readExternalMessage();
+    void readTestLink();
+    _ssize_t receiveTestLinkData(char * buffer, int length);
 
     static void communicationHandlerStarter(void *arg);
     static void connectionHandlerStarter(void *arg);
@@ -124,7 +145,14 @@ private:
     std::atomic<bool> mTerminate; //set to true upon exit
     std::atomic<uint32_t> mRequestedSize;
 
+    //totals since the connection was created, including the headers
+    std::atomic<unsigned long long> mBytesSent;
+    std::atomic<unsigned long long> mBytesReceived;
+    std::atomic<unsigned long long> mMessagesSent;
+    std::atomic<unsigned long long> mMessagesReceived;
+
     std::mutex mConnectionMutex;
+    std::mutex mSendMutex; //trace and clock replies are sent from the communication thread
     std::thread * mCommThread;
     std::thread * mMainThread;
 
@@ -140,6 +168,25 @@ private:
     char mHeaderId;
 
     bool mUseNaglesAlgorithmInDataTransfer;
+    std::vector<char> mConnectMessage; //sent by the server before anything else on a new connection
+
+    //received sync data is held back as if the link had this latency (s) and bandwidth (bytes/s), see setTestLink
+    struct TestLinkChunk
+    {
+        double mReleaseTime; //when the data would have arrived over the test link
+        std::vector<char> mData;
+        std::size_t mRead;
+    };
+
+    double mTestLatency;
+    double mTestBandwidth;
+    double mTestLinkFreeTime; //used by the test link thread only
+    std::thread * mTestLinkThread;
+    std::mutex mTestLinkMutex;
+    std::condition_variable mTestLinkCond;
+    std::deque<TestLinkChunk> mTestLinkChunks;
+    bool mTestLinkOpen;
+    _ssize_t mTestLinkResult; //the recv result that closed the test link
 };
 }
 
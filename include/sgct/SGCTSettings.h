@@ -62,13 +62,20 @@ public:
     void setBufferFloatPrecision(BufferFloatPrecision bfp);
     void setUseFBO(bool state);
     void setNumberOfCaptureThreads(int count);
+    void setNumberOfLoaderThreads(int count);
     void setPNGCompressionLevel(int level);
     void setJPEGQuality(int quality);
     void setCapturePath(std::string path, CapturePathIndex cpi = Mono);
     void appendCapturePath(std::string str, CapturePathIndex cpi = Mono);
     void setCaptureFormat(const char * format);
+    void setCaptureStreamTarget(std::string target);
+    void setCaptureStreamFrameRate(int fps);
     void setCaptureFromBackBuffer(bool state);
     void setExportWarpingMeshes(bool state);
+    void setUseWarpMeshCache(bool state);
+    void setWatchCorrectionData(bool state);
+    void setWarpMeshCacheDirectory(std::string path);
+    void setWarpMeshDecimationError(float pixels);
     void setFXAASubPixTrim(float val);
     void setFXAASubPixOffset(float val);
     void setOSDTextXOffset(float val);
@@ -102,10 +109,16 @@ public:
     const bool            getCaptureFromBackBuffer() const;
     const bool            getTryMaintainAspectRatio() const;
     const bool            getExportWarpingMeshes() const;
+    const bool            getUseWarpMeshCache() const;
+    const bool            getWatchCorrectionData() const;
+    const std::string &    getWarpMeshCacheDirectory() const;
+    const float            getWarpMeshDecimationError() const;
 
     // -- mutex protected get functions ---------- //
     const bool            getUseRLE();
     const int            getCaptureFormat();
+    const std::string    getCaptureStreamTarget();
+    const int            getCaptureStreamFrameRate();
     const int            getPNGCompressionLevel();
     const int            getJPEGQuality();
 
@@ -120,6 +133,8 @@ public:
     inline bool        useFBO() { return mUseFBO; }
     //! Get the number of capture threads (for screenshot recording)
     inline int        getNumberOfCaptureThreads() { return mNumberOfCaptureThreads; }
+    //! Get the number of threads loading warping meshes and masks at startup
+    inline int        getNumberOfLoaderThreads() { return mNumberOfLoaderThreads; }
     //! The relative On-Screen-Display text x-offset in range [0, 1]
     inline float    getOSDTextXOffset() { return mOSDTextOffset[0]; }
     //! The relative On-Screen-Display text y-offset in range [0, 1]
@@ -144,9 +159,11 @@ private:
     static SGCTSettings * mInstance;
 
     int mCaptureFormat;
+    int mCaptureStreamFrameRate;
     int mSwapInterval;
     int mRefreshRate;
     int mNumberOfCaptureThreads;
+    int mNumberOfLoaderThreads;
     int mPNGCompressionLevel;
     int mJPEGQuality;
     int mDefaultNumberOfAASamples;
@@ -164,12 +181,17 @@ private:
     bool mCaptureBackBuffer;
     bool mTryMaintainAspectRatio;
     bool mExportWarpingMeshes;
+    bool mUseWarpMeshCache;
+    bool mWatchCorrectionData;
 
     float mOSDTextOffset[2];
     float mFXAASubPixTrim;
     float mFXAASubPixOffset;
 
     std::string mCapturePath[3];
+    std::string mCaptureStreamTarget;
+    std::string mWarpMeshCacheDirectory;
+    float mWarpMeshDecimationError;
 
     //fontdata
     std::string mFontName;
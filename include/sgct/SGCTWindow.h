@@ -42,6 +42,7 @@ public:
     void init();
     void initOGL();
     void initContextSpecificOGL();
+    void applyReloadedData();
     static void initNvidiaSwapGroups();
     void initWindowResolution(const int x, const int y);
     void swap(bool takeScreenshot);
@@ -10,8 +10,10 @@ For conditions of distribution and use, see copyright notice in sgct.h
 
 #include "ogl_headers.h"
 #include "Image.h"
+#include "CaptureStream.h"
 #include "helpers/SGCTCPPEleven.h"
 #include <string>
+#include <vector>
 
 #include <mutex>
 #include <thread>
@@ -27,17 +29,24 @@ public:
     std::thread * mFrameCaptureThreadPtr;
     std::mutex * mMutexPtr;
     bool mRunning; //needed for test if running without join
+
+    //set if the frame is written to a Y4M stream instead of an image file
+    sgct_core::CaptureStream * mStreamPtr;
+    unsigned long long mStreamSequence;
+    bool mStreamBGR;
+    std::vector<unsigned char> mStreamBuffer;
 };
 
 /*!
     This class is used internally by SGCT and is called when using the takeScreenshot function from the Engine.
     Screenshots are saved as PNG or TGA images and and can also be used for movie recording.
+    Using the Y4M format all frames are instead streamed into one video file, named pipe or local socket (see CaptureStream).
 */
 class ScreenCapture
 {
 public:
     //! The different file formats supported
-    enum CaptureFormat { NOT_SET = -1, PNG = 0, TGA, JPEG };
+    enum CaptureFormat { NOT_SET = -1, PNG = 0, TGA, JPEG, Y4M };
     enum CaputeSrc { CAPTURE_TEXTURE = 0, CAPTURE_BACK_BUFFER = GL_BACK, CAPTURE_LEFT_BACK_BUFFER = GL_BACK_LEFT, CAPTURE_RIGHT_BACK_BUFFER = GL_BACK_RIGHT};
     enum EyeIndex { MONO = 0, STEREO_LEFT, STEREO_RIGHT};
 
@@ -52,6 +61,8 @@ public:
     void saveScreenCapture(unsigned int textureId, CaputeSrc CapSrc = CAPTURE_TEXTURE);
     void setPathAndFileName(std::string path, std::string filename);
     void setUsePBO(bool state);
+    unsigned int getNumberOfPendingFrames();
+    unsigned long long getNumberOfDroppedStreamFrames();
 
 #ifdef __LOAD_CPP11_FUN__
     void setCaptureCallback(sgct_cppxeleven::function<void(Image*, std::size_t, EyeIndex, unsigned int type)> callback);
@@ -66,9 +77,15 @@ private:
     void updateDownloadFormat();
     void checkImageBuffer(const CaputeSrc & CapSrc);
     Image * prepareImage(int index);
+    void startCaptureThread(int index);
+    bool openStream();
+    void closeStream();
 
     std::mutex mMutex;
     ScreenCaptureThreadInfo * mSCTIPtrs;
+    CaptureStream * mStreamPtr;
+    unsigned int mStreamSegment;
+    bool mStreamFailed;
 
     unsigned int mNumberOfThreads;
     unsigned int mPBO;
@@ -116,10 +116,14 @@ public:
     void setDecodeFunction(sgct_cppxeleven::function<void(void)> fn);
 #endif
 
+    void setInternalEncodeFunction(sgct_cppxeleven::function<void(void)> fn);
+    void setInternalDecodeFunction(sgct_cppxeleven::function<void(void)> fn);
+
     void encode();
     void decode(const char * receivedData, int receivedlength, int clientIndex);
 
     std::size_t getUserDataSize();
+    const unsigned char * getEncodedData(std::size_t & size);
     inline unsigned char * getDataBlock() { return &dataBlock[0]; }
     inline std::size_t getDataSize() { return dataBlock.size(); }
     inline std::size_t getBufferSize() { return dataBlock.capacity(); }
@@ -141,6 +145,8 @@ private:
     //function pointers
     sgct_cppxeleven::function<void(void)> mEncodeFn;
     sgct_cppxeleven::function<void(void)> mDecodeFn;
+    sgct_cppxeleven::function<void(void)> mInternalEncodeFn; //SGCT's own data, before the application's
+    sgct_cppxeleven::function<void(void)> mInternalDecodeFn;
 
     static SharedData * mInstance;
     std::vector<unsigned char> dataBlock;
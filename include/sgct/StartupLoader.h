@@ -0,0 +1,61 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _STARTUP_LOADER_H_
+#define _STARTUP_LOADER_H_
+
+#include "Viewport.h"
+#include <vector>
+#include <atomic>
+
+namespace sgct_core
+{
+
+/*!
+    Decodes the overlay and mask textures and parses the warping meshes of all viewports on a pool of threads
+    before the OpenGL data is created. Each file is a separate task so a large mesh doesn't hold back the masks
+    of the same viewport. The OpenGL uploads are done later by Viewport::loadData on the context thread.
+*/
+class StartupLoader
+{
+public:
+    StartupLoader();
+
+    void addViewport(Viewport * vpPtr, std::size_t windowIndex, std::size_t viewportIndex, float windowAspectRatio, const glm::ivec2 & framebufferResolution);
+    void load(std::size_t numberOfThreads = 0);
+    void printReport();
+
+    //! \returns the number of files that are prepared
+    inline std::size_t getNumberOfTasks() const { return mTasks.size(); }
+
+private:
+    struct Task
+    {
+        Viewport * mViewportPtr;
+        Viewport::DataType mType;
+        std::size_t mWindowIndex;
+        std::size_t mViewportIndex;
+        float mWindowAspectRatio;
+        glm::ivec2 mFramebufferResolution;
+        double mPrepareTime;
+        bool mStatus;
+    };
+
+    void work();
+
+    StartupLoader(const StartupLoader & sl) = delete;
+    const StartupLoader & operator=(const StartupLoader & rhs) = delete;
+
+    std::vector<Task> mTasks;
+    std::atomic<std::size_t> mNextTask;
+    std::size_t mNumberOfThreads;
+    double mLoadTime;
+};
+
+}
+
+#endif
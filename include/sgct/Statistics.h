@@ -13,10 +13,15 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #define VERT_SCALE 5000.0f
 #define STATS_NUMBER_OF_DYNAMIC_OBJS 5
 #define STATS_NUMBER_OF_STATIC_OBJS 3
+#define STATS_NUMBER_OF_WINDOWED_OBJS 3 //frame, draw and sync time
+#define STATS_DROPPED_FRAME_FACTOR 1.5f
 
 #include "ShaderProgram.h"
+#include "helpers/SGCTCPPEleven.h"
 #include <glm/glm.hpp>
 #include <vector>
+#include <string>
+#include <cstdio>
 
 struct StatsVertex
 {
@@ -28,6 +33,14 @@ namespace sgct_core
 
 /*!
 Helper class for measuring application statistics
+
+Every metric is kept in a ring buffer of 2 x STATS_HISTORY_LENGTH vertices where each sample is written twice,
+at its slot and at its slot + STATS_HISTORY_LENGTH. The latest STATS_HISTORY_LENGTH samples are then always
+contiguous so the graph is drawn with a single draw call and the head index in the transform, and only the
+new samples are uploaded to the VBOs.
+
+Frame, draw and sync times are also kept for a configurable window of frames from which percentiles are
+calculated. A report of them can be written to a CSV file and/or passed to a callback at a fixed interval.
 */
 class Statistics
 {
@@ -36,6 +49,29 @@ private:
     enum mStatsStaticType { GRID = 0, FREQ, BG };
 
 public:
+    struct Percentiles
+    {
+        float mAvg;
+        float mP50;
+        float mP95;
+        float mP99;
+        float mMax;
+    };
+
+    //! All times are in seconds
+    struct Report
+    {
+        double mTime; //when the report was created
+        unsigned long long mNumberOfFrames; //since start
+        std::size_t mWindowFrames; //frames the percentiles are based on
+        float mAvgFPS;
+        Percentiles mFrameTime;
+        Percentiles mDrawTime;
+        Percentiles mSyncTime;
+        unsigned long long mDroppedFrames; //since start
+        std::size_t mWindowDroppedFrames;
+    };
+
     Statistics();
     ~Statistics();
     void initVBO(bool fixedPipeline);
@@ -48,23 +84,57 @@ public:
     void update();
     void draw(float lineWidth);
 
+    void setRefreshRate(double rate);
+    void setPercentileWindow(std::size_t numberOfFrames);
+    void setReportInterval(double interval);
+    bool setReportFile(const std::string & filename);
+    void setReportFunction(sgct_cppxeleven::function<void(const Report &)> fn);
+    void updateReport(double time);
+    Report getReport(double time);
+
     const float getAvgFPS() { return mAvgFPS; }
     const float getAvgDrawTime() { return mAvgDrawTime; }
     const float getAvgSyncTime() { return mAvgSyncTime; }
     const float getAvgFrameTime() { return mAvgFrameTime; }
-    const float getFrameTime() { return mDynamicVertexList[FRAME_TIME * STATS_HISTORY_LENGTH].y; }
-    const float getDrawTime() { return mDynamicVertexList[DRAW_TIME * STATS_HISTORY_LENGTH].y; }
-    const float getSyncTime() { return mDynamicVertexList[SYNC_TIME * STATS_HISTORY_LENGTH].y; }
+    const float getFrameTime() { return getLatest(FRAME_TIME); }
+    const float getDrawTime() { return getLatest(DRAW_TIME); }
+    const float getSyncTime() { return getLatest(SYNC_TIME); }
+    const unsigned long long getNumberOfDroppedFrames() { return mDroppedFrames; }
 
 private:
+    float getLatest(int type) { return mDynamicVertexList[type * STATS_HISTORY_LENGTH * 2 + getHead(type) + STATS_HISTORY_LENGTH].y; }
+    unsigned int getHead(int type) { return static_cast<unsigned int>((mWrites[type] + STATS_HISTORY_LENGTH - 1) % STATS_HISTORY_LENGTH); }
+    void addSample(int type, float t);
+    float addToAverage(int type, float t);
+    void uploadSlots(int type, unsigned long long first, unsigned long long count);
+    void calculatePercentiles(int type, Percentiles & p);
+    void closeReportFile();
+
     float mAvgFPS;
     float mAvgDrawTime;
     float mAvgSyncTime;
     float mAvgFrameTime;
-    StatsVertex mDynamicVertexList[STATS_HISTORY_LENGTH * STATS_NUMBER_OF_DYNAMIC_OBJS];
+    double mAvgSums[STATS_NUMBER_OF_WINDOWED_OBJS]; //of the latest STATS_AVERAGE_LENGTH samples
+    StatsVertex mDynamicVertexList[STATS_HISTORY_LENGTH * 2 * STATS_NUMBER_OF_DYNAMIC_OBJS];
+    unsigned long long mWrites[STATS_NUMBER_OF_DYNAMIC_OBJS]; //samples ever added, the head is at (mWrites - 1) % STATS_HISTORY_LENGTH
+    unsigned long long mUploaded[2][STATS_NUMBER_OF_DYNAMIC_OBJS]; //samples in each ping-pong VBO
+    bool mLatestSyncDirty[2]; //addSyncTime changed the latest sample after it was uploaded
     glm::vec4 mDynamicColors[STATS_NUMBER_OF_DYNAMIC_OBJS];
     glm::vec4 mStaticColors[STATS_NUMBER_OF_STATIC_OBJS];
 
+    //percentile windows
+    std::vector<float> mWindowSamples[STATS_NUMBER_OF_WINDOWED_OBJS];
+    unsigned long long mWindowStart[STATS_NUMBER_OF_WINDOWED_OBJS]; //number of samples when the window was set
+    std::vector<float> mSortBuffer;
+    float mDroppedFrameTime;
+    unsigned long long mDroppedFrames;
+
+    //reports
+    double mReportInterval;
+    double mLastReportTime;
+    FILE * mReportFile;
+    sgct_cppxeleven::function<void(const Report &)> mReportFn;
+
     //VBOs
     unsigned int mVBOIndex;
     unsigned int mDynamicVBO[2]; //double buffered for ping-pong
@@ -9,12 +9,17 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #define _TEXTURE_MANAGER_H_
 
 #include <string>
+#include <vector>
 
 #include "Image.h"
+#include "TiledTextureStream.h"
+#include "AsyncTextureLoader.h"
 #include "helpers/SGCTCPPEleven.h"
 
 namespace sgct_core
 {
+class CompressedTexture;
+
 class TextureData
 {
 public:
@@ -27,6 +32,15 @@ public:
     int mWidth;
     int mHeight;
     int mChannels;
+
+    //residency
+    std::size_t mBytes;
+    unsigned long long mLastUsedFrame;
+    int mMipmapLevels;
+    bool mInterpolate;
+    bool mEvictable;
+    bool mEvicted;
+    bool mReloading;
 };
 }
 
@@ -82,16 +96,47 @@ public:
     void setAnisotropicFilterSize(float fval);
     void setCompression(CompressionMode cm);
     void setWarpingMode(int warp_s, int warp_t);
+    void setCompressionCacheDirectory(const std::string & directory);
     CompressionMode getCompression();
     bool loadTexture(const std::string name, const std::string filename, bool interpolate, int mipmapLevels = 8);
     bool loadTexture(const std::string name, sgct_core::Image * imgPtr, bool interpolate, int mipmapLevels = 8);
     bool loadUnManagedTexture(unsigned int & texID, const std::string filename, bool interpolate, int mipmapLevels = 8);
+    bool loadUnManagedTexture(unsigned int & texID, sgct_core::Image * imgPtr, bool interpolate, int mipmapLevels = 8);
+    bool loadTiledTexture(const std::string name, const std::string filename, bool interpolate, std::size_t tileBudget = 16);
+
+    /*!
+        Sets the maximum number of streamed tiles that are uploaded per frame. Default is 4.
+    */
+    void setStreamingUploadLimit(std::size_t tilesPerFrame) { mStreamingUploadLimit = tilesPerFrame > 0 ? tilesPerFrame : 1; }
+    bool isStreaming(const std::string name);
+
+    void setResidencyBudget(std::size_t bytes);
+
+    /*!
+        Sets the maximum number of bytes uploaded per frame when evicted textures are reloaded. Default is 8 MB.
+    */
+    void setUploadBudget(std::size_t bytesPerFrame) { mUploadBudget = bytesPerFrame > 0 ? bytesPerFrame : 1; }
+    std::size_t getResidentBytes();
+    void update();
 
 private:
     TextureManager();
     ~TextureManager();
     bool updateTexture(const std::string & name, unsigned int * texPtr, bool * reload);
     bool uploadImage(sgct_core::Image * imgPtr, unsigned int * texPtr);
+    bool loadImageFile(const std::string & filename, unsigned int * texPtr, sgct_core::TextureData & texData);
+    bool uploadCompressedTexture(const sgct_core::CompressedTexture & texture, unsigned int * texPtr);
+    bool getFormats(std::size_t channels, std::size_t bpc, bool isBGR, CompressionMode cm, int & textureType, int & internalFormat);
+    void stopStreaming(const std::string & name);
+    void uploadStreamedTiles();
+
+    void requestReload(const std::string & name, sgct_core::TextureData & texData);
+    void cancelReload(const std::string & name);
+    void uploadReloadedTextures();
+    bool uploadReloadChunk(std::size_t & budget);
+    void evictTextures();
+    unsigned int getPlaceholderId();
+    bool useCompressionCache();
 
     void freeTextureData();
 
@@ -109,6 +154,24 @@ private:
     sgct_cppxeleven::unordered_map<std::string, sgct_core::TextureData> mTextures;
     int mMipmapLevels;
     int mWarpMode[2];
+    std::vector<sgct_core::TiledTextureStream *> mStreams;
+    std::size_t mStreamingUploadLimit;
+    std::string mCompressionCacheDirectory;
+
+    struct ReloadUpload
+    {
+        sgct_core::AsyncTextureLoader::Result * mResultPtr;
+        unsigned int mTexId;
+        std::size_t mLevel;
+        std::size_t mRow;
+    };
+
+    sgct_core::AsyncTextureLoader * mLoaderPtr;
+    ReloadUpload * mActiveUploadPtr;
+    std::size_t mResidencyBudget;
+    std::size_t mUploadBudget;
+    unsigned long long mFrame;
+    unsigned int mPlaceholderId;
 };
 
 }
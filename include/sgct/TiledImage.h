@@ -0,0 +1,100 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _TILED_IMAGE_H_
+#define _TILED_IMAGE_H_
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <mutex>
+
+namespace sgct_core
+{
+
+class Image;
+
+/*!
+    Tiled and mip-mapped on-disk image (*.sgcttile). Each mip level is split into square tiles
+    that are stored individually (raw or zlib deflated) and located through an index table
+    right after the header, so that a single tile, a tile range or a whole mip level can be
+    read without touching the rest of the file. Pixel rows are stored bottom-up like in Image.
+
+    Layout (native byte order, little endian on all supported platforms):
+    - header: magic "SGCTTILE", version, width, height, channels, bytes per channel, tile size, levels, flags
+    - index: for each level (finest first) and each tile (row major, bottom-up): offset (64-bit), stored size, encoding
+    - tile data
+*/
+class TiledImage
+{
+public:
+    enum TileEncoding { Tile_Raw = 0, Tile_Deflate };
+
+    struct TileInfo
+    {
+        unsigned long long mOffset;
+        unsigned int mStoredSize;
+        unsigned int mEncoding;
+    };
+
+    TiledImage();
+    ~TiledImage();
+
+    static bool convert(Image & src, const std::string & filename, std::size_t tileSize = 256, bool compress = true);
+
+    bool open(const std::string & filename);
+    void close();
+    bool isOpen() const;
+
+    bool readTile(std::size_t level, std::size_t tileX, std::size_t tileY, std::vector<unsigned char> & buffer);
+    bool loadLevel(std::size_t level, Image & img);
+    bool loadRegion(std::size_t level, std::size_t firstTileX, std::size_t firstTileY, std::size_t lastTileX, std::size_t lastTileY, Image & img);
+
+    inline std::size_t getWidth(std::size_t level = 0) const { return levelSize(mWidth, level); }
+    inline std::size_t getHeight(std::size_t level = 0) const { return levelSize(mHeight, level); }
+    inline std::size_t getChannels() const { return mChannels; }
+    inline std::size_t getBytesPerChannel() const { return mBytesPerChannel; }
+    inline std::size_t getTileSize() const { return mTileSize; }
+    inline std::size_t getNumberOfLevels() const { return mLevels.size(); }
+    inline bool getPreferBGR() const { return mPreferBGR; }
+    std::size_t getTilesX(std::size_t level) const;
+    std::size_t getTilesY(std::size_t level) const;
+    void getTileRect(std::size_t level, std::size_t tileX, std::size_t tileY, std::size_t & x, std::size_t & y, std::size_t & width, std::size_t & height) const;
+    inline const std::string & getFilename() const { return mFilename; }
+
+private:
+    static inline std::size_t levelSize(std::size_t size, std::size_t level) { size >>= level; return size > 0 ? size : 1; }
+    static void downsample(const unsigned char * src, std::size_t srcWidth, std::size_t srcHeight,
+        unsigned char * dst, std::size_t channels, std::size_t bpc);
+
+    TiledImage(const TiledImage & ti) = delete;
+    const TiledImage & operator=(const TiledImage & rhs) = delete;
+
+private:
+    struct LevelInfo
+    {
+        std::size_t mTilesX;
+        std::size_t mTilesY;
+        std::vector<TileInfo> mTiles;
+    };
+
+    FILE * mFile;
+    std::string mFilename;
+    std::size_t mWidth;
+    std::size_t mHeight;
+    std::size_t mChannels;
+    std::size_t mBytesPerChannel;
+    std::size_t mTileSize;
+    bool mPreferBGR;
+    std::vector<LevelInfo> mLevels;
+    std::vector<unsigned char> mReadBuffer;
+    std::mutex mMutex;
+};
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _TILED_TEXTURE_STREAM_H_
+#define _TILED_TEXTURE_STREAM_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+#include "TiledImage.h"
+
+namespace sgct_core
+{
+
+/*!
+    Background reader for a tiled image. Tiles are read coarse to fine on a worker thread and queued
+    until the render thread uploads them. At most tileBudget decoded tiles are kept in memory.
+*/
+class TiledTextureStream
+{
+public:
+    struct Tile
+    {
+        std::size_t mLevel;
+        std::size_t mX;
+        std::size_t mY;
+        std::size_t mWidth;
+        std::size_t mHeight;
+        std::vector<unsigned char> mData;
+    };
+
+    TiledTextureStream(const std::string & name, unsigned int texId, std::size_t tileBudget);
+    ~TiledTextureStream();
+
+    void start(std::size_t firstLevel);
+    void stop();
+    bool popTile(Tile & tile);
+    bool tileUploaded(std::size_t level);
+    bool isDone();
+    bool hasFailed() const { return mFailed; }
+
+    inline TiledImage & getImage() { return mImage; }
+    inline const std::string & getName() const { return mName; }
+    inline unsigned int getTextureId() const { return mTexId; }
+    inline void setTextureId(unsigned int texId) { mTexId = texId; }
+
+private:
+    void readTiles(std::size_t firstLevel);
+
+    TiledTextureStream(const TiledTextureStream & tts) = delete;
+    const TiledTextureStream & operator=(const TiledTextureStream & rhs) = delete;
+
+private:
+    std::string mName;
+    unsigned int mTexId;
+    std::size_t mTileBudget;
+    TiledImage mImage;
+    std::vector<std::size_t> mPendingTiles; //per level, only touched by the render thread
+
+    std::thread * mThreadPtr;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<Tile> mQueue;
+    std::atomic<bool> mRunning;
+    std::atomic<bool> mFailed;
+    bool mReaderDone;
+};
+
+}
+
+#endif
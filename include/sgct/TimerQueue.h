@@ -0,0 +1,66 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _TIMER_QUEUE_H_
+#define _TIMER_QUEUE_H_
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace sgct_core
+{
+
+/*!
+    Repeating timers kept in a binary min-heap ordered by when they are due next. Adding and removing a timer is
+    O(log n) and finding the expired ones is O(log n) per expired timer, so a frame only pays for the timers that
+    fire instead of scanning all of them.
+
+    A timer is due when the time is past its last firing plus the interval. When it fires it is rescheduled one
+    interval from the time it fired, so a timer fires at most once per call to popExpired. The class is not thread safe.
+*/
+class TimerQueue
+{
+public:
+    typedef void (*Callback)(std::size_t);
+
+    TimerQueue();
+
+    void add(std::size_t id, double interval, double time, Callback fn);
+    bool remove(std::size_t id);
+    bool contains(std::size_t id) const;
+    Callback getCallback(std::size_t id) const;
+    void popExpired(double time, std::vector<std::size_t> & ids);
+    void clear();
+
+    //! \returns the number of timers
+    std::size_t size() const { return mHeap.size(); }
+
+private:
+    struct Timer
+    {
+        std::size_t mId;
+        double mInterval;
+        double mDue;
+        Callback mCallback;
+        std::size_t mHeapIndex;
+    };
+
+    void siftUp(std::size_t index);
+    void siftDown(std::size_t index);
+    void swap(std::size_t a, std::size_t b);
+    bool isEarlier(std::size_t a, std::size_t b) const { return mTimers[mHeap[a]].mDue < mTimers[mHeap[b]].mDue; }
+
+    std::vector<Timer> mTimers; //slots, the slots of removed timers are reused
+    std::vector<std::size_t> mFreeSlots;
+    std::vector<std::size_t> mHeap; //slots ordered by when they are due
+    std::unordered_map<std::size_t, std::size_t> mSlots; //timer id to slot
+};
+
+}
+
+#endif
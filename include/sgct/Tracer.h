@@ -0,0 +1,160 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _TRACER_H_
+#define _TRACER_H_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <set>
+#include <cstddef>
+
+namespace sgct_core
+{
+
+/*!
+    Records timed zones of the render loop for offline inspection. Every thread records into its own ring of
+    events without locking, the ring keeps the latest events when it is full. The events are exported as a
+    Chrome trace (JSON), which chrome://tracing and the Perfetto UI open.
+
+    Events that aren't timed by the recording thread, like GPU times that are read back later, are recorded on
+    named tracks that are shown as threads of their own.
+
+    Slaves can serialize their events and send them to the master, which merges them into its trace with the
+    times moved to the master clock, so that a whole cluster frame is shown in one timeline.
+
+    Zone names must be string literals or otherwise outlive the tracer, only the pointer is stored.
+*/
+class Tracer
+{
+public:
+    struct Event
+    {
+        const char * mName;
+        double mStart; //seconds
+        float mDuration; //seconds
+        int mArgument; //window, viewport or face index, -1 if none
+    };
+
+    //! A ring of events with one writer, the events of a thread or of a track
+    struct ThreadBuffer
+    {
+        std::vector<Event> mEvents;
+        std::atomic<std::size_t> mCount; //events ever recorded, only written by the owner
+        std::atomic<bool> mWriting;
+        unsigned int mThreadId;
+        std::string mName;
+    };
+
+    /*! Get the Tracer instance */
+    static Tracer * instance()
+    {
+        if (mInstance == nullptr)
+            mInstance = new Tracer();
+        return mInstance;
+    }
+
+    /*! Destroy the Tracer */
+    static void destroy()
+    {
+        if (mInstance != nullptr)
+        {
+            delete mInstance;
+            mInstance = nullptr;
+        }
+    }
+
+    //! \returns true if zones are recorded, cheap enough to call for every zone
+    static inline bool isEnabled() { return mEnabled.load(std::memory_order_relaxed); }
+    static double getTime();
+
+    void setEnabled(bool state);
+    void setEventsPerThread(std::size_t numberOfEvents);
+    void setThreadName(const char * name);
+    void setNode(int nodeId, const std::string & name);
+    void record(const char * name, double start, double end, int argument = -1);
+    ThreadBuffer * getTrack(const char * name);
+    void record(ThreadBuffer * track, const char * name, double start, double end, int argument = -1);
+    unsigned long long getNumberOfDroppedEvents();
+
+    void serialize(std::vector<char> & buffer, double requestTime);
+    bool addRemoteTrace(const char * data, std::size_t size, double requestTime, double receiveTime);
+    void clearRemoteTraces();
+    bool exportChromeTrace(const std::string & filename);
+
+private:
+    Tracer();
+    ~Tracer();
+
+    Tracer(const Tracer & rhs) = delete;
+    const Tracer & operator=(const Tracer & rhs) = delete;
+
+    struct ThreadTrace
+    {
+        unsigned int mThreadId;
+        std::string mName;
+        std::vector<Event> mEvents;
+    };
+
+    struct NodeTrace
+    {
+        int mNodeId;
+        std::string mName;
+        std::vector<ThreadTrace> mThreads;
+    };
+
+    ThreadBuffer * getThreadBuffer();
+    ThreadBuffer * createBuffer();
+    void snapshot(NodeTrace & trace);
+
+    static Tracer * mInstance;
+    static std::atomic<bool> mEnabled;
+    static std::atomic<unsigned int> mGeneration; //tells thread local buffer pointers of a destroyed tracer apart
+
+    std::mutex mBuffersMutex;
+    std::vector<ThreadBuffer *> mBuffers;
+    std::vector<ThreadBuffer *> mTracks; //also in mBuffers
+    std::atomic<bool> mPaused;
+    std::atomic<unsigned long long> mDroppedEvents;
+    std::size_t mEventsPerThread;
+    int mNodeId;
+    std::string mNodeName;
+
+    std::mutex mRemoteMutex;
+    std::vector<NodeTrace> mRemoteTraces;
+    std::set<std::string> mRemoteNames; //zone names of the remote events, the elements never move
+};
+
+/*!
+    Records a zone from construction to destruction if tracing is enabled.
+*/
+class TraceZone
+{
+public:
+    explicit TraceZone(const char * name, int argument = -1)
+        : mName(name), mArgument(argument), mStart(Tracer::isEnabled() ? Tracer::getTime() : -1.0) {}
+
+    ~TraceZone()
+    {
+        if (mStart >= 0.0)
+            Tracer::instance()->record(mName, mStart, Tracer::getTime(), mArgument);
+    }
+
+private:
+    TraceZone(const TraceZone & rhs) = delete;
+    const TraceZone & operator=(const TraceZone & rhs) = delete;
+
+    const char * mName;
+    int mArgument;
+    double mStart;
+};
+
+}
+
+#endif
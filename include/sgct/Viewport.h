@@ -14,6 +14,8 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #include <glm/gtc/quaternion.hpp>
 #include <string>
 #include "CorrectionMesh.h"
+#include "Image.h"
+#include "MpcdiWarpGrid.h"
 #include <stddef.h> //get definition for NULL
 
 #define TIXML_USE_STL //needed for tinyXML lib to link properly in mingw
@@ -54,6 +56,9 @@ struct FrustumData {
 class Viewport : public BaseViewport
 {
 public:
+    //! Files loaded by loadData, in the order they are uploaded
+    enum DataType { OVERLAY_DATA = 0, BLEND_MASK_DATA, BLACK_LEVEL_MASK_DATA, CORRECTION_MESH_DATA, NUMBER_OF_DATA_TYPES };
+
     Viewport();
     Viewport(float x, float y, float xSize, float ySize);
     virtual ~Viewport() override;
@@ -64,11 +69,21 @@ public:
     void setBlendMaskTexture(const char * texturePath);
     void setBlackLevelMaskTexture(const char * texturePath);
     void setCorrectionMesh(const char * meshPath);
-    void setMpcdiWarpMesh(const char* meshData, size_t size);
+    void setMpcdiWarpGrid(MpcdiWarpGrid & grid);
+    void setMpcdiMask(DataType type, Image * imgPtr, const std::string & name);
     void setTracked(bool state);
+    void setUseWarpLookup(bool state);
+    void setFitFrustumToMesh(bool state);
+    bool hasData(DataType type);
+    std::string getDataPath(DataType type);
+    bool prepareData(DataType type, float windowAspectRatio, const glm::ivec2 & framebufferResolution);
     void loadData();
+    bool isDataChanged(DataType type);
+    bool prepareReload(DataType type, float windowAspectRatio, const glm::ivec2 & framebufferResolution);
+    bool applyReload();
 
     void renderMesh(CorrectionMesh::MeshType mt);
+    void updateFrustums(float nearClippingPlane, float farClippingPlane);
 
     inline bool hasOverlayTexture() { return mOverlayTextureIndex != GL_FALSE; }
     inline bool hasBlendMaskTexture() { return mBlendMaskTextureIndex != GL_FALSE; }
@@ -77,14 +92,23 @@ public:
 
     inline const bool & hasCorrectionMesh() { return mCorrectionMesh; }
     inline const bool & isTracked() { return mTracked; }
+    //! \returns true if the warp mesh should be baked into a lookup texture
+    inline bool getUseWarpLookup() const { return mUseWarpLookup; }
+    //! \returns true if the frustum of a mesh with a view plane should be fitted to the part of the image the mesh uses
+    inline bool getFitFrustumToMesh() const { return mFitFrustumToMesh; }
+    inline bool hasWarpLookupTexture() const { return mCM.hasLookupTexture(); }
+    inline unsigned int getWarpLookupTextureIndex() const { return mCM.getLookupTexture(); }
     inline const unsigned int & getOverlayTextureIndex() { return mOverlayTextureIndex; }
     inline const unsigned int & getBlendMaskTextureIndex() { return mBlendMaskTextureIndex; }
     inline const unsigned int & getBlackLevelMaskTextureIndex() { return mBlackLevelMaskTextureIndex; }
     inline CorrectionMesh * getCorrectionMeshPtr() { return &mCM; }
     inline NonLinearProjection * getNonLinearProjectionPtr() { return mNonLinearProjection; }
-
-    char* mMpcdiWarpMeshData = nullptr;
-    size_t mMpcdiWarpMeshSize = 0;
+    inline bool hasMpcdiWarpGrid() const { return !mMpcdiWarpGrid.isEmpty(); }
+    inline const MpcdiWarpGrid & getMpcdiWarpGrid() const { return mMpcdiWarpGrid; }
+    //! \returns true if the data comes from an .mpcdi package, it has no file of its own then
+    inline bool isMpcdiData(DataType type) const { return type == CORRECTION_MESH_DATA ? hasMpcdiWarpGrid() : mMpcdiMasks[type]; }
+    //! \returns the time in seconds loadData spent on uploading the data
+    inline double getDataUploadTime(DataType type) { return mDataUploadTimes[type]; }
 
 private:
     void reset(float x, float y, float xSize, float ySize);
@@ -96,6 +120,7 @@ private:
                                  float& target);
     bool parseFrustumElement(FrustumData& frustum, FrustumData::elemIdx elemIndex,
         tinyxml2::XMLElement* elem, const char* frustumTag);
+    bool getDataStamp(DataType type, unsigned long long stamp[2]);
 
 private:
     CorrectionMesh mCM;
@@ -106,11 +131,26 @@ private:
     std::string mMeshHint;
     bool mCorrectionMesh;
     bool mTracked;
-    bool mIsMeshStoredInFile = false;
+    bool mUseWarpLookup;
+    bool mFitFrustumToMesh;
     unsigned int mOverlayTextureIndex;
     unsigned int mBlendMaskTextureIndex;
     unsigned int mBlackLevelMaskTextureIndex;
 
+    //decoded masks and parsed mesh waiting for loadData
+    Image * mPreparedImages[CORRECTION_MESH_DATA];
+    bool mDataPrepared[NUMBER_OF_DATA_TYPES];
+    bool mMpcdiMasks[CORRECTION_MESH_DATA]; //set for the masks decoded from an .mpcdi package
+    bool mPreparedMeshStatus;
+    double mDataUploadTimes[NUMBER_OF_DATA_TYPES];
+
+    //data reloaded in the background waiting for applyReload
+    CorrectionMesh * mReloadMeshPtr;
+    Image * mReloadImages[CORRECTION_MESH_DATA];
+    unsigned long long mDataStamps[NUMBER_OF_DATA_TYPES][2]; //modification time and size of the loaded files
+    unsigned long long mReloadStamps[NUMBER_OF_DATA_TYPES][2];
+    MpcdiWarpGrid mMpcdiWarpGrid;
+
     NonLinearProjection * mNonLinearProjection;
 };
 
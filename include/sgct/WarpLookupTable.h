@@ -0,0 +1,67 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _WARP_LOOKUP_TABLE_H_
+#define _WARP_LOOKUP_TABLE_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+namespace sgct_core
+{
+
+struct CorrectionMeshVertex;
+
+/*!
+    A warping mesh rasterized into a float image with one texel per framebuffer pixel of the viewport. A texel
+    holds the interpolated texture coordinate, intensity and alpha of the mesh at the pixel center (s, t, i, a)
+    and is zero where the mesh doesn't cover the pixel. Warping is then a single dependent texture fetch per
+    pixel instead of rasterizing the mesh every frame, which is cheaper for very dense meshes.
+
+    The table is baked on the CPU by several threads and has no OpenGL dependencies. Tables can be stored on disk
+    (*.sgctlut) like compiled meshes, keyed by the source mesh and a hash of the parameters.
+
+    Only meshes with gray vertex colors can be baked, since the color is stored as a single intensity.
+*/
+class WarpLookupTable
+{
+public:
+    WarpLookupTable();
+
+    bool bake(const CorrectionMeshVertex * vertices, unsigned int numberOfVertices, const unsigned int * indices, unsigned int numberOfIndices,
+        bool triangleStrip, const glm::vec4 & area, int width, int height, std::size_t numberOfThreads = 0);
+    void clear();
+    void swap(WarpLookupTable & other);
+
+    bool load(const std::string & filename, const std::string & source, unsigned long long parameterHash);
+    bool store(const std::string & filename, const std::string & source, unsigned long long parameterHash) const;
+    static std::string getCacheFilename(const std::string & cacheDirectory, const std::string & source, unsigned long long parameterHash);
+
+    //! \returns true if the table has no texels
+    inline bool isEmpty() const { return mData.empty(); }
+    inline int getWidth() const { return mWidth; }
+    inline int getHeight() const { return mHeight; }
+    //! \returns the texels as four floats per texel, the first row is the bottom one
+    inline const float * getData() const { return mData.data(); }
+    //! \returns the number of texels covered by the mesh
+    inline std::size_t getNumberOfCoveredTexels() const { return mCoveredTexels; }
+
+private:
+    void bakeRows(const CorrectionMeshVertex * vertices, const unsigned int * indices, unsigned int numberOfTriangles, bool triangleStrip,
+        const glm::vec4 & area, int firstRow, int lastRow, std::size_t * coveredTexels);
+
+    std::vector<float> mData;
+    int mWidth;
+    int mHeight;
+    std::size_t mCoveredTexels;
+};
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _SGCT_FILE_FUNCTIONS
+#define _SGCT_FILE_FUNCTIONS
+
+#include <string>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+namespace sgct_helpers
+{
+
+/*!
+    Get the modification time (seconds since epoch) and size in bytes of a file.
+    \returns false if the file doesn't exist
+*/
+inline bool getFileInfo(const std::string & path, unsigned long long & mtime, unsigned long long & size)
+{
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    struct __stat64 info;
+    if (_stat64(path.c_str(), &info) != 0)
+        return false;
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+        return false;
+#endif
+    mtime = static_cast<unsigned long long>(info.st_mtime);
+    size = static_cast<unsigned long long>(info.st_size);
+    return true;
+}
+
+/*!
+    64-bit FNV-1a hash. Pass the previous result as hash to continue hashing more data.
+*/
+inline unsigned long long hashFNV1a(const void * data, std::size_t length, unsigned long long hash = 14695981039346656037ULL)
+{
+    const unsigned char * bytes = reinterpret_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*!
+    Rename src to dst, replacing dst if it exists. Used to publish a file that was written under a temporary name
+    so that readers (possibly on other nodes sharing the directory) never see a partially written file.
+*/
+inline bool replaceFile(const std::string & src, const std::string & dst)
+{
+    if (rename(src.c_str(), dst.c_str()) == 0)
+        return true;
+
+    //windows doesn't replace existing files
+    remove(dst.c_str());
+    return rename(src.c_str(), dst.c_str()) == 0;
+}
+
+}
+
+#endif
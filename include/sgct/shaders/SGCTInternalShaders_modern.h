@@ -76,6 +76,24 @@ namespace sgct_core
                 Color = texture(Tex, UV);\n\
             }\n";
 
+        //the lookup texture holds the warped texture coordinate, intensity and alpha of each pixel of the viewport
+        const std::string Warp_Lookup_Frag_Shader = "\
+            **glsl_version**\n\
+            \n\
+            in vec2 UV;\n\
+            in vec4 Col;\n\
+            out vec4 Color;\n\
+            \n\
+            uniform sampler2D Tex;\n\
+            uniform sampler2D LookupTex;\n\
+            uniform vec4 LookupRect;\n\
+            \n\
+            void main()\n\
+            {\n\
+                vec4 lookup = texture(LookupTex, (UV - LookupRect.xy) / LookupRect.zw);\n\
+                Color = Col * vec4(lookup.zzz, lookup.w) * texture(Tex, lookup.xy);\n\
+            }\n";
+
         const std::string Anaglyph_Vert_Shader = "\
             **glsl_version**\n\
             \n\
@@ -0,0 +1,381 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include "SGCTBench.h"
+#include <sgct.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__WIN32__)
+    #include <process.h>
+#else
+    #include <sys/types.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+/*
+    Usage: sgct_cluster_sim [--nodes <n>] [--frames <n>] [--payload <bytes>] [--draw <ms>] [--latency <ms>]
+                            [--bandwidth <Mbit/s>] [--stall <node>:<every n frames>:<ms>] [--port <port>]
+                            [--json <file>]
+
+    Runs a master and n - 1 slaves as local processes on loopback ports, without windows, using the --Simulate
+    mode of the Engine. Every node runs the real sync path, shared data encode and decode, frame lock and
+    acknowledges, while the draw is replaced by a sleep. The master sends a payload of the given size each frame
+    and the slaves check that they decode the frames in order and intact.
+
+    --latency and --bandwidth impair every sync connection on the receiving side
+    --stall makes one node stall its draw every n:th frame, to see how a slow node holds back the cluster
+    --json writes the frame, draw and sync times of the master in the JSON format of Google Benchmark
+
+    The nodes are started as "sgct_cluster_sim --node <id> ..." and exit when all frames are rendered.
+*/
+namespace
+{
+    struct Options
+    {
+        Options() : mNodes(2), mFrames(600), mPayload(4096), mDrawTime(5.0), mLatency(0.0), mBandwidth(0.0),
+            mStallNode(-1), mStallInterval(0), mStallDuration(0.0), mPort(20400) {}
+
+        unsigned int mNodes;
+        unsigned int mFrames;
+        unsigned int mPayload;
+        double mDrawTime;
+        double mLatency;
+        double mBandwidth;
+        int mStallNode;
+        unsigned int mStallInterval;
+        double mStallDuration;
+        unsigned int mPort;
+        std::string mJSONPath;
+    };
+
+    const char * ConfigPath = "sgct_cluster_sim.xml";
+
+    sgct::SharedUInt32 gFrame(0);
+    sgct::SharedVector<unsigned char> gPayload;
+    uint32_t gNextFrame = 0;
+    unsigned long long gDecodeErrors = 0;
+    unsigned long long gSkippedFrames = 0;
+
+    unsigned char payloadByte(uint32_t frame, std::size_t i)
+    {
+        return static_cast<unsigned char>((frame * 31 + i) & 0xFF);
+    }
+
+    void preSync()
+    {
+        if (!sgct::Engine::instance()->isMaster())
+            return;
+
+        uint32_t frame = gNextFrame++;
+        std::vector<unsigned char> payload = gPayload.getVal();
+        for (std::size_t i = 0; i < payload.size(); i++)
+            payload[i] = payloadByte(frame, i);
+        gFrame.setVal(frame);
+        gPayload.setVal(payload);
+    }
+
+    void postSyncPreDraw()
+    {
+        if (sgct::Engine::instance()->isMaster())
+            return;
+
+        uint32_t frame = gFrame.getVal();
+        if (frame != gNextFrame)
+            gSkippedFrames++;
+        gNextFrame = frame + 1;
+
+        std::vector<unsigned char> payload = gPayload.getVal();
+        for (std::size_t i = 0; i < payload.size(); i++)
+            if (payload[i] != payloadByte(frame, i))
+            {
+                gDecodeErrors++;
+                break;
+            }
+    }
+
+    void encode()
+    {
+        sgct::SharedData::instance()->writeUInt32(&gFrame);
+        sgct::SharedData::instance()->writeVector(&gPayload);
+    }
+
+    void decode()
+    {
+        sgct::SharedData::instance()->readUInt32(&gFrame);
+        sgct::SharedData::instance()->readVector(&gPayload);
+    }
+
+    bool writeConfig(const Options & opt)
+    {
+        FILE * file = fopen(ConfigPath, "wb");
+        if (file == nullptr)
+        {
+            fprintf(stderr, "Failed to create '%s'!\n", ConfigPath);
+            return false;
+        }
+
+        fprintf(file, "<?xml version=\"1.0\" ?>\n");
+        fprintf(file, "<Cluster masterAddress=\"127.0.0.1\">\n");
+        for (unsigned int i = 0; i < opt.mNodes; i++)
+        {
+            fprintf(file, "\t<Node address=\"127.0.0.1\" port=\"%u\">\n", opt.mPort + i);
+            fprintf(file, "\t\t<Window fullScreen=\"false\">\n");
+            fprintf(file, "\t\t\t<Size x=\"640\" y=\"360\" />\n");
+            fprintf(file, "\t\t\t<Viewport>\n");
+            fprintf(file, "\t\t\t\t<Pos x=\"0.0\" y=\"0.0\" />\n");
+            fprintf(file, "\t\t\t\t<Size x=\"1.0\" y=\"1.0\" />\n");
+            fprintf(file, "\t\t\t\t<Projectionplane>\n");
+            fprintf(file, "\t\t\t\t\t<Pos x=\"-1.778\" y=\"-1.0\" z=\"0.0\" />\n");
+            fprintf(file, "\t\t\t\t\t<Pos x=\"-1.778\" y=\"1.0\" z=\"0.0\" />\n");
+            fprintf(file, "\t\t\t\t\t<Pos x=\"1.778\" y=\"1.0\" z=\"0.0\" />\n");
+            fprintf(file, "\t\t\t\t</Projectionplane>\n");
+            fprintf(file, "\t\t\t</Viewport>\n");
+            fprintf(file, "\t\t</Window>\n");
+            fprintf(file, "\t</Node>\n");
+        }
+        fprintf(file, "\t<User eyeSeparation=\"0.06\">\n");
+        fprintf(file, "\t\t<Pos x=\"0.0\" y=\"0.0\" z=\"4.0\" />\n");
+        fprintf(file, "\t</User>\n");
+        fprintf(file, "</Cluster>\n");
+        fclose(file);
+        return true;
+    }
+
+    sgct_bench::BenchResult toResult(const std::string & name, const sgct_core::Statistics::Percentiles & p, std::size_t frames)
+    {
+        sgct_bench::BenchResult res;
+        res.mName = name;
+        res.mIterations = frames;
+        res.mSecondsPerIteration = p.mAvg;
+        res.mCPUSecondsPerIteration = p.mAvg;
+        res.mBytesPerSecond = 0.0;
+        res.mCounters.push_back(std::make_pair(std::string("p50_ms"), p.mP50 * 1000.0));
+        res.mCounters.push_back(std::make_pair(std::string("p95_ms"), p.mP95 * 1000.0));
+        res.mCounters.push_back(std::make_pair(std::string("p99_ms"), p.mP99 * 1000.0));
+        res.mCounters.push_back(std::make_pair(std::string("max_ms"), p.mMax * 1000.0));
+        return res;
+    }
+
+    void printPercentiles(const char * name, const sgct_core::Statistics::Percentiles & p)
+    {
+        fprintf(stdout, "%-6s avg %8.3f ms  p50 %8.3f ms  p95 %8.3f ms  p99 %8.3f ms  max %8.3f ms\n", name,
+            p.mAvg * 1000.0, p.mP50 * 1000.0, p.mP95 * 1000.0, p.mP99 * 1000.0, p.mMax * 1000.0);
+    }
+
+    /*
+        Runs one simulated node in this process.
+    */
+    int runNode(unsigned int nodeId, const Options & opt, const char * executable)
+    {
+        std::vector<std::string> args;
+        args.push_back(executable);
+        args.push_back("-config");
+        args.push_back(ConfigPath);
+        args.push_back("-local");
+        args.push_back(std::to_string(nodeId));
+        if (nodeId > 0)
+            args.push_back("--slave");
+        args.push_back("--Simulate");
+        args.push_back("-simDrawTime");
+        args.push_back(std::to_string(opt.mDrawTime));
+        args.push_back("-simFrames");
+        args.push_back(std::to_string(opt.mFrames));
+        args.push_back("-statsWindow");
+        args.push_back(std::to_string(opt.mFrames));
+        if (opt.mLatency > 0.0)
+        {
+            args.push_back("-simLatency");
+            args.push_back(std::to_string(opt.mLatency));
+        }
+        if (opt.mBandwidth > 0.0)
+        {
+            args.push_back("-simBandwidth");
+            args.push_back(std::to_string(opt.mBandwidth));
+        }
+        if (opt.mStallNode == static_cast<int>(nodeId) && opt.mStallInterval > 0)
+        {
+            args.push_back("-simStall");
+            args.push_back(std::to_string(opt.mStallInterval));
+            args.push_back(std::to_string(opt.mStallDuration));
+        }
+        args.push_back("-notify");
+        args.push_back("1");
+
+        std::vector<char *> argv;
+        for (std::size_t i = 0; i < args.size(); i++)
+            argv.push_back(&args[i][0]);
+        argv.push_back(nullptr);
+        int argc = static_cast<int>(args.size());
+        char ** argvPtr = argv.data();
+
+        gPayload.setVal(std::vector<unsigned char>(opt.mPayload, 0));
+
+        sgct::Engine * engine = new sgct::Engine(argc, argvPtr);
+        engine->setPreSyncFunction(preSync);
+        engine->setPostSyncPreDrawFunction(postSyncPreDraw);
+        sgct::SharedData::instance()->setEncodeFunction(encode);
+        sgct::SharedData::instance()->setDecodeFunction(decode);
+
+        if (!engine->init())
+        {
+            delete engine;
+            return EXIT_FAILURE;
+        }
+
+        engine->render();
+
+        int result = EXIT_SUCCESS;
+        if (engine->isMaster())
+        {
+            sgct_core::Statistics::Report report = engine->getStatisticsReport();
+            fprintf(stdout, "\n%u nodes, %llu frames, %u byte payload, %.2f ms draw, %.3f ms latency, %.1f Mbit/s\n",
+                opt.mNodes, report.mNumberOfFrames, opt.mPayload, opt.mDrawTime, opt.mLatency, opt.mBandwidth);
+            printPercentiles("frame", report.mFrameTime);
+            printPercentiles("draw", report.mDrawTime);
+            printPercentiles("sync", report.mSyncTime);
+            fprintf(stdout, "%.1f fps, %llu dropped frames\n", report.mAvgFPS, report.mDroppedFrames);
+
+            if (!opt.mJSONPath.empty())
+            {
+                std::string base = "ClusterSim/" + std::to_string(opt.mNodes) + "nodes/" + std::to_string(opt.mPayload) + "B";
+                std::size_t frames = report.mWindowFrames;
+                sgct_bench::BenchRunner runner;
+                runner.addResult(toResult(base + "/frame", report.mFrameTime, frames));
+                runner.addResult(toResult(base + "/draw", report.mDrawTime, frames));
+                runner.addResult(toResult(base + "/sync", report.mSyncTime, frames));
+                if (!sgct_bench::writeJSONReport(opt.mJSONPath, runner, executable))
+                    result = EXIT_FAILURE;
+            }
+        }
+        else if (gDecodeErrors > 0 || gSkippedFrames > 0)
+        {
+            fprintf(stderr, "Node %u: %llu corrupt and %llu skipped frames!\n", nodeId, gDecodeErrors, gSkippedFrames);
+            result = EXIT_FAILURE;
+        }
+
+        delete engine;
+        return result;
+    }
+
+#if defined(__WIN32__)
+    typedef intptr_t NodeProcess;
+#else
+    typedef pid_t NodeProcess;
+#endif
+
+    bool startNode(const std::vector<std::string> & args, NodeProcess & process)
+    {
+        std::vector<char *> argv;
+        for (std::size_t i = 0; i < args.size(); i++)
+            argv.push_back(const_cast<char *>(args[i].c_str()));
+        argv.push_back(nullptr);
+
+#if defined(__WIN32__)
+        process = _spawnv(_P_NOWAIT, argv[0], argv.data());
+        return process != -1;
+#else
+        process = fork();
+        if (process == 0)
+        {
+            execvp(argv[0], argv.data());
+            fprintf(stderr, "Failed to start '%s'!\n", argv[0]);
+            _exit(EXIT_FAILURE);
+        }
+        return process > 0;
+#endif
+    }
+
+    bool waitForNode(NodeProcess process)
+    {
+        int status = 0;
+#if defined(__WIN32__)
+        if (_cwait(&status, process, _WAIT_CHILD) == -1)
+            return false;
+        return status == EXIT_SUCCESS;
+#else
+        if (waitpid(process, &status, 0) != process)
+            return false;
+        return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+#endif
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    Options opt;
+    int nodeId = -1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--node") == 0 && i + 1 < argc)
+            nodeId = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--nodes") == 0 && i + 1 < argc)
+            opt.mNodes = static_cast<unsigned int>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            opt.mFrames = static_cast<unsigned int>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--payload") == 0 && i + 1 < argc)
+            opt.mPayload = static_cast<unsigned int>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--draw") == 0 && i + 1 < argc)
+            opt.mDrawTime = atof(argv[++i]);
+        else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc)
+            opt.mLatency = atof(argv[++i]);
+        else if (strcmp(argv[i], "--bandwidth") == 0 && i + 1 < argc)
+            opt.mBandwidth = atof(argv[++i]);
+        else if (strcmp(argv[i], "--stall") == 0 && i + 1 < argc)
+        {
+            if (sscanf(argv[++i], "%d:%u:%lf", &opt.mStallNode, &opt.mStallInterval, &opt.mStallDuration) != 3)
+                fprintf(stderr, "Ignoring --stall, expected <node>:<every n frames>:<ms>\n");
+        }
+        else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+            opt.mPort = static_cast<unsigned int>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            opt.mJSONPath.assign(argv[++i]);
+    }
+
+    if (opt.mNodes < 1 || opt.mFrames < 1)
+    {
+        fprintf(stderr, "At least one node and one frame is needed!\n");
+        return EXIT_FAILURE;
+    }
+
+    if (nodeId >= 0)
+        return runNode(static_cast<unsigned int>(nodeId), opt, argv[0]);
+
+    if (!writeConfig(opt))
+        return EXIT_FAILURE;
+
+    //the nodes get the same options and their id
+    std::vector<NodeProcess> processes;
+    bool success = true;
+    for (unsigned int i = 0; i < opt.mNodes && success; i++)
+    {
+        std::vector<std::string> args(argv, argv + argc);
+        args.push_back("--node");
+        args.push_back(std::to_string(i));
+
+        NodeProcess process;
+        if (startNode(args, process))
+            processes.push_back(process);
+        else
+        {
+            fprintf(stderr, "Failed to start node %u!\n", i);
+            success = false;
+        }
+    }
+
+    for (std::size_t i = 0; i < processes.size(); i++)
+        if (!waitForNode(processes[i]))
+        {
+            fprintf(stderr, "Node %u failed!\n", static_cast<unsigned int>(i));
+            success = false;
+        }
+
+    remove(ConfigPath);
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,105 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include "SGCTBench.h"
+#include <sgct/ReadConfig.h>
+#include <sgct/ClusterManager.h>
+#include <sgct/SGCTProjection.h>
+#include <math.h>
+
+/*
+    Parses a generated configuration of a dome sized cluster, several nodes with two windows each and two
+    viewports with projection planes per window, and times the off-axis projection that is calculated for
+    every viewport and eye each frame.
+*/
+namespace
+{
+    const unsigned int NumberOfNodes = 16;
+
+    void writeViewport(FILE * file, float x, float left, float right)
+    {
+        fprintf(file, "\t\t\t<Viewport>\n");
+        fprintf(file, "\t\t\t\t<Pos x=\"%.1f\" y=\"0.0\" />\n", x);
+        fprintf(file, "\t\t\t\t<Size x=\"0.5\" y=\"1.0\" />\n");
+        fprintf(file, "\t\t\t\t<Projectionplane>\n");
+        fprintf(file, "\t\t\t\t\t<Pos x=\"%f\" y=\"-1.0\" z=\"0.0\" />\n", left);
+        fprintf(file, "\t\t\t\t\t<Pos x=\"%f\" y=\"1.0\" z=\"0.0\" />\n", left);
+        fprintf(file, "\t\t\t\t\t<Pos x=\"%f\" y=\"1.0\" z=\"0.0\" />\n", right);
+        fprintf(file, "\t\t\t\t</Projectionplane>\n");
+        fprintf(file, "\t\t\t</Viewport>\n");
+    }
+
+    void writeCluster(FILE * file)
+    {
+        fprintf(file, "<?xml version=\"1.0\" ?>\n");
+        fprintf(file, "<Cluster masterAddress=\"127.0.0.1\">\n");
+        for (unsigned int i = 0; i < NumberOfNodes; i++)
+        {
+            fprintf(file, "\t<Node address=\"127.0.0.%u\" port=\"%u\" dataTransferPort=\"%u\">\n", i + 1, 20401 + i, 20501 + i);
+            for (unsigned int j = 0; j < 2; j++)
+            {
+                float left = -1.778f + static_cast<float>(j) * 1.778f;
+                fprintf(file, "\t\t<Window fullScreen=\"false\" msaa=\"4\" border=\"false\">\n");
+                fprintf(file, "\t\t\t<Pos x=\"%u\" y=\"0\" />\n", j * 1920);
+                fprintf(file, "\t\t\t<Size x=\"1920\" y=\"1080\" />\n");
+                writeViewport(file, 0.0f, left, left + 0.889f);
+                writeViewport(file, 0.5f, left + 0.889f, left + 1.778f);
+                fprintf(file, "\t\t</Window>\n");
+            }
+            fprintf(file, "\t</Node>\n");
+        }
+        fprintf(file, "\t<User eyeSeparation=\"0.06\">\n");
+        fprintf(file, "\t\t<Pos x=\"0.0\" y=\"0.0\" z=\"4.0\" />\n");
+        fprintf(file, "\t</User>\n");
+        fprintf(file, "</Cluster>\n");
+    }
+}
+
+void sgct_bench::runConfigBenchmarks(BenchRunner & runner)
+{
+    if (runner.isSelected("Config/ReadConfig"))
+    {
+        const std::string path("sgct_bench_config.xml");
+        FILE * file = fopen(path.c_str(), "wb");
+        if (file != nullptr)
+        {
+            writeCluster(file);
+            fclose(file);
+
+            runner.run("Config/ReadConfig", 0, [&]() {
+                sgct_core::ReadConfig config(path);
+                if (!config.isValid())
+                    fprintf(stderr, "Failed to parse '%s'!\n", path.c_str());
+                sgct_core::ClusterManager::destroy();
+            });
+
+            remove(path.c_str());
+        }
+        else
+            fprintf(stderr, "Failed to create '%s'!\n", path.c_str());
+    }
+
+    sgct_core::SGCTProjectionPlane plane;
+    plane.setCoordinate(sgct_core::SGCTProjectionPlane::LowerLeft, glm::vec3(-1.778f, -1.0f, 0.0f));
+    plane.setCoordinate(sgct_core::SGCTProjectionPlane::UpperLeft, glm::vec3(-1.778f, 1.0f, 0.0f));
+    plane.setCoordinate(sgct_core::SGCTProjectionPlane::UpperRight, glm::vec3(1.778f, 1.0f, 0.0f));
+
+    //a tracked head moving in front of the plane
+    std::vector<glm::vec3> eyes(256);
+    for (std::size_t i = 0; i < eyes.size(); i++)
+    {
+        float t = static_cast<float>(i) / static_cast<float>(eyes.size());
+        eyes[i] = glm::vec3(sinf(t * 6.2832f) * 0.5f, 0.1f * cosf(t * 12.566f), 4.0f - t);
+    }
+
+    sgct_core::SGCTProjection projection;
+    std::size_t eye = 0;
+    runner.run("Config/SGCTProjection/calculateProjection", 0, [&]() {
+        projection.calculateProjection(eyes[eye], &plane, 0.1f, 100.0f, glm::vec3(0.03f, 0.0f, 0.0f));
+        eye = (eye + 1) % eyes.size();
+    });
+}
@@ -0,0 +1,70 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include "SGCTBench.h"
+#include <sgct/Font.h>
+
+/*
+    Rasterizes the printable ASCII glyphs of a font the way Font::createGlyph does before the texture
+    upload, loading the glyph, stroking it and expanding the bitmaps to the two channel image.
+*/
+void sgct_bench::runFontBenchmarks(BenchRunner & runner, const std::string & fontPath)
+{
+    if (!runner.isSelected("Font/rasterize"))
+        return;
+
+    FT_Library library;
+    if (FT_Init_FreeType(&library) != 0)
+    {
+        fprintf(stderr, "Failed to init FreeType!\n");
+        return;
+    }
+
+    FT_Face face;
+    if (FT_New_Face(library, fontPath.c_str(), 0, &face) != 0)
+    {
+        fprintf(stdout, "%-48s skipped, can't load font '%s' (use --font)\n", "Font/rasterize", fontPath.c_str());
+        FT_Done_FreeType(library);
+        return;
+    }
+
+    const unsigned int sizes[] = { 14, 32 };
+    for (std::size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        //same resolution as FontManager
+        if (FT_Set_Char_Size(face, sizes[i] << 6, sizes[i] << 6, 96, 96) != 0)
+            continue;
+
+        std::size_t pixelBytes = 0;
+        runner.run("Font/rasterize/" + std::to_string(sizes[i]) + "px", 0, [&]() {
+            pixelBytes = 0;
+            for (wchar_t c = 32; c < 127; c++)
+            {
+                FT_UInt index = FT_Get_Char_Index(face, static_cast<FT_ULong>(c));
+                if (FT_Load_Glyph(face, index, FT_LOAD_FORCE_AUTOHINT))
+                    continue;
+
+                int width, height;
+                unsigned char * pixels = nullptr;
+                sgct_text::GlyphData gd;
+                if (sgct_text::Font::getPixelData(library, face, 1, width, height, &pixels, &gd))
+                {
+                    pixelBytes += static_cast<std::size_t>(width * height * 2);
+                    delete[] pixels;
+                    FT_Stroker_Done(gd.mStroker);
+                    FT_Done_Glyph(gd.mStrokeGlyph);
+                    FT_Done_Glyph(gd.mGlyph);
+                }
+            }
+        });
+        if (runner.isSelected("Font/rasterize/" + std::to_string(sizes[i]) + "px"))
+            runner.addCounter("glyph_bytes", static_cast<double>(pixelBytes));
+    }
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+}
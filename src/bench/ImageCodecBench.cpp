@@ -0,0 +1,107 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include "SGCTBench.h"
+#include <sgct/Image.h>
+#include <stdlib.h>
+
+/*
+    Encodes a full HD frame to each of the formats that screenshots and textures use and decodes the file
+    from memory. The frame is a gradient with some noise, so it compresses about like a rendered frame.
+*/
+namespace
+{
+    typedef bool (*SaveFn)(sgct_core::Image & img);
+    typedef bool (sgct_core::Image::*LoadFn)(unsigned char * data, std::size_t len);
+
+    struct ImageFormat
+    {
+        const char * mName;
+        const char * mExtension;
+        SaveFn mSave;
+        LoadFn mLoad;
+    };
+
+    bool savePNG(sgct_core::Image & img) { return img.savePNG(); }
+    bool saveJPEG(sgct_core::Image & img) { return img.saveJPEG(); }
+    bool saveTGA(sgct_core::Image & img) { return img.saveTGA(); }
+
+    bool readFile(const std::string & path, std::vector<unsigned char> & data)
+    {
+        FILE * file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+            return false;
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        data.resize(size > 0 ? static_cast<std::size_t>(size) : 0);
+        bool ok = !data.empty() && fread(data.data(), 1, data.size(), file) == data.size();
+        fclose(file);
+        return ok;
+    }
+}
+
+void sgct_bench::runImageCodecBenchmarks(BenchRunner & runner)
+{
+    const std::size_t width = 1920;
+    const std::size_t height = 1080;
+    const std::size_t channels = 3; //JPEG has no alpha
+
+    sgct_core::Image frame;
+    frame.setSize(width, height);
+    frame.setChannels(channels);
+    frame.setBytesPerChannel(1);
+    if (!frame.allocateOrResizeData())
+        return;
+
+    srand(1234);
+    unsigned char * pixels = frame.getData();
+    for (std::size_t y = 0; y < height; y++)
+        for (std::size_t x = 0; x < width; x++)
+            for (std::size_t c = 0; c < channels; c++)
+            {
+                int value = static_cast<int>((x * (c + 1) + y * (3 - c)) * 255 / (width + height * 3)) + rand() % 8;
+                pixels[(y * width + x) * channels + c] = static_cast<unsigned char>(value > 255 ? 255 : value);
+            }
+    std::size_t size = width * height * channels;
+
+    const ImageFormat formats[] =
+    {
+        { "PNG", "png", savePNG, &sgct_core::Image::loadPNG },
+        { "JPEG", "jpg", saveJPEG, &sgct_core::Image::loadJPEG },
+        { "TGA", "tga", saveTGA, &sgct_core::Image::loadTGA }
+    };
+
+    for (std::size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+    {
+        const ImageFormat & format = formats[i];
+        std::string base = std::string("ImageCodec/") + format.mName;
+        std::string path = std::string("sgct_bench_image.") + format.mExtension;
+        frame.setFilename(path);
+
+        if (!runner.isSelected(base + "/encode") && !runner.isSelected(base + "/decode"))
+            continue;
+
+        //the decoder needs the file even if the encoder isn't timed
+        std::vector<unsigned char> file;
+        if (format.mSave(frame) && readFile(path, file))
+        {
+            runner.run(base + "/encode", size, [&]() {
+                format.mSave(frame);
+            });
+            if (runner.isSelected(base + "/encode"))
+                runner.addCounter("file_bytes", static_cast<double>(file.size()));
+
+            runner.run(base + "/decode", size, [&]() {
+                sgct_core::Image img;
+                (img.*format.mLoad)(file.data(), file.size());
+            });
+        }
+
+        remove(path.c_str());
+    }
+}
@@ -0,0 +1,71 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include "SGCTBench.h"
+#include <sgct/Image.h>
+#include <stdlib.h>
+
+void sgct_bench::runImageKernelBenchmarks(BenchRunner & runner)
+{
+    //a 4K frame
+    const std::size_t width = 3840;
+    const std::size_t height = 2160;
+    const std::size_t pixels = width * height;
+
+    std::vector<unsigned char> rgba(pixels * 4);
+    std::vector<unsigned char> rgb(pixels * 3);
+    std::vector<unsigned short> rgba16(pixels * 4);
+    std::vector<unsigned char> half((width / 2) * (height / 2) * 4);
+    std::vector<unsigned char> i420(pixels + (width / 2) * (height / 2) * 2);
+
+    srand(1234);
+    for (std::size_t i = 0; i < rgba.size(); i++)
+        rgba[i] = static_cast<unsigned char>(rand());
+    for (std::size_t i = 0; i < rgb.size(); i++)
+        rgb[i] = static_cast<unsigned char>(rand());
+
+    runner.run("Image/swapRedBlue/RGBA8", rgba.size(), [&]() {
+        sgct_core::Image::swapRedBlue(rgba.data(), pixels, 4);
+    });
+
+    runner.run("Image/swapRedBlue/RGB8", rgb.size(), [&]() {
+        sgct_core::Image::swapRedBlue(rgb.data(), pixels, 3);
+    });
+
+    runner.run("Image/packRGBAToRGB", rgba.size(), [&]() {
+        sgct_core::Image::packRGBAToRGB(rgba.data(), rgb.data(), pixels);
+    });
+
+    runner.run("Image/unpackRGBToRGBA", rgb.size(), [&]() {
+        sgct_core::Image::unpackRGBToRGBA(rgb.data(), rgba.data(), pixels);
+    });
+
+    runner.run("Image/flipRows/RGBA8", rgba.size(), [&]() {
+        sgct_core::Image::flipRows(rgba.data(), width * 4, height);
+    });
+
+    runner.run("Image/convert8To16", rgba.size(), [&]() {
+        sgct_core::Image::convert8To16(rgba.data(), rgba16.data(), rgba.size());
+    });
+
+    runner.run("Image/convert16To8", rgba16.size() * 2, [&]() {
+        sgct_core::Image::convert16To8(rgba16.data(), rgba.data(), rgba16.size());
+    });
+
+    runner.run("Image/premultiplyAlpha", rgba.size(), [&]() {
+        sgct_core::Image::premultiplyAlpha(rgba.data(), pixels);
+    });
+
+    runner.run("Image/resampleBilinear/RGBA8/half", rgba.size(), [&]() {
+        sgct_core::Image::resampleBilinear(rgba.data(), width, height, half.data(), width / 2, height / 2, 4);
+    });
+
+    runner.run("Image/convertToI420/BGRA8", rgba.size(), [&]() {
+        unsigned char * y = i420.data();
+        sgct_core::Image::convertToI420(rgba.data(), width, height, 4, true, true, y, y + pixels, y + pixels + pixels / 4);
+    });
+}
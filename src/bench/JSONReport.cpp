@@ -0,0 +1,96 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include "SGCTBench.h"
+#include <sgct/SGCTVersion.h>
+
+/*
+    Writes the results in the JSON format of Google Benchmark so that the existing tools for comparing runs
+    and tracking regressions can read them. Times are in nanoseconds per iteration.
+*/
+namespace
+{
+    std::string escape(const std::string & str)
+    {
+        std::string out;
+        for (std::size_t i = 0; i < str.size(); i++)
+        {
+            char c = str[i];
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+                out += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned int>(c));
+                out += buffer;
+            }
+            else
+                out += c;
+        }
+        return out;
+    }
+}
+
+bool sgct_bench::writeJSONReport(const std::string & filename, const BenchRunner & runner, const char * executable)
+{
+    FILE * file = nullptr;
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    if (fopen_s(&file, filename.c_str(), "wb") != 0)
+        file = nullptr;
+#else
+    file = fopen(filename.c_str(), "wb");
+#endif
+    if (file == nullptr)
+    {
+        fprintf(stderr, "Failed to create '%s'!\n", filename.c_str());
+        return false;
+    }
+
+    char date[64];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"context\": {\n");
+    fprintf(file, "    \"date\": \"%s\",\n", date);
+    fprintf(file, "    \"executable\": \"%s\",\n", escape(executable != nullptr ? executable : "").c_str());
+    fprintf(file, "    \"sgct_version\": \"%s\",\n", escape(sgct::getSGCTVersion()).c_str());
+#ifdef NDEBUG
+    fprintf(file, "    \"library_build_type\": \"release\"\n");
+#else
+    fprintf(file, "    \"library_build_type\": \"debug\"\n");
+#endif
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"benchmarks\": [");
+
+    const std::vector<BenchResult> & results = runner.getResults();
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult & res = results[i];
+        std::string name = escape(res.mName);
+        fprintf(file, "%s\n    {\n", i > 0 ? "," : "");
+        fprintf(file, "      \"name\": \"%s\",\n", name.c_str());
+        fprintf(file, "      \"run_name\": \"%s\",\n", name.c_str());
+        fprintf(file, "      \"run_type\": \"iteration\",\n");
+        fprintf(file, "      \"iterations\": %llu,\n", static_cast<unsigned long long>(res.mIterations));
+        fprintf(file, "      \"real_time\": %.6e,\n", res.mSecondsPerIteration * 1.0e9);
+        fprintf(file, "      \"cpu_time\": %.6e,\n", res.mCPUSecondsPerIteration * 1.0e9);
+        if (res.mBytesPerSecond > 0.0)
+            fprintf(file, "      \"bytes_per_second\": %.6e,\n", res.mBytesPerSecond);
+        for (std::size_t j = 0; j < res.mCounters.size(); j++)
+            fprintf(file, "      \"%s\": %.6e,\n", escape(res.mCounters[j].first).c_str(), res.mCounters[j].second);
+        fprintf(file, "      \"time_unit\": \"ns\"\n");
+        fprintf(file, "    }");
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,412 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include "SGCTBench.h"
+#include <sgct/MeshTextReader.h>
+#include <sgct/CorrectionMesh.h>
+#include <sgct/SGCTSettings.h>
+#include <sgct/Viewport.h>
+#include <string.h>
+#include <stdlib.h>
+
+#define MAX_LINE_LENGTH 1024
+
+/*
+    Times the line scanning of the text warping mesh formats with fgets and sscanf, as the readers did before,
+    and with MeshTextReader. Both variants scan the same patterns as CorrectionMesh and hash every value they
+    read, a difference in the hashes means that the results aren't bit-identical. The CorrectionMesh variant
+    times the whole parse of the file into a mesh, without the cache and the upload.
+*/
+namespace
+{
+    struct Hash
+    {
+        Hash() : mValue(14695981039346656037ULL), mCount(0) {}
+
+        void add(const void * data, std::size_t size)
+        {
+            const unsigned char * bytes = reinterpret_cast<const unsigned char *>(data);
+            for (std::size_t i = 0; i < size; i++)
+            {
+                mValue ^= bytes[i];
+                mValue *= 1099511628211ULL;
+            }
+            mCount++;
+        }
+        void add(float f) { add(&f, sizeof(f)); }
+        void add(double d) { add(&d, sizeof(d)); }
+        void add(unsigned int u) { add(&u, sizeof(u)); }
+        void add(int i) { add(&i, sizeof(i)); }
+
+        unsigned long long mValue;
+        std::size_t mCount;
+    };
+
+    float randomUnit()
+    {
+        return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+    }
+
+    std::size_t fileSize(const std::string & path)
+    {
+        FILE * file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+            return 0;
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fclose(file);
+        return size > 0 ? static_cast<std::size_t>(size) : 0;
+    }
+
+    /*
+        Generators, n x n vertices with the same number formatting as the calibration tools
+    */
+    void writeDomeProjection(FILE * file, unsigned int n)
+    {
+        fprintf(file, "x;y;u;v;column;row\n");
+        for (unsigned int r = 0; r < n; r++)
+            for (unsigned int c = 0; c < n; c++)
+                fprintf(file, "%f;%f;%f;%f;%u;%u\n", randomUnit(), randomUnit(), randomUnit(), randomUnit(), c, r);
+    }
+
+    void writeScalable(FILE * file, unsigned int n)
+    {
+        fprintf(file, "NATIVEXRES 1920\nNATIVEYRES 1200\nORTHO_LEFT 0.0\nORTHO_RIGHT 1920.0\nORTHO_BOTTOM 0.0\nORTHO_TOP 1200.0\n");
+        fprintf(file, "VERTICES %u\n", n * n);
+        for (unsigned int i = 0; i < n * n; i++)
+            fprintf(file, "%.6f %.6f %u %.6f %.6f\n", randomUnit() * 1920.0f, randomUnit() * 1200.0f, static_cast<unsigned int>(rand() % 256), randomUnit(), randomUnit());
+        fprintf(file, "FACES %u\n", (n - 1) * (n - 1) * 2);
+        for (unsigned int r = 0; r < n - 1; r++)
+            for (unsigned int c = 0; c < n - 1; c++)
+            {
+                unsigned int i0 = r * n + c;
+                fprintf(file, "[ %u %u %u ]\n[ %u %u %u ]\n", i0, i0 + 1, i0 + n + 1, i0, i0 + n + 1, i0 + n);
+            }
+    }
+
+    void writeSkySkan(FILE * file, unsigned int n)
+    {
+        fprintf(file, "Dome Azimuth=12.5\nDome Elevation=21.0\nHorizontal FOV=70.0\nVertical FOV=45.0\n");
+        fprintf(file, "Horizontal Tweek=1.0\nVertical Tweek=1.0\n%u %u\n", n, n);
+        for (unsigned int i = 0; i < n * n; i++)
+            fprintf(file, "%f %f %f %f\n", randomUnit(), randomUnit(), randomUnit(), randomUnit());
+    }
+
+    void writePaulBourke(FILE * file, unsigned int n)
+    {
+        fprintf(file, "2\n%u %u\n", n, n);
+        for (unsigned int i = 0; i < n * n; i++)
+            fprintf(file, "%f %f %f %f %f\n", randomUnit() * 2.0f - 1.0f, randomUnit() * 2.0f - 1.0f, randomUnit(), randomUnit(), randomUnit());
+    }
+
+    void writeOBJ(FILE * file, unsigned int n)
+    {
+        for (unsigned int i = 0; i < n * n; i++)
+            fprintf(file, "v %f %f 0.000000\n", randomUnit() * 2.0f - 1.0f, randomUnit() * 2.0f - 1.0f);
+        for (unsigned int i = 0; i < n * n; i++)
+            fprintf(file, "vt %f %f 0.000000\n", randomUnit(), randomUnit());
+        for (unsigned int r = 0; r < n - 1; r++)
+            for (unsigned int c = 0; c < n - 1; c++)
+            {
+                unsigned int i0 = r * n + c + 1;
+                fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", i0, i0, i0, i0 + 1, i0 + 1, i0 + 1, i0 + n + 1, i0 + n + 1, i0 + n + 1);
+            }
+    }
+
+    /*
+        Scanning with fgets and sscanf
+    */
+    void scanDomeProjection(FILE * file, Hash & hash)
+    {
+        char line[MAX_LINE_LENGTH];
+        float x, y, u, v;
+        unsigned int col, row;
+        while (fgets(line, MAX_LINE_LENGTH, file) != nullptr)
+            if (sscanf(line, "%f;%f;%f;%f;%u;%u", &x, &y, &u, &v, &col, &row) == 6)
+            {
+                hash.add(x); hash.add(y); hash.add(u); hash.add(v); hash.add(col); hash.add(row);
+            }
+    }
+
+    void scanScalable(FILE * file, Hash & hash)
+    {
+        char line[MAX_LINE_LENGTH];
+        float x, y, s, t;
+        unsigned int intensity, a, b, c, ui;
+        char word[16];
+        double d;
+        while (fgets(line, MAX_LINE_LENGTH, file) != nullptr)
+        {
+            if (sscanf(line, "%f %f %u %f %f", &x, &y, &intensity, &s, &t) == 5)
+            {
+                hash.add(x); hash.add(y); hash.add(intensity); hash.add(s); hash.add(t);
+            }
+            else if (sscanf(line, "[ %u %u %u ]", &a, &b, &c) == 3)
+            {
+                hash.add(a); hash.add(b); hash.add(c);
+            }
+            else if (sscanf(line, "VERTICES %u", &ui) == 1 || sscanf(line, "FACES %u", &ui) == 1)
+                hash.add(ui);
+            else if (sscanf(line, "ORTHO_%15s %lf", word, &d) == 2)
+            {
+                hash.add(word, strlen(word)); hash.add(d);
+            }
+            else if (sscanf(line, "NATIVEXRES %u", &ui) == 1 || sscanf(line, "NATIVEYRES %u", &ui) == 1)
+                hash.add(ui);
+        }
+    }
+
+    void scanSkySkan(FILE * file, Hash & hash)
+    {
+        char line[MAX_LINE_LENGTH];
+        float f, x, y, u, v;
+        unsigned int size[2];
+        bool dimensionsSet = false;
+        while (fgets(line, MAX_LINE_LENGTH, file) != nullptr)
+        {
+            if (sscanf(line, "Dome Azimuth=%f", &f) == 1 || sscanf(line, "Dome Elevation=%f", &f) == 1 ||
+                sscanf(line, "Horizontal FOV=%f", &f) == 1 || sscanf(line, "Vertical FOV=%f", &f) == 1 ||
+                sscanf(line, "Horizontal Tweek=%f", &f) == 1 || sscanf(line, "Vertical Tweek=%f", &f) == 1 ||
+                sscanf(line, "U Tweek=%f", &f) == 1 || sscanf(line, "V Tweek=%f", &f) == 1)
+                hash.add(f);
+            else if (!dimensionsSet && sscanf(line, "%u %u", &size[0], &size[1]) == 2)
+            {
+                dimensionsSet = true;
+                hash.add(size[0]); hash.add(size[1]);
+            }
+            else if (dimensionsSet && sscanf(line, "%f %f %f %f", &x, &y, &u, &v) == 4)
+            {
+                hash.add(x); hash.add(y); hash.add(u); hash.add(v);
+            }
+        }
+    }
+
+    void scanPaulBourke(FILE * file, Hash & hash)
+    {
+        char line[MAX_LINE_LENGTH];
+        int type, size[2];
+        float x, y, s, t, intensity;
+        if (fgets(line, MAX_LINE_LENGTH, file) != nullptr && sscanf(line, "%d", &type) == 1)
+            hash.add(type);
+        if (fgets(line, MAX_LINE_LENGTH, file) != nullptr && sscanf(line, "%d %d", &size[0], &size[1]) == 2)
+        {
+            hash.add(size[0]); hash.add(size[1]);
+        }
+        while (fgets(line, MAX_LINE_LENGTH, file) != nullptr)
+            if (sscanf(line, "%f %f %f %f %f", &x, &y, &s, &t, &intensity) == 5)
+            {
+                hash.add(x); hash.add(y); hash.add(s); hash.add(t); hash.add(intensity);
+            }
+    }
+
+    void scanOBJ(FILE * file, Hash & hash)
+    {
+        char line[MAX_LINE_LENGTH];
+        float a, b;
+        int i0, i1, i2;
+        while (fgets(line, MAX_LINE_LENGTH, file) != nullptr)
+        {
+            if (sscanf(line, "v %f %f %*f", &a, &b) == 2 || sscanf(line, "vt %f %f %*f", &a, &b) == 2)
+            {
+                hash.add(a); hash.add(b);
+            }
+            else if (sscanf(line, "f %d/%*d/%*d %d/%*d/%*d %d/%*d/%*d", &i0, &i1, &i2) == 3)
+            {
+                hash.add(i0); hash.add(i1); hash.add(i2);
+            }
+        }
+    }
+
+    /*
+        Scanning with MeshTextReader
+    */
+    void scanDomeProjection(sgct_core::MeshTextReader & reader, Hash & hash)
+    {
+        float x, y, u, v;
+        unsigned int col, row;
+        while (reader.nextLine())
+            if (reader.readFloat(x) && reader.match(";") && reader.readFloat(y) && reader.match(";") &&
+                reader.readFloat(u) && reader.match(";") && reader.readFloat(v) && reader.match(";") &&
+                reader.readUInt(col) && reader.match(";") && reader.readUInt(row))
+            {
+                hash.add(x); hash.add(y); hash.add(u); hash.add(v); hash.add(col); hash.add(row);
+            }
+    }
+
+    void scanScalable(sgct_core::MeshTextReader & reader, Hash & hash)
+    {
+        float x, y, s, t;
+        unsigned int intensity, a, b, c, ui;
+        char word[16];
+        double d;
+        while (reader.nextLine())
+        {
+            if (reader.readFloat(x) && reader.match(" ") && reader.readFloat(y) && reader.match(" ") &&
+                reader.readUInt(intensity) && reader.match(" ") && reader.readFloat(s) && reader.match(" ") && reader.readFloat(t))
+            {
+                hash.add(x); hash.add(y); hash.add(intensity); hash.add(s); hash.add(t);
+            }
+            else if (reader.restart() && reader.match("[ ") && reader.readUInt(a) && reader.match(" ") &&
+                reader.readUInt(b) && reader.match(" ") && reader.readUInt(c))
+            {
+                hash.add(a); hash.add(b); hash.add(c);
+            }
+            else if ((reader.restart() && reader.match("VERTICES ") && reader.readUInt(ui)) ||
+                (reader.restart() && reader.match("FACES ") && reader.readUInt(ui)))
+                hash.add(ui);
+            else if (reader.restart() && reader.match("ORTHO_") && reader.readWord(word, 16) && reader.match(" ") && reader.readDouble(d))
+            {
+                hash.add(word, strlen(word)); hash.add(d);
+            }
+            else if ((reader.restart() && reader.match("NATIVEXRES ") && reader.readUInt(ui)) ||
+                (reader.restart() && reader.match("NATIVEYRES ") && reader.readUInt(ui)))
+                hash.add(ui);
+        }
+    }
+
+    void scanSkySkan(sgct_core::MeshTextReader & reader, Hash & hash)
+    {
+        static const char * keywords[] = { "Dome Azimuth=", "Dome Elevation=", "Horizontal FOV=", "Vertical FOV=",
+            "Horizontal Tweek=", "Vertical Tweek=", "U Tweek=", "V Tweek=" };
+        float f, x, y, u, v;
+        unsigned int size[2];
+        bool dimensionsSet = false;
+        while (reader.nextLine())
+        {
+            bool keyword = false;
+            for (std::size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]) && !keyword; i++)
+                keyword = reader.restart() && reader.match(keywords[i]) && reader.readFloat(f);
+
+            if (keyword)
+                hash.add(f);
+            else if (!dimensionsSet && reader.restart() && reader.readUInt(size[0]) && reader.match(" ") && reader.readUInt(size[1]))
+            {
+                dimensionsSet = true;
+                hash.add(size[0]); hash.add(size[1]);
+            }
+            else if (dimensionsSet && reader.restart() && reader.readFloat(x) && reader.match(" ") && reader.readFloat(y) &&
+                reader.match(" ") && reader.readFloat(u) && reader.match(" ") && reader.readFloat(v))
+            {
+                hash.add(x); hash.add(y); hash.add(u); hash.add(v);
+            }
+        }
+    }
+
+    void scanPaulBourke(sgct_core::MeshTextReader & reader, Hash & hash)
+    {
+        int type, size[2];
+        float x, y, s, t, intensity;
+        if (reader.nextLine() && reader.readInt(type))
+            hash.add(type);
+        if (reader.nextLine() && reader.readInt(size[0]) && reader.match(" ") && reader.readInt(size[1]))
+        {
+            hash.add(size[0]); hash.add(size[1]);
+        }
+        while (reader.nextLine())
+            if (reader.readFloat(x) && reader.match(" ") && reader.readFloat(y) && reader.match(" ") &&
+                reader.readFloat(s) && reader.match(" ") && reader.readFloat(t) && reader.match(" ") && reader.readFloat(intensity))
+            {
+                hash.add(x); hash.add(y); hash.add(s); hash.add(t); hash.add(intensity);
+            }
+    }
+
+    void scanOBJ(sgct_core::MeshTextReader & reader, Hash & hash)
+    {
+        float a, b;
+        int i0, i1, i2;
+        while (reader.nextLine())
+        {
+            if ((reader.match("v ") && reader.readFloat(a) && reader.match(" ") && reader.readFloat(b)) ||
+                (reader.restart() && reader.match("vt ") && reader.readFloat(a) && reader.match(" ") && reader.readFloat(b)))
+            {
+                hash.add(a); hash.add(b);
+            }
+            else if (reader.restart() && reader.match("f ") && reader.readInt(i0) &&
+                reader.match("/") && reader.skipInt() && reader.match("/") && reader.skipInt() && reader.match(" ") && reader.readInt(i1) &&
+                reader.match("/") && reader.skipInt() && reader.match("/") && reader.skipInt() && reader.match(" ") && reader.readInt(i2))
+            {
+                hash.add(i0); hash.add(i1); hash.add(i2);
+            }
+        }
+    }
+
+    struct MeshFormat
+    {
+        const char * mName;
+        const char * mExtension;
+        void (*mWrite)(FILE *, unsigned int);
+        void (*mScanFile)(FILE *, Hash &);
+        void (*mScanReader)(sgct_core::MeshTextReader &, Hash &);
+    };
+}
+
+void sgct_bench::runMeshParserBenchmarks(BenchRunner & runner, unsigned int gridSize)
+{
+    const MeshFormat formats[] =
+    {
+        { "DomeProjection", "csv", writeDomeProjection, scanDomeProjection, scanDomeProjection },
+        { "Scalable", "ol", writeScalable, scanScalable, scanScalable },
+        { "SkySkan", "skyskan", writeSkySkan, scanSkySkan, scanSkySkan },
+        { "PaulBourke", "data", writePaulBourke, scanPaulBourke, scanPaulBourke },
+        { "OBJ", "obj", writeOBJ, scanOBJ, scanOBJ }
+    };
+
+    //time the parsers, not the reading of a compiled mesh
+    sgct::SGCTSettings::instance()->setUseWarpMeshCache(false);
+
+    for (std::size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+    {
+        const MeshFormat & format = formats[i];
+        std::string base = std::string("MeshParser/") + format.mName;
+        if (!runner.isSelected(base + "/sscanf") && !runner.isSelected(base + "/MeshTextReader") &&
+            !runner.isSelected(base + "/CorrectionMesh"))
+            continue;
+
+        std::string path = std::string("sgct_bench_mesh.") + format.mExtension;
+        FILE * file = fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            fprintf(stderr, "Failed to create '%s'!\n", path.c_str());
+            continue;
+        }
+        srand(1234);
+        format.mWrite(file, gridSize);
+        fclose(file);
+        std::size_t size = fileSize(path);
+
+        Hash referenceHash;
+        runner.run(base + "/sscanf", size, [&]() {
+            referenceHash = Hash();
+            FILE * f = fopen(path.c_str(), "r");
+            if (f != nullptr)
+            {
+                format.mScanFile(f, referenceHash);
+                fclose(f);
+            }
+        });
+
+        Hash readerHash;
+        runner.run(base + "/MeshTextReader", size, [&]() {
+            readerHash = Hash();
+            sgct_core::MeshTextReader reader(MAX_LINE_LENGTH);
+            if (reader.open(path))
+                format.mScanReader(reader, readerHash);
+        });
+
+        if (referenceHash.mCount != 0 && readerHash.mCount != 0 &&
+            (referenceHash.mValue != readerHash.mValue || referenceHash.mCount != readerHash.mCount))
+            fprintf(stdout, "%-48s MISMATCH, the parsed values differ!\n", base.c_str());
+
+        runner.run(base + "/CorrectionMesh", size, [&]() {
+            sgct_core::Viewport viewport;
+            sgct_core::CorrectionMesh mesh;
+            mesh.parseMesh(path, &viewport, sgct_core::CorrectionMesh::NO_HINT, 16.0f / 9.0f, glm::ivec2(1920, 1080));
+        });
+
+        remove(path.c_str());
+    }
+}
@@ -0,0 +1,189 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include "SGCTBench.h"
+#include <sgct/NetworkManager.h>
+#include <sgct/SGCTNetwork.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <stdlib.h>
+
+/*
+    Times the packaging of data transfers and a data transfer connection over the loopback interface. The
+    throughput is measured with bursts of packages from the client to the server and the latency as the time
+    from sending a small package until its acknowledge has come back.
+*/
+namespace
+{
+    //waits for the callbacks of the connection threads
+    struct Receiver
+    {
+        Receiver() : mReceived(0), mAcknowledged(0) {}
+
+        void onPackage(void *, int, int, int)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mReceived++;
+            mCond.notify_all();
+        }
+
+        void onAcknowledge(int, int)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mAcknowledged++;
+            mCond.notify_all();
+        }
+
+        std::size_t get(const std::size_t & counter)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return counter;
+        }
+
+        bool waitFor(const std::size_t & counter, std::size_t value)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            return mCond.wait_for(lock, std::chrono::seconds(5), [&]() { return counter >= value; });
+        }
+
+        std::mutex mMutex;
+        std::condition_variable mCond;
+        std::size_t mReceived;
+        std::size_t mAcknowledged;
+    };
+
+    std::vector<char> createPayload(std::size_t size)
+    {
+        //runs of repeated values so that compression has something to do
+        std::vector<char> payload(size);
+        for (std::size_t i = 0; i < size; i++)
+            payload[i] = static_cast<char>((i / 64) % 7 == 0 ? rand() : i / 256);
+        return payload;
+    }
+
+    bool waitForConnection(sgct_core::SGCTNetwork & connection)
+    {
+        for (int i = 0; i < 500 && !connection.isConnected(); i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return connection.isConnected();
+    }
+}
+
+void sgct_bench::runNetworkBenchmarks(BenchRunner & runner, const std::string & port)
+{
+    const std::size_t sizes[] = { 1024, 64 * 1024, 1024 * 1024 };
+    const char * sizeNames[] = { "1K", "64K", "1M" };
+
+    srand(1234);
+    for (std::size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        std::vector<char> payload = createPayload(sizes[i]);
+        for (int compress = 0; compress < 2; compress++)
+        {
+            runner.run(std::string("Network/prepareTransferData/") + sizeNames[i] + (compress ? "/compressed" : ""), payload.size(), [&]() {
+                char * buffer = nullptr;
+                int length = static_cast<int>(payload.size());
+                sgct_core::NetworkManager::prepareTransferData(payload.data(), &buffer, length, 0, compress != 0, 1);
+                delete[] buffer;
+            });
+        }
+    }
+
+    if (!runner.isSelected("Network/Loopback/throughput") && !runner.isSelected("Network/Loopback/latency"))
+        return;
+
+#ifdef __WIN32__
+    WORD version = MAKEWORD(2, 2);
+    WSADATA wsaData;
+    if (WSAStartup(version, &wsaData) != 0)
+    {
+        fprintf(stderr, "Failed to init winsock!\n");
+        return;
+    }
+#endif
+
+    Receiver receiver;
+    sgct_core::SGCTNetwork * server = new sgct_core::SGCTNetwork();
+    sgct_core::SGCTNetwork * client = new sgct_core::SGCTNetwork();
+    server->setPackageDecodeFunction(sgct_cppxeleven::bind(&Receiver::onPackage, &receiver,
+        sgct_cppxeleven::placeholders::_1, sgct_cppxeleven::placeholders::_2, sgct_cppxeleven::placeholders::_3, sgct_cppxeleven::placeholders::_4));
+    client->setAcknowledgeFunction(sgct_cppxeleven::bind(&Receiver::onAcknowledge, &receiver,
+        sgct_cppxeleven::placeholders::_1, sgct_cppxeleven::placeholders::_2));
+
+    bool connected = false;
+    try
+    {
+        server->init(port, "127.0.0.1", true, sgct_core::SGCTNetwork::DataTransfer);
+        client->init(port, "127.0.0.1", false, sgct_core::SGCTNetwork::DataTransfer);
+        connected = waitForConnection(*server) && waitForConnection(*client);
+    }
+    catch (const char * err)
+    {
+        fprintf(stderr, "Failed to open loopback connection on port %s: %s\n", port.c_str(), err);
+    }
+
+    if (connected)
+    {
+        //bursts of packages, the size of a typical texture or mesh update
+        const std::size_t burst = 16;
+        std::vector<char> payload = createPayload(256 * 1024);
+        char * buffer = nullptr;
+        int length = static_cast<int>(payload.size());
+        if (sgct_core::NetworkManager::prepareTransferData(payload.data(), &buffer, length, 1, false, 0))
+        {
+            runner.run("Network/Loopback/throughput", payload.size() * burst, [&]() {
+                std::size_t target = receiver.get(receiver.mReceived) + burst;
+                for (std::size_t i = 0; i < burst; i++)
+                    client->sendData(buffer, length);
+                if (!receiver.waitFor(receiver.mReceived, target))
+                    fprintf(stderr, "Timed out waiting for loopback packages!\n");
+            });
+        }
+        delete[] buffer;
+        buffer = nullptr;
+
+        payload = createPayload(64);
+        length = static_cast<int>(payload.size());
+        if (sgct_core::NetworkManager::prepareTransferData(payload.data(), &buffer, length, 2, false, 0))
+        {
+            typedef std::chrono::high_resolution_clock Clock;
+            std::vector<double> roundTrips;
+            runner.run("Network/Loopback/latency", 0, [&]() {
+                std::size_t target = receiver.get(receiver.mAcknowledged) + 1;
+                Clock::time_point t0 = Clock::now();
+                client->sendData(buffer, length);
+                if (receiver.waitFor(receiver.mAcknowledged, target))
+                    roundTrips.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+                else
+                    fprintf(stderr, "Timed out waiting for loopback acknowledge!\n");
+            });
+
+            if (!roundTrips.empty())
+            {
+                std::sort(roundTrips.begin(), roundTrips.end());
+                runner.addCounter("p50_us", roundTrips[(roundTrips.size() - 1) / 2]);
+                runner.addCounter("p99_us", roundTrips[(roundTrips.size() - 1) * 99 / 100]);
+            }
+        }
+        delete[] buffer;
+    }
+
+    //same sequence as NetworkManager::close
+    server->initShutdown();
+    client->initShutdown();
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    server->closeNetwork(false);
+    client->closeNetwork(false);
+    delete server;
+    delete client;
+
+#ifdef __WIN32__
+    WSACleanup();
+#endif
+}
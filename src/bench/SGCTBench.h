@@ -0,0 +1,138 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifndef _SGCT_BENCH_H_
+#define _SGCT_BENCH_H_
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdio.h>
+#include <time.h>
+
+namespace sgct_bench
+{
+
+/*!
+    Result of a single benchmark run.
+*/
+struct BenchResult
+{
+    std::string mName;
+    std::size_t mIterations;
+    double mSecondsPerIteration;
+    double mCPUSecondsPerIteration; //of the whole process, including helper threads
+    double mBytesPerSecond;
+    std::vector<std::pair<std::string, double> > mCounters; //extra values, such as latency percentiles
+};
+
+/*!
+    Minimal self-contained benchmark runner. Each benchmark is a function that performs
+    one iteration of the measured work. The function is repeated until the minimum run
+    time is reached and the mean time per iteration is reported.
+*/
+class BenchRunner
+{
+public:
+    BenchRunner() : mMinTime(0.25), mFilter("") {}
+
+    void setMinTime(double seconds) { mMinTime = seconds; }
+    void setFilter(const std::string & filter) { mFilter = filter; }
+
+    /*!
+        \param name the benchmark name, used for filtering and reporting
+        \param bytesPerIteration the number of bytes processed per iteration (0 if not applicable)
+        \param fn the work for one iteration
+    */
+    void run(const std::string & name, std::size_t bytesPerIteration, std::function<void()> fn)
+    {
+        if (!isSelected(name))
+            return;
+
+        //warm up caches and lazy allocations
+        fn();
+
+        typedef std::chrono::high_resolution_clock Clock;
+        std::size_t iterations = 0;
+        std::size_t batch = 1;
+        double elapsed = 0.0;
+        clock_t c0 = clock();
+        Clock::time_point t0 = Clock::now();
+        while (elapsed < mMinTime)
+        {
+            for (std::size_t i = 0; i < batch; i++)
+                fn();
+            iterations += batch;
+            batch *= 2;
+            elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+        }
+        double cpuTime = static_cast<double>(clock() - c0) / static_cast<double>(CLOCKS_PER_SEC);
+
+        BenchResult res;
+        res.mName = name;
+        res.mIterations = iterations;
+        res.mSecondsPerIteration = elapsed / static_cast<double>(iterations);
+        res.mCPUSecondsPerIteration = cpuTime / static_cast<double>(iterations);
+        res.mBytesPerSecond = bytesPerIteration > 0 ? static_cast<double>(bytesPerIteration) / res.mSecondsPerIteration : 0.0;
+        mResults.push_back(res);
+
+        if (res.mBytesPerSecond > 0.0)
+            fprintf(stdout, "%-48s %12.3f us %10.1f MB/s (%u iterations)\n", name.c_str(),
+                res.mSecondsPerIteration * 1.0e6, res.mBytesPerSecond / (1024.0 * 1024.0), static_cast<unsigned int>(iterations));
+        else
+            fprintf(stdout, "%-48s %12.3f us (%u iterations)\n", name.c_str(),
+                res.mSecondsPerIteration * 1.0e6, static_cast<unsigned int>(iterations));
+    }
+
+    /*!
+        Adds a value to the latest result, written to the JSON report next to the timings.
+    */
+    void addCounter(const std::string & name, double value)
+    {
+        if (mResults.empty())
+            return;
+        mResults.back().mCounters.push_back(std::make_pair(name, value));
+        fprintf(stdout, "%-48s %12.3f %s\n", "", value, name.c_str());
+    }
+
+    /*!
+        Adds a result that was measured outside of run, such as by the nodes of the cluster simulator.
+    */
+    void addResult(const BenchResult & res)
+    {
+        mResults.push_back(res);
+    }
+
+    //! \returns true if the benchmark passes the filter, used to skip expensive setup
+    bool isSelected(const std::string & name) const
+    {
+        return mFilter.empty() || name.find(mFilter) != std::string::npos;
+    }
+
+    const std::vector<BenchResult> & getResults() const { return mResults; }
+
+private:
+    double mMinTime;
+    std::string mFilter;
+    std::vector<BenchResult> mResults;
+};
+
+bool writeJSONReport(const std::string & filename, const BenchRunner & runner, const char * executable);
+
+void runImageKernelBenchmarks(BenchRunner & runner);
+void runImageCodecBenchmarks(BenchRunner & runner);
+void runMeshParserBenchmarks(BenchRunner & runner, unsigned int gridSize);
+void runSharedDataBenchmarks(BenchRunner & runner);
+void runNetworkBenchmarks(BenchRunner & runner, const std::string & port);
+void runConfigBenchmarks(BenchRunner & runner);
+void runFontBenchmarks(BenchRunner & runner, const std::string & fontPath);
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include "SGCTBench.h"
+#include <sgct/SGCTNetwork.h>
+#include <sgct/SharedData.h>
+#include <zlib.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+    Encodes and decodes a frame of shared data of the kind an application synchronizes, a few scalars, a
+    transform per object and some strings, with and without compression. The compressed decode includes the
+    uncompress that SGCTNetwork does before handing the data to SharedData.
+*/
+namespace
+{
+    const std::size_t NumberOfObjects = 2048;
+
+    sgct::SharedDouble gTime(0.0);
+    sgct::SharedBool gPaused(false);
+    sgct::SharedVector<float> gTransforms;
+    sgct::SharedString gLabels[16];
+
+    void encodeFrame()
+    {
+        sgct::SharedData::instance()->writeDouble(&gTime);
+        sgct::SharedData::instance()->writeBool(&gPaused);
+        sgct::SharedData::instance()->writeVector(&gTransforms);
+        for (std::size_t i = 0; i < sizeof(gLabels) / sizeof(gLabels[0]); i++)
+            sgct::SharedData::instance()->writeString(&gLabels[i]);
+    }
+
+    void decodeFrame()
+    {
+        sgct::SharedData::instance()->readDouble(&gTime);
+        sgct::SharedData::instance()->readBool(&gPaused);
+        sgct::SharedData::instance()->readVector(&gTransforms);
+        for (std::size_t i = 0; i < sizeof(gLabels) / sizeof(gLabels[0]); i++)
+            sgct::SharedData::instance()->readString(&gLabels[i]);
+    }
+
+    uint32_t readUInt32(const unsigned char * p)
+    {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+}
+
+void sgct_bench::runSharedDataBenchmarks(BenchRunner & runner)
+{
+    srand(1234);
+    std::vector<float> transforms(NumberOfObjects * 16);
+    for (std::size_t i = 0; i < transforms.size(); i++)
+        transforms[i] = static_cast<float>(rand() % 1000) * 0.01f;
+    gTransforms.setVal(transforms);
+    for (std::size_t i = 0; i < sizeof(gLabels) / sizeof(gLabels[0]); i++)
+        gLabels[i].setVal("Label of object " + std::to_string(i) + " in the synchronized scene graph");
+
+    sgct::SharedData * sd = sgct::SharedData::instance();
+    sd->setEncodeFunction(encodeFrame);
+    sd->setDecodeFunction(decodeFrame);
+    const std::size_t header = sgct_core::SGCTNetwork::mHeaderSize;
+
+    sd->setCompression(false);
+    sd->encode();
+    std::size_t size = sd->getDataSize() - header;
+
+    runner.run("SharedData/encode", size, [&]() {
+        gTime.setVal(gTime.getVal() + 0.016);
+        sd->encode();
+    });
+
+    std::vector<char> frame(sd->getDataBlock() + header, sd->getDataBlock() + sd->getDataSize());
+    runner.run("SharedData/decode", size, [&]() {
+        sd->decode(frame.data(), static_cast<int>(frame.size()), 0);
+    });
+
+    sd->setCompression(true, 1);
+    runner.run("SharedData/encode/compressed", size, [&]() {
+        gTime.setVal(gTime.getVal() + 0.016);
+        sd->encode();
+    });
+    if (runner.isSelected("SharedData/encode/compressed"))
+        runner.addCounter("compression_ratio", sd->getCompressionRatio());
+    else
+        sd->encode();
+
+    //bytes 9-12 of the header hold the uncompressed size
+    std::vector<unsigned char> compressed(sd->getDataBlock() + header, sd->getDataBlock() + sd->getDataSize());
+    uLongf uncompressedSize = readUInt32(sd->getDataBlock() + 9);
+    std::vector<char> uncompressed(uncompressedSize);
+    runner.run("SharedData/decode/compressed", size, [&]() {
+        uLongf length = static_cast<uLongf>(uncompressed.size());
+        if (uncompress(reinterpret_cast<Bytef *>(uncompressed.data()), &length, compressed.data(), static_cast<uLong>(compressed.size())) == Z_OK)
+            sd->decode(uncompressed.data(), static_cast<int>(length), 0);
+    });
+
+    sd->setCompression(false);
+    sd->setEncodeFunction(SGCT_NULL_PTR);
+    sd->setDecodeFunction(SGCT_NULL_PTR);
+}
@@ -0,0 +1,69 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include "SGCTBench.h"
+#include <sgct/MessageHandler.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__WIN32__)
+    #define DEFAULT_FONT_PATH "C:/Windows/Fonts/verdanab.ttf"
+#elif defined(__APPLE__)
+    #define DEFAULT_FONT_PATH "/Library/Fonts/Arial.ttf"
+#else
+    #define DEFAULT_FONT_PATH "/usr/share/fonts/truetype/freefont/FreeSans.ttf"
+#endif
+
+/*
+    Usage: sgct_bench [--filter <substring>] [--min-time <seconds>] [--mesh-grid <n>] [--port <port>]
+                      [--font <file>] [--json <file>]
+
+    --mesh-grid sets the size of the generated warping meshes to n x n vertices (default 1500)
+    --port sets the port of the loopback connection (default 20450)
+    --font sets the TrueType font that is rasterized
+    --json writes the results to a file in the JSON format of Google Benchmark
+*/
+int main(int argc, char * argv[])
+{
+    sgct_bench::BenchRunner runner;
+    unsigned int meshGridSize = 1500;
+    std::string port("20450");
+    std::string fontPath(DEFAULT_FONT_PATH);
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            runner.setFilter(argv[++i]);
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+            runner.setMinTime(atof(argv[++i]));
+        else if (strcmp(argv[i], "--mesh-grid") == 0 && i + 1 < argc)
+            meshGridSize = static_cast<unsigned int>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+            port.assign(argv[++i]);
+        else if (strcmp(argv[i], "--font") == 0 && i + 1 < argc)
+            fontPath.assign(argv[++i]);
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonPath.assign(argv[++i]);
+    }
+
+    //keep the output of the library from drowning the results
+    sgct::MessageHandler::instance()->setNotifyLevel(sgct::MessageHandler::NOTIFY_ERROR);
+
+    sgct_bench::runImageKernelBenchmarks(runner);
+    sgct_bench::runImageCodecBenchmarks(runner);
+    sgct_bench::runMeshParserBenchmarks(runner, meshGridSize > 1 ? meshGridSize : 2);
+    sgct_bench::runSharedDataBenchmarks(runner);
+    sgct_bench::runNetworkBenchmarks(runner, port);
+    sgct_bench::runConfigBenchmarks(runner);
+    sgct_bench::runFontBenchmarks(runner, fontPath);
+
+    if (!jsonPath.empty() && !sgct_bench::writeJSONReport(jsonPath, runner, argv[0]))
+        return 1;
+
+    return 0;
+}
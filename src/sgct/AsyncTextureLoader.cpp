@@ -0,0 +1,196 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/AsyncTextureLoader.h>
+#include <sgct/MessageHandler.h>
+#include <new>
+
+sgct_core::AsyncTextureLoader::Result::Result()
+{
+    mSuccess = false;
+    mCompressed = false;
+    mImagePtr = nullptr;
+}
+
+sgct_core::AsyncTextureLoader::Result::~Result()
+{
+    if (mImagePtr)
+        delete mImagePtr;
+}
+
+sgct_core::AsyncTextureLoader::AsyncTextureLoader(std::size_t maxPending)
+{
+    mMaxPending = maxPending > 0 ? maxPending : 1;
+    mThreadPtr = nullptr;
+    mRunning = false;
+}
+
+sgct_core::AsyncTextureLoader::~AsyncTextureLoader()
+{
+    stop();
+}
+
+/*!
+    Queue a texture for loading. The worker thread is started on the first request.
+*/
+void sgct_core::AsyncTextureLoader::request(const Request & req)
+{
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mRequests.push_back(req);
+
+        if (mThreadPtr == nullptr)
+        {
+            mRunning = true;
+            mThreadPtr = new std::thread(&AsyncTextureLoader::work, this);
+        }
+    }
+
+    mCondition.notify_all();
+}
+
+/*!
+    Drop queued requests and finished results for a texture. A load in progress is discarded when done.
+*/
+void sgct_core::AsyncTextureLoader::cancel(const std::string & name)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    for (std::deque<Request>::iterator it = mRequests.begin(); it != mRequests.end();)
+    {
+        if (it->mName == name)
+            it = mRequests.erase(it);
+        else
+            ++it;
+    }
+
+    for (std::deque<Result *>::iterator it = mResults.begin(); it != mResults.end();)
+    {
+        if ((*it)->mRequest.mName == name)
+        {
+            delete (*it);
+            it = mResults.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    if (mActiveName == name)
+        mActiveName.clear(); //marks the active load as cancelled
+
+    mCondition.notify_all();
+}
+
+/*!
+    Stop the worker thread and discard all requests and results.
+*/
+void sgct_core::AsyncTextureLoader::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mRunning = false;
+        mRequests.clear();
+    }
+    mCondition.notify_all();
+
+    if (mThreadPtr)
+    {
+        mThreadPtr->join();
+        delete mThreadPtr;
+        mThreadPtr = nullptr;
+    }
+
+    for (std::size_t i = 0; i < mResults.size(); i++)
+        delete mResults[i];
+    mResults.clear();
+}
+
+/*!
+    \returns the next finished load or nullptr, the caller takes ownership
+*/
+sgct_core::AsyncTextureLoader::Result * sgct_core::AsyncTextureLoader::popResult()
+{
+    Result * result = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mResults.empty())
+            return nullptr;
+
+        result = mResults.front();
+        mResults.pop_front();
+    }
+
+    mCondition.notify_all();
+    return result;
+}
+
+/*!
+    \returns true if there is nothing queued, in progress or waiting to be taken
+*/
+bool sgct_core::AsyncTextureLoader::isIdle()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    return mRequests.empty() && mResults.empty() && mActiveName.empty();
+}
+
+void sgct_core::AsyncTextureLoader::work()
+{
+    while (true)
+    {
+        Result * result = new (std::nothrow) Result();
+        if (result == nullptr)
+            return;
+
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (mRunning && (mRequests.empty() || mResults.size() >= mMaxPending))
+                mCondition.wait(lock);
+
+            if (!mRunning)
+            {
+                delete result;
+                return;
+            }
+
+            result->mRequest = mRequests.front();
+            mRequests.pop_front();
+            mActiveName = result->mRequest.mName;
+        }
+
+        const Request & req = result->mRequest;
+        //same order as TextureManager::loadImageFile: cache hit, else decode and fill the cache
+        if (!req.mCacheDirectory.empty() && CompressedTextureCache::load(req.mCacheDirectory, req.mPath, req.mMipmapLevels, result->mCompressedTexture))
+        {
+            result->mCompressed = true;
+            result->mSuccess = true;
+        }
+        else
+        {
+            result->mImagePtr = new (std::nothrow) Image();
+            result->mSuccess = result->mImagePtr != nullptr && result->mImagePtr->load(req.mPath) && result->mImagePtr->getData() != nullptr;
+
+            if (result->mSuccess && !req.mCacheDirectory.empty() && result->mImagePtr->getBytesPerChannel() == 1 &&
+                CompressedTextureCache::compress(*(result->mImagePtr), req.mMipmapLevels, result->mCompressedTexture))
+            {
+                CompressedTextureCache::store(req.mCacheDirectory, req.mPath, req.mMipmapLevels, result->mCompressedTexture);
+                result->mCompressed = true;
+                delete result->mImagePtr;
+                result->mImagePtr = nullptr;
+            }
+        }
+
+        if (!result->mSuccess)
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "AsyncTextureLoader: Failed to load '%s'!\n", req.mPath.c_str());
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mActiveName == req.mName) //not cancelled
+            mResults.push_back(result);
+        else
+            delete result;
+        mActiveName.clear();
+    }
+}
@@ -0,0 +1,453 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/BCEncoder.h>
+#include <sgct/MessageHandler.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+//blocks rows per thread below which threading isn't worth it
+#define BC_MIN_BLOCK_ROWS_PER_THREAD 16
+
+namespace
+{
+    unsigned short packRGB565(const float * color)
+    {
+        int r = static_cast<int>(color[0] * (31.0f / 255.0f) + 0.5f);
+        int g = static_cast<int>(color[1] * (63.0f / 255.0f) + 0.5f);
+        int b = static_cast<int>(color[2] * (31.0f / 255.0f) + 0.5f);
+        r = std::min(std::max(r, 0), 31);
+        g = std::min(std::max(g, 0), 63);
+        b = std::min(std::max(b, 0), 31);
+        return static_cast<unsigned short>((r << 11) | (g << 5) | b);
+    }
+
+    void unpackRGB565(unsigned short c, int * color)
+    {
+        int r = (c >> 11) & 31;
+        int g = (c >> 5) & 63;
+        int b = c & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    /*
+        Select the closest of the four palette entries for each pixel (4-color mode).
+        Returns the total squared error.
+    */
+    int fitBC1Indices(const unsigned char * rgb, unsigned short c0, unsigned short c1, unsigned char * indices)
+    {
+        int palette[4][3];
+        unpackRGB565(c0, palette[0]);
+        unpackRGB565(c1, palette[1]);
+        for (int c = 0; c < 3; c++)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        }
+
+        int totalError = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            int bestError = 0x7FFFFFFF;
+            for (int p = 0; p < 4; p++)
+            {
+                int dr = rgb[i * 3] - palette[p][0];
+                int dg = rgb[i * 3 + 1] - palette[p][1];
+                int db = rgb[i * 3 + 2] - palette[p][2];
+                int error = dr * dr + dg * dg + db * db;
+                if (error < bestError)
+                {
+                    bestError = error;
+                    indices[i] = static_cast<unsigned char>(p);
+                }
+            }
+            totalError += bestError;
+        }
+
+        return totalError;
+    }
+
+    /*
+        Least squares fit of the two endpoints given the current palette indices.
+        Returns false if the system is degenerate.
+    */
+    bool refineBC1Endpoints(const unsigned char * rgb, const unsigned char * indices, float * e0, float * e1)
+    {
+        static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[3] = { 0.0f, 0.0f, 0.0f };
+        float bx[3] = { 0.0f, 0.0f, 0.0f };
+
+        for (int i = 0; i < 16; i++)
+        {
+            float a = weights[indices[i]];
+            float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < 3; c++)
+            {
+                ax[c] += a * rgb[i * 3 + c];
+                bx[c] += b * rgb[i * 3 + c];
+            }
+        }
+
+        float det = aa * bb - ab * ab;
+        if (fabsf(det) < 1e-6f)
+            return false;
+
+        float invDet = 1.0f / det;
+        for (int c = 0; c < 3; c++)
+        {
+            e0[c] = (ax[c] * bb - bx[c] * ab) * invDet;
+            e1[c] = (bx[c] * aa - ax[c] * ab) * invDet;
+        }
+
+        return true;
+    }
+
+    void writeBC1Block(unsigned short c0, unsigned short c1, unsigned char * indices, unsigned char * dst)
+    {
+        if (c0 < c1)
+        {
+            std::swap(c0, c1);
+            for (int i = 0; i < 16; i++)
+                indices[i] ^= 1; //0<->1, 2<->3
+        }
+        else if (c0 == c1)
+        {
+            memset(indices, 0, 16);
+        }
+
+        unsigned int bits = 0;
+        for (int i = 0; i < 16; i++)
+            bits |= static_cast<unsigned int>(indices[i]) << (2 * i);
+
+        dst[0] = static_cast<unsigned char>(c0 & 0xFF);
+        dst[1] = static_cast<unsigned char>(c0 >> 8);
+        dst[2] = static_cast<unsigned char>(c1 & 0xFF);
+        dst[3] = static_cast<unsigned char>(c1 >> 8);
+        dst[4] = static_cast<unsigned char>(bits & 0xFF);
+        dst[5] = static_cast<unsigned char>((bits >> 8) & 0xFF);
+        dst[6] = static_cast<unsigned char>((bits >> 16) & 0xFF);
+        dst[7] = static_cast<unsigned char>(bits >> 24);
+    }
+}
+
+/*!
+    \returns the format used for images with the given number of channels
+*/
+sgct_core::BCEncoder::Format sgct_core::BCEncoder::getFormatForChannels(std::size_t channels)
+{
+    switch (channels)
+    {
+    case 1:
+        return BC4;
+    case 2:
+        return BC5;
+    case 3:
+        return BC1;
+    default:
+        return BC3;
+    }
+}
+
+/*!
+    \returns the number of bytes per 4x4 block
+*/
+std::size_t sgct_core::BCEncoder::getBlockSize(Format format)
+{
+    return (format == BC1 || format == BC4) ? 8 : 16;
+}
+
+/*!
+    \returns the number of bytes of an encoded image
+*/
+std::size_t sgct_core::BCEncoder::getCompressedSize(Format format, std::size_t width, std::size_t height)
+{
+    return ((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+}
+
+/*!
+    Encode an 8-bit image. Partial blocks at the right and top edges are padded by repeating the edge pixels.
+
+    \param format the block format
+    \param src the source pixels
+    \param width the image width
+    \param height the image height
+    \param channels number of channels in src (BC1 needs at least 3, BC3 4, BC5 2)
+    \param isBGR set to true if src is stored as BGR(A)
+    \param dst destination of getCompressedSize(format, width, height) bytes
+    \param numberOfThreads number of worker threads, 0 uses all hardware threads
+    \returns true on success
+*/
+bool sgct_core::BCEncoder::encode(Format format, const unsigned char * src, std::size_t width, std::size_t height, std::size_t channels,
+    bool isBGR, unsigned char * dst, std::size_t numberOfThreads)
+{
+    std::size_t requiredChannels = (format == BC1) ? 3 : ((format == BC3) ? 4 : ((format == BC5) ? 2 : 1));
+    if (src == nullptr || dst == nullptr || width == 0 || height == 0 || channels < requiredChannels)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "BCEncoder: Invalid image or channel count for format!\n");
+        return false;
+    }
+
+    std::size_t blockRows = (height + 3) / 4;
+    if (numberOfThreads == 0)
+        numberOfThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    numberOfThreads = std::max<std::size_t>(std::min(numberOfThreads, blockRows / BC_MIN_BLOCK_ROWS_PER_THREAD), 1);
+
+    if (numberOfThreads == 1)
+    {
+        encodeRows(format, src, width, height, channels, isBGR, dst, 0, blockRows);
+        return true;
+    }
+
+    std::vector<std::thread> threads;
+    std::size_t rowsPerThread = (blockRows + numberOfThreads - 1) / numberOfThreads;
+    for (std::size_t first = 0; first < blockRows; first += rowsPerThread)
+        threads.push_back(std::thread(&BCEncoder::encodeRows, format, src, width, height, channels, isBGR, dst,
+            first, std::min(first + rowsPerThread, blockRows)));
+
+    for (std::size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    return true;
+}
+
+void sgct_core::BCEncoder::encodeRows(Format format, const unsigned char * src, std::size_t width, std::size_t height, std::size_t channels,
+    bool isBGR, unsigned char * dst, std::size_t firstBlockRow, std::size_t lastBlockRow)
+{
+    std::size_t blocksX = (width + 3) / 4;
+    std::size_t blockSize = getBlockSize(format);
+    std::size_t redIndex = (isBGR && channels >= 3) ? 2 : 0;
+    std::size_t blueIndex = (isBGR && channels >= 3) ? 0 : 2;
+
+    unsigned char rgb[16 * 3];
+    unsigned char values[2][16];
+
+    for (std::size_t by = firstBlockRow; by < lastBlockRow; by++)
+    {
+        unsigned char * blockPtr = dst + by * blocksX * blockSize;
+
+        for (std::size_t bx = 0; bx < blocksX; bx++)
+        {
+            for (std::size_t i = 0; i < 16; i++)
+            {
+                std::size_t x = std::min(bx * 4 + (i & 3), width - 1);
+                std::size_t y = std::min(by * 4 + (i >> 2), height - 1);
+                const unsigned char * pixel = src + (y * width + x) * channels;
+
+                switch (format)
+                {
+                case BC1:
+                case BC3:
+                    rgb[i * 3] = pixel[redIndex];
+                    rgb[i * 3 + 1] = pixel[1];
+                    rgb[i * 3 + 2] = pixel[blueIndex];
+                    values[0][i] = (format == BC3) ? pixel[3] : 255;
+                    break;
+                case BC4:
+                    values[0][i] = pixel[redIndex];
+                    break;
+                case BC5:
+                    values[0][i] = pixel[redIndex];
+                    values[1][i] = pixel[1];
+                    break;
+                }
+            }
+
+            switch (format)
+            {
+            case BC1:
+                encodeBC1Block(rgb, blockPtr);
+                break;
+            case BC3:
+                encodeChannelBlock(values[0], blockPtr);
+                encodeBC1Block(rgb, blockPtr + 8);
+                break;
+            case BC4:
+                encodeChannelBlock(values[0], blockPtr);
+                break;
+            case BC5:
+                encodeChannelBlock(values[0], blockPtr);
+                encodeChannelBlock(values[1], blockPtr + 8);
+                break;
+            }
+
+            blockPtr += blockSize;
+        }
+    }
+}
+
+/*!
+    Encode a 4x4 block of RGB pixels (48 bytes) into an 8 byte BC1 block using the four color mode.
+*/
+void sgct_core::BCEncoder::encodeBC1Block(const unsigned char * rgb, unsigned char * dst)
+{
+    float mean[3] = { 0.0f, 0.0f, 0.0f };
+    int minColor[3] = { 255, 255, 255 };
+    int maxColor[3] = { 0, 0, 0 };
+
+    for (int i = 0; i < 16; i++)
+        for (int c = 0; c < 3; c++)
+        {
+            mean[c] += rgb[i * 3 + c];
+            minColor[c] = std::min<int>(minColor[c], rgb[i * 3 + c]);
+            maxColor[c] = std::max<int>(maxColor[c], rgb[i * 3 + c]);
+        }
+
+    for (int c = 0; c < 3; c++)
+        mean[c] /= 16.0f;
+
+    unsigned char indices[16];
+
+    //solid block
+    if (minColor[0] == maxColor[0] && minColor[1] == maxColor[1] && minColor[2] == maxColor[2])
+    {
+        unsigned short c = packRGB565(mean);
+        memset(indices, 0, sizeof(indices));
+        writeBC1Block(c, c, indices, dst);
+        return;
+    }
+
+    //principal axis by power iteration on the covariance matrix
+    float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; i++)
+    {
+        float r = rgb[i * 3] - mean[0];
+        float g = rgb[i * 3 + 1] - mean[1];
+        float b = rgb[i * 3 + 2] - mean[2];
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+
+    float axis[3] = {
+        static_cast<float>(maxColor[0] - minColor[0]),
+        static_cast<float>(maxColor[1] - minColor[1]),
+        static_cast<float>(maxColor[2] - minColor[2]) };
+
+    for (int iter = 0; iter < 8; iter++)
+    {
+        float r = axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2];
+        float g = axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4];
+        float b = axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5];
+        float maxComponent = std::max(fabsf(r), std::max(fabsf(g), fabsf(b)));
+        if (maxComponent < 1e-6f)
+            break;
+        axis[0] = r / maxComponent;
+        axis[1] = g / maxComponent;
+        axis[2] = b / maxComponent;
+    }
+
+    //extremes along the axis
+    float minDot = 1e30f;
+    float maxDot = -1e30f;
+    int minIndex = 0;
+    int maxIndex = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        float dot = rgb[i * 3] * axis[0] + rgb[i * 3 + 1] * axis[1] + rgb[i * 3 + 2] * axis[2];
+        if (dot < minDot)
+        {
+            minDot = dot;
+            minIndex = i;
+        }
+        if (dot > maxDot)
+        {
+            maxDot = dot;
+            maxIndex = i;
+        }
+    }
+
+    float e0[3] = { static_cast<float>(rgb[maxIndex * 3]), static_cast<float>(rgb[maxIndex * 3 + 1]), static_cast<float>(rgb[maxIndex * 3 + 2]) };
+    float e1[3] = { static_cast<float>(rgb[minIndex * 3]), static_cast<float>(rgb[minIndex * 3 + 1]), static_cast<float>(rgb[minIndex * 3 + 2]) };
+
+    unsigned short c0 = packRGB565(e0);
+    unsigned short c1 = packRGB565(e1);
+    int error = fitBC1Indices(rgb, c0, c1, indices);
+
+    //one least squares refinement
+    unsigned char refinedIndices[16];
+    if (refineBC1Endpoints(rgb, indices, e0, e1))
+    {
+        unsigned short r0 = packRGB565(e0);
+        unsigned short r1 = packRGB565(e1);
+        if (r0 != r1)
+        {
+            int refinedError = fitBC1Indices(rgb, r0, r1, refinedIndices);
+            if (refinedError < error)
+            {
+                c0 = r0;
+                c1 = r1;
+                memcpy(indices, refinedIndices, sizeof(indices));
+            }
+        }
+    }
+
+    writeBC1Block(c0, c1, indices, dst);
+}
+
+/*!
+    Encode 16 single channel values into an 8 byte BC4 block (also used for BC3 alpha and the BC5 channels)
+    using the eight value mode.
+*/
+void sgct_core::BCEncoder::encodeChannelBlock(const unsigned char * values, unsigned char * dst)
+{
+    int minValue = 255;
+    int maxValue = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        minValue = std::min<int>(minValue, values[i]);
+        maxValue = std::max<int>(maxValue, values[i]);
+    }
+
+    dst[0] = static_cast<unsigned char>(maxValue);
+    dst[1] = static_cast<unsigned char>(minValue);
+
+    if (minValue == maxValue)
+    {
+        memset(dst + 2, 0, 6);
+        return;
+    }
+
+    int palette[8];
+    palette[0] = maxValue;
+    palette[1] = minValue;
+    for (int p = 2; p < 8; p++)
+        palette[p] = ((8 - p) * maxValue + (p - 1) * minValue + 3) / 7;
+
+    unsigned long long bits = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        int bestError = 256;
+        unsigned long long bestIndex = 0;
+        for (int p = 0; p < 8; p++)
+        {
+            int error = abs(values[i] - palette[p]);
+            if (error < bestError)
+            {
+                bestError = error;
+                bestIndex = static_cast<unsigned long long>(p);
+            }
+        }
+        bits |= bestIndex << (3 * i);
+    }
+
+    for (int b = 0; b < 6; b++)
+        dst[2 + b] = static_cast<unsigned char>((bits >> (8 * b)) & 0xFF);
+}
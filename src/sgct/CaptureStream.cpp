@@ -0,0 +1,375 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifdef __WIN32__
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else //Use BSD sockets
+    #include <unistd.h>
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #define INVALID_SOCKET (SGCT_SOCKET)(~0)
+#endif
+
+#include <sgct/CaptureStream.h>
+#include <sgct/Image.h>
+#include <sgct/MessageHandler.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sstream>
+
+#define SGCT_Y4M_FRAME_HEADER "FRAME\n"
+#define SGCT_Y4M_FRAME_HEADER_SIZE 6
+
+sgct_core::CaptureStream::CaptureStream()
+{
+    mType = FILE_TARGET;
+    mFile = nullptr;
+    mSocket = INVALID_SOCKET;
+    mWinsockStarted = false;
+    mWidth = 0;
+    mHeight = 0;
+    mOpen = false;
+    mFailed = false;
+    mNextReserved = 0;
+    mNextWrite = 0;
+    mWrittenFrames = 0;
+    mDroppedFrames = 0;
+}
+
+sgct_core::CaptureStream::~CaptureStream()
+{
+    close();
+}
+
+/*!
+    \returns the kind of target described by the string, see the class description
+*/
+sgct_core::CaptureStream::TargetType sgct_core::CaptureStream::getTargetType(const std::string & target)
+{
+    if (target.compare(0, 5, "unix:") == 0)
+        return UNIX_SOCKET_TARGET;
+    else if (target.compare(0, 4, "tcp:") == 0)
+        return TCP_SOCKET_TARGET;
+    else
+        return FILE_TARGET;
+}
+
+/*!
+    Opens the target and writes the Y4M stream header. A previously opened stream is closed first.
+
+    \param target file, named pipe or socket address (see the class description)
+    \param width the frame width in pixels
+    \param height the frame height in pixels
+    \param frameRate the frame rate stored in the stream header
+    \param comment optional text added to the header as an X parameter (no spaces)
+    \returns true if the target could be opened
+*/
+bool sgct_core::CaptureStream::open(const std::string & target, int width, int height, int frameRate, const std::string & comment)
+{
+    close();
+
+    if (width <= 0 || height <= 0)
+        return false;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    mTarget = target;
+    mType = getTargetType(target);
+    mWidth = width;
+    mHeight = height;
+    mFailed = false;
+    mWrittenFrames = 0;
+    mDroppedFrames = 0;
+
+    if (mType == FILE_TARGET)
+    {
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+        if (fopen_s(&mFile, target.c_str(), "wb") != 0)
+            mFile = nullptr;
+#else
+        mFile = fopen(target.c_str(), "wb");
+#endif
+        if (mFile == nullptr)
+        {
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CaptureStream: Failed to open '%s' for writing!\n", target.c_str());
+            return false;
+        }
+    }
+    else if (!openSocket(mType, target.substr(mType == UNIX_SOCKET_TARGET ? 5 : 4)))
+        return false;
+
+    std::stringstream ss;
+    ss << "YUV4MPEG2 W" << width << " H" << height << " F" << (frameRate > 0 ? frameRate : 60) << ":1 Ip A1:1 C420jpeg";
+    if (!comment.empty())
+        ss << " X" << comment;
+    ss << "\n";
+    std::string header = ss.str();
+
+    mOpen = true;
+    if (!write(reinterpret_cast<const unsigned char *>(header.c_str()), header.size()))
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CaptureStream: Failed to write header to '%s'!\n", target.c_str());
+        closeTarget();
+        mOpen = false;
+        return false;
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO, "CaptureStream: Streaming %dx%d frames to '%s'.\n", width, height, target.c_str());
+    return true;
+}
+
+/*!
+    Waits for all reserved frames to be written or skipped and closes the target.
+*/
+void sgct_core::CaptureStream::close()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (mNextWrite != mNextReserved)
+        mCondition.wait(lock);
+
+    if (!mOpen)
+        return;
+
+    closeTarget();
+    mOpen = false;
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO, "CaptureStream: Closed '%s' (%llu frames written, %llu dropped).\n",
+        mTarget.c_str(), mWrittenFrames.load(), mDroppedFrames.load());
+}
+
+bool sgct_core::CaptureStream::isOpen()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    return mOpen && !mFailed;
+}
+
+/*!
+    Reserves the position of the next frame in the stream. Must be called in frame order (the render thread) and
+    every reserved frame must be passed to writeFrame or skipFrame.
+*/
+unsigned long long sgct_core::CaptureStream::reserveFrame()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    return mNextReserved++;
+}
+
+/*!
+    Converts a frame to I420 and writes it once all earlier frames have been written. Called from the capture threads.
+
+    \param sequence the number returned by reserveFrame
+    \param data 8-bit pixel data of getWidth() x getHeight() pixels
+    \param channels number of channels (3 or 4)
+    \param isBGR true if the red and blue channels are swapped
+    \param flipVertical true if the rows are stored bottom-up
+    \param buffer conversion buffer owned by the calling thread, reused between frames
+*/
+void sgct_core::CaptureStream::writeFrame(unsigned long long sequence, const unsigned char * data, std::size_t channels, bool isBGR, bool flipVertical,
+    std::vector<unsigned char> & buffer)
+{
+    std::size_t width, height;
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        width = static_cast<std::size_t>(mWidth);
+        height = static_cast<std::size_t>(mHeight);
+    }
+
+    std::size_t lumaSize = width * height;
+    std::size_t chromaSize = ((width + 1) / 2) * ((height + 1) / 2);
+    buffer.resize(SGCT_Y4M_FRAME_HEADER_SIZE + lumaSize + chromaSize * 2);
+    memcpy(&buffer[0], SGCT_Y4M_FRAME_HEADER, SGCT_Y4M_FRAME_HEADER_SIZE);
+
+    unsigned char * planes = &buffer[SGCT_Y4M_FRAME_HEADER_SIZE];
+    if (lumaSize > 0)
+        Image::convertToI420(data, width, height, channels, isBGR, flipVertical, planes, planes + lumaSize, planes + lumaSize + chromaSize);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    waitForTurn(lock, sequence);
+
+    if (mOpen && !mFailed && lumaSize > 0)
+    {
+        if (write(&buffer[0], buffer.size()))
+            mWrittenFrames++;
+        else
+        {
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CaptureStream: Failed to write to '%s', dropping frames!\n", mTarget.c_str());
+            mFailed = true;
+            mDroppedFrames++;
+        }
+    }
+    else
+        mDroppedFrames++;
+
+    finishTurn();
+}
+
+/*!
+    Gives up a reserved frame so that the frames after it can be written.
+*/
+void sgct_core::CaptureStream::skipFrame(unsigned long long sequence)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    waitForTurn(lock, sequence);
+    mDroppedFrames++;
+    finishTurn();
+}
+
+unsigned long long sgct_core::CaptureStream::getWrittenFrames()
+{
+    return mWrittenFrames.load();
+}
+
+unsigned long long sgct_core::CaptureStream::getDroppedFrames()
+{
+    return mDroppedFrames.load();
+}
+
+void sgct_core::CaptureStream::waitForTurn(std::unique_lock<std::mutex> & lock, unsigned long long sequence)
+{
+    while (mNextWrite != sequence)
+        mCondition.wait(lock);
+}
+
+void sgct_core::CaptureStream::finishTurn()
+{
+    mNextWrite++;
+    mCondition.notify_all();
+}
+
+/*
+    Writes one message, must be called with the mutex locked. Socket messages are prefixed with their size.
+*/
+bool sgct_core::CaptureStream::write(const unsigned char * data, std::size_t size)
+{
+    if (mType == FILE_TARGET)
+        return mFile != nullptr && fwrite(data, 1, size, mFile) == size;
+
+    if (mSocket == INVALID_SOCKET || size > 0xFFFFFFFFULL)
+        return false;
+
+    unsigned char prefix[4];
+    for (int i = 0; i < 4; i++)
+        prefix[i] = static_cast<unsigned char>((size >> (8 * i)) & 0xFF);
+
+    const unsigned char * parts[2] = { prefix, data };
+    std::size_t sizes[2] = { sizeof(prefix), size };
+    for (int p = 0; p < 2; p++)
+    {
+        std::size_t sent = 0;
+        while (sent < sizes[p])
+        {
+            std::size_t chunk = sizes[p] - sent;
+            if (chunk > (1 << 30))
+                chunk = (1 << 30);
+#ifdef __WIN32__
+            int result = send(mSocket, reinterpret_cast<const char *>(parts[p] + sent), static_cast<int>(chunk), 0);
+#elif defined(MSG_NOSIGNAL)
+            ssize_t result = send(mSocket, parts[p] + sent, chunk, MSG_NOSIGNAL);
+#else
+            ssize_t result = send(mSocket, parts[p] + sent, chunk, 0);
+#endif
+            if (result <= 0)
+                return false;
+            sent += static_cast<std::size_t>(result);
+        }
+    }
+
+    return true;
+}
+
+bool sgct_core::CaptureStream::openSocket(TargetType type, const std::string & address)
+{
+#ifdef __WIN32__
+    if (type == UNIX_SOCKET_TARGET)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CaptureStream: Local unix sockets are not supported on this platform, use tcp:<port>!\n");
+        return false;
+    }
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CaptureStream: Failed to init winsock!\n");
+        return false;
+    }
+    mWinsockStarted = true;
+#endif
+
+    int result = -1;
+    if (type == TCP_SOCKET_TARGET)
+    {
+        int port = atoi(address.c_str());
+        mSocket = (port > 0 && port < 65536) ? socket(AF_INET, SOCK_STREAM, IPPROTO_TCP) : INVALID_SOCKET;
+        if (mSocket != INVALID_SOCKET)
+        {
+            struct sockaddr_in addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(static_cast<unsigned short>(port));
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            result = connect(mSocket, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+        }
+    }
+#ifndef __WIN32__
+    else
+    {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        mSocket = (!address.empty() && address.size() < sizeof(addr.sun_path)) ? socket(AF_UNIX, SOCK_STREAM, 0) : INVALID_SOCKET;
+        if (mSocket != INVALID_SOCKET)
+        {
+            memcpy(addr.sun_path, address.c_str(), address.size());
+            result = connect(mSocket, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+        }
+    }
+#endif
+
+    if (result != 0)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CaptureStream: Failed to connect to '%s'!\n", mTarget.c_str());
+        closeTarget();
+        return false;
+    }
+
+    return true;
+}
+
+void sgct_core::CaptureStream::closeTarget()
+{
+    if (mFile != nullptr)
+    {
+        fclose(mFile);
+        mFile = nullptr;
+    }
+
+    if (mSocket != INVALID_SOCKET)
+    {
+#ifdef __WIN32__
+        closesocket(mSocket);
+#else
+        ::close(mSocket);
+#endif
+        mSocket = INVALID_SOCKET;
+    }
+
+#ifdef __WIN32__
+    //only balance our own startup, winsock is shared with the cluster connections
+    if (mWinsockStarted)
+    {
+        WSACleanup();
+        mWinsockStarted = false;
+    }
+#endif
+}
@@ -0,0 +1,165 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/ClockSync.h>
+#include <algorithm>
+#include <cmath>
+
+//corrections smaller than this don't make the master time go backwards, larger ones step the clock like NTP does
+#define CLOCK_SYNC_STEP_THRESHOLD 0.128
+//the offsets of samples are fitted to a line once they span this many seconds
+#define CLOCK_SYNC_MIN_DRIFT_SPAN 2.0
+
+const std::size_t sgct_core::ClockSync::MaxSamples;
+const std::size_t sgct_core::ClockSync::MinSamples;
+const double sgct_core::ClockSync::MaxDrift = 500e-6;
+
+sgct_core::ClockSync::ClockSync()
+{
+    reset();
+}
+
+/*!
+Add the four time stamps of a request and its reply.
+
+\param t0 local time when the request was sent
+\param t1 master time when the request was received
+\param t2 master time when the reply was sent
+\param t3 local time when the reply was received
+*/
+void sgct_core::ClockSync::addSample(double t0, double t1, double t2, double t3)
+{
+    Sample sample;
+    sample.mTime = (t0 + t3) * 0.5;
+    sample.mOffset = ((t1 - t0) + (t2 - t3)) * 0.5;
+    sample.mRoundTripTime = (t3 - t0) - (t2 - t1);
+    if (sample.mRoundTripTime < 0.0)
+        return; //the stamps don't belong together
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSamples[mNumberOfSamples % MaxSamples] = sample;
+    mNumberOfSamples++;
+    estimate();
+}
+
+/*!
+Forget all samples, for example after reconnecting to a restarted master.
+*/
+void sgct_core::ClockSync::reset()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mNumberOfSamples = 0;
+    mSynchronized = false;
+    mReferenceTime = 0.0;
+    mOffset = 0.0;
+    mDrift = 0.0;
+    mRoundTripTime = 0.0;
+    mJitter = 0.0;
+    mUsedSamples = 0;
+    mLastMasterTime = -1.0;
+}
+
+/*!
+\returns the master time at a local time, the local time until the first sample has arrived
+*/
+double sgct_core::ClockSync::toMasterTime(double localTime)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    double masterTime = localTime + mOffset + mDrift * (localTime - mReferenceTime);
+
+    if (masterTime < mLastMasterTime && mLastMasterTime - masterTime < CLOCK_SYNC_STEP_THRESHOLD)
+        return mLastMasterTime;
+    mLastMasterTime = masterTime;
+    return masterTime;
+}
+
+sgct_core::ClockSync::Quality sgct_core::ClockSync::getQuality(double localTime)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Quality quality;
+    quality.mSynchronized = mSynchronized;
+    quality.mOffset = mOffset + mDrift * (localTime - mReferenceTime);
+    quality.mDrift = mDrift;
+    quality.mRoundTripTime = mRoundTripTime;
+    quality.mJitter = mJitter;
+    quality.mErrorBound = mRoundTripTime * 0.5 + mJitter;
+    quality.mNumberOfSamples = mUsedSamples;
+    return quality;
+}
+
+/*!
+\returns the number of samples added since the last reset
+*/
+std::size_t sgct_core::ClockSync::getNumberOfSamples()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mNumberOfSamples;
+}
+
+/*!
+Update the offset and drift from the kept samples, called with the mutex locked.
+*/
+void sgct_core::ClockSync::estimate()
+{
+    std::size_t count = std::min(mNumberOfSamples, MaxSamples);
+
+    //queueing only ever adds delay, so the samples with the shortest round trips have the smallest errors
+    double roundTripTimes[MaxSamples];
+    for (std::size_t i = 0; i < count; i++)
+        roundTripTimes[i] = mSamples[i].mRoundTripTime;
+    std::size_t used = std::min(count, std::max(MinSamples, count / 2));
+    std::nth_element(roundTripTimes, roundTripTimes + (used - 1), roundTripTimes + count);
+    double threshold = roundTripTimes[used - 1];
+
+    std::size_t n = 0;
+    double minRoundTripTime = threshold;
+    double sumTime = 0.0, sumOffset = 0.0;
+    double minTime = mSamples[0].mTime, maxTime = mSamples[0].mTime;
+    for (std::size_t i = 0; i < count; i++)
+        if (mSamples[i].mRoundTripTime <= threshold)
+        {
+            n++;
+            sumTime += mSamples[i].mTime;
+            sumOffset += mSamples[i].mOffset;
+            minRoundTripTime = std::min(minRoundTripTime, mSamples[i].mRoundTripTime);
+            minTime = std::min(minTime, mSamples[i].mTime);
+            maxTime = std::max(maxTime, mSamples[i].mTime);
+        }
+
+    double meanTime = sumTime / static_cast<double>(n);
+    double meanOffset = sumOffset / static_cast<double>(n);
+
+    double drift = 0.0;
+    if (n >= MinSamples && maxTime - minTime >= CLOCK_SYNC_MIN_DRIFT_SPAN)
+    {
+        double sxx = 0.0, sxy = 0.0;
+        for (std::size_t i = 0; i < count; i++)
+            if (mSamples[i].mRoundTripTime <= threshold)
+            {
+                double dt = mSamples[i].mTime - meanTime;
+                sxx += dt * dt;
+                sxy += dt * (mSamples[i].mOffset - meanOffset);
+            }
+        drift = std::max(-MaxDrift, std::min(MaxDrift, sxy / sxx));
+    }
+
+    double sumSquares = 0.0;
+    for (std::size_t i = 0; i < count; i++)
+        if (mSamples[i].mRoundTripTime <= threshold)
+        {
+            double residual = mSamples[i].mOffset - (meanOffset + drift * (mSamples[i].mTime - meanTime));
+            sumSquares += residual * residual;
+        }
+
+    mReferenceTime = meanTime;
+    mOffset = meanOffset;
+    mDrift = drift;
+    mRoundTripTime = minRoundTripTime;
+    mJitter = sqrt(sumSquares / static_cast<double>(n));
+    mUsedSamples = n;
+    mSynchronized = count >= MinSamples;
+}
@@ -0,0 +1,279 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/ClusterConfigSnapshot.h>
+#include <sgct/SGCTVersion.h>
+#include <sgct/helpers/SGCTFileFunctions.h>
+#include <map>
+#include <cstring>
+
+namespace
+{
+    const char SnapshotMagic[4] = { 'S', 'G', 'C', 'S' };
+    const unsigned int SnapshotFormatVersion = 1;
+    const unsigned int NoString = 0xFFFFFFFF;
+    const unsigned int MaxElementDepth = 64;
+
+    /*
+        All integers are stored as 32-bit little endian so the snapshot doesn't depend on the host.
+    */
+    class SnapshotWriter
+    {
+    public:
+        void writeUInt(std::vector<char> & buffer, unsigned int value)
+        {
+            for (int i = 0; i < 4; i++)
+                buffer.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+        }
+
+        unsigned int addString(const char * str)
+        {
+            if (str == nullptr)
+                return NoString;
+
+            std::map<std::string, unsigned int>::iterator it = mStringIndices.find(str);
+            if (it != mStringIndices.end())
+                return it->second;
+
+            unsigned int index = static_cast<unsigned int>(mStrings.size());
+            mStrings.push_back(str);
+            mStringIndices[str] = index;
+            return index;
+        }
+
+        void writeElement(const tinyxml2::XMLElement * element)
+        {
+            writeUInt(mTree, addString(element->Value()));
+            writeUInt(mTree, addString(element->GetText()));
+
+            unsigned int numberOfAttributes = 0;
+            for (const tinyxml2::XMLAttribute * attr = element->FirstAttribute(); attr != nullptr; attr = attr->Next())
+                numberOfAttributes++;
+            writeUInt(mTree, numberOfAttributes);
+            for (const tinyxml2::XMLAttribute * attr = element->FirstAttribute(); attr != nullptr; attr = attr->Next())
+            {
+                writeUInt(mTree, addString(attr->Name()));
+                writeUInt(mTree, addString(attr->Value()));
+            }
+
+            unsigned int numberOfChildren = 0;
+            for (const tinyxml2::XMLElement * child = element->FirstChildElement(); child != nullptr; child = child->NextSiblingElement())
+                numberOfChildren++;
+            writeUInt(mTree, numberOfChildren);
+            for (const tinyxml2::XMLElement * child = element->FirstChildElement(); child != nullptr; child = child->NextSiblingElement())
+                writeElement(child);
+        }
+
+        void finish(std::vector<char> & snapshot)
+        {
+            snapshot.clear();
+            snapshot.insert(snapshot.end(), SnapshotMagic, SnapshotMagic + 4);
+            writeUInt(snapshot, SnapshotFormatVersion);
+
+            std::string version = sgct::getSGCTVersion();
+            writeUInt(snapshot, static_cast<unsigned int>(version.size()));
+            snapshot.insert(snapshot.end(), version.begin(), version.end());
+
+            writeUInt(snapshot, static_cast<unsigned int>(mStrings.size()));
+            for (std::size_t i = 0; i < mStrings.size(); i++)
+            {
+                writeUInt(snapshot, static_cast<unsigned int>(mStrings[i].size()));
+                snapshot.insert(snapshot.end(), mStrings[i].begin(), mStrings[i].end());
+            }
+
+            snapshot.insert(snapshot.end(), mTree.begin(), mTree.end());
+        }
+
+    private:
+        std::vector<std::string> mStrings;
+        std::map<std::string, unsigned int> mStringIndices;
+        std::vector<char> mTree;
+    };
+
+    class SnapshotReader
+    {
+    public:
+        SnapshotReader(const char * data, std::size_t size) : mData(data), mSize(size), mPos(0) {}
+
+        bool readUInt(unsigned int & value)
+        {
+            if (mSize - mPos < 4)
+                return false;
+
+            value = 0;
+            for (int i = 0; i < 4; i++)
+                value |= static_cast<unsigned int>(static_cast<unsigned char>(mData[mPos + i])) << (i * 8);
+            mPos += 4;
+            return true;
+        }
+
+        bool readString(std::string & str)
+        {
+            unsigned int length;
+            if (!readUInt(length) || mSize - mPos < length)
+                return false;
+
+            str.assign(mData + mPos, length);
+            mPos += length;
+            return true;
+        }
+
+        bool readStringTable()
+        {
+            unsigned int numberOfStrings;
+            //every string needs at least its length
+            if (!readUInt(numberOfStrings) || numberOfStrings > (mSize - mPos) / 4)
+                return false;
+
+            mStrings.resize(numberOfStrings);
+            for (unsigned int i = 0; i < numberOfStrings; i++)
+                if (!readString(mStrings[i]))
+                    return false;
+            return true;
+        }
+
+        bool readStringIndex(const char *& str, bool allowNone)
+        {
+            unsigned int index;
+            if (!readUInt(index))
+                return false;
+
+            if (index == NoString)
+            {
+                str = nullptr;
+                return allowNone;
+            }
+
+            if (index >= mStrings.size())
+                return false;
+            str = mStrings[index].c_str();
+            return true;
+        }
+
+        tinyxml2::XMLElement * readElement(tinyxml2::XMLDocument & xmlDoc, unsigned int depth)
+        {
+            const char * name;
+            const char * text;
+            unsigned int numberOfAttributes;
+            if (depth > MaxElementDepth || !readStringIndex(name, false) || !readStringIndex(text, true) || !readUInt(numberOfAttributes))
+                return nullptr;
+
+            tinyxml2::XMLElement * element = xmlDoc.NewElement(name);
+            if (text != nullptr)
+                element->SetText(text);
+
+            for (unsigned int i = 0; i < numberOfAttributes; i++)
+            {
+                const char * attrName;
+                const char * attrValue;
+                if (!readStringIndex(attrName, false) || !readStringIndex(attrValue, false))
+                {
+                    xmlDoc.DeleteNode(element);
+                    return nullptr;
+                }
+                element->SetAttribute(attrName, attrValue);
+            }
+
+            unsigned int numberOfChildren;
+            if (!readUInt(numberOfChildren))
+            {
+                xmlDoc.DeleteNode(element);
+                return nullptr;
+            }
+
+            for (unsigned int i = 0; i < numberOfChildren; i++)
+            {
+                tinyxml2::XMLElement * child = readElement(xmlDoc, depth + 1);
+                if (child == nullptr)
+                {
+                    xmlDoc.DeleteNode(element);
+                    return nullptr;
+                }
+                element->InsertEndChild(child);
+            }
+
+            return element;
+        }
+
+        bool isAtEnd() const { return mPos == mSize; }
+
+    private:
+        const char * mData;
+        std::size_t mSize;
+        std::size_t mPos;
+        std::vector<std::string> mStrings;
+    };
+}
+
+/*!
+Encode the root element of a configuration document.
+\returns false if the document is empty
+*/
+bool sgct_core::ClusterConfigSnapshot::encode(const tinyxml2::XMLDocument & xmlDoc, std::vector<char> & snapshot)
+{
+    const tinyxml2::XMLElement * root = xmlDoc.RootElement();
+    if (root == nullptr)
+        return false;
+
+    SnapshotWriter writer;
+    writer.writeElement(root);
+    writer.finish(snapshot);
+    return true;
+}
+
+/*!
+Rebuild a configuration document from a snapshot.
+\param data the snapshot
+\param size the size of the snapshot in bytes
+\param xmlDoc the document to fill, any previous content is removed
+\param errorMsg the reason if the snapshot is refused
+\returns true if the snapshot was valid and made by the same SGCT version
+*/
+bool sgct_core::ClusterConfigSnapshot::decode(const char * data, std::size_t size, tinyxml2::XMLDocument & xmlDoc, std::string & errorMsg)
+{
+    xmlDoc.Clear();
+
+    if (data == nullptr || size < 8 || memcmp(data, SnapshotMagic, 4) != 0)
+    {
+        errorMsg.assign("Not a configuration snapshot");
+        return false;
+    }
+
+    SnapshotReader reader(data + 4, size - 4);
+    unsigned int formatVersion;
+    std::string version;
+    if (!reader.readUInt(formatVersion) || formatVersion != SnapshotFormatVersion || !reader.readString(version))
+    {
+        errorMsg.assign("Unsupported configuration snapshot format");
+        return false;
+    }
+
+    if (version != sgct::getSGCTVersion())
+    {
+        errorMsg = "Configuration snapshot was created by " + version + " but this node runs " + sgct::getSGCTVersion();
+        return false;
+    }
+
+    tinyxml2::XMLElement * root = nullptr;
+    if (!reader.readStringTable() || (root = reader.readElement(xmlDoc, 0)) == nullptr || !reader.isAtEnd())
+    {
+        xmlDoc.Clear();
+        errorMsg.assign("Corrupt configuration snapshot");
+        return false;
+    }
+
+    xmlDoc.InsertEndChild(root);
+    return true;
+}
+
+/*!
+\returns the hash that nodes compare to verify that they use the same configuration
+*/
+unsigned long long sgct_core::ClusterConfigSnapshot::hash(const std::vector<char> & snapshot)
+{
+    return sgct_helpers::hashFNV1a(snapshot.data(), snapshot.size());
+}
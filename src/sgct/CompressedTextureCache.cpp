@@ -0,0 +1,293 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/CompressedTextureCache.h>
+#include <sgct/Image.h>
+#include <sgct/MessageHandler.h>
+#include <sgct/Engine.h>
+#include <sgct/helpers/SGCTFileFunctions.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include <functional>
+
+#define BC_CACHE_MAGIC "SGCTBCTX"
+#define BC_CACHE_MAGIC_LENGTH 8
+#define BC_CACHE_VERSION 1
+#define BC_CACHE_HEADER_FIELDS 8
+
+namespace
+{
+    FILE * openFile(const std::string & filename, const char * mode)
+    {
+        FILE * fp = nullptr;
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+        if (fopen_s(&fp, filename.c_str(), mode) != 0)
+            fp = nullptr;
+#else
+        fp = fopen(filename.c_str(), mode);
+#endif
+        return fp;
+    }
+}
+
+sgct_core::CompressedTexture::CompressedTexture()
+{
+    mFormat = BCEncoder::BC1;
+    mWidth = 0;
+    mHeight = 0;
+    mChannels = 0;
+}
+
+/*!
+    Get the cache entry filename for a source image.
+    \returns an empty string if the source doesn't exist
+*/
+std::string sgct_core::CompressedTextureCache::getCacheFilename(const std::string & cacheDirectory, const std::string & source, int mipmapLevels)
+{
+    unsigned long long mtime, size;
+    if (!sgct_helpers::getFileInfo(source, mtime, size))
+        return std::string();
+
+    unsigned int settings[2] = { BC_CACHE_VERSION, static_cast<unsigned int>(std::max(mipmapLevels, 1)) };
+    unsigned long long hash = sgct_helpers::hashFNV1a(source.c_str(), source.size());
+    hash = sgct_helpers::hashFNV1a(&mtime, sizeof(mtime), hash);
+    hash = sgct_helpers::hashFNV1a(&size, sizeof(size), hash);
+    hash = sgct_helpers::hashFNV1a(settings, sizeof(settings), hash);
+
+    char name[32];
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    sprintf_s(name, sizeof(name), "%016llx.sgctbc", hash);
+#else
+    sprintf(name, "%016llx.sgctbc", hash);
+#endif
+
+    std::string filename(cacheDirectory);
+    if (!filename.empty() && filename[filename.size() - 1] != '/' && filename[filename.size() - 1] != '\\')
+        filename.push_back('/');
+    filename.append(name);
+
+    return filename;
+}
+
+/*!
+    Load a cache entry for a source image.
+    \returns false if there is no valid entry for the current version of the source
+*/
+bool sgct_core::CompressedTextureCache::load(const std::string & cacheDirectory, const std::string & source, int mipmapLevels, CompressedTexture & texture)
+{
+    double t0 = sgct::Engine::getTime();
+
+    unsigned long long mtime, size;
+    if (!sgct_helpers::getFileInfo(source, mtime, size))
+        return false;
+
+    std::string filename = getCacheFilename(cacheDirectory, source, mipmapLevels);
+    FILE * fp = openFile(filename, "rb");
+    if (fp == nullptr)
+        return false;
+
+    char magic[BC_CACHE_MAGIC_LENGTH];
+    unsigned int header[BC_CACHE_HEADER_FIELDS];
+    unsigned long long sourceInfo[2];
+    bool ok = fread(magic, 1, BC_CACHE_MAGIC_LENGTH, fp) == BC_CACHE_MAGIC_LENGTH &&
+        memcmp(magic, BC_CACHE_MAGIC, BC_CACHE_MAGIC_LENGTH) == 0 &&
+        fread(header, sizeof(unsigned int), BC_CACHE_HEADER_FIELDS, fp) == BC_CACHE_HEADER_FIELDS &&
+        fread(sourceInfo, sizeof(unsigned long long), 2, fp) == 2;
+
+    //verify the key to rule out hash collisions
+    ok = ok && header[0] == BC_CACHE_VERSION && header[1] <= BCEncoder::BC5 && header[5] > 0 && header[5] <= 32 &&
+        header[6] == static_cast<unsigned int>(std::max(mipmapLevels, 1)) && header[7] == source.size() &&
+        sourceInfo[0] == mtime && sourceInfo[1] == size;
+
+    if (ok)
+    {
+        std::string path(header[7], '\0');
+        ok = fread(&path[0], 1, path.size(), fp) == path.size() && path == source;
+    }
+
+    if (ok)
+    {
+        texture.mFormat = static_cast<BCEncoder::Format>(header[1]);
+        texture.mWidth = header[2];
+        texture.mHeight = header[3];
+        texture.mChannels = header[4];
+        texture.mLevels.resize(header[5]);
+
+        for (std::size_t l = 0; l < texture.mLevels.size() && ok; l++)
+        {
+            std::size_t expectedSize = BCEncoder::getCompressedSize(texture.mFormat,
+                std::max<std::size_t>(texture.mWidth >> l, 1), std::max<std::size_t>(texture.mHeight >> l, 1));
+            unsigned int levelSize = 0;
+            ok = fread(&levelSize, sizeof(unsigned int), 1, fp) == 1 && levelSize == expectedSize;
+            if (ok)
+            {
+                texture.mLevels[l].resize(levelSize);
+                ok = fread(texture.mLevels[l].data(), 1, levelSize, fp) == levelSize;
+            }
+        }
+    }
+
+    fclose(fp);
+
+    if (!ok)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING, "CompressedTextureCache: Ignoring invalid cache entry '%s' for '%s'.\n",
+            filename.c_str(), source.c_str());
+        texture.mLevels.clear();
+        return false;
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CompressedTextureCache: Loaded '%s' from '%s' in %.2f ms.\n",
+        source.c_str(), filename.c_str(), (sgct::Engine::getTime() - t0)*1000.0);
+
+    return true;
+}
+
+/*!
+    Load and compress a source image and store it in the cache.
+    \returns true if the image was compressed, the texture is valid even if the cache entry couldn't be written
+*/
+bool sgct_core::CompressedTextureCache::build(const std::string & cacheDirectory, const std::string & source, int mipmapLevels, CompressedTexture & texture)
+{
+    Image img;
+    if (!img.load(source) || !compress(img, mipmapLevels, texture))
+        return false;
+
+    store(cacheDirectory, source, mipmapLevels, texture);
+    return true;
+}
+
+/*!
+    Compress an 8-bit image and its mip chain.
+    \param img the source image
+    \param mipmapLevels the maximum number of mip levels, values less than 1 are treated as 1
+    \param texture receives the compressed levels
+*/
+bool sgct_core::CompressedTextureCache::compress(Image & img, int mipmapLevels, CompressedTexture & texture)
+{
+    double t0 = sgct::Engine::getTime();
+
+    if (img.getData() == nullptr || img.getBytesPerChannel() != 1 || img.getChannels() == 0 || img.getChannels() > 4)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CompressedTextureCache: Only 8-bit images with 1-4 channels can be compressed!\n");
+        return false;
+    }
+
+    texture.mFormat = BCEncoder::getFormatForChannels(img.getChannels());
+    texture.mWidth = img.getWidth();
+    texture.mHeight = img.getHeight();
+    texture.mChannels = img.getChannels();
+    texture.mLevels.clear();
+
+    std::size_t maxLevels = static_cast<std::size_t>(std::max(mipmapLevels, 1));
+    std::size_t channels = img.getChannels();
+    std::vector<unsigned char> previous;
+    std::vector<unsigned char> current;
+    const unsigned char * levelData = img.getData();
+
+    for (std::size_t l = 0; l < maxLevels; l++)
+    {
+        std::size_t width = std::max<std::size_t>(texture.mWidth >> l, 1);
+        std::size_t height = std::max<std::size_t>(texture.mHeight >> l, 1);
+
+        if (l > 0)
+        {
+            std::size_t previousWidth = std::max<std::size_t>(texture.mWidth >> (l - 1), 1);
+            std::size_t previousHeight = std::max<std::size_t>(texture.mHeight >> (l - 1), 1);
+            if (previousWidth == 1 && previousHeight == 1)
+                break;
+
+            current.resize(width * height * channels);
+            Image::resampleBilinear(levelData, previousWidth, previousHeight, current.data(), width, height, channels);
+            previous.swap(current);
+            levelData = previous.data();
+        }
+
+        texture.mLevels.push_back(std::vector<unsigned char>(BCEncoder::getCompressedSize(texture.mFormat, width, height)));
+        if (!BCEncoder::encode(texture.mFormat, levelData, width, height, channels, img.getPreferBGRImport(), texture.mLevels.back().data()))
+        {
+            texture.mLevels.clear();
+            return false;
+        }
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CompressedTextureCache: Compressed %dx%d image with %d levels in %.2f ms.\n",
+        texture.mWidth, texture.mHeight, texture.mLevels.size(), (sgct::Engine::getTime() - t0)*1000.0);
+
+    return true;
+}
+
+/*!
+    Store a compressed version of a source image in the cache.
+    \returns true if the cache entry was written
+*/
+bool sgct_core::CompressedTextureCache::store(const std::string & cacheDirectory, const std::string & source, int mipmapLevels, const CompressedTexture & texture)
+{
+    unsigned long long mtime, size;
+    std::string filename = getCacheFilename(cacheDirectory, source, mipmapLevels);
+    if (filename.empty() || !sgct_helpers::getFileInfo(source, mtime, size))
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CompressedTextureCache: Can't find '%s'!\n", source.c_str());
+        return false;
+    }
+
+    //unique temporary name per process and thread
+    char suffix[32];
+    unsigned long long id = std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+        static_cast<unsigned long long>(sgct::Engine::getTime() * 1000000.0) ^ static_cast<unsigned long long>(reinterpret_cast<std::size_t>(&texture));
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    sprintf_s(suffix, sizeof(suffix), ".%016llx.tmp", id);
+#else
+    sprintf(suffix, ".%016llx.tmp", id);
+#endif
+    std::string tmpFilename = filename + suffix;
+
+    FILE * fp = openFile(tmpFilename, "wb");
+    if (fp == nullptr)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING, "CompressedTextureCache: Can't create cache entry '%s'.\n", filename.c_str());
+        return false;
+    }
+
+    unsigned int header[BC_CACHE_HEADER_FIELDS];
+    header[0] = BC_CACHE_VERSION;
+    header[1] = static_cast<unsigned int>(texture.mFormat);
+    header[2] = static_cast<unsigned int>(texture.mWidth);
+    header[3] = static_cast<unsigned int>(texture.mHeight);
+    header[4] = static_cast<unsigned int>(texture.mChannels);
+    header[5] = static_cast<unsigned int>(texture.mLevels.size());
+    header[6] = static_cast<unsigned int>(std::max(mipmapLevels, 1));
+    header[7] = static_cast<unsigned int>(source.size());
+    unsigned long long sourceInfo[2] = { mtime, size };
+
+    bool ok = fwrite(BC_CACHE_MAGIC, 1, BC_CACHE_MAGIC_LENGTH, fp) == BC_CACHE_MAGIC_LENGTH &&
+        fwrite(header, sizeof(unsigned int), BC_CACHE_HEADER_FIELDS, fp) == BC_CACHE_HEADER_FIELDS &&
+        fwrite(sourceInfo, sizeof(unsigned long long), 2, fp) == 2 &&
+        fwrite(source.c_str(), 1, source.size(), fp) == source.size();
+
+    for (std::size_t l = 0; l < texture.mLevels.size() && ok; l++)
+    {
+        unsigned int levelSize = static_cast<unsigned int>(texture.mLevels[l].size());
+        ok = fwrite(&levelSize, sizeof(unsigned int), 1, fp) == 1 &&
+            fwrite(texture.mLevels[l].data(), 1, levelSize, fp) == levelSize;
+    }
+
+    if (fclose(fp) != 0)
+        ok = false;
+
+    if (!ok || !sgct_helpers::replaceFile(tmpFilename, filename))
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING, "CompressedTextureCache: Failed to write cache entry '%s'.\n", filename.c_str());
+        remove(tmpFilename.c_str());
+        return false;
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CompressedTextureCache: Stored '%s' as '%s'.\n", source.c_str(), filename.c_str());
+    return true;
+}
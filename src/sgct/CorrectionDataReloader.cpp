@@ -0,0 +1,340 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/CorrectionDataReloader.h>
+#include <sgct/NetworkManager.h>
+#include <sgct/SGCTNetwork.h>
+#include <sgct/SGCTWindow.h>
+#include <sgct/MessageHandler.h>
+
+namespace
+{
+    //frames between the commit and the switch, the commit must reach the slaves before the sync data of that frame
+    const int ApplyDelay = 2;
+    const int FrameRange = MAX_NET_SYNC_FRAME_NUMBER + 1;
+}
+
+sgct_core::CorrectionDataReloader::CorrectionDataReloader()
+{
+    mWorkerPtr = nullptr;
+    mState = Idle;
+    mGeneration = 0;
+    mRequested = false;
+    mForce = false;
+    mNumberOfReloadedFiles = 0;
+    mFramesUntilApply = 0;
+    mHasPrepare = false;
+    mPrepareGeneration = 0;
+    mPrepareForce = false;
+    mReadySent = false;
+    mHasCommit = false;
+    mCommitFrame = 0;
+}
+
+sgct_core::CorrectionDataReloader::~CorrectionDataReloader()
+{
+    stop();
+}
+
+/*!
+Add a viewport whose data can be reloaded, the files it uses are watched if watching is enabled.
+*/
+void sgct_core::CorrectionDataReloader::addViewport(Viewport * vpPtr, sgct::SGCTWindow * winPtr)
+{
+    Entry entry;
+    entry.mViewportPtr = vpPtr;
+    entry.mWindowPtr = winPtr;
+    entry.mWindowAspectRatio = 1.0f;
+    entry.mFramebufferResolution = glm::ivec2(0, 0);
+    mEntries.push_back(entry);
+
+    for (std::size_t i = 0; i < Viewport::NUMBER_OF_DATA_TYPES; i++)
+    {
+        Viewport::DataType type = static_cast<Viewport::DataType>(i);
+        if (!vpPtr->isMpcdiData(type))
+            mWatcher.addFile(vpPtr->getDataPath(type));
+    }
+}
+
+/*!
+Start or stop watching the files of all added viewports. A change starts a reload of the whole cluster.
+*/
+void sgct_core::CorrectionDataReloader::setWatching(bool state)
+{
+    if (!state)
+        mWatcher.stop();
+    else if (!mWatcher.isRunning() && mWatcher.start())
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO, "CorrectionDataReloader: Watching warping meshes and masks for changes.\n");
+}
+
+/*!
+Ask for a reload, a slave forwards the request to the master.
+\param force reload all files and not only the changed ones
+*/
+void sgct_core::CorrectionDataReloader::request(bool force)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mRequested = true;
+    mForce = mForce || force;
+}
+
+/*!
+\returns true if a reload is in progress
+*/
+bool sgct_core::CorrectionDataReloader::isBusy()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    return mState != Idle;
+}
+
+/*!
+Advance the reload, called once per frame by the render thread after the frame is synced. Messages are sent
+from here so the sync connections are only written by the render thread, and the reloaded data is uploaded here
+when the frame to switch on is reached.
+\returns true if data was replaced, the current OpenGL context has changed in that case
+*/
+bool sgct_core::CorrectionDataReloader::update(NetworkManager * netPtr)
+{
+    if (mWatcher.hasChanged())
+        request(false);
+
+    enum Action { NoAction = 0, SendRequest, SendPrepare, SendReady, SendCommit, Apply };
+    Action action = NoAction;
+    unsigned int generation = 0;
+    bool force = false;
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        generation = mGeneration;
+
+        if (netPtr->isComputerServer())
+        {
+            if (mState == Idle && mRequested)
+            {
+                force = mForce;
+                mRequested = false;
+                mForce = false;
+                generation = ++mGeneration;
+                mReadyConnections.clear();
+                startPreparing(force);
+                action = SendPrepare;
+            }
+            else if (mState == Prepared)
+            {
+                //slaves that disconnected don't hold back the reload
+                bool allReady = true;
+                for (std::size_t i = 0; i < mPendingConnections.size(); i++)
+                    if (mPendingConnections[i]->isConnected() && mReadyConnections.count(mPendingConnections[i]->getId()) == 0)
+                        allReady = false;
+
+                if (allReady)
+                {
+                    mState = Committed;
+                    mFramesUntilApply = ApplyDelay;
+                    action = SendCommit;
+                }
+            }
+            else if (mState == Committed && --mFramesUntilApply <= 0)
+                action = Apply;
+        }
+        else
+        {
+            if (mRequested)
+            {
+                force = mForce;
+                mRequested = false;
+                mForce = false;
+                action = SendRequest;
+            }
+            else if (mState == Idle && mHasPrepare)
+            {
+                mHasPrepare = false;
+                mReadySent = false;
+                mHasCommit = false;
+                generation = mGeneration = mPrepareGeneration;
+                startPreparing(mPrepareForce);
+            }
+            else if (mState == Prepared && !mReadySent)
+            {
+                mReadySent = true;
+                action = SendReady;
+            }
+            else if (mState == Prepared && mHasCommit && netPtr->getSyncConnectionsCount() > 0 &&
+                isFrameReached(netPtr->getSyncConnectionByIndex(0)->getRecvFrame(SGCTNetwork::Current), mCommitFrame))
+                action = Apply;
+        }
+    }
+
+    switch (action)
+    {
+    case SendRequest:
+        if (netPtr->getSyncConnectionsCount() > 0)
+            netPtr->getSyncConnectionByIndex(0)->sendReloadMessage(RequestMessage, 0, force ? 1 : 0);
+        break;
+
+    case SendPrepare:
+        mPendingConnections.clear();
+        for (unsigned int i = 0; i < netPtr->getSyncConnectionsCount(); i++)
+        {
+            SGCTNetwork * conn = netPtr->getSyncConnectionByIndex(i);
+            if (conn->isServer() && conn->isConnected())
+            {
+                conn->sendReloadMessage(PrepareMessage, generation, force ? 1 : 0);
+                mPendingConnections.push_back(conn);
+            }
+        }
+        break;
+
+    case SendReady:
+        if (netPtr->getSyncConnectionsCount() > 0)
+            netPtr->getSyncConnectionByIndex(0)->sendReloadMessage(ReadyMessage, generation, 0);
+        break;
+
+    case SendCommit:
+        //each connection counts its own frames
+        for (std::size_t i = 0; i < mPendingConnections.size(); i++)
+            if (mPendingConnections[i]->isConnected())
+                mPendingConnections[i]->sendReloadMessage(CommitMessage, generation,
+                    (mPendingConnections[i]->getSendFrame() + ApplyDelay) % FrameRange);
+        mPendingConnections.clear();
+        break;
+
+    case Apply:
+        {
+            joinWorker();
+
+            std::vector<sgct::SGCTWindow *> windows;
+            for (std::size_t i = 0; i < mEntries.size(); i++)
+                if (windows.empty() || windows.back() != mEntries[i].mWindowPtr)
+                    windows.push_back(mEntries[i].mWindowPtr);
+
+            for (std::size_t i = 0; i < windows.size(); i++)
+                windows[i]->applyReloadedData();
+
+            std::unique_lock<std::mutex> lock(mMutex);
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
+                "CorrectionDataReloader: Switched to %u reloaded file(s) (reload %u).\n", static_cast<unsigned int>(mNumberOfReloadedFiles), mGeneration);
+            mState = Idle;
+            mHasCommit = false;
+        }
+        return true;
+
+    default:
+        break;
+    }
+
+    return false;
+}
+
+/*!
+Handle a reload message from the network, called by the connection threads.
+*/
+void sgct_core::CorrectionDataReloader::receiveMessage(int type, unsigned int generation, int value, int connectionId)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    switch (type)
+    {
+    case RequestMessage:
+        mRequested = true;
+        mForce = mForce || value != 0;
+        break;
+
+    case PrepareMessage:
+        mHasPrepare = true;
+        mPrepareGeneration = generation;
+        mPrepareForce = value != 0;
+        break;
+
+    case ReadyMessage:
+        if (generation == mGeneration)
+            mReadyConnections.insert(connectionId);
+        break;
+
+    case CommitMessage:
+        if (generation == mGeneration)
+        {
+            mHasCommit = true;
+            mCommitFrame = value;
+        }
+        break;
+
+    default:
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING,
+            "CorrectionDataReloader: Unknown reload message %d from connection %d.\n", type, connectionId);
+        break;
+    }
+}
+
+/*!
+Stop watching files and wait for a reload in progress. Data that wasn't switched to yet is dropped with the viewports.
+*/
+void sgct_core::CorrectionDataReloader::stop()
+{
+    mWatcher.stop();
+    joinWorker();
+}
+
+void sgct_core::CorrectionDataReloader::startPreparing(bool force)
+{
+    //the window size may have changed since startup
+    for (std::size_t i = 0; i < mEntries.size(); i++)
+    {
+        sgct::SGCTWindow * winPtr = mEntries[i].mWindowPtr;
+        mEntries[i].mWindowAspectRatio = winPtr->getAspectRatio();
+        mEntries[i].mFramebufferResolution = glm::ivec2(winPtr->getXFramebufferResolution(), winPtr->getYFramebufferResolution());
+    }
+
+    //the previous worker was joined when its data was switched to
+    mState = Preparing;
+    mNumberOfReloadedFiles = 0;
+    mWorkerPtr = new std::thread(&CorrectionDataReloader::work, this, force);
+}
+
+void sgct_core::CorrectionDataReloader::joinWorker()
+{
+    if (mWorkerPtr)
+    {
+        mWorkerPtr->join();
+        delete mWorkerPtr;
+        mWorkerPtr = nullptr;
+    }
+}
+
+void sgct_core::CorrectionDataReloader::work(bool force)
+{
+    std::size_t numberOfFiles = 0;
+    for (std::size_t i = 0; i < mEntries.size(); i++)
+    {
+        const Entry & entry = mEntries[i];
+        for (std::size_t j = 0; j < Viewport::NUMBER_OF_DATA_TYPES; j++)
+        {
+            Viewport::DataType type = static_cast<Viewport::DataType>(j);
+            if (!force && !entry.mViewportPtr->isDataChanged(type))
+                continue;
+
+            if (entry.mViewportPtr->prepareReload(type, entry.mWindowAspectRatio, entry.mFramebufferResolution))
+            {
+                sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG,
+                    "CorrectionDataReloader: Reloaded '%s'.\n", entry.mViewportPtr->getDataPath(type).c_str());
+                numberOfFiles++;
+            }
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mNumberOfReloadedFiles = numberOfFiles;
+    mState = Prepared;
+}
+
+/*!
+\returns true if the sync frame has reached the target, handles the wrap around of the frame counter
+*/
+bool sgct_core::CorrectionDataReloader::isFrameReached(int frame, int targetFrame)
+{
+    int distance = ((frame - targetFrame) % FrameRange + FrameRange) % FrameRange;
+    return distance < FrameRange / 2;
+}
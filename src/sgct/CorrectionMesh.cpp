@@ -19,6 +19,11 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #include <sgct/Engine.h>
 #include <sgct/Viewport.h>
 #include <sgct/SGCTSettings.h>
+#include <sgct/MeshTextReader.h>
+#include <sgct/CorrectionMeshDecimator.h>
+#include <sgct/MeshFrustumFit.h>
+#include <sgct/MpcdiWarpGrid.h>
+#include <sgct/helpers/SGCTFileFunctions.h>
 #include <string>
 #include <cstring>
 #include <algorithm>
@@ -55,6 +60,24 @@ struct SCISSViewData
 
 enum SCISSDistortionType { MESHTYPE_PLANAR, MESHTYPE_CUBE };
 
+namespace
+{
+    GLenum getAttributeType(sgct_core::CorrectionMeshLayout::AttributeFormat format)
+    {
+        switch (format)
+        {
+        case sgct_core::CorrectionMeshLayout::Snorm16:
+            return GL_SHORT;
+        case sgct_core::CorrectionMeshLayout::Unorm16:
+            return GL_UNSIGNED_SHORT;
+        case sgct_core::CorrectionMeshLayout::Unorm8:
+            return GL_UNSIGNED_BYTE;
+        default:
+            return GL_FLOAT;
+        }
+    }
+}
+
 sgct_core::CorrectionMeshGeometry::CorrectionMeshGeometry()
 {
     mMeshData[0] = GL_FALSE;
@@ -94,6 +117,12 @@ sgct_core::CorrectionMesh::CorrectionMesh()
 {
     mTempVertices = nullptr;
     mTempIndices = nullptr;
+    mWindowAspectRatio = 1.0f;
+    mFramebufferResolution[0] = 0;
+    mFramebufferResolution[1] = 0;
+    mGridSize[0] = 0;
+    mGridSize[1] = 0;
+    mLookupTexture = GL_FALSE;
 
     for (CorrectionMeshGeometry & geometry : mGeometries)
     {
@@ -102,7 +131,11 @@ sgct_core::CorrectionMesh::CorrectionMesh()
     }
 }
 
-sgct_core::CorrectionMesh::~CorrectionMesh() = default;
+sgct_core::CorrectionMesh::~CorrectionMesh()
+{
+    if (mLookupTexture)
+        glDeleteTextures(1, &mLookupTexture);
+}
 
 /*!
 This function finds a suitible parser for warping meshes and loads them into memory.
@@ -115,32 +148,40 @@ This function finds a suitible parser for warping meshes and loads them into mem
 bool sgct_core::CorrectionMesh::readAndGenerateMesh(std::string meshPath, sgct_core::Viewport * parent,
                                                     MeshHint hint)
 {    
-    //generate unwarped mask
-    setupSimpleMesh(&mGeometries[QUAD_MESH], parent);
-    createMesh(&mGeometries[QUAD_MESH]);
-    cleanUp();
-    
-    //generate unwarped mesh for mask
-    if(parent->hasBlendMaskTexture() || parent->hasBlackLevelMaskTexture())
-    {
-        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Creating mask mesh\n");
-        
-        bool flip_x = false;
-        bool flip_y = false;
-        //if (hint == DOMEPROJECTION_HINT)
-        //    flip_x = true;
+    sgct::SGCTWindow * winPtr = sgct::Engine::instance()->getCurrentWindowPtr();
+    bool loadStatus = parseMesh(meshPath, parent, hint, winPtr->getAspectRatio(),
+        glm::ivec2(winPtr->getXFramebufferResolution(), winPtr->getYFramebufferResolution()));
+    uploadMesh(parent);
+    return loadStatus;
+}
 
-        setupMaskMesh(parent, flip_x, flip_y);
-        createMesh(&mGeometries[MASK_MESH]);
-        cleanUp();
-    }
+/*!
+Parses the warping mesh without using OpenGL, so meshes of different viewports can be parsed in parallel.
+Changes to the viewport and the user that the format carries are applied later by uploadMesh.
+
+@param meshPath the path to the mesh data
+@param parent the pointer to parent viewport
+@param meshHint a hint to pass to the parser selector
+@param windowAspectRatio the aspect ratio of the window of the viewport
+@param framebufferResolution the framebuffer size of the window, the unit of the decimation error
+@return true if mesh found and parsed successfully, false if the default mesh is used
+*/
+bool sgct_core::CorrectionMesh::parseMesh(const std::string & meshPath, Viewport * parent, MeshHint hint, float windowAspectRatio, const glm::ivec2 & framebufferResolution)
+{
+    cleanUp();
+    mCachedMesh.close();
+    mCacheProperties = CorrectionMeshCache::Properties();
+    mWindowAspectRatio = windowAspectRatio;
+    mFramebufferResolution[0] = framebufferResolution.x;
+    mFramebufferResolution[1] = framebufferResolution.y;
+    mGridSize[0] = 0;
+    mGridSize[1] = 0;
+    mLookupTable.clear();
 
     //fallback if no mesh is provided
     if ( meshPath.empty())
     {
         setupSimpleMesh(&mGeometries[WARP_MESH], parent);
-        createMesh(&mGeometries[WARP_MESH]);
-        cleanUp();
 
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Empty mesh path.\n");
         return false;
@@ -184,67 +225,164 @@ bool sgct_core::CorrectionMesh::readAndGenerateMesh(std::string meshPath, sgct_c
         meshFmt = MPCDI_FMT;
     }
 
+    //use the compiled mesh if the source and the viewport are unchanged
+    bool useCache = meshFmt != NO_FMT && meshFmt != MPCDI_FMT && sgct::SGCTSettings::instance()->getUseWarpMeshCache();
+    unsigned long long parameterHash = 0;
+    std::string cacheFilename;
+    bool loadedFromCache = false;
+    if (useCache)
+    {
+        parameterHash = getParameterHash(meshPath, meshFmt, parent);
+        cacheFilename = CorrectionMeshCache::getCacheFilename(sgct::SGCTSettings::instance()->getWarpMeshCacheDirectory(), meshPath, parameterHash);
+        loadedFromCache = readCachedMesh(cacheFilename, meshPath, parameterHash);
+    }
+
     //select parser
-    bool loadStatus = false;
-    switch (meshFmt)
+    bool loadStatus = loadedFromCache;
+    if (!loadedFromCache)
     {
-    case DOMEPROJECTION_FMT:
-        loadStatus = readAndGenerateDomeProjectionMesh(meshPath, parent);
-        break;
+        switch (meshFmt)
+        {
+        case DOMEPROJECTION_FMT:
+            loadStatus = readAndGenerateDomeProjectionMesh(meshPath, parent);
+            break;
 
-    case SCALEABLE_FMT:
-        loadStatus = readAndGenerateScalableMesh(meshPath, parent);
-        break;
+        case SCALEABLE_FMT:
+            loadStatus = readAndGenerateScalableMesh(meshPath, parent);
+            break;
 
-    case SCISS_FMT:
-        loadStatus = readAndGenerateScissMesh(meshPath, parent);
-        break;
+        case SCISS_FMT:
+            loadStatus = readAndGenerateScissMesh(meshPath, parent);
+            break;
 
-    case SKYSKAN_FMT:
-        loadStatus = readAndGenerateSkySkanMesh(meshPath, parent);
-        break;
+        case SKYSKAN_FMT:
+            loadStatus = readAndGenerateSkySkanMesh(meshPath, parent);
+            break;
 
-    case PAULBOURKE_FMT:
-        loadStatus = readAndGeneratePaulBourkeMesh(meshPath, parent);
-        break;
+        case PAULBOURKE_FMT:
+            loadStatus = readAndGeneratePaulBourkeMesh(meshPath, parent);
+            break;
 
-    case OBJ_FMT:
-        loadStatus = readAndGenerateOBJMesh(meshPath, parent);
-        break;
+        case OBJ_FMT:
+            loadStatus = readAndGenerateOBJMesh(meshPath, parent);
+            break;
 
-    case MPCDI_FMT:
-        loadStatus = readAndGenerateMpcdiMesh("", parent);
-        break;
+        case MPCDI_FMT:
+            loadStatus = readAndGenerateMpcdiMesh("", parent);
+            break;
             
-    case NO_FMT:
-        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh error: Loading mesh '%s' failed!\n", meshPath.c_str());
+        case NO_FMT:
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh error: Loading mesh '%s' failed!\n", meshPath.c_str());
+        }
     }
 
+    if (loadStatus && !loadedFromCache && parent->getFitFrustumToMesh())
+        fitFrustumToMesh(parent);
+
     //export
-    if (loadStatus && sgct::SGCTSettings::instance()->getExportWarpingMeshes())
+    std::string exportBasePath;
+    if (loadStatus && !loadedFromCache && sgct::SGCTSettings::instance()->getExportWarpingMeshes())
     {
         std::size_t found = meshPath.find_last_of(".");
         if (found != std::string::npos)
         {
-            std::string filename = meshPath.substr(0, found) + "_export.obj";
-            exportMesh(filename);
+            exportBasePath = meshPath.substr(0, found);
+            exportMesh(exportBasePath + "_export.obj");
         }
     }
-    cleanUp();
+
+    //decimate before compiling so that the cached mesh is the small one
+    if (loadStatus && !loadedFromCache && sgct::SGCTSettings::instance()->getWarpMeshDecimationError() > 0.0f && decimateMesh())
+    {
+        if (!exportBasePath.empty())
+            exportMesh(exportBasePath + "_decimated_export.obj");
+    }
+
+    //compile the parsed mesh for the next start
+    if (loadStatus && useCache && !loadedFromCache)
+    {
+        mCacheProperties.mGeometryType = mGeometries[WARP_MESH].mGeometryType;
+        CorrectionMeshCache::store(cacheFilename, meshPath, parameterHash, mCacheProperties,
+            mTempVertices, mGeometries[WARP_MESH].mNumberOfVertices, mTempIndices, mGeometries[WARP_MESH].mNumberOfIndices);
+    }
+
+    if (loadStatus && parent->getUseWarpLookup())
+        bakeLookupTable(meshPath, useCache, parameterHash, parent);
 
     if( !loadStatus )
     {
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh error: Loading mesh '%s' failed!\n", meshPath.c_str());
         
-        setupSimpleMesh(&mGeometries[WARP_MESH], parent);
-        createMesh(&mGeometries[WARP_MESH]);
         cleanUp();
+        mCachedMesh.close();
+        mCacheProperties = CorrectionMeshCache::Properties();
+        setupSimpleMesh(&mGeometries[WARP_MESH], parent);
         return false;
     }
 
     return true;
 }
 
+/*!
+Creates the OpenGL buffers for the mesh parsed by parseMesh and the unwarped quad and mask meshes. Must be
+called on the thread of the OpenGL context after the mask textures of the viewport are loaded.
+
+@param parent the pointer to parent viewport
+*/
+void sgct_core::CorrectionMesh::uploadMesh(Viewport * parent)
+{
+    //a compiled mesh is uploaded directly from the mapped file
+    if (mCachedMesh.isOpen())
+        createMesh(&mGeometries[WARP_MESH], mCachedMesh.getVertices(), mCachedMesh.getIndices());
+    else if (mTempVertices != nullptr && mTempIndices != nullptr)
+        createMesh(&mGeometries[WARP_MESH]);
+    mCachedMesh.close();
+    cleanUp();
+
+    if (!mLookupTable.isEmpty())
+    {
+        if (mLookupTexture)
+            glDeleteTextures(1, &mLookupTexture);
+
+        //one texel per pixel, the texels are not filtered since neighbours may be outside the mesh
+        glGenTextures(1, &mLookupTexture);
+        glBindTexture(GL_TEXTURE_2D, mLookupTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, mLookupTable.getWidth(), mLookupTable.getHeight(), 0, GL_RGBA, GL_FLOAT, mLookupTable.getData());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, GL_FALSE);
+
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Generating warp lookup texture: %d (%dx%d)\n",
+            mLookupTexture, mLookupTable.getWidth(), mLookupTable.getHeight());
+        mLookupTable.clear();
+    }
+
+    applyCacheProperties(parent);
+
+    //generate unwarped mask
+    setupSimpleMesh(&mGeometries[QUAD_MESH], parent);
+    createMesh(&mGeometries[QUAD_MESH]);
+    cleanUp();
+    
+    //generate unwarped mesh for mask
+    if(parent->hasBlendMaskTexture() || parent->hasBlackLevelMaskTexture())
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Creating mask mesh\n");
+        
+        bool flip_x = false;
+        bool flip_y = false;
+        //if (hint == DOMEPROJECTION_HINT)
+        //    flip_x = true;
+
+        setupMaskMesh(parent, flip_x, flip_y);
+        createMesh(&mGeometries[MASK_MESH]);
+        cleanUp();
+    }
+}
+
 /*!
 Parse data from domeprojection's camera based calibration system. Domeprojection.com
 */
@@ -253,23 +391,13 @@ bool sgct_core::CorrectionMesh::readAndGenerateDomeProjectionMesh(const std::str
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
         "CorrectionMesh: Reading DomeProjection mesh data from '%s'.\n", meshPath.c_str());
 
-    FILE * meshFile = nullptr;
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-    if (fopen_s(&meshFile, meshPath.c_str(), "r") != 0 || !meshFile)
+    MeshTextReader reader(MAX_LINE_LENGTH);
+    if (!reader.open(meshPath))
     {
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh: Failed to open warping mesh file!\n");
         return false;
     }
-#else
-    meshFile = fopen(meshPath.c_str(), "r");
-    if (meshFile == NULL)
-    {
-        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh: Failed to open warping mesh file!\n");
-        return false;
-    }
-#endif
 
-    char lineBuffer[MAX_LINE_LENGTH];
     float x, y, u, v;
     unsigned int col, row;
     unsigned int numberOfCols = 0;
@@ -284,45 +412,39 @@ bool sgct_core::CorrectionMesh::readAndGenerateDomeProjectionMesh(const std::str
     vertex.b = 1.0f;
     vertex.a = 1.0f;
 
-    while (!feof(meshFile))
+    while (reader.nextLine())
     {
-        if (fgets(lineBuffer, MAX_LINE_LENGTH, meshFile) != nullptr)
+        //"%f;%f;%f;%f;%u;%u"
+        if (reader.readFloat(x) && reader.match(";") && reader.readFloat(y) && reader.match(";") &&
+            reader.readFloat(u) && reader.match(";") && reader.readFloat(v) && reader.match(";") &&
+            reader.readUInt(col) && reader.match(";") && reader.readUInt(row))
         {
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            if (sscanf_s(lineBuffer, "%f;%f;%f;%f;%u;%u", &x, &y, &u, &v, &col, &row) == 6)
-#else
-            if (sscanf(lineBuffer, "%f;%f;%f;%f;%u;%u", &x, &y, &u, &v, &col, &row) == 6)
-#endif
-            {
-                //find dimensions of meshdata
-                if (col > numberOfCols)
-                    numberOfCols = col;
+            //find dimensions of meshdata
+            if (col > numberOfCols)
+                numberOfCols = col;
 
-                if (row > numberOfRows)
-                    numberOfRows = row;
+            if (row > numberOfRows)
+                numberOfRows = row;
 
-                //clamp
-                clamp(x, 1.0f, 0.0f);
-                clamp(y, 1.0f, 0.0f);
-                //clamp(u, 1.0f, 0.0f);
-                //clamp(v, 1.0f, 0.0f);
+            //clamp
+            clamp(x, 1.0f, 0.0f);
+            clamp(y, 1.0f, 0.0f);
+            //clamp(u, 1.0f, 0.0f);
+            //clamp(v, 1.0f, 0.0f);
 
-                //convert to [-1, 1]
-                vertex.x = 2.0f * (x * parent->getXSize() + parent->getX()) - 1.0f;
-                vertex.y = 2.0f * ((1.0f-y) * parent->getYSize() + parent->getY()) - 1.0f;
+            //convert to [-1, 1]
+            vertex.x = 2.0f * (x * parent->getXSize() + parent->getX()) - 1.0f;
+            vertex.y = 2.0f * ((1.0f-y) * parent->getYSize() + parent->getY()) - 1.0f;
 
-                //scale to viewport coordinates
-                vertex.s = u * parent->getXSize() + parent->getX();
-                vertex.t = (1.0f-v) * parent->getYSize() + parent->getY();
+            //scale to viewport coordinates
+            vertex.s = u * parent->getXSize() + parent->getX();
+            vertex.t = (1.0f-v) * parent->getYSize() + parent->getY();
 
-                vertices.push_back(vertex);
-            }
-            
+            vertices.push_back(vertex);
         }
-
     }
 
-    fclose(meshFile);
+    reader.close();
 
     //add one to actually store the dimensions instread of largest index
     numberOfCols++;
@@ -378,8 +500,9 @@ bool sgct_core::CorrectionMesh::readAndGenerateDomeProjectionMesh(const std::str
     indices.clear();
 
     mGeometries[WARP_MESH].mGeometryType = GL_TRIANGLES;
+    mGridSize[0] = numberOfCols;
+    mGridSize[1] = numberOfRows;
 
-    createMesh(&mGeometries[WARP_MESH]);
 
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Correction mesh read successfully! Vertices=%u, Indices=%u.\n", mGeometries[WARP_MESH].mNumberOfVertices, mGeometries[WARP_MESH].mNumberOfIndices);
     
@@ -391,21 +514,12 @@ bool sgct_core::CorrectionMesh::readAndGenerateScalableMesh(const std::string &
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
         "CorrectionMesh: Reading scalable mesh data from '%s'.\n", meshPath.c_str());
 
-    FILE * meshFile = nullptr;
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-    if( fopen_s(&meshFile, meshPath.c_str(), "r") != 0 || !meshFile )
-    {
-        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh: Failed to open warping mesh file!\n");
-        return false;
-    }
-#else
-    meshFile = fopen(meshPath.c_str(), "r");
-    if( meshFile == NULL )
+    MeshTextReader reader(MAX_LINE_LENGTH);
+    if (!reader.open(meshPath))
     {
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh: Failed to open warping mesh file!\n");
         return false;
     }
-#endif
 
     float x,y,s,t;
     unsigned int intensity;
@@ -427,109 +541,79 @@ bool sgct_core::CorrectionMesh::readAndGenerateScalableMesh(const std::string &
 
     CorrectionMeshVertex * vertexPtr;
 
-    char lineBuffer[MAX_LINE_LENGTH];
-    while( !feof( meshFile ) )
+    while (reader.nextLine())
     {
-        if( fgets(lineBuffer, MAX_LINE_LENGTH, meshFile ) != nullptr )
+        //"%f %f %u %f %f"
+        if (reader.readFloat(x) && reader.match(" ") && reader.readFloat(y) && reader.match(" ") &&
+            reader.readUInt(intensity) && reader.match(" ") && reader.readFloat(s) && reader.match(" ") && reader.readFloat(t))
         {
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            if( sscanf_s(lineBuffer, "%f %f %u %f %f", &x, &y, &intensity, &s, &t) == 5 )
-#else
-            if( sscanf(lineBuffer, "%f %f %u %f %f", &x, &y, &intensity, &s, &t) == 5 )
-#endif
+            if( mTempVertices != nullptr && resolution[0] != 0 && resolution[1] != 0 )
             {
-                if( mTempVertices != nullptr && resolution[0] != 0 && resolution[1] != 0 )
-                {
-                    vertexPtr = &mTempVertices[numOfVerticesRead];
-                    vertexPtr->x = (x / static_cast<float>(resolution[0])) * parent->getXSize() + parent->getX();
-                    vertexPtr->y = (y / static_cast<float>(resolution[1])) * parent->getYSize() + parent->getY();
-                    vertexPtr->r = static_cast<float>(intensity)/255.0f;
-                    vertexPtr->g = static_cast<float>(intensity)/255.0f;
-                    vertexPtr->b = static_cast<float>(intensity)/255.0f;
-                    vertexPtr->a = 1.0f;
-                    vertexPtr->s = (1.0f - t) * parent->getXSize() + parent->getX();
-                    vertexPtr->t = (1.0f - s) * parent->getYSize() + parent->getY();
-
-                    numOfVerticesRead++;
-                }
+                vertexPtr = &mTempVertices[numOfVerticesRead];
+                vertexPtr->x = (x / static_cast<float>(resolution[0])) * parent->getXSize() + parent->getX();
+                vertexPtr->y = (y / static_cast<float>(resolution[1])) * parent->getYSize() + parent->getY();
+                vertexPtr->r = static_cast<float>(intensity)/255.0f;
+                vertexPtr->g = static_cast<float>(intensity)/255.0f;
+                vertexPtr->b = static_cast<float>(intensity)/255.0f;
+                vertexPtr->a = 1.0f;
+                vertexPtr->s = (1.0f - t) * parent->getXSize() + parent->getX();
+                vertexPtr->t = (1.0f - s) * parent->getYSize() + parent->getY();
+
+                numOfVerticesRead++;
             }
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            else if( sscanf_s(lineBuffer, "[ %u %u %u ]", &a, &b, &c) == 3 )
-#else
-            else if( sscanf(lineBuffer, "[ %u %u %u ]", &a, &b, &c) == 3 )
-#endif
+        }
+        //"[ %u %u %u ]", the closing bracket is optional like in scanf
+        else if (reader.restart() && reader.match("[ ") && reader.readUInt(a) && reader.match(" ") &&
+            reader.readUInt(b) && reader.match(" ") && reader.readUInt(c))
+        {
+            if (mTempIndices != nullptr)
             {
-                if (mTempIndices != nullptr)
-                {
-                    mTempIndices[numOfFacesRead * 3] = a;
-                    mTempIndices[numOfFacesRead * 3 + 1] = b;
-                    mTempIndices[numOfFacesRead * 3 + 2] = c;
-                }
-
-                numOfFacesRead++;
+                mTempIndices[numOfFacesRead * 3] = a;
+                mTempIndices[numOfFacesRead * 3 + 1] = b;
+                mTempIndices[numOfFacesRead * 3 + 2] = c;
             }
-            else
-            {
-                char tmpString[16];
-                tmpString[0] = '\0';
-                double tmpD = 0.0;
-                unsigned int tmpUI = 0;
-
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-                if( sscanf_s(lineBuffer, "VERTICES %u", &numberOfVertices) == 1 )
-#else
-                if( sscanf(lineBuffer, "VERTICES %u", &numberOfVertices) == 1 )
-#endif
-                {
-                    mTempVertices = new CorrectionMeshVertex[ numberOfVertices ];
-                    memset(mTempVertices, 0, numberOfVertices * sizeof(CorrectionMeshVertex));
-                }
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-                else if( sscanf_s(lineBuffer, "FACES %u", &numberOfFaces) == 1 )
-#else
-                else if (sscanf(lineBuffer, "FACES %u", &numberOfFaces) == 1)
-#endif
-                {
-                    numberOfIndices = numberOfFaces * 3;
-                    mTempIndices = new unsigned int[numberOfIndices];
-                    memset(mTempIndices, 0, numberOfIndices * sizeof(unsigned int));
-                }
+            numOfFacesRead++;
+        }
+        else
+        {
+            char tmpString[16];
+            tmpString[0] = '\0';
+            double tmpD = 0.0;
+            unsigned int tmpUI = 0;
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-                else if( sscanf_s(lineBuffer, "ORTHO_%s %lf", tmpString, 16, &tmpD) == 2 )
-#else
-                else if( sscanf(lineBuffer, "ORTHO_%s %lf", tmpString, &tmpD) == 2 )
-#endif
-                {
-                    if( strcmp(tmpString, "LEFT") == 0 )
-                        orthoCoords[0] = tmpD;
-                    else if( strcmp(tmpString, "RIGHT") == 0 )
-                        orthoCoords[1] = tmpD;
-                    else if( strcmp(tmpString, "BOTTOM") == 0 )
-                        orthoCoords[2] = tmpD;
-                    else if( strcmp(tmpString, "TOP") == 0 )
-                        orthoCoords[3] = tmpD;
-                }
+            if (reader.restart() && reader.match("VERTICES ") && reader.readUInt(numberOfVertices))
+            {
+                mTempVertices = new CorrectionMeshVertex[ numberOfVertices ];
+                memset(mTempVertices, 0, numberOfVertices * sizeof(CorrectionMeshVertex));
+            }
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-                else if( sscanf_s(lineBuffer, "NATIVEXRES %u", &tmpUI) == 1 )
-#else
-                else if( sscanf(lineBuffer, "NATIVEXRES %u", &tmpUI) == 1 )
-#endif
-                    resolution[0] = tmpUI;
+            else if (reader.restart() && reader.match("FACES ") && reader.readUInt(numberOfFaces))
+            {
+                numberOfIndices = numberOfFaces * 3;
+                mTempIndices = new unsigned int[numberOfIndices];
+                memset(mTempIndices, 0, numberOfIndices * sizeof(unsigned int));
+            }
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-                else if( sscanf_s(lineBuffer, "NATIVEYRES %u", &tmpUI) == 1 )
-#else
-                else if( sscanf(lineBuffer, "NATIVEYRES %u", &tmpUI) == 1 )
-#endif
-                    resolution[1] = tmpUI;
+            else if (reader.restart() && reader.match("ORTHO_") && reader.readWord(tmpString, 16) &&
+                reader.match(" ") && reader.readDouble(tmpD))
+            {
+                if( strcmp(tmpString, "LEFT") == 0 )
+                    orthoCoords[0] = tmpD;
+                else if( strcmp(tmpString, "RIGHT") == 0 )
+                    orthoCoords[1] = tmpD;
+                else if( strcmp(tmpString, "BOTTOM") == 0 )
+                    orthoCoords[2] = tmpD;
+                else if( strcmp(tmpString, "TOP") == 0 )
+                    orthoCoords[3] = tmpD;
             }
 
-            //fprintf(stderr, "Row text: %s", lineBuffer);
-        }
+            else if (reader.restart() && reader.match("NATIVEXRES ") && reader.readUInt(tmpUI))
+                resolution[0] = tmpUI;
 
+            else if (reader.restart() && reader.match("NATIVEYRES ") && reader.readUInt(tmpUI))
+                resolution[1] = tmpUI;
+        }
     }
 
     if (numberOfVertices != numOfVerticesRead || numberOfFaces != numOfFacesRead)
@@ -555,13 +639,12 @@ bool sgct_core::CorrectionMesh::readAndGenerateScalableMesh(const std::string &
         mTempVertices[i].y = yVal * 2.0f - 1.0f;
     }
 
-    fclose( meshFile );
+    reader.close();
 
     mGeometries[WARP_MESH].mNumberOfVertices = numberOfVertices;
     mGeometries[WARP_MESH].mNumberOfIndices = numberOfIndices;
     mGeometries[WARP_MESH].mGeometryType = GL_TRIANGLES;
 
-    createMesh(&mGeometries[WARP_MESH]);
 
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO, "CorrectionMesh: Correction mesh read successfully! Vertices=%u, Faces=%u.\n", numOfVerticesRead, numOfFacesRead);
 
@@ -754,18 +837,18 @@ bool sgct_core::CorrectionMesh::readAndGenerateScissMesh(const std::string & mes
 
     fclose(meshFile);
 
-    parent->getUser()->setPos(
-        viewData.x, viewData.y, viewData.z);
-
-    parent->setViewPlaneCoordsUsingFOVs(
-        viewData.fovUp,
-        viewData.fovDown,
-        viewData.fovLeft,
-        viewData.fovRight,
-        glm::quat(viewData.qw, viewData.qx, viewData.qy, viewData.qz)
-        );
-
-    sgct::Engine::instance()->updateFrustums();
+    mCacheProperties.mHasViewPlane = true;
+    mCacheProperties.mUserPosition[0] = viewData.x;
+    mCacheProperties.mUserPosition[1] = viewData.y;
+    mCacheProperties.mUserPosition[2] = viewData.z;
+    mCacheProperties.mFov[0] = viewData.fovUp;
+    mCacheProperties.mFov[1] = viewData.fovDown;
+    mCacheProperties.mFov[2] = viewData.fovLeft;
+    mCacheProperties.mFov[3] = viewData.fovRight;
+    mCacheProperties.mRotation[0] = viewData.qw;
+    mCacheProperties.mRotation[1] = viewData.qx;
+    mCacheProperties.mRotation[2] = viewData.qy;
+    mCacheProperties.mRotation[3] = viewData.qz;
 
     CorrectionMeshVertex * vertexPtr;
     SCISSTexturedVertex * scissVertexPtr;
@@ -861,7 +944,6 @@ bool sgct_core::CorrectionMesh::readAndGenerateScissMesh(const std::string & mes
     delete [] texturedVertexList;
     texturedVertexList = nullptr;
 
-    createMesh(&mGeometries[WARP_MESH]);
 
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Correction mesh read successfully! Vertices=%u, Indices=%u.\n", numberOfVertices, numberOfIndices);
     
@@ -873,21 +955,12 @@ bool sgct_core::CorrectionMesh::readAndGenerateSkySkanMesh(const std::string & m
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
         "CorrectionMesh: Reading SkySkan mesh data from '%s'.\n", meshPath.c_str());
 
-    FILE * meshFile = nullptr;
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-    if (fopen_s(&meshFile, meshPath.c_str(), "r") != 0 || !meshFile)
-    {
-        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh: Failed to open warping mesh file!\n");
-        return false;
-    }
-#else
-    meshFile = fopen(meshPath.c_str(), "r");
-    if (meshFile == NULL)
+    MeshTextReader reader(MAX_LINE_LENGTH);
+    if (!reader.open(meshPath))
     {
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh: Failed to open warping mesh file!\n");
         return false;
     }
-#endif
 
     float azimuth = 0.0f;
     float elevation = 0.0f;
@@ -905,130 +978,85 @@ bool sgct_core::CorrectionMesh::readAndGenerateSkySkanMesh(const std::string & m
     unsigned int size[2];
     unsigned int counter = 0;
 
-    char lineBuffer[MAX_LINE_LENGTH];
-    while (!feof(meshFile))
+    while (reader.nextLine())
     {
-        if (fgets(lineBuffer, MAX_LINE_LENGTH, meshFile) != nullptr)
+        if (reader.match("Dome Azimuth=") && reader.readFloat(azimuth))
         {
+            azimuthSet = true;
+        }
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            if (sscanf_s(lineBuffer, "Dome Azimuth=%f", &azimuth) == 1)
-#else
-            if (sscanf(lineBuffer, "Dome Azimuth=%f", &azimuth) == 1)
-#endif
-            {
-                azimuthSet = true;
-            }
+        else if (reader.restart() && reader.match("Dome Elevation=") && reader.readFloat(elevation))
+        {
+            elevationSet = true;
+        }
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            else if (sscanf_s(lineBuffer, "Dome Elevation=%f", &elevation) == 1)
-#else
-            else if (sscanf(lineBuffer, "Dome Elevation=%f", &elevation) == 1)
-#endif
-            {
-                elevationSet = true;
-            }
+        else if (reader.restart() && reader.match("Horizontal FOV=") && reader.readFloat(horizontal_fov))
+        {
+            hFovSet = true;
+        }
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            else if (sscanf_s(lineBuffer, "Horizontal FOV=%f", &horizontal_fov) == 1)
-#else
-            else if (sscanf(lineBuffer, "Horizontal FOV=%f", &horizontal_fov) == 1)
-#endif
-            {
-                hFovSet = true;
-            }
+        else if (reader.restart() && reader.match("Vertical FOV=") && reader.readFloat(vertical_fov))
+        {
+            vFovSet = true;
+        }
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            else if (sscanf_s(lineBuffer, "Vertical FOV=%f", &vertical_fov) == 1)
-#else
-            else if (sscanf(lineBuffer, "Vertical FOV=%f", &vertical_fov) == 1)
-#endif
-            {
-                vFovSet = true;
-            }
+        else if (reader.restart() && reader.match("Horizontal Tweek=") && reader.readFloat(fovTweeks[0]))
+        {
+            ;
+        }
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            else if (sscanf_s(lineBuffer, "Horizontal Tweek=%f", &fovTweeks[0]) == 1)
-#else
-            else if (sscanf(lineBuffer, "Horizontal Tweek=%f", &fovTweeks[0]) == 1)
-#endif
-            {
-                ;
-            }
+        else if (reader.restart() && reader.match("Vertical Tweek=") && reader.readFloat(fovTweeks[1]))
+        {
+            ;
+        }
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            else if (sscanf_s(lineBuffer, "Vertical Tweek=%f", &fovTweeks[1]) == 1)
-#else
-            else if (sscanf(lineBuffer, "Vertical Tweek=%f", &fovTweeks[1]) == 1)
-#endif
-            {
-                ;
-            }
+        else if (reader.restart() && reader.match("U Tweek=") && reader.readFloat(UVTweeks[0]))
+        {
+            ;
+        }
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            else if (sscanf_s(lineBuffer, "U Tweek=%f", &UVTweeks[0]) == 1)
-#else
-            else if (sscanf(lineBuffer, "U Tweek=%f", &UVTweeks[0]) == 1)
-#endif
-            {
-                ;
-            }
+        else if (reader.restart() && reader.match("V Tweek=") && reader.readFloat(UVTweeks[1]))
+        {
+            ;
+        }
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            else if (sscanf_s(lineBuffer, "V Tweek=%f", &UVTweeks[1]) == 1)
-#else
-            else if (sscanf(lineBuffer, "V Tweek=%f", &UVTweeks[1]) == 1)
-#endif
-            {
-                ;
-            }
+        //"%u %u"
+        else if (!dimensionsSet && reader.restart() && reader.readUInt(size[0]) && reader.match(" ") && reader.readUInt(size[1]))
+        {
+            dimensionsSet = true;
+            mTempVertices = new CorrectionMeshVertex[size[0] * size[1]];
+            mGeometries[WARP_MESH].mNumberOfVertices = size[0] * size[1];
+        }
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            else if (!dimensionsSet && sscanf_s(lineBuffer, "%u %u", &size[0], &size[1]) == 2)
-#else
-            else if (!dimensionsSet && sscanf(lineBuffer, "%u %u", &size[0], &size[1]) == 2)
-#endif
-            {
-                dimensionsSet = true;
-                mTempVertices = new CorrectionMeshVertex[size[0] * size[1]];
-                mGeometries[WARP_MESH].mNumberOfVertices = size[0] * size[1];
-            }
+        //"%f %f %f %f"
+        else if (dimensionsSet && reader.restart() && reader.readFloat(x) && reader.match(" ") && reader.readFloat(y) &&
+            reader.match(" ") && reader.readFloat(u) && reader.match(" ") && reader.readFloat(v))
+        {
+            if (UVTweeks[0] > -1.0f)
+                u *= UVTweeks[0];
 
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            else if (dimensionsSet && sscanf_s(lineBuffer, "%f %f %f %f", &x, &y, &u, &v) == 4)
-#else
-            else if (dimensionsSet && sscanf(lineBuffer, "%f %f %f %f", &x, &y, &u, &v) == 4)
-#endif
-            {
-                if (UVTweeks[0] > -1.0f)
-                    u *= UVTweeks[0];
-
-                if (UVTweeks[1] > -1.0f)
-                    v *= UVTweeks[1];
-                
-                mTempVertices[counter].x = x;
-                mTempVertices[counter].y = y;
-                mTempVertices[counter].s = u;
-                //mTempVertices[counter].t = v;
-                //mTempVertices[counter].s = 1.0f - u;
-                mTempVertices[counter].t = 1.0f - v;
-
-                mTempVertices[counter].r = 1.0f;
-                mTempVertices[counter].g = 1.0f;
-                mTempVertices[counter].b = 1.0f;
-                mTempVertices[counter].a = 1.0f;
-
-                //fprintf(stderr, "Adding vertex: %u %.3f %.3f %.3f %.3f\n", counter, x, y, u, v);
-
-                counter++;
-            }
+            if (UVTweeks[1] > -1.0f)
+                v *= UVTweeks[1];
+            
+            mTempVertices[counter].x = x;
+            mTempVertices[counter].y = y;
+            mTempVertices[counter].s = u;
+            //mTempVertices[counter].t = v;
+            //mTempVertices[counter].s = 1.0f - u;
+            mTempVertices[counter].t = 1.0f - v;
 
-            //fprintf(stderr, "Row text: %s", lineBuffer);
-        }
+            mTempVertices[counter].r = 1.0f;
+            mTempVertices[counter].g = 1.0f;
+            mTempVertices[counter].b = 1.0f;
+            mTempVertices[counter].a = 1.0f;
+
+            //fprintf(stderr, "Adding vertex: %u %.3f %.3f %.3f %.3f\n", counter, x, y, u, v);
 
+            counter++;
+        }
     }
 
-    fclose(meshFile);
+    reader.close();
 
     if (!dimensionsSet ||
         !azimuthSet ||
@@ -1069,16 +1097,15 @@ bool sgct_core::CorrectionMesh::readAndGenerateSkySkanMesh(const std::string & m
     rotQuat = glm::rotate(rotQuat, glm::radians(-azimuth), glm::vec3(0.0f, 1.0f, 0.0f));
     rotQuat = glm::rotate(rotQuat, glm::radians(elevation), glm::vec3(1.0f, 0.0f, 0.0f));
 
-    parent->getUser()->setPos(0.0f, 0.0f, 0.0f);
-    parent->setViewPlaneCoordsUsingFOVs(
-        vertical_fov / 2.0f,
-        -vertical_fov / 2.0f,
-        -horizontal_fov / 2.0f,
-        horizontal_fov / 2.0f,
-        rotQuat
-        );
-    
-    sgct::Engine::instance()->updateFrustums();
+    mCacheProperties.mHasViewPlane = true;
+    mCacheProperties.mFov[0] = vertical_fov / 2.0f;
+    mCacheProperties.mFov[1] = -vertical_fov / 2.0f;
+    mCacheProperties.mFov[2] = -horizontal_fov / 2.0f;
+    mCacheProperties.mFov[3] = horizontal_fov / 2.0f;
+    mCacheProperties.mRotation[0] = rotQuat.w;
+    mCacheProperties.mRotation[1] = rotQuat.x;
+    mCacheProperties.mRotation[2] = rotQuat.y;
+    mCacheProperties.mRotation[3] = rotQuat.z;
 
     std::vector<unsigned int> indices;
     unsigned int i0, i1, i2, i3;
@@ -1168,8 +1195,9 @@ bool sgct_core::CorrectionMesh::readAndGenerateSkySkanMesh(const std::string & m
     memcpy(mTempIndices, indices.data(), mGeometries[WARP_MESH].mNumberOfIndices * sizeof(unsigned int));
 
     mGeometries[WARP_MESH].mGeometryType = GL_TRIANGLES;
+    mGridSize[0] = size[0];
+    mGridSize[1] = size[1];
 
-    createMesh(&mGeometries[WARP_MESH]);
 
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Correction mesh read successfully! Vertices=%u, Indices=%u.\n", mGeometries[WARP_MESH].mNumberOfVertices, mGeometries[WARP_MESH].mNumberOfIndices);
 
@@ -1181,41 +1209,31 @@ bool sgct_core::CorrectionMesh::readAndGeneratePaulBourkeMesh(const std::string
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
         "CorrectionMesh: Reading Paul Bourke spherical mirror mesh data from '%s'.\n", meshPath.c_str());
 
-    FILE * meshFile = nullptr;
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-    if (fopen_s(&meshFile, meshPath.c_str(), "r") != 0 || !meshFile)
-    {
-        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh: Failed to open warping mesh file!\n");
-        return false;
-    }
-#else
-    meshFile = fopen(meshPath.c_str(), "r");
-    if (meshFile == NULL)
+    MeshTextReader reader(MAX_LINE_LENGTH);
+    if (!reader.open(meshPath))
     {
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh: Failed to open warping mesh file!\n");
         return false;
     }
-#endif
 
     //variables
     int mappingType = -1;
     int size[2] = {-1, -1};
     unsigned int counter = 0;
     float x, y, s, t, intensity;
-    char lineBuffer[MAX_LINE_LENGTH];
 
     //get the fist line containing the mapping type id
-    if (fgets(lineBuffer, MAX_LINE_LENGTH, meshFile) != nullptr)
+    if (reader.nextLine())
     {
         int tmpi;
-        if(_sscanf(lineBuffer, "%d", &tmpi) == 1)
+        if (reader.readInt(tmpi))
             mappingType = tmpi;
     }
 
     //get the mesh dimensions
-    if (fgets(lineBuffer, MAX_LINE_LENGTH, meshFile) != nullptr)
+    if (reader.nextLine())
     {
-        if (_sscanf(lineBuffer, "%d %d", &size[0], &size[1]) == 2)
+        if (reader.readInt(size[0]) && reader.match(" ") && reader.readInt(size[1]))
         {
             mTempVertices = new CorrectionMeshVertex[size[0] * size[1]];
             mGeometries[WARP_MESH].mNumberOfVertices = static_cast<unsigned int>(size[0] * size[1]);
@@ -1230,27 +1248,26 @@ bool sgct_core::CorrectionMesh::readAndGeneratePaulBourkeMesh(const std::string
     }
 
     //get all data
-    while (!feof(meshFile))
+    while (reader.nextLine())
     {
-        if (fgets(lineBuffer, MAX_LINE_LENGTH, meshFile) != nullptr)
+        //"%f %f %f %f %f"
+        if (reader.readFloat(x) && reader.match(" ") && reader.readFloat(y) && reader.match(" ") &&
+            reader.readFloat(s) && reader.match(" ") && reader.readFloat(t) && reader.match(" ") && reader.readFloat(intensity))
         {
-            if (_sscanf(lineBuffer, "%f %f %f %f %f", &x, &y, &s, &t, &intensity) == 5)
-            {
-                mTempVertices[counter].x = x;
-                mTempVertices[counter].y = y;
-                mTempVertices[counter].s = s;
-                mTempVertices[counter].t = t;
+            mTempVertices[counter].x = x;
+            mTempVertices[counter].y = y;
+            mTempVertices[counter].s = s;
+            mTempVertices[counter].t = t;
 
-                mTempVertices[counter].r = intensity;
-                mTempVertices[counter].g = intensity;
-                mTempVertices[counter].b = intensity;
-                mTempVertices[counter].a = 1.0f;
+            mTempVertices[counter].r = intensity;
+            mTempVertices[counter].g = intensity;
+            mTempVertices[counter].b = intensity;
+            mTempVertices[counter].a = 1.0f;
 
-                //if(counter <= 100)
-                //    fprintf(stderr, "Adding vertex: %u %.3f %.3f %.3f %.3f %.3f\n", counter, x, y, s, t, intensity);
+            //if(counter <= 100)
+            //    fprintf(stderr, "Adding vertex: %u %.3f %.3f %.3f %.3f %.3f\n", counter, x, y, s, t, intensity);
 
-                counter++;
-            }
+            counter++;
         }
     }
 
@@ -1291,7 +1308,7 @@ bool sgct_core::CorrectionMesh::readAndGeneratePaulBourkeMesh(const std::string
             indices.push_back(i3);
         }
 
-    float aspect = sgct::Engine::instance()->getCurrentWindowPtr()->getAspectRatio() * 
+    float aspect = mWindowAspectRatio * 
         (parent->getXSize() / parent->getYSize());
     
     for (unsigned int i = 0; i < mGeometries[WARP_MESH].mNumberOfVertices; i++)
@@ -1316,14 +1333,11 @@ bool sgct_core::CorrectionMesh::readAndGeneratePaulBourkeMesh(const std::string
     memcpy(mTempIndices, indices.data(), mGeometries[WARP_MESH].mNumberOfIndices * sizeof(unsigned int));
 
     mGeometries[WARP_MESH].mGeometryType = GL_TRIANGLES;
-    createMesh(&mGeometries[WARP_MESH]);
+    mGridSize[0] = static_cast<unsigned int>(size[0]);
+    mGridSize[1] = static_cast<unsigned int>(size[1]);
 
     //force regeneration of dome render quad
-    if (auto* fishPrj = dynamic_cast<FisheyeProjection*>(parent->getNonLinearProjectionPtr()))
-    {
-        fishPrj->setIgnoreAspectRatio(true);
-        fishPrj->update(1.0f, 1.0f);
-    }
+    mCacheProperties.mFisheyeIgnoreAspect = true;
 
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Correction mesh read successfully! Vertices=%u, Indices=%u.\n", mGeometries[WARP_MESH].mNumberOfVertices, mGeometries[WARP_MESH].mNumberOfIndices);
     return true;
@@ -1334,61 +1348,52 @@ bool sgct_core::CorrectionMesh::readAndGenerateOBJMesh(const std::string & meshP
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
         "CorrectionMesh: Reading Maya Wavefront OBJ mesh data from '%s'.\n", meshPath.c_str());
 
-    FILE * meshFile = nullptr;
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-    if (fopen_s(&meshFile, meshPath.c_str(), "r") != 0 || !meshFile)
-    {
-        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh: Failed to open warping mesh file!\n");
-        return false;
-    }
-#else
-    meshFile = fopen(meshPath.c_str(), "r");
-    if (meshFile == NULL)
+    MeshTextReader reader(MAX_LINE_LENGTH);
+    if (!reader.open(meshPath))
     {
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh: Failed to open warping mesh file!\n");
         return false;
     }
-#endif
 
     //variables
     int i0, i1, i2;
     unsigned int counter = 0;
-    char lineBuffer[MAX_LINE_LENGTH];
     CorrectionMeshVertex tmpVert;
     std::vector<CorrectionMeshVertex> verts;
     std::vector<unsigned int> indices;
 
     //get all data
-    while (!feof(meshFile))
+    while (reader.nextLine())
     {
-        if (fgets(lineBuffer, MAX_LINE_LENGTH, meshFile) != nullptr)
+        //"v %f %f %*f", the third coordinate is optional like in scanf
+        if (reader.match("v ") && reader.readFloat(tmpVert.x) && reader.match(" ") && reader.readFloat(tmpVert.y))
         {
-            if (_sscanf(lineBuffer, "v %f %f %*f", &tmpVert.x, &tmpVert.y) == 2)
-            {
-                tmpVert.r = 1.0f;
-                tmpVert.g = 1.0f;
-                tmpVert.b = 1.0f;
-                tmpVert.a = 1.0f;
+            tmpVert.r = 1.0f;
+            tmpVert.g = 1.0f;
+            tmpVert.b = 1.0f;
+            tmpVert.a = 1.0f;
 
-                verts.push_back(tmpVert);
-            }
-            else if (_sscanf(lineBuffer, "vt %f %f %*f", &tmpVert.s, &tmpVert.t) == 2)
-            {
-                if (counter < verts.size())
-                {
-                    verts[counter].s = tmpVert.s;
-                    verts[counter].t = tmpVert.t;
-                }
-                
-                counter++;
-            }
-            else if (_sscanf(lineBuffer, "f %d/%*d/%*d %d/%*d/%*d %d/%*d/%*d", &i0, &i1, &i2) == 3)
+            verts.push_back(tmpVert);
+        }
+        else if (reader.restart() && reader.match("vt ") && reader.readFloat(tmpVert.s) && reader.match(" ") && reader.readFloat(tmpVert.t))
+        {
+            if (counter < verts.size())
             {
-                //indexes starts at 1 in OBJ
-                indices.push_back(i0-1);
-                indices.push_back(i1-1);
-                indices.push_back(i2-1);
+                verts[counter].s = tmpVert.s;
+                verts[counter].t = tmpVert.t;
             }
+            
+            counter++;
+        }
+        //"f %d/%*d/%*d %d/%*d/%*d %d/%*d/%*d"
+        else if (reader.restart() && reader.match("f ") && reader.readInt(i0) &&
+            reader.match("/") && reader.skipInt() && reader.match("/") && reader.skipInt() && reader.match(" ") && reader.readInt(i1) &&
+            reader.match("/") && reader.skipInt() && reader.match("/") && reader.skipInt() && reader.match(" ") && reader.readInt(i2))
+        {
+            //indexes starts at 1 in OBJ
+            indices.push_back(i0-1);
+            indices.push_back(i1-1);
+            indices.push_back(i2-1);
         }
     }
 
@@ -1409,253 +1414,94 @@ bool sgct_core::CorrectionMesh::readAndGenerateOBJMesh(const std::string & meshP
     memcpy(mTempVertices, verts.data(), mGeometries[WARP_MESH].mNumberOfVertices * sizeof(CorrectionMeshVertex));
 
     mGeometries[WARP_MESH].mGeometryType = GL_TRIANGLES;
-    createMesh(&mGeometries[WARP_MESH]);
 
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Correction mesh read successfully! Vertices=%u, Indices=%u.\n", mGeometries[WARP_MESH].mNumberOfVertices, mGeometries[WARP_MESH].mNumberOfIndices);
     return true;
 }
 
-int numberOfDigitsInInt(int number)
-{
-    int i = 0;
-    while (number > pow(10, i))
-        i++;
-    return i;
-}
-
 /*!
-Parse data from domeprojection's camera based calibration system. Domeprojection.com
+Generate a mesh from an MPCDI geometry warp field (PFM format), either read from a file or decoded from the .mpcdi package
+when the configuration was read.
 */
 bool sgct_core::CorrectionMesh::readAndGenerateMpcdiMesh(const std::string & meshPath, Viewport* parent)
 {
-    bool isReadingFile = ( meshPath.length() > 0 ) ? true : false;
-    unsigned int srcIdx = 0;
-    char* srcBuff;
-    size_t srcSize_bytes;
-    const int MaxHeaderLineLength = 100;
-    FILE * meshFile = nullptr;
-
-    if( isReadingFile )
+    MpcdiWarpGrid fileGrid;
+    const MpcdiWarpGrid * gridPtr = &parent->getMpcdiWarpGrid();
+    if (!meshPath.empty())
     {
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
             "CorrectionMesh: Reading MPCDI mesh (PFM format) data from '%s'.\n", meshPath.c_str());
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-        if (fopen_s(&meshFile, meshPath.c_str(), "r") != 0 || !meshFile)
-        {
-            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
-                "CorrectionMesh: Failed to open warping mesh file!\n");
+        if (!fileGrid.readFile(meshPath))
             return false;
-        }
-#else
-        meshFile = fopen(meshPath.c_str(), "rb");
-        if (meshFile == NULL)
-        {
-            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
-                "CorrectionMesh: Failed to open warping mesh file!\n");
-            return false;
-        }
-#endif
+        gridPtr = &fileGrid;
     }
     else
-    {
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
-            "CorrectionMesh: Reading MPCDI mesh (PFM format) from buffer.\n", meshPath.c_str());
-        srcBuff = parent->mMpcdiWarpMeshData;
-        srcSize_bytes = parent->mMpcdiWarpMeshSize;
-    }
+            "CorrectionMesh: Reading MPCDI mesh (PFM format) from buffer.\n");
 
-    size_t retval;
-    char headerChar;
-    char headerBuffer[MaxHeaderLineLength];
-    int index = 0;
-    int nNewlines = 0;
-    const int read3lines = 3;
-
-    do {
-        if( isReadingFile )
-        {
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
-            retval = fread_s(&headerChar, sizeof(char)*1, sizeof(char), 1, meshFile);
-#else
-            retval = fread(&headerChar, sizeof(char), 1, meshFile);
-#endif
-        }
-        else
-        {
-            if( srcIdx == srcSize_bytes )
-                retval = -1;
-            else
-            {
-                headerChar = srcBuff[srcIdx++];
-                retval = 1;
-            }
-        }
-        if (retval != 1) {
-            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
-                                                    "CorrectionMesh: Error reading from file.\n");
-            fclose(meshFile);
-            return false;
-        }
-        headerBuffer[index++] = headerChar;
-        if( headerChar == '\n' )
-            nNewlines++;
-    } while (nNewlines < read3lines);
-
-    char fileFormatHeader[2];
-    unsigned int numberOfCols = 0;
-    unsigned int numberOfRows = 0;
-    float endiannessIndicator = 0;
-
-#ifdef __WIN32__
-    _sscanf(&headerBuffer[0], "%2c\n", &fileFormatHeader);
-    //Read header past the 2 character start
-    _sscanf(&headerBuffer[3], "%d %d\n", &numberOfCols, &numberOfRows);
-    int indexForEndianness = 3 + numberOfDigitsInInt(numberOfCols)
-        + numberOfDigitsInInt(numberOfRows) + 2;
-    _sscanf(&headerBuffer[indexForEndianness], "%f\n", &endiannessIndicator);
-#else
-    if (_sscanf(headerBuffer, "%2c %d %d %f", fileFormatHeader,
-                &numberOfCols, &numberOfRows, &endiannessIndicator) != 4)
+    if (gridPtr->isEmpty())
     {
-        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
-            "CorrectionMesh: Invalid header syntax.\n");
-        if (isReadingFile)
-            fclose(meshFile);
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh: No MPCDI warp data!\n");
         return false;
     }
-#endif
 
-    if (fileFormatHeader[0] != 'P' || fileFormatHeader[1] != 'F') {
-        //The 'Pf' header is invalid because PFM grayscale type is not supported.
-        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
-                                                "CorrectionMesh: Incorrect file type.\n");
-    }
-    bool littleEndian = (endiannessIndicator < 0.0) ? true : false;
+    unsigned int numberOfCols = gridPtr->getColumns();
+    unsigned int numberOfRows = gridPtr->getRows();
+    unsigned int numberOfVertices = numberOfCols * numberOfRows;
+    const float * corrections = gridPtr->getCorrections();
 
-    int numCorrectionValues = numberOfCols * numberOfRows;
-    float* correctionGridX = new float[numCorrectionValues];
-    float* correctionGridY = new float[numCorrectionValues];
-    float  errorPosition;
-    const int value32bit = 4;
+    //the vertices are written directly, the warp field is the only other copy of the data
+    mTempVertices = new CorrectionMeshVertex[numberOfVertices];
+    mGeometries[WARP_MESH].mNumberOfVertices = numberOfVertices;
 
-    if( isReadingFile )
-    {
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
- #define SGCT_READ fread_s
-#else
- #define SGCT_READ fread
-#endif
-        for (unsigned int i = 0; i < numCorrectionValues; ++i)
-        {
-#ifdef __WIN32__
-            retval = SGCT_READ(correctionGridX + i, numCorrectionValues, value32bit, 1, meshFile);
-            retval = SGCT_READ(correctionGridY + i, numCorrectionValues, value32bit, 1, meshFile);
-            //MPCDI uses the PFM format for correction grid. PFM format is designed for 3 RGB
-            // values. However MPCDI substitutes Red for X correction, Green for Y
-            // correction, and Blue for correction error. This will be NaN for no error value
-            retval = SGCT_READ(&errorPosition, numCorrectionValues, value32bit, 1, meshFile);
-#else
-            retval = SGCT_READ(correctionGridX + i, value32bit, 1, meshFile);
-            retval = SGCT_READ(correctionGridY + i, value32bit, 1, meshFile);
-            retval = SGCT_READ(&errorPosition,      value32bit, 1, meshFile);
-#endif
-        }
-        fclose(meshFile);
-        if (retval != value32bit)
-        {
-            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
-                "CorrectionMesh: Error reading all correction values!\n");
-            return false;
-        }
-    }
-    else
+    CorrectionMeshVertex vertex;
+    //init to max intensity (opaque white)
+    vertex.r = 1.0f;
+    vertex.g = 1.0f;
+    vertex.b = 1.0f;
+    vertex.a = 1.0f;
+    for (unsigned int i = 0; i < numberOfVertices; ++i)
     {
-        bool readErr = false;
-        for (unsigned int i = 0; i < numCorrectionValues; ++i)
-        {
-//#define TEST_FLAT_MESH
-
-#ifdef TEST_FLAT_MESH
-            correctionGridX[i] = (float)(i%32) / 32.0;
-            correctionGridY[i] = 1.0 - (float)i * 32.0 / 32.0;
-#else
-            if( !readMeshBuffer(&correctionGridX[i], srcIdx, srcBuff, srcSize_bytes, value32bit) )
-                readErr = true;
-            else if( !readMeshBuffer(&correctionGridY[i], srcIdx, srcBuff, srcSize_bytes, value32bit) )
-                readErr = true;
-            else if( !readMeshBuffer(&errorPosition, srcIdx, srcBuff, srcSize_bytes, value32bit) )
-                readErr = true;
-
-            if( readErr ) {
-                sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
-                    "CorrectionMesh: Error reading mpcdi correction value at index %d\n", i);
-            }
-#endif
-        }
-    }
-
-    int   gridIndex_column, gridIndex_row;
-    float* smoothPos_x = new float[numCorrectionValues];
-    float* smoothPos_y = new float[numCorrectionValues];
-    float* warpedPos_x = new float[numCorrectionValues];
-    float* warpedPos_y = new float[numCorrectionValues];
-
-    for (unsigned int i = 0; i < numCorrectionValues; ++i) {
-        gridIndex_column = i % numberOfCols;
-        gridIndex_row = i / numberOfCols;
+        unsigned int gridIndex_column = i % numberOfCols;
+        unsigned int gridIndex_row = i / numberOfCols;
         //Compute XY positions for each point based on a normalized 0,0 to 1,1 grid,
         // add the correction offsets to each warp point
-        smoothPos_x[i] = (float)gridIndex_column / (float)(numberOfCols - 1);
+        float smoothPos_x = (float)gridIndex_column / (float)(numberOfCols - 1);
         //Reverse the y position because the values from pfm file are given in raster-scan
         // order, which is left to right but starts at upper-left rather than lower-left.
-        smoothPos_y[i] = 1.0 - ((float)gridIndex_row    / (float)(numberOfRows - 1));
-        warpedPos_x[i] = smoothPos_x[i] + correctionGridX[i];
-        warpedPos_y[i] = smoothPos_y[i] + correctionGridY[i];
+        float smoothPos_y = 1.0 - ((float)gridIndex_row / (float)(numberOfRows - 1));
+        float warpedPos_x = smoothPos_x + corrections[i * 2];
+        float warpedPos_y = smoothPos_y + corrections[i * 2 + 1];
+
+        vertex.s = smoothPos_x;
+        vertex.t = smoothPos_y;
+        //scale to viewport coordinates
+        vertex.x = 2.0f * warpedPos_x - 1.0f;
+        vertex.y = 2.0f * warpedPos_y - 1.0f;
+        mTempVertices[i] = vertex;
     }
 
 #ifdef NORMALIZE_CORRECTION_MESH
-    float maxX = *std::max_element(warpedPos_x, warpedPos_x + numCorrectionValues);
-    float minX = *std::min_element(warpedPos_x, warpedPos_x + numCorrectionValues);
-    float scaleRangeX = maxX - minX;
-    float maxY = *std::max_element(warpedPos_y, warpedPos_y + numCorrectionValues);
-    float minY = *std::min_element(warpedPos_y, warpedPos_y + numCorrectionValues);
-    float scaleRangeY = maxY - minY;
-    float scaleFactor = (scaleRangeX >= scaleRangeY) ? scaleRangeX : scaleRangeY;
     //Scale all positions to fit within 0,0 to 1,1
-    for (unsigned int i = 0; i < numCorrectionValues; ++i) {
-        warpedPos_x[i] = (warpedPos_x[i] - minX) / scaleFactor;
-        warpedPos_y[i] = (warpedPos_y[i] - minY) / scaleFactor;
+    float minX = 1.0f, maxX = -1.0f, minY = 1.0f, maxY = -1.0f;
+    for (unsigned int i = 0; i < numberOfVertices; ++i)
+    {
+        minX = std::min(minX, mTempVertices[i].x);
+        maxX = std::max(maxX, mTempVertices[i].x);
+        minY = std::min(minY, mTempVertices[i].y);
+        maxY = std::max(maxY, mTempVertices[i].y);
     }
-#endif //NORMALIZE_CORRECTION_MESH
-
-    CorrectionMeshVertex vertex;
-    std::vector<CorrectionMeshVertex> vertices;
-    //init to max intensity (opaque white)
-    vertex.r = 1.0f;
-    vertex.g = 1.0f;
-    vertex.b = 1.0f;
-    vertex.a = 1.0f;
-    for (unsigned int i = 0; i < numCorrectionValues; ++i) {
-        vertex.s = smoothPos_x[i];
-        vertex.t = smoothPos_y[i];
-        //scale to viewport coordinates
-        vertex.x = 2.0f * warpedPos_x[i] - 1.0f;
-        vertex.y = 2.0f * warpedPos_y[i] - 1.0f;
-        vertices.push_back(vertex);
+    float scaleFactor = std::max(maxX - minX, maxY - minY) / 2.0f;
+    for (unsigned int i = 0; i < numberOfVertices; ++i)
+    {
+        mTempVertices[i].x = 2.0f * ((mTempVertices[i].x + 1.0f) / 2.0f - (minX + 1.0f) / 2.0f) / scaleFactor - 1.0f;
+        mTempVertices[i].y = 2.0f * ((mTempVertices[i].y + 1.0f) / 2.0f - (minY + 1.0f) / 2.0f) / scaleFactor - 1.0f;
     }
-    delete[] warpedPos_x;
-    delete[] warpedPos_y;
-    delete[] smoothPos_x;
-    delete[] smoothPos_y;
-
-    //copy vertices
-    unsigned int numberOfVertices = numberOfCols * numberOfRows;
-    mTempVertices = new CorrectionMeshVertex[numberOfVertices];
-    memcpy(mTempVertices, vertices.data(), numberOfVertices * sizeof(CorrectionMeshVertex));
-    mGeometries[WARP_MESH].mNumberOfVertices = numberOfVertices;
-    vertices.clear();
+#endif //NORMALIZE_CORRECTION_MESH
 
-    std::vector<unsigned int> indices;
+    mGeometries[WARP_MESH].mNumberOfIndices = (numberOfCols - 1) * (numberOfRows - 1) * 6;
+    mTempIndices = new unsigned int[mGeometries[WARP_MESH].mNumberOfIndices];
+    unsigned int * indexPtr = mTempIndices;
     unsigned int i0, i1, i2, i3;
     for (unsigned int c = 0; c < (numberOfCols -1); c++)
         for (unsigned int r = 0; r < (numberOfRows-1); r++)
@@ -1665,8 +1511,6 @@ bool sgct_core::CorrectionMesh::readAndGenerateMpcdiMesh(const std::string & mes
             i2 = (r + 1) * numberOfCols + (c + 1);
             i3 = (r + 1) * numberOfCols + c;
 
-            //fprintf(stderr, "Indexes: %u %u %u %u\n", i0, i1, i2, i3);
-
             /*
 
             3      2
@@ -1681,46 +1525,247 @@ bool sgct_core::CorrectionMesh::readAndGenerateMpcdiMesh(const std::string & mes
             */
 
             //triangle 1
-            indices.push_back(i0);
-            indices.push_back(i1);
-            indices.push_back(i2);
+            *indexPtr++ = i0;
+            *indexPtr++ = i1;
+            *indexPtr++ = i2;
 
             //triangle 2
-            indices.push_back(i0);
-            indices.push_back(i2);
-            indices.push_back(i3);
+            *indexPtr++ = i0;
+            *indexPtr++ = i2;
+            *indexPtr++ = i3;
         }
 
-    //allocate and copy indices
-    mGeometries[WARP_MESH].mNumberOfIndices = static_cast<unsigned int>(indices.size());
-    mTempIndices = new unsigned int[mGeometries[WARP_MESH].mNumberOfIndices];
-    memcpy(mTempIndices, indices.data(), mGeometries[WARP_MESH].mNumberOfIndices * sizeof(unsigned int));
-    indices.clear();
-
     mGeometries[WARP_MESH].mGeometryType = GL_TRIANGLES;
-
-    createMesh(&mGeometries[WARP_MESH]);
+    mGridSize[0] = numberOfCols;
+    mGridSize[1] = numberOfRows;
 
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Mpcdi Correction mesh read successfully! Vertices=%u, Indices=%u.\n", mGeometries[WARP_MESH].mNumberOfVertices, mGeometries[WARP_MESH].mNumberOfIndices);
 
     return true;
 }
 
-bool sgct_core::CorrectionMesh::readMeshBuffer(float* dest, unsigned int& idx,
-                                               char* src,
-                                               const size_t srcSize_bytes,
-                                               const int readSize_bytes)
+/*!
+Open a compiled mesh from the cache. The mapping stays open until uploadMesh.
+*/
+bool sgct_core::CorrectionMesh::readCachedMesh(const std::string & cacheFilename, const std::string & meshPath, unsigned long long parameterHash)
+{
+    CorrectionMeshCache & cache = mCachedMesh;
+    if (!cache.open(cacheFilename, meshPath, parameterHash))
+        return false;
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
+        "CorrectionMesh: Reading compiled mesh data from '%s'.\n", cacheFilename.c_str());
+
+    mCacheProperties = cache.getProperties();
+
+    mGeometries[WARP_MESH].mNumberOfVertices = cache.getNumberOfVertices();
+    mGeometries[WARP_MESH].mNumberOfIndices = cache.getNumberOfIndices();
+    mGeometries[WARP_MESH].mGeometryType = mCacheProperties.mGeometryType;
+
+    //exportMesh reads the temporary buffers
+    if (sgct::SGCTSettings::instance()->getExportWarpingMeshes())
+    {
+        mTempVertices = new CorrectionMeshVertex[cache.getNumberOfVertices()];
+        memcpy(mTempVertices, cache.getVertices(), cache.getNumberOfVertices() * sizeof(CorrectionMeshVertex));
+        mTempIndices = new unsigned int[cache.getNumberOfIndices()];
+        memcpy(mTempIndices, cache.getIndices(), cache.getNumberOfIndices() * sizeof(unsigned int));
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Correction mesh read successfully! Vertices=%u, Indices=%u.\n", mGeometries[WARP_MESH].mNumberOfVertices, mGeometries[WARP_MESH].mNumberOfIndices);
+    return true;
+}
+
+/*!
+Hash of everything except the source file that the generated mesh depends on.
+*/
+unsigned long long sgct_core::CorrectionMesh::getParameterHash(const std::string & meshPath, MeshFormat meshFmt, Viewport * parent)
+{
+    float params[8];
+    params[0] = parent->getX();
+    params[1] = parent->getY();
+    params[2] = parent->getXSize();
+    params[3] = parent->getYSize();
+    //paul bourke meshes are scaled by the window aspect ratio
+    params[4] = meshFmt == PAULBOURKE_FMT ? mWindowAspectRatio : 0.0f;
+    //decimated meshes depend on the error in pixels
+    float decimationError = sgct::SGCTSettings::instance()->getWarpMeshDecimationError();
+    params[5] = decimationError > 0.0f ? decimationError : 0.0f;
+    params[6] = decimationError > 0.0f ? static_cast<float>(mFramebufferResolution[0]) : 0.0f;
+    params[7] = decimationError > 0.0f ? static_cast<float>(mFramebufferResolution[1]) : 0.0f;
+
+    int format = static_cast<int>(meshFmt);
+    unsigned long long hash = sgct_helpers::hashFNV1a(meshPath.c_str(), meshPath.size());
+    hash = sgct_helpers::hashFNV1a(&format, sizeof(format), hash);
+    hash = sgct_helpers::hashFNV1a(params, sizeof(params), hash);
+    //fitted meshes have other texture coordinates, unfitted ones keep the hash they had
+    if (parent->getFitFrustumToMesh())
+    {
+        const char fitted[] = "fitFrustumToMesh";
+        hash = sgct_helpers::hashFNV1a(fitted, sizeof(fitted), hash);
+    }
+    return hash;
+}
+
+/*!
+Simplify a mesh parsed as a regular grid within the decimation error set in SGCTSettings.
+@return true if the mesh was replaced
+*/
+bool sgct_core::CorrectionMesh::decimateMesh()
+{
+    CorrectionMeshGeometry & geometry = mGeometries[WARP_MESH];
+    if (mGridSize[0] < 2 || mGridSize[1] < 2 || geometry.mGeometryType != GL_TRIANGLES ||
+        static_cast<std::size_t>(mGridSize[0]) * mGridSize[1] != geometry.mNumberOfVertices)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Decimation is only supported for grid meshes.\n");
+        return false;
+    }
+
+    float maxError = sgct::SGCTSettings::instance()->getWarpMeshDecimationError();
+    std::vector<CorrectionMeshVertex> vertices;
+    std::vector<unsigned int> indices;
+    if (!CorrectionMeshDecimator::decimateGrid(mTempVertices, mGridSize[0], mGridSize[1], mTempIndices, geometry.mNumberOfIndices,
+        maxError, mFramebufferResolution[0], mFramebufferResolution[1], vertices, indices) || indices.empty())
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING, "CorrectionMesh: Mesh triangles don't follow the grid, decimation skipped.\n");
+        return false;
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
+        "CorrectionMesh: Decimated mesh from %u to %u triangles (max error %.2f pixels).\n",
+        geometry.mNumberOfIndices / 3, static_cast<unsigned int>(indices.size() / 3), maxError);
+
+    cleanUp();
+    geometry.mNumberOfVertices = static_cast<unsigned int>(vertices.size());
+    geometry.mNumberOfIndices = static_cast<unsigned int>(indices.size());
+    mTempVertices = new CorrectionMeshVertex[geometry.mNumberOfVertices];
+    memcpy(mTempVertices, vertices.data(), geometry.mNumberOfVertices * sizeof(CorrectionMeshVertex));
+    mTempIndices = new unsigned int[geometry.mNumberOfIndices];
+    memcpy(mTempIndices, indices.data(), geometry.mNumberOfIndices * sizeof(unsigned int));
+    return true;
+}
+
+/*!
+Apply the view plane and projection changes a mesh format carries.
+*/
+void sgct_core::CorrectionMesh::applyCacheProperties(Viewport * parent)
+{
+    if (mCacheProperties.mHasViewPlane)
+    {
+        glm::vec3 userPosition(mCacheProperties.mUserPosition[0], mCacheProperties.mUserPosition[1], mCacheProperties.mUserPosition[2]);
+        bool userMoved = parent->getUser()->getPos() != userPosition;
+        parent->getUser()->setPos(userPosition);
+
+        parent->setViewPlaneCoordsUsingFOVs(
+            mCacheProperties.mFov[0],
+            mCacheProperties.mFov[1],
+            mCacheProperties.mFov[2],
+            mCacheProperties.mFov[3],
+            glm::quat(mCacheProperties.mRotation[0], mCacheProperties.mRotation[1], mCacheProperties.mRotation[2], mCacheProperties.mRotation[3])
+            );
+
+        //the user may be shared with other viewports, otherwise only this viewport changed
+        if (userMoved)
+            sgct::Engine::instance()->updateFrustums();
+        else
+            parent->updateFrustums(sgct::Engine::instance()->getNearClippingPlane(), sgct::Engine::instance()->getFarClippingPlane());
+    }
+
+    if (mCacheProperties.mFisheyeIgnoreAspect)
+    {
+        if (auto* fishPrj = dynamic_cast<FisheyeProjection*>(parent->getNonLinearProjectionPtr()))
+        {
+            fishPrj->setIgnoreAspectRatio(true);
+            fishPrj->update(1.0f, 1.0f);
+        }
+    }
+}
+
+/*!
+Narrow the view plane of the parsed mesh to the texture coordinates it uses. The fitted field of view is stored
+in the cache properties, so compiled meshes don't have to be fitted again.
+*/
+void sgct_core::CorrectionMesh::fitFrustumToMesh(Viewport * parent)
 {
-    float val;
-    if( (idx + readSize_bytes) > srcSize_bytes )
+    if (!mCacheProperties.mHasViewPlane || mTempVertices == nullptr)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING,
+            "CorrectionMesh: Only meshes with a view plane can be fitted to the frustum.\n");
+        return;
+    }
+
+    glm::vec4 area(parent->getX(), parent->getY(), parent->getXSize(), parent->getYSize());
+    MeshFrustumFit::Bounds bounds;
+    if (!MeshFrustumFit::compute(mTempVertices, mGeometries[WARP_MESH].mNumberOfVertices, mCacheProperties.mFov, area, bounds))
+        return;
+
+    MeshFrustumFit::remapTexCoords(mTempVertices, mGeometries[WARP_MESH].mNumberOfVertices, area, bounds);
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
+        "CorrectionMesh: Fitted frustum to mesh, fov up = %f down = %f left = %f right = %f (was %f %f %f %f).\n",
+        bounds.mFov[0], bounds.mFov[1], bounds.mFov[2], bounds.mFov[3],
+        mCacheProperties.mFov[0], mCacheProperties.mFov[1], mCacheProperties.mFov[2], mCacheProperties.mFov[3]);
+    for (int i = 0; i < 4; i++)
+        mCacheProperties.mFov[i] = bounds.mFov[i];
+}
+
+/*!
+Rasterize the parsed mesh into a lookup table with one texel per framebuffer pixel of the viewport. The table
+is stored next to the compiled mesh and read from there if the mesh and the framebuffer size are unchanged.
+
+@return true if the warp mesh will be replaced by a lookup texture
+*/
+bool sgct_core::CorrectionMesh::bakeLookupTable(const std::string & meshPath, bool useCache, unsigned long long parameterHash)
+{
+    //the lookup shader needs float textures
+    if (sgct::Engine::instance()->isOGLPipelineFixed())
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING,
+            "CorrectionMesh: Warp lookup textures require the programmable pipeline, using the mesh.\n");
+        return false;
+    }
+
+    int width = static_cast<int>(floorf(parent->getXSize() * static_cast<float>(mFramebufferResolution[0]) + 0.5f));
+    int height = static_cast<int>(floorf(parent->getYSize() * static_cast<float>(mFramebufferResolution[1]) + 0.5f));
+    if (width <= 0 || height <= 0)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING,
+            "CorrectionMesh: Unknown framebuffer size, using the mesh instead of a warp lookup texture.\n");
+        return false;
+    }
+
+    std::string cacheFilename;
+    if (useCache)
+    {
+        parameterHash = sgct_helpers::hashFNV1a(&width, sizeof(width), parameterHash);
+        parameterHash = sgct_helpers::hashFNV1a(&height, sizeof(height), parameterHash);
+        cacheFilename = WarpLookupTable::getCacheFilename(sgct::SGCTSettings::instance()->getWarpMeshCacheDirectory(), meshPath, parameterHash);
+        if (mLookupTable.load(cacheFilename, meshPath, parameterHash))
+        {
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Read warp lookup table '%s'.\n", cacheFilename.c_str());
+            return true;
+        }
+    }
+
+    const CorrectionMeshVertex * vertices = mCachedMesh.isOpen() ? mCachedMesh.getVertices() : mTempVertices;
+    const unsigned int * indices = mCachedMesh.isOpen() ? mCachedMesh.getIndices() : mTempIndices;
+    const CorrectionMeshGeometry & geometry = mGeometries[WARP_MESH];
+    if (geometry.mGeometryType != GL_TRIANGLES && geometry.mGeometryType != GL_TRIANGLE_STRIP)
     {
-        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
-            "CorrectionMesh: Reached EOF in mesh buffer!\n");
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING,
+            "CorrectionMesh: The geometry type can't be baked into a warp lookup texture, using the mesh.\n");
         return false;
     }
-    memcpy(&val, &src[idx], readSize_bytes);
-    *dest = val;
-    idx += readSize_bytes;
+
+    if (!mLookupTable.bake(vertices, geometry.mNumberOfVertices, indices, geometry.mNumberOfIndices, geometry.mGeometryType == GL_TRIANGLE_STRIP,
+        glm::vec4(parent->getX(), parent->getY(), parent->getXSize(), parent->getYSize()), width, height))
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING,
+            "CorrectionMesh: Failed to bake a warp lookup texture for '%s', using the mesh.\n", meshPath.c_str());
+        return false;
+    }
+
+    if (useCache)
+        mLookupTable.store(cacheFilename, meshPath, parameterHash);
     return true;
 }
 
@@ -1839,6 +1884,11 @@ void sgct_core::CorrectionMesh::setupMaskMesh(Viewport * parent, bool flip_x, bo
 }
 
 void sgct_core::CorrectionMesh::createMesh(sgct_core::CorrectionMeshGeometry * geomPtr)
+{
+    createMesh(geomPtr, mTempVertices, mTempIndices);
+}
+
+void sgct_core::CorrectionMesh::createMesh(sgct_core::CorrectionMeshGeometry * geomPtr, const CorrectionMeshVertex * vertices, const unsigned int * indices)
 {
     /*sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO, "Uploading mesh data (type=%d)...\n",
         ClusterManager::instance()->getMeshImplementation());*/
@@ -1856,44 +1906,61 @@ void sgct_core::CorrectionMesh::createMesh(sgct_core::CorrectionMeshGeometry * g
         glGenBuffers(2, &(geomPtr->mMeshData[0]));
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Generating VBOs: %d %d\n", geomPtr->mMeshData[0], geomPtr->mMeshData[1]);
 
+        //the fixed pipeline can't normalize positions and texture coordinates
+        CorrectionMeshLayout & layout = geomPtr->mLayout;
+        layout.choose(vertices, geomPtr->mNumberOfVertices, glm::ivec2(mFramebufferResolution[0], mFramebufferResolution[1]),
+            !sgct::Engine::instance()->isOGLPipelineFixed());
+
+        std::vector<unsigned char> vertexData;
+        std::vector<unsigned char> indexData;
+        layout.packVertices(vertices, geomPtr->mNumberOfVertices, vertexData);
+        layout.packIndices(indices, geomPtr->mNumberOfIndices, indexData);
+
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMesh: Packed %u vertices into %u bytes per vertex and %u bytes per index.\n",
+            geomPtr->mNumberOfVertices, layout.mStride, layout.mIndexSize);
+
         glBindBuffer(GL_ARRAY_BUFFER, geomPtr->mMeshData[Vertex]);
-        glBufferData(GL_ARRAY_BUFFER, geomPtr->mNumberOfVertices * sizeof(CorrectionMeshVertex), &mTempVertices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, vertexData.size(), vertexData.empty() ? nullptr : vertexData.data(), GL_STATIC_DRAW);
 
         if(!sgct::Engine::instance()->isOGLPipelineFixed())
         {
             glEnableVertexAttribArray(0);
             glVertexAttribPointer(
                 0, // The attribute we want to configure
-                2,                           // size
-                GL_FLOAT,                    // type
-                GL_FALSE,                    // normalized?
-                sizeof(CorrectionMeshVertex),// stride
-                reinterpret_cast<void*>(0)   // array buffer offset
+                2,                                             // size
+                getAttributeType(layout.mPositionFormat),      // type
+                layout.mPositionFormat != CorrectionMeshLayout::Float ? GL_TRUE : GL_FALSE, // normalized?
+                layout.mStride,                                // stride
+                reinterpret_cast<void*>(layout.mPositionOffset)// array buffer offset
             );
 
             glEnableVertexAttribArray(1);
             glVertexAttribPointer(
                 1, // The attribute we want to configure
-                2,                           // size
-                GL_FLOAT,                    // type
-                GL_FALSE,                    // normalized?
-                sizeof(CorrectionMeshVertex),// stride
-                reinterpret_cast<void*>(8)   // array buffer offset
+                2,                                             // size
+                getAttributeType(layout.mTexCoordFormat),      // type
+                layout.mTexCoordFormat != CorrectionMeshLayout::Float ? GL_TRUE : GL_FALSE, // normalized?
+                layout.mStride,                                // stride
+                reinterpret_cast<void*>(layout.mTexCoordOffset)// array buffer offset
             );
 
-            glEnableVertexAttribArray(2);
-            glVertexAttribPointer(
-                2, // The attribute we want to configure
-                4,                           // size
-                GL_FLOAT,                    // type
-                GL_FALSE,                    // normalized?
-                sizeof(CorrectionMeshVertex),// stride
-                reinterpret_cast<void*>(16)  // array buffer offset
-            );
+            //without a color stream the constant attribute value is set when rendering
+            if (layout.mColorFormat != CorrectionMeshLayout::NoAttribute)
+            {
+                glEnableVertexAttribArray(2);
+                glVertexAttribPointer(
+                    2, // The attribute we want to configure
+                    4,                                             // size
+                    getAttributeType(layout.mColorFormat),         // type
+                    layout.mColorFormat != CorrectionMeshLayout::Float ? GL_TRUE : GL_FALSE, // normalized?
+                    layout.mStride,                                // stride
+                    reinterpret_cast<void*>(layout.mColorOffset)   // array buffer offset
+                );
+            }
         }
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geomPtr->mMeshData[Index]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, geomPtr->mNumberOfIndices * sizeof(unsigned int), &mTempIndices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexData.size(), indexData.empty() ? nullptr : indexData.data(), GL_STATIC_DRAW);
 
         //unbind
         if(!sgct::Engine::instance()->isOGLPipelineFixed())
@@ -1912,7 +1979,7 @@ void sgct_core::CorrectionMesh::createMesh(sgct_core::CorrectionMeshGeometry * g
         
         for (unsigned int i = 0; i < geomPtr->mNumberOfIndices; i++)
         {
-            vertex = mTempVertices[mTempIndices[i]];
+            vertex = vertices[indices[i]];
 
             glColor4f(vertex.r, vertex.g, vertex.b, vertex.a);
             glTexCoord2f(vertex.s, vertex.t);
@@ -1991,6 +2058,33 @@ void sgct_core::CorrectionMesh::exportMesh(const std::string & exportMeshPath)
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "CorrectionMesh error: Failed to export '%s'!\n", exportMeshPath.c_str());
 }
 
+/*!
+Exchange the uploaded meshes with another correction mesh, used to replace a mesh that was reloaded in the
+background. Both meshes must have been uploaded.
+*/
+void sgct_core::CorrectionMesh::swap(CorrectionMesh & other)
+{
+    for (std::size_t i = 0; i < LAST_MESH; i++)
+    {
+        std::swap(mGeometries[i].mGeometryType, other.mGeometries[i].mGeometryType);
+        std::swap(mGeometries[i].mNumberOfVertices, other.mGeometries[i].mNumberOfVertices);
+        std::swap(mGeometries[i].mNumberOfIndices, other.mGeometries[i].mNumberOfIndices);
+        for (std::size_t j = 0; j < 3; j++)
+            std::swap(mGeometries[i].mMeshData[j], other.mGeometries[i].mMeshData[j]);
+        std::swap(mGeometries[i].mLayout, other.mGeometries[i].mLayout);
+    }
+
+    std::swap(mCacheProperties, other.mCacheProperties);
+    std::swap(mWindowAspectRatio, other.mWindowAspectRatio);
+    std::swap(mLookupTexture, other.mLookupTexture);
+    mLookupTable.swap(other.mLookupTable);
+    for (std::size_t i = 0; i < 2; i++)
+    {
+        std::swap(mFramebufferResolution[i], other.mFramebufferResolution[i]);
+        std::swap(mGridSize[i], other.mGridSize[i]);
+    }
+}
+
 void sgct_core::CorrectionMesh::cleanUp()
 {
     delete[] mTempVertices;
@@ -2023,6 +2117,9 @@ void sgct_core::CorrectionMesh::render(const MeshType & mt)
 
     if( ClusterManager::instance()->getMeshImplementation() == ClusterManager::BUFFER_OBJECTS )
     {
+        const CorrectionMeshLayout & layout = geomPtr->mLayout;
+        GLenum indexType = layout.mIndexSize == sizeof(unsigned short) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
         if(sgct::Engine::instance()->isOGLPipelineFixed())
         {
             glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
@@ -2030,16 +2127,21 @@ void sgct_core::CorrectionMesh::render(const MeshType & mt)
             glEnableClientState(GL_VERTEX_ARRAY);
             glClientActiveTexture(GL_TEXTURE0);
             glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-            glEnableClientState(GL_COLOR_ARRAY);
 
             glBindBuffer(GL_ARRAY_BUFFER, geomPtr->mMeshData[Vertex]);
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geomPtr->mMeshData[Index]);
         
-            glVertexPointer(2, GL_FLOAT, sizeof(CorrectionMeshVertex), reinterpret_cast<void*>(0));        
-            glTexCoordPointer(2, GL_FLOAT, sizeof(CorrectionMeshVertex), reinterpret_cast<void*>(8));
-            glColorPointer(4, GL_FLOAT, sizeof(CorrectionMeshVertex), reinterpret_cast<void*>(16));
+            glVertexPointer(2, GL_FLOAT, layout.mStride, reinterpret_cast<void*>(layout.mPositionOffset));
+            glTexCoordPointer(2, GL_FLOAT, layout.mStride, reinterpret_cast<void*>(layout.mTexCoordOffset));
+            if (layout.mColorFormat != CorrectionMeshLayout::NoAttribute)
+            {
+                glEnableClientState(GL_COLOR_ARRAY);
+                glColorPointer(4, getAttributeType(layout.mColorFormat), layout.mStride, reinterpret_cast<void*>(layout.mColorOffset));
+            }
+            else
+                glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 
-            glDrawElements(geomPtr->mGeometryType, geomPtr->mNumberOfIndices, GL_UNSIGNED_INT, nullptr);
+            glDrawElements(geomPtr->mGeometryType, geomPtr->mNumberOfIndices, indexType, nullptr);
         
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
             glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -2048,8 +2150,11 @@ void sgct_core::CorrectionMesh::render(const MeshType & mt)
         }
         else
         {
+            if (layout.mColorFormat == CorrectionMeshLayout::NoAttribute)
+                glVertexAttrib4f(2, 1.0f, 1.0f, 1.0f, 1.0f);
+
             glBindVertexArray(geomPtr->mMeshData[Array]);
-            glDrawElements(geomPtr->mGeometryType, geomPtr->mNumberOfIndices, GL_UNSIGNED_INT, nullptr);
+            glDrawElements(geomPtr->mGeometryType, geomPtr->mNumberOfIndices, indexType, nullptr);
             glBindVertexArray(0);
         }
     }
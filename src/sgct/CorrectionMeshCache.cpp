@@ -0,0 +1,264 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/CorrectionMeshCache.h>
+#include <sgct/CorrectionMesh.h>
+#include <sgct/MessageHandler.h>
+#include <sgct/Engine.h>
+#include <sgct/helpers/SGCTFileFunctions.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <thread>
+#include <functional>
+
+#define MESH_CACHE_MAGIC "SGCTMESH"
+#define MESH_CACHE_MAGIC_LENGTH 8
+#define MESH_CACHE_VERSION 1
+#define MESH_CACHE_BYTE_ORDER 0x01020304
+
+namespace
+{
+    //stored as is, vertex data follows directly after the header
+    struct MeshCacheHeader
+    {
+        char mMagic[MESH_CACHE_MAGIC_LENGTH];
+        uint32_t mVersion;
+        uint32_t mByteOrder;
+        uint32_t mVertexSize;
+        uint32_t mIndexSize;
+        uint32_t mNumberOfVertices;
+        uint32_t mNumberOfIndices;
+        uint32_t mGeometryType;
+        uint32_t mFlags;
+        uint64_t mSourceSize;
+        uint64_t mSourceTime;
+        uint64_t mSourceHash;
+        uint64_t mParameterHash;
+        float mUserPosition[3];
+        float mFov[4];
+        float mRotation[4];
+        uint32_t mReserved[3];
+    };
+
+    enum MeshCacheFlags { VIEW_PLANE_FLAG = 1, FISHEYE_IGNORE_ASPECT_FLAG = 2 };
+
+    bool hashFile(const std::string & path, unsigned long long & hash)
+    {
+        sgct_core::MappedFile file;
+        if (!file.open(path))
+            return false;
+
+        hash = sgct_helpers::hashFNV1a(file.getData(), file.getSize());
+        return true;
+    }
+}
+
+sgct_core::CorrectionMeshCache::Properties::Properties()
+{
+    mGeometryType = GL_TRIANGLES;
+    mHasViewPlane = false;
+    mFisheyeIgnoreAspect = false;
+    for (int i = 0; i < 3; i++)
+        mUserPosition[i] = 0.0f;
+    for (int i = 0; i < 4; i++)
+        mFov[i] = 0.0f;
+    mRotation[0] = 1.0f;
+    mRotation[1] = mRotation[2] = mRotation[3] = 0.0f;
+}
+
+sgct_core::CorrectionMeshCache::CorrectionMeshCache()
+{
+    mVertices = nullptr;
+    mIndices = nullptr;
+    mNumberOfVertices = 0;
+    mNumberOfIndices = 0;
+}
+
+sgct_core::CorrectionMeshCache::~CorrectionMeshCache()
+{
+    close();
+}
+
+/*!
+    Get the cache entry filename for a source mesh.
+
+    \param cacheDirectory the cache directory, if empty the entry is placed next to the source
+    \param source the path to the source mesh
+    \param parameterHash hash of the parameters the mesh is generated with
+*/
+std::string sgct_core::CorrectionMeshCache::getCacheFilename(const std::string & cacheDirectory, const std::string & source, unsigned long long parameterHash)
+{
+    std::size_t found = source.find_last_of("/\\");
+    std::string name = (found == std::string::npos) ? source : source.substr(found + 1);
+
+    char suffix[32];
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    sprintf_s(suffix, sizeof(suffix), ".%016llx.sgctmesh", parameterHash);
+#else
+    sprintf(suffix, ".%016llx.sgctmesh", parameterHash);
+#endif
+
+    std::string filename;
+    if (cacheDirectory.empty())
+        filename = (found == std::string::npos) ? std::string() : source.substr(0, found + 1);
+    else
+    {
+        filename = cacheDirectory;
+        if (filename[filename.size() - 1] != '/' && filename[filename.size() - 1] != '\\')
+            filename.push_back('/');
+    }
+
+    filename.append(name);
+    filename.append(suffix);
+    return filename;
+}
+
+/*!
+    Map a cache entry.
+    \returns false if there is no valid entry for the current version of the source and parameters
+*/
+bool sgct_core::CorrectionMeshCache::open(const std::string & filename, const std::string & source, unsigned long long parameterHash)
+{
+    close();
+
+    unsigned long long mtime, size;
+    if (!sgct_helpers::getFileInfo(source, mtime, size) || !mFile.open(filename) || mFile.getSize() < sizeof(MeshCacheHeader))
+    {
+        close();
+        return false;
+    }
+
+    MeshCacheHeader header;
+    memcpy(&header, mFile.getData(), sizeof(MeshCacheHeader));
+
+    unsigned long long dataSize = static_cast<unsigned long long>(header.mNumberOfVertices) * sizeof(CorrectionMeshVertex) +
+        static_cast<unsigned long long>(header.mNumberOfIndices) * sizeof(unsigned int);
+
+    if (memcmp(header.mMagic, MESH_CACHE_MAGIC, MESH_CACHE_MAGIC_LENGTH) != 0 ||
+        header.mVersion != MESH_CACHE_VERSION ||
+        header.mByteOrder != MESH_CACHE_BYTE_ORDER ||
+        header.mVertexSize != sizeof(CorrectionMeshVertex) ||
+        header.mIndexSize != sizeof(unsigned int) ||
+        header.mParameterHash != parameterHash ||
+        header.mSourceSize != size ||
+        mFile.getSize() < sizeof(MeshCacheHeader) + dataSize)
+    {
+        close();
+        return false;
+    }
+
+    //a source with a new time stamp but the same contents (copied to another node for instance) is still valid
+    if (header.mSourceTime != mtime)
+    {
+        unsigned long long hash;
+        if (!hashFile(source, hash) || hash != header.mSourceHash)
+        {
+            close();
+            return false;
+        }
+    }
+
+    mProperties.mGeometryType = header.mGeometryType;
+    mProperties.mHasViewPlane = (header.mFlags & VIEW_PLANE_FLAG) != 0;
+    mProperties.mFisheyeIgnoreAspect = (header.mFlags & FISHEYE_IGNORE_ASPECT_FLAG) != 0;
+    memcpy(mProperties.mUserPosition, header.mUserPosition, sizeof(header.mUserPosition));
+    memcpy(mProperties.mFov, header.mFov, sizeof(header.mFov));
+    memcpy(mProperties.mRotation, header.mRotation, sizeof(header.mRotation));
+
+    mNumberOfVertices = header.mNumberOfVertices;
+    mNumberOfIndices = header.mNumberOfIndices;
+    mVertices = reinterpret_cast<const CorrectionMeshVertex *>(mFile.getData() + sizeof(MeshCacheHeader));
+    mIndices = reinterpret_cast<const unsigned int *>(mFile.getData() + sizeof(MeshCacheHeader) + mNumberOfVertices * sizeof(CorrectionMeshVertex));
+
+    return true;
+}
+
+/*!
+    Unmap the entry, the vertex and index pointers are invalid after this.
+*/
+void sgct_core::CorrectionMeshCache::close()
+{
+    mFile.close();
+    mVertices = nullptr;
+    mIndices = nullptr;
+    mNumberOfVertices = 0;
+    mNumberOfIndices = 0;
+    mProperties = Properties();
+}
+
+/*!
+    Write a cache entry for a generated mesh.
+    \returns false if the entry couldn't be written
+*/
+bool sgct_core::CorrectionMeshCache::store(const std::string & filename, const std::string & source, unsigned long long parameterHash, const Properties & properties,
+    const CorrectionMeshVertex * vertices, unsigned int numberOfVertices, const unsigned int * indices, unsigned int numberOfIndices)
+{
+    MeshCacheHeader header;
+    memset(&header, 0, sizeof(MeshCacheHeader));
+
+    unsigned long long mtime, size, hash;
+    if (!sgct_helpers::getFileInfo(source, mtime, size) || !hashFile(source, hash))
+        return false;
+
+    memcpy(header.mMagic, MESH_CACHE_MAGIC, MESH_CACHE_MAGIC_LENGTH);
+    header.mVersion = MESH_CACHE_VERSION;
+    header.mByteOrder = MESH_CACHE_BYTE_ORDER;
+    header.mVertexSize = sizeof(CorrectionMeshVertex);
+    header.mIndexSize = sizeof(unsigned int);
+    header.mNumberOfVertices = numberOfVertices;
+    header.mNumberOfIndices = numberOfIndices;
+    header.mGeometryType = properties.mGeometryType;
+    header.mFlags = (properties.mHasViewPlane ? VIEW_PLANE_FLAG : 0) | (properties.mFisheyeIgnoreAspect ? FISHEYE_IGNORE_ASPECT_FLAG : 0);
+    header.mSourceSize = size;
+    header.mSourceTime = mtime;
+    header.mSourceHash = hash;
+    header.mParameterHash = parameterHash;
+    memcpy(header.mUserPosition, properties.mUserPosition, sizeof(header.mUserPosition));
+    memcpy(header.mFov, properties.mFov, sizeof(header.mFov));
+    memcpy(header.mRotation, properties.mRotation, sizeof(header.mRotation));
+
+    //unique temporary name per process and thread, viewports sharing a mesh may be stored concurrently
+    char suffix[32];
+    unsigned long long id = std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+        static_cast<unsigned long long>(sgct::Engine::getTime() * 1000000.0) ^ static_cast<unsigned long long>(reinterpret_cast<std::size_t>(vertices));
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    sprintf_s(suffix, sizeof(suffix), ".%016llx.tmp", id);
+#else
+    sprintf(suffix, ".%016llx.tmp", id);
+#endif
+    std::string tmpFilename = filename + suffix;
+    FILE * fp = nullptr;
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    if (fopen_s(&fp, tmpFilename.c_str(), "wb") != 0)
+        fp = nullptr;
+#else
+    fp = fopen(tmpFilename.c_str(), "wb");
+#endif
+    if (fp == nullptr)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING, "CorrectionMeshCache: Failed to write '%s'!\n", filename.c_str());
+        return false;
+    }
+
+    bool success = fwrite(&header, sizeof(MeshCacheHeader), 1, fp) == 1;
+    if (success && numberOfVertices > 0)
+        success = fwrite(vertices, sizeof(CorrectionMeshVertex), numberOfVertices, fp) == numberOfVertices;
+    if (success && numberOfIndices > 0)
+        success = fwrite(indices, sizeof(unsigned int), numberOfIndices, fp) == numberOfIndices;
+    success = (fclose(fp) == 0) && success;
+
+    if (!success || !sgct_helpers::replaceFile(tmpFilename, filename))
+    {
+        remove(tmpFilename.c_str());
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING, "CorrectionMeshCache: Failed to write '%s'!\n", filename.c_str());
+        return false;
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "CorrectionMeshCache: Stored '%s'.\n", filename.c_str());
+    return true;
+}
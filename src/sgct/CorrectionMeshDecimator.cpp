@@ -0,0 +1,523 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/CorrectionMeshDecimator.h>
+#include <sgct/MessageHandler.h>
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+namespace
+{
+    const unsigned char FIRST_TRIANGLE = 1;
+    const unsigned char SECOND_TRIANGLE = 2;
+    const unsigned char FULL_CELL = FIRST_TRIANGLE | SECOND_TRIANGLE;
+    const unsigned int UNUSED_INDEX = std::numeric_limits<unsigned int>::max();
+    const std::size_t MAX_BINS_PER_AXIS = 1024;
+
+    //! Cells [c0, c1) x [r0, r1), the block corner vertices are (c0, r0) and (c1, r1)
+    struct Block
+    {
+        unsigned int c0, r0, c1, r1;
+    };
+
+    struct GridInfo
+    {
+        const sgct_core::CorrectionMeshVertex * mVertices;
+        unsigned int mColumns;
+        double mScale[4]; //x, y, s, t to pixels
+        double mTolerance;
+    };
+
+    inline const sgct_core::CorrectionMeshVertex & vertexAt(const GridInfo & grid, unsigned int c, unsigned int r)
+    {
+        return grid.mVertices[static_cast<std::size_t>(r) * grid.mColumns + c];
+    }
+
+    inline bool sameColor(const sgct_core::CorrectionMeshVertex & a, const sgct_core::CorrectionMeshVertex & b)
+    {
+        return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+    }
+
+    /*!
+        Checks that all vertices of the block have the same color and are within the tolerance of the affine
+        map through the averaged block edges.
+    */
+    bool isBlockAffine(const GridInfo & grid, const Block & block)
+    {
+        const sgct_core::CorrectionMeshVertex & v00 = vertexAt(grid, block.c0, block.r0);
+        const sgct_core::CorrectionMeshVertex & v10 = vertexAt(grid, block.c1, block.r0);
+        const sgct_core::CorrectionMeshVertex & v01 = vertexAt(grid, block.c0, block.r1);
+        const sgct_core::CorrectionMeshVertex & v11 = vertexAt(grid, block.c1, block.r1);
+
+        double center[4], du[4], dv[4];
+        const float * c00 = &v00.x;
+        const float * c10 = &v10.x;
+        const float * c01 = &v01.x;
+        const float * c11 = &v11.x;
+        //x, y, s and t are the first four members
+        for (int i = 0; i < 4; i++)
+        {
+            center[i] = 0.25 * (static_cast<double>(c00[i]) + c10[i] + c01[i] + c11[i]);
+            du[i] = 0.5 * ((static_cast<double>(c10[i]) - c00[i]) + (static_cast<double>(c11[i]) - c01[i]));
+            dv[i] = 0.5 * ((static_cast<double>(c01[i]) - c00[i]) + (static_cast<double>(c11[i]) - c10[i]));
+        }
+
+        double columns = static_cast<double>(block.c1 - block.c0);
+        double rows = static_cast<double>(block.r1 - block.r0);
+        for (unsigned int r = block.r0; r <= block.r1; r++)
+        {
+            double v = static_cast<double>(r - block.r0) / rows - 0.5;
+            for (unsigned int c = block.c0; c <= block.c1; c++)
+            {
+                const sgct_core::CorrectionMeshVertex & vertex = vertexAt(grid, c, r);
+                if (!sameColor(vertex, v00))
+                    return false;
+
+                double u = static_cast<double>(c - block.c0) / columns - 0.5;
+                const float * values = &vertex.x;
+                for (int i = 0; i < 4; i++)
+                {
+                    double affine = center[i] + du[i] * u + dv[i] * v;
+                    if (fabs(values[i] - affine) * grid.mScale[i] > grid.mTolerance)
+                        return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    //! \returns the number of cells in the block that don't have both triangles
+    inline unsigned int countIncompleteCells(const std::vector<unsigned int> & table, unsigned int cellColumns, const Block & block)
+    {
+        std::size_t stride = cellColumns + 1;
+        return table[block.r1 * stride + block.c1] - table[block.r0 * stride + block.c1]
+            - table[block.r1 * stride + block.c0] + table[block.r0 * stride + block.c0];
+    }
+
+    inline unsigned int remapIndex(unsigned int index, const sgct_core::CorrectionMeshVertex * vertices,
+        std::vector<unsigned int> & remap, std::vector<sgct_core::CorrectionMeshVertex> & outVertices)
+    {
+        if (remap[index] == UNUSED_INDEX)
+        {
+            remap[index] = static_cast<unsigned int>(outVertices.size());
+            outVertices.push_back(vertices[index]);
+        }
+        return remap[index];
+    }
+
+    //! Triangles sorted into a uniform grid over their positions for point lookups
+    class TriangleBins
+    {
+    public:
+        TriangleBins(const sgct_core::CorrectionMeshVertex * vertices, unsigned int numberOfVertices,
+            const unsigned int * indices, unsigned int numberOfIndices)
+        {
+            mVertices = vertices;
+            mIndices = indices;
+            mBins = 0;
+            mMinX = mMinY = mMaxX = mMaxY = mBinWidth = mBinHeight = 0.0;
+
+            unsigned int numberOfTriangles = numberOfIndices / 3;
+            if (numberOfVertices == 0 || numberOfTriangles == 0)
+                return;
+
+            double maxX = -std::numeric_limits<double>::max();
+            double maxY = maxX;
+            mMinX = mMinY = std::numeric_limits<double>::max();
+            for (unsigned int i = 0; i < numberOfIndices; i++)
+            {
+                const sgct_core::CorrectionMeshVertex & v = vertices[indices[i]];
+                mMinX = std::min<double>(mMinX, v.x);
+                maxX = std::max<double>(maxX, v.x);
+                mMinY = std::min<double>(mMinY, v.y);
+                maxY = std::max<double>(maxY, v.y);
+            }
+
+            mBins = static_cast<std::size_t>(sqrt(static_cast<double>(numberOfTriangles)));
+            mBins = std::max<std::size_t>(std::min(mBins, MAX_BINS_PER_AXIS), 1);
+            mBinWidth = std::max(maxX - mMinX, 1e-9) / static_cast<double>(mBins);
+            mBinHeight = std::max(maxY - mMinY, 1e-9) / static_cast<double>(mBins);
+            mMaxX = maxX;
+            mMaxY = maxY;
+
+            mTriangles.resize(mBins * mBins);
+            for (unsigned int t = 0; t < numberOfTriangles; t++)
+            {
+                double x0 = std::numeric_limits<double>::max();
+                double x1 = -x0;
+                double y0 = x0;
+                double y1 = -x0;
+                for (unsigned int j = 0; j < 3; j++)
+                {
+                    const sgct_core::CorrectionMeshVertex & v = vertices[indices[t * 3 + j]];
+                    x0 = std::min<double>(x0, v.x);
+                    x1 = std::max<double>(x1, v.x);
+                    y0 = std::min<double>(y0, v.y);
+                    y1 = std::max<double>(y1, v.y);
+                }
+
+                for (std::size_t by = getBin(y0, mMinY, mBinHeight); by <= getBin(y1, mMinY, mBinHeight); by++)
+                    for (std::size_t bx = getBin(x0, mMinX, mBinWidth); bx <= getBin(x1, mMinX, mBinWidth); bx++)
+                        mTriangles[by * mBins + bx].push_back(t);
+            }
+        }
+
+        //! Interpolates the texture coordinates at a position, prefers the triangle the point is deepest inside since points on shared edges hit several
+        bool interpolate(double x, double y, double & s, double & t) const
+        {
+            const double edgeTolerance = 1e-6;
+            if (mBins == 0 || x < mMinX - edgeTolerance || x > mMaxX + edgeTolerance || y < mMinY - edgeTolerance || y > mMaxY + edgeTolerance)
+                return false;
+
+            const std::vector<unsigned int> & candidates = mTriangles[getBin(y, mMinY, mBinHeight) * mBins + getBin(x, mMinX, mBinWidth)];
+            double bestDepth = -edgeTolerance;
+            bool found = false;
+            for (std::size_t k = 0; k < candidates.size(); k++)
+            {
+                const sgct_core::CorrectionMeshVertex & a = mVertices[mIndices[candidates[k] * 3]];
+                const sgct_core::CorrectionMeshVertex & b = mVertices[mIndices[candidates[k] * 3 + 1]];
+                const sgct_core::CorrectionMeshVertex & c = mVertices[mIndices[candidates[k] * 3 + 2]];
+
+                double denom = (static_cast<double>(b.y) - c.y) * (static_cast<double>(a.x) - c.x) + (static_cast<double>(c.x) - b.x) * (static_cast<double>(a.y) - c.y);
+                if (denom == 0.0)
+                    continue;
+
+                double l0 = ((static_cast<double>(b.y) - c.y) * (x - c.x) + (static_cast<double>(c.x) - b.x) * (y - c.y)) / denom;
+                double l1 = ((static_cast<double>(c.y) - a.y) * (x - c.x) + (static_cast<double>(a.x) - c.x) * (y - c.y)) / denom;
+                double l2 = 1.0 - l0 - l1;
+                double depth = std::min(l0, std::min(l1, l2));
+                if (depth > bestDepth)
+                {
+                    bestDepth = depth;
+                    s = l0 * a.s + l1 * b.s + l2 * c.s;
+                    t = l0 * a.t + l1 * b.t + l2 * c.t;
+                    found = true;
+                }
+            }
+            return found;
+        }
+
+    private:
+        inline std::size_t getBin(double value, double minValue, double binSize) const
+        {
+            double bin = (value - minValue) / binSize;
+            return bin <= 0.0 ? 0 : std::min(static_cast<std::size_t>(bin), mBins - 1);
+        }
+
+        const sgct_core::CorrectionMeshVertex * mVertices;
+        const unsigned int * mIndices;
+        std::vector< std::vector<unsigned int> > mTriangles;
+        std::size_t mBins;
+        double mMinX, mMinY, mMaxX, mMaxY;
+        double mBinWidth, mBinHeight;
+    };
+
+    inline double pixelDistance(double ds, double dt, int width, int height)
+    {
+        ds *= static_cast<double>(width);
+        dt *= static_cast<double>(height);
+        return sqrt(ds * ds + dt * dt);
+    }
+}
+
+/*!
+Decimate a regular grid mesh.
+
+\param vertices the grid vertices in row major order
+\param columns the number of vertices per row
+\param rows the number of vertex rows
+\param indices triangle list where each cell (i0 lower left, counter clockwise) is split into (i0, i1, i2) and (i0, i2, i3), cells may be missing
+\param numberOfIndices the number of indices
+\param maxError the maximum error in pixels
+\param width the framebuffer width in pixels
+\param height the framebuffer height in pixels
+\param outVertices the used vertices
+\param outIndices the decimated triangle list
+\returns false if the triangles don't follow the grid layout
+*/
+bool sgct_core::CorrectionMeshDecimator::decimateGrid(const CorrectionMeshVertex * vertices, unsigned int columns, unsigned int rows,
+    const unsigned int * indices, unsigned int numberOfIndices, float maxError, int width, int height,
+    std::vector<CorrectionMeshVertex> & outVertices, std::vector<unsigned int> & outIndices)
+{
+    outVertices.clear();
+    outIndices.clear();
+    if (vertices == nullptr || indices == nullptr || columns < 2 || rows < 2 || numberOfIndices % 3 != 0 || width <= 0 || height <= 0)
+        return false;
+
+    unsigned int cellColumns = columns - 1;
+    unsigned int cellRows = rows - 1;
+    std::size_t numberOfVertices = static_cast<std::size_t>(columns) * rows;
+
+    //find the triangles of each cell
+    std::vector<unsigned char> cells(static_cast<std::size_t>(cellColumns) * cellRows, 0);
+    for (unsigned int i = 0; i < numberOfIndices; i += 3)
+    {
+        unsigned int i0 = indices[i];
+        if (i0 >= numberOfVertices)
+            return false;
+
+        unsigned int c = i0 % columns;
+        unsigned int r = i0 / columns;
+        if (c >= cellColumns || r >= cellRows)
+            return false;
+
+        unsigned char triangle = 0;
+        if (indices[i + 1] == i0 + 1 && indices[i + 2] == i0 + columns + 1)
+            triangle = FIRST_TRIANGLE;
+        else if (indices[i + 1] == i0 + columns + 1 && indices[i + 2] == i0 + columns)
+            triangle = SECOND_TRIANGLE;
+
+        unsigned char & cell = cells[static_cast<std::size_t>(r) * cellColumns + c];
+        if (triangle == 0 || (cell & triangle) != 0)
+            return false;
+        cell |= triangle;
+    }
+
+    //summed area table of incomplete cells
+    std::vector<unsigned int> incomplete(static_cast<std::size_t>(cellColumns + 1) * (cellRows + 1), 0);
+    for (unsigned int r = 0; r < cellRows; r++)
+        for (unsigned int c = 0; c < cellColumns; c++)
+            incomplete[(r + 1) * (cellColumns + 1) + c + 1] = (cells[static_cast<std::size_t>(r) * cellColumns + c] != FULL_CELL ? 1 : 0)
+                + incomplete[r * (cellColumns + 1) + c + 1] + incomplete[(r + 1) * (cellColumns + 1) + c] - incomplete[r * (cellColumns + 1) + c];
+
+    //the mesh border and the borders of holes are kept
+    std::vector<bool> used(numberOfVertices, false);
+    for (unsigned int r = 0; r < rows; r++)
+        for (unsigned int c = 0; c < columns; c++)
+        {
+            bool border = (c == 0 || r == 0 || c == cellColumns || r == cellRows);
+            for (unsigned int cr = (r > 0 ? r - 1 : 0); !border && cr <= r && cr < cellRows; cr++)
+                for (unsigned int cc = (c > 0 ? c - 1 : 0); !border && cc <= c && cc < cellColumns; cc++)
+                    border = cells[static_cast<std::size_t>(cr) * cellColumns + cc] != FULL_CELL;
+            used[static_cast<std::size_t>(r) * columns + c] = border;
+        }
+
+    GridInfo grid;
+    grid.mVertices = vertices;
+    grid.mColumns = columns;
+    grid.mScale[0] = 0.5 * static_cast<double>(width); //[-1, 1]
+    grid.mScale[1] = 0.5 * static_cast<double>(height);
+    grid.mScale[2] = static_cast<double>(width); //[0, 1]
+    grid.mScale[3] = static_cast<double>(height);
+    //a vertex of the decimated and of the original mesh can deviate in opposite directions
+    grid.mTolerance = 0.5 * static_cast<double>(maxError);
+
+    //split blocks until they are affine or single cells
+    std::vector<Block> blocks;
+    std::vector<Block> stack;
+    Block root = { 0, 0, cellColumns, cellRows };
+    stack.push_back(root);
+    while (!stack.empty())
+    {
+        Block block = stack.back();
+        stack.pop_back();
+
+        //merged blocks are at least two cells wide so that there is a vertex inside them
+        bool singleCell = (block.c1 - block.c0 == 1 && block.r1 - block.r0 == 1);
+        bool thin = (block.c1 - block.c0 == 1 || block.r1 - block.r0 == 1);
+        bool complete = countIncompleteCells(incomplete, cellColumns, block) == 0;
+        if (singleCell || (complete && !thin && isBlockAffine(grid, block)))
+        {
+            if (complete)
+            {
+                blocks.push_back(block);
+                used[static_cast<std::size_t>(block.r0) * columns + block.c0] = true;
+                used[static_cast<std::size_t>(block.r0) * columns + block.c1] = true;
+                used[static_cast<std::size_t>(block.r1) * columns + block.c0] = true;
+                used[static_cast<std::size_t>(block.r1) * columns + block.c1] = true;
+            }
+            continue;
+        }
+
+        unsigned int cm = block.c1 - block.c0 > 1 ? (block.c0 + block.c1) / 2 : block.c1;
+        unsigned int rm = block.r1 - block.r0 > 1 ? (block.r0 + block.r1) / 2 : block.r1;
+        Block parts[4] =
+        {
+            { block.c0, block.r0, cm, rm },
+            { cm, block.r0, block.c1, rm },
+            { block.c0, rm, cm, block.r1 },
+            { cm, rm, block.c1, block.r1 }
+        };
+        for (int i = 0; i < 4; i++)
+            if (parts[i].c0 < parts[i].c1 && parts[i].r0 < parts[i].r1)
+                stack.push_back(parts[i]);
+    }
+
+    std::vector<unsigned int> remap(numberOfVertices, UNUSED_INDEX);
+
+    //cells with a single triangle are copied
+    for (unsigned int i = 0; i < numberOfIndices; i += 3)
+    {
+        unsigned int i0 = indices[i];
+        if (cells[static_cast<std::size_t>(i0 / columns) * cellColumns + i0 % columns] != FULL_CELL)
+            for (unsigned int j = 0; j < 3; j++)
+                outIndices.push_back(remapIndex(indices[i + j], vertices, remap, outVertices));
+    }
+
+    //the used vertices along the block edges counter clockwise from the lower left corner, like the source cells
+    std::vector<unsigned int> perimeter;
+    std::vector<bool> corner;
+    for (std::size_t b = 0; b < blocks.size(); b++)
+    {
+        const Block & block = blocks[b];
+        perimeter.clear();
+        corner.clear();
+
+        for (unsigned int c = block.c0; c < block.c1; c++)
+        {
+            std::size_t index = static_cast<std::size_t>(block.r0) * columns + c;
+            if (used[index])
+            {
+                perimeter.push_back(static_cast<unsigned int>(index));
+                corner.push_back(c == block.c0);
+            }
+        }
+        for (unsigned int r = block.r0; r < block.r1; r++)
+        {
+            std::size_t index = static_cast<std::size_t>(r) * columns + block.c1;
+            if (used[index])
+            {
+                perimeter.push_back(static_cast<unsigned int>(index));
+                corner.push_back(r == block.r0);
+            }
+        }
+        for (unsigned int c = block.c1; c > block.c0; c--)
+        {
+            std::size_t index = static_cast<std::size_t>(block.r1) * columns + c;
+            if (used[index])
+            {
+                perimeter.push_back(static_cast<unsigned int>(index));
+                corner.push_back(c == block.c1);
+            }
+        }
+        for (unsigned int r = block.r1; r > block.r0; r--)
+        {
+            std::size_t index = static_cast<std::size_t>(r) * columns + block.c0;
+            if (used[index])
+            {
+                perimeter.push_back(static_cast<unsigned int>(index));
+                corner.push_back(r == block.r1);
+            }
+        }
+
+        //a fan from a corner covers the block if the neighbouring vertices are the adjacent corners,
+        //otherwise the fan starts from a vertex inside the block so that the vertices on all edges are connected
+        std::size_t n = perimeter.size();
+        std::size_t apex = n;
+        for (std::size_t i = 0; i < n && apex == n; i++)
+            if (corner[i] && corner[(i + n - 1) % n] && corner[(i + 1) % n])
+                apex = i;
+
+        if (apex < n)
+        {
+            for (std::size_t i = 1; i + 1 < n; i++)
+            {
+                outIndices.push_back(remapIndex(perimeter[apex], vertices, remap, outVertices));
+                outIndices.push_back(remapIndex(perimeter[(apex + i) % n], vertices, remap, outVertices));
+                outIndices.push_back(remapIndex(perimeter[(apex + i + 1) % n], vertices, remap, outVertices));
+            }
+        }
+        else
+        {
+            unsigned int center = ((block.r0 + block.r1) / 2) * columns + (block.c0 + block.c1) / 2;
+            for (std::size_t i = 0; i < n; i++)
+            {
+                outIndices.push_back(remapIndex(center, vertices, remap, outVertices));
+                outIndices.push_back(remapIndex(perimeter[i], vertices, remap, outVertices));
+                outIndices.push_back(remapIndex(perimeter[(i + 1) % n], vertices, remap, outVertices));
+            }
+        }
+    }
+
+    return true;
+}
+
+/*!
+Compares the texture coordinates of a decimated mesh with the original. The original is sampled at its vertices
+and triangle centers, the decimated mesh is interpolated at the same positions.
+
+\returns the error statistics in pixels of a framebuffer with the given size, samples outside the decimated mesh are counted as uncovered
+*/
+sgct_core::CorrectionMeshDecimator::ErrorReport sgct_core::CorrectionMeshDecimator::measureError(
+    const CorrectionMeshVertex * vertices, unsigned int numberOfVertices,
+    const unsigned int * indices, unsigned int numberOfIndices,
+    const CorrectionMeshVertex * decimatedVertices, unsigned int numberOfDecimatedVertices,
+    const unsigned int * decimatedIndices, unsigned int numberOfDecimatedIndices, int width, int height)
+{
+    ErrorReport report;
+    report.mSamples = 0;
+    report.mUncoveredSamples = 0;
+    report.mMaxError = 0.0;
+    report.mMeanError = 0.0;
+    report.mP99Error = 0.0;
+
+    TriangleBins bins(decimatedVertices, numberOfDecimatedVertices, decimatedIndices, numberOfDecimatedIndices);
+    std::vector<double> errors;
+    errors.reserve(numberOfVertices + numberOfIndices / 3);
+
+    std::vector<bool> sampled(numberOfVertices, false);
+    for (unsigned int i = 0; i + 2 < numberOfIndices; i += 3)
+    {
+        if (indices[i] >= numberOfVertices || indices[i + 1] >= numberOfVertices || indices[i + 2] >= numberOfVertices)
+            continue;
+
+        //the vertices once and the center of every triangle
+        double center[4] = { 0.0, 0.0, 0.0, 0.0 };
+        for (unsigned int j = 0; j < 4; j++)
+        {
+            double px, py, ps, pt;
+            if (j < 3)
+            {
+                const CorrectionMeshVertex & v = vertices[indices[i + j]];
+                center[0] += v.x / 3.0;
+                center[1] += v.y / 3.0;
+                center[2] += v.s / 3.0;
+                center[3] += v.t / 3.0;
+                if (sampled[indices[i + j]])
+                    continue;
+                sampled[indices[i + j]] = true;
+                px = v.x;
+                py = v.y;
+                ps = v.s;
+                pt = v.t;
+            }
+            else
+            {
+                px = center[0];
+                py = center[1];
+                ps = center[2];
+                pt = center[3];
+            }
+
+            report.mSamples++;
+            double s, t;
+            if (bins.interpolate(px, py, s, t))
+                errors.push_back(pixelDistance(s - ps, t - pt, width, height));
+            else
+                report.mUncoveredSamples++;
+        }
+    }
+
+    if (errors.empty())
+        return report;
+
+    double sum = 0.0;
+    for (std::size_t i = 0; i < errors.size(); i++)
+    {
+        sum += errors[i];
+        report.mMaxError = std::max(report.mMaxError, errors[i]);
+    }
+    report.mMeanError = sum / static_cast<double>(errors.size());
+
+    std::size_t p99 = std::min(errors.size() - 1, (errors.size() * 99) / 100);
+    std::nth_element(errors.begin(), errors.begin() + p99, errors.end());
+    report.mP99Error = errors[p99];
+
+    return report;
+}
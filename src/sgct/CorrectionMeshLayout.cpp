@@ -0,0 +1,198 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/CorrectionMeshLayout.h>
+#include <sgct/CorrectionMesh.h>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    const float MaxErrorInPixels = 0.25f;
+    //used if the framebuffer size isn't known
+    const int DefaultResolution = 4096;
+
+    /*
+        OpenGL before 4.2 decodes a normalized short c as (2c + 1) / 65535 and later versions as c / 32767. Values
+        are rounded for the later, the difference to the older decoding is at most 1 / 65535.
+    */
+    const float Snorm16Error = 0.5f / 32767.0f + 1.0f / 65535.0f;
+    const float Unorm16Error = 0.5f / 65535.0f;
+
+    inline short toSnorm16(float value)
+    {
+        return static_cast<short>(floorf(std::max(-1.0f, std::min(1.0f, value)) * 32767.0f + 0.5f));
+    }
+
+    inline unsigned short toUnorm16(float value)
+    {
+        return static_cast<unsigned short>(floorf(std::max(0.0f, std::min(1.0f, value)) * 65535.0f + 0.5f));
+    }
+
+    inline unsigned char toUnorm8(float value)
+    {
+        return static_cast<unsigned char>(floorf(std::max(0.0f, std::min(1.0f, value)) * 255.0f + 0.5f));
+    }
+
+    void writeAttribute(unsigned char * dst, sgct_core::CorrectionMeshLayout::AttributeFormat format, const float * values, unsigned int components)
+    {
+        for (unsigned int i = 0; i < components; i++)
+        {
+            switch (format)
+            {
+            case sgct_core::CorrectionMeshLayout::Float:
+                memcpy(dst + i * sizeof(float), &values[i], sizeof(float));
+                break;
+            case sgct_core::CorrectionMeshLayout::Snorm16:
+                {
+                    short s = toSnorm16(values[i]);
+                    memcpy(dst + i * sizeof(short), &s, sizeof(short));
+                }
+                break;
+            case sgct_core::CorrectionMeshLayout::Unorm16:
+                {
+                    unsigned short us = toUnorm16(values[i]);
+                    memcpy(dst + i * sizeof(unsigned short), &us, sizeof(unsigned short));
+                }
+                break;
+            case sgct_core::CorrectionMeshLayout::Unorm8:
+                dst[i] = toUnorm8(values[i]);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+sgct_core::CorrectionMeshLayout::CorrectionMeshLayout()
+{
+    mPositionFormat = Float;
+    mTexCoordFormat = Float;
+    mColorFormat = Float;
+    mPositionOffset = 0;
+    mTexCoordOffset = 8;
+    mColorOffset = 16;
+    mStride = sizeof(CorrectionMeshVertex);
+    mIndexSize = sizeof(unsigned int);
+}
+
+/*!
+Pick the smallest layout that represents the mesh within the error bound.
+
+\param vertices the mesh
+\param numberOfVertices the number of vertices in the mesh
+\param framebufferResolution the framebuffer size of the window, the unit of the error bound
+\param allowNormalizedCoordinates false for the fixed pipeline, which can't normalize positions and texture coordinates
+*/
+void sgct_core::CorrectionMeshLayout::choose(const CorrectionMeshVertex * vertices, unsigned int numberOfVertices,
+    const glm::ivec2 & framebufferResolution, bool allowNormalizedCoordinates)
+{
+    float minPosition = 0.0f;
+    float maxPosition = 0.0f;
+    float minTexCoord = 0.0f;
+    float maxTexCoord = 0.0f;
+    float minColor = 1.0f;
+    float maxColor = 1.0f;
+
+    for (unsigned int i = 0; i < numberOfVertices; i++)
+    {
+        const CorrectionMeshVertex & v = vertices[i];
+        minPosition = std::min(minPosition, std::min(v.x, v.y));
+        maxPosition = std::max(maxPosition, std::max(v.x, v.y));
+        minTexCoord = std::min(minTexCoord, std::min(v.s, v.t));
+        maxTexCoord = std::max(maxTexCoord, std::max(v.s, v.t));
+        minColor = std::min(minColor, std::min(std::min(v.r, v.g), std::min(v.b, v.a)));
+        maxColor = std::max(maxColor, std::max(std::max(v.r, v.g), std::max(v.b, v.a)));
+    }
+
+    float resolution = static_cast<float>(std::max(framebufferResolution.x, framebufferResolution.y));
+    if (resolution <= 0.0f)
+        resolution = static_cast<float>(DefaultResolution);
+
+    //positions span the framebuffer over [-1, 1] and texture coordinates over [0, 1]
+    mPositionFormat = allowNormalizedCoordinates && minPosition >= -1.0f && maxPosition <= 1.0f &&
+        Snorm16Error * 0.5f * resolution <= MaxErrorInPixels ? Snorm16 : Float;
+    mTexCoordFormat = allowNormalizedCoordinates && minTexCoord >= 0.0f && maxTexCoord <= 1.0f &&
+        Unorm16Error * resolution <= MaxErrorInPixels ? Unorm16 : Float;
+
+    //NaN fails both comparisons and keeps the float color
+    if (minColor == 1.0f && maxColor == 1.0f)
+        mColorFormat = NoAttribute;
+    else if (minColor >= 0.0f && maxColor <= 1.0f)
+        mColorFormat = Unorm8;
+    else
+        mColorFormat = Float;
+
+    mPositionOffset = 0;
+    mTexCoordOffset = mPositionOffset + getAttributeSize(mPositionFormat, 2);
+    mColorOffset = mTexCoordOffset + getAttributeSize(mTexCoordFormat, 2);
+    mStride = mColorOffset + getAttributeSize(mColorFormat, 4);
+    mIndexSize = numberOfVertices < 65536 ? sizeof(unsigned short) : sizeof(unsigned int);
+}
+
+/*!
+Write the vertices in this layout.
+*/
+void sgct_core::CorrectionMeshLayout::packVertices(const CorrectionMeshVertex * vertices, unsigned int numberOfVertices,
+    std::vector<unsigned char> & buffer) const
+{
+    buffer.assign(static_cast<std::size_t>(numberOfVertices) * mStride, 0);
+    for (unsigned int i = 0; i < numberOfVertices; i++)
+    {
+        const CorrectionMeshVertex & v = vertices[i];
+        unsigned char * dst = &buffer[static_cast<std::size_t>(i) * mStride];
+
+        const float position[] = { v.x, v.y };
+        const float texCoord[] = { v.s, v.t };
+        const float color[] = { v.r, v.g, v.b, v.a };
+        writeAttribute(dst + mPositionOffset, mPositionFormat, position, 2);
+        writeAttribute(dst + mTexCoordOffset, mTexCoordFormat, texCoord, 2);
+        writeAttribute(dst + mColorOffset, mColorFormat, color, 4);
+    }
+}
+
+/*!
+Write the indices in this layout.
+*/
+void sgct_core::CorrectionMeshLayout::packIndices(const unsigned int * indices, unsigned int numberOfIndices,
+    std::vector<unsigned char> & buffer) const
+{
+    buffer.resize(static_cast<std::size_t>(numberOfIndices) * mIndexSize);
+    if (mIndexSize == sizeof(unsigned int))
+    {
+        if (numberOfIndices > 0)
+            memcpy(buffer.data(), indices, buffer.size());
+        return;
+    }
+
+    for (unsigned int i = 0; i < numberOfIndices; i++)
+    {
+        unsigned short index = static_cast<unsigned short>(indices[i]);
+        memcpy(&buffer[static_cast<std::size_t>(i) * sizeof(unsigned short)], &index, sizeof(unsigned short));
+    }
+}
+
+/*!
+\returns the size in bytes of an attribute, the sizes are multiples of four to keep the attributes aligned
+*/
+unsigned int sgct_core::CorrectionMeshLayout::getAttributeSize(AttributeFormat format, unsigned int components)
+{
+    switch (format)
+    {
+    case Float:
+        return components * 4;
+    case Snorm16:
+    case Unorm16:
+        return components * 2;
+    case Unorm8:
+        return components;
+    default:
+        return 0;
+    }
+}
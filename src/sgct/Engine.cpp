@@ -18,6 +18,8 @@ For conditions of distribution and use, see copyright notice in sgct.h
     #include <sgct/FontManager.h>
 #endif
 #include <sgct/MessageHandler.h>
+#include <sgct/Tracer.h>
+#include <sgct/GPUTimer.h>
 #include <sgct/TextureManager.h>
 #include <sgct/SharedData.h>
 #include <sgct/shaders/SGCTInternalShaders.h>
@@ -26,6 +28,7 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #include <sgct/SGCTSettings.h>
 #include <sgct/ogl_headers.h>
 #include <sgct/ShaderManager.h>
+#include <sgct/StartupLoader.h>
 #include <sgct/helpers/SGCTStringFunctions.h>
 
 #include <glm/gtc/constants.hpp>
@@ -66,6 +69,10 @@ sgct_core::Touch sgct::Engine::mCurrentTouchPoints = sgct_core::Touch();
 void updateFrameLockLoop(void * arg);
 static bool sRunUpdateFrameLockLoop = true;
 
+//a simulated node has no GLFW, see --Simulate
+static bool sSimulationClock = false;
+static std::chrono::steady_clock::time_point sSimulationStart = std::chrono::steady_clock::now();
+
 #ifdef GLEW_MX
 GLEWContext * glewGetContext();
 #endif
@@ -74,6 +81,9 @@ GLEWContext * glewGetContext();
 #define MAX_SGCT_PATH_LENGTH 512
 #define FRAME_LOCK_TIMEOUT 100 //ms
 #define RUN_FRAME_LOCK_CHECK_THREAD 1
+#define METRICS_PUBLISH_INTERVAL 1.0 //s
+#define GPU_TIMER_FRAMES_IN_FLIGHT 4 //frames measured before the queries of the first one are read back
+#define SYNCHRONIZED_TIMER_ID_BASE (std::numeric_limits<std::size_t>::max() / 2)
 
 /*!
 This is the only valid constructor that also initiates [GLFW](http://www.glfw.org/). Command line parameters are used to load a configuration file and settings.
@@ -92,9 +102,28 @@ Parameter     | Description
 --Loose-Sync | disable firm frame sync
 --Ignore-Sync | disable frame sync
 -notify <integer> | set the notify level used in the MessageHandler (0 = highest priority)
+--Async-Log | write log messages from a background thread
+-trace <filename> | record a timeline of every frame and write it as a Chrome trace on exit
+-clockSyncDelay <ms> <ms> | delay the clock sync requests and replies of a slave to test the cluster clock
+-clockSyncJitter <ms> | add a random delay up to this to every clock sync message of a slave
+-statsLog <filename> | write frame, draw and sync time percentiles and dropped frames to a CSV file once a second
+-statsWindow <integer> | set the number of latest frames the statistics percentiles are calculated from
+-metricsPort <integer> | serve health metrics in the Prometheus format at http://127.0.0.1:<port + node index>/metrics
+--Simulate | run this node without windows or OpenGL, the draw is replaced by a sleep, to test the cluster sync
+-simDrawTime <ms> | set the simulated draw time of each frame
+-simFrames <integer> | exit after this many simulated frames
+-simStall <integer> <ms> | stall the simulated draw of every n:th frame by the given time
+-simLatency <ms> | delay every received sync message by the given latency
+-simBandwidth <Mbit/s> | delay every received sync message as if the link had the given bandwidth
+-record <filename> | record the sync stream of the master to a file for replay
+-replay <filename> | replay a recorded sync stream on a single node without windows (implies --Simulate)
+-replayStart <integer> | start the replay at this frame
+--Replay-Step | replay one frame at a time, controlled from the console
 --No-FBO | disable frame buffer objects (some stereo modes, Multi-Window rendering, FXAA and fisheye rendering will be disabled)
 --Capture-PNG | use png images for screen capture (default)
 --Capture-TGA | use tga images for screen capture
+--Capture-Y4M | stream screen capture into one y4m video file instead of numbered images
+-captureStream <target> | y4m stream target: file, named pipe, unix:<path> or tcp:<port> (implies --Capture-Y4M)
 -MSAA <integer> | Enable MSAA as default (argument must be a power of two)
 --FXAA | Enable FXAA as default
 --gDebugger | Force textures to be genareted using glTexImage2D instead of glTexStorage2D
@@ -111,6 +140,28 @@ sgct::Engine::Engine( int& argc, char**& argv )
     mStatistics = nullptr;
     mThisNode = nullptr;
     mThreadPtr = nullptr;
+    for(std::size_t i = 0; i < 3; i++)
+        mClockSyncTestDelays[i] = 0.0;
+    mSimulation = false;
+    mSimDrawTime = 0.0;
+    mSimFrames = 0;
+    mSimStallInterval = 0;
+    mSimStallDuration = 0.0;
+    mSimLatency = 0.0;
+    mSimBandwidth = 0.0;
+    mMetricsServer = nullptr;
+    mMetricsPort = 0;
+    mMetricsPublishTime = -METRICS_PUBLISH_INTERVAL;
+    mFrameRecorder = nullptr;
+    mFrameReplay = nullptr;
+    mReplayStartFrame = 0;
+    mReplayStep = false;
+    mReplayFrames = 0;
+    mReplayBytes = 0;
+    mReplayDecodeTime = 0.0;
+    mStatsWindow = STATS_HISTORY_LENGTH;
+    mStatsReportInterval = 1.0;
+    mCorrectionDataReloader = nullptr;
 
     //init function pointers
     mDrawFnPtr = SGCT_NULL_PTR;
@@ -122,6 +173,7 @@ sgct::Engine::Engine( int& argc, char**& argv )
     mPreWindowFnPtr = SGCT_NULL_PTR;
     mClearBufferFnPtr = SGCT_NULL_PTR;
     mCleanUpFnPtr = SGCT_NULL_PTR;
+    mStatsReportFnPtr = SGCT_NULL_PTR;
     mExternalDecodeCallbackFnPtr = SGCT_NULL_PTR;
     mExternalStatusCallbackFnPtr = SGCT_NULL_PTR;
     mDataTransferDecodeCallbackFnPtr = SGCT_NULL_PTR;
@@ -171,12 +223,14 @@ sgct::Engine::Engine( int& argc, char**& argv )
     mFrameCounter = 0;
     mShotCounter = 0;
     mTimerID = 0;
+    mSynchronizedTimerID = SYNCHRONIZED_TIMER_ID_BASE;
     mExitKey = GLFW_KEY_ESCAPE;
 
     //parse needs to be before read config since the path to the XML is parsed here
     parseArguments( argc, argv );
 
-    if(!mHelpMode)
+    //a simulated node has no windows and can run where GLFW can't be initiated
+    if(!mHelpMode && !mSimulation)
     {
         // Initialize GLFW
         glfwSetErrorCallback( internal_glfw_error_callback );
@@ -241,6 +295,13 @@ bool sgct::Engine::init(RunMode rm)
         return false;
     }
 
+    if( mSimulation )
+    {
+        initSimulation();
+        mInitialized = true;
+        return true;
+    }
+
     if( !initWindows() )
     {
         MessageHandler::instance()->print(MessageHandler::NOTIFY_ERROR, "Window init error. Application will close in 5 seconds.\n");
@@ -295,10 +356,14 @@ Initiates network communication.
 */
 bool sgct::Engine::initNetwork()
 {
+    //must exist before the connections can receive reload messages
+    mCorrectionDataReloader = new sgct_core::CorrectionDataReloader();
+
     try
     {
         mNetworkConnections = new sgct_core::NetworkManager(sgct_core::ClusterManager::instance()->getNetworkMode());
-
+        mNetworkConnections->setClockSyncTestDelays(mClockSyncTestDelays[0], mClockSyncTestDelays[1], mClockSyncTestDelays[2]);
+        mNetworkConnections->setSyncTestLink(mSimLatency, mSimBandwidth);
     }
     catch(const char * err)
     {
@@ -337,12 +402,83 @@ bool sgct::Engine::initNetwork()
         MessageHandler::instance()->setLogToFile(true);
     }
 
+    sgct_core::Tracer::instance()->setNode(sgct_core::ClusterManager::instance()->getThisNodeId(), mThisNode->getAddress());
+    if( !mTraceFilePath.empty() )
+        setTracing(true);
+
+    if( mMetricsPort > 0 )
+    {
+        //every node gets its own port so that a local cluster can be scraped too
+        mMetricsServer = new sgct_core::MetricsServer();
+        if( !mMetricsServer->start(mMetricsPort + sgct_core::ClusterManager::instance()->getThisNodeId()) )
+        {
+            delete mMetricsServer;
+            mMetricsServer = nullptr;
+        }
+    }
+
+    if( !mReplayPath.empty() )
+    {
+        //the recorded frames replace the ones of the master, so there must be no other nodes
+        if( sgct_core::ClusterManager::instance()->getNumberOfNodes() > 1 )
+        {
+            MessageHandler::instance()->print(MessageHandler::NOTIFY_ERROR, "A replay needs a configuration with a single node!\n");
+            mNetworkConnections->close();
+            return false;
+        }
+
+        mFrameReplay = new sgct_core::FrameReplay();
+        if( !mFrameReplay->open(mReplayPath) || (mReplayStartFrame > 0 && !mFrameReplay->seek(mReplayStartFrame)) )
+        {
+            mNetworkConnections->close();
+            return false;
+        }
+    }
+    else if( !mRecordPath.empty() && mNetworkConnections->isComputerServer() )
+    {
+        //before the connections are opened, since packages are recorded from the network threads
+        mFrameRecorder = new sgct_core::FrameRecorder();
+        if( !mFrameRecorder->open(mRecordPath) )
+        {
+            delete mFrameRecorder;
+            mFrameRecorder = nullptr;
+        }
+    }
+
     //Set message handler to send messages or not
     //MessageHandler::instance()->setSendFeedbackToServer( !mNetworkConnections->isComputerServer() );
 
+    //with a configuration snapshot only the master reads the whole configuration and sends it to the slaves
+    if( mConfig->isSnapshotPending() && mNetworkConnections->isComputerServer() )
+    {
+        std::vector<char> snapshot;
+        if( !mConfig->parseContents() || !mConfig->createSnapshot(snapshot) ||
+            !mNetworkConnections->setConfigurationSnapshot(snapshot) )
+        {
+            mNetworkConnections->close();
+            return false;
+        }
+    }
+
+    //the synchronized timers are sent in the sync frames, which can arrive as soon as the connections are up
+    SharedData::instance()->setInternalEncodeFunction(sgct_cppxeleven::bind(&sgct::Engine::encodeSynchronizedTimers, this));
+    SharedData::instance()->setInternalDecodeFunction(sgct_cppxeleven::bind(&sgct::Engine::decodeSynchronizedTimers, this));
+
     if(!mNetworkConnections->init())
         return false;
 
+    if( mConfig->isSnapshotPending() )
+    {
+        MessageHandler::instance()->print(MessageHandler::NOTIFY_INFO, "Waiting for configuration snapshot from master...\n");
+
+        std::vector<char> snapshot;
+        if( !mNetworkConnections->waitForConfigurationSnapshot(snapshot) || !mConfig->parseSnapshot(snapshot) )
+        {
+            MessageHandler::instance()->print(MessageHandler::NOTIFY_ERROR, "Failed to get the configuration from master!\n");
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -563,6 +699,7 @@ bool sgct::Engine::initWindows()
         mPreWindowFnPtr();
 
     mStatistics = new sgct_core::Statistics();
+    applyStatisticsSettings();
     GLFWwindow* share = nullptr;
     size_t lastWindowIdx = mThisNode->getNumberOfWindows()-1;
     for(std::size_t i=0; i < mThisNode->getNumberOfWindows(); i++)
@@ -586,6 +723,19 @@ bool sgct::Engine::initWindows()
     }
     MessageHandler::instance()->print(MessageHandler::NOTIFY_VERSION_INFO, "Using GLEW %s.\n", glewGetString(GLEW_VERSION));
 
+    //frames that take longer than one and a half refresh interval of the first window's display are counted as dropped
+    if( mThisNode->getNumberOfWindows() > 0 )
+    {
+        GLFWmonitor * monitor = mThisNode->getWindowPtr(0)->getMonitor();
+        if( monitor == nullptr )
+            monitor = glfwGetPrimaryMonitor();
+        const GLFWvidmode * mode = monitor != nullptr ? glfwGetVideoMode(monitor) : nullptr;
+        if( SGCTSettings::instance()->getRefreshRateHint() > 0 )
+            mStatistics->setRefreshRate( static_cast<double>(SGCTSettings::instance()->getRefreshRateHint()) );
+        else if( mode != nullptr )
+            mStatistics->setRefreshRate( static_cast<double>(mode->refreshRate) );
+    }
+
     if( !checkForOGLErrors() )
         MessageHandler::instance()->print(MessageHandler::NOTIFY_ERROR, "GLEW init triggered an OpenGL error.\n");
 
@@ -632,6 +782,30 @@ bool sgct::Engine::initWindows()
     return true;
 }
 
+/*!
+Initiates a simulated node, which has no windows or OpenGL. See renderSimulation.
+*/
+void sgct::Engine::initSimulation()
+{
+    MessageHandler::instance()->print(MessageHandler::NOTIFY_INFO, "Simulating node %d without windows, draw time %.2f ms.\n",
+        sgct_core::ClusterManager::instance()->getThisNodeId(), mSimDrawTime * 1000.0);
+
+    mStatistics = new sgct_core::Statistics();
+    applyStatisticsSettings();
+    if( SGCTSettings::instance()->getRefreshRateHint() > 0 )
+        mStatistics->setRefreshRate( static_cast<double>(SGCTSettings::instance()->getRefreshRateHint()) );
+
+    if( RUN_FRAME_LOCK_CHECK_THREAD )
+    {
+        if(sgct_core::ClusterManager::instance()->getNumberOfNodes() > 1)
+            mThreadPtr = new (std::nothrow) std::thread( updateFrameLockLoop, nullptr );
+    }
+
+    //if a single node, skip syncing
+    if(sgct_core::ClusterManager::instance()->getNumberOfNodes() == 1)
+        sgct_core::ClusterManager::instance()->setUseIgnoreSync(true);
+}
+
 /*!
 Initiates OpenGL.
 */
@@ -803,6 +977,17 @@ void sgct::Engine::initOGL()
     SGCTWindow::setBarrier(true);
     SGCTWindow::resetSwapGroupFrameNumber();
 
+    //decode masks and parse warping meshes in parallel, the uploads are done per context below
+    sgct_core::StartupLoader loader;
+    for (size_t i = 0; i < mThisNode->getNumberOfWindows(); i++)
+    {
+        SGCTWindow * winPtr = mThisNode->getWindowPtr(i);
+        for (size_t j = 0; j < winPtr->getNumberOfViewports(); j++)
+            loader.addViewport(winPtr->getViewport(j), i, j, winPtr->getAspectRatio(),
+                glm::ivec2(winPtr->getXFramebufferResolution(), winPtr->getYFramebufferResolution()));
+    }
+    loader.load(static_cast<std::size_t>(std::max(SGCTSettings::instance()->getNumberOfLoaderThreads(), 0)));
+
     for(size_t i=0; i < mThisNode->getNumberOfWindows(); i++)
     {
         mThisNode->setCurrentWindowIndex(i);
@@ -810,6 +995,15 @@ void sgct::Engine::initOGL()
         //generate mesh (VAO and VBO)
         getCurrentWindowPtr()->initContextSpecificOGL();
     }
+    loader.printReport();
+
+    for (size_t i = 0; i < mThisNode->getNumberOfWindows(); i++)
+    {
+        SGCTWindow * winPtr = mThisNode->getWindowPtr(i);
+        for (size_t j = 0; j < winPtr->getNumberOfViewports(); j++)
+            mCorrectionDataReloader->addViewport(winPtr->getViewport(j), winPtr);
+    }
+    mCorrectionDataReloader->setWatching(SGCTSettings::instance()->getWatchCorrectionData());
 
     //check for errors
     checkForOGLErrors();
@@ -826,7 +1020,7 @@ void sgct::Engine::clean()
 
     if (mCleanUpFnPtr != SGCT_NULL_PTR)
     {
-        if( mThisNode != nullptr && mThisNode->getNumberOfWindows() > 0 )
+        if( mThisNode != nullptr && mThisNode->getNumberOfWindows() > 0 && !mSimulation )
             mThisNode->getWindowPtr(0)->makeOpenGLContextCurrent( SGCTWindow::Shared_Context );
         mCleanUpFnPtr();
     }
@@ -834,6 +1028,10 @@ void sgct::Engine::clean()
     MessageHandler::instance()->print(MessageHandler::NOTIFY_INFO, "Clearing all callbacks...\n");
     clearAllCallbacks();
 
+    //wait for a warping mesh reload in progress, it uses the viewports
+    if (mCorrectionDataReloader != nullptr)
+        mCorrectionDataReloader->stop();
+
     //kill thread
     if( mThreadPtr )
     {
@@ -849,8 +1047,14 @@ void sgct::Engine::clean()
         MessageHandler::instance()->print(MessageHandler::NOTIFY_DEBUG, "Done.\n");
     }
 
+    //the master collects the slave traces, so it must write its trace before the connections are closed
+    if( !mTraceFilePath.empty() && mThisNode != nullptr )
+    {
+        exportTrace(getNodeFilePath(mTraceFilePath));
+    }
+
     //de-init window and unbind swapgroups...
-    if(sgct_core::ClusterManager::instance()->getNumberOfNodes() > 0)
+    if(sgct_core::ClusterManager::instance()->getNumberOfNodes() > 0 && !mSimulation)
     {
         if(mThisNode != nullptr)
             for(std::size_t i=0; i<mThisNode->getNumberOfWindows(); i++)
@@ -859,6 +1063,12 @@ void sgct::Engine::clean()
             }
     }
 
+    if( mMetricsServer != nullptr )
+    {
+        delete mMetricsServer;
+        mMetricsServer = nullptr;
+    }
+
     //close TCP connections
     if( mNetworkConnections != nullptr )
     {
@@ -866,6 +1076,28 @@ void sgct::Engine::clean()
         mNetworkConnections = nullptr;
     }
 
+    //the connections record packages until they are closed
+    if( mFrameRecorder != nullptr )
+    {
+        delete mFrameRecorder;
+        mFrameRecorder = nullptr;
+    }
+
+    if( mFrameReplay != nullptr )
+    {
+        delete mFrameReplay;
+        mFrameReplay = nullptr;
+    }
+
+    if (mCorrectionDataReloader != nullptr)
+    {
+        delete mCorrectionDataReloader;
+        mCorrectionDataReloader = nullptr;
+    }
+
+    sgct_core::GPUTimer::destroy();
+    sgct_core::Tracer::destroy();
+
     if( mConfig != nullptr )
     {
         delete mConfig;
@@ -874,7 +1106,7 @@ void sgct::Engine::clean()
 
     // Destroy explicitly to avoid memory leak messages
     //Shared contex -------------------------------------------------------------------------------->
-    if( mThisNode != nullptr && mThisNode->getNumberOfWindows() > 0 )
+    if( mThisNode != nullptr && mThisNode->getNumberOfWindows() > 0 && !mSimulation )
         mThisNode->getWindowPtr(0)->makeOpenGLContextCurrent( SGCTWindow::Shared_Context );
     if( mStatistics != nullptr )
     {
@@ -897,7 +1129,7 @@ void sgct::Engine::clean()
 #endif
 
     //Window specific context ------------------------------------------------------------------->
-    if( mThisNode != nullptr && mThisNode->getNumberOfWindows() > 0 )
+    if( mThisNode != nullptr && mThisNode->getNumberOfWindows() > 0 && !mSimulation )
         mThisNode->getWindowPtr(0)->makeOpenGLContextCurrent( SGCTWindow::Window_Context );
     
     MessageHandler::instance()->print(MessageHandler::NOTIFY_INFO, "Destroying shared data...\n");
@@ -935,6 +1167,7 @@ void sgct::Engine::clearAllCallbacks()
     mPreWindowFnPtr = SGCT_NULL_PTR;
     mClearBufferFnPtr = SGCT_NULL_PTR;
     mCleanUpFnPtr = SGCT_NULL_PTR;
+    mStatsReportFnPtr = SGCT_NULL_PTR;
     mExternalDecodeCallbackFnPtr = SGCT_NULL_PTR;
     mExternalStatusCallbackFnPtr = SGCT_NULL_PTR;
     mDataTransferDecodeCallbackFnPtr = SGCT_NULL_PTR;
@@ -959,10 +1192,12 @@ void sgct::Engine::clearAllCallbacks()
     gDropCallbackFnPtr = SGCT_NULL_PTR;
     gTouchCallbackFnPtr = SGCT_NULL_PTR;
 
-    for(sgct::Engine::TimerInformation & timer : mTimers)
-    {
-        timer.mCallback = nullptr;
-    }
+    mTimers.clear();
+    mSynchronizedTimers.clear();
+    mClusterClockTimers.clear();
+    mFiredTimers.clear();
+    std::lock_guard<std::mutex> lock(mTimerMutex);
+    mPendingTimers.clear();
 }
 
 /*!
@@ -975,16 +1210,18 @@ Sync time from statistics is the time each computer waits for sync.
 */
 bool sgct::Engine::frameLock(sgct::Engine::SyncStage stage)
 {
+    sgct_core::TraceZone zone(stage == PreStage ? "Sync" : "Frame lock");
+
     if( stage == PreStage )
     {
-        double t0 = glfwGetTime();
+        double t0 = getTime();
         mNetworkConnections->sync(sgct_core::NetworkManager::SendDataToClients, mStatistics); //from server to clients
-        mStatistics->setSyncTime( static_cast<float>(glfwGetTime() - t0) );
+        mStatistics->setSyncTime( static_cast<float>(getTime() - t0) );
 
         //run only on clients/slaves
         if (!sgct_core::ClusterManager::instance()->getIgnoreSync() && !mNetworkConnections->isComputerServer()) //not server
         {
-            t0 = glfwGetTime();
+            t0 = getTime();
             while(mNetworkConnections->isRunning() && mRunning)
             {
                 if( mNetworkConnections->isSyncComplete() )
@@ -1003,7 +1240,7 @@ bool sgct::Engine::frameLock(sgct::Engine::SyncStage stage)
                 
                 //for debuging
                 sgct_core::SGCTNetwork * conn;
-                if( glfwGetTime() - t0 > 1.0 ) //more than a second
+                if( getTime() - t0 > 1.0 ) //more than a second
                 {
                     conn = mNetworkConnections->getSyncConnectionByIndex(0);
                     if( !conn->isUpdated() )
@@ -1020,7 +1257,7 @@ bool sgct::Engine::frameLock(sgct::Engine::SyncStage stage)
                             mFrameCounter);
                     }
                     
-                    if( glfwGetTime() - t0 > 60.0 ) //more than a minute
+                    if( getTime() - t0 > 60.0 ) //more than a minute
                     {
                         MessageHandler::instance()->print(MessageHandler::NOTIFY_ERROR, "Slave: no sync signal from master after 60 seconds! Exiting...");
                         
@@ -1032,11 +1269,15 @@ bool sgct::Engine::frameLock(sgct::Engine::SyncStage stage)
             /*
                 A this point all data needed for rendering a frame is received.
                 Let's signal that back to the master/server.
+                The timers are taken first, with frame lock the master can't send the next sync frame before the acknowledgement.
             */
+            takeSynchronizedTimers();
             mNetworkConnections->sync(sgct_core::NetworkManager::AcknowledgeData, mStatistics);
 
-            mStatistics->addSyncTime(static_cast<float>(glfwGetTime() - t0));
+            mStatistics->addSyncTime(static_cast<float>(getTime() - t0));
         }//end if client
+        else
+            takeSynchronizedTimers();
     }
     else //post stage
     {
@@ -1045,7 +1286,7 @@ bool sgct::Engine::frameLock(sgct::Engine::SyncStage stage)
             /*localRunningMode == NetworkManager::Remote &&*/
             //!getCurrentWindowPtr()->isBarrierActive() )//post stage
         {
-            double t0 = glfwGetTime();
+            double t0 = getTime();
             while(mNetworkConnections->isRunning() &&
                 mRunning &&
                 mNetworkConnections->getActiveConnectionsCount() > 0)
@@ -1067,7 +1308,7 @@ bool sgct::Engine::frameLock(sgct::Engine::SyncStage stage)
 
                 //for debuging
                 sgct_core::SGCTNetwork * conn;
-                if( glfwGetTime() - t0 > 1.0 ) //more than a second
+                if( getTime() - t0 > 1.0 ) //more than a second
                 {
                     for(unsigned int i=0; i<mNetworkConnections->getSyncConnectionsCount(); i++)
                     {
@@ -1088,7 +1329,7 @@ bool sgct::Engine::frameLock(sgct::Engine::SyncStage stage)
                         }
                     }
                     
-                    if( glfwGetTime() - t0 > 60.0 ) //more than a minute
+                    if( getTime() - t0 > 60.0 ) //more than a minute
                     {
                         MessageHandler::instance()->print(MessageHandler::NOTIFY_ERROR, "Master: no sync signal from all slaves after 60 seconds! Exiting...");
                         
@@ -1096,7 +1337,7 @@ bool sgct::Engine::frameLock(sgct::Engine::SyncStage stage)
                     }
                 }
             }//end while
-            mStatistics->addSyncTime(static_cast<float>(glfwGetTime() - t0));
+            mStatistics->addSyncTime(static_cast<float>(getTime() - t0));
         }//end if server
     }
     
@@ -1117,16 +1358,19 @@ void sgct::Engine::render()
     
     mRunning = GL_TRUE;
 
-    //create openGL query objects for opengl 3.3+
-    GLuint time_queries[2];
-    if (!mFixedOGLPipeline)
+    if( mSimulation )
     {
-        getCurrentWindowPtr()->makeOpenGLContextCurrent(SGCTWindow::Shared_Context);
-        glGenQueries(2, time_queries);
+        renderSimulation();
+        return;
     }
 
+    //the GPU times are read back a few frames later so that the render loop never waits for the queries
+    getCurrentWindowPtr()->makeOpenGLContextCurrent(SGCTWindow::Shared_Context);
+    sgct_core::GPUTimer::instance()->init(GPU_TIMER_FRAMES_IN_FLIGHT);
+
     while( mRunning )
     {
+        sgct_core::TraceZone frameZone("Frame", static_cast<int>(mFrameCounter));
         mRenderingOffScreen = false;
 
 #ifdef __SGCT_RENDER_LOOP_DEBUG__
@@ -1141,14 +1385,25 @@ void sgct::Engine::render()
         MessageHandler::instance()->print(MessageHandler::NOTIFY_INFO, "Render-Loop: Running pre-sync.\n");
 #endif
         if (mPreSyncFnPtr != SGCT_NULL_PTR)
+        {
+            sgct_core::TraceZone zone("Pre sync");
             mPreSyncFnPtr();
+        }
 
         if( mNetworkConnections->isComputerServer() )
         {
 #ifdef __SGCT_RENDER_LOOP_DEBUG__
             MessageHandler::instance()->print(MessageHandler::NOTIFY_INFO, "Render-Loop: Encoding data.\n");
 #endif
+            sgct_core::TraceZone zone("Encode");
             SharedData::instance()->encode();
+
+            if( mFrameRecorder != nullptr )
+            {
+                std::size_t size;
+                const unsigned char * data = SharedData::instance()->getEncodedData(size);
+                mFrameRecorder->recordSyncFrame(mFrameCounter, getTime(), data, size);
+            }
         }
         else
         {
@@ -1180,20 +1435,28 @@ void sgct::Engine::render()
 
         if(buffersNeedUpdate)
             updateDrawBufferResolutions();
+
+        //switch to reloaded warping meshes and masks on the frame agreed on by the cluster
+        mCorrectionDataReloader->update(mNetworkConnections);
     
         mRenderingOffScreen = SGCTSettings::instance()->useFBO();
         if( mRenderingOffScreen )
             getCurrentWindowPtr()->makeOpenGLContextCurrent( SGCTWindow::Shared_Context );
 
+        //streamed, reloaded and evicted textures
+        TextureManager::instance()->update();
+
         //Make sure correct context is current
         if (mPostSyncPreDrawFnPtr != SGCT_NULL_PTR)
+        {
+            sgct_core::TraceZone zone("Post sync pre draw");
             mPostSyncPreDrawFnPtr();
+        }
 
         double startFrameTime = glfwGetTime();
         calculateFPS(startFrameTime); //measures time between calls
 
-        if (!mFixedOGLPipeline && mShowGraph)
-            glQueryCounter(time_queries[0], GL_TIMESTAMP);
+        sgct_core::GPUTimer::instance()->beginFrame();
 
         //--------------------------------------------------------------
         //     RENDER VIEWPORTS / DRAW
@@ -1204,6 +1467,8 @@ void sgct::Engine::render()
         for(size_t i=0; i < mThisNode->getNumberOfWindows(); i++)
         if (mThisNode->getWindowPtr(i)->isVisible() || mThisNode->getWindowPtr(i)->isRenderingWhileHidden())
         {
+            sgct_core::TraceZone windowZone("Draw window", static_cast<int>(i));
+
             //store the first buffer index for each window
             firstDrawBufferIndexInWindow = mCurrentDrawBufferIndex;
             
@@ -1344,7 +1609,10 @@ void sgct::Engine::render()
 
                 mRenderingOffScreen = false;
                 if( SGCTSettings::instance()->useFBO() )
+                {
+                    sgct_core::TraceZone zone("Render to screen", static_cast<int>(i));
                     (this->*mInternalRenderFBOFn)();
+                }
             }
 
 #ifdef __SGCT_RENDER_LOOP_DEBUG__
@@ -1370,49 +1638,22 @@ void sgct::Engine::render()
         MessageHandler::instance()->print(MessageHandler::NOTIFY_INFO, "Render-Loop: swap and update data\n");
 #endif
         
-        if (!mFixedOGLPipeline && mShowGraph)
-            glQueryCounter(time_queries[1], GL_TIMESTAMP);
+        sgct_core::GPUTimer::instance()->endFrame();
 
         double endFrameTime = glfwGetTime();
         updateTimers( endFrameTime );
 
         //run post frame actions
         if (mPostDrawFnPtr != SGCT_NULL_PTR)
-            mPostDrawFnPtr();
-
-        //update stats
-        if (mFixedOGLPipeline)
-            mStatistics->setDrawTime(static_cast<float>(endFrameTime - startFrameTime));
-        else
         {
-            if (mShowGraph) {
-                //double t = glfwGetTime();
-                //int counter = 0;
-
-                // wait until the query results are available
-                GLint done = GL_FALSE;
-                while (!done)
-                {
-                    glGetQueryObjectiv(time_queries[1],
-                        GL_QUERY_RESULT_AVAILABLE,
-                        &done);
-
-                    //counter++;
-                }
-
-                //fprintf(stderr, "Wait: %d %lf\n", counter, (glfwGetTime() - t) * 1000.0);
-
-                GLuint64 timerStart;
-                GLuint64 timerEnd;
-                // get the query results
-                glGetQueryObjectui64v(time_queries[0], GL_QUERY_RESULT, &timerStart);
-                glGetQueryObjectui64v(time_queries[1], GL_QUERY_RESULT, &timerEnd);
-
-                double elapsedTime = static_cast<double>(timerEnd - timerStart) / 1000000000.0;
-                mStatistics->setDrawTime(static_cast<float>(elapsedTime));
-            }
+            sgct_core::TraceZone zone("Post draw");
+            mPostDrawFnPtr();
         }
 
+        //update stats, the GPU time is from a few frames back and the CPU time is used until there is one
+        double gpuFrameTime = sgct_core::GPUTimer::instance()->getFrameTime();
+        mStatistics->setDrawTime(static_cast<float>(gpuFrameTime >= 0.0 ? gpuFrameTime : endFrameTime - startFrameTime));
+
         if (mShowGraph)
         {
 #ifdef __SGCT_RENDER_LOOP_DEBUG__
@@ -1420,6 +1661,8 @@ void sgct::Engine::render()
 #endif
             mStatistics->update();
         }
+        mStatistics->updateReport(endFrameTime);
+        publishMetrics(endFrameTime);
         
 #ifdef __SGCT_RENDER_LOOP_DEBUG__
         MessageHandler::instance()->print(MessageHandler::NOTIFY_INFO, "Render-Loop: lock\n");
@@ -1457,10 +1700,181 @@ void sgct::Engine::render()
 #endif
     }
 
-    if (!mFixedOGLPipeline)
+    getCurrentWindowPtr()->makeOpenGLContextCurrent(SGCTWindow::Shared_Context);
+    sgct_core::GPUTimer::instance()->deinit();
+}
+
+/*!
+    The render loop of a simulated node, see --Simulate. The synchronization is the same as in render(), including
+    the shared data, frame lock and statistics, but the drawing is replaced by a sleep for the simulated draw time.
+    With -replay the frames are decoded from the recording instead of encoded, see replayFrame.
+*/
+void sgct::Engine::renderSimulation()
+{
+    while( mRunning )
     {
-        getCurrentWindowPtr()->makeOpenGLContextCurrent(SGCTWindow::Shared_Context);
-        glDeleteQueries(2, time_queries);
+        sgct_core::TraceZone frameZone("Frame", static_cast<int>(mFrameCounter));
+
+        //the recorded frame replaces what the pre sync and encode of the master would have produced
+        if( mFrameReplay != nullptr )
+        {
+            sgct_core::TraceZone zone("Replay");
+            if( !replayFrame() )
+                break;
+        }
+        else
+        {
+            if (mPreSyncFnPtr != SGCT_NULL_PTR)
+            {
+                sgct_core::TraceZone zone("Pre sync");
+                mPreSyncFnPtr();
+            }
+
+            if( mNetworkConnections->isComputerServer() )
+            {
+                sgct_core::TraceZone zone("Encode");
+                SharedData::instance()->encode();
+
+                if( mFrameRecorder != nullptr )
+                {
+                    std::size_t size;
+                    const unsigned char * data = SharedData::instance()->getEncodedData(size);
+                    mFrameRecorder->recordSyncFrame(mFrameCounter, getTime(), data, size);
+                }
+            }
+            else if( !mNetworkConnections->isRunning() ) //exit if not running
+            {
+                MessageHandler::instance()->print(MessageHandler::NOTIFY_ERROR, "Network disconnected! Exiting...\n");
+                break;
+            }
+        }
+
+        if( !frameLock(PreStage) )
+            break;
+
+        if (mPostSyncPreDrawFnPtr != SGCT_NULL_PTR)
+        {
+            sgct_core::TraceZone zone("Post sync pre draw");
+            mPostSyncPreDrawFnPtr();
+        }
+
+        double startFrameTime = getTime();
+        calculateFPS(startFrameTime); //measures time between calls
+
+        double drawTime = mSimDrawTime;
+        if( mSimStallInterval > 0 && mFrameCounter > 0 && mFrameCounter % mSimStallInterval == 0 )
+            drawTime += mSimStallDuration;
+        if( drawTime > 0.0 )
+        {
+            sgct_core::TraceZone zone("Simulated draw");
+            std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(drawTime * 1e6)));
+        }
+
+        double endFrameTime = getTime();
+        updateTimers( endFrameTime );
+
+        if (mPostDrawFnPtr != SGCT_NULL_PTR)
+        {
+            sgct_core::TraceZone zone("Post draw");
+            mPostDrawFnPtr();
+        }
+
+        mStatistics->setDrawTime(static_cast<float>(endFrameTime - startFrameTime));
+        mStatistics->updateReport(endFrameTime);
+        publishMetrics(endFrameTime);
+
+        //master will wait for nodes render before swapping
+        if( !frameLock(PostStage) )
+            break;
+
+        mFrameCounter++;
+        mRunning = !(mTerminate ||
+            !mNetworkConnections->isRunning() ||
+            (mSimFrames > 0 && mFrameCounter >= mSimFrames));
+    }
+
+    if( mFrameReplay != nullptr && mReplayFrames > 0 )
+    {
+        //the decode time includes the decode callback of the application, so this benchmarks it too
+        double mb = static_cast<double>(mReplayBytes) / (1024.0 * 1024.0);
+        MessageHandler::instance()->print(MessageHandler::NOTIFY_INFO,
+            "Replay: Decoded %llu frames (%.2f MB) in %.3f s, %.0f frames/s, %.2f MB/s.\n",
+            mReplayFrames, mb, mReplayDecodeTime,
+            mReplayDecodeTime > 0.0 ? static_cast<double>(mReplayFrames) / mReplayDecodeTime : 0.0,
+            mReplayDecodeTime > 0.0 ? mb / mReplayDecodeTime : 0.0);
+    }
+}
+
+/*!
+    Decode the next frame of the replay. The external control and data transfer packages that were received before
+    the frame are passed to their callbacks first, on the render thread instead of the network threads.
+
+    \returns false at the end of the recording or if the user quits a stepped replay
+*/
+bool sgct::Engine::replayFrame()
+{
+    if( mReplayStep && !readReplayCommand() )
+        return false;
+
+    sgct_core::FrameRecord record;
+    while( mFrameReplay->next(record) )
+    {
+        if( record.mType == sgct_core::FrameRecord::ExternalControl )
+        {
+            invokeDecodeCallbackForExternalControl(reinterpret_cast<const char *>(record.mData),
+                static_cast<int>(record.mSize), record.mClientId);
+        }
+        else if( record.mType == sgct_core::FrameRecord::DataTransfer )
+        {
+            invokeDecodeCallbackForDataTransfer(record.mData, static_cast<int>(record.mSize),
+                record.mPackageId, record.mClientId);
+        }
+        else
+        {
+            double start = getTime();
+            SharedData::instance()->decode(reinterpret_cast<const char *>(record.mData), static_cast<int>(record.mSize), 0);
+            mReplayDecodeTime += getTime() - start;
+            mReplayFrames++;
+            mReplayBytes += record.mSize;
+
+            if( mReplayStep )
+                MessageHandler::instance()->print(MessageHandler::NOTIFY_INFO, "Replay: Frame %u, recorded at %.3f s, %u bytes.\n",
+                    record.mFrame, record.mTime, static_cast<unsigned int>(record.mSize));
+            return true;
+        }
+    }
+
+    MessageHandler::instance()->print(MessageHandler::NOTIFY_INFO, "Replay: End of the recording.\n");
+    return false;
+}
+
+/*!
+    Wait for a command from the console during a stepped replay, see --Replay-Step.
+
+    \returns false if the replay should end
+*/
+bool sgct::Engine::readReplayCommand()
+{
+    while( true )
+    {
+        MessageHandler::instance()->print(MessageHandler::NOTIFY_INFO,
+            "Replay: Press enter for the next frame, type a frame number to seek to it or q to quit.\n");
+
+        std::string line;
+        if( !std::getline(std::cin, line) || line == "q" )
+            return false;
+        if( line.empty() )
+            return true;
+
+        unsigned int frame;
+        std::stringstream ss( line );
+        if( ss >> frame )
+        {
+            if( mFrameReplay->seek(frame) )
+                return true;
+        }
+        else
+            MessageHandler::instance()->print(MessageHandler::NOTIFY_WARNING, "Replay: Unknown command '%s'.\n", line.c_str());
     }
 }
 
@@ -1535,13 +1949,16 @@ void sgct::Engine::renderDisplayInfo()
         }
         else
         {
+            sgct_core::ClockSync::Quality clockQuality = mNetworkConnections->getClockSyncQuality();
             sgct_text::print(font,
                 sgct_text::TOP_LEFT,
                 xPos,
                 lineHeight * 3.0f + yPos,
                 glm::vec4(0.0f,0.8f,0.8f,1.0f),
-                "Avg. sync time: %.2f ms",
-                mStatistics->getAvgSyncTime()*1000.0);
+                "Avg. sync time: %.2f ms, clock offset: %.3f ms (+/- %.3f ms)",
+                mStatistics->getAvgSyncTime()*1000.0,
+                clockQuality.mOffset*1000.0,
+                clockQuality.mErrorBound*1000.0);
         }
 
         bool usingSwapGroups = getCurrentWindowPtr()->isUsingSwapGroups();
@@ -1828,6 +2245,7 @@ void sgct::Engine::renderFBOTexture()
 
     SGCTWindow * win = getCurrentWindowPtr();
     win->makeOpenGLContextCurrent( SGCTWindow::Window_Context );
+    sgct_core::GPUTraceZone gpuZone("Warp and blend", static_cast<int>(mThisNode->getCurrentWindowIndex()));
 
     glDisable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); //needed for shaders
@@ -1873,7 +2291,7 @@ void sgct::Engine::renderFBOTexture()
         maskShaderSet = true;
 
         for (std::size_t i = 0; i < numberOfIterations; i++)
-            win->getViewport(i)->renderMesh( mt );
+            renderViewportMesh(win->getViewport(i), mt);
 
         //render right eye in active stereo mode
         if( win->getStereoMode() == SGCTWindow::Active_Stereo )
@@ -1886,7 +2304,7 @@ void sgct::Engine::renderFBOTexture()
 
             glBindTexture(GL_TEXTURE_2D, win->getFrameBufferTexture(RightEye));
             for(std::size_t i=0; i<numberOfIterations; i++)
-                win->getViewport(i)->renderMesh( mt );
+                renderViewportMesh(win->getViewport(i), mt);
         }
     }
 
@@ -1947,6 +2365,29 @@ void sgct::Engine::renderFBOTexture()
     glDisable(GL_BLEND);
 }
 
+/*!
+    Render the warp mesh of a viewport in renderFBOTexture, or its warp lookup texture if it has one. The
+    FBOQuadShader must be bound and the framebuffer texture bound to texture unit 0.
+*/
+void sgct::Engine::renderViewportMesh(sgct_core::Viewport * vpPtr, sgct_core::CorrectionMesh::MeshType mt)
+{
+    if (mt != sgct_core::CorrectionMesh::WARP_MESH || !vpPtr->hasWarpLookupTexture() || !vpPtr->isEnabled())
+    {
+        vpPtr->renderMesh(mt);
+        return;
+    }
+
+    //draw the unwarped quad and look up the warped texture coordinate of each pixel
+    mShaders[WarpLookupShader].bind();
+    glUniform4f(mShaderLocs[WarpLookupRect], vpPtr->getX(), vpPtr->getY(), vpPtr->getXSize(), vpPtr->getYSize());
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, vpPtr->getWarpLookupTextureIndex());
+    glActiveTexture(GL_TEXTURE0);
+
+    vpPtr->renderMesh(sgct_core::CorrectionMesh::QUAD_MESH);
+
+    mShaders[FBOQuadShader].bind();
+}
 
 /*!
     Draw geometry and bind FBO as texture in screenspace (ortho mode).
@@ -1959,6 +2400,7 @@ void sgct::Engine::renderFBOTextureFixedPipeline()
     
     SGCTWindow * win = getCurrentWindowPtr();
     win->makeOpenGLContextCurrent( SGCTWindow::Window_Context );
+    sgct_core::GPUTraceZone gpuZone("Warp and blend", static_cast<int>(mThisNode->getCurrentWindowIndex()));
     
     //clear buffers
     mCurrentFrustumMode = win->getStereoMode() == SGCTWindow::Active_Stereo ? sgct_core::Frustum::StereoLeftEye : sgct_core::Frustum::MonoEye;
@@ -2112,6 +2554,9 @@ void sgct::Engine::renderViewports(TextureIndexes ti)
 
         if( vp->isEnabled() )
         {
+            sgct_core::TraceZone zone("Draw viewport", static_cast<int>(i));
+            sgct_core::GPUTraceZone gpuZone("Draw viewport", static_cast<int>(i));
+
             //if passive stereo or mono
             if( sm == SGCTWindow::No_Stereo )
                 mCurrentFrustumMode = vp->getEye();
@@ -2165,7 +2610,11 @@ void sgct::Engine::renderViewports(TextureIndexes ti)
             //blit buffers
             updateRenderingTargets(ti); //only used if multisampled FBOs
 
-            (this->*mInternalRenderPostFXFn)(ti);
+            {
+                sgct_core::TraceZone zone("Post FX");
+                sgct_core::GPUTraceZone gpuZone("Post FX");
+                (this->*mInternalRenderPostFXFn)(ti);
+            }
 
             render2D();
             if(split_screen_stereo)
@@ -2272,6 +2721,8 @@ void sgct::Engine::renderPostFX(TextureIndexes finalTargetIndex)
     }
     if( getCurrentWindowPtr()->useFXAA() )
     {
+        sgct_core::GPUTraceZone gpuZone("FXAA");
+
         //bind target FBO
         getCurrentWindowPtr()->mFinalFBO_Ptr->attachColorTexture( getCurrentWindowPtr()->getFrameBufferTexture( finalTargetIndex ) );
 
@@ -2351,6 +2802,8 @@ void sgct::Engine::renderPostFXFixedPipeline(TextureIndexes finalTargetIndex)
 
     if( getCurrentWindowPtr()->useFXAA() )
     {
+        sgct_core::GPUTraceZone gpuZone("FXAA");
+
         //bind target FBO
         getCurrentWindowPtr()->mFinalFBO_Ptr->attachColorTexture( getCurrentWindowPtr()->getFrameBufferTexture( finalTargetIndex ) );
 
@@ -2436,25 +2889,84 @@ void sgct::Engine::updateRenderingTargets(TextureIndexes ti)
 }
 
 /*!
-    This function updates the timers.
+    This function fires the timers that have expired at the end of the frame.
 */
 void sgct::Engine::updateTimers(double timeStamp)
 {
-    // check all timers if one of them has expired
+    mExpiredTimers.clear();
     if ( isMaster() )
+        mTimers.popExpired(timeStamp, mExpiredTimers);
+    fireTimers(mTimers, mExpiredTimers);
+
+    //decided by the master in the sync frame of this frame, see takeSynchronizedTimers
+    mExpiredTimers.clear();
+    mExpiredTimers.swap(mFiredTimers);
+    fireTimers(mSynchronizedTimers, mExpiredTimers);
+
+    mExpiredTimers.clear();
+    if( mClusterClockTimers.size() > 0 )
+        mClusterClockTimers.popExpired(getClusterTime(), mExpiredTimers);
+    fireTimers(mClusterClockTimers, mExpiredTimers);
+}
+
+void sgct::Engine::fireTimers(sgct_core::TimerQueue & timers, const std::vector<std::size_t> & ids)
+{
+    for(std::size_t id : ids)
     {
-        for(TimerInformation& currentTimer : mTimers)
-        {
-            const double timeSinceLastFiring = timeStamp - currentTimer.mLastFired;
-            if( timeSinceLastFiring > currentTimer.mInterval )
-            {
-                currentTimer.mLastFired = timeStamp;
-                currentTimer.mCallback(currentTimer.mId);
-            }
-        }
+        //a callback may stop a timer that expired in the same frame
+        timerCallbackFn fn = timers.getCallback(id);
+        if( fn != nullptr )
+            fn(id);
+    }
+}
+
+/*!
+    The master schedules the synchronized timers when the sync frame is encoded and sends the ids of the ones
+    that fire, so that every node fires them at the end of this frame, see takeSynchronizedTimers.
+*/
+void sgct::Engine::encodeSynchronizedTimers()
+{
+    std::vector<std::size_t> fired;
+    mSynchronizedTimers.popExpired(getTime(), fired);
+
+    mFiredTimersSync.setVal(std::vector<uint64_t>(fired.begin(), fired.end()));
+    SharedData::instance()->writeVector(&mFiredTimersSync);
+
+    if( !fired.empty() )
+    {
+        std::lock_guard<std::mutex> lock(mTimerMutex);
+        mPendingTimers.insert(mPendingTimers.end(), fired.begin(), fired.end());
     }
 }
 
+/*!
+    Called on slaves from the network thread when a sync frame is decoded, see encodeSynchronizedTimers. The sync
+    frame may arrive while the previous frame is still drawn, so the ids wait until takeSynchronizedTimers.
+*/
+void sgct::Engine::decodeSynchronizedTimers()
+{
+    SharedData::instance()->readVector(&mFiredTimersSync);
+    std::vector<uint64_t> fired = mFiredTimersSync.getVal();
+    if( fired.empty() )
+        return;
+
+    std::lock_guard<std::mutex> lock(mTimerMutex);
+    for(uint64_t id : fired)
+        mPendingTimers.push_back(static_cast<std::size_t>(id));
+}
+
+/*!
+    Called by the frame lock once the sync frame of this frame has been received, the synchronized timers of that
+    frame are then fired at the end of it. Without frame lock the sync frames aren't paced by the slaves, so the
+    timers of a sync frame that arrives during the frame lock of a slave may fire a frame late there.
+*/
+void sgct::Engine::takeSynchronizedTimers()
+{
+    std::lock_guard<std::mutex> lock(mTimerMutex);
+    mFiredTimers.insert(mFiredTimers.end(), mPendingTimers.begin(), mPendingTimers.end());
+    mPendingTimers.clear();
+}
+
 /*!
     This function loads shaders that handles different 3D modes.
     The shaders are only loaded once in the initOGL function.
@@ -2549,8 +3061,29 @@ void sgct::Engine::loadShaders()
         mShaderLocs[OverlayTex] = mShaders[OverlayShader].getUniformLocation( "Tex" );
         glUniform1i( mShaderLocs[OverlayTex], 0 );
         ShaderProgram::unbind();
-    }
-}
+
+        std::string Warp_lookup_vert_shader;
+        std::string Warp_lookup_frag_shader;
+        Warp_lookup_vert_shader = sgct_core::shaders_modern::Base_Vert_Shader;
+        Warp_lookup_frag_shader = sgct_core::shaders_modern::Warp_Lookup_Frag_Shader;
+
+        //replace glsl version
+        sgct_helpers::findAndReplace(Warp_lookup_vert_shader, "**glsl_version**", Engine::instance()->getGLSLVersion());
+        sgct_helpers::findAndReplace(Warp_lookup_frag_shader, "**glsl_version**", Engine::instance()->getGLSLVersion());
+
+        mShaders[WarpLookupShader].setName("WarpLookupShader");
+        if(!mShaders[WarpLookupShader].addShaderSrc(Warp_lookup_vert_shader, GL_VERTEX_SHADER, ShaderProgram::SHADER_SRC_STRING))
+            MessageHandler::instance()->print(MessageHandler::NOTIFY_ERROR, "Failed to load warp lookup vertex shader\n");
+        if(!mShaders[WarpLookupShader].addShaderSrc(Warp_lookup_frag_shader, GL_FRAGMENT_SHADER, ShaderProgram::SHADER_SRC_STRING))
+            MessageHandler::instance()->print(MessageHandler::NOTIFY_ERROR, "Failed to load warp lookup fragment shader\n");
+        mShaders[WarpLookupShader].createAndLinkProgram();
+        mShaders[WarpLookupShader].bind();
+        glUniform1i( mShaders[WarpLookupShader].getUniformLocation( "Tex" ), 0 );
+        glUniform1i( mShaders[WarpLookupShader].getUniformLocation( "LookupTex" ), 1 );
+        mShaderLocs[WarpLookupRect] = mShaders[WarpLookupShader].getUniformLocation( "LookupRect" );
+        ShaderProgram::unbind();
+    }
+}
 
 /*!
     \param mode is the one of the following:
@@ -2737,56 +3270,14 @@ void sgct::Engine::waitForAllWindowsInSwapGroupToOpen()
 */
 void sgct::Engine::updateFrustums()
 {
-    SGCTWindow * win;
-    sgct_core::Viewport * vp;
-    
     if (mThisNode == nullptr)
         return;
 
     for(size_t w=0; w < mThisNode->getNumberOfWindows(); w++)
     {
-        win = mThisNode->getWindowPtr(w);
+        SGCTWindow * win = mThisNode->getWindowPtr(w);
         for (unsigned int i = 0; i < win->getNumberOfViewports(); i++)
-        {
-            vp = win->getViewport(i);
-            if (!vp->isTracked()) //if not tracked update, otherwise this is done on the fly
-            {
-                if (vp->hasSubViewports())
-                {
-                    vp->getNonLinearProjectionPtr()->updateFrustums(
-                        sgct_core::Frustum::MonoEye,
-                        mNearClippingPlaneDist,
-                        mFarClippingPlaneDist);
-
-                    vp->getNonLinearProjectionPtr()->updateFrustums(
-                        sgct_core::Frustum::StereoLeftEye,
-                        mNearClippingPlaneDist,
-                        mFarClippingPlaneDist);
-
-                    vp->getNonLinearProjectionPtr()->updateFrustums(
-                        sgct_core::Frustum::StereoRightEye,
-                        mNearClippingPlaneDist,
-                        mFarClippingPlaneDist);
-                }
-                else
-                {
-                    vp->calculateFrustum(
-                        sgct_core::Frustum::MonoEye,
-                        mNearClippingPlaneDist,
-                        mFarClippingPlaneDist);
-
-                    vp->calculateFrustum(
-                        sgct_core::Frustum::StereoLeftEye,
-                        mNearClippingPlaneDist,
-                        mFarClippingPlaneDist);
-
-                    vp->calculateFrustum(
-                        sgct_core::Frustum::StereoRightEye,
-                        mNearClippingPlaneDist,
-                        mFarClippingPlaneDist);
-                }
-            }
-        }
+            win->getViewport(i)->updateFrustums(mNearClippingPlaneDist, mFarClippingPlaneDist);
     }
 }
 
@@ -2917,6 +3408,148 @@ void sgct::Engine::parseArguments( int& argc, char**& argv )
             argumentsToRemove.push_back(i+1);
             i+=2;
         }
+        else if( strcmp(argv[i],"-clockSyncDelay") == 0 && argc > (i+2) )
+        {
+            mClockSyncTestDelays[0] = atof(argv[i+1]) / 1000.0;
+            mClockSyncTestDelays[1] = atof(argv[i+2]) / 1000.0;
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            argumentsToRemove.push_back(i+2);
+            i+=3;
+        }
+        else if( strcmp(argv[i],"-clockSyncJitter") == 0 && argc > (i+1) )
+        {
+            mClockSyncTestDelays[2] = atof(argv[i+1]) / 1000.0;
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            i+=2;
+        }
+        else if( strcmp(argv[i],"-statsLog") == 0 && argc > (i+1) )
+        {
+            mStatsLogPath.assign( argv[i+1] );
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            i+=2;
+        }
+        else if( strcmp(argv[i],"-statsWindow") == 0 && argc > (i+1) )
+        {
+            int tmpi = -1;
+            std::stringstream ss( argv[i+1] );
+            ss >> tmpi;
+            if( tmpi > 0 )
+                mStatsWindow = static_cast<std::size_t>(tmpi);
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            i+=2;
+        }
+        else if( strcmp(argv[i],"-metricsPort") == 0 && argc > (i+1) )
+        {
+            mMetricsPort = std::max(atoi(argv[i+1]), 0);
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            i+=2;
+        }
+        else if( strcmp(argv[i],"-trace") == 0 && argc > (i+1) )
+        {
+            mTraceFilePath.assign( argv[i+1] );
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            i+=2;
+        }
+        else if( strcmp(argv[i],"-record") == 0 && argc > (i+1) )
+        {
+            mRecordPath.assign( argv[i+1] );
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            i+=2;
+        }
+        else if( strcmp(argv[i],"-replay") == 0 && argc > (i+1) )
+        {
+            mReplayPath.assign( argv[i+1] );
+            mSimulation = true;
+            sSimulationClock = true;
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            i+=2;
+        }
+        else if( strcmp(argv[i],"-replayStart") == 0 && argc > (i+1) )
+        {
+            int tmpi = -1;
+            std::stringstream ss( argv[i+1] );
+            ss >> tmpi;
+            if( tmpi > 0 )
+                mReplayStartFrame = static_cast<unsigned int>(tmpi);
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            i+=2;
+        }
+        else if( strcmp(argv[i],"--Replay-Step") == 0 )
+        {
+            mReplayStep = true;
+            argumentsToRemove.push_back(i);
+            i++;
+        }
+        else if( strcmp(argv[i],"--Simulate") == 0 )
+        {
+            mSimulation = true;
+            sSimulationClock = true;
+            argumentsToRemove.push_back(i);
+            i++;
+        }
+        else if( strcmp(argv[i],"-simDrawTime") == 0 && argc > (i+1) )
+        {
+            mSimDrawTime = std::max(atof(argv[i+1]) / 1000.0, 0.0);
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            i+=2;
+        }
+        else if( strcmp(argv[i],"-simFrames") == 0 && argc > (i+1) )
+        {
+            int tmpi = -1;
+            std::stringstream ss( argv[i+1] );
+            ss >> tmpi;
+            if( tmpi > 0 )
+                mSimFrames = static_cast<unsigned int>(tmpi);
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            i+=2;
+        }
+        else if( strcmp(argv[i],"-simStall") == 0 && argc > (i+2) )
+        {
+            int tmpi = -1;
+            std::stringstream ss( argv[i+1] );
+            ss >> tmpi;
+            if( tmpi > 0 )
+            {
+                mSimStallInterval = static_cast<unsigned int>(tmpi);
+                mSimStallDuration = std::max(atof(argv[i+2]) / 1000.0, 0.0);
+            }
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            argumentsToRemove.push_back(i+2);
+            i+=3;
+        }
+        else if( strcmp(argv[i],"-simLatency") == 0 && argc > (i+1) )
+        {
+            mSimLatency = std::max(atof(argv[i+1]) / 1000.0, 0.0);
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            i+=2;
+        }
+        else if( strcmp(argv[i],"-simBandwidth") == 0 && argc > (i+1) )
+        {
+            //Mbit/s to bytes/s
+            mSimBandwidth = std::max(atof(argv[i+1]) * 1.0e6 / 8.0, 0.0);
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i+1);
+            i+=2;
+        }
+        else if( strcmp(argv[i],"--Async-Log") == 0 )
+        {
+            MessageHandler::instance()->setAsyncLogging(true);
+            argumentsToRemove.push_back(i);
+            i++;
+        }
         else if( strcmp(argv[i],"--Firm-Sync") == 0 )
         {
             sgct_core::ClusterManager::instance()->setFirmFrameLockSyncStatus(true);
@@ -2987,6 +3620,20 @@ void sgct::Engine::parseArguments( int& argc, char**& argv )
             argumentsToRemove.push_back(i);
             i++;
         }
+        else if (strcmp(argv[i], "--Capture-Y4M") == 0)
+        {
+            SGCTSettings::instance()->setCaptureFormat("Y4M");
+            argumentsToRemove.push_back(i);
+            i++;
+        }
+        else if (strcmp(argv[i], "-captureStream") == 0 && argc > (i + 1))
+        {
+            SGCTSettings::instance()->setCaptureFormat("Y4M");
+            SGCTSettings::instance()->setCaptureStreamTarget(argv[i + 1]);
+            argumentsToRemove.push_back(i);
+            argumentsToRemove.push_back(i + 1);
+            i += 2;
+        }
         else if( strcmp(argv[i],"-numberOfCaptureThreads") == 0 && argc > (i+1) )
         {
             int tmpi = -1;
@@ -3887,7 +4534,7 @@ void sgct::Engine::enterCurrentViewport()
 
 void sgct::Engine::calculateFPS(double timestamp)
 {
-    static double lastTimestamp = glfwGetTime();
+    static double lastTimestamp = getTime();
     mStatistics->setFrameTime(static_cast<float>(timestamp - lastTimestamp));
     lastTimestamp = timestamp;
     static float renderedFrames = 0.0f;
@@ -3900,9 +4547,10 @@ void sgct::Engine::calculateFPS(double timestamp)
         renderedFrames = 0.0f;
         tmpTime = 0.0f;
 
-        for(size_t i=0; i < mThisNode->getNumberOfWindows(); i++)
-            if( mThisNode->getWindowPtr(i)->isVisible() )
-                updateAAInfo(i);
+        if( !mSimulation )
+            for(size_t i=0; i < mThisNode->getNumberOfWindows(); i++)
+                if( mThisNode->getWindowPtr(i)->isVisible() )
+                    updateAAInfo(i);
     }
 }
 
@@ -4082,6 +4730,9 @@ std::size_t sgct::Engine::getFocusedWindowIndex()
  */
 void sgct::Engine::invokeDecodeCallbackForExternalControl(const char * receivedData, int receivedlength, int clientId)
 {
+    if (mFrameRecorder != nullptr && receivedlength > 0)
+        mFrameRecorder->recordExternalControl(getTime(), receivedData, static_cast<std::size_t>(receivedlength), clientId);
+
     if (mExternalDecodeCallbackFnPtr != SGCT_NULL_PTR && receivedlength > 0)
         mExternalDecodeCallbackFnPtr(receivedData, receivedlength);
 }
@@ -4100,6 +4751,9 @@ void sgct::Engine::invokeUpdateCallbackForExternalControl(bool connected)
  */
 void sgct::Engine::invokeDecodeCallbackForDataTransfer(void * receivedData, int receivedlength, int packageId, int clientId)
 {
+    if (mFrameRecorder != nullptr && receivedlength > 0)
+        mFrameRecorder->recordDataTransfer(getTime(), receivedData, static_cast<std::size_t>(receivedlength), packageId, clientId);
+
     if (mDataTransferDecodeCallbackFnPtr != SGCT_NULL_PTR && receivedlength > 0)
         mDataTransferDecodeCallbackFnPtr(receivedData, receivedlength, packageId, clientId);
 }
@@ -4122,6 +4776,30 @@ void sgct::Engine::invokeAcknowledgeCallbackForDataTransfer(int packageId, int c
         mDataTransferAcknowledgeCallbackFnPtr(packageId, clientId);
 }
 
+/*!
+Reload the warping meshes, blend masks, black level masks and overlays that have changed since they were loaded.
+The files are parsed in the background and all nodes switch to the new data on the same frame. Can be called on
+any node, a slave asks the master to reload the whole cluster. Data from .mpcdi packages isn't reloaded.
+
+Files can also be reloaded automatically when they change, see SGCTSettings::setWatchCorrectionData.
+
+\param force reload all files even if they haven't changed
+*/
+void sgct::Engine::reloadCorrectionData(bool force)
+{
+    if (mCorrectionDataReloader != nullptr)
+        mCorrectionDataReloader->request(force);
+}
+
+/*!
+    Don't use this. This function is called from SGCTNetwork when a warping mesh reload message is received.
+*/
+void sgct::Engine::invokeCorrectionDataReloadCallback(int type, unsigned int generation, int value, int clientId)
+{
+    if (mCorrectionDataReloader != nullptr)
+        mCorrectionDataReloader->receiveMessage(type, generation, value, clientId);
+}
+
 /*!
     Don't use this. This function is called internally in SGCT.
 */
@@ -4384,19 +5062,50 @@ void sgct::Engine::sleep(double secs)
 */
 size_t sgct::Engine::createTimer( double millisec, void(*fnPtr)(std::size_t) )
 {
-    if ( isMaster() )
+    return createTimer( millisec, fnPtr, Master_Timer );
+}
+
+/*!
+    Create a timer that repeatedly calls the given callback at the end of the frame in which the interval has passed.
+
+    A Master_Timer runs only on the master. A Synchronized_Timer must be created in the same order on every node, it
+    gets the same id everywhere. The master decides when it fires and sends that in the sync frame, so with frame lock
+    the callback is called in the same frame on every node. Without frame lock a slave fires it at the end of the
+    first frame that starts after the sync frame was received, which may be a frame later. A Cluster_Clock_Timer runs on every node and is checked against
+    getClusterTime, so it fires at about the same time everywhere but not necessarily in the same frame.
+
+    \param millisec is the interval
+    \param fnPtr is the function pointer to a timer callback (the argument will be the timer handle/id).
+    \param type is the kind of timer
+
+    \returns Handle/id to the created timer
+*/
+size_t sgct::Engine::createTimer( double millisec, void(*fnPtr)(std::size_t), TimerType type )
+{
+    double interval = millisec / 1000.0; // we want to present timers in millisec, but getTime uses seconds
+    std::size_t id;
+    switch( type )
     {
-        // construct the timer object
-        TimerInformation timer;
-        timer.mCallback = fnPtr;
-        timer.mInterval = millisec / 1000.0; // we want to present timers in millisec, but glfwGetTime uses seconds
-        timer.mId = mTimerID++;  // use and post-increase
-        timer.mLastFired = getTime();
-        mTimers.push_back( timer );
-        return timer.mId;
+    case Synchronized_Timer:
+        id = mSynchronizedTimerID++;
+        mSynchronizedTimers.add( id, interval, getTime(), fnPtr );
+        return id;
+
+    case Cluster_Clock_Timer:
+        id = mTimerID++;
+        mClusterClockTimers.add( id, interval, getClusterTime(), fnPtr );
+        return id;
+
+    default:
+        if ( isMaster() )
+        {
+            id = mTimerID++;
+            mTimers.add( id, interval, getTime(), fnPtr );
+            return id;
+        }
+        else
+            return std::numeric_limits<size_t>::max();
     }
-    else
-        return std::numeric_limits<size_t>::max();
 }
 
 /*!
@@ -4405,24 +5114,12 @@ Stops the specified timer
 */
 void sgct::Engine::stopTimer( size_t id )
 {
-    if ( isMaster() )
-    {
-        // iterate over all timers and search for the id
-        for( size_t i = 0; i < mTimers.size(); ++i )
-        {
-            const TimerInformation& currentTimer = mTimers[i];
-            if( currentTimer.mId == id )
-            {
-                mTimers[i].mCallback = nullptr;
-                // if the id found, delete this timer and return immediately
-                mTimers.erase( mTimers.begin() + i );
-                return;
-            }
-        }
+    if( mTimers.remove(id) || mSynchronizedTimers.remove(id) || mClusterClockTimers.remove(id) )
+        return;
 
-        // if we get this far, the searched ID did not exist
-        MessageHandler::instance()->print(MessageHandler::NOTIFY_WARNING, "There was no timer with id: %d", id);
-    }
+    // if we get this far, the searched ID did not exist
+    if ( isMaster() )
+        MessageHandler::instance()->print(MessageHandler::NOTIFY_WARNING, "There was no timer with id: %llu\n", static_cast<unsigned long long>(id));
 }
 
 /*!
@@ -4430,9 +5127,36 @@ void sgct::Engine::stopTimer( size_t id )
 */
 double sgct::Engine::getTime()
 {
+    if( sSimulationClock )
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - sSimulationStart).count();
     return glfwGetTime();
 }
 
+/*!
+This function returns the time of the master in seconds, estimated on slaves from clock synchronization messages
+sent over the sync connection about once a second. Unlike getTime it is the same on all nodes, within the error
+bound returned by getClusterClockQuality, and can drive time based animation without sharing the time.
+Small corrections never make it go backwards. Before the first estimate it returns the local time.
+*/
+double sgct::Engine::getClusterTime()
+{
+    sgct_core::NetworkManager * nm = sgct_core::NetworkManager::instance();
+    return nm != nullptr ? nm->getClusterTime() : getTime();
+}
+
+/*!
+\returns the offset, drift and error estimates of the cluster clock of this node, see getClusterTime
+*/
+sgct_core::ClockSync::Quality sgct::Engine::getClusterClockQuality()
+{
+    sgct_core::NetworkManager * nm = sgct_core::NetworkManager::instance();
+    if (nm != nullptr)
+        return nm->getClockSyncQuality();
+
+    sgct_core::ClockSync::Quality quality = { false, 0.0, 0.0, 0.0, 0.0, 0.0, 0 };
+    return quality;
+}
+
 /*!
     Get the current viewportindex for given type: MainViewport or SubViewport
 */
@@ -4541,6 +5265,170 @@ void sgct::Engine::setScreenShotNumber(unsigned int number)
     mShotCounter = number;
 }
 
+/*!
+Start or stop recording the render loop zones, see exportTrace. Call it from the render thread, which is named in the trace.
+*/
+void sgct::Engine::setTracing(bool state)
+{
+    if( state )
+        sgct_core::Tracer::instance()->setThreadName("Render");
+    sgct_core::Tracer::instance()->setEnabled(state);
+}
+
+/*!
+Write the recorded zones as a Chrome trace, which can be opened in chrome://tracing or the Perfetto UI.
+
+\param filename the JSON file to write
+\param includeSlaves if this node is the master, collect the traces of the slaves and add them with their times moved to the master clock. This waits for the slaves to reply, which takes a few frames worth of time.
+
+\returns false if the file couldn't be written
+*/
+bool sgct::Engine::exportTrace(const std::string & filename, bool includeSlaves)
+{
+    if( includeSlaves && mNetworkConnections != nullptr && mNetworkConnections->isComputerServer() &&
+        mNetworkConnections->getSyncConnectionsCount() > 0 )
+    {
+        sgct_core::Tracer::instance()->clearRemoteTraces();
+        mNetworkConnections->requestTraces(5.0);
+    }
+
+    return sgct_core::Tracer::instance()->exportChromeTrace(filename);
+}
+
+/*!
+Set a callback that gets the frame, draw and sync time percentiles and the number of dropped frames at every statistics report interval.
+The callback is called from the render thread, so it should only do quick checks, for example raise an alarm when the frame times regress.
+*/
+void sgct::Engine::setStatisticsFunction(sgct_cppxeleven::function<void(const sgct_core::Statistics::Report &)> fn)
+{
+    mStatsReportFnPtr = fn;
+    if( mStatistics != nullptr )
+        mStatistics->setReportFunction(fn);
+}
+
+/*!
+Write the statistics reports to a CSV file. Slaves add _node<id> to the filename. An empty filename stops writing.
+*/
+void sgct::Engine::setStatisticsLogFile(const std::string & filename)
+{
+    mStatsLogPath = filename;
+    if( mStatistics != nullptr )
+        mStatistics->setReportFile( filename.empty() ? filename : getNodeFilePath(filename) );
+}
+
+/*!
+\param numberOfFrames the number of latest frames the percentiles are calculated from
+\param reportInterval how often in seconds the reports are written and passed to the statistics callback
+*/
+void sgct::Engine::setStatisticsWindow(std::size_t numberOfFrames, double reportInterval)
+{
+    mStatsWindow = numberOfFrames;
+    mStatsReportInterval = reportInterval;
+    if( mStatistics != nullptr )
+    {
+        mStatistics->setPercentileWindow(numberOfFrames);
+        mStatistics->setReportInterval(reportInterval);
+    }
+}
+
+/*!
+\returns the frame, draw and sync time percentiles of the statistics window
+*/
+sgct_core::Statistics::Report sgct::Engine::getStatisticsReport()
+{
+    return mStatistics->getReport( getTime() );
+}
+
+void sgct::Engine::applyStatisticsSettings()
+{
+    mStatistics->setPercentileWindow(mStatsWindow);
+    mStatistics->setReportInterval(mStatsReportInterval);
+    mStatistics->setReportFunction(mStatsReportFnPtr);
+    if( !mStatsLogPath.empty() )
+        mStatistics->setReportFile( getNodeFilePath(mStatsLogPath) );
+}
+
+/*!
+    Publish a snapshot of the health metrics to the metrics server, see -metricsPort. The snapshot is taken once per
+    METRICS_PUBLISH_INTERVAL and only from counters that can be read without waiting for other threads.
+*/
+void sgct::Engine::publishMetrics(double time)
+{
+    if( mMetricsServer == nullptr || time - mMetricsPublishTime < METRICS_PUBLISH_INTERVAL )
+        return;
+
+    sgct_core::MetricsServer::Snapshot & snapshot = mMetricsSnapshot;
+    snapshot.mTime = time;
+    snapshot.mNodeId = sgct_core::ClusterManager::instance()->getThisNodeId();
+    snapshot.mMaster = isMaster();
+    snapshot.mFrameNumber = mFrameCounter;
+    snapshot.mReport = mStatistics->getReport(time);
+    snapshot.mGPUFrameTime = sgct_core::GPUTimer::instance()->getFrameTime();
+    snapshot.mGPUDroppedFrames = sgct_core::GPUTimer::instance()->getNumberOfDroppedFrames();
+
+    SGCTTrackingManager * trackingManager = getTrackingManager();
+    snapshot.mTrackingSamplingTime = (trackingManager != nullptr && trackingManager->getNumberOfTrackers() > 0) ?
+        trackingManager->getSamplingTime() : -1.0;
+
+    snapshot.mCapturePendingFrames = 0;
+    snapshot.mCaptureDroppedFrames = 0;
+    if( !mSimulation )
+        for(std::size_t i=0; i < mThisNode->getNumberOfWindows(); i++)
+            for(unsigned int eye=0; eye < 2; eye++)
+            {
+                sgct_core::ScreenCapture * capture = mThisNode->getWindowPtr(i)->getScreenCapturePointer(eye);
+                if( capture != nullptr )
+                {
+                    snapshot.mCapturePendingFrames += capture->getNumberOfPendingFrames();
+                    snapshot.mCaptureDroppedFrames += capture->getNumberOfDroppedStreamFrames();
+                }
+            }
+
+    snapshot.mDroppedLogMessages = MessageHandler::instance()->getNumberOfDroppedMessages();
+    snapshot.mDroppedTraceEvents = sgct_core::Tracer::instance()->getNumberOfDroppedEvents();
+
+    snapshot.mConnections.resize(mNetworkConnections->getConnectionsCount());
+    for(std::size_t i=0; i < snapshot.mConnections.size(); i++)
+    {
+        sgct_core::SGCTNetwork * connection = mNetworkConnections->getConnectionByIndex(static_cast<unsigned int>(i));
+        sgct_core::MetricsServer::Connection & c = snapshot.mConnections[i];
+        c.mId = connection->getId();
+        c.mType = connection->getTypeStr();
+        c.mAddress = connection->getAddress();
+        c.mPort = connection->getPort();
+        c.mConnected = connection->isConnected();
+        c.mBytesSent = connection->getBytesSent();
+        c.mBytesReceived = connection->getBytesReceived();
+        c.mMessagesSent = connection->getMessagesSent();
+        c.mMessagesReceived = connection->getMessagesReceived();
+        c.mLoopTime = connection->getType() == sgct_core::SGCTNetwork::SyncConnection ? connection->getLoopTime() : -1.0;
+    }
+
+    //retried in the next frame if the server was busy copying the previous snapshot
+    if( mMetricsServer->publish(snapshot) )
+        mMetricsPublishTime = time;
+}
+
+/*!
+\returns the path with _node<id> added before the extension on slaves, so that nodes sharing a disk don't write the same file
+*/
+std::string sgct::Engine::getNodeFilePath(const std::string & path)
+{
+    if( mNetworkConnections == nullptr || mNetworkConnections->isComputerServer() )
+        return path;
+
+    std::stringstream ss;
+    ss << "_node" << sgct_core::ClusterManager::instance()->getThisNodeId();
+    std::string nodePath = path;
+    std::size_t extension = nodePath.find_last_of('.');
+    std::size_t separator = nodePath.find_last_of("/\\");
+    if( extension == std::string::npos || (separator != std::string::npos && extension < separator) )
+        nodePath += ss.str();
+    else
+        nodePath.insert(extension, ss.str());
+    return nodePath;
+}
+
 /*!
  \returns the current screenshot number (file index)
  */
@@ -4559,6 +5447,23 @@ void sgct::Engine::outputHelpMessage()
 \n--client                         \n\tRun the application as client\n\t(only available when running as local)\n\
 \n--slave                          \n\tRun the application as client\n\t(only available when running as local)\n\
 \n--debug                          \n\tSet the notify level of messagehandler to debug\n\
+\n--Async-Log                      \n\tWrite log messages from a background thread\n\t(the log file is kept open and flushed once a second)\n\
+\n-clockSyncDelay <ms> <ms>        \n\tDelay the clock sync requests and replies of a slave to test the cluster clock\n\t(for example on localhost, different delays bias the offset by half the difference)\n\
+\n-clockSyncJitter <ms>            \n\tAdd a random delay up to this to every clock sync message of a slave\n\
+\n-trace <filename.json>           \n\tRecord a timeline of every frame and write it as a Chrome trace on exit\n\t(the master merges the slave traces, slaves also write their own)\n\
+\n-statsLog <filename.csv>         \n\tWrite frame, draw and sync time percentiles and dropped frames to a CSV file\n\tonce a second (slaves add _node<id> to the filename)\n\
+\n-statsWindow <integer>            \n\tSet the number of latest frames the statistics percentiles are calculated from\n\t(default 512)\n\
+\n-metricsPort <integer>            \n\tServe health metrics in the Prometheus format at\n\thttp://127.0.0.1:<port + node index>/metrics\n\
+\n--Simulate                       \n\tRun this node without windows or OpenGL to test the cluster sync\n\t(the draw is replaced by a sleep and only the sync callbacks are called)\n\
+\n-simDrawTime <ms>                \n\tSet the simulated draw time of each frame\n\
+\n-simFrames <integer>             \n\tExit after this many simulated frames\n\
+\n-simStall <integer> <ms>         \n\tStall the simulated draw of every n:th frame by the given time\n\
+\n-simLatency <ms>                 \n\tDelay every received sync message by the given latency\n\
+\n-simBandwidth <Mbit/s>           \n\tDelay every received sync message as if the link had the given bandwidth\n\
+\n-record <filename>               \n\tRecord the sync stream of the master to a file for replay\n\t(shared data, external control and data transfer packages)\n\
+\n-replay <filename>               \n\tReplay a recorded sync stream on a single node without windows\n\t(implies --Simulate, prints the decode throughput at the end)\n\
+\n-replayStart <integer>           \n\tStart the replay at this frame\n\
+\n--Replay-Step                    \n\tReplay one frame at a time, controlled from the console\n\
 \n--Firm-Sync                      \n\tEnable firm frame sync\n\
 \n--Loose-Sync                     \n\tDisable firm frame sync\n\
 \n--Ignore-Sync                    \n\tDisable frame sync\n\
@@ -4570,6 +5475,8 @@ void sgct::Engine::outputHelpMessage()
 \n--Capture-PNG                    \n\tUse png images for screen capture (default)\n\
 \n--Capture-JPG                    \n\tUse jpg images for screen capture\n\
 \n--Capture-TGA                    \n\tUse tga images for screen capture\n\
+\n--Capture-Y4M                    \n\tStream screen capture into one y4m video file\n\
+\n-captureStream <target>          \n\tStream screen capture to a file, named pipe,\n\tunix:<path> or tcp:<port> (y4m)\n\
 \n-numberOfCaptureThreads <integer>\n\tSet the maximum amount of threads\n\tthat should be used during framecapture (default 8)\n------------------------------------\n\n");
 }
 
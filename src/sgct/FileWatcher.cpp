@@ -0,0 +1,230 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/FileWatcher.h>
+#include <sgct/MessageHandler.h>
+#include <sgct/helpers/SGCTFileFunctions.h>
+#include <chrono>
+
+#if defined(__linux__)
+    #include <sys/inotify.h>
+    #include <poll.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+    //a change is reported when the files have been quiet for this long
+    const std::chrono::milliseconds SettleTime(250);
+    const std::chrono::milliseconds PollInterval(500);
+}
+
+sgct_core::FileWatcher::FileWatcher()
+{
+    mThreadPtr = nullptr;
+    mRunning = false;
+    mChanged = false;
+    mNotifyFd = -1;
+}
+
+sgct_core::FileWatcher::~FileWatcher()
+{
+    stop();
+}
+
+/*!
+Add a file to watch, must be called before start. The file doesn't need to exist yet.
+*/
+void sgct_core::FileWatcher::addFile(const std::string & path)
+{
+    if (path.empty())
+        return;
+
+    for (std::size_t i = 0; i < mFiles.size(); i++)
+        if (mFiles[i].mPath == path)
+            return;
+
+    WatchedFile file;
+    file.mPath = path;
+    std::size_t found = path.find_last_of("/\\");
+    if (found == std::string::npos)
+    {
+        file.mDirectory.assign(".");
+        file.mName = path;
+    }
+    else
+    {
+        file.mDirectory = found == 0 ? path.substr(0, 1) : path.substr(0, found);
+        file.mName = path.substr(found + 1);
+    }
+
+    file.mWatch = -1;
+    file.mTime = 0;
+    file.mSize = 0;
+    sgct_helpers::getFileInfo(path, file.mTime, file.mSize);
+    mFiles.push_back(file);
+}
+
+/*!
+Start the watcher thread.
+\returns false if there is nothing to watch
+*/
+bool sgct_core::FileWatcher::start()
+{
+    if (mThreadPtr != nullptr)
+        return true;
+
+    if (mFiles.empty())
+        return false;
+
+#if defined(__linux__)
+    mNotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (mNotifyFd < 0)
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING,
+            "FileWatcher: Failed to initialize inotify, polling files instead.\n");
+#endif
+
+    mRunning = true;
+    mThreadPtr = new std::thread(&FileWatcher::work, this);
+    return true;
+}
+
+/*!
+Stop the watcher thread.
+*/
+void sgct_core::FileWatcher::stop()
+{
+    mRunning = false;
+    if (mThreadPtr)
+    {
+        mThreadPtr->join();
+        delete mThreadPtr;
+        mThreadPtr = nullptr;
+    }
+
+#if defined(__linux__)
+    if (mNotifyFd >= 0)
+    {
+        close(mNotifyFd);
+        mNotifyFd = -1;
+    }
+#endif
+}
+
+/*!
+\returns true if any file has changed since the last call
+*/
+bool sgct_core::FileWatcher::hasChanged()
+{
+    return mChanged.exchange(false);
+}
+
+/*!
+Compare the modification time and size of the files that aren't watched with inotify with the previous poll.
+\returns true if any file has changed
+*/
+bool sgct_core::FileWatcher::pollStamps()
+{
+    bool changed = false;
+    for (std::size_t i = 0; i < mFiles.size(); i++)
+    {
+        if (mFiles[i].mWatch >= 0)
+            continue;
+
+        unsigned long long mtime = 0;
+        unsigned long long size = 0;
+        sgct_helpers::getFileInfo(mFiles[i].mPath, mtime, size);
+        if (mtime != mFiles[i].mTime || size != mFiles[i].mSize)
+        {
+            mFiles[i].mTime = mtime;
+            mFiles[i].mSize = size;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void sgct_core::FileWatcher::work()
+{
+    typedef std::chrono::steady_clock Clock;
+    bool pending = false;
+    Clock::time_point lastChange;
+    Clock::time_point lastPoll = Clock::now();
+
+#if defined(__linux__)
+    //one watch per directory, the files themselves may be replaced. Different spellings of a directory share
+    //the same watch, so events are matched on the watch of each file rather than on the directory name.
+    bool useNotify = false;
+    for (std::size_t i = 0; i < mFiles.size(); i++)
+    {
+        mFiles[i].mWatch = mNotifyFd >= 0 ?
+            inotify_add_watch(mNotifyFd, mFiles[i].mDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) : -1;
+        if (mFiles[i].mWatch >= 0)
+            useNotify = true;
+        else if (mNotifyFd >= 0)
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING,
+                "FileWatcher: Failed to watch directory '%s', polling '%s' instead.\n",
+                mFiles[i].mDirectory.c_str(), mFiles[i].mName.c_str());
+    }
+#endif
+
+    while (mRunning)
+    {
+        bool changed = false;
+
+#if defined(__linux__)
+        if (useNotify)
+        {
+            pollfd pfd;
+            pfd.fd = mNotifyFd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+
+            if (poll(&pfd, 1, 100) > 0 && (pfd.revents & POLLIN))
+            {
+                alignas(inotify_event) char buffer[4096];
+                ssize_t length;
+                while ((length = read(mNotifyFd, buffer, sizeof(buffer))) > 0)
+                {
+                    for (char * ptr = buffer; ptr < buffer + length;)
+                    {
+                        const inotify_event * event = reinterpret_cast<const inotify_event *>(ptr);
+                        if (event->len > 0)
+                        {
+                            for (std::size_t i = 0; i < mFiles.size(); i++)
+                                if (mFiles[i].mWatch == event->wd && mFiles[i].mName == event->name)
+                                    changed = true;
+                        }
+                        ptr += sizeof(inotify_event) + event->len;
+                    }
+                }
+            }
+        }
+        else
+#endif
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        //files without a watch are polled, also when others are watched
+        if (Clock::now() - lastPoll >= PollInterval)
+        {
+            if (pollStamps())
+                changed = true;
+            lastPoll = Clock::now();
+        }
+
+        if (changed)
+        {
+            pending = true;
+            lastChange = Clock::now();
+        }
+        else if (pending && Clock::now() - lastChange >= SettleTime)
+        {
+            pending = false;
+            mChanged = true;
+        }
+    }
+}
@@ -244,7 +244,7 @@ bool sgct_text::Font::createGlyph(wchar_t c, FontFaceData * FFDPtr)
 
     //load pixel data
     GlyphData gd;
-    if (!getPixelData(mFace, width, height, &pixels, &gd))
+    if (!getPixelData(mFTLibrary, mFace, mStrokeSize, width, height, &pixels, &gd))
     {
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Font %s: FT_Get_Glyph failed for char %u.\n", mName.c_str(), static_cast<unsigned int>(c));
         return false;
@@ -306,7 +306,13 @@ unsigned int sgct_text::Font::generateTexture(int width, int height, unsigned ch
     return tex;
 }
 
-bool sgct_text::Font::getPixelData(FT_Face face, int & width, int & height, unsigned char ** pixels, GlyphData * gd)
+/*!
+Renders the glyph loaded in the face and its stroke to a two channel image, without any OpenGL calls.
+The caller deletes the pixels with delete[] and releases the glyphs and the stroker in the glyph data.
+
+\returns false if the glyph couldn't be copied from the face
+*/
+bool sgct_text::Font::getPixelData(FT_Library lib, FT_Face face, FT_Fixed strokeSize, int & width, int & height, unsigned char ** pixels, GlyphData * gd)
 {
     //Move the face's glyph into a Glyph object.
     if (FT_Get_Glyph(face->glyph, &(gd->mGlyph)) || FT_Get_Glyph(face->glyph, &(gd->mStrokeGlyph)))
@@ -315,10 +321,10 @@ bool sgct_text::Font::getPixelData(FT_Face face, int & width, int & height, unsi
     }
 
     gd->mStroker = nullptr;
-    FT_Error error = FT_Stroker_New(mFTLibrary, &(gd->mStroker));
+    FT_Error error = FT_Stroker_New(lib, &(gd->mStroker));
     if (!error)
     {
-        FT_Stroker_Set(gd->mStroker, 64 * mStrokeSize,
+        FT_Stroker_Set(gd->mStroker, 64 * strokeSize,
             FT_STROKER_LINECAP_ROUND,
             FT_STROKER_LINEJOIN_ROUND,
             0);
@@ -0,0 +1,701 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/FrameRecording.h>
+#include <sgct/MessageHandler.h>
+#ifndef SGCT_DONT_USE_EXTERNAL
+#include "../include/external/zlib.h"
+#else
+#include <zlib.h>
+#endif
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+
+#define FRAME_RECORDING_MAGIC "SGCTREC"
+#define FRAME_RECORDING_MAGIC_LENGTH 8
+#define FRAME_RECORDING_VERSION 2
+#define FRAME_RECORDING_HEADER_SIZE 16
+#define FRAME_RECORDING_CHUNK_MAGIC "CHNK"
+#define FRAME_RECORDING_CHUNK_HEADER_SIZE 24
+#define FRAME_RECORDING_RECORD_HEADER_SIZE 32
+#define FRAME_RECORDING_RECORD_ALIGNMENT 16
+#define FRAME_RECORDING_INDEX_ENTRY_SIZE 20
+#define FRAME_RECORDING_FOOTER_MAGIC "SIDX"
+#define FRAME_RECORDING_FOOTER_SIZE 16
+#define FRAME_RECORDING_CHUNK_FRAMES 64
+#define FRAME_RECORDING_CHUNK_BYTES 1048576
+
+namespace
+{
+    bool seekFile(FILE * fp, unsigned long long offset)
+    {
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+        return _fseeki64(fp, static_cast<__int64>(offset), SEEK_SET) == 0;
+#elif defined(_WIN32)
+        return fseeko64(fp, static_cast<off64_t>(offset), SEEK_SET) == 0;
+#else
+        return fseeko(fp, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+
+    unsigned long long getFileSize(FILE * fp)
+    {
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+        if (_fseeki64(fp, 0, SEEK_END) != 0)
+            return 0;
+        return static_cast<unsigned long long>(_ftelli64(fp));
+#elif defined(_WIN32)
+        if (fseeko64(fp, 0, SEEK_END) != 0)
+            return 0;
+        return static_cast<unsigned long long>(ftello64(fp));
+#else
+        if (fseeko(fp, 0, SEEK_END) != 0)
+            return 0;
+        return static_cast<unsigned long long>(ftello(fp));
+#endif
+    }
+
+    template <class T>
+    void putValue(unsigned char * dst, std::size_t & pos, T val)
+    {
+        memcpy(dst + pos, &val, sizeof(T));
+        pos += sizeof(T);
+    }
+
+    template <class T>
+    T getValue(const unsigned char * src, std::size_t & pos)
+    {
+        T val;
+        memcpy(&val, src + pos, sizeof(T));
+        pos += sizeof(T);
+        return val;
+    }
+
+    //! \returns the size of the data of a record padded to the start of the next record
+    std::size_t alignRecordSize(std::size_t size)
+    {
+        return (size + FRAME_RECORDING_RECORD_ALIGNMENT - 1) & ~static_cast<std::size_t>(FRAME_RECORDING_RECORD_ALIGNMENT - 1);
+    }
+}
+
+sgct_core::FrameRecorder::FrameRecorder()
+{
+    mWriterThread = nullptr;
+    mTerminate = false;
+    mFile = nullptr;
+    mCompressionLevel = 1;
+    mOpen = false;
+    mFailed = false;
+    mCurrentChunk.mFirstFrame = 0;
+    mCurrentChunk.mLastFrame = 0;
+    mCurrentChunk.mRecords = 0;
+    mCurrentChunk.mFramesEnd = 0;
+    mCurrentChunk.mFramesRecords = 0;
+    mNextFrame = 0;
+    mOffset = 0;
+    mFrames = 0;
+    mWrittenBytes = 0;
+}
+
+sgct_core::FrameRecorder::~FrameRecorder()
+{
+    close();
+}
+
+/*!
+Create the file and start the writer thread.
+
+\param path the file, an existing file is replaced
+\param compressionLevel the zlib compression level of the chunks, 1 (fastest) to 9 (smallest)
+\returns false if the file can't be created
+*/
+bool sgct_core::FrameRecorder::open(const std::string & path, int compressionLevel)
+{
+    close();
+
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    if (fopen_s(&mFile, path.c_str(), "wb") != 0)
+        mFile = nullptr;
+#else
+    mFile = fopen(path.c_str(), "wb");
+#endif
+    if (mFile == nullptr)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameRecorder: Failed to create '%s'!\n", path.c_str());
+        return false;
+    }
+
+    unsigned char header[FRAME_RECORDING_HEADER_SIZE];
+    memset(header, 0, FRAME_RECORDING_HEADER_SIZE);
+    memcpy(header, FRAME_RECORDING_MAGIC, FRAME_RECORDING_MAGIC_LENGTH);
+    std::size_t pos = FRAME_RECORDING_MAGIC_LENGTH;
+    putValue<uint32_t>(header, pos, FRAME_RECORDING_VERSION);
+    putValue<uint32_t>(header, pos, 0);
+
+    if (fwrite(header, 1, FRAME_RECORDING_HEADER_SIZE, mFile) != FRAME_RECORDING_HEADER_SIZE)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameRecorder: Failed to write to '%s'!\n", path.c_str());
+        fclose(mFile);
+        mFile = nullptr;
+        return false;
+    }
+
+    mPath = path;
+    mCompressionLevel = std::max(1, std::min(compressionLevel, 9));
+    mFailed = false;
+    mTerminate = false;
+    mCurrentChunk.mData.clear();
+    mCurrentChunk.mRecords = 0;
+    mCurrentChunk.mFramesEnd = 0;
+    mCurrentChunk.mFramesRecords = 0;
+    mNextFrame = 0;
+    mIndex.clear();
+    mOffset = FRAME_RECORDING_HEADER_SIZE;
+    mFrames = 0;
+    mWrittenBytes = FRAME_RECORDING_HEADER_SIZE;
+    mOpen = true;
+
+    mWriterThread = new std::thread(&FrameRecorder::writeChunks, this);
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
+        "FrameRecorder: Recording the sync stream to '%s'.\n", path.c_str());
+    return true;
+}
+
+/*!
+Write the remaining records and the index, and close the file. Packages received after the last frame are not
+written, since no frame was encoded with them.
+*/
+void sgct_core::FrameRecorder::close()
+{
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (!mOpen)
+            return;
+
+        if (mCurrentChunk.mFramesRecords > 0)
+        {
+            mCurrentChunk.mData.resize(mCurrentChunk.mFramesEnd);
+            mCurrentChunk.mRecords = mCurrentChunk.mFramesRecords;
+            mPendingChunks.push_back(std::move(mCurrentChunk));
+        }
+        mCurrentChunk.mData.clear();
+        mCurrentChunk.mRecords = 0;
+        mCurrentChunk.mFramesRecords = 0;
+        mOpen = false;
+        mTerminate = true;
+    }
+
+    mCondition.notify_all();
+    mWriterThread->join();
+    delete mWriterThread;
+    mWriterThread = nullptr;
+
+    if (!mFailed && !writeIndex())
+        mFailed = true;
+
+    fclose(mFile);
+    mFile = nullptr;
+
+    if (mFailed)
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameRecorder: The recording '%s' is incomplete!\n", mPath.c_str());
+    else
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
+            "FrameRecorder: Recorded %llu frames in %llu bytes to '%s'.\n", mFrames.load(), mWrittenBytes.load(), mPath.c_str());
+}
+
+bool sgct_core::FrameRecorder::isOpen()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    return mOpen;
+}
+
+/*!
+Record the data of an encoded frame.
+
+\param frame the frame number, must increase
+\param time the time of the master
+\param data the data as the slaves pass it to SharedData::decode, without the header and uncompressed
+\param size the size of the data
+*/
+void sgct_core::FrameRecorder::recordSyncFrame(unsigned int frame, double time, const unsigned char * data, std::size_t size)
+{
+    append(FrameRecord::SyncFrame, frame, time, 0, -1, data, size);
+}
+
+/*!
+Record a message from an external control connection, it is replayed before the next recorded frame. Called from the network threads.
+*/
+void sgct_core::FrameRecorder::recordExternalControl(double time, const char * data, std::size_t size, int clientId)
+{
+    append(FrameRecord::ExternalControl, 0, time, 0, clientId, data, size);
+}
+
+/*!
+Record a data transfer package, it is replayed before the next recorded frame. Called from the network threads.
+*/
+void sgct_core::FrameRecorder::recordDataTransfer(double time, const void * data, std::size_t size, int packageId, int clientId)
+{
+    append(FrameRecord::DataTransfer, 0, time, packageId, clientId, data, size);
+}
+
+unsigned long long sgct_core::FrameRecorder::getNumberOfFrames()
+{
+    return mFrames;
+}
+
+/*!
+\returns the number of bytes written to the file so far, the chunks that the writer thread hasn't written yet are not included
+*/
+unsigned long long sgct_core::FrameRecorder::getWrittenBytes()
+{
+    return mWrittenBytes;
+}
+
+void sgct_core::FrameRecorder::append(FrameRecord::Type type, unsigned int frame, double time, int packageId, int clientId,
+    const void * data, std::size_t size)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (!mOpen || mFailed)
+        return;
+
+    //packages are replayed before the frame that follows them
+    if (type != FrameRecord::SyncFrame)
+        frame = mNextFrame;
+
+    Chunk & chunk = mCurrentChunk;
+    if (chunk.mRecords == 0)
+    {
+        chunk.mFirstFrame = frame;
+        chunk.mLastFrame = frame;
+    }
+    chunk.mRecords++;
+
+    //the header is padded and the data is padded to the next record, so the data of every record is aligned
+    //like a newly allocated buffer when the chunk is read
+    std::size_t start = chunk.mData.size();
+    chunk.mData.resize(start + FRAME_RECORDING_RECORD_HEADER_SIZE + alignRecordSize(size));
+    unsigned char * dst = &chunk.mData[0];
+    std::size_t pos = start;
+    putValue<uint8_t>(dst, pos, static_cast<uint8_t>(type));
+    putValue<uint32_t>(dst, pos, frame);
+    putValue<double>(dst, pos, time);
+    putValue<int32_t>(dst, pos, packageId);
+    putValue<int32_t>(dst, pos, clientId);
+    putValue<uint32_t>(dst, pos, static_cast<uint32_t>(size));
+    if (size > 0)
+        memcpy(dst + start + FRAME_RECORDING_RECORD_HEADER_SIZE, data, size);
+
+    if (type != FrameRecord::SyncFrame)
+        return;
+
+    chunk.mLastFrame = frame;
+    chunk.mFramesEnd = chunk.mData.size();
+    chunk.mFramesRecords = chunk.mRecords;
+    mNextFrame = frame + 1;
+    mFrames++;
+
+    //chunks only end after a frame, so a chunk holds the packages of all its frames
+    if (chunk.mLastFrame - chunk.mFirstFrame + 1 >= FRAME_RECORDING_CHUNK_FRAMES || chunk.mData.size() >= FRAME_RECORDING_CHUNK_BYTES)
+    {
+        mPendingChunks.push_back(std::move(chunk));
+        chunk.mData.clear();
+        chunk.mRecords = 0;
+        chunk.mFramesRecords = 0;
+        lock.unlock();
+        mCondition.notify_one();
+    }
+}
+
+/*!
+The writer thread, it writes the pending chunks until the recorder is closed and all chunks are written.
+*/
+void sgct_core::FrameRecorder::writeChunks()
+{
+    std::vector<unsigned char> compressed;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true)
+    {
+        mCondition.wait(lock, [this] { return mTerminate || !mPendingChunks.empty(); });
+        if (mPendingChunks.empty())
+            break;
+
+        Chunk chunk = std::move(mPendingChunks.front());
+        mPendingChunks.pop_front();
+        if (mFailed)
+            continue;
+
+        lock.unlock();
+        bool written = writeChunk(chunk, compressed);
+        lock.lock();
+
+        if (!written)
+            mFailed = true;
+    }
+}
+
+bool sgct_core::FrameRecorder::writeChunk(Chunk & chunk, std::vector<unsigned char> & compressed)
+{
+    compressed.resize(FRAME_RECORDING_CHUNK_HEADER_SIZE + compressBound(static_cast<uLong>(chunk.mData.size())));
+
+    uLongf compressedSize = static_cast<uLongf>(compressed.size() - FRAME_RECORDING_CHUNK_HEADER_SIZE);
+    int err = compress2(&compressed[FRAME_RECORDING_CHUNK_HEADER_SIZE], &compressedSize,
+        &chunk.mData[0], static_cast<uLong>(chunk.mData.size()), mCompressionLevel);
+    if (err != Z_OK)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameRecorder: Failed to compress frames %u-%u (error %d)!\n", chunk.mFirstFrame, chunk.mLastFrame, err);
+        return false;
+    }
+
+    std::size_t pos = 0;
+    memcpy(&compressed[0], FRAME_RECORDING_CHUNK_MAGIC, 4);
+    pos += 4;
+    putValue<uint32_t>(&compressed[0], pos, chunk.mFirstFrame);
+    putValue<uint32_t>(&compressed[0], pos, chunk.mLastFrame);
+    putValue<uint32_t>(&compressed[0], pos, chunk.mRecords);
+    putValue<uint32_t>(&compressed[0], pos, static_cast<uint32_t>(compressedSize));
+    putValue<uint32_t>(&compressed[0], pos, static_cast<uint32_t>(chunk.mData.size()));
+
+    std::size_t size = FRAME_RECORDING_CHUNK_HEADER_SIZE + compressedSize;
+    if (fwrite(&compressed[0], 1, size, mFile) != size)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameRecorder: Failed to write frames %u-%u to '%s'!\n", chunk.mFirstFrame, chunk.mLastFrame, mPath.c_str());
+        return false;
+    }
+
+    IndexEntry entry;
+    entry.mOffset = mOffset;
+    entry.mFirstFrame = chunk.mFirstFrame;
+    entry.mLastFrame = chunk.mLastFrame;
+    entry.mRecords = chunk.mRecords;
+    mIndex.push_back(entry);
+
+    mOffset += size;
+    mWrittenBytes = mOffset;
+    return true;
+}
+
+bool sgct_core::FrameRecorder::writeIndex()
+{
+    std::vector<unsigned char> buffer(mIndex.size() * FRAME_RECORDING_INDEX_ENTRY_SIZE + FRAME_RECORDING_FOOTER_SIZE);
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < mIndex.size(); i++)
+    {
+        putValue<uint64_t>(&buffer[0], pos, mIndex[i].mOffset);
+        putValue<uint32_t>(&buffer[0], pos, mIndex[i].mFirstFrame);
+        putValue<uint32_t>(&buffer[0], pos, mIndex[i].mLastFrame);
+        putValue<uint32_t>(&buffer[0], pos, mIndex[i].mRecords);
+    }
+
+    putValue<uint64_t>(&buffer[0], pos, mOffset);
+    putValue<uint32_t>(&buffer[0], pos, static_cast<uint32_t>(mIndex.size()));
+    memcpy(&buffer[pos], FRAME_RECORDING_FOOTER_MAGIC, 4);
+
+    if (fwrite(&buffer[0], 1, buffer.size(), mFile) != buffer.size())
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameRecorder: Failed to write the index to '%s'!\n", mPath.c_str());
+        return false;
+    }
+
+    mWrittenBytes = mOffset + buffer.size();
+    return true;
+}
+
+sgct_core::FrameReplay::FrameReplay()
+{
+    mFile = nullptr;
+    mFileSize = 0;
+    mCurrentChunk = 0;
+    mPos = 0;
+}
+
+sgct_core::FrameReplay::~FrameReplay()
+{
+    close();
+}
+
+/*!
+Open a recording and position it at the first frame. The index is rebuilt from the chunks if the recording wasn't closed.
+
+\returns false if the file can't be read or has no frames
+*/
+bool sgct_core::FrameReplay::open(const std::string & path)
+{
+    close();
+
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    if (fopen_s(&mFile, path.c_str(), "rb") != 0)
+        mFile = nullptr;
+#else
+    mFile = fopen(path.c_str(), "rb");
+#endif
+    if (mFile == nullptr)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameReplay: Failed to open '%s'!\n", path.c_str());
+        return false;
+    }
+
+    mPath = path;
+    mFileSize = getFileSize(mFile);
+
+    unsigned char header[FRAME_RECORDING_HEADER_SIZE];
+    if (mFileSize < FRAME_RECORDING_HEADER_SIZE || !seekFile(mFile, 0) ||
+        fread(header, 1, FRAME_RECORDING_HEADER_SIZE, mFile) != FRAME_RECORDING_HEADER_SIZE ||
+        memcmp(header, FRAME_RECORDING_MAGIC, FRAME_RECORDING_MAGIC_LENGTH) != 0)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameReplay: '%s' is not a frame recording!\n", path.c_str());
+        close();
+        return false;
+    }
+
+    std::size_t pos = FRAME_RECORDING_MAGIC_LENGTH;
+    uint32_t version = getValue<uint32_t>(header, pos);
+    if (version != FRAME_RECORDING_VERSION)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameReplay: '%s' has unsupported version %u!\n", path.c_str(), version);
+        close();
+        return false;
+    }
+
+    if (!readIndex() && !rebuildIndex())
+    {
+        close();
+        return false;
+    }
+
+    if (mIndex.empty() || !loadChunk(0))
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameReplay: '%s' has no frames!\n", path.c_str());
+        close();
+        return false;
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
+        "FrameReplay: Opened '%s' with frames %u-%u in %u chunks.\n",
+        path.c_str(), getFirstFrame(), getLastFrame(), static_cast<unsigned int>(mIndex.size()));
+    return true;
+}
+
+void sgct_core::FrameReplay::close()
+{
+    if (mFile != nullptr)
+    {
+        fclose(mFile);
+        mFile = nullptr;
+    }
+
+    mFileSize = 0;
+    mIndex.clear();
+    mChunk.clear();
+    mCurrentChunk = 0;
+    mPos = 0;
+}
+
+/*!
+Position the replay at a frame, the next record read is the first package received before it or the frame itself.
+
+\returns false if the frame isn't in the recording
+*/
+bool sgct_core::FrameReplay::seek(unsigned int frame)
+{
+    std::vector<IndexEntry>::const_iterator it = std::lower_bound(mIndex.begin(), mIndex.end(), frame,
+        [](const IndexEntry & entry, unsigned int value) { return entry.mLastFrame < value; });
+
+    if (it == mIndex.end() || frame < mIndex.front().mFirstFrame)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameReplay: Frame %u is not in the recording (frames %u-%u)!\n", frame, getFirstFrame(), getLastFrame());
+        return false;
+    }
+
+    if (!loadChunk(static_cast<std::size_t>(it - mIndex.begin())))
+        return false;
+
+    //the chunk ends with a frame at or after the wanted one, so this never reads into the next chunk
+    FrameRecord record;
+    std::size_t pos = mPos;
+    while (next(record))
+    {
+        if (record.mFrame >= frame)
+        {
+            mPos = pos;
+            return true;
+        }
+        pos = mPos;
+    }
+
+    return false;
+}
+
+/*!
+Read the next record.
+
+\returns false at the end of the recording or if it is corrupt
+*/
+bool sgct_core::FrameReplay::next(FrameRecord & record)
+{
+    while (mPos >= mChunk.size())
+    {
+        if (mCurrentChunk + 1 >= mIndex.size() || !loadChunk(mCurrentChunk + 1))
+            return false;
+    }
+
+    if (mChunk.size() - mPos < FRAME_RECORDING_RECORD_HEADER_SIZE)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameReplay: Corrupt record in chunk %u of '%s'!\n", static_cast<unsigned int>(mCurrentChunk), mPath.c_str());
+        mPos = mChunk.size();
+        return false;
+    }
+
+    const unsigned char * src = &mChunk[0];
+    std::size_t pos = mPos;
+    uint8_t type = getValue<uint8_t>(src, pos);
+    record.mType = static_cast<FrameRecord::Type>(type);
+    record.mFrame = getValue<uint32_t>(src, pos);
+    record.mTime = getValue<double>(src, pos);
+    record.mPackageId = getValue<int32_t>(src, pos);
+    record.mClientId = getValue<int32_t>(src, pos);
+    record.mSize = getValue<uint32_t>(src, pos);
+
+    if (type > FrameRecord::DataTransfer || record.mSize > mChunk.size() - pos ||
+        alignRecordSize(record.mSize) > mChunk.size() - pos)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameReplay: Corrupt record in chunk %u of '%s'!\n", static_cast<unsigned int>(mCurrentChunk), mPath.c_str());
+        mPos = mChunk.size();
+        return false;
+    }
+
+    record.mData = &mChunk[0] + FRAME_RECORDING_RECORD_HEADER_SIZE + mPos;
+    mPos += FRAME_RECORDING_RECORD_HEADER_SIZE + alignRecordSize(record.mSize);
+    return true;
+}
+
+/*!
+Read the index from the end of the file.
+
+\returns false if the file has no valid index
+*/
+bool sgct_core::FrameReplay::readIndex()
+{
+    if (mFileSize < FRAME_RECORDING_HEADER_SIZE + FRAME_RECORDING_FOOTER_SIZE)
+        return false;
+
+    unsigned char footer[FRAME_RECORDING_FOOTER_SIZE];
+    if (!seekFile(mFile, mFileSize - FRAME_RECORDING_FOOTER_SIZE) ||
+        fread(footer, 1, FRAME_RECORDING_FOOTER_SIZE, mFile) != FRAME_RECORDING_FOOTER_SIZE ||
+        memcmp(footer + 12, FRAME_RECORDING_FOOTER_MAGIC, 4) != 0)
+        return false;
+
+    std::size_t pos = 0;
+    unsigned long long offset = getValue<uint64_t>(footer, pos);
+    unsigned long long entries = getValue<uint32_t>(footer, pos);
+    if (offset < FRAME_RECORDING_HEADER_SIZE ||
+        offset + entries * FRAME_RECORDING_INDEX_ENTRY_SIZE + FRAME_RECORDING_FOOTER_SIZE != mFileSize)
+        return false;
+
+    std::vector<unsigned char> buffer(static_cast<std::size_t>(entries * FRAME_RECORDING_INDEX_ENTRY_SIZE));
+    if (!buffer.empty() && (!seekFile(mFile, offset) || fread(&buffer[0], 1, buffer.size(), mFile) != buffer.size()))
+        return false;
+
+    mIndex.resize(static_cast<std::size_t>(entries));
+    pos = 0;
+    for (std::size_t i = 0; i < mIndex.size(); i++)
+    {
+        mIndex[i].mOffset = getValue<uint64_t>(&buffer[0], pos);
+        mIndex[i].mFirstFrame = getValue<uint32_t>(&buffer[0], pos);
+        mIndex[i].mLastFrame = getValue<uint32_t>(&buffer[0], pos);
+        mIndex[i].mRecords = getValue<uint32_t>(&buffer[0], pos);
+    }
+
+    return true;
+}
+
+/*!
+Rebuild the index of a recording that wasn't closed by walking the chunk headers. A chunk cut off at the end is skipped.
+*/
+bool sgct_core::FrameReplay::rebuildIndex()
+{
+    mIndex.clear();
+
+    unsigned long long offset = FRAME_RECORDING_HEADER_SIZE;
+    unsigned char header[FRAME_RECORDING_CHUNK_HEADER_SIZE];
+    while (offset + FRAME_RECORDING_CHUNK_HEADER_SIZE <= mFileSize)
+    {
+        if (!seekFile(mFile, offset) ||
+            fread(header, 1, FRAME_RECORDING_CHUNK_HEADER_SIZE, mFile) != FRAME_RECORDING_CHUNK_HEADER_SIZE ||
+            memcmp(header, FRAME_RECORDING_CHUNK_MAGIC, 4) != 0)
+            break;
+
+        std::size_t pos = 4;
+        IndexEntry entry;
+        entry.mOffset = offset;
+        entry.mFirstFrame = getValue<uint32_t>(header, pos);
+        entry.mLastFrame = getValue<uint32_t>(header, pos);
+        entry.mRecords = getValue<uint32_t>(header, pos);
+        unsigned long long compressedSize = getValue<uint32_t>(header, pos);
+
+        offset += FRAME_RECORDING_CHUNK_HEADER_SIZE + compressedSize;
+        if (offset > mFileSize)
+            break;
+
+        mIndex.push_back(entry);
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING,
+        "FrameReplay: '%s' has no index, it was rebuilt from %u chunks.\n", mPath.c_str(), static_cast<unsigned int>(mIndex.size()));
+    return true;
+}
+
+bool sgct_core::FrameReplay::loadChunk(std::size_t chunk)
+{
+    unsigned char header[FRAME_RECORDING_CHUNK_HEADER_SIZE];
+    if (!seekFile(mFile, mIndex[chunk].mOffset) ||
+        fread(header, 1, FRAME_RECORDING_CHUNK_HEADER_SIZE, mFile) != FRAME_RECORDING_CHUNK_HEADER_SIZE ||
+        memcmp(header, FRAME_RECORDING_CHUNK_MAGIC, 4) != 0)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameReplay: Failed to read chunk %u of '%s'!\n", static_cast<unsigned int>(chunk), mPath.c_str());
+        return false;
+    }
+
+    std::size_t pos = 16;
+    uint32_t compressedSize = getValue<uint32_t>(header, pos);
+    uint32_t uncompressedSize = getValue<uint32_t>(header, pos);
+
+    mCompressed.resize(compressedSize);
+    mChunk.resize(uncompressedSize);
+    uLongf size = static_cast<uLongf>(uncompressedSize);
+    if (compressedSize == 0 || uncompressedSize == 0 ||
+        fread(&mCompressed[0], 1, compressedSize, mFile) != compressedSize ||
+        uncompress(&mChunk[0], &size, &mCompressed[0], static_cast<uLong>(compressedSize)) != Z_OK ||
+        size != uncompressedSize)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "FrameReplay: Failed to decompress chunk %u of '%s'!\n", static_cast<unsigned int>(chunk), mPath.c_str());
+        mChunk.clear();
+        mPos = 0;
+        return false;
+    }
+
+    mCurrentChunk = chunk;
+    mPos = 0;
+    return true;
+}
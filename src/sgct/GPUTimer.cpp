@@ -0,0 +1,213 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/GPUTimer.h>
+#include <sgct/Engine.h>
+#include <sgct/MessageHandler.h>
+#include <sgct/Tracer.h>
+
+sgct_core::GPUTimer * sgct_core::GPUTimer::mInstance = nullptr;
+bool sgct_core::GPUTimer::mMeasuring = false;
+
+sgct_core::GPUTimer::GPUTimer()
+{
+    mCurrentFrame = 0;
+    mContext = nullptr;
+    mFrameTime = -1.0;
+    mDroppedFrames = 0;
+}
+
+/*!
+The queries are deleted by deinit, which needs the OpenGL context.
+*/
+sgct_core::GPUTimer::~GPUTimer()
+{
+    mMeasuring = false;
+}
+
+/*!
+Create the frame slots for the current OpenGL context.
+
+\param framesInFlight is the number of frames that are measured before the results of the first one are read, at least two
+\returns false if timestamp queries aren't supported (OpenGL 3.3 or GL_ARB_timer_query)
+*/
+bool sgct_core::GPUTimer::init(std::size_t framesInFlight)
+{
+    deinit();
+
+    if (!GLEW_VERSION_3_3 && !GLEW_ARB_timer_query)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO,
+            "GPUTimer: Timestamp queries are not supported, the GPU time of the passes is not measured.\n");
+        return false;
+    }
+
+    mFrames.resize(framesInFlight < 2 ? 2 : framesInFlight);
+    for (std::size_t i = 0; i < mFrames.size(); i++)
+    {
+        mFrames[i].mUsedQueries = 0;
+        mFrames[i].mTime = 0.0;
+        mFrames[i].mTimestamp = 0;
+    }
+    mCurrentFrame = 0;
+    mContext = glfwGetCurrentContext();
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG,
+        "GPUTimer: Measuring with %u frames in flight.\n", static_cast<unsigned int>(mFrames.size()));
+    return true;
+}
+
+/*!
+Delete the queries, the context that was current in init must be current.
+*/
+void sgct_core::GPUTimer::deinit()
+{
+    for (std::size_t i = 0; i < mFrames.size(); i++)
+        if (!mFrames[i].mQueries.empty())
+            glDeleteQueries(static_cast<GLsizei>(mFrames[i].mQueries.size()), &mFrames[i].mQueries[0]);
+
+    mFrames.clear();
+    mZones.clear();
+    mContext = nullptr;
+    mMeasuring = false;
+    mFrameTime = -1.0;
+}
+
+/*!
+Start measuring a frame in the next slot, reading back the frame that was measured in it before.
+Nothing is measured if the owning context isn't current.
+*/
+void sgct_core::GPUTimer::beginFrame()
+{
+    if (mFrames.empty() || glfwGetCurrentContext() != mContext)
+        return;
+
+    mCurrentFrame = (mCurrentFrame + 1) % mFrames.size();
+    Frame & frame = mFrames[mCurrentFrame];
+    readBack(frame);
+
+    frame.mUsedQueries = 0;
+    frame.mZones.clear();
+
+    //doesn't wait for the GPU, it is the time when the previous commands have reached it
+    glGetInteger64v(GL_TIMESTAMP, &frame.mTimestamp);
+    frame.mTime = sgct::Engine::getTime();
+
+    mMeasuring = true;
+    beginZone("GPU frame", -1);
+}
+
+void sgct_core::GPUTimer::endFrame()
+{
+    if (!mMeasuring)
+        return;
+
+    endZone(0);
+    mMeasuring = false;
+}
+
+/*!
+Issue the start timestamp of a zone.
+
+\param name the name of the zone, must outlive the tracer
+\param argument an index shown with the zone, -1 if none
+\returns the zone to pass to endZone, -1 if the zone isn't measured
+*/
+int sgct_core::GPUTimer::beginZone(const char * name, int argument)
+{
+    if (!mMeasuring || glfwGetCurrentContext() != mContext)
+        return -1;
+
+    PendingZone zone;
+    zone.mName = name;
+    zone.mArgument = argument;
+    zone.mBeginQuery = issueQuery();
+    zone.mEndQuery = zone.mBeginQuery; //not ended
+
+    Frame & frame = mFrames[mCurrentFrame];
+    frame.mZones.push_back(zone);
+    return static_cast<int>(frame.mZones.size() - 1);
+}
+
+/*!
+Issue the end timestamp of a zone. A zone that ends in another context than it began in is not measured.
+*/
+void sgct_core::GPUTimer::endZone(int zone)
+{
+    if (!mMeasuring || glfwGetCurrentContext() != mContext || zone < 0 ||
+        static_cast<std::size_t>(zone) >= mFrames[mCurrentFrame].mZones.size())
+        return;
+
+    std::size_t query = issueQuery();
+    mFrames[mCurrentFrame].mZones[zone].mEndQuery = query;
+}
+
+/*!
+\returns the index of a timestamp query issued now in the current frame, the queries are created when first needed
+*/
+std::size_t sgct_core::GPUTimer::issueQuery()
+{
+    Frame & frame = mFrames[mCurrentFrame];
+    if (frame.mUsedQueries == frame.mQueries.size())
+    {
+        GLuint query;
+        glGenQueries(1, &query);
+        frame.mQueries.push_back(query);
+    }
+
+    glQueryCounter(frame.mQueries[frame.mUsedQueries], GL_TIMESTAMP);
+    return frame.mUsedQueries++;
+}
+
+/*!
+Read the results of a frame if the GPU is done with it, otherwise the frame is dropped.
+*/
+void sgct_core::GPUTimer::readBack(Frame & frame)
+{
+    if (frame.mUsedQueries == 0)
+        return;
+
+    //the commands finish in order, so the other results are available if the last one is
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frame.mQueries[frame.mUsedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE)
+    {
+        mDroppedFrames++;
+        return;
+    }
+
+    mZones.clear();
+    for (std::size_t i = 0; i < frame.mZones.size(); i++)
+    {
+        const PendingZone & pending = frame.mZones[i];
+        if (pending.mEndQuery == pending.mBeginQuery)
+            continue;
+
+        GLuint64 begin;
+        GLuint64 end;
+        glGetQueryObjectui64v(frame.mQueries[pending.mBeginQuery], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.mQueries[pending.mEndQuery], GL_QUERY_RESULT, &end);
+
+        //timestamps are in nanoseconds
+        Zone zone;
+        zone.mName = pending.mName;
+        zone.mArgument = pending.mArgument;
+        zone.mStart = frame.mTime + static_cast<double>(static_cast<GLint64>(begin) - frame.mTimestamp) * 1.0e-9;
+        zone.mEnd = zone.mStart + static_cast<double>(end - begin) * 1.0e-9;
+        mZones.push_back(zone);
+
+        if (i == 0)
+            mFrameTime = zone.mEnd - zone.mStart;
+    }
+
+    if (Tracer::isEnabled())
+    {
+        Tracer::ThreadBuffer * track = Tracer::instance()->getTrack("GPU");
+        for (std::size_t i = 0; i < mZones.size(); i++)
+            Tracer::instance()->record(track, mZones[i].mName, mZones[i].mStart, mZones[i].mEnd, mZones[i].mArgument);
+    }
+}
@@ -8,6 +8,7 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #include <stdio.h>
 #include <fstream>
 #include <algorithm>
+#include <new>
 
 #ifndef SGCT_DONT_USE_EXTERNAL
 #include "../include/external/png.h"
@@ -728,6 +729,12 @@ bool sgct_core::Image::loadTGA(std::string filename)
     //done with the file
     fclose(fp);
 
+    //TGA pixels are stored as BGR(A) with origin in the lower left corner unless bit 5 of the descriptor is set
+    if (header[17] & 0x20)
+        flipVertical();
+    if (!mPreferBGRForImport)
+        swapRedBlue(mData, mSize_x * mSize_y, mChannels);
+
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO, "Image: Loaded %s (%dx%d %d-bit).\n", mFilename.c_str(), mSize_x, mSize_y, mBytesPerChannel * 8);
     return true;
 }
@@ -768,6 +775,11 @@ bool sgct_core::Image::loadTGA(unsigned char * data, std::size_t len)
         
         memcpy(mData, &data[TGA_BYTES_TO_CHECK], mDataSize);
     }
+
+    if (data[17] & 0x20)
+        flipVertical();
+    if (!mPreferBGRForImport)
+        swapRedBlue(mData, mSize_x * mSize_y, mChannels);
     
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO, "Image: Loaded %dx%d TGA from memory.\n", mSize_x, mSize_y);
 
@@ -1263,14 +1275,7 @@ bool sgct_core::Image::saveTGA()
     {
         mPreferBGRForImport = true;//reset BGR flag for texture manager
         
-        unsigned char tmp;
-        if (mChannels >= 3)
-            for (std::size_t i = 0; i < mDataSize; i += mChannels)
-            {
-                tmp = mData[i];
-                mData[i] = mData[i + 2];
-                mData[i + 2] = tmp;
-            }
+        swapRedBlue(mData, mSize_x * mSize_y, mChannels);
     }
 
     //write row-by-row
@@ -1526,6 +1531,162 @@ float sgct_core::Image::getInterpolatedSampleAt(float x, float y, sgct_core::Ima
     return p0 * w0 + p1 * w1 + p2 * w2 + p3 * w3;
 }
 
+/*!
+Swap the red and blue channels of the image (RGB(A) <-> BGR(A)). The BGR import flag is toggled so that the TextureManager still interprets the data correctly.
+*/
+void sgct_core::Image::swapRedBlue()
+{
+    if (mData == nullptr || mChannels < 3)
+        return;
+
+    swapRedBlue(mData, mSize_x * mSize_y, mChannels, mBytesPerChannel);
+    mPreferBGRForImport = !mPreferBGRForImport;
+}
+
+/*!
+Convert a 8-bit three channel image to four channels with constant alpha.
+*/
+bool sgct_core::Image::addAlphaChannel(unsigned char alpha)
+{
+    if (mData == nullptr || mChannels != 3 || mBytesPerChannel != 1)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Image error: Can only add alpha to 8-bit three channel images!\n");
+        return false;
+    }
+
+    unsigned char * data = new (std::nothrow) unsigned char[mSize_x * mSize_y * 4];
+    if (data == nullptr)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Image error: Failed to allocate image data!\n");
+        return false;
+    }
+
+    unpackRGBToRGBA(mData, data, mSize_x * mSize_y, alpha);
+    return replaceData(data, 4, 1, mSize_x, mSize_y);
+}
+
+/*!
+Convert a 8-bit four channel image to three channels by dropping the alpha channel.
+*/
+bool sgct_core::Image::removeAlphaChannel()
+{
+    if (mData == nullptr || mChannels != 4 || mBytesPerChannel != 1)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Image error: Can only remove alpha from 8-bit four channel images!\n");
+        return false;
+    }
+
+    unsigned char * data = new (std::nothrow) unsigned char[mSize_x * mSize_y * 3];
+    if (data == nullptr)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Image error: Failed to allocate image data!\n");
+        return false;
+    }
+
+    packRGBAToRGB(mData, data, mSize_x * mSize_y);
+    return replaceData(data, 3, 1, mSize_x, mSize_y);
+}
+
+/*!
+Flip the image upside down.
+*/
+void sgct_core::Image::flipVertical()
+{
+    if (mData == nullptr)
+        return;
+
+    flipRows(mData, mSize_x * mChannels * mBytesPerChannel, mSize_y);
+}
+
+/*!
+Convert the image between 8-bit and 16-bit per channel.
+*/
+bool sgct_core::Image::convertBytesPerChannel(std::size_t bpc)
+{
+    if (mData == nullptr || (bpc != 1 && bpc != 2) || (mBytesPerChannel != 1 && mBytesPerChannel != 2))
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Image error: Can only convert between 8-bit and 16-bit images!\n");
+        return false;
+    }
+
+    if (bpc == mBytesPerChannel)
+        return true;
+
+    std::size_t count = mSize_x * mSize_y * mChannels;
+    unsigned char * data = new (std::nothrow) unsigned char[count * bpc];
+    if (data == nullptr)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Image error: Failed to allocate image data!\n");
+        return false;
+    }
+
+    if (bpc == 2)
+        convert8To16(mData, reinterpret_cast<unsigned short *>(data), count);
+    else
+        convert16To8(reinterpret_cast<unsigned short *>(mData), data, count);
+
+    return replaceData(data, mChannels, bpc, mSize_x, mSize_y);
+}
+
+/*!
+Multiply the color channels with the alpha channel. Only valid for 8-bit four channel images.
+*/
+bool sgct_core::Image::premultiplyAlpha()
+{
+    if (mData == nullptr || mChannels != 4 || mBytesPerChannel != 1)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Image error: Can only premultiply 8-bit four channel images!\n");
+        return false;
+    }
+
+    premultiplyAlpha(mData, mSize_x * mSize_y);
+    return true;
+}
+
+/*!
+Resize the image using bilinear filtering. Only valid for 8-bit images.
+*/
+bool sgct_core::Image::resample(std::size_t width, std::size_t height)
+{
+    if (mData == nullptr || mBytesPerChannel != 1 || width == 0 || height == 0)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Image error: Can only resample 8-bit images to a valid size!\n");
+        return false;
+    }
+
+    if (width == mSize_x && height == mSize_y)
+        return true;
+
+    unsigned char * data = new (std::nothrow) unsigned char[width * height * mChannels];
+    if (data == nullptr)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Image error: Failed to allocate image data!\n");
+        return false;
+    }
+
+    resampleBilinear(mData, mSize_x, mSize_y, data, width, height, mChannels);
+    return replaceData(data, mChannels, 1, width, height);
+}
+
+/*!
+Take ownership of a converted buffer and release the previous one (unless external).
+*/
+bool sgct_core::Image::replaceData(unsigned char * data, std::size_t channels, std::size_t bpc, std::size_t width, std::size_t height)
+{
+    if (!mExternalData && mData)
+        delete[] mData;
+
+    mData = data;
+    mExternalData = false;
+    mChannels = channels;
+    mBytesPerChannel = bpc;
+    mSize_x = width;
+    mSize_y = height;
+    mDataSize = mChannels * mSize_x * mSize_y * mBytesPerChannel;
+
+    return allocateRowPtrs();
+}
+
 void sgct_core::Image::setDataPtr(unsigned char * dPtr)
 {
     if (!mExternalData && mData)
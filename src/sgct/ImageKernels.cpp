@@ -0,0 +1,696 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+/*
+    Pixel conversion kernels used by sgct_core::Image.
+    The vector paths are selected at compile time from the instruction sets enabled
+    for the compiler (-msse2/-mssse3/-mavx2 or /arch:AVX2 and NEON on ARM). Every kernel
+    has a scalar fallback that also handles the remaining tail of each buffer.
+*/
+
+#include <sgct/Image.h>
+
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SGCT_IMAGE_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+    #define SGCT_IMAGE_SSSE3 1
+    #include <tmmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+    #define SGCT_IMAGE_AVX2 1
+    #include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define SGCT_IMAGE_NEON 1
+    #include <arm_neon.h>
+#endif
+
+/*!
+    Swaps the red and blue channel of 3 or 4 channel pixel data in place (RGB <-> BGR, RGBA <-> BGRA).
+
+    \param data pointer to the pixel data
+    \param pixels number of pixels
+    \param channels number of channels per pixel, data with less than three channels is left untouched
+    \param bpc bytes per channel (1 or 2)
+*/
+void sgct_core::Image::swapRedBlue(unsigned char * data, std::size_t pixels, std::size_t channels, std::size_t bpc)
+{
+    if (data == nullptr || channels < 3)
+        return;
+
+    if (bpc == 2)
+    {
+        auto * data16 = reinterpret_cast<unsigned short *>(data);
+        for (std::size_t i = 0; i < pixels * channels; i += channels)
+            std::swap(data16[i], data16[i + 2]);
+        return;
+    }
+
+    std::size_t i = 0;
+
+    if (channels == 4)
+    {
+#if SGCT_IMAGE_AVX2
+        const __m256i ag256 = _mm256_set1_epi32(static_cast<int>(0xFF00FF00));
+        const __m256i byte256 = _mm256_set1_epi32(0xFF);
+        for (; i + 8 <= pixels; i += 8)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i * 4));
+            __m256i r = _mm256_and_si256(v, ag256);
+            r = _mm256_or_si256(r, _mm256_and_si256(_mm256_srli_epi32(v, 16), byte256));
+            r = _mm256_or_si256(r, _mm256_slli_epi32(_mm256_and_si256(v, byte256), 16));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + i * 4), r);
+        }
+#endif
+#if SGCT_IMAGE_SSE2
+        const __m128i ag = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+        const __m128i byte = _mm_set1_epi32(0xFF);
+        for (; i + 4 <= pixels; i += 4)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 4));
+            __m128i r = _mm_and_si128(v, ag);
+            r = _mm_or_si128(r, _mm_and_si128(_mm_srli_epi32(v, 16), byte));
+            r = _mm_or_si128(r, _mm_slli_epi32(_mm_and_si128(v, byte), 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i * 4), r);
+        }
+#elif SGCT_IMAGE_NEON
+        for (; i + 16 <= pixels; i += 16)
+        {
+            uint8x16x4_t v = vld4q_u8(data + i * 4);
+            uint8x16_t tmp = v.val[0];
+            v.val[0] = v.val[2];
+            v.val[2] = tmp;
+            vst4q_u8(data + i * 4, v);
+        }
+#endif
+    }
+    else if (channels == 3)
+    {
+#if SGCT_IMAGE_SSSE3
+        //five pixels per 16 byte register, the last byte is kept as is
+        const __m128i mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+        for (; (i + 5) * 3 + 1 <= pixels * 3; i += 5)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i * 3), _mm_shuffle_epi8(v, mask));
+        }
+#elif SGCT_IMAGE_NEON
+        for (; i + 16 <= pixels; i += 16)
+        {
+            uint8x16x3_t v = vld3q_u8(data + i * 3);
+            uint8x16_t tmp = v.val[0];
+            v.val[0] = v.val[2];
+            v.val[2] = tmp;
+            vst3q_u8(data + i * 3, v);
+        }
+#endif
+    }
+
+    //scalar tail
+    for (std::size_t pos = i * channels; pos < pixels * channels; pos += channels)
+        std::swap(data[pos], data[pos + 2]);
+}
+
+/*!
+    Converts 8-bit four channel pixels to three channels by dropping the last (alpha) channel.
+    The channel order of the first three channels is kept. The source and destination must not overlap.
+*/
+void sgct_core::Image::packRGBAToRGB(const unsigned char * src, unsigned char * dst, std::size_t pixels)
+{
+    if (src == nullptr || dst == nullptr)
+        return;
+
+    std::size_t i = 0;
+
+#if SGCT_IMAGE_SSSE3
+    //16 bytes are written per 4 pixels but only 12 are valid, stay clear of the buffer end
+    const __m128i mask = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    for (; i + 6 <= pixels; i += 4)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 3), _mm_shuffle_epi8(v, mask));
+    }
+#elif SGCT_IMAGE_NEON
+    for (; i + 16 <= pixels; i += 16)
+    {
+        uint8x16x4_t v = vld4q_u8(src + i * 4);
+        uint8x16x3_t o;
+        o.val[0] = v.val[0];
+        o.val[1] = v.val[1];
+        o.val[2] = v.val[2];
+        vst3q_u8(dst + i * 3, o);
+    }
+#endif
+
+    for (; i < pixels; i++)
+    {
+        dst[i * 3] = src[i * 4];
+        dst[i * 3 + 1] = src[i * 4 + 1];
+        dst[i * 3 + 2] = src[i * 4 + 2];
+    }
+}
+
+/*!
+    Converts 8-bit three channel pixels to four channels by appending a constant alpha channel.
+    The channel order of the first three channels is kept. The source and destination must not overlap.
+*/
+void sgct_core::Image::unpackRGBToRGBA(const unsigned char * src, unsigned char * dst, std::size_t pixels, unsigned char alpha)
+{
+    if (src == nullptr || dst == nullptr)
+        return;
+
+    std::size_t i = 0;
+
+#if SGCT_IMAGE_SSSE3
+    //16 bytes are read per 4 pixels but only 12 are used, stay clear of the buffer end
+    const __m128i mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alphaVec = _mm_set1_epi32(static_cast<int>(static_cast<unsigned int>(alpha) << 24));
+    for (; i + 6 <= pixels; i += 4)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(v, mask), alphaVec));
+    }
+#elif SGCT_IMAGE_NEON
+    const uint8x16_t alphaVec = vdupq_n_u8(alpha);
+    for (; i + 16 <= pixels; i += 16)
+    {
+        uint8x16x3_t v = vld3q_u8(src + i * 3);
+        uint8x16x4_t o;
+        o.val[0] = v.val[0];
+        o.val[1] = v.val[1];
+        o.val[2] = v.val[2];
+        o.val[3] = alphaVec;
+        vst4q_u8(dst + i * 4, o);
+    }
+#endif
+
+    for (; i < pixels; i++)
+    {
+        dst[i * 4] = src[i * 3];
+        dst[i * 4 + 1] = src[i * 3 + 1];
+        dst[i * 4 + 2] = src[i * 3 + 2];
+        dst[i * 4 + 3] = alpha;
+    }
+}
+
+/*!
+    Flips the row order of a buffer in place (first row becomes last).
+
+    \param data pointer to the first row
+    \param rowSize size of a row in bytes
+    \param rows number of rows
+*/
+void sgct_core::Image::flipRows(unsigned char * data, std::size_t rowSize, std::size_t rows)
+{
+    if (data == nullptr || rows < 2)
+        return;
+
+    for (std::size_t y = 0; y < rows / 2; y++)
+    {
+        unsigned char * top = data + y * rowSize;
+        unsigned char * bottom = data + (rows - 1 - y) * rowSize;
+        std::size_t i = 0;
+
+#if SGCT_IMAGE_AVX2
+        for (; i + 32 <= rowSize; i += 32)
+        {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(top + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bottom + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(top + i), b);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(bottom + i), a);
+        }
+#endif
+#if SGCT_IMAGE_SSE2
+        for (; i + 16 <= rowSize; i += 16)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(top + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(top + i), b);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(bottom + i), a);
+        }
+#elif SGCT_IMAGE_NEON
+        for (; i + 16 <= rowSize; i += 16)
+        {
+            uint8x16_t a = vld1q_u8(top + i);
+            uint8x16_t b = vld1q_u8(bottom + i);
+            vst1q_u8(top + i, b);
+            vst1q_u8(bottom + i, a);
+        }
+#endif
+
+        for (; i < rowSize; i++)
+            std::swap(top[i], bottom[i]);
+    }
+}
+
+/*!
+    Expands 8-bit samples to 16-bit (x * 257 so that 255 maps to 65535).
+*/
+void sgct_core::Image::convert8To16(const unsigned char * src, unsigned short * dst, std::size_t count)
+{
+    if (src == nullptr || dst == nullptr)
+        return;
+
+    std::size_t i = 0;
+
+#if SGCT_IMAGE_AVX2
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_or_si256(v, _mm256_slli_epi16(v, 8)));
+    }
+#endif
+#if SGCT_IMAGE_SSE2
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        //interleaving a byte with itself gives x | (x << 8) = x * 257
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_unpacklo_epi8(v, v));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 8), _mm_unpackhi_epi8(v, v));
+    }
+#elif SGCT_IMAGE_NEON
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16_t v = vld1q_u8(src + i);
+        uint8x16x2_t z = vzipq_u8(v, v);
+        vst1q_u16(dst + i, vreinterpretq_u16_u8(z.val[0]));
+        vst1q_u16(dst + i + 8, vreinterpretq_u16_u8(z.val[1]));
+    }
+#endif
+
+    for (; i < count; i++)
+        dst[i] = static_cast<unsigned short>(src[i] * 257);
+}
+
+/*!
+    Reduces 16-bit samples to 8-bit with correct rounding (round(x * 255 / 65535)).
+*/
+void sgct_core::Image::convert16To8(const unsigned short * src, unsigned char * dst, std::size_t count)
+{
+    if (src == nullptr || dst == nullptr)
+        return;
+
+    std::size_t i = 0;
+
+#if SGCT_IMAGE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi32(32895);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i out[2];
+        for (int j = 0; j < 2; j++)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + j * 8));
+            __m128i lo = _mm_unpacklo_epi16(v, zero);
+            __m128i hi = _mm_unpackhi_epi16(v, zero);
+            //(x * 255 + 32895) >> 16
+            lo = _mm_srli_epi32(_mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(lo, 8), lo), bias), 16);
+            hi = _mm_srli_epi32(_mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(hi, 8), hi), bias), 16);
+            out[j] = _mm_packs_epi32(lo, hi);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(out[0], out[1]));
+    }
+#elif SGCT_IMAGE_NEON
+    const uint32x4_t bias = vdupq_n_u32(32895);
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t v = vld1q_u16(src + i);
+        uint16x4_t lo = vshrn_n_u32(vaddq_u32(vmull_n_u16(vget_low_u16(v), 255), bias), 16);
+        uint16x4_t hi = vshrn_n_u32(vaddq_u32(vmull_n_u16(vget_high_u16(v), 255), bias), 16);
+        vst1_u8(dst + i, vmovn_u16(vcombine_u16(lo, hi)));
+    }
+#endif
+
+    for (; i < count; i++)
+        dst[i] = static_cast<unsigned char>((static_cast<unsigned int>(src[i]) * 255 + 32895) >> 16);
+}
+
+/*!
+    Multiplies the color channels of 8-bit four channel pixels with the alpha channel in place.
+    The alpha channel is expected last which is the case for both RGBA and BGRA data.
+*/
+void sgct_core::Image::premultiplyAlpha(unsigned char * data, std::size_t pixels)
+{
+    if (data == nullptr)
+        return;
+
+    std::size_t i = 0;
+
+    //round(c * a / 255) computed as t = c * a + 128; (t + (t >> 8)) >> 8
+#if SGCT_IMAGE_AVX2
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i half = _mm256_set1_epi16(128);
+        const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+        for (; i + 8 <= pixels; i += 8)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i * 4));
+            __m256i lo = _mm256_unpacklo_epi8(v, zero);
+            __m256i hi = _mm256_unpackhi_epi8(v, zero);
+            __m256i aLo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            __m256i aHi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            lo = _mm256_add_epi16(_mm256_mullo_epi16(lo, aLo), half);
+            hi = _mm256_add_epi16(_mm256_mullo_epi16(hi, aHi), half);
+            lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+            hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+            __m256i r = _mm256_packus_epi16(lo, hi);
+            r = _mm256_or_si256(_mm256_andnot_si256(alphaMask, r), _mm256_and_si256(alphaMask, v));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + i * 4), r);
+        }
+    }
+#endif
+#if SGCT_IMAGE_SSE2
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i half = _mm_set1_epi16(128);
+        const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+        for (; i + 4 <= pixels; i += 4)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 4));
+            __m128i lo = _mm_unpacklo_epi8(v, zero);
+            __m128i hi = _mm_unpackhi_epi8(v, zero);
+            __m128i aLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            __m128i aHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            lo = _mm_add_epi16(_mm_mullo_epi16(lo, aLo), half);
+            hi = _mm_add_epi16(_mm_mullo_epi16(hi, aHi), half);
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+            __m128i r = _mm_packus_epi16(lo, hi);
+            r = _mm_or_si128(_mm_andnot_si128(alphaMask, r), _mm_and_si128(alphaMask, v));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i * 4), r);
+        }
+    }
+#elif SGCT_IMAGE_NEON
+    for (; i + 8 <= pixels; i += 8)
+    {
+        uint8x8x4_t v = vld4_u8(data + i * 4);
+        for (int c = 0; c < 3; c++)
+        {
+            uint16x8_t t = vmull_u8(v.val[c], v.val[3]);
+            v.val[c] = vraddhn_u16(t, vrshrq_n_u16(t, 8));
+        }
+        vst4_u8(data + i * 4, v);
+    }
+#endif
+
+    for (; i < pixels; i++)
+    {
+        unsigned char * p = data + i * 4;
+        for (int c = 0; c < 3; c++)
+        {
+            unsigned int t = static_cast<unsigned int>(p[c]) * p[3] + 128;
+            p[c] = static_cast<unsigned char>((t + (t >> 8)) >> 8);
+        }
+    }
+}
+
+/*!
+    Bilinear resampling of 8-bit pixel data with any number of channels.
+    Sample positions are aligned on pixel centers and clamped at the image borders.
+    The vertical pass is vectorized over a whole row, the horizontal pass uses precomputed
+    source offsets and weights.
+*/
+void sgct_core::Image::resampleBilinear(const unsigned char * src, std::size_t srcWidth, std::size_t srcHeight,
+    unsigned char * dst, std::size_t dstWidth, std::size_t dstHeight, std::size_t channels)
+{
+    if (src == nullptr || dst == nullptr || srcWidth == 0 || srcHeight == 0 || dstWidth == 0 || dstHeight == 0 || channels == 0)
+        return;
+
+    const std::size_t srcRowSize = srcWidth * channels;
+
+    //horizontal lookup: first source sample offset and 8-bit fixed point weight of the second sample
+    std::vector<std::size_t> xOffsets(dstWidth * 2);
+    std::vector<unsigned int> xWeights(dstWidth);
+    const double xScale = static_cast<double>(srcWidth) / static_cast<double>(dstWidth);
+    for (std::size_t x = 0; x < dstWidth; x++)
+    {
+        double fx = (static_cast<double>(x) + 0.5) * xScale - 0.5;
+        fx = std::max(0.0, std::min(fx, static_cast<double>(srcWidth - 1)));
+        auto x0 = static_cast<std::size_t>(fx);
+        std::size_t x1 = std::min(x0 + 1, srcWidth - 1);
+        xOffsets[x * 2] = x0 * channels;
+        xOffsets[x * 2 + 1] = x1 * channels;
+        xWeights[x] = static_cast<unsigned int>((fx - static_cast<double>(x0)) * 256.0 + 0.5);
+    }
+
+    //vertically blended source row, 8.8 fixed point
+    std::vector<unsigned short> row(srcRowSize);
+    const double yScale = static_cast<double>(srcHeight) / static_cast<double>(dstHeight);
+
+    for (std::size_t y = 0; y < dstHeight; y++)
+    {
+        double fy = (static_cast<double>(y) + 0.5) * yScale - 0.5;
+        fy = std::max(0.0, std::min(fy, static_cast<double>(srcHeight - 1)));
+        auto y0 = static_cast<std::size_t>(fy);
+        std::size_t y1 = std::min(y0 + 1, srcHeight - 1);
+        auto wy = static_cast<unsigned short>((fy - static_cast<double>(y0)) * 256.0 + 0.5);
+        auto wy0 = static_cast<unsigned short>(256 - wy);
+
+        const unsigned char * r0 = src + y0 * srcRowSize;
+        const unsigned char * r1 = src + y1 * srcRowSize;
+        std::size_t i = 0;
+
+#if SGCT_IMAGE_AVX2
+        {
+            const __m256i w0 = _mm256_set1_epi16(static_cast<short>(wy0));
+            const __m256i w1 = _mm256_set1_epi16(static_cast<short>(wy));
+            for (; i + 16 <= srcRowSize; i += 16)
+            {
+                __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(r0 + i)));
+                __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(r1 + i)));
+                __m256i r = _mm256_add_epi16(_mm256_mullo_epi16(a, w0), _mm256_mullo_epi16(b, w1));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(&row[i]), r);
+            }
+        }
+#endif
+#if SGCT_IMAGE_SSE2
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i w0 = _mm_set1_epi16(static_cast<short>(wy0));
+            const __m128i w1 = _mm_set1_epi16(static_cast<short>(wy));
+            for (; i + 16 <= srcRowSize; i += 16)
+            {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(r0 + i));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(r1 + i));
+                __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), w0), _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w1));
+                __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), w0), _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w1));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(&row[i]), lo);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(&row[i + 8]), hi);
+            }
+        }
+#elif SGCT_IMAGE_NEON
+        for (; i + 8 <= srcRowSize; i += 8)
+        {
+            uint16x8_t r = vmulq_n_u16(vmovl_u8(vld1_u8(r0 + i)), wy0);
+            r = vmlaq_n_u16(r, vmovl_u8(vld1_u8(r1 + i)), wy);
+            vst1q_u16(&row[i], r);
+        }
+#endif
+
+        for (; i < srcRowSize; i++)
+            row[i] = static_cast<unsigned short>(r0[i] * wy0 + r1[i] * wy);
+
+        unsigned char * out = dst + y * dstWidth * channels;
+        for (std::size_t x = 0; x < dstWidth; x++)
+        {
+            const unsigned short * s0 = &row[xOffsets[x * 2]];
+            const unsigned short * s1 = &row[xOffsets[x * 2 + 1]];
+            unsigned int wx = xWeights[x];
+            unsigned int wx0 = 256 - wx;
+            for (std::size_t c = 0; c < channels; c++)
+                out[x * channels + c] = static_cast<unsigned char>((s0[c] * wx0 + s1[c] * wx + 32768) >> 16);
+        }
+    }
+}
+
+#if SGCT_IMAGE_SSE2
+/*
+    Splits eight 4-channel pixels into 16-bit red, green and blue lanes.
+*/
+static inline void splitChannels(const unsigned char * src, const __m128i & rShift, const __m128i & bShift,
+    __m128i & r, __m128i & g, __m128i & b)
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+    r = _mm_packs_epi32(_mm_and_si128(_mm_srl_epi32(v0, rShift), mask), _mm_and_si128(_mm_srl_epi32(v1, rShift), mask));
+    g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(v0, 8), mask), _mm_and_si128(_mm_srli_epi32(v1, 8), mask));
+    b = _mm_packs_epi32(_mm_and_si128(_mm_srl_epi32(v0, bShift), mask), _mm_and_si128(_mm_srl_epi32(v1, bShift), mask));
+}
+
+static inline __m128i lumaBT601(const __m128i & r, const __m128i & g, const __m128i & b)
+{
+    //unsigned 16-bit math, the largest sum is 220 * 255 + 128
+    __m128i y = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(66)), _mm_mullo_epi16(g, _mm_set1_epi16(129)));
+    y = _mm_add_epi16(y, _mm_mullo_epi16(b, _mm_set1_epi16(25)));
+    y = _mm_srli_epi16(_mm_add_epi16(y, _mm_set1_epi16(128)), 8);
+    return _mm_add_epi16(y, _mm_set1_epi16(16));
+}
+
+/*
+    Averages 2x2 blocks from two rows of sixteen pixels (8-bit values in 16-bit lanes) into eight values.
+*/
+static inline __m128i average2x2(const __m128i & row0a, const __m128i & row1a, const __m128i & row0b, const __m128i & row1b)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_packs_epi32(_mm_madd_epi16(_mm_add_epi16(row0a, row1a), ones), _mm_madd_epi16(_mm_add_epi16(row0b, row1b), ones));
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+}
+#endif
+
+/*!
+    Converts 8-bit RGB(A) or BGR(A) pixel data to planar YUV 4:2:0 (I420) using BT.601 studio range coefficients.
+    Chroma is the average of each 2x2 block (center sited, as in Y4M's C420jpeg), odd edges are replicated.
+
+    \param src pointer to the pixel data
+    \param width the width in pixels
+    \param height the height in pixels
+    \param channels number of channels per pixel (3 or 4), alpha is ignored
+    \param isBGR true if the red and blue channels are swapped in src
+    \param flipVertical true if src is stored bottom-up (as read back from OpenGL)
+    \param dstY luma plane of width x height bytes
+    \param dstU chroma plane of ((width+1)/2) x ((height+1)/2) bytes
+    \param dstV chroma plane of ((width+1)/2) x ((height+1)/2) bytes
+*/
+void sgct_core::Image::convertToI420(const unsigned char * src, std::size_t width, std::size_t height, std::size_t channels,
+    bool isBGR, bool flipVertical, unsigned char * dstY, unsigned char * dstU, unsigned char * dstV)
+{
+    if (src == nullptr || dstY == nullptr || dstU == nullptr || dstV == nullptr || width == 0 || height == 0 || channels < 3)
+        return;
+
+    const std::size_t ri = isBGR ? 2 : 0;
+    const std::size_t bi = isBGR ? 0 : 2;
+    const std::size_t rowSize = width * channels;
+    const std::size_t chromaWidth = (width + 1) / 2;
+
+#if SGCT_IMAGE_SSE2
+    const __m128i rShift = _mm_cvtsi32_si128(static_cast<int>(ri * 8));
+    const __m128i bShift = _mm_cvtsi32_si128(static_cast<int>(bi * 8));
+#endif
+
+    for (std::size_t cy = 0; cy < (height + 1) / 2; cy++)
+    {
+        std::size_t y0 = cy * 2;
+        std::size_t y1 = (y0 + 1 < height) ? y0 + 1 : y0;
+        const unsigned char * s0 = src + (flipVertical ? height - 1 - y0 : y0) * rowSize;
+        const unsigned char * s1 = src + (flipVertical ? height - 1 - y1 : y1) * rowSize;
+        unsigned char * outY0 = dstY + y0 * width;
+        unsigned char * outY1 = dstY + y1 * width;
+        unsigned char * outU = dstU + cy * chromaWidth;
+        unsigned char * outV = dstV + cy * chromaWidth;
+
+        std::size_t x = 0;
+
+        if (channels == 4)
+        {
+#if SGCT_IMAGE_SSE2
+            for (; x + 16 <= width; x += 16)
+            {
+                __m128i r0a, g0a, b0a, r0b, g0b, b0b, r1a, g1a, b1a, r1b, g1b, b1b;
+                splitChannels(s0 + x * 4, rShift, bShift, r0a, g0a, b0a);
+                splitChannels(s0 + x * 4 + 32, rShift, bShift, r0b, g0b, b0b);
+                splitChannels(s1 + x * 4, rShift, bShift, r1a, g1a, b1a);
+                splitChannels(s1 + x * 4 + 32, rShift, bShift, r1b, g1b, b1b);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(outY0 + x), _mm_packus_epi16(lumaBT601(r0a, g0a, b0a), lumaBT601(r0b, g0b, b0b)));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(outY1 + x), _mm_packus_epi16(lumaBT601(r1a, g1a, b1a), lumaBT601(r1b, g1b, b1b)));
+
+                __m128i r = average2x2(r0a, r1a, r0b, r1b);
+                __m128i g = average2x2(g0a, g1a, g0b, g1b);
+                __m128i b = average2x2(b0a, b1a, b0b, b1b);
+
+                //signed 16-bit math, the largest magnitude is 112 * 255 + 128
+                const __m128i bias = _mm_set1_epi16(128);
+                __m128i u = _mm_sub_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(112)), _mm_mullo_epi16(r, _mm_set1_epi16(38)));
+                u = _mm_sub_epi16(u, _mm_mullo_epi16(g, _mm_set1_epi16(74)));
+                u = _mm_add_epi16(_mm_srai_epi16(_mm_add_epi16(u, bias), 8), bias);
+                __m128i v = _mm_sub_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(112)), _mm_mullo_epi16(g, _mm_set1_epi16(94)));
+                v = _mm_sub_epi16(v, _mm_mullo_epi16(b, _mm_set1_epi16(18)));
+                v = _mm_add_epi16(_mm_srai_epi16(_mm_add_epi16(v, bias), 8), bias);
+
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(outU + x / 2), _mm_packus_epi16(u, u));
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(outV + x / 2), _mm_packus_epi16(v, v));
+            }
+#elif SGCT_IMAGE_NEON
+            for (; x + 16 <= width; x += 16)
+            {
+                uint8x16x4_t p0 = vld4q_u8(s0 + x * 4);
+                uint8x16x4_t p1 = vld4q_u8(s1 + x * 4);
+                const uint8x8_t k66 = vdup_n_u8(66);
+                const uint8x8_t k129 = vdup_n_u8(129);
+                const uint8x8_t k25 = vdup_n_u8(25);
+                const uint8x8_t k16 = vdup_n_u8(16);
+
+                const uint8x16x4_t * rows[2] = { &p0, &p1 };
+                unsigned char * outs[2] = { outY0 + x, outY1 + x };
+                for (int i = 0; i < 2; i++)
+                {
+                    const uint8x16x4_t & p = *rows[i];
+                    uint16x8_t lo = vmull_u8(vget_low_u8(p.val[ri]), k66);
+                    lo = vmlal_u8(lo, vget_low_u8(p.val[1]), k129);
+                    lo = vmlal_u8(lo, vget_low_u8(p.val[bi]), k25);
+                    uint16x8_t hi = vmull_u8(vget_high_u8(p.val[ri]), k66);
+                    hi = vmlal_u8(hi, vget_high_u8(p.val[1]), k129);
+                    hi = vmlal_u8(hi, vget_high_u8(p.val[bi]), k25);
+                    vst1q_u8(outs[i], vcombine_u8(vadd_u8(vrshrn_n_u16(lo, 8), k16), vadd_u8(vrshrn_n_u16(hi, 8), k16)));
+                }
+
+                int16x8_t r = vreinterpretq_s16_u16(vrshrq_n_u16(vpadalq_u8(vpaddlq_u8(p0.val[ri]), p1.val[ri]), 2));
+                int16x8_t g = vreinterpretq_s16_u16(vrshrq_n_u16(vpadalq_u8(vpaddlq_u8(p0.val[1]), p1.val[1]), 2));
+                int16x8_t b = vreinterpretq_s16_u16(vrshrq_n_u16(vpadalq_u8(vpaddlq_u8(p0.val[bi]), p1.val[bi]), 2));
+
+                const int16x8_t bias = vdupq_n_s16(128);
+                int16x8_t u = vmulq_n_s16(b, 112);
+                u = vmlsq_n_s16(u, r, 38);
+                u = vmlsq_n_s16(u, g, 74);
+                u = vaddq_s16(vshrq_n_s16(vaddq_s16(u, bias), 8), bias);
+                int16x8_t v = vmulq_n_s16(r, 112);
+                v = vmlsq_n_s16(v, g, 94);
+                v = vmlsq_n_s16(v, b, 18);
+                v = vaddq_s16(vshrq_n_s16(vaddq_s16(v, bias), 8), bias);
+
+                vst1_u8(outU + x / 2, vqmovun_s16(u));
+                vst1_u8(outV + x / 2, vqmovun_s16(v));
+            }
+#endif
+        }
+
+        for (; x < width; x += 2)
+        {
+            std::size_t x1 = (x + 1 < width) ? x + 1 : x;
+            const unsigned char * p[4] = { s0 + x * channels, s0 + x1 * channels, s1 + x * channels, s1 + x1 * channels };
+            unsigned char * outs[4] = { outY0 + x, outY0 + x1, outY1 + x, outY1 + x1 };
+
+            int r = 0, g = 0, b = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                int pr = p[i][ri];
+                int pg = p[i][1];
+                int pb = p[i][bi];
+                *outs[i] = static_cast<unsigned char>(((66 * pr + 129 * pg + 25 * pb + 128) >> 8) + 16);
+                r += pr;
+                g += pg;
+                b += pb;
+            }
+
+            r = (r + 2) >> 2;
+            g = (g + 2) >> 2;
+            b = (b + 2) >> 2;
+            outU[x / 2] = static_cast<unsigned char>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            outV[x / 2] = static_cast<unsigned char>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
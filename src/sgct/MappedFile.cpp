@@ -0,0 +1,131 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifdef __WIN32__
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include <sgct/MappedFile.h>
+#include <stdio.h>
+
+sgct_core::MappedFile::MappedFile()
+{
+    mData = nullptr;
+    mSize = 0;
+    mMapped = false;
+    mFileHandle = nullptr;
+    mMappingHandle = nullptr;
+}
+
+sgct_core::MappedFile::~MappedFile()
+{
+    close();
+}
+
+/*!
+    Maps a file for reading. A previously opened file is closed first.
+    \returns false if the file can't be read
+*/
+bool sgct_core::MappedFile::open(const std::string & path)
+{
+    close();
+
+#ifdef __WIN32__
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            void * view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (view)
+            {
+                mFileHandle = file;
+                mMappingHandle = mapping;
+                mData = reinterpret_cast<const unsigned char *>(view);
+                mSize = static_cast<std::size_t>(size.QuadPart);
+                mMapped = true;
+                return true;
+            }
+
+            if (mapping)
+                CloseHandle(mapping);
+        }
+        CloseHandle(file);
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void * view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED)
+            {
+                ::close(fd); //the mapping stays valid
+                mData = reinterpret_cast<const unsigned char *>(view);
+                mSize = static_cast<std::size_t>(info.st_size);
+                mMapped = true;
+                return true;
+            }
+        }
+        ::close(fd);
+    }
+#endif
+
+    //fall back on reading the file (empty files, pipes or file systems without mapping support)
+    FILE * fp = nullptr;
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    if (fopen_s(&fp, path.c_str(), "rb") != 0)
+        fp = nullptr;
+#else
+    fp = fopen(path.c_str(), "rb");
+#endif
+    if (fp == nullptr)
+        return false;
+
+    unsigned char chunk[65536];
+    std::size_t count;
+    while ((count = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+        mBuffer.insert(mBuffer.end(), chunk, chunk + count);
+    fclose(fp);
+
+    mData = mBuffer.empty() ? nullptr : mBuffer.data();
+    mSize = mBuffer.size();
+    return true;
+}
+
+void sgct_core::MappedFile::close()
+{
+    if (mMapped)
+    {
+#ifdef __WIN32__
+        UnmapViewOfFile(mData);
+        CloseHandle(reinterpret_cast<HANDLE>(mMappingHandle));
+        CloseHandle(reinterpret_cast<HANDLE>(mFileHandle));
+#else
+        munmap(const_cast<unsigned char *>(mData), mSize);
+#endif
+    }
+
+    mData = nullptr;
+    mSize = 0;
+    mMapped = false;
+    mFileHandle = nullptr;
+    mMappingHandle = nullptr;
+    mBuffer.clear();
+}
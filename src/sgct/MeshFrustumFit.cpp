@@ -0,0 +1,114 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/MeshFrustumFit.h>
+#include <sgct/CorrectionMesh.h>
+#include <cmath>
+
+namespace
+{
+    //fits closer than this to the whole image are not worth rendering to a new frustum
+    const float MinimumGain = 1.0e-4f;
+
+    inline float toTangent(float degrees)
+    {
+        return tanf(glm::radians<float>(degrees));
+    }
+
+    inline float toDegrees(float tangent)
+    {
+        return glm::degrees<float>(atanf(tangent));
+    }
+}
+
+/*!
+Find the field of view that covers the texture coordinates of the mesh.
+
+\param vertices the mesh, texture coordinates are in the window and cover area
+\param numberOfVertices the number of vertices in the mesh
+\param fov the field of view of the whole image, up, down, left and right in degrees
+\param area the viewport position and size (x, y, xSize, ySize) the texture coordinates are mapped into
+\param bounds the fitted field of view and the texture coordinates it covers
+
+@return true if the fitted field of view is smaller than fov
+*/
+bool sgct_core::MeshFrustumFit::compute(const CorrectionMeshVertex * vertices, unsigned int numberOfVertices, const float fov[4],
+    const glm::vec4 & area, Bounds & bounds)
+{
+    for (int i = 0; i < 4; i++)
+        bounds.mFov[i] = fov[i];
+    bounds.mTexCoordRect[0] = 0.0f;
+    bounds.mTexCoordRect[1] = 0.0f;
+    bounds.mTexCoordRect[2] = 1.0f;
+    bounds.mTexCoordRect[3] = 1.0f;
+
+    if (numberOfVertices == 0 || area.z <= 0.0f || area.w <= 0.0f)
+        return false;
+
+    /*
+        Plain min/max reductions over the texture coordinates, kept free of branches and calls so the compiler can
+        vectorize them. NaN coordinates fail the comparisons and are ignored.
+    */
+    float sMin = vertices[0].s;
+    float sMax = vertices[0].s;
+    float tMin = vertices[0].t;
+    float tMax = vertices[0].t;
+    for (unsigned int i = 1; i < numberOfVertices; i++)
+    {
+        const float s = vertices[i].s;
+        const float t = vertices[i].t;
+        sMin = s < sMin ? s : sMin;
+        sMax = s > sMax ? s : sMax;
+        tMin = t < tMin ? t : tMin;
+        tMax = t > tMax ? t : tMax;
+    }
+
+    //to the viewport
+    float rect[4];
+    rect[0] = glm::clamp((sMin - area.x) / area.z, 0.0f, 1.0f);
+    rect[1] = glm::clamp((tMin - area.y) / area.w, 0.0f, 1.0f);
+    rect[2] = glm::clamp((sMax - area.x) / area.z, 0.0f, 1.0f);
+    rect[3] = glm::clamp((tMax - area.y) / area.w, 0.0f, 1.0f);
+
+    if (!(rect[2] > rect[0] && rect[3] > rect[1]))
+        return false;
+    if (rect[0] < MinimumGain && rect[1] < MinimumGain && rect[2] > 1.0f - MinimumGain && rect[3] > 1.0f - MinimumGain)
+        return false;
+
+    //the texture coordinates are linear in the tangents of the view plane
+    float tanUp = toTangent(fov[0]);
+    float tanDown = toTangent(fov[1]);
+    float tanLeft = toTangent(fov[2]);
+    float tanRight = toTangent(fov[3]);
+
+    bounds.mFov[0] = toDegrees(tanDown + rect[3] * (tanUp - tanDown));
+    bounds.mFov[1] = toDegrees(tanDown + rect[1] * (tanUp - tanDown));
+    bounds.mFov[2] = toDegrees(tanLeft + rect[0] * (tanRight - tanLeft));
+    bounds.mFov[3] = toDegrees(tanLeft + rect[2] * (tanRight - tanLeft));
+    for (int i = 0; i < 4; i++)
+        bounds.mTexCoordRect[i] = rect[i];
+
+    return true;
+}
+
+/*!
+Stretch the texture coordinates of the mesh so that the fitted field of view covers the whole viewport.
+*/
+void sgct_core::MeshFrustumFit::remapTexCoords(CorrectionMeshVertex * vertices, unsigned int numberOfVertices, const glm::vec4 & area,
+    const Bounds & bounds)
+{
+    const float sScale = 1.0f / (bounds.mTexCoordRect[2] - bounds.mTexCoordRect[0]);
+    const float tScale = 1.0f / (bounds.mTexCoordRect[3] - bounds.mTexCoordRect[1]);
+    const float sOffset = area.x + bounds.mTexCoordRect[0] * area.z;
+    const float tOffset = area.y + bounds.mTexCoordRect[1] * area.w;
+
+    for (unsigned int i = 0; i < numberOfVertices; i++)
+    {
+        vertices[i].s = area.x + (vertices[i].s - sOffset) * sScale;
+        vertices[i].t = area.y + (vertices[i].t - tOffset) * tScale;
+    }
+}
@@ -0,0 +1,447 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/MeshTextReader.h>
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    #define _sscanf sscanf_s
+#else
+    #define _sscanf sscanf
+#endif
+
+namespace
+{
+    //powers of ten that are exact in double precision
+    const double EXACT_POWERS_OF_TEN[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const int MAX_EXACT_POWER_OF_TEN = 22;
+    const unsigned long long MAX_EXACT_MANTISSA = 1ULL << 53;
+    const int MAX_MANTISSA_DIGITS = 19;
+    const int MAX_INT_DIGITS = 9;
+
+    inline bool isSpace(char c)
+    {
+        //isspace in the C locale, without the locale lookup
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    inline bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    /*!
+        Decimal number split into mantissa and power of ten. The number is valid if it has at least one digit and
+        the exponent, if any, has digits. Numbers that need the C library are marked as not simple.
+    */
+    struct DecimalNumber
+    {
+        unsigned long long mMantissa;
+        int mExponent;
+        bool mNegative;
+        bool mSimple;
+        const char * mEnd;
+    };
+
+    void scanDecimal(const char * p, const char * end, DecimalNumber & number)
+    {
+        number.mMantissa = 0;
+        number.mExponent = 0;
+        number.mNegative = false;
+        number.mSimple = false;
+
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            number.mNegative = (*p == '-');
+            p++;
+        }
+
+        int digits = 0; //significant digits in the mantissa
+        bool anyDigit = false;
+        while (p < end && isDigit(*p))
+        {
+            if (number.mMantissa != 0 || *p != '0')
+            {
+                number.mMantissa = number.mMantissa * 10ULL + static_cast<unsigned long long>(*p - '0');
+                digits++;
+            }
+            anyDigit = true;
+            p++;
+            if (digits > MAX_MANTISSA_DIGITS)
+                return;
+        }
+
+        if (p < end && *p == '.')
+        {
+            p++;
+            while (p < end && isDigit(*p))
+            {
+                if (number.mMantissa != 0 || *p != '0')
+                {
+                    number.mMantissa = number.mMantissa * 10ULL + static_cast<unsigned long long>(*p - '0');
+                    digits++;
+                }
+                number.mExponent--;
+                anyDigit = true;
+                p++;
+                if (digits > MAX_MANTISSA_DIGITS)
+                    return;
+            }
+        }
+
+        //no digits means inf, nan or no number at all, and 0x starts a hexadecimal number
+        if (!anyDigit || (p < end && (*p == 'x' || *p == 'X')))
+            return;
+
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            p++;
+            bool negativeExponent = false;
+            if (p < end && (*p == '-' || *p == '+'))
+            {
+                negativeExponent = (*p == '-');
+                p++;
+            }
+
+            if (p >= end || !isDigit(*p))
+                return;
+
+            int exponent = 0;
+            while (p < end && isDigit(*p))
+            {
+                if (exponent < 100000)
+                    exponent = exponent * 10 + (*p - '0');
+                p++;
+            }
+            number.mExponent += negativeExponent ? -exponent : exponent;
+        }
+
+        number.mEnd = p;
+        number.mSimple = true;
+    }
+
+    /*!
+        Correctly rounded conversion if both the mantissa and the power of ten are exact in double precision,
+        since the result is then rounded only once.
+    */
+    bool decimalToDouble(const DecimalNumber & number, double & value)
+    {
+        if (number.mMantissa == 0)
+        {
+            value = number.mNegative ? -0.0 : 0.0;
+            return true;
+        }
+
+        if (number.mMantissa > MAX_EXACT_MANTISSA || number.mExponent > MAX_EXACT_POWER_OF_TEN || number.mExponent < -MAX_EXACT_POWER_OF_TEN)
+            return false;
+
+        double mantissa = static_cast<double>(number.mMantissa);
+        value = number.mExponent < 0 ?
+            mantissa / EXACT_POWERS_OF_TEN[-number.mExponent] :
+            mantissa * EXACT_POWERS_OF_TEN[number.mExponent];
+        if (number.mNegative)
+            value = -value;
+        return true;
+    }
+
+    /*!
+        Rounding the double to float gives the correctly rounded float unless the double landed exactly half way
+        between two floats, where the first rounding may have hidden which way to go.
+    */
+    bool decimalToFloat(const DecimalNumber & number, float & value)
+    {
+        double d;
+        if (!decimalToDouble(number, d))
+            return false;
+
+        if (d == 0.0)
+        {
+            value = static_cast<float>(d);
+            return true;
+        }
+
+        double magnitude = d < 0.0 ? -d : d;
+        if (magnitude < static_cast<double>(FLT_MIN) || magnitude > static_cast<double>(FLT_MAX))
+            return false;
+
+        unsigned long long bits;
+        memcpy(&bits, &d, sizeof(bits));
+        //the 29 mantissa bits that a float drops
+        if ((bits & 0x1FFFFFFFULL) == 0x10000000ULL)
+            return false;
+
+        value = static_cast<float>(d);
+        return true;
+    }
+}
+
+sgct_core::MeshTextReader::MeshTextReader(std::size_t maxLineLength)
+{
+    mMaxLineLength = maxLineLength > 1 ? maxLineLength : 2;
+    mBegin = nullptr;
+    mEnd = nullptr;
+    mLineBegin = nullptr;
+    mLineEnd = nullptr;
+    mPos = nullptr;
+    mScratch.resize(mMaxLineLength);
+}
+
+/*!
+    Maps a text file for reading.
+    \returns false if the file can't be read
+*/
+bool sgct_core::MeshTextReader::open(const std::string & path)
+{
+    close();
+    if (!mFile.open(path))
+        return false;
+
+    mBegin = reinterpret_cast<const char *>(mFile.getData());
+    mEnd = mBegin + mFile.getSize();
+    mLineBegin = mLineEnd = mPos = mBegin;
+    return true;
+}
+
+/*!
+    Reads text from memory. The data must stay valid until the reader is closed.
+*/
+void sgct_core::MeshTextReader::open(const char * data, std::size_t size)
+{
+    close();
+    mBegin = data;
+    mEnd = data != nullptr ? data + size : nullptr;
+    mLineBegin = mLineEnd = mPos = mBegin;
+}
+
+void sgct_core::MeshTextReader::close()
+{
+    mFile.close();
+    mBegin = mEnd = mLineBegin = mLineEnd = mPos = nullptr;
+}
+
+/*!
+    Moves to the next line, including its newline character.
+    \returns false at the end of the text
+*/
+bool sgct_core::MeshTextReader::nextLine()
+{
+    if (mLineEnd >= mEnd)
+        return false;
+
+    mLineBegin = mLineEnd;
+    std::size_t remaining = static_cast<std::size_t>(mEnd - mLineBegin);
+    std::size_t length = remaining < mMaxLineLength - 1 ? remaining : mMaxLineLength - 1;
+    const char * newline = reinterpret_cast<const char *>(memchr(mLineBegin, '\n', length));
+    mLineEnd = newline != nullptr ? newline + 1 : mLineBegin + length;
+    mPos = mLineBegin;
+    return true;
+}
+
+void sgct_core::MeshTextReader::skipSpace()
+{
+    while (mPos < mLineEnd && isSpace(*mPos))
+        mPos++;
+}
+
+/*!
+    Matches literal text the way a scanf format does: white space matches any amount of white space (also none)
+    and other characters must match exactly.
+*/
+bool sgct_core::MeshTextReader::match(const char * literal)
+{
+    for (const char * c = literal; *c != '\0'; c++)
+    {
+        if (isSpace(*c))
+            skipSpace();
+        else if (mPos < mLineEnd && *mPos == *c)
+            mPos++;
+        else
+            return false;
+    }
+    return true;
+}
+
+/*!
+    Runs sscanf on a copy of the rest of the line. The format must end with %n.
+    \returns the number of characters consumed or -1 if the conversion failed
+*/
+int sgct_core::MeshTextReader::fallbackScan(const char * format, void * value)
+{
+    std::size_t length = static_cast<std::size_t>(mLineEnd - mPos);
+    memcpy(&mScratch[0], mPos, length);
+    mScratch[length] = '\0';
+
+    int consumed = 0;
+    if (_sscanf(&mScratch[0], format, value, &consumed) != 1)
+        return -1;
+    return consumed;
+}
+
+/*!
+    Same as the %f conversion.
+*/
+bool sgct_core::MeshTextReader::readFloat(float & value)
+{
+    skipSpace();
+
+    DecimalNumber number;
+    scanDecimal(mPos, mLineEnd, number);
+    if (number.mSimple && decimalToFloat(number, value))
+    {
+        mPos = number.mEnd;
+        return true;
+    }
+
+    int consumed = fallbackScan("%f%n", &value);
+    if (consumed < 0)
+        return false;
+    mPos += consumed;
+    return true;
+}
+
+/*!
+    Same as the %lf conversion.
+*/
+bool sgct_core::MeshTextReader::readDouble(double & value)
+{
+    skipSpace();
+
+    DecimalNumber number;
+    scanDecimal(mPos, mLineEnd, number);
+    if (number.mSimple && decimalToDouble(number, value))
+    {
+        mPos = number.mEnd;
+        return true;
+    }
+
+    int consumed = fallbackScan("%lf%n", &value);
+    if (consumed < 0)
+        return false;
+    mPos += consumed;
+    return true;
+}
+
+/*!
+    Same as the %u conversion, a minus sign negates the value modulo 2^32.
+*/
+bool sgct_core::MeshTextReader::readUInt(unsigned int & value)
+{
+    skipSpace();
+
+    const char * p = mPos;
+    bool negative = false;
+    if (p < mLineEnd && (*p == '-' || *p == '+'))
+    {
+        negative = (*p == '-');
+        p++;
+    }
+
+    const char * digits = p;
+    unsigned int result = 0;
+    while (p < mLineEnd && isDigit(*p) && p - digits < MAX_INT_DIGITS)
+    {
+        result = result * 10U + static_cast<unsigned int>(*p - '0');
+        p++;
+    }
+
+    if (p == digits)
+        return false;
+
+    //more digits than always fit, let the C library handle the overflow
+    if (p < mLineEnd && isDigit(*p))
+    {
+        int consumed = fallbackScan("%u%n", &value);
+        if (consumed < 0)
+            return false;
+        mPos += consumed;
+        return true;
+    }
+
+    value = negative ? 0U - result : result;
+    mPos = p;
+    return true;
+}
+
+/*!
+    Same as the %d conversion.
+*/
+bool sgct_core::MeshTextReader::readInt(int & value)
+{
+    skipSpace();
+
+    const char * p = mPos;
+    bool negative = false;
+    if (p < mLineEnd && (*p == '-' || *p == '+'))
+    {
+        negative = (*p == '-');
+        p++;
+    }
+
+    const char * digits = p;
+    int result = 0;
+    while (p < mLineEnd && isDigit(*p) && p - digits < MAX_INT_DIGITS)
+    {
+        result = result * 10 + (*p - '0');
+        p++;
+    }
+
+    if (p == digits)
+        return false;
+
+    if (p < mLineEnd && isDigit(*p))
+    {
+        int consumed = fallbackScan("%d%n", &value);
+        if (consumed < 0)
+            return false;
+        mPos += consumed;
+        return true;
+    }
+
+    value = negative ? -result : result;
+    mPos = p;
+    return true;
+}
+
+/*!
+    Same as the %s conversion with a width of bufferSize - 1. The result is always null terminated.
+*/
+bool sgct_core::MeshTextReader::readWord(char * buffer, std::size_t bufferSize)
+{
+    skipSpace();
+
+    std::size_t length = 0;
+    while (mPos < mLineEnd && !isSpace(*mPos) && *mPos != '\0' && length + 1 < bufferSize)
+        buffer[length++] = *mPos++;
+
+    if (bufferSize > 0)
+        buffer[length] = '\0';
+    return length > 0;
+}
+
+/*!
+    Same as the %*f conversion.
+*/
+bool sgct_core::MeshTextReader::skipFloat()
+{
+    float value;
+    return readFloat(value);
+}
+
+/*!
+    Same as the %*d conversion.
+*/
+bool sgct_core::MeshTextReader::skipInt()
+{
+    int value;
+    return readInt(value);
+}
@@ -9,6 +9,7 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #include <sgct/MessageHandler.h>
 #include <sgct/ClusterManager.h>
 #include <sgct/SGCTMutexManager.h>
+#include <sgct/MessageRing.h>
 #include <sgct/helpers/SGCTPortedFunctions.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -16,6 +17,8 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #include <sstream>
 #include <string.h>
 #include <time.h>
+#include <chrono>
+#include <algorithm>
 
 sgct::MessageHandler * sgct::MessageHandler::mInstance = nullptr;
 
@@ -58,11 +61,28 @@ sgct::MessageHandler::MessageHandler()
     mLogToCallback = false;
     mMessageCallback = SGCT_NULL_PTR;
 
+    mRing = nullptr;
+    mWriterThread = nullptr;
+    mAsync = false;
+    mWriterRunning = false;
+    mWriterSleeping = false;
+    mFlushRequested = false;
+    mActiveProducers = 0;
+    mOverflowPolicy = DROP_MESSAGE;
+    mFlushLevel = NOTIFY_ERROR;
+    mFlushIntervalMs = 1000;
+    mDroppedMessages = 0;
+    mPushedMessages = 0;
+    mWrittenMessages = 0;
+    mLogFile = nullptr;
+
     setLogPath(nullptr);
 }
 
 sgct::MessageHandler::~MessageHandler()
 {
+    //write what is left in the ring before the callback is removed
+    stopWriter();
     mMessageCallback = SGCT_NULL_PTR;
 
     if(mParseBuffer)
@@ -91,8 +111,18 @@ void sgct::MessageHandler::decode(const char * receivedData, int receivedlength,
     SGCTMutexManager::instance()->unlockMutex( SGCTMutexManager::DataSyncMutex );
 }
 
-void sgct::MessageHandler::printv(const char *fmt, va_list ap)
+void sgct::MessageHandler::printv(NotifyLevel nl, const char *fmt, va_list ap)
 {
+    //the writer is only stopped when no producer is between these two checks
+    mActiveProducers++;
+    if (mAsync)
+    {
+        printAsync(nl, fmt, ap);
+        mActiveProducers--;
+        return;
+    }
+    mActiveProducers--;
+
     //prevent writing to console simultaneously
     SGCTMutexManager::instance()->lockMutex( SGCTMutexManager::ConsoleMutex );
 
@@ -134,30 +164,87 @@ void sgct::MessageHandler::printv(const char *fmt, va_list ap)
 #else
         sprintf( mCombinedBuffer, "%s| %s", getTimeOfDayStr(), mParseBuffer );
 #endif
-        if(mLogToConsole)
-            std::cerr << mCombinedBuffer;
-
-        if(mLogToFile)
-            logToFile( mCombinedBuffer );
-        if (mLogToCallback && mMessageCallback != SGCT_NULL_PTR)
-            mMessageCallback( mCombinedBuffer );
+        writeMessage( mCombinedBuffer, false );
     }
     else
+        writeMessage( mParseBuffer, false );
+
+    SGCTMutexManager::instance()->unlockMutex( SGCTMutexManager::ConsoleMutex );
+
+    //if client send to server
+    sendMessageToServer(mParseBuffer);
+}
+
+/*!
+Format on the calling thread and hand the message to the writer thread without locking.
+*/
+void sgct::MessageHandler::printAsync(NotifyLevel nl, const char *fmt, va_list ap)
+{
+    char stackBuffer[1024];
+    std::vector<char> heapBuffer;
+    char * buffer = stackBuffer;
+
+    std::size_t offset = 0;
+    if (getShowTime())
     {
-        if (mLogToConsole)
-            std::cerr << mParseBuffer;
+        formatTimeOfDay(stackBuffer);
+        offset = strlen(stackBuffer);
+        stackBuffer[offset++] = '|';
+        stackBuffer[offset++] = ' ';
+    }
 
-        if(mLogToFile)
-            logToFile( mParseBuffer );
-        if (mLogToCallback && mMessageCallback != SGCT_NULL_PTR)
-            mMessageCallback( mParseBuffer );
+    int formattedSize = vscprintf(fmt, ap);
+    if (formattedSize < 0)
+        return;
 
+    auto size = static_cast<std::size_t>(1 + formattedSize);
+    if (offset + size > sizeof(stackBuffer))
+    {
+        heapBuffer.resize(offset + size);
+        memcpy(&heapBuffer[0], stackBuffer, offset);
+        buffer = &heapBuffer[0];
     }
 
-    SGCTMutexManager::instance()->unlockMutex( SGCTMutexManager::ConsoleMutex );
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    vsprintf_s(buffer + offset, size, fmt, ap);
+#else
+    vsprintf(buffer + offset, fmt, ap);
+#endif
+
+    if (mRing->push(nl, buffer, offset + size - 1, mOverflowPolicy == BLOCK_CALLER))
+    {
+        mPushedMessages++;
+        //a sleeping writer is woken up, a busy one finds the message anyway
+        if (mWriterSleeping || nl <= mFlushLevel)
+            mWriterCondition.notify_one();
+    }
+    else
+        mDroppedMessages++;
 
     //if client send to server
-    sendMessageToServer(mParseBuffer);
+    sendMessageToServer(buffer + offset);
+}
+
+/*!
+Write a formatted message to the enabled outputs.
+
+\param keepFileOpen true for the writer thread, which keeps the log file open between messages
+*/
+void sgct::MessageHandler::writeMessage(const char * buffer, bool keepFileOpen)
+{
+    if (mLogToConsole)
+        std::cerr << buffer;
+
+    if (mLogToFile)
+    {
+        if (keepFileOpen)
+            writeToOpenLogFile(buffer);
+        else
+            logToFile(buffer);
+    }
+
+    if (mLogToCallback && mMessageCallback != SGCT_NULL_PTR)
+        mMessageCallback(buffer);
 }
 
 void sgct::MessageHandler::logToFile(const char * buffer)
@@ -223,7 +310,10 @@ void sgct::MessageHandler::setLogPath(const char * path, int nodeId)
         ss << tmpBuff << ".txt";
 #endif
 
+    //the asynchronous writer reads the filename with the console mutex locked
+    SGCTMutexManager::instance()->lockMutex( SGCTMutexManager::ConsoleMutex );
     mFilename.assign(ss.str());
+    SGCTMutexManager::instance()->unlockMutex( SGCTMutexManager::ConsoleMutex );
 }
 
 /*!
@@ -239,7 +329,7 @@ void sgct::MessageHandler::print(const char *fmt, ...)
 
     va_list        ap;        // Pointer To List Of Arguments
     va_start(ap, fmt);    // Parses The String For Variables
-    printv(fmt, ap);
+    printv(NOTIFY_ALL, fmt, ap);
     va_end(ap);
 }
 
@@ -258,7 +348,7 @@ void sgct::MessageHandler::print(NotifyLevel nl, const char *fmt, ...)
 
     va_list        ap;        // Pointer To List Of Arguments
     va_start(ap, fmt);    // Parses The String For Variables
-    printv(fmt, ap);
+    printv(nl, fmt, ap);
     va_end(ap);
 }
 
@@ -345,24 +435,269 @@ void sgct::MessageHandler::setLogCallback(sgct_cppxeleven::function<void(const c
     mMessageCallback = fn;
 }
 
+/*!
+Enable or disable asynchronous logging. Prints then only format the message on the calling thread and add it to
+a lock-free ring, and a writer thread does the console, file and callback output. The log file is kept open and
+flushed every flush interval, or right away for messages at the flush level or higher priority. Callbacks are
+invoked on the writer thread. Disabling writes every message that is still in the ring.
+
+\param state true to enable asynchronous logging
+\param numberOfRecords the size of the ring in records of 256 bytes, a message takes one record per 240 chars
+*/
+void sgct::MessageHandler::setAsyncLogging(bool state, std::size_t numberOfRecords)
+{
+    stopWriter();
+    if (state)
+        startWriter(numberOfRecords);
+}
+
+/*!
+Get if asynchronous logging is enabled
+*/
+bool sgct::MessageHandler::getAsyncLogging()
+{
+    return mAsync.load();
+}
+
+/*!
+Set if an asynchronous print drops the message or waits for the writer when the ring is full. Dropping is the
+default, dropped messages are counted and reported in the log. A log callback must not print when the caller
+is blocked, since the callback is invoked by the writer it would wait for.
+*/
+void sgct::MessageHandler::setAsyncOverflowPolicy(OverflowPolicy policy)
+{
+    mOverflowPolicy = policy;
+}
+
+/*!
+Set the time in seconds between flushes of the log file in asynchronous mode, one second by default
+*/
+void sgct::MessageHandler::setAsyncFlushInterval(double seconds)
+{
+    mFlushIntervalMs = std::max(1, static_cast<int>(seconds * 1000.0));
+}
+
+/*!
+Set the lowest priority notify level that flushes the log file right away in asynchronous mode. NOTIFY_ERROR is the
+default.
+*/
+void sgct::MessageHandler::setAsyncFlushLevel(NotifyLevel nl)
+{
+    mFlushLevel = nl;
+}
+
+/*!
+Get the number of messages dropped because the asynchronous ring was full
+*/
+unsigned long long sgct::MessageHandler::getNumberOfDroppedMessages()
+{
+    return mDroppedMessages.load();
+}
+
+/*!
+Block until every message printed so far is written and the log file is flushed. Does nothing if asynchronous
+logging is disabled, since messages are then written before print returns.
+*/
+void sgct::MessageHandler::flush()
+{
+    if (!mAsync)
+        return;
+
+    unsigned long long target = mPushedMessages.load();
+    std::unique_lock<std::mutex> lock(mWriterMutex);
+    mFlushRequested = true;
+    mWriterCondition.notify_one();
+    mFlushedCondition.wait(lock, [this, target]() { return mWrittenMessages >= target || !mWriterRunning; });
+}
+
+void sgct::MessageHandler::startWriter(std::size_t numberOfRecords)
+{
+    mRing = new sgct_core::MessageRing(numberOfRecords);
+    mWrittenMessages = 0;
+    mPushedMessages = 0;
+    mWriterRunning = true;
+    mWriterThread = new (std::nothrow) std::thread(&MessageHandler::writerLoop, this);
+    if (mWriterThread == nullptr)
+    {
+        mWriterRunning = false;
+        delete mRing;
+        mRing = nullptr;
+        return;
+    }
+
+    mAsync = true;
+}
+
+void sgct::MessageHandler::stopWriter()
+{
+    if (mWriterThread == nullptr)
+        return;
+
+    //new prints go the synchronous way, wait for the ones that already took the asynchronous one
+    mAsync = false;
+    while (mActiveProducers > 0)
+        std::this_thread::yield();
+
+    {
+        std::unique_lock<std::mutex> lock(mWriterMutex);
+        mWriterRunning = false;
+    }
+    mWriterCondition.notify_one();
+    mWriterThread->join();
+    delete mWriterThread;
+    mWriterThread = nullptr;
+    mFlushedCondition.notify_all();
+
+    delete mRing;
+    mRing = nullptr;
+}
+
+void sgct::MessageHandler::writerLoop()
+{
+    std::string text;
+    int level;
+    unsigned long long reportedDrops = mDroppedMessages.load();
+    auto lastFlush = std::chrono::steady_clock::now();
+    auto lastReport = lastFlush;
+    bool unflushed = false;
+
+    for (;;)
+    {
+        //read before draining, so that everything pushed before a stop is written
+        bool running = mWriterRunning;
+        bool flushNow = mFlushRequested.exchange(false);
+        unsigned long long written = 0;
+
+        SGCTMutexManager::instance()->lockMutex( SGCTMutexManager::ConsoleMutex );
+        while (mRing->pop(level, text))
+        {
+            writeMessage(text.c_str(), true);
+            written++;
+            if (level <= mFlushLevel)
+                flushNow = true;
+        }
+
+        //drops are summed up once a second
+        auto now = std::chrono::steady_clock::now();
+        unsigned long long drops = mDroppedMessages.load();
+        if (drops != reportedDrops &&
+            (!running || std::chrono::duration_cast<std::chrono::milliseconds>(now - lastReport).count() >= 1000))
+        {
+            char report[128];
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+            sprintf_s(report, sizeof(report), "MessageHandler: %llu messages were dropped, the log ring was full.\n", drops - reportedDrops);
+#else
+            sprintf(report, "MessageHandler: %llu messages were dropped, the log ring was full.\n", drops - reportedDrops);
+#endif
+            writeMessage(report, true);
+            reportedDrops = drops;
+            lastReport = now;
+        }
+
+        unflushed = unflushed || written > 0;
+        if (unflushed && (flushNow || !running ||
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - lastFlush).count() >= mFlushIntervalMs))
+        {
+            if (mLogFile != nullptr)
+                fflush(mLogFile);
+            lastFlush = now;
+            unflushed = false;
+        }
+
+        if (!running && mLogFile != nullptr)
+        {
+            fclose(mLogFile);
+            mLogFile = nullptr;
+            mLogFileName.clear();
+        }
+        SGCTMutexManager::instance()->unlockMutex( SGCTMutexManager::ConsoleMutex );
+
+        std::unique_lock<std::mutex> lock(mWriterMutex);
+        mWrittenMessages += written;
+        mFlushedCondition.notify_all();
+        if (!running)
+            break;
+
+        /*
+            Producers only notify when the writer sleeps, a message pushed just before the wait may miss the
+            notification and is written after the timeout instead.
+        */
+        mWriterSleeping = true;
+        if (mRing->isEmpty() && mWriterRunning && !mFlushRequested)
+        {
+            int timeout = unflushed ? std::min(mFlushIntervalMs.load(), 50) : 50;
+            mWriterCondition.wait_for(lock, std::chrono::milliseconds(timeout));
+        }
+        mWriterSleeping = false;
+    }
+}
+
+/*!
+Append to the log file kept open by the writer thread, which is reopened if the log path changes
+*/
+void sgct::MessageHandler::writeToOpenLogFile(const char * buffer)
+{
+    if (mFilename.empty())
+        return;
+
+    if (mLogFile != nullptr && mLogFileName != mFilename)
+    {
+        fclose(mLogFile);
+        mLogFile = nullptr;
+    }
+
+    if (mLogFile == nullptr)
+    {
+        //don't retry a file that failed to open until the path changes
+        if (mLogFileName == mFilename)
+            return;
+        mLogFileName = mFilename;
+
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+        if (fopen_s(&mLogFile, mFilename.c_str(), "a") != 0)
+            mLogFile = nullptr;
+#else
+        mLogFile = fopen(mFilename.c_str(), "a");
+#endif
+        if (mLogFile == nullptr)
+        {
+            std::cerr << "Failed to open '" << mFilename << "'!" << std::endl;
+            return;
+        }
+    }
+
+    fputs(buffer, mLogFile);
+}
+
 /*!
 Get the time of day string
 */
 const char * sgct::MessageHandler::getTimeOfDayStr()
 {
+    formatTimeOfDay(mTimeBuffer);
+    return mTimeBuffer;
+}
+
+/*!
+Write the time of day into a buffer of TIME_BUFFER_SIZE chars, safe to call from several threads
+*/
+void sgct::MessageHandler::formatTimeOfDay(char * buffer)
+{
+    buffer[0] = '\0';
     time_t now = time(nullptr);
-#if (_MSC_VER >= 1400) //visual studio 2005 or later
     struct tm timeInfo;
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
     errno_t err = localtime_s(&timeInfo, &now);
     if( err == 0 ) 
-        strftime(mTimeBuffer, TIME_BUFFER_SIZE, "%X", &timeInfo);
+        strftime(buffer, TIME_BUFFER_SIZE, "%X", &timeInfo);
+#elif defined(__WIN32__)
+    struct tm * timeInfoPtr = localtime(&now); //thread local in the windows runtime
+    if( timeInfoPtr != NULL )
+        strftime(buffer, TIME_BUFFER_SIZE, "%X", timeInfoPtr);
 #else
-    struct tm * timeInfoPtr;
-    timeInfoPtr = localtime(&now);
-    strftime(mTimeBuffer, TIME_BUFFER_SIZE, "%X", timeInfoPtr);
+    if( localtime_r(&now, &timeInfo) != NULL )
+        strftime(buffer, TIME_BUFFER_SIZE, "%X", &timeInfo);
 #endif
-
-    return mTimeBuffer;
 }
 
 char * sgct::MessageHandler::getMessage()
@@ -381,7 +716,7 @@ void sgct::MessageHandler::printDebug(NotifyLevel nl, const char *fmt, ...)
 
     va_list ap;
     va_start(ap, fmt);    // Parses The String For Variables
-    printv(fmt, ap);
+    printv(nl, fmt, ap);
     va_end(ap);
 #endif
 }
@@ -404,13 +739,13 @@ void sgct::MessageHandler::printIndent(NotifyLevel nl, unsigned int indentation,
 
         const char *fmtIndented = fmtComplete.c_str();
         va_start(ap, fmt);    // Parses The String For Variables
-        printv(fmtIndented, ap);
+        printv(nl, fmtIndented, ap);
         va_end(ap);
     }
     else
     {
         va_start(ap, fmt);    // Parses The String For Variables
-        printv(fmt, ap);
+        printv(nl, fmt, ap);
         va_end(ap);
     }
 }
@@ -0,0 +1,130 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/MessageRing.h>
+#include <thread>
+#include <cstring>
+#include <algorithm>
+
+/*!
+\param numberOfRecords rounded up to a power of two of at least MaxRecordsPerMessage
+*/
+sgct_core::MessageRing::MessageRing(std::size_t numberOfRecords)
+{
+    std::size_t capacity = MaxRecordsPerMessage;
+    while (capacity < numberOfRecords)
+        capacity <<= 1;
+
+    mRecords = new Record[capacity];
+    mMask = capacity - 1;
+    for (std::size_t i = 0; i < capacity; i++)
+        mRecords[i].mSequence.store(i, std::memory_order_relaxed);
+
+    mEnqueuePosition.store(0, std::memory_order_relaxed);
+    mDequeuePosition.store(0, std::memory_order_release);
+}
+
+sgct_core::MessageRing::~MessageRing()
+{
+    delete [] mRecords;
+}
+
+/*!
+Add a message, may be called by any number of threads at the same time.
+
+\param level the notify level of the message
+\param text the message, doesn't have to be null terminated
+\param length the length of the message, messages longer than MaxRecordsPerMessage records are truncated
+\param block wait for the consumer if the ring is full instead of dropping the message
+
+@return false if the message was dropped
+*/
+bool sgct_core::MessageRing::push(int level, const char * text, std::size_t length, bool block)
+{
+    length = std::min(length, MaxRecordsPerMessage * RecordTextSize);
+    std::size_t numberOfRecords = std::max<std::size_t>(1, (length + RecordTextSize - 1) / RecordTextSize);
+
+    std::size_t position = mEnqueuePosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        std::size_t lastPosition = position + numberOfRecords - 1;
+        std::size_t sequence = mRecords[lastPosition & mMask].mSequence.load(std::memory_order_acquire);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence - lastPosition);
+
+        if (difference == 0)
+        {
+            //position is reloaded if another producer got there first
+            if (mEnqueuePosition.compare_exchange_weak(position, position + numberOfRecords, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+        {
+            //full
+            if (!block)
+                return false;
+            std::this_thread::yield();
+            position = mEnqueuePosition.load(std::memory_order_relaxed);
+        }
+        else
+            position = mEnqueuePosition.load(std::memory_order_relaxed);
+    }
+
+    for (std::size_t i = 0; i < numberOfRecords; i++)
+    {
+        Record & record = mRecords[(position + i) & mMask];
+        std::size_t offset = i * RecordTextSize;
+        std::size_t size = std::min(RecordTextSize, length - offset);
+
+        record.mLevel = level;
+        record.mNumberOfRecords = static_cast<unsigned short>(numberOfRecords);
+        record.mLength = static_cast<unsigned short>(size);
+        if (size > 0)
+            memcpy(record.mText, text + offset, size);
+        record.mSequence.store(position + i + 1, std::memory_order_release);
+    }
+
+    return true;
+}
+
+/*!
+Take the oldest message, must only be called by one thread.
+
+@return false if there is no complete message
+*/
+bool sgct_core::MessageRing::pop(int & level, std::string & text)
+{
+    std::size_t position = mDequeuePosition.load(std::memory_order_relaxed);
+    Record & first = mRecords[position & mMask];
+    if (first.mSequence.load(std::memory_order_acquire) != position + 1)
+        return false;
+
+    //the producer publishes the records in order
+    std::size_t numberOfRecords = first.mNumberOfRecords;
+    std::size_t lastPosition = position + numberOfRecords - 1;
+    if (mRecords[lastPosition & mMask].mSequence.load(std::memory_order_acquire) != lastPosition + 1)
+        return false;
+
+    level = first.mLevel;
+    text.clear();
+    for (std::size_t i = 0; i < numberOfRecords; i++)
+    {
+        Record & record = mRecords[(position + i) & mMask];
+        text.append(record.mText, record.mLength);
+        record.mSequence.store(position + i + mMask + 1, std::memory_order_release);
+    }
+
+    mDequeuePosition.store(position + numberOfRecords, std::memory_order_release);
+    return true;
+}
+
+/*!
+@return true if no message has been claimed since the last pop, messages that are being written count
+*/
+bool sgct_core::MessageRing::isEmpty() const
+{
+    return mEnqueuePosition.load(std::memory_order_acquire) == mDequeuePosition.load(std::memory_order_acquire);
+}
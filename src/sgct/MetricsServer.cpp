@@ -0,0 +1,438 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#ifdef __WIN32__
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else //Use BSD sockets
+    #include <unistd.h>
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <sys/select.h>
+    #include <sys/time.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #define INVALID_SOCKET (SGCT_SOCKET)(~0)
+#endif
+
+#include <sgct/MetricsServer.h>
+#include <sgct/Engine.h>
+#include <sgct/MessageHandler.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define METRICS_MAX_REQUEST_SIZE 4096
+#define METRICS_ACCEPT_TIMEOUT 100 //ms, how often the server checks if it should stop
+#define METRICS_CLIENT_TIMEOUT 1000 //ms, for the whole request and for each send of the response
+
+namespace
+{
+    void appendFormat(std::string & text, const char * format, ...)
+    {
+        char buffer[512];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        if (length > 0)
+            text.append(buffer, static_cast<std::size_t>(length) < sizeof(buffer) ? static_cast<std::size_t>(length) : sizeof(buffer) - 1);
+    }
+
+    std::string escapeLabel(const std::string & value)
+    {
+        std::string out;
+        for (std::size_t i = 0; i < value.size(); i++)
+        {
+            if (value[i] == '\\' || value[i] == '"')
+                out += '\\';
+            if (value[i] == '\n')
+                out += "\\n";
+            else
+                out += value[i];
+        }
+        return out;
+    }
+
+    void writeFamily(std::string & text, const char * name, const char * type, const char * help)
+    {
+        appendFormat(text, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    }
+
+    void writePercentiles(std::string & text, const char * name, const char * help, const std::string & labels,
+        const sgct_core::Statistics::Percentiles & p)
+    {
+        //the percentiles of the statistics window, not a summary since there is no running sum and count. The
+        //quantile label is reserved for summaries, so they are gauges with a label of their own.
+        writeFamily(text, name, "gauge", help);
+        appendFormat(text, "%s{%s,percentile=\"50\"} %.9g\n", name, labels.c_str(), p.mP50);
+        appendFormat(text, "%s{%s,percentile=\"95\"} %.9g\n", name, labels.c_str(), p.mP95);
+        appendFormat(text, "%s{%s,percentile=\"99\"} %.9g\n", name, labels.c_str(), p.mP99);
+        appendFormat(text, "%s{%s,percentile=\"100\"} %.9g\n", name, labels.c_str(), p.mMax);
+
+        //a family of its own, the samples of a gauge can't have suffixes
+        std::string meanName = std::string(name) + "_mean";
+        writeFamily(text, meanName.c_str(), "gauge", help);
+        appendFormat(text, "%s{%s} %.9g\n", meanName.c_str(), labels.c_str(), p.mAvg);
+    }
+
+    bool sendAll(SGCT_SOCKET lSocket, const std::string & data)
+    {
+        std::size_t sent = 0;
+        while (sent < data.size())
+        {
+#ifdef __WIN32__
+            int result = send(lSocket, data.c_str() + sent, static_cast<int>(data.size() - sent), 0);
+#elif defined(MSG_NOSIGNAL)
+            ssize_t result = send(lSocket, data.c_str() + sent, data.size() - sent, MSG_NOSIGNAL);
+#else
+            ssize_t result = send(lSocket, data.c_str() + sent, data.size() - sent, 0);
+#endif
+            if (result <= 0)
+                return false;
+            sent += static_cast<std::size_t>(result);
+        }
+        return true;
+    }
+}
+
+sgct_core::MetricsServer::Snapshot::Snapshot()
+{
+    mTime = -1.0;
+    mNodeId = 0;
+    mMaster = false;
+    mFrameNumber = 0;
+    memset(&mReport, 0, sizeof(mReport));
+    mGPUFrameTime = -1.0;
+    mGPUDroppedFrames = 0;
+    mTrackingSamplingTime = -1.0;
+    mCapturePendingFrames = 0;
+    mCaptureDroppedFrames = 0;
+    mDroppedLogMessages = 0;
+    mDroppedTraceEvents = 0;
+}
+
+sgct_core::MetricsServer::MetricsServer()
+{
+    mListenSocket = INVALID_SOCKET;
+    mPort = 0;
+    mThread = nullptr;
+    mTerminate = false;
+}
+
+sgct_core::MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+/*!
+Start serving on 127.0.0.1.
+
+\param port the TCP port
+\returns false if the port couldn't be opened
+*/
+bool sgct_core::MetricsServer::start(int port)
+{
+    stop();
+
+#ifdef __WIN32__
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "MetricsServer: Failed to init winsock!\n");
+        return false;
+    }
+#endif
+
+    mPort = port;
+    mListenSocket = (port > 0 && port < 65536) ? socket(AF_INET, SOCK_STREAM, IPPROTO_TCP) : INVALID_SOCKET;
+    bool ok = mListenSocket != INVALID_SOCKET;
+    if (ok)
+    {
+        //allow a restarted application to bind the port again right away
+        int flag = 1;
+        setsockopt(mListenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char *>(&flag), sizeof(flag));
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<unsigned short>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ok = bind(mListenSocket, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == 0 &&
+            listen(mListenSocket, 4) == 0;
+    }
+
+    if (!ok)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "MetricsServer: Failed to listen on port %d!\n", port);
+        closeSocket(mListenSocket);
+#ifdef __WIN32__
+        WSACleanup();
+#endif
+        return false;
+    }
+
+    mTerminate = false;
+    mThread = new std::thread(&MetricsServer::serve, this);
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO, "MetricsServer: Serving metrics at http://127.0.0.1:%d/metrics\n", port);
+    return true;
+}
+
+/*!
+Stop the server. A request that is being read is dropped, one that is being answered waits at most for the
+send timeout.
+*/
+void sgct_core::MetricsServer::stop()
+{
+    if (mThread == nullptr)
+        return;
+
+    mTerminate = true;
+    mThread->join();
+    delete mThread;
+    mThread = nullptr;
+
+    closeSocket(mListenSocket);
+#ifdef __WIN32__
+    WSACleanup();
+#endif
+}
+
+/*!
+Replace the served metrics. Never waits, the snapshot is skipped if the server is copying the previous one.
+
+\returns false if the snapshot was skipped
+*/
+bool sgct_core::MetricsServer::publish(const Snapshot & snapshot)
+{
+    std::unique_lock<std::mutex> lock(mSnapshotMutex, std::try_to_lock);
+    if (!lock.owns_lock())
+        return false;
+
+    mSnapshot = snapshot;
+    return true;
+}
+
+/*!
+Write a snapshot in the Prometheus text format.
+
+\param snapshot the metrics
+\param time the current time, to tell the age of the snapshot
+\param text the output, replaced
+*/
+void sgct_core::MetricsServer::format(const Snapshot & snapshot, double time, std::string & text)
+{
+    text.clear();
+
+    std::string node;
+    appendFormat(node, "node=\"%d\"", snapshot.mNodeId);
+    const char * labels = node.c_str();
+
+    writeFamily(text, "sgct_up", "gauge", "1 if the render loop has published metrics.");
+    appendFormat(text, "sgct_up{%s} %d\n", labels, snapshot.mTime >= 0.0 ? 1 : 0);
+    if (snapshot.mTime < 0.0)
+        return;
+
+    writeFamily(text, "sgct_metrics_age_seconds", "gauge", "Time since the render loop published the metrics, grows if it stalls.");
+    appendFormat(text, "sgct_metrics_age_seconds{%s} %.9g\n", labels, time - snapshot.mTime);
+    writeFamily(text, "sgct_master", "gauge", "1 on the master node.");
+    appendFormat(text, "sgct_master{%s} %d\n", labels, snapshot.mMaster ? 1 : 0);
+    writeFamily(text, "sgct_frames_total", "counter", "Rendered frames.");
+    appendFormat(text, "sgct_frames_total{%s} %llu\n", labels, snapshot.mFrameNumber);
+    writeFamily(text, "sgct_fps", "gauge", "Average frames per second.");
+    appendFormat(text, "sgct_fps{%s} %.9g\n", labels, snapshot.mReport.mAvgFPS);
+
+    writePercentiles(text, "sgct_frame_time_seconds", "Frame time over the statistics window.", node, snapshot.mReport.mFrameTime);
+    writePercentiles(text, "sgct_draw_time_seconds", "Draw time over the statistics window.", node, snapshot.mReport.mDrawTime);
+    writePercentiles(text, "sgct_sync_wait_seconds", "Time waiting for the frame sync over the statistics window.", node, snapshot.mReport.mSyncTime);
+    writeFamily(text, "sgct_dropped_frames_total", "counter", "Frames that took more than 1.5 refresh periods.");
+    appendFormat(text, "sgct_dropped_frames_total{%s} %llu\n", labels, snapshot.mReport.mDroppedFrames);
+
+    if (snapshot.mGPUFrameTime >= 0.0)
+    {
+        writeFamily(text, "sgct_gpu_frame_time_seconds", "gauge", "GPU time of the latest measured frame.");
+        appendFormat(text, "sgct_gpu_frame_time_seconds{%s} %.9g\n", labels, snapshot.mGPUFrameTime);
+    }
+    writeFamily(text, "sgct_gpu_timer_dropped_frames_total", "counter", "Frames whose GPU timer queries weren't done in time.");
+    appendFormat(text, "sgct_gpu_timer_dropped_frames_total{%s} %llu\n", labels, snapshot.mGPUDroppedFrames);
+
+    if (snapshot.mTrackingSamplingTime >= 0.0)
+    {
+        writeFamily(text, "sgct_tracking_sampling_time_seconds", "gauge", "Time between the tracking samples.");
+        appendFormat(text, "sgct_tracking_sampling_time_seconds{%s} %.9g\n", labels, snapshot.mTrackingSamplingTime);
+    }
+
+    writeFamily(text, "sgct_capture_pending_frames", "gauge", "Captured frames that are still being saved or streamed.");
+    appendFormat(text, "sgct_capture_pending_frames{%s} %u\n", labels, snapshot.mCapturePendingFrames);
+    writeFamily(text, "sgct_capture_dropped_frames_total", "counter", "Frames the capture stream failed to write.");
+    appendFormat(text, "sgct_capture_dropped_frames_total{%s} %llu\n", labels, snapshot.mCaptureDroppedFrames);
+    writeFamily(text, "sgct_log_dropped_messages_total", "counter", "Log messages dropped because the asynchronous log was full.");
+    appendFormat(text, "sgct_log_dropped_messages_total{%s} %llu\n", labels, snapshot.mDroppedLogMessages);
+    writeFamily(text, "sgct_trace_dropped_events_total", "counter", "Trace events dropped while a trace was collected.");
+    appendFormat(text, "sgct_trace_dropped_events_total{%s} %llu\n", labels, snapshot.mDroppedTraceEvents);
+
+    if (snapshot.mConnections.empty())
+        return;
+
+    std::vector<std::string> connectionLabels(snapshot.mConnections.size());
+    for (std::size_t i = 0; i < snapshot.mConnections.size(); i++)
+    {
+        const Connection & c = snapshot.mConnections[i];
+        appendFormat(connectionLabels[i], "%s,connection=\"%d\",type=\"%s\",peer=\"%s:%s\"", labels, c.mId,
+            escapeLabel(c.mType).c_str(), escapeLabel(c.mAddress).c_str(), escapeLabel(c.mPort).c_str());
+    }
+
+    writeFamily(text, "sgct_network_connected", "gauge", "1 if the connection is up.");
+    for (std::size_t i = 0; i < snapshot.mConnections.size(); i++)
+        appendFormat(text, "sgct_network_connected{%s} %d\n", connectionLabels[i].c_str(), snapshot.mConnections[i].mConnected ? 1 : 0);
+    writeFamily(text, "sgct_network_sent_bytes_total", "counter", "Bytes sent on the connection.");
+    for (std::size_t i = 0; i < snapshot.mConnections.size(); i++)
+        appendFormat(text, "sgct_network_sent_bytes_total{%s} %llu\n", connectionLabels[i].c_str(), snapshot.mConnections[i].mBytesSent);
+    writeFamily(text, "sgct_network_received_bytes_total", "counter", "Bytes received on the connection.");
+    for (std::size_t i = 0; i < snapshot.mConnections.size(); i++)
+        appendFormat(text, "sgct_network_received_bytes_total{%s} %llu\n", connectionLabels[i].c_str(), snapshot.mConnections[i].mBytesReceived);
+    writeFamily(text, "sgct_network_sent_messages_total", "counter", "Messages sent on the connection.");
+    for (std::size_t i = 0; i < snapshot.mConnections.size(); i++)
+        appendFormat(text, "sgct_network_sent_messages_total{%s} %llu\n", connectionLabels[i].c_str(), snapshot.mConnections[i].mMessagesSent);
+    writeFamily(text, "sgct_network_received_messages_total", "counter", "Messages received on the connection.");
+    for (std::size_t i = 0; i < snapshot.mConnections.size(); i++)
+        appendFormat(text, "sgct_network_received_messages_total{%s} %llu\n", connectionLabels[i].c_str(), snapshot.mConnections[i].mMessagesReceived);
+    writeFamily(text, "sgct_network_loop_time_seconds", "gauge", "Time from sending sync data until the reply, sync connections only.");
+    for (std::size_t i = 0; i < snapshot.mConnections.size(); i++)
+        if (snapshot.mConnections[i].mLoopTime >= 0.0)
+            appendFormat(text, "sgct_network_loop_time_seconds{%s} %.9g\n", connectionLabels[i].c_str(), snapshot.mConnections[i].mLoopTime);
+}
+
+/*!
+Answers one client at a time, checking for stop between the clients.
+*/
+void sgct_core::MetricsServer::serve()
+{
+    while (!mTerminate)
+    {
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(mListenSocket, &readSet);
+
+        struct timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = METRICS_ACCEPT_TIMEOUT * 1000;
+        if (select(static_cast<int>(mListenSocket + 1), &readSet, nullptr, nullptr, &timeout) <= 0)
+            continue;
+
+        SGCT_SOCKET client = accept(mListenSocket, nullptr, nullptr);
+        if (client == INVALID_SOCKET)
+            continue;
+
+        handleClient(client);
+        closeSocket(client);
+    }
+}
+
+void sgct_core::MetricsServer::handleClient(SGCT_SOCKET client)
+{
+    //the response is small enough for the send buffer, the timeout only guards against a client that stopped reading
+#ifdef __WIN32__
+    DWORD clientTimeout = METRICS_CLIENT_TIMEOUT;
+#else
+    struct timeval clientTimeout;
+    clientTimeout.tv_sec = METRICS_CLIENT_TIMEOUT / 1000;
+    clientTimeout.tv_usec = (METRICS_CLIENT_TIMEOUT % 1000) * 1000;
+#endif
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<char *>(&clientTimeout), sizeof(clientTimeout));
+
+    //only the request line is used, but the headers are read so that the client doesn't get a reset. A slow client
+    //must not keep the server from stopping, so the whole request has a deadline and stop is checked while waiting.
+    std::string request;
+    char buffer[1024];
+    double deadline = sgct::Engine::getTime() + METRICS_CLIENT_TIMEOUT / 1000.0;
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < METRICS_MAX_REQUEST_SIZE)
+    {
+        double remaining = deadline - sgct::Engine::getTime();
+        if (mTerminate || remaining <= 0.0)
+            return;
+
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(client, &readSet);
+
+        int wait = static_cast<int>(remaining * 1000.0) + 1;
+        if (wait > METRICS_ACCEPT_TIMEOUT)
+            wait = METRICS_ACCEPT_TIMEOUT;
+        struct timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = wait * 1000;
+
+        int ready = select(static_cast<int>(client + 1), &readSet, nullptr, nullptr, &timeout);
+        if (ready < 0)
+            return;
+        if (ready == 0)
+            continue;
+
+        int received = static_cast<int>(recv(client, buffer, sizeof(buffer), 0));
+        if (received <= 0)
+            break;
+        request.append(buffer, static_cast<std::size_t>(received));
+    }
+
+    std::string path;
+    bool isGet = request.compare(0, 4, "GET ") == 0;
+    if (isGet)
+    {
+        std::size_t end = request.find_first_of(" ?\r\n", 4);
+        path = request.substr(4, end == std::string::npos ? std::string::npos : end - 4);
+    }
+
+    std::string body;
+    std::string status;
+    if (!isGet)
+    {
+        status = "405 Method Not Allowed";
+        body = "Only GET is supported.\n";
+    }
+    else if (path == "/" || path == "/metrics")
+    {
+        Snapshot snapshot;
+        {
+            std::unique_lock<std::mutex> lock(mSnapshotMutex);
+            snapshot = mSnapshot;
+        }
+        format(snapshot, sgct::Engine::getTime(), body);
+        status = "200 OK";
+    }
+    else
+    {
+        status = "404 Not Found";
+        body = "The metrics are served at /metrics.\n";
+    }
+
+    std::string response;
+    appendFormat(response, "HTTP/1.1 %s\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: %u\r\nConnection: close\r\n\r\n",
+        status.c_str(), static_cast<unsigned int>(body.size()));
+    response += body;
+    sendAll(client, response);
+}
+
+void sgct_core::MetricsServer::closeSocket(SGCT_SOCKET & lSocket)
+{
+    if (lSocket == INVALID_SOCKET)
+        return;
+
+#ifdef __WIN32__
+    shutdown(lSocket, SD_BOTH);
+    closesocket(lSocket);
+#else
+    shutdown(lSocket, SHUT_RDWR);
+    close(lSocket);
+#endif
+    lSocket = INVALID_SOCKET;
+}
@@ -0,0 +1,218 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/MpcdiWarpGrid.h>
+#include <sgct/MessageHandler.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    #define _sscanf sscanf_s
+#else
+    #define _sscanf sscanf
+#endif
+
+namespace
+{
+    const std::size_t MAX_HEADER_LENGTH = 256;
+    const std::size_t POINT_SIZE = 12; //x correction, y correction and error as 32 bit floats
+    const std::size_t READ_BLOCK_SIZE = 64 * 1024;
+
+    bool isLittleEndian()
+    {
+        unsigned short value = 1;
+        unsigned char first;
+        memcpy(&first, &value, 1);
+        return first == 1;
+    }
+
+    inline float readFloat(const unsigned char * src, bool swapBytes)
+    {
+        unsigned char bytes[4];
+        if (swapBytes)
+        {
+            bytes[0] = src[3];
+            bytes[1] = src[2];
+            bytes[2] = src[1];
+            bytes[3] = src[0];
+        }
+        else
+            memcpy(bytes, src, 4);
+
+        float value;
+        memcpy(&value, bytes, 4);
+        return value;
+    }
+}
+
+sgct_core::MpcdiWarpGrid::MpcdiWarpGrid()
+{
+    reset();
+}
+
+void sgct_core::MpcdiWarpGrid::reset()
+{
+    mHeader.clear();
+    std::vector<float>().swap(mCorrections);
+    mPendingSize = 0;
+    mPointsRead = 0;
+    mColumns = 0;
+    mRows = 0;
+    mHeaderDone = false;
+    mSwapBytes = false;
+    mComplete = false;
+    mFailed = false;
+}
+
+/*!
+    The header is three lines: "PF", the number of columns and rows and the scale, where a negative scale means
+    little endian data.
+*/
+bool sgct_core::MpcdiWarpGrid::parseHeader()
+{
+    char format[3] = { 0, 0, 0 };
+    float endiannessIndicator = 0.0f;
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    int count = _sscanf(mHeader.c_str(), "%2c %u %u %f", format, 3, &mColumns, &mRows, &endiannessIndicator);
+#else
+    int count = _sscanf(mHeader.c_str(), "%2c %u %u %f", format, &mColumns, &mRows, &endiannessIndicator);
+#endif
+    if (count != 4)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "MpcdiWarpGrid: Invalid header syntax.\n");
+        return false;
+    }
+
+    //the 'Pf' grayscale type has no room for both corrections
+    if (format[0] != 'P' || format[1] != 'F')
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "MpcdiWarpGrid: Incorrect file type.\n");
+        return false;
+    }
+
+    if (mColumns < 2 || mRows < 2 || static_cast<unsigned long long>(mColumns) * mRows > 0x10000000ULL)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "MpcdiWarpGrid: Invalid grid size %ux%u.\n", mColumns, mRows);
+        return false;
+    }
+
+    mSwapBytes = (endiannessIndicator < 0.0f) != isLittleEndian();
+    mCorrections.resize(static_cast<std::size_t>(mColumns) * mRows * 2);
+    return true;
+}
+
+/*!
+    Decodes the next block of a PFM file. Blocks can have any size.
+    \returns false if the data is invalid
+*/
+bool sgct_core::MpcdiWarpGrid::decode(const char * data, std::size_t size)
+{
+    if (mFailed)
+        return false;
+
+    const unsigned char * src = reinterpret_cast<const unsigned char *>(data);
+    const unsigned char * end = src + size;
+
+    //the header ends after the third newline
+    while (!mHeaderDone && src < end)
+    {
+        char c = static_cast<char>(*src++);
+        mHeader.push_back(c);
+        if (c == '\n' && std::count(mHeader.begin(), mHeader.end(), '\n') == 3)
+        {
+            if (!parseHeader())
+            {
+                mFailed = true;
+                return false;
+            }
+            mHeaderDone = true;
+        }
+        else if (mHeader.size() > MAX_HEADER_LENGTH)
+        {
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "MpcdiWarpGrid: Invalid header syntax.\n");
+            mFailed = true;
+            return false;
+        }
+    }
+
+    std::size_t numberOfPoints = mCorrections.size() / 2;
+    while (src < end && mPointsRead < numberOfPoints)
+    {
+        const unsigned char * point = src;
+        if (mPendingSize > 0 || static_cast<std::size_t>(end - src) < POINT_SIZE)
+        {
+            std::size_t count = POINT_SIZE - mPendingSize;
+            if (count > static_cast<std::size_t>(end - src))
+                count = static_cast<std::size_t>(end - src);
+            memcpy(mPending + mPendingSize, src, count);
+            mPendingSize += count;
+            src += count;
+            if (mPendingSize < POINT_SIZE)
+                break;
+            point = mPending;
+            mPendingSize = 0;
+        }
+        else
+            src += POINT_SIZE;
+
+        //MPCDI substitutes red for the x correction, green for y and blue for the error, which is skipped
+        mCorrections[mPointsRead * 2] = readFloat(point, mSwapBytes);
+        mCorrections[mPointsRead * 2 + 1] = readFloat(point + 4, mSwapBytes);
+        mPointsRead++;
+    }
+
+    if (mHeaderDone && mPointsRead == numberOfPoints)
+        mComplete = true;
+    return true;
+}
+
+/*!
+    \returns true if the whole grid has been decoded
+*/
+bool sgct_core::MpcdiWarpGrid::finish()
+{
+    if (!mComplete && !mFailed)
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "MpcdiWarpGrid: Error reading all correction values (%u of %u)!\n",
+            static_cast<unsigned int>(mPointsRead), static_cast<unsigned int>(mCorrections.size() / 2));
+    return mComplete;
+}
+
+/*!
+    Reads a PFM file in blocks.
+*/
+bool sgct_core::MpcdiWarpGrid::readFile(const std::string & path)
+{
+    reset();
+
+    FILE * file = nullptr;
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    if (fopen_s(&file, path.c_str(), "rb") != 0 || !file)
+#else
+    file = fopen(path.c_str(), "rb");
+    if (file == nullptr)
+#endif
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "MpcdiWarpGrid: Failed to open '%s'!\n", path.c_str());
+        return false;
+    }
+
+    std::vector<char> block(READ_BLOCK_SIZE);
+    bool status = true;
+    std::size_t count;
+    while (status && !mComplete && (count = fread(block.data(), 1, block.size(), file)) > 0)
+        status = decode(block.data(), count);
+    fclose(file);
+
+    return status && finish();
+}
+
+void sgct_core::MpcdiWarpGrid::swap(MpcdiWarpGrid & other)
+{
+    std::swap(*this, other);
+}
@@ -16,7 +16,11 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #include <sgct/ClusterManager.h>
 #include <sgct/SharedData.h>
 #include <sgct/Engine.h>
+#include <sgct/Tracer.h>
+#include <sgct/ClusterConfigSnapshot.h>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 
 #ifndef SGCT_DONT_USE_EXTERNAL
 #include "../include/external/zlib.h"
@@ -73,6 +77,20 @@ sgct_core::NetworkManager::NetworkManager(NetworkMode nm)
     mAllNodesConnected = false;
     mIsRunning = true;
     mIsServer = true;
+    mConfigurationReceived = false;
+    mConfigurationFailed = false;
+    mTraceRequestId = 0;
+    mTraceReplies = 0;
+    mTraceRequestTime = 0.0;
+
+    mClockSyncThread = nullptr;
+    mClockSyncRunning = false;
+    mClockSyncRequestId = 0;
+    mClockSyncInterval = 1.0;
+    for (std::size_t i = 0; i < 3; i++)
+        mClockSyncTestDelays[i] = 0.0;
+    mSyncTestLink[0] = 0.0;
+    mSyncTestLink[1] = 0.0;
 
     mExternalControlConnection = nullptr;
 
@@ -274,6 +292,12 @@ bool sgct_core::NetworkManager::init()
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "NetworkManager: Cluster sync is set to %s\n",
         ClusterManager::instance()->getFirmFrameLockSyncStatus() ? "firm/strict" : "loose" );
 
+    if( !mIsServer && !mSyncConnections.empty() )
+    {
+        mClockSyncRunning = true;
+        mClockSyncThread = new (std::nothrow) std::thread(&sgct_core::NetworkManager::clockSyncLoop, this);
+    }
+
     return true;
 }
 
@@ -380,7 +404,7 @@ void sgct_core::NetworkManager::transferData(const void * data, int length, int
     char * buffer = nullptr;
     int sendSize = length;
 
-    if (prepareTransferData(data, &buffer, sendSize, packageId))
+    if (prepareTransferData(data, &buffer, sendSize, packageId, mCompress, mCompressionLevel))
     {
         //Send the data
         for (SGCTNetwork * dataTransferConnection : mDataTransferConnections)
@@ -405,7 +429,7 @@ void sgct_core::NetworkManager::transferData(const void * data, int length, int
         char * buffer = nullptr;
         int sendSize = length;
 
-        if (prepareTransferData(data, &buffer, sendSize, packageId))
+        if (prepareTransferData(data, &buffer, sendSize, packageId, mCompress, mCompressionLevel))
         {
             mDataTransferConnections[nodeIndex]->sendData(buffer, sendSize);
         }
@@ -427,7 +451,7 @@ void sgct_core::NetworkManager::transferData(const void * data, int length, int
         char * buffer = nullptr;
         int sendSize = length;
 
-        if (prepareTransferData(data, &buffer, sendSize, packageId))
+        if (prepareTransferData(data, &buffer, sendSize, packageId, mCompress, mCompressionLevel))
         {
             connection->sendData(buffer, sendSize);
         }
@@ -441,11 +465,359 @@ void sgct_core::NetworkManager::transferData(const void * data, int length, int
     }
 }
 
-bool sgct_core::NetworkManager::prepareTransferData(const void * data, char ** bufferPtr, int & length, int packageId)
+/*!
+Set the configuration snapshot that the master sends to each slave when it connects, must be called before init.
+\returns false if the snapshot couldn't be compressed
+*/
+bool sgct_core::NetworkManager::setConfigurationSnapshot(const std::vector<char> & snapshot)
+{
+    auto compressedSize = compressBound(static_cast<uLong>(snapshot.size()));
+    mConfigurationMessage.resize(SGCTNetwork::mHeaderSize + compressedSize);
+
+    int err = compress2(reinterpret_cast<Bytef*>(mConfigurationMessage.data() + SGCTNetwork::mHeaderSize),
+        &compressedSize,
+        reinterpret_cast<const Bytef*>(snapshot.data()),
+        static_cast<uLong>(snapshot.size()),
+        Z_BEST_COMPRESSION);
+    if (err != Z_OK)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "NetworkManager: Failed to compress configuration snapshot!\n");
+        mConfigurationMessage.clear();
+        return false;
+    }
+    mConfigurationMessage.resize(SGCTNetwork::mHeaderSize + compressedSize);
+
+    //same header layout as the sync data
+    auto dataSize = static_cast<uint32_t>(compressedSize);
+    auto uncompressedSize = static_cast<uint32_t>(snapshot.size());
+    int32_t frame = 0;
+    mConfigurationMessage[0] = SGCTNetwork::ConfigurationId;
+    memcpy(&mConfigurationMessage[1], &frame, 4);
+    memcpy(&mConfigurationMessage[5], &dataSize, 4);
+    memcpy(&mConfigurationMessage[9], &uncompressedSize, 4);
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "NetworkManager: Configuration snapshot is %u bytes (%u compressed).\n",
+        uncompressedSize, dataSize);
+    return true;
+}
+
+/*!
+Wait until the master has sent the configuration snapshot.
+\returns false if the connection to the master was lost or the snapshot couldn't be read
+*/
+bool sgct_core::NetworkManager::waitForConfigurationSnapshot(std::vector<char> & snapshot)
+{
+    std::unique_lock<std::mutex> lk(mConfigurationMutex);
+    while (!mConfigurationReceived)
+    {
+        if (mConfigurationFailed || !isRunning())
+            return false;
+        mConfigurationCond.wait_for(lk, std::chrono::milliseconds(100));
+    }
+
+    snapshot.swap(mConfigurationSnapshot);
+    mConfigurationSnapshot.clear();
+    return true;
+}
+
+/*!
+Store the configuration snapshot from the master. A null snapshot means that the connection failed to uncompress it.
+*/
+void sgct_core::NetworkManager::receiveConfigurationSnapshot(const char * data, int length)
+{
+    std::unique_lock<std::mutex> lk(mConfigurationMutex);
+    //a slave that reconnects gets the snapshot again, only the first one is used
+    if (mConfigurationReceived || mConfigurationFailed)
+        return;
+
+    tinyxml2::XMLDocument xmlDoc;
+    std::string errorMsg;
+    if (data != nullptr && length > 0 &&
+        ClusterConfigSnapshot::decode(data, static_cast<std::size_t>(length), xmlDoc, errorMsg))
+    {
+        mConfigurationSnapshot.assign(data, data + length);
+        mConfigurationReceived = true;
+    }
+    else
+    {
+        if (data != nullptr)
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+                "NetworkManager: Invalid configuration snapshot from master: %s\n", errorMsg.c_str());
+        mConfigurationFailed = true;
+    }
+    mConfigurationCond.notify_all();
+}
+
+/*!
+Collect the traces of all connected slaves into the Tracer of the master, waiting for the replies. Slaves reply from
+their network thread, so they don't have to be rendering.
+\returns false if some slave didn't reply within the timeout (seconds)
+*/
+bool sgct_core::NetworkManager::requestTraces(double timeout)
+{
+    if (!mIsServer)
+        return false;
+
+    std::unique_lock<std::mutex> lk(mTraceMutex);
+    mTraceRequestId++;
+    mTraceReplies = 0;
+    mTraceRequestTime = sgct::Engine::getTime();
+
+    unsigned int numberOfRequests = 0;
+    for (std::size_t i = 0; i < mSyncConnections.size(); i++)
+        if (mSyncConnections[i]->isConnected())
+        {
+            mSyncConnections[i]->sendTraceRequest(mTraceRequestId);
+            numberOfRequests++;
+        }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<long long>(timeout * 1e6));
+    while (mTraceReplies < numberOfRequests)
+        if (mTraceCond.wait_until(lk, deadline) == std::cv_status::timeout)
+            break;
+
+    if (mTraceReplies < numberOfRequests)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING, "NetworkManager: Received %u of %u slave traces.\n",
+            mTraceReplies, numberOfRequests);
+        return false;
+    }
+    return true;
+}
+
+/*!
+A slave replies to a trace request and the master adds the reply to its Tracer.
+*/
+void sgct_core::NetworkManager::receiveTrace(SGCTNetwork * connection, const char * data, int length, int requestId)
+{
+    if (!mIsServer)
+    {
+        double requestTime = sgct::Engine::getTime();
+        std::vector<char> trace;
+        Tracer::instance()->serialize(trace, requestTime);
+
+        auto compressedSize = compressBound(static_cast<uLong>(trace.size()));
+        std::vector<char> message(SGCTNetwork::mHeaderSize + compressedSize);
+        int err = compress2(reinterpret_cast<Bytef*>(message.data() + SGCTNetwork::mHeaderSize),
+            &compressedSize,
+            reinterpret_cast<const Bytef*>(trace.data()),
+            static_cast<uLong>(trace.size()),
+            Z_BEST_SPEED);
+        if (err != Z_OK)
+        {
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "NetworkManager: Failed to compress trace!\n");
+            return;
+        }
+
+        auto dataSize = static_cast<uint32_t>(compressedSize);
+        auto uncompressedSize = static_cast<uint32_t>(trace.size());
+        message[0] = SGCTNetwork::TraceId;
+        memcpy(&message[1], &requestId, 4);
+        memcpy(&message[5], &dataSize, 4);
+        memcpy(&message[9], &uncompressedSize, 4);
+        connection->sendData(message.data(), static_cast<int>(SGCTNetwork::mHeaderSize + compressedSize));
+        return;
+    }
+
+    if (length == 0)
+        return;
+
+    double receiveTime = sgct::Engine::getTime();
+    std::unique_lock<std::mutex> lk(mTraceMutex);
+    if (requestId != mTraceRequestId)
+        return; //a late reply to a request that timed out
+
+    Tracer::instance()->addRemoteTrace(data, static_cast<std::size_t>(length), mTraceRequestTime, receiveTime);
+    mTraceReplies++;
+    mTraceCond.notify_all();
+}
+
+/*!
+\returns the time of the master clock in seconds, estimated on slaves, see ClockSync
+*/
+double sgct_core::NetworkManager::getClusterTime()
+{
+    double localTime = sgct::Engine::getTime();
+    return mIsServer ? localTime : mClockSync.toMasterTime(localTime);
+}
+
+/*!
+\returns how well this slave's clock is synchronized to the master, the master is always synchronized to itself
+*/
+sgct_core::ClockSync::Quality sgct_core::NetworkManager::getClockSyncQuality()
+{
+    if (!mIsServer)
+        return mClockSync.getQuality(sgct::Engine::getTime());
+
+    ClockSync::Quality quality;
+    quality.mSynchronized = true;
+    quality.mOffset = 0.0;
+    quality.mDrift = 0.0;
+    quality.mRoundTripTime = 0.0;
+    quality.mJitter = 0.0;
+    quality.mErrorBound = 0.0;
+    quality.mNumberOfSamples = 0;
+    return quality;
+}
+
+/*!
+Set the time between clock synchronization requests of a slave in seconds, the first ones are sent faster.
+*/
+void sgct_core::NetworkManager::setClockSyncInterval(double interval)
+{
+    std::unique_lock<std::mutex> lk(mClockSyncMutex);
+    mClockSyncInterval = std::max(interval, 0.01);
+}
+
+/*!
+Delay the clock synchronization messages of a slave to test the estimate, for example on loopback. The request
+delay is added before a request is sent and the reply delay before a reply is stamped, so both are seen as network
+delay. Each message gets an additional random delay up to the jitter. Different request and reply delays bias the
+offset by half their difference, like an asymmetric network route would. All times are in seconds.
+*/
+void sgct_core::NetworkManager::setClockSyncTestDelays(double requestDelay, double replyDelay, double jitter)
+{
+    std::unique_lock<std::mutex> lk(mClockSyncMutex);
+    mClockSyncTestDelays[0] = std::max(requestDelay, 0.0);
+    mClockSyncTestDelays[1] = std::max(replyDelay, 0.0);
+    mClockSyncTestDelays[2] = std::max(jitter, 0.0);
+}
+
+/*!
+Impairs the sync connections as if they went over a link with the latency in seconds and bandwidth in bytes per
+second, to test the frame sync on loopback. Applies to the connections that are added after the call.
+*/
+void sgct_core::NetworkManager::setSyncTestLink(double latency, double bandwidth)
+{
+    mSyncTestLink[0] = latency;
+    mSyncTestLink[1] = bandwidth;
+}
+
+double sgct_core::NetworkManager::getClockSyncTestDelay(double delay, std::minstd_rand & random)
+{
+    if (mClockSyncTestDelays[2] > 0.0)
+        delay += std::uniform_real_distribution<double>(0.0, mClockSyncTestDelays[2])(random);
+    return delay;
+}
+
+/*!
+Sends the clock synchronization requests of a slave.
+*/
+void sgct_core::NetworkManager::clockSyncLoop()
+{
+    //the first samples are taken quickly to synchronize soon after connecting
+    const std::size_t numberOfFastSamples = 20;
+    const double fastInterval = 0.1;
+    const double reportInterval = 10.0;
+
+    bool wasConnected = false;
+    bool wasSynchronized = false;
+    double lastReport = sgct::Engine::getTime();
+
+    std::unique_lock<std::mutex> lk(mClockSyncMutex);
+    while (mClockSyncRunning)
+    {
+        double interval = mClockSync.getNumberOfSamples() < numberOfFastSamples ? fastInterval : mClockSyncInterval;
+        mClockSyncCond.wait_for(lk, std::chrono::microseconds(static_cast<long long>(interval * 1e6)));
+        if (!mClockSyncRunning)
+            break;
+
+        SGCTNetwork * connection = mSyncConnections[0];
+        if (!connection->isConnected())
+        {
+            wasConnected = false;
+            continue;
+        }
+        if (!wasConnected)
+        {
+            //the master may have been restarted
+            mClockSync.reset();
+            wasConnected = true;
+            wasSynchronized = false;
+        }
+
+        int32_t requestId = ++mClockSyncRequestId;
+        mClockSyncRequestTimes[requestId % 16] = sgct::Engine::getTime();
+        double delay = mClockSyncTestDelays[0] > 0.0 || mClockSyncTestDelays[2] > 0.0 ?
+            getClockSyncTestDelay(mClockSyncTestDelays[0], mClockSyncRandom[0]) : 0.0;
+
+        lk.unlock();
+        if (delay > 0.0)
+            std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(delay * 1e6)));
+        connection->sendClockSyncRequest(requestId);
+
+        double now = sgct::Engine::getTime();
+        ClockSync::Quality quality = mClockSync.getQuality(now);
+        if ((quality.mSynchronized && !wasSynchronized) || (quality.mSynchronized && now - lastReport > reportInterval))
+        {
+            sgct::MessageHandler::instance()->print(wasSynchronized ? sgct::MessageHandler::NOTIFY_DEBUG : sgct::MessageHandler::NOTIFY_INFO,
+                "NetworkManager: Clock offset to master %.3f ms, drift %.1f ppm, round trip %.3f ms, jitter %.3f ms.\n",
+                quality.mOffset * 1000.0, quality.mDrift * 1e6, quality.mRoundTripTime * 1000.0, quality.mJitter * 1000.0);
+            wasSynchronized = true;
+            lastReport = now;
+        }
+        lk.lock();
+    }
+}
+
+/*!
+The master replies to a clock synchronization request and a slave adds the reply to its estimate.
+*/
+void sgct_core::NetworkManager::receiveClockSync(SGCTNetwork * connection, const char * data, int length, int requestId)
+{
+    if (mIsServer)
+    {
+        double receiveTime = sgct::Engine::getTime();
+        connection->sendClockSyncReply(requestId, receiveTime, sgct::Engine::getTime());
+        return;
+    }
+
+    if (length < static_cast<int>(2 * sizeof(double)))
+        return;
+
+    double delay;
+    {
+        std::unique_lock<std::mutex> lk(mClockSyncMutex);
+        delay = mClockSyncTestDelays[1] > 0.0 || mClockSyncTestDelays[2] > 0.0 ?
+            getClockSyncTestDelay(mClockSyncTestDelays[1], mClockSyncRandom[1]) : 0.0;
+    }
+    if (delay > 0.0)
+        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(delay * 1e6)));
+
+    double t3 = sgct::Engine::getTime();
+    double t1, t2;
+    memcpy(&t1, data, sizeof(double));
+    memcpy(&t2, data + sizeof(double), sizeof(double));
+
+    double t0;
+    {
+        std::unique_lock<std::mutex> lk(mClockSyncMutex);
+        //only the latest requests are remembered
+        if (requestId > mClockSyncRequestId || mClockSyncRequestId - requestId >= 16)
+            return;
+        t0 = mClockSyncRequestTimes[requestId % 16];
+    }
+
+    mClockSync.addSample(t0, t1, t2, t3);
+}
+
+/*!
+Creates a data transfer package of a header followed by the data, optionally compressed.
+
+\param data the data to send
+\param bufferPtr set to the package, which must be deleted with delete[]
+\param length the data size, set to the package size
+\param packageId the id of the package
+\param compress true to compress the data with zlib
+\param compressionLevel the zlib compression level
+
+\returns false if the package couldn't be created
+*/
+bool sgct_core::NetworkManager::prepareTransferData(const void * data, char ** bufferPtr, int & length, int packageId, bool compress, int compressionLevel)
 {
     int msg_len = length;
 
-    if (mCompress)
+    if (compress)
         length = compressBound(static_cast<uLong>(length));
     length += static_cast<int>(SGCTNetwork::mHeaderSize);
 
@@ -454,22 +826,23 @@ bool sgct_core::NetworkManager::prepareTransferData(const void * data, char ** b
     {
         auto *packageIdPtr = (char *)&packageId;
 
-        (*bufferPtr)[0] = mCompress ? SGCTNetwork::CompressedDataId : SGCTNetwork::DataId;
+        (*bufferPtr)[0] = compress ? SGCTNetwork::CompressedDataId : SGCTNetwork::DataId;
         (*bufferPtr)[1] = packageIdPtr[0];
         (*bufferPtr)[2] = packageIdPtr[1];
         (*bufferPtr)[3] = packageIdPtr[2];
         (*bufferPtr)[4] = packageIdPtr[3];
 
         char * compDataPtr = (*bufferPtr) + SGCTNetwork::mHeaderSize;
+        int dataSize = msg_len;
 
-        if (mCompress)
+        if (compress)
         {
             auto compressedSize = static_cast<uLongf>(length - SGCTNetwork::mHeaderSize);
             int err = compress2(reinterpret_cast<Bytef*>(compDataPtr),
                 &compressedSize,
                 reinterpret_cast<const Bytef*>(data),
-                static_cast<uLong>(length),
-                mCompressionLevel);
+                static_cast<uLong>(msg_len),
+                compressionLevel);
 
             if (err != Z_OK)
             {
@@ -494,19 +867,21 @@ bool sgct_core::NetworkManager::prepareTransferData(const void * data, char ** b
                 }
 
                 sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "NetworkManager: Failed to compress data! Error: %s\n", errStr.c_str());
+                delete[] (*bufferPtr);
+                (*bufferPtr) = nullptr;
                 return false;
             }
 
-            //send original size
-            auto *uncompressedSizePtr = (char *)&length;
+            //send original size, the receiver reads the compressed size
+            auto *uncompressedSizePtr = (char *)&msg_len;
             (*bufferPtr)[9] = uncompressedSizePtr[0];
             (*bufferPtr)[10] = uncompressedSizePtr[1];
             (*bufferPtr)[11] = uncompressedSizePtr[2];
             (*bufferPtr)[12] = uncompressedSizePtr[3];
 
-            length = static_cast<int>(compressedSize);
+            dataSize = static_cast<int>(compressedSize);
             //re-calculate the true send size
-            length = length + static_cast<int>(SGCTNetwork::mHeaderSize);
+            length = dataSize + static_cast<int>(SGCTNetwork::mHeaderSize);
         }
         else
         {
@@ -529,7 +904,7 @@ bool sgct_core::NetworkManager::prepareTransferData(const void * data, char ** b
 
         }
 
-        auto *sizePtr = (char *)&msg_len;
+        auto *sizePtr = (char *)&dataSize;
         (*bufferPtr)[5] = sizePtr[0];
         (*bufferPtr)[6] = sizePtr[1];
         (*bufferPtr)[7] = sizePtr[2];
@@ -741,6 +1116,18 @@ void sgct_core::NetworkManager::close()
 {
     mIsRunning = false;
 
+    if( mClockSyncThread != nullptr )
+    {
+        {
+            std::unique_lock<std::mutex> lk(mClockSyncMutex);
+            mClockSyncRunning = false;
+            mClockSyncCond.notify_all();
+        }
+        mClockSyncThread->join();
+        delete mClockSyncThread;
+        mClockSyncThread = nullptr;
+    }
+
     //release condition variables
     gCond.notify_all();
 
@@ -810,7 +1197,44 @@ bool sgct_core::NetworkManager::addConnection(const std::string & port, const st
         netPtr->setConnectedFunction(connectedCallback);
 
         if( connectionType == SGCTNetwork::SyncConnection )
+        {
+            if( mIsServer )
+                netPtr->setConnectMessage(mConfigurationMessage);
+            else
+            {
+                sgct_cppxeleven::function< void(const char*, int, int) > configurationCallback;
+                configurationCallback = sgct_cppxeleven::bind(&sgct_core::NetworkManager::receiveConfigurationSnapshot, this,
+                                                              sgct_cppxeleven::placeholders::_1,
+                                                              sgct_cppxeleven::placeholders::_2);
+                netPtr->setConfigurationFunction(configurationCallback);
+            }
+
+            sgct_cppxeleven::function< void(int, unsigned int, int, int) > reloadCallback;
+            reloadCallback = sgct_cppxeleven::bind(&sgct::Engine::invokeCorrectionDataReloadCallback, sgct::Engine::instance(),
+                                                   sgct_cppxeleven::placeholders::_1,
+                                                   sgct_cppxeleven::placeholders::_2,
+                                                   sgct_cppxeleven::placeholders::_3,
+                                                   sgct_cppxeleven::placeholders::_4);
+            netPtr->setReloadFunction(reloadCallback);
+
+            sgct_cppxeleven::function< void(SGCTNetwork *, const char*, int, int) > traceCallback;
+            traceCallback = sgct_cppxeleven::bind(&sgct_core::NetworkManager::receiveTrace, this,
+                                                  sgct_cppxeleven::placeholders::_1,
+                                                  sgct_cppxeleven::placeholders::_2,
+                                                  sgct_cppxeleven::placeholders::_3,
+                                                  sgct_cppxeleven::placeholders::_4);
+            netPtr->setTraceFunction(traceCallback);
+
+            sgct_cppxeleven::function< void(SGCTNetwork *, const char*, int, int) > clockSyncCallback;
+            clockSyncCallback = sgct_cppxeleven::bind(&sgct_core::NetworkManager::receiveClockSync, this,
+                                                      sgct_cppxeleven::placeholders::_1,
+                                                      sgct_cppxeleven::placeholders::_2,
+                                                      sgct_cppxeleven::placeholders::_3,
+                                                      sgct_cppxeleven::placeholders::_4);
+            netPtr->setClockSyncFunction(clockSyncCallback);
+            netPtr->setTestLink(mSyncTestLink[0], mSyncTestLink[1]);
             mSyncConnections.push_back(netPtr);
+        }
         else if (connectionType == SGCTNetwork::DataTransfer)
             mDataTransferConnections.push_back(netPtr);
         else
@@ -15,6 +15,7 @@
 
 #include <sgct/SGCTSettings.h>
 #include <sgct/SGCTMpcdi.h>
+#include <sgct/ClusterConfigSnapshot.h>
 #include <algorithm>
 #include <sstream>
 
@@ -44,6 +45,7 @@ const std::string DefaultSingleConfiguration = "            \
 sgct_core::ReadConfig::ReadConfig( const std::string filename )
 {
     valid = false;
+    mSnapshotPending = false;
     
     if( filename.empty() )
     {
@@ -157,23 +159,23 @@ bool sgct_core::ReadConfig::readAndParseXMLFile()
         return false;
     }
     
-    tinyxml2::XMLDocument xmlDoc;
-    if( xmlDoc.LoadFile(xmlFileName.c_str()) != tinyxml2::XML_NO_ERROR )
+    //the document is kept for parseContents and createSnapshot
+    if( mXmlDoc.LoadFile(xmlFileName.c_str()) != tinyxml2::XML_NO_ERROR )
     {
         std::stringstream ss;
-        if (xmlDoc.GetErrorStr1() && xmlDoc.GetErrorStr2())
-            ss << "Parsing failed after: " << xmlDoc.GetErrorStr1() << " " << xmlDoc.GetErrorStr2();
-        else if(xmlDoc.GetErrorStr1())
-                ss << "Parsing failed after: " << xmlDoc.GetErrorStr1();
-        else if(xmlDoc.GetErrorStr2())
-            ss << "Parsing failed after: " << xmlDoc.GetErrorStr2();
+        if (mXmlDoc.GetErrorStr1() && mXmlDoc.GetErrorStr2())
+            ss << "Parsing failed after: " << mXmlDoc.GetErrorStr1() << " " << mXmlDoc.GetErrorStr2();
+        else if(mXmlDoc.GetErrorStr1())
+                ss << "Parsing failed after: " << mXmlDoc.GetErrorStr1();
+        else if(mXmlDoc.GetErrorStr2())
+            ss << "Parsing failed after: " << mXmlDoc.GetErrorStr2();
         else
             ss << "File not found";
         mErrorMsg = ss.str();
         return false;
     }
     else
-        return readAndParseXML(xmlDoc);
+        return readAndParseXML(mXmlDoc);
 }
 
 bool sgct_core::ReadConfig::readAndParseXMLString()
@@ -201,6 +203,24 @@ bool sgct_core::ReadConfig::readAndParseXMLString()
 }
 
 bool sgct_core::ReadConfig::readAndParseXML(tinyxml2::XMLDocument& xmlDoc)
+{
+    if( !readAndParseXMLCluster(xmlDoc) )
+        return false;
+
+    //the slaves get the rest from the master, see parseSnapshot
+    if( mSnapshotPending )
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "ReadConfig: Using configuration snapshot from master.\n");
+        return true;
+    }
+
+    return readAndParseXMLContents(xmlDoc);
+}
+
+/*!
+Read the cluster attributes and the node addresses and ports, which is all that is needed to find this node and connect to the master.
+*/
+bool sgct_core::ReadConfig::readAndParseXMLCluster(tinyxml2::XMLDocument& xmlDoc)
 {
     tinyxml2::XMLElement* XMLroot = xmlDoc.FirstChildElement( "Cluster" );
     if( XMLroot == NULL )
@@ -236,11 +256,57 @@ bool sgct_core::ReadConfig::readAndParseXML(tinyxml2::XMLDocument& xmlDoc)
         ClusterManager::instance()->setFirmFrameLockSyncStatus(
                                                                strcmp( XMLroot->Attribute( "firmSync" ), "true" ) == 0 ? true : false );
     }
+
+    if( XMLroot->Attribute( "configSnapshot" ) != NULL )
+        mSnapshotPending = strcmp( XMLroot->Attribute( "configSnapshot" ), "true" ) == 0;
+    
+    tinyxml2::XMLElement* element = XMLroot->FirstChildElement( "Node" );
+    while( element != NULL )
+    {
+        SGCTNode tmpNode;
+        
+        if( element->Attribute( "address" ) )
+            tmpNode.setAddress( element->Attribute( "address" ) );
+        if (element->Attribute("name"))
+            tmpNode.setName(element->Attribute("name"));
+        if( element->Attribute( "ip" ) ) //backward compability with older versions of SGCT config files
+            tmpNode.setAddress( element->Attribute( "ip" ) );
+        if( element->Attribute( "port" ) )
+            tmpNode.setSyncPort( element->Attribute( "port" ) );
+        if (element->Attribute("syncPort"))
+            tmpNode.setSyncPort(element->Attribute("syncPort"));
+        if (element->Attribute("dataTransferPort"))
+            tmpNode.setDataTransferPort(element->Attribute("dataTransferPort"));
+        
+        if( element->Attribute("swapLock") != NULL )
+            tmpNode.setUseSwapGroups( strcmp( element->Attribute("swapLock"), "true" ) == 0 ? true : false );
+
+        ClusterManager::instance()->addNode(tmpNode);
+
+        //iterate
+        element = element->NextSiblingElement( "Node" );
+    }
+
+    return true;
+}
+
+/*!
+Read everything but the cluster attributes and node addresses: scene, users, settings, trackers and the windows of the nodes.
+*/
+bool sgct_core::ReadConfig::readAndParseXMLContents(tinyxml2::XMLDocument& xmlDoc)
+{
+    tinyxml2::XMLElement* XMLroot = xmlDoc.FirstChildElement( "Cluster" );
+    if( XMLroot == NULL )
+    {
+        mErrorMsg.assign("Cannot find XML root!");
+        return false;
+    }
     
     tinyxml2::XMLElement* element[MAX_XML_DEPTH];
     for(unsigned int i=0; i < MAX_XML_DEPTH; i++)
         element[i] = NULL;
     const char * val[MAX_XML_DEPTH];
+    std::size_t nodeIndex = 0;
     element[0] = XMLroot->FirstChildElement();
     while( element[0] != NULL )
     {
@@ -298,23 +364,14 @@ bool sgct_core::ReadConfig::readAndParseXML(tinyxml2::XMLDocument& xmlDoc)
         }
         else if( strcmp("Node", val[0]) == 0 )
         {
-            SGCTNode tmpNode;
-            
-            if( element[0]->Attribute( "address" ) )
-                tmpNode.setAddress( element[0]->Attribute( "address" ) );
-            if (element[0]->Attribute("name"))
-                tmpNode.setName(element[0]->Attribute("name"));
-            if( element[0]->Attribute( "ip" ) ) //backward compability with older versions of SGCT config files
-                tmpNode.setAddress( element[0]->Attribute( "ip" ) );
-            if( element[0]->Attribute( "port" ) )
-                tmpNode.setSyncPort( element[0]->Attribute( "port" ) );
-            if (element[0]->Attribute("syncPort"))
-                tmpNode.setSyncPort(element[0]->Attribute("syncPort"));
-            if (element[0]->Attribute("dataTransferPort"))
-                tmpNode.setDataTransferPort(element[0]->Attribute("dataTransferPort"));
-            
-            if( element[0]->Attribute("swapLock") != NULL )
-                tmpNode.setUseSwapGroups( strcmp( element[0]->Attribute("swapLock"), "true" ) == 0 ? true : false );
+            //the node itself was added by readAndParseXMLCluster
+            SGCTNode * nodePtr = ClusterManager::instance()->getNodePtr(nodeIndex++);
+            if( nodePtr == NULL )
+            {
+                mErrorMsg.assign("Node list doesn't match the cluster!");
+                return false;
+            }
+            SGCTNode & tmpNode = *nodePtr;
             
             element[1] = element[0]->FirstChildElement();
             while( element[1] != NULL )
@@ -474,8 +531,6 @@ bool sgct_core::ReadConfig::readAndParseXML(tinyxml2::XMLDocument& xmlDoc)
                 element[1] = element[1]->NextSiblingElement();
                 
             }//end while
-            
-            ClusterManager::instance()->addNode(tmpNode);
         }//end if node
         else if( strcmp("User", val[0]) == 0 )
         {
@@ -606,6 +661,17 @@ bool sgct_core::ReadConfig::readAndParseXML(tinyxml2::XMLDocument& xmlDoc)
             {
                 sgct::SGCTSettings::instance()->setCaptureFormat( element[0]->Attribute("format") );
             }
+
+            if( element[0]->Attribute("streamTarget") != NULL )
+            {
+                sgct::SGCTSettings::instance()->setCaptureStreamTarget( element[0]->Attribute("streamTarget") );
+            }
+
+            int tmpFps = 0;
+            if( element[0]->QueryIntAttribute("streamFrameRate", &tmpFps) == tinyxml2::XML_NO_ERROR && tmpFps > 0 )
+            {
+                sgct::SGCTSettings::instance()->setCaptureStreamFrameRate( tmpFps );
+            }
         }
         else if( strcmp("Tracker", val[0]) == 0 && element[0]->Attribute("name") != NULL )
         {
@@ -802,6 +868,106 @@ bool sgct_core::ReadConfig::readAndParseXML(tinyxml2::XMLDocument& xmlDoc)
     return true;
 }
 
+/*!
+Read the part of the configuration that was skipped because it comes from a snapshot. Used by the master
+which creates the snapshot from its own file.
+*/
+bool sgct_core::ReadConfig::parseContents()
+{
+    if( !mSnapshotPending )
+        return true;
+
+    if( !readAndParseXMLContents(mXmlDoc) )
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "ReadConfig: Error occured while reading config file '%s'\nError: %s\n", xmlFileName.c_str(), mErrorMsg.c_str());
+        return false;
+    }
+
+    mSnapshotPending = false;
+    return true;
+}
+
+/*!
+Encode the configuration file of this node as a snapshot.
+\returns false if no configuration file was read
+*/
+bool sgct_core::ReadConfig::createSnapshot(std::vector<char> & snapshot)
+{
+    return ClusterConfigSnapshot::encode(mXmlDoc, snapshot);
+}
+
+/*!
+Read the configuration the master sent. The cluster and nodes must match the ones this node read from its own file,
+differences in anything else are reported and the master's configuration is used.
+*/
+bool sgct_core::ReadConfig::parseSnapshot(const std::vector<char> & snapshot)
+{
+    tinyxml2::XMLDocument xmlDoc;
+    std::string errorMsg;
+    if( !ClusterConfigSnapshot::decode(snapshot.data(), snapshot.size(), xmlDoc, errorMsg) )
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "ReadConfig: Invalid configuration snapshot from master: %s\n", errorMsg.c_str());
+        return false;
+    }
+
+    std::vector<char> localSnapshot;
+    unsigned long long masterHash = ClusterConfigSnapshot::hash(snapshot);
+    if( createSnapshot(localSnapshot) && ClusterConfigSnapshot::hash(localSnapshot) != masterHash )
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING,
+            "ReadConfig: Config file '%s' differs from the master's (hash %016llx, master %016llx), using the master's configuration.\n",
+            xmlFileName.c_str(), ClusterConfigSnapshot::hash(localSnapshot), masterHash);
+    else
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "ReadConfig: Configuration snapshot hash %016llx.\n", masterHash);
+
+    if( !verifySnapshotNodes(xmlDoc) || !readAndParseXMLContents(xmlDoc) )
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "ReadConfig: Error occured while reading configuration snapshot\nError: %s\n", mErrorMsg.c_str());
+        return false;
+    }
+
+    mSnapshotPending = false;
+    return true;
+}
+
+/*!
+\returns true if the nodes in the document have the same addresses and sync ports as the ones read by readAndParseXMLCluster
+*/
+bool sgct_core::ReadConfig::verifySnapshotNodes(tinyxml2::XMLDocument& xmlDoc)
+{
+    tinyxml2::XMLElement* XMLroot = xmlDoc.FirstChildElement( "Cluster" );
+    if( XMLroot == NULL )
+    {
+        mErrorMsg.assign("Cannot find XML root!");
+        return false;
+    }
+
+    std::size_t nodeIndex = 0;
+    for(tinyxml2::XMLElement* element = XMLroot->FirstChildElement( "Node" ); element != NULL; element = element->NextSiblingElement( "Node" ))
+    {
+        SGCTNode * nodePtr = ClusterManager::instance()->getNodePtr(nodeIndex++);
+        if( nodePtr == NULL )
+            break;
+
+        const char * address = element->Attribute( "ip" ) ? element->Attribute( "ip" ) : element->Attribute( "address" );
+        const char * port = element->Attribute( "syncPort" ) ? element->Attribute( "syncPort" ) : element->Attribute( "port" );
+        if( address == NULL || nodePtr->getAddress().compare(address) != 0 ||
+            port == NULL || nodePtr->getSyncPort().compare(port) != 0 )
+        {
+            std::stringstream ss;
+            ss << "Node " << (nodeIndex - 1) << " differs from the master's configuration!";
+            mErrorMsg = ss.str();
+            return false;
+        }
+    }
+
+    if( nodeIndex != ClusterManager::instance()->getNumberOfNodes() )
+    {
+        mErrorMsg.assign("Number of nodes differs from the master's configuration!");
+        return false;
+    }
+    return true;
+}
+
 sgct::SGCTWindow::StereoMode sgct_core::ReadConfig::getStereoType( std::string type )
 {
     std::transform(type.begin(), type.end(), type.begin(), ::tolower);
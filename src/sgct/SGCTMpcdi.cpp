@@ -14,6 +14,7 @@
 #include <sgct/SGCTMpcdi.h>
 #include <algorithm>
 #include <sstream>
+#include <thread>
 #include "unzip.h"
 #include <zip.h>
 
@@ -93,8 +94,11 @@ bool sgct_core::SGCTMpcdi::parseConfiguration(const std::string filenameMpcdi,
         }
     }
     unzClose(zipfile);
-    bool hasXmlFile = mMpcdiSubFileContents.hasFound[MpcdiSubFiles::mpcdiXml];
-    bool hasPfmFile = mMpcdiSubFileContents.hasFound[MpcdiSubFiles::mpcdiPfm];
+    bool hasXmlFile = mMpcdiSubFileContents.hasXml;
+    bool hasPfmFile = false;
+    for (std::size_t i = 0; i < mMpcdiSubFileContents.entries.size(); ++i)
+        if (doesStringHaveSuffix(mMpcdiSubFileContents.entries[i].filename, "pfm"))
+            hasPfmFile = true;
     if( !hasXmlFile || !hasPfmFile)
     {
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
@@ -102,10 +106,11 @@ bool sgct_core::SGCTMpcdi::parseConfiguration(const std::string filenameMpcdi,
             filenameMpcdi.c_str());
         return false;
     }
+    mFilename = filenameMpcdi;
     if( !readAndParseXMLString(tmpNode, tmpWin) )
         return false;
     else
-        return true;
+        return decodeSubFiles();
 }
 
 bool sgct_core::SGCTMpcdi::openZipFile(FILE* cfgFile, const std::string cfgFilePath,
@@ -133,59 +138,163 @@ bool sgct_core::SGCTMpcdi::openZipFile(FILE* cfgFile, const std::string cfgFileP
     return true;
 }
 
+/*!
+Record where each file is in the archive. Only the xml is read here, warp fields and masks are streamed by
+decodeSubFiles once the xml tells which ones are used.
+*/
 bool sgct_core::SGCTMpcdi::processSubFiles(std::string filename, unzFile* zipfile,
                                                  unz_file_info& file_info)
 {
-    for (int i = 0; i < mMpcdiSubFileContents.mpcdi_nRequiredFiles; ++i)
+    if( !mMpcdiSubFileContents.hasXml && doesStringHaveSuffix(filename, "xml") )
+    {
+        mMpcdiSubFileContents.hasXml = true;
+        mMpcdiSubFileContents.xmlFilename = filename;
+        return readXmlFile(zipfile, file_info);
+    }
+
+    MpcdiArchiveEntry entry;
+    entry.filename = filename;
+    entry.size = file_info.uncompressed_size;
+    if( unzGetFilePos(*zipfile, &entry.position) != UNZ_OK )
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "parseMpcdiConfiguration: Unable to get the position of %s\n", filename.c_str());
+        return false;
+    }
+    mMpcdiSubFileContents.entries.push_back(entry);
+    return true;
+}
+
+bool sgct_core::SGCTMpcdi::readXmlFile(unzFile* zipfile, unz_file_info& file_info)
+{
+    const std::string & filename = mMpcdiSubFileContents.xmlFilename;
+    int openCurrentFile = unzOpenCurrentFile(*zipfile);
+    if( openCurrentFile != UNZ_OK )
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "parseMpcdiConfiguration: Unable to open %s\n", filename.c_str());
+        return false;
+    }
+
+    mMpcdiSubFileContents.xmlBuffer.resize(file_info.uncompressed_size);
+    int error = file_info.uncompressed_size == 0 ? 0 :
+        unzReadCurrentFile(*zipfile, mMpcdiSubFileContents.xmlBuffer.data(),
+                           static_cast<unsigned int>(file_info.uncompressed_size));
+    unzCloseCurrentFile(*zipfile);
+    if (error < 0)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "parseMpcdiConfiguration: xml read from %s failed.\n", filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+/*!
+Decode the warp fields and masks referenced by the xml. The files are independent so they are decompressed and
+decoded in parallel, each thread with its own handle to the archive. PFM data is decoded block by block as it is
+decompressed so only the final warp field is kept in memory.
+*/
+bool sgct_core::SGCTMpcdi::decodeSubFiles()
+{
+    if (mSubFileTasks.empty())
+        return true;
+
+    std::size_t numberOfThreads = static_cast<std::size_t>(std::max(sgct::SGCTSettings::instance()->getNumberOfLoaderThreads(), 1));
+    numberOfThreads = std::min(numberOfThreads, mSubFileTasks.size());
+    mNextSubFileTask = 0;
+
+    if (numberOfThreads == 1)
+        decodeSubFileTasks();
+    else
+    {
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < numberOfThreads; i++)
+            threads.push_back(std::thread(&SGCTMpcdi::decodeSubFileTasks, this));
+
+        for (std::size_t i = 0; i < threads.size(); i++)
+            threads[i].join();
+    }
+
+    //hand the results over to the viewports
+    bool status = true;
+    for (std::size_t i = 0; i < mSubFileTasks.size(); i++)
     {
-        if( !mMpcdiSubFileContents.hasFound[i]
-			&& doesStringHaveSuffix(filename, mMpcdiSubFileContents.extension[i]))
+        MpcdiSubFileTask & task = mSubFileTasks[i];
+        if (!task.status)
         {
-            mMpcdiSubFileContents.hasFound[i] = true;
-            mMpcdiSubFileContents.size[i] = file_info.uncompressed_size;
-            mMpcdiSubFileContents.filename[i] = filename;
-            int openCurrentFile = unzOpenCurrentFile(*zipfile);
-            if( openCurrentFile != UNZ_OK )
-            {
-                sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
-                    "parseMpcdiConfiguration: Unable to open %s\n", filename.c_str());
-                unzClose(*zipfile);
-                return false;
-            }
-            mMpcdiSubFileContents.buffer[i] = new char[file_info.uncompressed_size];
-            if( mMpcdiSubFileContents.buffer[i] != nullptr)
-            {
-                int error = unzReadCurrentFile(*zipfile, mMpcdiSubFileContents.buffer[i],
-                                               file_info.uncompressed_size);
-                if (error < 0)
-                {
-                    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
-                        "parseMpcdiConfiguration: %s read from %s failed.\n",
-                        mMpcdiSubFileContents.extension[i].c_str(), filename.c_str());
-                    unzClose(*zipfile);
-                    return false;
-                }
-            }
-            else
-            {
-                sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
-                    "parseMpcdiConfiguration: Unable to allocate memory for %s\n", filename.c_str());
-                unzClose(*zipfile);
-                return false;
-            }
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+                "parseMpcdiConfiguration: Failed to decode %s\n", task.path.c_str());
+            delete task.imagePtr;
+            task.imagePtr = nullptr;
+            //the geometry is required, a missing mask only disables blending
+            if (task.type == Viewport::CORRECTION_MESH_DATA)
+                status = false;
+        }
+        else if (task.type == Viewport::CORRECTION_MESH_DATA)
+            task.viewportPtr->setMpcdiWarpGrid(task.grid);
+        else
+        {
+            task.viewportPtr->setMpcdiMask(task.type, task.imagePtr, task.path);
+            task.imagePtr = nullptr;
         }
     }
-    return true;
+    mSubFileTasks.clear();
+    return status;
+}
+
+void sgct_core::SGCTMpcdi::decodeSubFileTasks()
+{
+    unzFile zipfile = unzOpen(mFilename.c_str());
+    for (std::size_t i = mNextSubFileTask++; i < mSubFileTasks.size(); i = mNextSubFileTask++)
+        mSubFileTasks[i].status = zipfile != nullptr && decodeSubFile(zipfile, mSubFileTasks[i]);
+
+    if (zipfile != nullptr)
+        unzClose(zipfile);
+}
+
+bool sgct_core::SGCTMpcdi::decodeSubFile(unzFile zipfile, MpcdiSubFileTask & task)
+{
+    MpcdiArchiveEntry & entry = mMpcdiSubFileContents.entries[task.entryIndex];
+    if (unzGoToFilePos(zipfile, &entry.position) != UNZ_OK || unzOpenCurrentFile(zipfile) != UNZ_OK)
+        return false;
+
+    bool status = false;
+    if (task.type == Viewport::CORRECTION_MESH_DATA)
+    {
+        const unsigned int BlockSize = 64 * 1024;
+        std::vector<char> block(BlockSize);
+        task.grid.reset();
+        int bytesRead;
+        status = true;
+        while (status && (bytesRead = unzReadCurrentFile(zipfile, block.data(), BlockSize)) > 0)
+            status = task.grid.decode(block.data(), static_cast<std::size_t>(bytesRead));
+        status = status && bytesRead == 0 && task.grid.finish();
+    }
+    else
+    {
+        //the png decoder needs the whole file
+        std::vector<unsigned char> data(entry.size);
+        int bytesRead = entry.size == 0 ? 0 : unzReadCurrentFile(zipfile, data.data(), static_cast<unsigned int>(entry.size));
+        if (bytesRead == static_cast<int>(entry.size) && bytesRead > 0)
+        {
+            task.imagePtr = new Image();
+            status = task.imagePtr->loadPNG(data.data(), data.size()) && task.imagePtr->getData() != nullptr;
+        }
+    }
+
+    unzCloseCurrentFile(zipfile);
+    return status;
 }
 
 bool sgct_core::SGCTMpcdi::readAndParseXMLString(SGCTNode& tmpNode, sgct::SGCTWindow& tmpWin)
 {
     bool mpcdiParseResult = false;
-    if (mMpcdiSubFileContents.buffer[MpcdiSubFiles::mpcdiXml] != nullptr)
+    if (!mMpcdiSubFileContents.xmlBuffer.empty())
     {
         tinyxml2::XMLDocument xmlDoc;
-        tinyxml2::XMLError result = xmlDoc.Parse(mMpcdiSubFileContents.buffer[MpcdiSubFiles::mpcdiXml],
-            mMpcdiSubFileContents.size[MpcdiSubFiles::mpcdiXml]);
+        tinyxml2::XMLError result = xmlDoc.Parse(mMpcdiSubFileContents.xmlBuffer.data(),
+            mMpcdiSubFileContents.xmlBuffer.size());
 
         if (result != tinyxml2::XML_NO_ERROR)
         {
@@ -323,8 +432,18 @@ bool sgct_core::SGCTMpcdi::readAndParseXML_files(tinyxml2::XMLElement* element[]
                                                           filesetRegionId) )
                         return false;
                 }
-                unsupportedFeatureCheck(val[2], "alphaMap");
-                unsupportedFeatureCheck(val[2], "betaMap");
+                else if( strcmp("alphaMap", val[2]) == 0 )
+                {
+                    if(! readAndParseXML_maskFile(element, tmpWin, filesetRegionId,
+                                                  Viewport::BLEND_MASK_DATA) )
+                        return false;
+                }
+                else if( strcmp("betaMap", val[2]) == 0 )
+                {
+                    if(! readAndParseXML_maskFile(element, tmpWin, filesetRegionId,
+                                                  Viewport::BLACK_LEVEL_MASK_DATA) )
+                        return false;
+                }
                 unsupportedFeatureCheck(val[2], "distortionMap");
                 unsupportedFeatureCheck(val[2], "decodeLUT");
                 unsupportedFeatureCheck(val[2], "correctLUT");
@@ -372,26 +491,9 @@ bool sgct_core::SGCTMpcdi::readAndParseXML_geoWarpFile(tinyxml2::XMLElement* ele
     {
         //Look for matching MPCDI region (SGCT viewport) to pass
         // the warp field data to
-        bool foundMatchingPfmBuffer = false;
-        for (int r = 0; r < tmpWin.getNumberOfViewports(); ++r)
-        {
-            std::string tmpWindowName = tmpWin.getViewport(r)->getName();
-            std::string currRegion_warpName = mWarp.back()->id;
-            if( tmpWindowName.compare(currRegion_warpName) == 0 )
-            {
-                std::string currRegion_warpFilename = mWarp.back()->pathWarpFile;
-                std::string matchingMpcdiDataFile
-                    = mMpcdiSubFileContents.filename[MpcdiSubFiles::mpcdiPfm];
-                if( currRegion_warpFilename.compare(matchingMpcdiDataFile) == 0 )
-                {
-                    tmpWin.getViewport(r)->setMpcdiWarpMesh(
-                        mMpcdiSubFileContents.buffer[MpcdiSubFiles::mpcdiPfm],
-                        mMpcdiSubFileContents.size[MpcdiSubFiles::mpcdiPfm]);
-                    foundMatchingPfmBuffer = true;
-                }
-            }
-        }
-        if( !foundMatchingPfmBuffer )
+        Viewport * vpPtr = findRegionViewport(tmpWin, mWarp.back()->id);
+        if( vpPtr == nullptr
+           || !addSubFileTask(mWarp.back()->pathWarpFile, vpPtr, Viewport::CORRECTION_MESH_DATA) )
         {
             sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
                 "parseMpcdiXml: matching geometryWarpFile not found.\n");
@@ -408,6 +510,70 @@ bool sgct_core::SGCTMpcdi::readAndParseXML_geoWarpFile(tinyxml2::XMLElement* ele
 }
 
 
+/*!
+Queue an alphaMap (blend mask) or betaMap (black level mask) of a region for decoding
+*/
+bool sgct_core::SGCTMpcdi::readAndParseXML_maskFile(tinyxml2::XMLElement* element[],
+                                                          sgct::SGCTWindow& tmpWin,
+                                                          std::string filesetRegionId,
+                                                          Viewport::DataType type)
+{
+    const char * tag = element[2]->Value();
+    tinyxml2::XMLElement* pathElement = element[2]->FirstChildElement("path");
+    if( pathElement == NULL || pathElement->GetText() == NULL )
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "parseMpcdiXml: %s requires a path.\n", tag);
+        return false;
+    }
+
+    Viewport * vpPtr = findRegionViewport(tmpWin, filesetRegionId);
+    if( vpPtr == nullptr || !addSubFileTask(pathElement->GetText(), vpPtr, type) )
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "parseMpcdiXml: matching %s '%s' not found.\n", tag, pathElement->GetText());
+        return false;
+    }
+    return true;
+}
+
+sgct_core::Viewport * sgct_core::SGCTMpcdi::findRegionViewport(sgct::SGCTWindow& tmpWin,
+                                                               const std::string & regionId)
+{
+    for (int r = 0; r < tmpWin.getNumberOfViewports(); ++r)
+    {
+        if( tmpWin.getViewport(r)->getName().compare(regionId) == 0 )
+            return tmpWin.getViewport(r);
+    }
+    return nullptr;
+}
+
+/*!
+Queue a file of the archive for decodeSubFiles
+\returns false if the archive doesn't contain the file
+*/
+bool sgct_core::SGCTMpcdi::addSubFileTask(const std::string & path, Viewport * vpPtr,
+                                          Viewport::DataType type)
+{
+    const std::vector<MpcdiArchiveEntry> & entries = mMpcdiSubFileContents.entries;
+    for (std::size_t i = 0; i < entries.size(); ++i)
+    {
+        if( entries[i].filename.compare(path) == 0 )
+        {
+            mSubFileTasks.push_back(MpcdiSubFileTask());
+            MpcdiSubFileTask & task = mSubFileTasks.back();
+            task.path = path;
+            task.entryIndex = i;
+            task.viewportPtr = vpPtr;
+            task.type = type;
+            task.imagePtr = nullptr;
+            task.status = false;
+            return true;
+        }
+    }
+    return false;
+}
+
 bool sgct_core::SGCTMpcdi::readAndParseXML_buffer(tinyxml2::XMLElement* element[],
                                                         const char* val[],
                                                         sgct::SGCTWindow& tmpWin,
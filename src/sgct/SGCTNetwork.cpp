@@ -48,14 +48,17 @@ For conditions of distribution and use, see copyright notice in sgct.h
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <algorithm>
 
 #define MAX_NUMBER_OF_ATTEMPS 10
 #define SGCT_SOCKET_BUFFER_SIZE 4096
+#define SGCT_TEST_LINK_READ_SIZE 65536
 
 sgct_core::SGCTNetwork::SGCTNetwork()
 {
     mCommThread        = nullptr;
     mMainThread        = nullptr;
+    mTestLinkThread    = nullptr;
     mRecvBuf        = nullptr;
     mUncompressBuf    = nullptr;
     mSocket            = INVALID_SOCKET;
@@ -66,6 +69,10 @@ sgct_core::SGCTNetwork::SGCTNetwork()
     mConnectedCallbackFn        = SGCT_NULL_PTR;
     mAcknowledgeCallbackFn        = SGCT_NULL_PTR;
     mPackageDecoderCallbackFn    = SGCT_NULL_PTR;
+    mConfigurationCallbackFn    = SGCT_NULL_PTR;
+    mReloadCallbackFn            = SGCT_NULL_PTR;
+    mTraceCallbackFn            = SGCT_NULL_PTR;
+    mClockSyncCallbackFn        = SGCT_NULL_PTR;
 
     mConnectionType        = SyncConnection;
     mBufferSize            = 1024;
@@ -82,6 +89,15 @@ sgct_core::SGCTNetwork::SGCTNetwork()
     mConnected            = false;
     mTerminate          = false;
     mUseNaglesAlgorithmInDataTransfer = false;
+    mTestLatency        = 0.0;
+    mTestBandwidth        = 0.0;
+    mTestLinkFreeTime    = 0.0;
+    mTestLinkOpen        = false;
+    mTestLinkResult        = 0;
+    mBytesSent            = 0;
+    mBytesReceived        = 0;
+    mMessagesSent        = 0;
+    mMessagesReceived    = 0;
     
     static int id = 0;
     mId = id;
@@ -615,6 +631,47 @@ void sgct_core::SGCTNetwork::setAcknowledgeFunction(sgct_cppxeleven::function<vo
     mAcknowledgeCallbackFn = callback;
 }
 
+void sgct_core::SGCTNetwork::setConfigurationFunction(sgct_cppxeleven::function<void(const char*, int, int)> callback)
+{
+    mConfigurationCallbackFn = callback;
+}
+
+void sgct_core::SGCTNetwork::setReloadFunction(sgct_cppxeleven::function<void(int, unsigned int, int, int)> callback)
+{
+    mReloadCallbackFn = callback;
+}
+
+void sgct_core::SGCTNetwork::setTraceFunction(sgct_cppxeleven::function<void(SGCTNetwork *, const char*, int, int)> callback)
+{
+    mTraceCallbackFn = callback;
+}
+
+void sgct_core::SGCTNetwork::setClockSyncFunction(sgct_cppxeleven::function<void(SGCTNetwork *, const char*, int, int)> callback)
+{
+    mClockSyncCallbackFn = callback;
+}
+
+/*!
+Set a message that the server sends to every client that connects, before the connection is used for anything else.
+*/
+void sgct_core::SGCTNetwork::setConnectMessage(const std::vector<char> & message)
+{
+    mConnectMessage = message;
+}
+
+/*!
+Impairs the link of a sync connection for testing, received data is held back by the latency in seconds plus the
+time it would take to transfer it at the bandwidth in bytes per second. Zero disables either. Must be set before init.
+
+The data is read from the socket by a thread of its own as soon as it arrives and handed to the connection when it
+would have arrived over the test link, so several messages can be in flight like on a real link.
+*/
+void sgct_core::SGCTNetwork::setTestLink(double latency, double bandwidth)
+{
+    mTestLatency = latency > 0.0 ? latency : 0.0;
+    mTestBandwidth = bandwidth > 0.0 ? bandwidth : 0.0;
+}
+
 void sgct_core::SGCTNetwork::setConnectedStatus(bool state)
 {
 #ifdef __SGCT_NETWORK_DEBUG__
@@ -775,14 +832,18 @@ void sgct_core::SGCTNetwork::updateBuffer(char ** buffer, uint32_t requested_siz
 
 int sgct_core::SGCTNetwork::readSyncMessage(char * _header, int32_t & _syncFrameNumber, uint32_t & _dataSize, uint32_t & _uncompressedDataSize)
 {
-    int iResult = sgct_core::SGCTNetwork::receiveData(mSocket,
-        _header,
-        static_cast<int>(sgct_core::SGCTNetwork::mHeaderSize),
-        0);
+    int iResult = mTestLinkThread != nullptr ?
+        receiveTestLinkData(_header, static_cast<int>(sgct_core::SGCTNetwork::mHeaderSize)) :
+        sgct_core::SGCTNetwork::receiveData(mSocket,
+            _header,
+            static_cast<int>(sgct_core::SGCTNetwork::mHeaderSize),
+            0);
 
     if (iResult == static_cast<int>(sgct_core::SGCTNetwork::mHeaderSize))
     {
         mHeaderId = _header[0];
+        mMessagesReceived++;
+        mBytesReceived += mHeaderSize;
 #ifdef __SGCT_NETWORK_DEBUG__
         sgct::MessageHandler::instance()->printDebug(sgct::MessageHandler::NOTIFY_INFO, "Header id=%d...\n", mHeaderId);
 #endif
@@ -817,6 +878,42 @@ int sgct_core::SGCTNetwork::readSyncMessage(char * _header, int32_t & _syncFrame
             fprintf(stderr, "Mutex for connection %d is unlocked.\n", mId);
 #endif
         }
+        else if (mHeaderId == sgct_core::SGCTNetwork::ConfigurationId)
+        {
+            //the configuration snapshot is always compressed and doesn't count as a sync frame
+            _dataSize = sgct_core::SGCTNetwork::parseUInt32(&_header[5]);
+            _uncompressedDataSize = sgct_core::SGCTNetwork::parseUInt32(&_header[9]);
+
+            updateBuffer(&mRecvBuf, _dataSize, mBufferSize);
+            updateBuffer(&mUncompressBuf, _uncompressedDataSize, mUncompressedBufferSize);
+        }
+        else if (mHeaderId == sgct_core::SGCTNetwork::ReloadId)
+        {
+            //the whole message is in the header, see sendReloadMessage
+            _syncFrameNumber = sgct_core::SGCTNetwork::parseInt32(&_header[1]);
+            _dataSize = 0;
+        }
+        else if (mHeaderId == sgct_core::SGCTNetwork::ClockSyncId)
+        {
+            //a request is only a header, a reply holds the two master time stamps
+            _syncFrameNumber = sgct_core::SGCTNetwork::parseInt32(&_header[1]);
+            _dataSize = sgct_core::SGCTNetwork::parseUInt32(&_header[5]);
+            if (_dataSize > 0)
+                updateBuffer(&mRecvBuf, _dataSize, mBufferSize);
+        }
+        else if (mHeaderId == sgct_core::SGCTNetwork::TraceId)
+        {
+            //a request is only a header, a reply holds the compressed trace
+            _syncFrameNumber = sgct_core::SGCTNetwork::parseInt32(&_header[1]);
+            _dataSize = sgct_core::SGCTNetwork::parseUInt32(&_header[5]);
+            _uncompressedDataSize = sgct_core::SGCTNetwork::parseUInt32(&_header[9]);
+
+            if (_dataSize > 0)
+            {
+                updateBuffer(&mRecvBuf, _dataSize, mBufferSize);
+                updateBuffer(&mUncompressBuf, _uncompressedDataSize, mUncompressedBufferSize);
+            }
+        }
     }
 
 #ifdef __SGCT_NETWORK_DEBUG__
@@ -828,15 +925,103 @@ int sgct_core::SGCTNetwork::readSyncMessage(char * _header, int32_t & _syncFrame
     */
     if (_dataSize > 0)
     {
-        iResult = sgct_core::SGCTNetwork::receiveData(mSocket,
-            mRecvBuf,
-            _dataSize,
-            0);
+        iResult = mTestLinkThread != nullptr ?
+            receiveTestLinkData(mRecvBuf, static_cast<int>(_dataSize)) :
+            sgct_core::SGCTNetwork::receiveData(mSocket,
+                mRecvBuf,
+                _dataSize,
+                0);
+        if (iResult > 0)
+            mBytesReceived += iResult;
     }
 
     return iResult;
 }
 
+/*!
+Reads the socket of a sync connection with a test link as fast as the data arrives. The data is queued with the time
+it would have arrived over the test link, see setTestLink and receiveTestLinkData.
+*/
+void sgct_core::SGCTNetwork::readTestLink()
+{
+    std::vector<char> buffer(SGCT_TEST_LINK_READ_SIZE);
+    int attempts = 1;
+    while (true)
+    {
+        _ssize_t iResult = recv(mSocket, &buffer[0], static_cast<int>(buffer.size()), 0);
+#ifdef __WIN32__
+        if (iResult < 0 && SGCT_ERRNO == WSAEINTR && attempts <= MAX_NUMBER_OF_ATTEMPS)
+#else
+        if (iResult < 0 && SGCT_ERRNO == EINTR && attempts <= MAX_NUMBER_OF_ATTEMPS)
+#endif
+        {
+            attempts++;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mTestLinkMutex);
+        if (iResult <= 0)
+        {
+            mTestLinkOpen = false;
+            mTestLinkResult = iResult;
+            mTestLinkCond.notify_all();
+            return;
+        }
+
+        //the bandwidth queues the data behind what is still being transferred, the latency doesn't
+        double now = sgct::Engine::getTime();
+        double transferred = mTestLinkFreeTime > now ? mTestLinkFreeTime : now;
+        if (mTestBandwidth > 0.0)
+            transferred += static_cast<double>(iResult) / mTestBandwidth;
+        mTestLinkFreeTime = transferred;
+
+        TestLinkChunk chunk;
+        chunk.mReleaseTime = transferred + mTestLatency;
+        chunk.mData.assign(buffer.begin(), buffer.begin() + iResult);
+        chunk.mRead = 0;
+        mTestLinkChunks.push_back(std::move(chunk));
+        mTestLinkCond.notify_all();
+    }
+}
+
+/*!
+Receives data from the test link queue like receiveData does from the socket, waiting until the data would have
+arrived over the test link.
+\returns length, or the result of the recv that closed the link if it is closed before length bytes arrived
+*/
+_ssize_t sgct_core::SGCTNetwork::receiveTestLinkData(char * buffer, int length)
+{
+    int received = 0;
+    std::unique_lock<std::mutex> lock(mTestLinkMutex);
+    while (received < length)
+    {
+        if (mTestLinkChunks.empty())
+        {
+            if (!mTestLinkOpen)
+                return mTestLinkResult;
+            mTestLinkCond.wait(lock);
+            continue;
+        }
+
+        TestLinkChunk & chunk = mTestLinkChunks.front();
+        double delay = chunk.mReleaseTime - sgct::Engine::getTime();
+        if (delay > 0.0)
+        {
+            mTestLinkCond.wait_for(lock, std::chrono::microseconds(static_cast<long long>(delay * 1e6) + 1));
+            continue;
+        }
+
+        std::size_t size = std::min(chunk.mData.size() - chunk.mRead, static_cast<std::size_t>(length - received));
+        memcpy(buffer + received, &chunk.mData[chunk.mRead], size);
+        chunk.mRead += size;
+        received += static_cast<int>(size);
+        if (chunk.mRead == chunk.mData.size())
+            mTestLinkChunks.pop_front();
+    }
+
+    return received;
+}
+
 int sgct_core::SGCTNetwork::readDataTransferMessage(char * _header, int32_t & _packageId, uint32_t & _dataSize, uint32_t & _uncompressedDataSize)
 {
     int iResult = sgct_core::SGCTNetwork::receiveData(mSocket,
@@ -847,6 +1032,8 @@ int sgct_core::SGCTNetwork::readDataTransferMessage(char * _header, int32_t & _p
     if (iResult == static_cast<int>(sgct_core::SGCTNetwork::mHeaderSize))
     {
         mHeaderId = _header[0];
+        mMessagesReceived++;
+        mBytesReceived += mHeaderSize;
 #ifdef __SGCT_NETWORK_DEBUG__
         sgct::MessageHandler::instance()->printDebug(sgct::MessageHandler::NOTIFY_INFO, "Header id=%d...\n", mHeaderId);
 #endif
@@ -891,6 +1078,8 @@ int sgct_core::SGCTNetwork::readDataTransferMessage(char * _header, int32_t & _p
             mRecvBuf,
             _dataSize,
             0);
+        if (iResult > 0)
+            mBytesReceived += iResult;
 #ifdef __SGCT_NETWORK_DEBUG__
         sgct::MessageHandler::instance()->printDebug(sgct::MessageHandler::NOTIFY_INFO, "Data type: %d, %d bytes of %u...\n", _packageId, iResult, _dataSize);
 #endif
@@ -923,6 +1112,12 @@ int sgct_core::SGCTNetwork::readExternalMessage()
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO, "Receiving data after interrupted system error (attempt %d)...\n", attempts);
         attempts++;
     }
+
+    if (iResult > 0)
+    {
+        mMessagesReceived++;
+        mBytesReceived += iResult;
+    }
     
     return iResult;
 }
@@ -972,6 +1167,10 @@ void sgct_core::SGCTNetwork::communicationHandler()
         }
     }
 
+    //sent before the connection is marked as connected so no sync data can be sent before it
+    if (mServer && !mConnectMessage.empty())
+        sendData(mConnectMessage.data(), static_cast<int>(mConnectMessage.size()));
+
     setConnectedStatus(true);
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO, "Connection %d established!\n", mId);
 
@@ -989,6 +1188,15 @@ void sgct_core::SGCTNetwork::communicationHandler()
     
     std::string extBuffer; //for external comm
 
+    if (getType() == sgct_core::SGCTNetwork::SyncConnection && (mTestLatency > 0.0 || mTestBandwidth > 0.0))
+    {
+        mTestLinkChunks.clear();
+        mTestLinkOpen = true;
+        mTestLinkResult = 0;
+        mTestLinkFreeTime = 0.0;
+        mTestLinkThread = new std::thread(&SGCTNetwork::readTestLink, this);
+    }
+
     // Receive data until the server closes the connection
     _ssize_t iResult = 0;
     do
@@ -1113,6 +1321,62 @@ void sgct_core::SGCTNetwork::communicationHandler()
                          }*/
                         sgct_core::NetworkManager::gCond.notify_all();
                     }
+                    else if (mHeaderId == sgct_core::SGCTNetwork::ConfigurationId &&
+                        mConfigurationCallbackFn != SGCT_NULL_PTR)
+                    {
+                        auto uncompressedSize = static_cast<uLongf>(uncompressedDataSize);
+
+                        int err = uncompress(
+                                             reinterpret_cast<Bytef*>(mUncompressBuf),
+                                             &uncompressedSize,
+                                             reinterpret_cast<Bytef*>(mRecvBuf),
+                                             static_cast<uLongf>(dataSize));
+
+                        if(err == Z_OK && uncompressedSize == static_cast<uLongf>(uncompressedDataSize))
+                            (mConfigurationCallbackFn)(mUncompressBuf, static_cast<int>(uncompressedSize), mId);
+                        else
+                        {
+                            if(err == Z_OK)
+                                sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Network: Configuration for connection %d has the wrong size!\n", mId);
+                            else
+                                sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Network: Failed to uncompress configuration for connection %d! Error: %s\n", mId, getUncompressionErrorAsStr(err).c_str());
+
+                            //let the waiting slave know that the configuration won't arrive
+                            (mConfigurationCallbackFn)(nullptr, 0, mId);
+                        }
+                    }
+                    else if (mHeaderId == sgct_core::SGCTNetwork::ReloadId &&
+                        mReloadCallbackFn != SGCT_NULL_PTR)
+                    {
+                        (mReloadCallbackFn)(static_cast<unsigned char>(recvHeader[5]),
+                            sgct_core::SGCTNetwork::parseUInt32(&recvHeader[9]), syncFrameNumber, mId);
+                    }
+                    else if (mHeaderId == sgct_core::SGCTNetwork::ClockSyncId &&
+                        mClockSyncCallbackFn != SGCT_NULL_PTR)
+                    {
+                        (mClockSyncCallbackFn)(this, dataSize > 0 ? mRecvBuf : nullptr, static_cast<int>(dataSize), syncFrameNumber);
+                    }
+                    else if (mHeaderId == sgct_core::SGCTNetwork::TraceId &&
+                        mTraceCallbackFn != SGCT_NULL_PTR)
+                    {
+                        if (dataSize == 0)
+                            (mTraceCallbackFn)(this, nullptr, 0, syncFrameNumber);
+                        else
+                        {
+                            auto uncompressedSize = static_cast<uLongf>(uncompressedDataSize);
+
+                            int err = uncompress(
+                                                 reinterpret_cast<Bytef*>(mUncompressBuf),
+                                                 &uncompressedSize,
+                                                 reinterpret_cast<Bytef*>(mRecvBuf),
+                                                 static_cast<uLongf>(dataSize));
+
+                            if (err == Z_OK)
+                                (mTraceCallbackFn)(this, mUncompressBuf, static_cast<int>(uncompressedSize), syncFrameNumber);
+                            else
+                                sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Network: Failed to uncompress trace for connection %d! Error: %s\n", mId, getUncompressionErrorAsStr(err).c_str());
+                        }
+                    }
                     else if (mHeaderId == sgct_core::SGCTNetwork::ConnectedId &&
                         mConnectedCallbackFn != SGCT_NULL_PTR)
                     {
@@ -1387,6 +1651,14 @@ void sgct_core::SGCTNetwork::communicationHandler()
     //contains mutex
     closeSocket( mSocket );
 
+    //the closed socket ends the test link thread
+    if (mTestLinkThread != nullptr)
+    {
+        mTestLinkThread->join();
+        delete mTestLinkThread;
+        mTestLinkThread = nullptr;
+    }
+
     if (mUpdateCallbackFn != SGCT_NULL_PTR)
         mUpdateCallbackFn( this );
 
@@ -1404,6 +1676,8 @@ void sgct_core::SGCTNetwork::sendData(const void * data, int length)
     _ssize_t sentLen;
     int sendSize = length;
 
+    std::unique_lock<std::mutex> lk(mSendMutex);
+    mMessagesSent++;
     while (sendSize > 0)
     {
         int offset = length - sendSize;
@@ -1414,10 +1688,75 @@ void sgct_core::SGCTNetwork::sendData(const void * data, int length)
             break;
         }
         else
+        {
             sendSize -= sentLen;
+            mBytesSent += sentLen;
+        }
     }
 }
 
+/*!
+Send a correction data reload message on a sync connection. The message is only a header: byte 1-4 holds the
+value, byte 5 the message type and byte 9-12 the generation of the reload.
+*/
+void sgct_core::SGCTNetwork::sendReloadMessage(int type, unsigned int generation, int32_t value)
+{
+    char message[mHeaderSize];
+    memset(message, DefaultId, mHeaderSize);
+    message[0] = ReloadId;
+    memcpy(&message[1], &value, 4);
+    message[5] = static_cast<char>(type);
+    memcpy(&message[9], &generation, 4);
+    sendData(message, static_cast<int>(mHeaderSize));
+}
+
+/*!
+Ask the node at the other end of a sync connection for its trace. The request is only a header where byte 1-4
+holds the request id, the reply has the same header with the compressed trace size in byte 5-8 and the
+uncompressed size in byte 9-12.
+*/
+void sgct_core::SGCTNetwork::sendTraceRequest(int32_t requestId)
+{
+    char message[mHeaderSize];
+    memset(message, DefaultId, mHeaderSize);
+    message[0] = TraceId;
+    memcpy(&message[1], &requestId, 4);
+    memset(&message[5], 0, 8);
+    sendData(message, static_cast<int>(mHeaderSize));
+}
+
+/*!
+Send a clock synchronization request from a slave, see ClockSync. The request is only a header where byte 1-4 holds
+the request id.
+*/
+void sgct_core::SGCTNetwork::sendClockSyncRequest(int32_t requestId)
+{
+    char message[mHeaderSize];
+    memset(message, DefaultId, mHeaderSize);
+    message[0] = ClockSyncId;
+    memcpy(&message[1], &requestId, 4);
+    memset(&message[5], 0, 8);
+    sendData(message, static_cast<int>(mHeaderSize));
+}
+
+/*!
+Reply to a clock synchronization request with the master times when it was received and when the reply is sent.
+The header holds the request id and the data size, followed by the two times as doubles.
+*/
+void sgct_core::SGCTNetwork::sendClockSyncReply(int32_t requestId, double receiveTime, double sendTime)
+{
+    char message[mHeaderSize + 2 * sizeof(double)];
+    uint32_t dataSize = 2 * sizeof(double);
+    memset(message, DefaultId, mHeaderSize);
+    message[0] = ClockSyncId;
+    memcpy(&message[1], &requestId, 4);
+    memcpy(&message[5], &dataSize, 4);
+    memset(&message[9], 0, 4);
+    memcpy(&message[mHeaderSize], &receiveTime, sizeof(double));
+    memcpy(&message[mHeaderSize + sizeof(double)], &sendTime, sizeof(double));
+    sendData(message, static_cast<int>(sizeof(message)));
+}
+
 void sgct_core::SGCTNetwork::sendStr(std::string msg)
 {
     //sendData(static_cast<void *>(&msg), static_cast<int>(msg.size())); //doesn't work
@@ -1432,6 +1771,10 @@ void sgct_core::SGCTNetwork::closeNetwork(bool forced)
     mConnectedCallbackFn        = SGCT_NULL_PTR;
     mAcknowledgeCallbackFn        = SGCT_NULL_PTR;
     mPackageDecoderCallbackFn    = SGCT_NULL_PTR;
+    mConfigurationCallbackFn    = SGCT_NULL_PTR;
+    mReloadCallbackFn            = SGCT_NULL_PTR;
+    mTraceCallbackFn            = SGCT_NULL_PTR;
+    mClockSyncCallbackFn        = SGCT_NULL_PTR;
 
     //release conditions
     NetworkManager::gCond.notify_all();
@@ -19,6 +19,7 @@ sgct::SGCTSettings::SGCTSettings()
     mJPEGQuality = 100;
 
     mNumberOfCaptureThreads = std::thread::hardware_concurrency();
+    mNumberOfLoaderThreads = std::thread::hardware_concurrency();
 
     mCaptureBackBuffer            = false;
     mUseWarping                    = true;
@@ -32,6 +33,9 @@ sgct::SGCTSettings::SGCTSettings()
     mUseRLE                        = false;
     mTryMaintainAspectRatio        = true;
     mExportWarpingMeshes        = false;
+    mUseWarpMeshCache            = true;
+    mWatchCorrectionData        = false;
+    mWarpMeshDecimationError    = 0.0f;
 
     mSwapInterval = 1;
     mRefreshRate = 0;
@@ -48,6 +52,7 @@ sgct::SGCTSettings::SGCTSettings()
     for(std::string & path : mCapturePath)
         path.assign("SGCT");
     mCaptureFormat = sgct_core::ScreenCapture::NOT_SET;
+    mCaptureStreamFrameRate = 60;
 
     mCurrentDrawBuffer = Diffuse;
     mCurrentBufferFloatPrecision = Float_16Bit;
@@ -134,6 +139,31 @@ void sgct::SGCTSettings::configure(tinyxml2::XMLElement * element)
             if (subElement->Attribute("exportWarpingMeshes") != nullptr)
                 sgct::SGCTSettings::instance()->setExportWarpingMeshes(strcmp(subElement->Attribute("exportWarpingMeshes"), "true") == 0 ? true : false);
         }
+        else if (strcmp("MeshCache", val) == 0)
+        {
+            if (subElement->Attribute("enabled") != nullptr)
+                sgct::SGCTSettings::instance()->setUseWarpMeshCache(strcmp(subElement->Attribute("enabled"), "true") == 0 ? true : false);
+
+            if (subElement->Attribute("path") != nullptr)
+                sgct::SGCTSettings::instance()->setWarpMeshCacheDirectory(subElement->Attribute("path"));
+        }
+        else if (strcmp("HotReload", val) == 0)
+        {
+            if (subElement->Attribute("watch") != nullptr)
+                sgct::SGCTSettings::instance()->setWatchCorrectionData(strcmp(subElement->Attribute("watch"), "true") == 0 ? true : false);
+        }
+        else if (strcmp("MeshDecimation", val) == 0)
+        {
+            float maxError = 0.0f;
+            if (subElement->QueryFloatAttribute("maxError", &maxError) == tinyxml2::XML_NO_ERROR)
+                sgct::SGCTSettings::instance()->setWarpMeshDecimationError(maxError);
+        }
+        else if (strcmp("StartupLoader", val) == 0)
+        {
+            int threads = 0;
+            if (subElement->QueryIntAttribute("threads", &threads) == tinyxml2::XML_NO_ERROR)
+                sgct::SGCTSettings::instance()->setNumberOfLoaderThreads(threads);
+        }
         else if (strcmp("OSDText", val) == 0)
         {
             float x = 0.0f;
@@ -323,6 +353,14 @@ void sgct::SGCTSettings::setNumberOfCaptureThreads(int count)
     mNumberOfCaptureThreads = count;
 }
 
+/*!
+Set the number of threads that decode masks and parse warping meshes at startup. One thread loads everything serially.
+*/
+void sgct::SGCTSettings::setNumberOfLoaderThreads(int count)
+{
+    mNumberOfLoaderThreads = count;
+}
+
 /*!
 Set the zlib compression level used for saving png files
 
@@ -405,6 +443,8 @@ void sgct::SGCTSettings::appendCapturePath(std::string str, sgct::SGCTSettings::
 Set the capture format which can be one of the following:
 -PNG
 -TGA
+-JPG
+-Y4M (all frames streamed into one video, see setCaptureStreamTarget)
 */
 void sgct::SGCTSettings::setCaptureFormat(const char * format)
 {
@@ -422,7 +462,32 @@ void sgct::SGCTSettings::setCaptureFormat(const char * format)
     {
         mCaptureFormat = sgct_core::ScreenCapture::JPEG;
     }
+    else if (strcmp("y4m", format) == 0 || strcmp("Y4M", format) == 0)
+    {
+        mCaptureFormat = sgct_core::ScreenCapture::Y4M;
+    }
+
+    mMutex.unlock();
+}
+
+/*!
+Set the target of Y4M capture streams. If empty (default) the frames are written to a file named after the
+capture path. Otherwise it can be a file, an existing named pipe, "unix:<path>" or "tcp:<port>" (see CaptureStream).
+*/
+void sgct::SGCTSettings::setCaptureStreamTarget(std::string target)
+{
+    mMutex.lock();
+    mCaptureStreamTarget.assign(target);
+    mMutex.unlock();
+}
 
+/*!
+Set the frame rate stored in the header of Y4M capture streams (default 60).
+*/
+void sgct::SGCTSettings::setCaptureStreamFrameRate(int fps)
+{
+    mMutex.lock();
+    mCaptureStreamFrameRate = fps;
     mMutex.unlock();
 }
 
@@ -450,6 +515,30 @@ const int sgct::SGCTSettings::getCaptureFormat()
     return tmpI;
 }
 
+/*!
+    Get the target of Y4M capture streams, empty if derived from the capture path
+*/
+const std::string sgct::SGCTSettings::getCaptureStreamTarget()
+{
+    std::string tmpS;
+    mMutex.lock();
+    tmpS = mCaptureStreamTarget;
+    mMutex.unlock();
+    return tmpS;
+}
+
+/*!
+    Get the frame rate of Y4M capture streams
+*/
+const int sgct::SGCTSettings::getCaptureStreamFrameRate()
+{
+    int tmpI;
+    mMutex.lock();
+    tmpI = mCaptureStreamFrameRate;
+    mMutex.unlock();
+    return tmpI;
+}
+
 /*!
     Controls removal of sub-pixel aliasing.
     - 1/2 - low removal
@@ -605,6 +694,41 @@ void sgct::SGCTSettings::setExportWarpingMeshes(bool state)
     mExportWarpingMeshes = state;
 }
 
+/*!
+Set to true if parsed warping meshes should be compiled to binary cache files (*.sgctmesh) that are used instead of
+parsing the source on the next start. Enabled by default.
+*/
+void sgct::SGCTSettings::setUseWarpMeshCache(bool state)
+{
+    mUseWarpMeshCache = state;
+}
+
+/*!
+Set to true if warping meshes and masks should be watched and reloaded on all nodes when they change, see
+Engine::reloadCorrectionData. Must be set before the engine is initialized. Disabled by default.
+*/
+void sgct::SGCTSettings::setWatchCorrectionData(bool state)
+{
+    mWatchCorrectionData = state;
+}
+
+/*!
+Set the directory where compiled warping meshes are stored. If empty (default) they are stored next to the source meshes.
+*/
+void sgct::SGCTSettings::setWarpMeshCacheDirectory(std::string path)
+{
+    mWarpMeshCacheDirectory.assign(path);
+}
+
+/*!
+Set the maximum error in framebuffer pixels allowed when dense grid warping meshes are simplified. Regions that are close
+to linear are drawn with fewer triangles, the mesh borders and blend regions are kept. Zero (default) disables decimation.
+*/
+void sgct::SGCTSettings::setWarpMeshDecimationError(float pixels)
+{
+    mWarpMeshDecimationError = pixels;
+}
+
 /*!
 Get if run length encoding (RLE) is used in PNG and TGA export.
 */
@@ -633,6 +757,38 @@ const bool sgct::SGCTSettings::getExportWarpingMeshes() const
     return mExportWarpingMeshes;
 }
 
+/*!
+Get if compiled warping meshes are used.
+*/
+const bool sgct::SGCTSettings::getUseWarpMeshCache() const
+{
+    return mUseWarpMeshCache;
+}
+
+/*!
+Get if warping meshes and masks are watched for changes.
+*/
+const bool sgct::SGCTSettings::getWatchCorrectionData() const
+{
+    return mWatchCorrectionData;
+}
+
+/*!
+Get the directory for compiled warping meshes, empty if they are stored next to the source meshes.
+*/
+const std::string & sgct::SGCTSettings::getWarpMeshCacheDirectory() const
+{
+    return mWarpMeshCacheDirectory;
+}
+
+/*!
+Get the maximum warping mesh decimation error in pixels, zero if decimation is disabled.
+*/
+const float sgct::SGCTSettings::getWarpMeshDecimationError() const
+{
+    return mWarpMeshDecimationError;
+}
+
 /*!
 Get if screen warping is used
 */
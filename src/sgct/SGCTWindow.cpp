@@ -9,6 +9,7 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #include <sgct/Engine.h>
 #include <sgct/TextureManager.h>
 #include <sgct/MessageHandler.h>
+#include <sgct/Tracer.h>
 #include <sgct/ClusterManager.h>
 #include <sgct/SGCTSettings.h>
 #include <sgct/shaders/SGCTInternalShaders.h>
@@ -384,6 +385,22 @@ void sgct::SGCTWindow::initContextSpecificOGL()
         mHasAnyMasks = true;
 }
 
+/*!
+    Switch the viewports of this window to warping meshes and masks reloaded in the background, see
+    sgct_core::CorrectionDataReloader. Makes the context of the window current.
+*/
+void sgct::SGCTWindow::applyReloadedData()
+{
+    makeOpenGLContextCurrent(Window_Context);
+    TextureManager::CompressionMode cm = TextureManager::instance()->getCompression();
+    TextureManager::instance()->setCompression(TextureManager::No_Compression);
+
+    for (std::size_t j = 0; j < getNumberOfViewports(); j++)
+        getViewport(j)->applyReload();
+
+    TextureManager::instance()->setCompression(cm);
+}
+
 /*!
     Get a frame buffer texture. If the texture doesn't exists then it will be created.
 
@@ -539,6 +556,7 @@ void sgct::SGCTWindow::swap(bool takeScreenshot)
         
         if (takeScreenshot)
         {
+            sgct_core::TraceZone zone("Capture", static_cast<int>(mId));
             if (sgct::SGCTSettings::instance()->getCaptureFromBackBuffer() && mDoubleBuffered)
             {
                 if (mScreenCapture[0] != nullptr)
@@ -565,6 +583,7 @@ void sgct::SGCTWindow::swap(bool takeScreenshot)
         mWindowResOld[0] = mWindowRes[0];
         mWindowResOld[1] = mWindowRes[1];
 
+        sgct_core::TraceZone zone("Swap", static_cast<int>(mId));
         mDoubleBuffered ? glfwSwapBuffers(mWindowHandle): glFinish();
     }
 }
@@ -20,6 +20,9 @@ sgct_core::ScreenCaptureThreadInfo::ScreenCaptureThreadInfo()
     mframeBufferImagePtr = nullptr;
     mFrameCaptureThreadPtr = nullptr;
     mMutexPtr = nullptr;
+    mStreamPtr = nullptr;
+    mStreamSequence = 0;
+    mStreamBGR = true;
 }
 
 sgct_core::ScreenCapture::ScreenCapture()
@@ -42,6 +45,9 @@ sgct_core::ScreenCapture::ScreenCapture()
     mBytesPerColor = 1;
 
     mSCTIPtrs = nullptr;
+    mStreamPtr = nullptr;
+    mStreamSegment = 0;
+    mStreamFailed = false;
 }
 
 sgct_core::ScreenCapture::~ScreenCapture()
@@ -85,6 +91,8 @@ sgct_core::ScreenCapture::~ScreenCapture()
         mSCTIPtrs = nullptr;
     }
 
+    closeStream();
+
     if( mPBO ) //delete if buffer exitsts
     {
         glDeleteBuffers(1, &mPBO);
@@ -143,6 +151,13 @@ void sgct_core::ScreenCapture::initOrResize(int x, int y, int channels, int byte
         mSCTIPtrs[i].mRunning = false;
     }
 
+    //a y4m stream has a fixed size so continue in a new segment
+    if (mStreamPtr != nullptr && (mStreamPtr->getWidth() != mX || mStreamPtr->getHeight() != mY))
+    {
+        closeStream();
+        mStreamSegment++;
+    }
+
     if( mUsePBO )
     {
         glGenBuffers(1, &mPBO);
@@ -181,6 +196,7 @@ Set the image format to use
 void sgct_core::ScreenCapture::setCaptureFormat(CaptureFormat cf)
 {
     mFormat = cf;
+    mStreamFailed = false;
 }
 
 /*!
@@ -246,11 +262,7 @@ void sgct_core::ScreenCapture::saveScreenCapture(unsigned int textureId, CaputeS
                 if (mCaptureCallbackFn1 != SGCT_NULL_PTR)
                     mCaptureCallbackFn1(imPtr, mWindowIndex, mEyeIndex, mDownloadType);
                 else if (mBytesPerColor <= 2)
-                {
-                    //save the image
-                    mSCTIPtrs[threadIndex].mRunning = true;
-                    mSCTIPtrs[threadIndex].mFrameCaptureThreadPtr = new std::thread(screenCaptureHandler, &mSCTIPtrs[threadIndex]);
-                }
+                    startCaptureThread(threadIndex);
             }
             glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
         }
@@ -285,11 +297,7 @@ void sgct_core::ScreenCapture::saveScreenCapture(unsigned int textureId, CaputeS
         if (mCaptureCallbackFn1 != SGCT_NULL_PTR)
             mCaptureCallbackFn1(imPtr, mWindowIndex, mEyeIndex, mDownloadType);
         else if (mBytesPerColor <= 2)
-        {
-            //save the image
-            mSCTIPtrs[threadIndex].mRunning = true;
-            mSCTIPtrs[threadIndex].mFrameCaptureThreadPtr = new std::thread(screenCaptureHandler, &mSCTIPtrs[threadIndex]);
-        }
+            startCaptureThread(threadIndex);
     }
 }
 
@@ -306,6 +314,27 @@ void sgct_core::ScreenCapture::setUsePBO(bool state)
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO, "ScreenCapture: PBO rendering %s.\n", state ? "enabled" : "disabled");
 }
 
+/*!
+    \returns the number of captured frames that are still being saved or streamed by the capture threads
+*/
+unsigned int sgct_core::ScreenCapture::getNumberOfPendingFrames()
+{
+    unsigned int pending = 0;
+    std::unique_lock<std::mutex> lock(mMutex); //only held by the capture threads to clear their running flag
+    for (unsigned int i = 0; i < mNumberOfThreads; i++)
+        if (mSCTIPtrs != nullptr && mSCTIPtrs[i].mFrameCaptureThreadPtr != nullptr && mSCTIPtrs[i].mRunning)
+            pending++;
+    return pending;
+}
+
+/*!
+    \returns the number of frames the Y4M stream failed to write, 0 if not streaming
+*/
+unsigned long long sgct_core::ScreenCapture::getNumberOfDroppedStreamFrames()
+{
+    return mStreamPtr != nullptr ? mStreamPtr->getDroppedFrames() : 0;
+}
+
 /*!
     Init
 */
@@ -358,6 +387,8 @@ void sgct_core::ScreenCapture::addFrameNumberToFilename( unsigned int frameNumbe
         suffix.assign("png");
     else if(mFormat == TGA)
         suffix.assign("tga");
+    else if(mFormat == Y4M)
+        suffix.assign("y4m");
     else
         suffix.assign("jpg");
 
@@ -382,8 +413,13 @@ void sgct_core::ScreenCapture::addFrameNumberToFilename( unsigned int frameNumbe
 
     ss << eye;
 
-    //add frame numbers
-    if (frameNumber < 10)
+    //add frame numbers (a stream holds all frames)
+    if (mFormat == Y4M)
+    {
+        if (mStreamSegment > 0)
+            ss << "_" << mStreamSegment;
+    }
+    else if (frameNumber < 10)
         ss << "_00000" << frameNumber;
     else if( frameNumber < 100 )
         ss << "_0000" << frameNumber;
@@ -516,12 +552,105 @@ sgct_core::Image * sgct_core::ScreenCapture::prepareImage(int index)
     return (*imPtr);
 }
 
+/*
+    Starts a capture thread for the image prepared in the given slot.
+*/
+void sgct_core::ScreenCapture::startCaptureThread(int index)
+{
+    ScreenCaptureThreadInfo & info = mSCTIPtrs[index];
+    info.mStreamPtr = nullptr;
+
+    if (mFormat == Y4M)
+    {
+        if (!openStream())
+            return;
+
+        info.mStreamPtr = mStreamPtr;
+        info.mStreamSequence = mStreamPtr->reserveFrame(); //keeps the stream in frame order
+        info.mStreamBGR = (mDownloadFormat == GL_BGRA || mDownloadFormat == GL_BGR);
+    }
+
+    info.mRunning = true;
+    info.mFrameCaptureThreadPtr = new std::thread(screenCaptureHandler, &info);
+}
+
+/*
+    Opens the y4m stream on the first captured frame. Returns false if streaming isn't possible.
+*/
+bool sgct_core::ScreenCapture::openStream()
+{
+    if (mStreamPtr != nullptr)
+        return mStreamPtr->isOpen(); //false after a write error
+    if (mStreamFailed)
+        return false;
+
+    if (mBytesPerColor != 1 || mChannels < 3)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR,
+            "ScreenCapture: Y4M streaming requires an 8-bit RGB or RGBA framebuffer!\n");
+        mStreamFailed = true;
+        return false;
+    }
+
+    std::string target = sgct::SGCTSettings::instance()->getCaptureStreamTarget();
+    if (target.empty())
+        target = mFilename;
+    else if (CaptureStream::getTargetType(target) == CaptureStream::FILE_TARGET)
+    {
+        //give each window, eye and segment its own file
+        std::stringstream ss;
+        ss << target;
+        if (mWindowIndex > 0)
+            ss << "_win" << mWindowIndex;
+        if (mEyeIndex == STEREO_LEFT)
+            ss << "_L";
+        else if (mEyeIndex == STEREO_RIGHT)
+            ss << "_R";
+        if (mStreamSegment > 0)
+            ss << "_" << mStreamSegment;
+        target = ss.str();
+    }
+
+    //identifies the window and eye if several captures share a socket
+    std::stringstream comment;
+    comment << "SGCT_WINDOW=" << mWindowIndex << (mEyeIndex == STEREO_LEFT ? "_L" : (mEyeIndex == STEREO_RIGHT ? "_R" : ""));
+
+    mStreamPtr = new CaptureStream();
+    if (!mStreamPtr->open(target, mX, mY, sgct::SGCTSettings::instance()->getCaptureStreamFrameRate(), comment.str()))
+    {
+        delete mStreamPtr;
+        mStreamPtr = nullptr;
+        mStreamFailed = true;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+    Closes the y4m stream, all capture threads must have been joined.
+*/
+void sgct_core::ScreenCapture::closeStream()
+{
+    if (mStreamPtr != nullptr)
+    {
+        delete mStreamPtr;
+        mStreamPtr = nullptr;
+    }
+}
+
 //multi-threaded screenshot saver
 void screenCaptureHandler(void *arg)
 {
     auto * ptr = reinterpret_cast<sgct_core::ScreenCaptureThreadInfo *>(arg);
 
-    if( !ptr->mframeBufferImagePtr->save() )
+    if (ptr->mStreamPtr != nullptr)
+    {
+        sgct_core::Image * imPtr = ptr->mframeBufferImagePtr;
+        //frames read back from OpenGL are stored bottom-up
+        ptr->mStreamPtr->writeFrame(ptr->mStreamSequence, imPtr->getData(), imPtr->getChannels(), ptr->mStreamBGR, true, ptr->mStreamBuffer);
+    }
+    else if( !ptr->mframeBufferImagePtr->save() )
     {
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Error: Failed to save '%s'!\n", ptr->mframeBufferImagePtr->getFilename());
     }
@@ -28,6 +28,8 @@ SharedData::SharedData()
 {
     mEncodeFn = nullptr;
     mDecodeFn = nullptr;
+    mInternalEncodeFn = nullptr;
+    mInternalDecodeFn = nullptr;
 
     // use a compression buffer twice as large
     // to fit huffman tree + data which can be
@@ -165,6 +167,23 @@ void SharedData::setDecodeFunction(sgct_cppxeleven::function<void(void)> fn)
 }
 #endif
 
+/*!
+Set the encode callback of SGCT's own data in the sync frame, such as the synchronized timers. It is called before the
+application's encode callback and shouldn't be used by the user.
+*/
+void SharedData::setInternalEncodeFunction(sgct_cppxeleven::function<void(void)> fn)
+{
+    mInternalEncodeFn = fn;
+}
+
+/*!
+Set the decode callback of SGCT's own data in the sync frame, see setInternalEncodeFunction.
+*/
+void SharedData::setInternalDecodeFunction(sgct_cppxeleven::function<void(void)> fn)
+{
+    mInternalDecodeFn = fn;
+}
+
 /*!
 This fuction is called internally by SGCT and shouldn't be used by the user.
 */
@@ -185,6 +204,8 @@ void SharedData::decode(const char * receivedData, int receivedlength, int clien
 
     SGCTMutexManager::instance()->unlockMutex( sgct::SGCTMutexManager::DataSyncMutex );
 
+    if( mInternalDecodeFn != nullptr )
+        mInternalDecodeFn();
     if( mDecodeFn != nullptr )
         mDecodeFn();
 }
@@ -215,6 +236,8 @@ void SharedData::encode()
 
     SGCTMutexManager::instance()->unlockMutex( sgct::SGCTMutexManager::DataSyncMutex );
 
+    if( mInternalEncodeFn != nullptr )
+        mInternalEncodeFn();
     if( mEncodeFn != nullptr )
         mEncodeFn();
 
@@ -275,6 +298,24 @@ std::size_t SharedData::getUserDataSize()
     return dataBlock.size()-sgct_core::SGCTNetwork::mHeaderSize;
 }
 
+/*!
+Get the data of the latest encode as the slaves pass it to decode, without the header and uncompressed.
+
+\param size is set to the size of the data
+\returns the data, valid until the next encode or decode
+*/
+const unsigned char * SharedData::getEncodedData(std::size_t & size)
+{
+    if(mUseCompression)
+    {
+        size = dataBlockToCompress.size();
+        return dataBlockToCompress.data();
+    }
+
+    size = dataBlock.size() - sgct_core::SGCTNetwork::mHeaderSize;
+    return dataBlock.data() + sgct_core::SGCTNetwork::mHeaderSize;
+}
+
 void SharedData::writeFloat(SharedFloat * sf)
 {
 #ifdef __SGCT_NETWORK_DEBUG__    
@@ -9,6 +9,8 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #include <sgct/SGCTSettings.h>
 #include <sgct/Engine.h>
 #include <sgct/MessageHandler.h>
+#include <sgct/Tracer.h>
+#include <sgct/GPUTimer.h>
 #include <sgct/shaders/SGCTInternalFisheyeShaders.h>
 #include <sgct/shaders/SGCTInternalFisheyeShaders_modern.h>
 #include <sgct/helpers/SGCTStringFunctions.h>
@@ -277,6 +279,9 @@ void sgct_core::SpoutOutputProjection::initShaders()
 
 void sgct_core::SpoutOutputProjection::drawCubeFace(const std::size_t & face)
 {
+    TraceZone zone("Cubemap face", static_cast<int>(face));
+    GPUTraceZone gpuZone("Cubemap face", static_cast<int>(face));
+
     glLineWidth(1.0);
     sgct::Engine::instance()->getWireframe() ? glPolygonMode(GL_FRONT_AND_BACK, GL_LINE) : glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
@@ -0,0 +1,135 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/StartupLoader.h>
+#include <sgct/MessageHandler.h>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+
+    const char * getDataTypeName(sgct_core::Viewport::DataType type)
+    {
+        switch (type)
+        {
+        case sgct_core::Viewport::OVERLAY_DATA:
+            return "overlay";
+        case sgct_core::Viewport::BLEND_MASK_DATA:
+            return "blend mask";
+        case sgct_core::Viewport::BLACK_LEVEL_MASK_DATA:
+            return "black level mask";
+        case sgct_core::Viewport::CORRECTION_MESH_DATA:
+            return "warping mesh";
+        default:
+            return "unknown";
+        }
+    }
+}
+
+sgct_core::StartupLoader::StartupLoader()
+{
+    mNextTask = 0;
+    mNumberOfThreads = 0;
+    mLoadTime = 0.0;
+}
+
+/*!
+    Adds a task for every file that the viewport loads.
+*/
+void sgct_core::StartupLoader::addViewport(Viewport * vpPtr, std::size_t windowIndex, std::size_t viewportIndex, float windowAspectRatio, const glm::ivec2 & framebufferResolution)
+{
+    for (std::size_t i = 0; i < Viewport::NUMBER_OF_DATA_TYPES; i++)
+    {
+        Viewport::DataType type = static_cast<Viewport::DataType>(i);
+        if (!vpPtr->hasData(type))
+            continue;
+
+        Task task;
+        task.mViewportPtr = vpPtr;
+        task.mType = type;
+        task.mWindowIndex = windowIndex;
+        task.mViewportIndex = viewportIndex;
+        task.mWindowAspectRatio = windowAspectRatio;
+        task.mFramebufferResolution = framebufferResolution;
+        task.mPrepareTime = 0.0;
+        task.mStatus = false;
+        mTasks.push_back(task);
+    }
+}
+
+/*!
+    Prepares all files and returns when they are done.
+    \param numberOfThreads the number of worker threads, 0 uses one per hardware thread
+*/
+void sgct_core::StartupLoader::load(std::size_t numberOfThreads)
+{
+    if (numberOfThreads == 0)
+        numberOfThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    mNumberOfThreads = std::max<std::size_t>(std::min(numberOfThreads, mTasks.size()), 1);
+    mNextTask = 0;
+
+    Clock::time_point t0 = Clock::now();
+    if (mNumberOfThreads == 1)
+        work();
+    else
+    {
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < mNumberOfThreads; i++)
+            threads.push_back(std::thread(&StartupLoader::work, this));
+
+        for (std::size_t i = 0; i < threads.size(); i++)
+            threads[i].join();
+    }
+    mLoadTime = std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+void sgct_core::StartupLoader::work()
+{
+    for (std::size_t i = mNextTask++; i < mTasks.size(); i = mNextTask++)
+    {
+        Task & task = mTasks[i];
+        Clock::time_point t0 = Clock::now();
+        task.mStatus = task.mViewportPtr->prepareData(task.mType, task.mWindowAspectRatio, task.mFramebufferResolution);
+        task.mPrepareTime = std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+}
+
+/*!
+    Prints the prepare and upload time of every file. Call after the viewports have loaded their data.
+*/
+void sgct_core::StartupLoader::printReport()
+{
+    if (mTasks.empty())
+        return;
+
+    sgct::MessageHandler * mh = sgct::MessageHandler::instance();
+    mh->print(sgct::MessageHandler::NOTIFY_INFO, "StartupLoader: Loaded %u file(s) using %u thread(s):\n",
+        static_cast<unsigned int>(mTasks.size()), static_cast<unsigned int>(mNumberOfThreads));
+
+    double prepareSum = 0.0;
+    double uploadSum = 0.0;
+    for (std::size_t i = 0; i < mTasks.size(); i++)
+    {
+        const Task & task = mTasks[i];
+        double uploadTime = task.mViewportPtr->getDataUploadTime(task.mType);
+        std::string path = task.mViewportPtr->getDataPath(task.mType);
+
+        mh->print(sgct::MessageHandler::NOTIFY_INFO, "  window %u viewport %u %s '%s': prepare %.2f ms, upload %.2f ms%s\n",
+            static_cast<unsigned int>(task.mWindowIndex), static_cast<unsigned int>(task.mViewportIndex),
+            getDataTypeName(task.mType), path.empty() ? "default" : path.c_str(),
+            task.mPrepareTime * 1000.0, uploadTime * 1000.0, task.mStatus ? "" : " (failed)");
+
+        prepareSum += task.mPrepareTime;
+        uploadSum += uploadTime;
+    }
+
+    mh->print(sgct::MessageHandler::NOTIFY_INFO, "StartupLoader: Prepared in %.2f ms (%.2f ms serial), uploaded in %.2f ms.\n",
+        mLoadTime * 1000.0, prepareSum * 1000.0, uploadSum * 1000.0);
+}
@@ -24,6 +24,8 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #include <glm/gtc/matrix_transform.hpp>
 #include <string>
 #include <memory.h>
+#include <algorithm>
+#include <cmath>
 
 const static std::string Stats_Vert_Shader = "\
 **glsl_version**\n\
@@ -97,24 +99,38 @@ sgct_core::Statistics::Statistics()
     mStaticVBO        = GL_FALSE;
     mStaticVAO        = GL_FALSE;
 
-    for(unsigned int i=0; i<STATS_HISTORY_LENGTH; i++)
+    //the x of a vertex is its slot in the ring, the graph is moved to the head when drawn
+    for(unsigned int i=0; i<STATS_NUMBER_OF_DYNAMIC_OBJS; i++)
     {
-        mDynamicVertexList[i + FRAME_TIME * STATS_HISTORY_LENGTH].x = static_cast<float>(i);
-        mDynamicVertexList[i + DRAW_TIME * STATS_HISTORY_LENGTH].x = static_cast<float>(i);
-        mDynamicVertexList[i + SYNC_TIME * STATS_HISTORY_LENGTH].x = static_cast<float>(i);
-        mDynamicVertexList[i + LOOP_TIME_MAX * STATS_HISTORY_LENGTH].x = static_cast<float>(i);
-        mDynamicVertexList[i + LOOP_TIME_MIN * STATS_HISTORY_LENGTH].x = static_cast<float>(i);
-
-        mDynamicVertexList[i + FRAME_TIME * STATS_HISTORY_LENGTH].y = 0.0f;
-        mDynamicVertexList[i + DRAW_TIME * STATS_HISTORY_LENGTH].y = 0.0f;
-        mDynamicVertexList[i + SYNC_TIME * STATS_HISTORY_LENGTH].y = 0.0f;
-        mDynamicVertexList[i + LOOP_TIME_MAX * STATS_HISTORY_LENGTH].y = 0.0f;
-        mDynamicVertexList[i + LOOP_TIME_MIN * STATS_HISTORY_LENGTH].y = 0.0f;
+        for(unsigned int j=0; j<STATS_HISTORY_LENGTH * 2; j++)
+        {
+            mDynamicVertexList[i * STATS_HISTORY_LENGTH * 2 + j].x = static_cast<float>(j);
+            mDynamicVertexList[i * STATS_HISTORY_LENGTH * 2 + j].y = 0.0f;
+        }
+
+        mWrites[i] = 0;
+        mUploaded[0][i] = 0;
+        mUploaded[1][i] = 0;
     }
+    mLatestSyncDirty[0] = false;
+    mLatestSyncDirty[1] = false;
+
+    for(unsigned int i=0; i<STATS_NUMBER_OF_WINDOWED_OBJS; i++)
+        mAvgSums[i] = 0.0;
+
+    mDroppedFrames = 0;
+    setRefreshRate(0.0);
+    setPercentileWindow(STATS_HISTORY_LENGTH);
+
+    mReportInterval = 1.0;
+    mLastReportTime = -1.0;
+    mReportFile = nullptr;
+    mReportFn = SGCT_NULL_PTR;
 }
 
 sgct_core::Statistics::~Statistics()
 {
+    closeReportFile();
     mShader.deleteProgram();
     
     if(mDynamicVBO[0])
@@ -214,7 +230,10 @@ void sgct_core::Statistics::initVBO(bool fixedPipeline)
                 glEnableVertexAttribArray(0);
             }
             glBindBuffer(GL_ARRAY_BUFFER, mDynamicVBO[i]);
-            glBufferData(GL_ARRAY_BUFFER, STATS_HISTORY_LENGTH * sizeof(StatsVertex) * STATS_NUMBER_OF_DYNAMIC_OBJS, &mDynamicVertexList[0], GL_STREAM_DRAW);
+            glBufferData(GL_ARRAY_BUFFER, STATS_HISTORY_LENGTH * 2 * sizeof(StatsVertex) * STATS_NUMBER_OF_DYNAMIC_OBJS, &mDynamicVertexList[0], GL_STREAM_DRAW);
+            for(unsigned int j=0; j<STATS_NUMBER_OF_DYNAMIC_OBJS; j++)
+                mUploaded[i][j] = mWrites[j];
+            mLatestSyncDirty[i] = false;
     
             if(!mFixedPipeline)
                 glVertexAttribPointer( 0, 2, GL_FLOAT, GL_FALSE, 0, nullptr );
@@ -299,53 +318,22 @@ void sgct_core::Statistics::setAvgFPS(float afps)
 
 void sgct_core::Statistics::setFrameTime(float t)
 {
-    mAvgFrameTime = 0.0;
-    int start = FRAME_TIME * STATS_HISTORY_LENGTH;
-
-    for (int i = start + STATS_HISTORY_LENGTH - 2; i >= start; i--)
-    {
-        mDynamicVertexList[i + 1].y = mDynamicVertexList[i].y;
-        if (i < (STATS_AVERAGE_LENGTH + start - 1))
-            mAvgFrameTime += mDynamicVertexList[i].y;
-    }
-    mDynamicVertexList[start].y = t;
-    
-    mAvgFrameTime += mDynamicVertexList[start].y;
-    mAvgFrameTime /= static_cast<float>(STATS_AVERAGE_LENGTH);
+    if( t > mDroppedFrameTime )
+        mDroppedFrames++;
+    mAvgFrameTime = addToAverage(FRAME_TIME, t);
+    addSample(FRAME_TIME, t);
 }
 
 void sgct_core::Statistics::setDrawTime(float t)
 {
-    mAvgDrawTime = 0.0;
-    int start = DRAW_TIME * STATS_HISTORY_LENGTH;
-
-    for (int i = start + STATS_HISTORY_LENGTH - 2; i >= start; i--)
-    {
-        mDynamicVertexList[i + 1].y = mDynamicVertexList[i].y;
-        if (i < (STATS_AVERAGE_LENGTH + start - 1))
-            mAvgDrawTime += mDynamicVertexList[i].y;
-    }
-    mDynamicVertexList[start].y = t;
-    
-    mAvgDrawTime += mDynamicVertexList[start].y;
-    mAvgDrawTime /= static_cast<float>(STATS_AVERAGE_LENGTH);
+    mAvgDrawTime = addToAverage(DRAW_TIME, t);
+    addSample(DRAW_TIME, t);
 }
 
 void sgct_core::Statistics::setSyncTime(float t)
 {
-    mAvgSyncTime = 0.0;
-    int start = SYNC_TIME * STATS_HISTORY_LENGTH;
-    
-    for (int i = start + STATS_HISTORY_LENGTH - 2; i >= start; i--)
-    {
-        mDynamicVertexList[i + 1].y = mDynamicVertexList[i].y;
-        if (i < (STATS_AVERAGE_LENGTH + start - 1))
-            mAvgSyncTime += mDynamicVertexList[i].y;
-    }
-    mDynamicVertexList[start].y = t;
-    
-    mAvgSyncTime += mDynamicVertexList[start].y;
-    mAvgSyncTime /= static_cast<float>(STATS_AVERAGE_LENGTH);
+    mAvgSyncTime = addToAverage(SYNC_TIME, t);
+    addSample(SYNC_TIME, t);
 }
 
 /*!
@@ -353,48 +341,312 @@ void sgct_core::Statistics::setSyncTime(float t)
 */
 void sgct_core::Statistics::setLoopTime(float min, float max)
 {
-    int start = LOOP_TIME_MAX * STATS_HISTORY_LENGTH;
-    for (int i = start + STATS_HISTORY_LENGTH - 2; i >= start; i--)
-        mDynamicVertexList[i + 1].y = mDynamicVertexList[i].y;
-    mDynamicVertexList[start].y = max;
-    
-    start = LOOP_TIME_MIN * STATS_HISTORY_LENGTH;
-    for (int i = start + STATS_HISTORY_LENGTH - 2; i >= start; i--)
-        mDynamicVertexList[i + 1].y = mDynamicVertexList[i].y;
-    mDynamicVertexList[start].y = min;
+    addSample(LOOP_TIME_MAX, max);
+    addSample(LOOP_TIME_MIN, min);
 }
 
 
 void sgct_core::Statistics::addSyncTime(float t)
 {
-    mDynamicVertexList[SYNC_TIME * STATS_HISTORY_LENGTH].y += t;
-    mAvgSyncTime += (t/static_cast<float>(STATS_AVERAGE_LENGTH));
+    unsigned int slot = SYNC_TIME * STATS_HISTORY_LENGTH * 2 + getHead(SYNC_TIME);
+    mDynamicVertexList[slot].y += t;
+    mDynamicVertexList[slot + STATS_HISTORY_LENGTH].y += t;
+
+    if( mWrites[SYNC_TIME] > mWindowStart[SYNC_TIME] )
+    {
+        std::vector<float> & window = mWindowSamples[SYNC_TIME];
+        window[(mWrites[SYNC_TIME] - 1 - mWindowStart[SYNC_TIME]) % window.size()] += t;
+    }
+
+    mAvgSums[SYNC_TIME] += t;
+    mAvgSyncTime = static_cast<float>(mAvgSums[SYNC_TIME] / static_cast<double>(STATS_AVERAGE_LENGTH));
+
+    //the latest sample may already be in the VBOs
+    mLatestSyncDirty[0] = true;
+    mLatestSyncDirty[1] = true;
+}
+
+/*!
+    Writes a sample to its slot in the ring and to the mirrored slot, keeping the latest STATS_HISTORY_LENGTH samples contiguous.
+*/
+void sgct_core::Statistics::addSample(int type, float t)
+{
+    unsigned int slot = type * STATS_HISTORY_LENGTH * 2 + static_cast<unsigned int>(mWrites[type] % STATS_HISTORY_LENGTH);
+    mDynamicVertexList[slot].y = t;
+    mDynamicVertexList[slot + STATS_HISTORY_LENGTH].y = t;
+
+    if( type < STATS_NUMBER_OF_WINDOWED_OBJS )
+    {
+        std::vector<float> & window = mWindowSamples[type];
+        window[(mWrites[type] - mWindowStart[type]) % window.size()] = t;
+    }
+
+    mWrites[type]++;
 }
 
+/*!
+    Updates the running sum of the latest STATS_AVERAGE_LENGTH samples with a sample that is about to be added.
+
+    \returns the new average
+*/
+float sgct_core::Statistics::addToAverage(int type, float t)
+{
+    mAvgSums[type] += t;
+    if( mWrites[type] >= STATS_AVERAGE_LENGTH )
+    {
+        unsigned int oldest = static_cast<unsigned int>((mWrites[type] - STATS_AVERAGE_LENGTH) % STATS_HISTORY_LENGTH);
+        mAvgSums[type] -= mDynamicVertexList[type * STATS_HISTORY_LENGTH * 2 + oldest].y;
+    }
+
+    //restart the sum every lap to keep rounding errors from adding up
+    if( mWrites[type] % STATS_HISTORY_LENGTH == 0 )
+    {
+        mAvgSums[type] = t;
+        for(unsigned long long i = 1; i < STATS_AVERAGE_LENGTH && i <= mWrites[type]; i++)
+            mAvgSums[type] += mDynamicVertexList[type * STATS_HISTORY_LENGTH * 2 + static_cast<unsigned int>((mWrites[type] - i) % STATS_HISTORY_LENGTH)].y;
+    }
+
+    return static_cast<float>(mAvgSums[type] / static_cast<double>(STATS_AVERAGE_LENGTH));
+}
+
+/*!
+    Uploads the samples added since the VBO was last updated, not the whole history.
+*/
 void sgct_core::Statistics::update()
 {
     if(ClusterManager::instance()->getMeshImplementation() == ClusterManager::BUFFER_OBJECTS)
     {
-        GLvoid* PositionBuffer;
-
         mVBOIndex = 1 - mVBOIndex; //ping-pong
         glBindBuffer(GL_ARRAY_BUFFER, mDynamicVBO[mVBOIndex]);
-        size_t size = STATS_HISTORY_LENGTH * sizeof(StatsVertex) * STATS_NUMBER_OF_DYNAMIC_OBJS;
 
-        //glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
-    
-        PositionBuffer = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-    
-        if (PositionBuffer)
+        for(int i=0; i<STATS_NUMBER_OF_DYNAMIC_OBJS; i++)
         {
-            memcpy(PositionBuffer, &mDynamicVertexList[0], size);
-            glUnmapBuffer(GL_ARRAY_BUFFER);
+            unsigned long long pending = mWrites[i] - mUploaded[mVBOIndex][i];
+            if( pending >= STATS_HISTORY_LENGTH )
+                glBufferSubData(GL_ARRAY_BUFFER,
+                    i * STATS_HISTORY_LENGTH * 2 * sizeof(StatsVertex),
+                    STATS_HISTORY_LENGTH * 2 * sizeof(StatsVertex),
+                    &mDynamicVertexList[i * STATS_HISTORY_LENGTH * 2]);
+            else if( pending > 0 )
+                uploadSlots(i, mUploaded[mVBOIndex][i], pending);
+            else if( i == SYNC_TIME && mLatestSyncDirty[mVBOIndex] && mWrites[i] > 0 )
+                uploadSlots(i, mWrites[i] - 1, 1);
+
+            mUploaded[mVBOIndex][i] = mWrites[i];
         }
+        mLatestSyncDirty[mVBOIndex] = false;
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 }
 
+/*!
+    Uploads count samples starting with sample number first, and their mirrors, to the bound VBO. Count must be less than STATS_HISTORY_LENGTH.
+*/
+void sgct_core::Statistics::uploadSlots(int type, unsigned long long first, unsigned long long count)
+{
+    unsigned int slot = static_cast<unsigned int>(first % STATS_HISTORY_LENGTH);
+    unsigned int n = static_cast<unsigned int>(count);
+
+    //the slots are contiguous in the 2N ring, their copies are N away and may wrap around
+    unsigned int copy = slot + STATS_HISTORY_LENGTH;
+    unsigned int wrapped = copy + n > STATS_HISTORY_LENGTH * 2 ? copy + n - STATS_HISTORY_LENGTH * 2 : 0;
+    unsigned int offsets[3] = { slot, copy, 0 };
+    unsigned int counts[3] = { n, n - wrapped, wrapped };
+    
+    for(unsigned int i=0; i<3; i++)
+        if( counts[i] > 0 )
+        {
+            unsigned int index = type * STATS_HISTORY_LENGTH * 2 + offsets[i];
+            glBufferSubData(GL_ARRAY_BUFFER, index * sizeof(StatsVertex), counts[i] * sizeof(StatsVertex), &mDynamicVertexList[index]);
+        }
+}
+
+/*!
+    Set the refresh rate of the display in Hz, frames that take more than STATS_DROPPED_FRAME_FACTOR refresh intervals are counted as dropped. A rate of zero or less means 60 Hz.
+*/
+void sgct_core::Statistics::setRefreshRate(double rate)
+{
+    if( rate <= 0.0 )
+        rate = 60.0;
+    mDroppedFrameTime = static_cast<float>(STATS_DROPPED_FRAME_FACTOR / rate);
+}
+
+/*!
+    Set the number of latest frames that the percentiles of the reports are calculated from. The kept samples are cleared.
+*/
+void sgct_core::Statistics::setPercentileWindow(std::size_t numberOfFrames)
+{
+    if( numberOfFrames == 0 )
+        numberOfFrames = 1;
+
+    for(unsigned int i=0; i<STATS_NUMBER_OF_WINDOWED_OBJS; i++)
+    {
+        mWindowSamples[i].assign(numberOfFrames, 0.0f);
+        mWindowStart[i] = mWrites[i];
+    }
+    mSortBuffer.reserve(numberOfFrames);
+}
+
+/*!
+    Set how often, in seconds, reports are written to the report file and passed to the report callback. Default is once per second.
+*/
+void sgct_core::Statistics::setReportInterval(double interval)
+{
+    mReportInterval = interval;
+}
+
+/*!
+    Write a report as a line in a CSV file at every report interval. Times are written in milliseconds. An empty filename stops writing.
+
+    \returns false if the file could not be created
+*/
+bool sgct_core::Statistics::setReportFile(const std::string & filename)
+{
+    closeReportFile();
+    if( filename.empty() )
+        return true;
+
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    if (fopen_s(&mReportFile, filename.c_str(), "w") != 0)
+        mReportFile = nullptr;
+#else
+    mReportFile = fopen(filename.c_str(), "w");
+#endif
+    if( mReportFile == nullptr )
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Statistics: Failed to open '%s' for writing!\n", filename.c_str());
+        return false;
+    }
+
+    fprintf(mReportFile, "time,frames,window_frames,avg_fps");
+    const char * names[] = { "frame", "draw", "sync" };
+    for(unsigned int i=0; i<STATS_NUMBER_OF_WINDOWED_OBJS; i++)
+        fprintf(mReportFile, ",%s_avg_ms,%s_p50_ms,%s_p95_ms,%s_p99_ms,%s_max_ms", names[i], names[i], names[i], names[i], names[i]);
+    fprintf(mReportFile, ",dropped_frames,window_dropped_frames\n");
+    fflush(mReportFile);
+    return true;
+}
+
+/*!
+    Set a callback that gets a report at every report interval, for example to raise an alarm when the frame times regress.
+*/
+void sgct_core::Statistics::setReportFunction(sgct_cppxeleven::function<void(const Report &)> fn)
+{
+    mReportFn = fn;
+}
+
+/*!
+    Called once per frame, writes and passes on a report if the report interval has passed.
+
+    \param time the current time in seconds
+*/
+void sgct_core::Statistics::updateReport(double time)
+{
+    if( mReportFile == nullptr && mReportFn == SGCT_NULL_PTR )
+        return;
+
+    if( mLastReportTime < 0.0 )
+    {
+        mLastReportTime = time;
+        return;
+    }
+    if( time - mLastReportTime < mReportInterval )
+        return;
+    mLastReportTime = time;
+
+    Report report = getReport(time);
+
+    if( mReportFile != nullptr )
+    {
+        fprintf(mReportFile, "%.3f,%llu,%u,%.2f", report.mTime, report.mNumberOfFrames, static_cast<unsigned int>(report.mWindowFrames), report.mAvgFPS);
+        const Percentiles * percentiles[] = { &report.mFrameTime, &report.mDrawTime, &report.mSyncTime };
+        for(unsigned int i=0; i<STATS_NUMBER_OF_WINDOWED_OBJS; i++)
+            fprintf(mReportFile, ",%.3f,%.3f,%.3f,%.3f,%.3f",
+                percentiles[i]->mAvg * 1000.0f,
+                percentiles[i]->mP50 * 1000.0f,
+                percentiles[i]->mP95 * 1000.0f,
+                percentiles[i]->mP99 * 1000.0f,
+                percentiles[i]->mMax * 1000.0f);
+        fprintf(mReportFile, ",%llu,%u\n", report.mDroppedFrames, static_cast<unsigned int>(report.mWindowDroppedFrames));
+        fflush(mReportFile);
+    }
+
+    if( mReportFn != SGCT_NULL_PTR )
+        mReportFn(report);
+}
+
+/*!
+    \returns the percentiles of the frames in the percentile window
+*/
+sgct_core::Statistics::Report sgct_core::Statistics::getReport(double time)
+{
+    Report report;
+    report.mTime = time;
+    report.mNumberOfFrames = mWrites[FRAME_TIME];
+    report.mAvgFPS = mAvgFPS;
+    report.mDroppedFrames = mDroppedFrames;
+
+    unsigned long long frames = mWrites[FRAME_TIME] - mWindowStart[FRAME_TIME];
+    report.mWindowFrames = static_cast<std::size_t>(std::min<unsigned long long>(frames, mWindowSamples[FRAME_TIME].size()));
+    report.mWindowDroppedFrames = 0;
+    for(std::size_t i=0; i<report.mWindowFrames; i++)
+        if( mWindowSamples[FRAME_TIME][i] > mDroppedFrameTime )
+            report.mWindowDroppedFrames++;
+
+    calculatePercentiles(FRAME_TIME, report.mFrameTime);
+    calculatePercentiles(DRAW_TIME, report.mDrawTime);
+    calculatePercentiles(SYNC_TIME, report.mSyncTime);
+    return report;
+}
+
+/*!
+    Nearest rank percentiles of the samples in the window of a metric, O(n) using partial sorting.
+*/
+void sgct_core::Statistics::calculatePercentiles(int type, Percentiles & p)
+{
+    const std::vector<float> & window = mWindowSamples[type];
+    std::size_t count = static_cast<std::size_t>(std::min<unsigned long long>(mWrites[type] - mWindowStart[type], window.size()));
+    if( count == 0 )
+    {
+        p.mAvg = p.mP50 = p.mP95 = p.mP99 = p.mMax = 0.0f;
+        return;
+    }
+
+    //the kept samples are the first count ones until the window has been filled
+    mSortBuffer.assign(window.begin(), window.begin() + count);
+
+    double sum = 0.0;
+    for(float t : mSortBuffer)
+        sum += t;
+    p.mAvg = static_cast<float>(sum / static_cast<double>(count));
+
+    //each partition leaves larger samples after the nth, so the next search can start there
+    const float ranks[] = { 0.50f, 0.95f, 0.99f };
+    float * results[] = { &p.mP50, &p.mP95, &p.mP99 };
+    std::vector<float>::iterator begin = mSortBuffer.begin();
+    for(unsigned int i=0; i<3; i++)
+    {
+        std::size_t n = static_cast<std::size_t>(ceil(ranks[i] * static_cast<float>(count)));
+        std::vector<float>::iterator nth = mSortBuffer.begin() + (n > 0 ? n - 1 : 0);
+        if( nth < begin )
+            nth = begin;
+        std::nth_element(begin, nth, mSortBuffer.end());
+        *results[i] = *nth;
+        begin = nth;
+    }
+    p.mMax = *std::max_element(begin, mSortBuffer.end());
+}
+
+void sgct_core::Statistics::closeReportFile()
+{
+    if( mReportFile != nullptr )
+    {
+        fclose(mReportFile);
+        mReportFile = nullptr;
+    }
+}
+
 void sgct_core::Statistics::draw(float lineWidth)
 {
     mShader.bind();
@@ -446,8 +698,14 @@ void sgct_core::Statistics::draw(float lineWidth)
             glVertexPointer(2, GL_FLOAT, 0, reinterpret_cast<void*>(0));
             for(unsigned int i=0; i<STATS_NUMBER_OF_DYNAMIC_OBJS; i++)
             {
+                //the VBO may not contain the samples added since it was updated
+                unsigned int head = static_cast<unsigned int>((mUploaded[mVBOIndex][i] + STATS_HISTORY_LENGTH - 1) % STATS_HISTORY_LENGTH);
+                glPushMatrix();
+                glTranslatef(static_cast<float>(head + STATS_HISTORY_LENGTH), 0.0f, 0.0f);
+                glScalef(-1.0f, 1.0f, 1.0f);
                 glUniform4fv( mColLoc, 1, glm::value_ptr(mDynamicColors[ i ]) );
-                glDrawArrays(GL_LINE_STRIP, i * STATS_HISTORY_LENGTH, STATS_HISTORY_LENGTH);
+                glDrawArrays(GL_LINE_STRIP, i * STATS_HISTORY_LENGTH * 2 + head + 1, STATS_HISTORY_LENGTH);
+                glPopMatrix();
             }
 
             //unbind
@@ -491,11 +749,17 @@ void sgct_core::Statistics::draw(float lineWidth)
 
             for(unsigned int i=0; i<STATS_NUMBER_OF_DYNAMIC_OBJS; i++)
             {
+                unsigned int head = getHead(i);
+                unsigned int start = i * STATS_HISTORY_LENGTH * 2 + head + 1;
+                glPushMatrix();
+                glTranslatef(static_cast<float>(head + STATS_HISTORY_LENGTH), 0.0f, 0.0f);
+                glScalef(-1.0f, 1.0f, 1.0f);
                 glUniform4fv( mColLoc, 1, glm::value_ptr(mDynamicColors[ i ]) );
                 glBegin(GL_LINE_STRIP);
-                for( unsigned int j=0; j<STATS_HISTORY_LENGTH; j++ )
-                    glVertex2f( mDynamicVertexList[i*STATS_HISTORY_LENGTH + j].x, mDynamicVertexList[i*STATS_HISTORY_LENGTH + j].y );
+                for( unsigned int j=start; j<start + STATS_HISTORY_LENGTH; j++ )
+                    glVertex2f( mDynamicVertexList[j].x, mDynamicVertexList[j].y );
                 glEnd();
+                glPopMatrix();
             }
         }
 
@@ -535,8 +799,14 @@ void sgct_core::Statistics::draw(float lineWidth)
         glBindVertexArray(mDynamicVAO[mVBOIndex]);
         for (unsigned int i = 0; i<STATS_NUMBER_OF_DYNAMIC_OBJS; i++)
         {
+            //draw the latest samples of the ring with the newest at x = 0
+            unsigned int head = static_cast<unsigned int>((mUploaded[mVBOIndex][i] + STATS_HISTORY_LENGTH - 1) % STATS_HISTORY_LENGTH);
+            glm::mat4 ringMat = glm::translate( orthoMat, glm::vec3(static_cast<float>(head + STATS_HISTORY_LENGTH), 0.0f, 0.0f) );
+            ringMat = glm::scale( ringMat, glm::vec3(-1.0f, 1.0f, 1.0f) );
+            glUniformMatrix4fv( mMVPLoc, 1, GL_FALSE, &ringMat[0][0]);
+
             glUniform4fv( mColLoc, 1, glm::value_ptr(mDynamicColors[i]) );
-            glDrawArrays(GL_LINE_STRIP, i * STATS_HISTORY_LENGTH, STATS_HISTORY_LENGTH);
+            glDrawArrays(GL_LINE_STRIP, i * STATS_HISTORY_LENGTH * 2 + head + 1, STATS_HISTORY_LENGTH);
         }
         
         //unbind
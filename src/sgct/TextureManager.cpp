@@ -6,14 +6,34 @@ For conditions of distribution and use, see copyright notice in sgct.h
 *************************************************************************/
 
 #include <stdio.h>
+#include <algorithm>
 #include <GL/glew.h>
 
 #include <sgct/TextureManager.h>
+#include <sgct/CompressedTextureCache.h>
 #include <sgct/MessageHandler.h>
 #include <sgct/Engine.h>
 
 sgct::TextureManager * sgct::TextureManager::mInstance = nullptr;
 
+namespace
+{
+    GLenum getCompressedFormat(sgct_core::BCEncoder::Format format)
+    {
+        switch (format)
+        {
+        case sgct_core::BCEncoder::BC1:
+            return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case sgct_core::BCEncoder::BC3:
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case sgct_core::BCEncoder::BC4:
+            return GL_COMPRESSED_RED_RGTC1;
+        default:
+            return GL_COMPRESSED_RG_RGTC2;
+        }
+    }
+}
+
 sgct_core::TextureData::TextureData()
 {
     reset();
@@ -31,6 +51,14 @@ void sgct_core::TextureData::reset()
     mWidth = -1;
     mHeight = -1;
     mChannels = -1;
+
+    mBytes = 0;
+    mLastUsedFrame = 0;
+    mMipmapLevels = 1;
+    mInterpolate = true;
+    mEvictable = false;
+    mEvicted = false;
+    mReloading = false;
 }
 
 sgct::TextureManager::TextureManager()
@@ -44,6 +72,14 @@ sgct::TextureManager::TextureManager()
     mOverWriteMode = true;
     mInterpolate = true;
     mMipmapLevels = 8;
+    mStreamingUploadLimit = 4;
+
+    mLoaderPtr = nullptr;
+    mActiveUploadPtr = nullptr;
+    mResidencyBudget = 0;
+    mUploadBudget = 8 * 1024 * 1024;
+    mFrame = 0;
+    mPlaceholderId = GL_FALSE;
 
     //add empty texture
     sgct_core::TextureData tmpTexture;
@@ -56,14 +92,29 @@ sgct::TextureManager::~TextureManager()
 }
 
 /*!
-    This function gets a texture id by it's name.
+    This function gets a texture id by it's name. If the texture has been evicted (see setResidencyBudget) a reload is
+    started and a placeholder texture id is returned until the texture is resident again.
 
     \param name of texture
     \returns openGL texture id if texture is found otherwise GL_FALSE/0.
 */
 const unsigned int sgct::TextureManager::getTextureId(const std::string name)
 {
-    return mTextures.count(name) > 0 ? mTextures[name].mId : 0;
+    auto textureItem = mTextures.find(name);
+    if (textureItem == mTextures.end())
+        return 0;
+
+    sgct_core::TextureData & texData = textureItem->second;
+    texData.mLastUsedFrame = mFrame;
+
+    if (texData.mEvicted)
+    {
+        if (texData.mEvictable && !texData.mReloading)
+            requestReload(name, texData);
+        return getPlaceholderId();
+    }
+
+    return texData.mId;
 }
 
 /*!
@@ -164,49 +215,28 @@ bool sgct::TextureManager::loadTexture(const std::string name, const std::string
     GLuint texID = 0;
     bool reload = false;
     sgct_core::TextureData tmpTexture;
-    sgct_core::Image img;
 
     mInterpolate = interpolate;
     mMipmapLevels = mipmapLevels;
 
     if (!updateTexture(name, &texID, &reload))
         return true;
-    
-    auto textureItem = mTextures.end();
 
-    //load image
-    if ( !img.load(filename) )
+    if (!loadImageFile(filename, &texID, tmpTexture))
     {
         if (reload)
-        {
-            textureItem->second.reset();
-        }
+            mTextures[name].reset();
 
         return false;
     }
-    
-    if (img.getData() != nullptr)
-    {
-        if (!uploadImage(&img, &texID))
-            return false;
 
-        tmpTexture.mId = texID;
-        tmpTexture.mPath.assign(filename);
-        tmpTexture.mWidth = static_cast<int>(img.getWidth());
-        tmpTexture.mHeight = static_cast<int>(img.getHeight());
-        tmpTexture.mChannels = static_cast<int>(img.getChannels());
+    tmpTexture.mLastUsedFrame = mFrame;
+    tmpTexture.mMipmapLevels = mMipmapLevels;
+    tmpTexture.mInterpolate = mInterpolate;
+    tmpTexture.mEvictable = true;
+    mTextures[name] = tmpTexture;
 
-        if(!reload)
-        {
-            mTextures[name] = tmpTexture;
-        }
-
-        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Texture created from '%s' [id=%d]\n", filename.c_str(), texID );
-    }
-    else //image data not valid
-    {
-        return false;
-    }
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Texture created from '%s' [id=%d]\n", filename.c_str(), texID );
 
     return true;
 }
@@ -249,11 +279,10 @@ bool sgct::TextureManager::loadTexture(const std::string name, sgct_core::Image
         tmpTexture.mWidth = static_cast<int>(imgPtr->getWidth());
         tmpTexture.mHeight = static_cast<int>(imgPtr->getHeight());
         tmpTexture.mChannels = static_cast<int>(imgPtr->getChannels());
+        tmpTexture.mBytes = imgPtr->getDataSize() + (mMipmapLevels > 1 ? imgPtr->getDataSize() / 3 : 0);
+        tmpTexture.mLastUsedFrame = mFrame;
 
-        if (!reload)
-        {
-            mTextures[name] = tmpTexture;
-        }
+        mTextures[name] = tmpTexture;
 
         sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Texture created from image [id=%d]\n", texID);
     }
@@ -285,34 +314,663 @@ bool sgct::TextureManager::loadUnManagedTexture(unsigned int & texID, const std:
         texID = GL_FALSE;
     }
     
-    //load image
-    sgct_core::Image img;
-    if (!img.load(filename))
+    sgct_core::TextureData tmpTexture;
+    if (!loadImageFile(filename, &tmpTexID, tmpTexture))
+        return false;
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Unmanaged texture created from '%s' [id=%d]\n", filename.c_str(), tmpTexID);
+
+    texID = tmpTexID;
+    return true;
+}
+
+/*!
+Load a unmanged texture from a decoded image. Note that this type of textures doesn't auto destruct.
+\param texID the openGL texture id
+\param imgPtr pointer to image object
+\param interpolate set to true for using interpolation (bi-linear filtering)
+\param mipmapLevels is the number of mipmap levels that will be generated, setting this value to 1 or less disables mipmaps
+\return true if texture loaded successfully
+*/
+bool sgct::TextureManager::loadUnManagedTexture(unsigned int & texID, sgct_core::Image * imgPtr, bool interpolate, int mipmapLevels)
+{
+    if (!imgPtr || imgPtr->getData() == nullptr)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Cannot create unmanaged texture from invalid image!\n");
+        return false;
+    }
+
+    unsigned int tmpTexID = GL_FALSE;
+    mInterpolate = interpolate;
+    mMipmapLevels = mipmapLevels;
+
+    if (texID != GL_FALSE)
     {
+        glDeleteTextures(1, &texID);
+        texID = GL_FALSE;
+    }
+
+    if (!uploadImage(imgPtr, &tmpTexID))
+        return false;
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Unmanaged texture created from image [id=%d]\n", tmpTexID);
+
+    texID = tmpTexID;
+    return true;
+}
+
+/*!
+Load a tiled image (see sgct_core::TiledImage) as a streamed texture. Storage for all mip levels is allocated
+and the coarse levels that fit in a single tile are uploaded directly, so a low resolution preview is available
+immediately through getTextureId. The remaining tiles are read coarse to fine on a background thread and
+uploaded by update(), which the Engine calls once per frame. The base mip level is lowered each time
+a finer level is complete. Streamed textures are never compressed.
+\param name the name of the texture
+\param filename the filename or path to the tiled image
+\param interpolate set to true for using interpolation (tri-linear filtering)
+\param tileBudget the maximum number of decoded tiles waiting for upload
+\return true if the texture was created and streaming started
+*/
+bool sgct::TextureManager::loadTiledTexture(const std::string name, const std::string filename, bool interpolate, std::size_t tileBudget)
+{
+    GLuint texID = 0;
+    bool reload = false;
+
+    if (!updateTexture(name, &texID, &reload))
+        return true;
+
+    sgct_core::TiledTextureStream * stream = new sgct_core::TiledTextureStream(name, 0, tileBudget);
+    sgct_core::TiledImage & tiledImage = stream->getImage();
+
+    GLint textureType;
+    GLint internalFormat;
+    if (!tiledImage.open(filename) ||
+        !getFormats(tiledImage.getChannels(), tiledImage.getBytesPerChannel(), tiledImage.getPreferBGR(), No_Compression, textureType, internalFormat))
+    {
+        delete stream;
+        if (reload)
+            mTextures[name].reset();
         return false;
     }
 
-    if (img.getData() != nullptr)
+    std::size_t levels = tiledImage.getNumberOfLevels();
+    GLenum format = (tiledImage.getBytesPerChannel() == 1 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT);
+
+    glGenTextures(1, &texID);
+    glBindTexture(GL_TEXTURE_2D, texID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    //allocate all levels
+    for (std::size_t l = 0; l < levels; l++)
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(l), internalFormat,
+            static_cast<GLsizei>(tiledImage.getWidth(l)), static_cast<GLsizei>(tiledImage.getHeight(l)), 0, textureType, format, nullptr);
+
+    //upload the preview levels, i.e. all levels that consist of a single tile
+    std::size_t baseLevel = levels;
+    std::vector<unsigned char> tile;
+    while (baseLevel > 0 && tiledImage.getTilesX(baseLevel - 1) == 1 && tiledImage.getTilesY(baseLevel - 1) == 1)
     {
-        if (!uploadImage(&img, &tmpTexID))
+        baseLevel--;
+        if (!tiledImage.readTile(baseLevel, 0, 0, tile))
+        {
+            glDeleteTextures(1, &texID);
+            delete stream;
+            if (reload)
+                mTextures[name].reset();
             return false;
+        }
 
-        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Unmanaged texture created from '%s' [id=%d]\n", filename.c_str(), tmpTexID);
+        glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(baseLevel), 0, 0,
+            static_cast<GLsizei>(tiledImage.getWidth(baseLevel)), static_cast<GLsizei>(tiledImage.getHeight(baseLevel)), textureType, format, tile.data());
     }
-    else //image data not valid
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(baseLevel));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels - 1));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, interpolate ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, interpolate ? GL_LINEAR : GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, mWarpMode[0]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, mWarpMode[1]);
+
+    GLfloat maxAni;
+    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAni);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, mAnisotropicFilterSize > maxAni ? maxAni : mAnisotropicFilterSize);
+
+    sgct_core::TextureData & texData = mTextures[name];
+    texData.mId = texID;
+    texData.mPath.assign(filename);
+    texData.mWidth = static_cast<int>(tiledImage.getWidth());
+    texData.mHeight = static_cast<int>(tiledImage.getHeight());
+    texData.mChannels = static_cast<int>(tiledImage.getChannels());
+    texData.mBytes = tiledImage.getWidth() * tiledImage.getHeight() * tiledImage.getChannels() * tiledImage.getBytesPerChannel() * 4 / 3;
+    texData.mLastUsedFrame = mFrame;
+
+    if (baseLevel == 0) //small image, everything is uploaded already
     {
-        return false;
+        delete stream;
+    }
+    else
+    {
+        stream->setTextureId(texID);
+        stream->start(baseLevel - 1);
+        mStreams.push_back(stream);
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Streaming texture created from '%s' [id=%d], preview level %d\n", filename.c_str(), texID, baseLevel);
+
+    return true;
+}
+
+/*!
+\returns true if tiles are still being streamed for the named texture
+*/
+bool sgct::TextureManager::isStreaming(const std::string name)
+{
+    for (std::size_t i = 0; i < mStreams.size(); i++)
+        if (mStreams[i]->getName() == name)
+            return true;
+    return false;
+}
+
+/*!
+Upload tiles that the streaming threads have read, at most the streaming upload limit per call. Called from update().
+*/
+void sgct::TextureManager::uploadStreamedTiles()
+{
+    if (mStreams.empty())
+        return;
+
+    std::size_t uploaded = 0;
+    sgct_core::TiledTextureStream::Tile tile;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (std::size_t i = 0; i < mStreams.size();)
+    {
+        sgct_core::TiledTextureStream * stream = mStreams[i];
+        sgct_core::TiledImage & tiledImage = stream->getImage();
+        GLint textureType;
+        GLint internalFormat;
+        getFormats(tiledImage.getChannels(), tiledImage.getBytesPerChannel(), tiledImage.getPreferBGR(), No_Compression, textureType, internalFormat);
+        GLenum format = (tiledImage.getBytesPerChannel() == 1 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT);
+
+        bool bound = false;
+        while (uploaded < mStreamingUploadLimit && stream->popTile(tile))
+        {
+            if (!bound)
+            {
+                glBindTexture(GL_TEXTURE_2D, stream->getTextureId());
+                bound = true;
+            }
+
+            glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(tile.mLevel),
+                static_cast<GLint>(tile.mX * tiledImage.getTileSize()), static_cast<GLint>(tile.mY * tiledImage.getTileSize()),
+                static_cast<GLsizei>(tile.mWidth), static_cast<GLsizei>(tile.mHeight), textureType, format, tile.mData.data());
+            uploaded++;
+
+            //sample the finer level as soon as it is complete
+            if (stream->tileUploaded(tile.mLevel))
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(tile.mLevel));
+        }
+
+        if (stream->isDone())
+        {
+            sgct::MessageHandler::instance()->print(stream->hasFailed() ? sgct::MessageHandler::NOTIFY_ERROR : sgct::MessageHandler::NOTIFY_DEBUG,
+                "TextureManager: Streaming of '%s' %s.\n", stream->getName().c_str(), stream->hasFailed() ? "failed" : "done");
+            delete stream;
+            mStreams.erase(mStreams.begin() + i);
+        }
+        else
+            i++;
+    }
+
+    if (uploaded > 0)
+        glBindTexture(GL_TEXTURE_2D, GL_FALSE);
+}
+
+void sgct::TextureManager::stopStreaming(const std::string & name)
+{
+    for (std::size_t i = 0; i < mStreams.size(); i++)
+        if (mStreams[i]->getName() == name)
+        {
+            delete mStreams[i];
+            mStreams.erase(mStreams.begin() + i);
+            return;
+        }
+}
+
+/*!
+Load an image file and upload it. If S3TC/DXT compression and a compression cache directory are set (and the OpenGL 3+ pipeline is used)
+the precompressed blocks are read from the cache, the image is only decoded and compressed on a cache miss.
+*/
+bool sgct::TextureManager::loadImageFile(const std::string & filename, unsigned int * texPtr, sgct_core::TextureData & texData)
+{
+    bool useCache = useCompressionCache();
+    sgct_core::CompressedTexture compressed;
+    std::size_t bpc = 1;
+
+    if (useCache && sgct_core::CompressedTextureCache::load(mCompressionCacheDirectory, filename, mMipmapLevels, compressed))
+    {
+        if (!uploadCompressedTexture(compressed, texPtr))
+            return false;
+    }
+    else
+    {
+        sgct_core::Image img;
+        if (!img.load(filename) || img.getData() == nullptr)
+            return false;
+
+        if (useCache && img.getBytesPerChannel() == 1 && sgct_core::CompressedTextureCache::compress(img, mMipmapLevels, compressed))
+        {
+            sgct_core::CompressedTextureCache::store(mCompressionCacheDirectory, filename, mMipmapLevels, compressed);
+            if (!uploadCompressedTexture(compressed, texPtr))
+                return false;
+        }
+        else
+        {
+            if (!uploadImage(&img, texPtr))
+                return false;
+
+            compressed.mWidth = img.getWidth();
+            compressed.mHeight = img.getHeight();
+            compressed.mChannels = img.getChannels();
+            bpc = img.getBytesPerChannel();
+        }
+    }
+
+    texData.mId = *texPtr;
+    texData.mPath.assign(filename);
+    texData.mWidth = static_cast<int>(compressed.mWidth);
+    texData.mHeight = static_cast<int>(compressed.mHeight);
+    texData.mChannels = static_cast<int>(compressed.mChannels);
+    texData.mBytes = 0;
+
+    if (compressed.mLevels.empty())
+    {
+        //estimate, the driver decides the actual layout
+        texData.mBytes = compressed.mWidth * compressed.mHeight * compressed.mChannels * bpc;
+        if (mCompression != No_Compression)
+            texData.mBytes /= 4;
+        if (mMipmapLevels > 1)
+            texData.mBytes += texData.mBytes / 3;
+    }
+    else
+    {
+        for (std::size_t l = 0; l < compressed.mLevels.size(); l++)
+            texData.mBytes += compressed.mLevels[l].size();
     }
 
-    texID = tmpTexID;
     return true;
 }
 
+bool sgct::TextureManager::uploadCompressedTexture(const sgct_core::CompressedTexture & texture, unsigned int * texPtr)
+{
+    GLenum internalFormat = getCompressedFormat(texture.mFormat);
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Creating precompressed texture... size: %dx%d, %d-channels, %d levels, Format: %#04x\n",
+        texture.mWidth, texture.mHeight, texture.mChannels, texture.mLevels.size(), internalFormat);
+
+    glGenTextures(1, texPtr);
+    glBindTexture(GL_TEXTURE_2D, *texPtr);
+
+    for (std::size_t l = 0; l < texture.mLevels.size(); l++)
+    {
+        GLsizei width = static_cast<GLsizei>(std::max<std::size_t>(texture.mWidth >> l, 1));
+        GLsizei height = static_cast<GLsizei>(std::max<std::size_t>(texture.mHeight >> l, 1));
+        glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(l), internalFormat, width, height, 0,
+            static_cast<GLsizei>(texture.mLevels[l].size()), texture.mLevels[l].data());
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(texture.mLevels.size()) - 1);
+
+    if (texture.mLevels.size() > 1)
+    {
+        GLfloat maxAni;
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAni);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mInterpolate ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mInterpolate ? GL_LINEAR : GL_NEAREST);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, mAnisotropicFilterSize > maxAni ? maxAni : mAnisotropicFilterSize);
+    }
+    else
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mInterpolate ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mInterpolate ? GL_LINEAR : GL_NEAREST);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, mWarpMode[0]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, mWarpMode[1]);
+
+    return true;
+}
+
+/*!
+Set a directory for precompressed textures. When set and the compression mode is S3TC_DXT, textures loaded from file are
+compressed on the CPU (BC1 for RGB, BC3 for RGBA, BC4/BC5 for one/two channels) and stored in this directory. Later loads,
+on any node sharing the directory, upload the stored blocks directly. An empty string (default) disables the cache.
+The sgct_texturecachebuilder tool can fill the cache offline.
+*/
+void sgct::TextureManager::setCompressionCacheDirectory(const std::string & directory)
+{
+    mCompressionCacheDirectory.assign(directory);
+}
+
+/*!
+Set a GPU memory budget in bytes for textures loaded from file. When the estimated size of all resident textures exceeds the budget,
+the least recently used textures that were not used in the previous frame are deleted. They are reloaded in the background the next
+time getTextureId is called for them, and a placeholder texture is returned meanwhile. Texture ids must therefore be fetched through
+getTextureId every frame when a budget is set. Textures created from images in memory or streamed from tiled images are counted but
+never evicted. A budget of 0 (default) disables eviction.
+*/
+void sgct::TextureManager::setResidencyBudget(std::size_t bytes)
+{
+    mResidencyBudget = bytes;
+}
+
+/*!
+\returns the estimated GPU memory in bytes used by resident textures
+*/
+std::size_t sgct::TextureManager::getResidentBytes()
+{
+    std::size_t bytes = 0;
+    for (std::pair<const std::string, sgct_core::TextureData> & texture : mTextures)
+        if (texture.second.mId && !texture.second.mEvicted)
+            bytes += texture.second.mBytes;
+    return bytes;
+}
+
+/*!
+Per frame texture work: uploads streamed tiles and reloaded textures within their budgets and evicts textures above the
+residency budget. Called by the Engine once per frame with the shared context current.
+*/
+void sgct::TextureManager::update()
+{
+    mFrame++;
+
+    uploadStreamedTiles();
+
+    if (mLoaderPtr || mActiveUploadPtr)
+        uploadReloadedTextures();
+
+    if (mResidencyBudget > 0)
+        evictTextures();
+}
+
+bool sgct::TextureManager::useCompressionCache()
+{
+    return !mCompressionCacheDirectory.empty() && mCompression == S3TC_DXT && !Engine::instance()->isOGLPipelineFixed();
+}
+
+void sgct::TextureManager::requestReload(const std::string & name, sgct_core::TextureData & texData)
+{
+    if (mLoaderPtr == nullptr)
+        mLoaderPtr = new sgct_core::AsyncTextureLoader();
+
+    sgct_core::AsyncTextureLoader::Request req;
+    req.mName = name;
+    req.mPath = texData.mPath;
+    req.mMipmapLevels = texData.mMipmapLevels;
+    if (useCompressionCache())
+        req.mCacheDirectory = mCompressionCacheDirectory;
+
+    texData.mReloading = true;
+    mLoaderPtr->request(req);
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Reloading evicted texture '%s'.\n", name.c_str());
+}
+
+void sgct::TextureManager::cancelReload(const std::string & name)
+{
+    if (mLoaderPtr)
+        mLoaderPtr->cancel(name);
+
+    if (mActiveUploadPtr && mActiveUploadPtr->mResultPtr->mRequest.mName == name)
+    {
+        glDeleteTextures(1, &(mActiveUploadPtr->mTexId));
+        delete mActiveUploadPtr->mResultPtr;
+        delete mActiveUploadPtr;
+        mActiveUploadPtr = nullptr;
+    }
+
+    auto textureItem = mTextures.find(name);
+    if (textureItem != mTextures.end())
+        textureItem->second.mReloading = false;
+}
+
+void sgct::TextureManager::uploadReloadedTextures()
+{
+    std::size_t budget = mUploadBudget;
+
+    while (budget > 0)
+    {
+        if (mActiveUploadPtr == nullptr)
+        {
+            sgct_core::AsyncTextureLoader::Result * result = mLoaderPtr ? mLoaderPtr->popResult() : nullptr;
+            if (result == nullptr)
+                break;
+
+            auto textureItem = mTextures.find(result->mRequest.mName);
+            if (textureItem == mTextures.end() || !textureItem->second.mReloading)
+            {
+                delete result;
+                continue;
+            }
+
+            if (!result->mSuccess)
+            {
+                //keep the placeholder and don't retry every frame
+                textureItem->second.mReloading = false;
+                textureItem->second.mEvictable = false;
+                delete result;
+                continue;
+            }
+
+            mActiveUploadPtr = new ReloadUpload();
+            mActiveUploadPtr->mResultPtr = result;
+            mActiveUploadPtr->mTexId = GL_FALSE;
+            mActiveUploadPtr->mLevel = 0;
+            mActiveUploadPtr->mRow = 0;
+        }
+
+        if (uploadReloadChunk(budget))
+        {
+            sgct_core::AsyncTextureLoader::Result * result = mActiveUploadPtr->mResultPtr;
+            sgct_core::TextureData & texData = mTextures[result->mRequest.mName];
+            texData.mId = mActiveUploadPtr->mTexId;
+            texData.mEvicted = false;
+            texData.mReloading = false;
+
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Texture '%s' resident again [id=%d]\n",
+                result->mRequest.mName.c_str(), texData.mId);
+
+            delete result;
+            delete mActiveUploadPtr;
+            mActiveUploadPtr = nullptr;
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, GL_FALSE);
+}
+
+/*!
+Upload the next rows of the active reload within the byte budget. Rows are uploaded in bands of whole 4x4 blocks
+with glTexSubImage2D or glCompressedTexSubImage2D, so a large texture is spread over several frames.
+\returns true when the texture is complete
+*/
+bool sgct::TextureManager::uploadReloadChunk(std::size_t & budget)
+{
+    ReloadUpload & upload = *mActiveUploadPtr;
+    sgct_core::AsyncTextureLoader::Result & result = *(upload.mResultPtr);
+    sgct_core::TextureData & texData = mTextures[result.mRequest.mName];
+    bool mipmaps = texData.mMipmapLevels > 1;
+
+    //driver side compression can't be done in parts, upload at once
+    if (!result.mCompressed && mCompression != No_Compression)
+    {
+        mInterpolate = texData.mInterpolate;
+        mMipmapLevels = texData.mMipmapLevels;
+        uploadImage(result.mImagePtr, &upload.mTexId);
+        budget -= std::min(budget, result.mImagePtr->getDataSize());
+        return true;
+    }
+
+    std::size_t width = result.mCompressed ? result.mCompressedTexture.mWidth : result.mImagePtr->getWidth();
+    std::size_t height = result.mCompressed ? result.mCompressedTexture.mHeight : result.mImagePtr->getHeight();
+    std::size_t levels = result.mCompressed ? result.mCompressedTexture.mLevels.size() : 1;
+    GLint textureType = GL_RGBA;
+    GLint internalFormat = GL_RGBA8;
+    GLenum format = GL_UNSIGNED_BYTE;
+
+    if (result.mCompressed)
+        internalFormat = static_cast<GLint>(getCompressedFormat(result.mCompressedTexture.mFormat));
+    else
+    {
+        getFormats(result.mImagePtr->getChannels(), result.mImagePtr->getBytesPerChannel(), result.mImagePtr->getPreferBGRImport(),
+            No_Compression, textureType, internalFormat);
+        format = (result.mImagePtr->getBytesPerChannel() == 1 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT);
+    }
+
+    if (upload.mTexId == GL_FALSE)
+    {
+        glGenTextures(1, &upload.mTexId);
+        glBindTexture(GL_TEXTURE_2D, upload.mTexId);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        //allocate storage, the data is uploaded in bands
+        for (std::size_t l = 0; l < levels; l++)
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(l), internalFormat,
+                static_cast<GLsizei>(std::max<std::size_t>(width >> l, 1)), static_cast<GLsizei>(std::max<std::size_t>(height >> l, 1)),
+                0, textureType, format, nullptr);
+
+        GLint maxLevel = result.mCompressed ? static_cast<GLint>(levels) - 1 : (mipmaps ? texData.mMipmapLevels - 1 : 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
+
+        if (maxLevel > 0)
+        {
+            GLfloat maxAni;
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAni);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texData.mInterpolate ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, mAnisotropicFilterSize > maxAni ? maxAni : mAnisotropicFilterSize);
+        }
+        else
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texData.mInterpolate ? GL_LINEAR : GL_NEAREST);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texData.mInterpolate ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, mWarpMode[0]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, mWarpMode[1]);
+    }
+    else
+    {
+        glBindTexture(GL_TEXTURE_2D, upload.mTexId);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    }
+
+    while (budget > 0 && upload.mLevel < levels)
+    {
+        std::size_t levelWidth = std::max<std::size_t>(width >> upload.mLevel, 1);
+        std::size_t levelHeight = std::max<std::size_t>(height >> upload.mLevel, 1);
+
+        //bytes per band of four rows
+        std::size_t bandSize = result.mCompressed ?
+            sgct_core::BCEncoder::getCompressedSize(result.mCompressedTexture.mFormat, levelWidth, 4) :
+            levelWidth * result.mImagePtr->getChannels() * result.mImagePtr->getBytesPerChannel() * 4;
+        std::size_t rows = std::max<std::size_t>(budget / bandSize, 1) * 4;
+        rows = std::min(rows, levelHeight - upload.mRow);
+
+        if (result.mCompressed)
+        {
+            std::size_t offset = (upload.mRow / 4) * bandSize;
+            std::size_t size = ((rows + 3) / 4) * bandSize;
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(upload.mLevel), 0, static_cast<GLint>(upload.mRow),
+                static_cast<GLsizei>(levelWidth), static_cast<GLsizei>(rows), static_cast<GLenum>(internalFormat),
+                static_cast<GLsizei>(size), result.mCompressedTexture.mLevels[upload.mLevel].data() + offset);
+            budget -= std::min(budget, size);
+        }
+        else
+        {
+            std::size_t rowSize = levelWidth * result.mImagePtr->getChannels() * result.mImagePtr->getBytesPerChannel();
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, static_cast<GLint>(upload.mRow), static_cast<GLsizei>(levelWidth), static_cast<GLsizei>(rows),
+                textureType, format, result.mImagePtr->getData() + upload.mRow * rowSize);
+            budget -= std::min(budget, rows * rowSize);
+        }
+
+        upload.mRow += rows;
+        if (upload.mRow >= levelHeight)
+        {
+            upload.mRow = 0;
+            upload.mLevel++;
+        }
+    }
+
+    if (upload.mLevel < levels)
+        return false;
+
+    if (!result.mCompressed && mipmaps)
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+    return true;
+}
+
+void sgct::TextureManager::evictTextures()
+{
+    std::size_t resident = getResidentBytes();
+    if (resident <= mResidencyBudget)
+        return;
+
+    //candidates not used in this or the previous frame, least recently used first
+    std::vector< std::pair<unsigned long long, std::string> > candidates;
+    for (std::pair<const std::string, sgct_core::TextureData> & texture : mTextures)
+    {
+        sgct_core::TextureData & texData = texture.second;
+        if (texData.mEvictable && !texData.mEvicted && texData.mId && texData.mLastUsedFrame + 1 < mFrame)
+            candidates.push_back(std::make_pair(texData.mLastUsedFrame, texture.first));
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    for (std::size_t i = 0; i < candidates.size() && resident > mResidencyBudget; i++)
+    {
+        sgct_core::TextureData & texData = mTextures[candidates[i].second];
+        glDeleteTextures(1, &(texData.mId));
+        texData.mId = GL_FALSE;
+        texData.mEvicted = true;
+        resident -= texData.mBytes;
+
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Evicted texture '%s' (%.1f MB).\n",
+            candidates[i].second.c_str(), static_cast<double>(texData.mBytes) / (1024.0 * 1024.0));
+    }
+}
+
+/*!
+\returns a 1x1 mid grey texture shown while evicted textures are reloaded
+*/
+unsigned int sgct::TextureManager::getPlaceholderId()
+{
+    if (mPlaceholderId == GL_FALSE)
+    {
+        const unsigned char grey[4] = { 128, 128, 128, 255 };
+        glGenTextures(1, &mPlaceholderId);
+        glBindTexture(GL_TEXTURE_2D, mPlaceholderId);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, GL_FALSE);
+    }
+
+    return mPlaceholderId;
+}
+
 /*!
 returns true if texture will be uploaded
 */
 bool sgct::TextureManager::updateTexture(const std::string & name, unsigned int * texPtr, bool * reload)
 {
+    //a texture being streamed or reloaded is replaced
+    stopStreaming(name);
+    cancelReload(name);
+
     //check if texture exits in manager
     bool exist = mTextures.count(name) > 0;
     auto textureItem = mTextures.end();
@@ -347,25 +1005,7 @@ bool sgct::TextureManager::uploadImage(sgct_core::Image * imgPtr, unsigned int *
     glGenTextures(1, texPtr);
     glBindTexture(GL_TEXTURE_2D, *texPtr);
 
-    bool isBGR = imgPtr->getPreferBGRImport();
-
-    //if three channels
-    int textureType = isBGR ? GL_BGR : GL_RGB;
-
-    //if OpenGL 1-2
-    if (Engine::instance()->isOGLPipelineFixed())
-    {
-        if (imgPtr->getChannels() == 4)    textureType = isBGR ? GL_BGRA : GL_RGBA;
-        else if (imgPtr->getChannels() == 1)    textureType = (mAlphaMode ? GL_ALPHA : GL_LUMINANCE);
-        else if (imgPtr->getChannels() == 2)    textureType = GL_LUMINANCE_ALPHA;
-    }
-    else //OpenGL 3+
-    {
-        if (imgPtr->getChannels() == 4)    textureType = isBGR ? GL_BGRA : GL_RGBA;
-        else if (imgPtr->getChannels() == 1)    textureType = GL_RED;
-        else if (imgPtr->getChannels() == 2)    textureType = GL_RG;
-    }
-
+    GLint textureType;
     GLint internalFormat;
     auto bpc = static_cast<unsigned int>(imgPtr->getBytesPerChannel());
 
@@ -380,13 +1020,87 @@ bool sgct::TextureManager::uploadImage(sgct_core::Image * imgPtr, unsigned int *
         mCompression = No_Compression;
     }
 
-    switch (imgPtr->getChannels())
+    if (!getFormats(imgPtr->getChannels(), bpc, imgPtr->getPreferBGRImport(), mCompression, textureType, internalFormat))
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TextureManager: %d-channel images are not supported!\n", imgPtr->getChannels());
+        glDeleteTextures(1, texPtr);
+        (*texPtr) = 0;
+        return false;
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Creating texture... size: %dx%d, %d-channels, compression: %s, Type: %#04x, Format: %#04x\n",
+        imgPtr->getWidth(),
+        imgPtr->getHeight(),
+        imgPtr->getChannels(),
+        (mCompression == No_Compression) ? "none" : ((mCompression == Generic) ? "generic" : "S3TC/DXT"),
+        textureType,
+        internalFormat);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (mMipmapLevels <= 1)
+        mMipmapLevels = 1;
+
+    GLenum format = (bpc == 1 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, static_cast<GLsizei>(imgPtr->getWidth()), static_cast<GLsizei>(imgPtr->getHeight()), 0, textureType, format, imgPtr->getData());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mMipmapLevels - 1);
+
+    if (mMipmapLevels > 1)
+    {
+        glGenerateMipmap(GL_TEXTURE_2D); //allocate the mipmaps
+
+        GLfloat maxAni;
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAni);
+        //sgct::MessageHandler::instance()->print("Max anisotropy: %f\n", maxAni);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mInterpolate ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mInterpolate ? GL_LINEAR : GL_NEAREST);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, mAnisotropicFilterSize > maxAni ? maxAni : mAnisotropicFilterSize);
+    }
+    else
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mInterpolate ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mInterpolate ? GL_LINEAR : GL_NEAREST);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, mWarpMode[0]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, mWarpMode[1]);
+
+    return true;
+}
+
+/*!
+Get the OpenGL pixel transfer format and internal format for an image layout.
+\returns false if the number of channels is not supported
+*/
+bool sgct::TextureManager::getFormats(std::size_t channels, std::size_t bpc, bool isBGR, CompressionMode cm, int & textureType, int & internalFormat)
+{
+    //if three channels
+    textureType = isBGR ? GL_BGR : GL_RGB;
+
+    //if OpenGL 1-2
+    if (Engine::instance()->isOGLPipelineFixed())
+    {
+        if (channels == 4)    textureType = isBGR ? GL_BGRA : GL_RGBA;
+        else if (channels == 1)    textureType = (mAlphaMode ? GL_ALPHA : GL_LUMINANCE);
+        else if (channels == 2)    textureType = GL_LUMINANCE_ALPHA;
+    }
+    else //OpenGL 3+
+    {
+        if (channels == 4)    textureType = isBGR ? GL_BGRA : GL_RGBA;
+        else if (channels == 1)    textureType = GL_RED;
+        else if (channels == 2)    textureType = GL_RG;
+    }
+
+    switch (channels)
     {
     case 4:
     {
-        if (mCompression == No_Compression)
+        if (cm == No_Compression)
             internalFormat = (bpc == 1 ? GL_RGBA8 : GL_RGBA16);
-        else if (mCompression == Generic)
+        else if (cm == Generic)
             internalFormat = GL_COMPRESSED_RGBA;
         else
             internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
@@ -394,9 +1108,9 @@ bool sgct::TextureManager::uploadImage(sgct_core::Image * imgPtr, unsigned int *
     break;
     case 3:
     {
-        if (mCompression == No_Compression)
+        if (cm == No_Compression)
             internalFormat = (bpc == 1 ? GL_RGB8 : GL_RGB16);
-        else if (mCompression == Generic)
+        else if (cm == Generic)
             internalFormat = GL_COMPRESSED_RGB;
         else
             internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
@@ -405,16 +1119,16 @@ bool sgct::TextureManager::uploadImage(sgct_core::Image * imgPtr, unsigned int *
     case 2:
         if (Engine::instance()->isOGLPipelineFixed())
         {
-            if (mCompression == No_Compression)
+            if (cm == No_Compression)
                 internalFormat = (bpc == 1 ? GL_LUMINANCE8_ALPHA8 : GL_LUMINANCE16_ALPHA16);
             else
                 internalFormat = GL_COMPRESSED_LUMINANCE_ALPHA;
         }
         else
         {
-            if (mCompression == No_Compression)
+            if (cm == No_Compression)
                 internalFormat = (bpc == 1 ? GL_RG8 : GL_RG16);
-            else if (mCompression == Generic)
+            else if (cm == Generic)
                 internalFormat = GL_COMPRESSED_RG;
             else
                 internalFormat = GL_COMPRESSED_RG_RGTC2;
@@ -424,67 +1138,53 @@ bool sgct::TextureManager::uploadImage(sgct_core::Image * imgPtr, unsigned int *
         if (Engine::instance()->isOGLPipelineFixed())
         {
             if (bpc == 1)
-                internalFormat = (mCompression == No_Compression) ? (mAlphaMode ? GL_ALPHA8 : GL_LUMINANCE8) : (mAlphaMode ? GL_COMPRESSED_ALPHA : GL_COMPRESSED_LUMINANCE);
+                internalFormat = (cm == No_Compression) ? (mAlphaMode ? GL_ALPHA8 : GL_LUMINANCE8) : (mAlphaMode ? GL_COMPRESSED_ALPHA : GL_COMPRESSED_LUMINANCE);
             else
                 internalFormat = (mAlphaMode ? GL_ALPHA16 : GL_LUMINANCE16);
         }
         else
         {
-            if (mCompression == No_Compression)
+            if (cm == No_Compression)
                 internalFormat = (bpc == 1 ? GL_R8 : GL_R16);
-            else if (mCompression == Generic)
+            else if (cm == Generic)
                 internalFormat = GL_COMPRESSED_RED;
             else
                 internalFormat = GL_COMPRESSED_RED_RGTC1;
         }
         break;
+    default:
+        return false;
     }
 
-    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TextureManager: Creating texture... size: %dx%d, %d-channels, compression: %s, Type: %#04x, Format: %#04x\n",
-        imgPtr->getWidth(),
-        imgPtr->getHeight(),
-        imgPtr->getChannels(),
-        (mCompression == No_Compression) ? "none" : ((mCompression == Generic) ? "generic" : "S3TC/DXT"),
-        textureType,
-        internalFormat);
-
-    glPixelStorei(GL_PACK_ALIGNMENT, 1);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-    if (mMipmapLevels <= 1)
-        mMipmapLevels = 1;
+    return true;
+}
 
-    GLenum format = (bpc == 1 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT);
-    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, static_cast<GLsizei>(imgPtr->getWidth()), static_cast<GLsizei>(imgPtr->getHeight()), 0, textureType, format, imgPtr->getData());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mMipmapLevels - 1);
+void sgct::TextureManager::freeTextureData()
+{
+    for (std::size_t i = 0; i < mStreams.size(); i++)
+        delete mStreams[i];
+    mStreams.clear();
 
-    if (mMipmapLevels > 1)
+    if (mLoaderPtr)
     {
-        glGenerateMipmap(GL_TEXTURE_2D); //allocate the mipmaps
-
-        GLfloat maxAni;
-        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAni);
-        //sgct::MessageHandler::instance()->print("Max anisotropy: %f\n", maxAni);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mInterpolate ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mInterpolate ? GL_LINEAR : GL_NEAREST);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, mAnisotropicFilterSize > maxAni ? maxAni : mAnisotropicFilterSize);
+        delete mLoaderPtr;
+        mLoaderPtr = nullptr;
     }
-    else
+
+    if (mActiveUploadPtr)
     {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mInterpolate ? GL_LINEAR : GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mInterpolate ? GL_LINEAR : GL_NEAREST);
+        glDeleteTextures(1, &(mActiveUploadPtr->mTexId));
+        delete mActiveUploadPtr->mResultPtr;
+        delete mActiveUploadPtr;
+        mActiveUploadPtr = nullptr;
     }
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, mWarpMode[0]);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, mWarpMode[1]);
-
-    return true;
-}
+    if (mPlaceholderId)
+    {
+        glDeleteTextures(1, &mPlaceholderId);
+        mPlaceholderId = GL_FALSE;
+    }
 
-void sgct::TextureManager::freeTextureData()
-{
     //the textures might not be stored in a sequence so
     //let's erase them one by one
     for (std::pair<const std::string, sgct_core::TextureData> & texture : mTextures)
@@ -0,0 +1,523 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/TiledImage.h>
+#include <sgct/Image.h>
+#include <sgct/MessageHandler.h>
+#include <sgct/Engine.h>
+#ifndef SGCT_DONT_USE_EXTERNAL
+#include "../include/external/zlib.h"
+#else
+#include <zlib.h>
+#endif
+#include <string.h>
+#include <algorithm>
+
+#define TILED_IMAGE_MAGIC "SGCTTILE"
+#define TILED_IMAGE_MAGIC_LENGTH 8
+#define TILED_IMAGE_VERSION 1
+#define TILED_IMAGE_HEADER_FIELDS 8
+#define TILED_IMAGE_FLAG_BGR 1
+#define TILED_IMAGE_MIN_TILE_SIZE 16
+
+static_assert(sizeof(sgct_core::TiledImage::TileInfo) == 16, "TileInfo must be tightly packed");
+
+namespace
+{
+    bool seekFile(FILE * fp, unsigned long long offset)
+    {
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+        return _fseeki64(fp, static_cast<__int64>(offset), SEEK_SET) == 0;
+#elif defined(_WIN32)
+        return fseeko64(fp, static_cast<off64_t>(offset), SEEK_SET) == 0;
+#else
+        return fseeko(fp, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+
+    unsigned long long getFileSize(FILE * fp)
+    {
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+        if (_fseeki64(fp, 0, SEEK_END) != 0)
+            return 0;
+        return static_cast<unsigned long long>(_ftelli64(fp));
+#elif defined(_WIN32)
+        if (fseeko64(fp, 0, SEEK_END) != 0)
+            return 0;
+        return static_cast<unsigned long long>(ftello64(fp));
+#else
+        if (fseeko(fp, 0, SEEK_END) != 0)
+            return 0;
+        return static_cast<unsigned long long>(ftello(fp));
+#endif
+    }
+
+    template <class T>
+    void downsampleBox(const T * src, std::size_t srcWidth, std::size_t srcHeight, T * dst, std::size_t channels)
+    {
+        std::size_t dstWidth = std::max<std::size_t>(srcWidth >> 1, 1);
+        std::size_t dstHeight = std::max<std::size_t>(srcHeight >> 1, 1);
+
+        for (std::size_t y = 0; y < dstHeight; y++)
+        {
+            const T * row0 = src + std::min(2 * y, srcHeight - 1) * srcWidth * channels;
+            const T * row1 = src + std::min(2 * y + 1, srcHeight - 1) * srcWidth * channels;
+
+            for (std::size_t x = 0; x < dstWidth; x++)
+            {
+                std::size_t x0 = std::min(2 * x, srcWidth - 1) * channels;
+                std::size_t x1 = std::min(2 * x + 1, srcWidth - 1) * channels;
+
+                for (std::size_t c = 0; c < channels; c++)
+                {
+                    unsigned int sum = static_cast<unsigned int>(row0[x0 + c]) + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                    *dst++ = static_cast<T>((sum + 2) >> 2);
+                }
+            }
+        }
+    }
+}
+
+sgct_core::TiledImage::TiledImage()
+{
+    mFile = nullptr;
+    mWidth = 0;
+    mHeight = 0;
+    mChannels = 0;
+    mBytesPerChannel = 0;
+    mTileSize = 0;
+    mPreferBGR = false;
+}
+
+sgct_core::TiledImage::~TiledImage()
+{
+    close();
+}
+
+/*!
+    Convert an image to a tiled and mip-mapped file. All mip levels down to 1x1 are generated with a box filter.
+
+    \param src the source image (8 or 16-bit per channel)
+    \param filename the destination file
+    \param tileSize the width and height of a tile in pixels
+    \param compress set to true to deflate tiles (tiles that don't shrink are stored raw)
+    \returns true if the file was written successfully
+*/
+bool sgct_core::TiledImage::convert(Image & src, const std::string & filename, std::size_t tileSize, bool compress)
+{
+    double t0 = sgct::Engine::getTime();
+
+    if (src.getData() == nullptr || src.getWidth() == 0 || src.getHeight() == 0 || src.getChannels() == 0 ||
+        src.getBytesPerChannel() == 0 || src.getBytesPerChannel() > 2)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Cannot convert invalid image to '%s'!\n", filename.c_str());
+        return false;
+    }
+
+    if (tileSize < TILED_IMAGE_MIN_TILE_SIZE)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Tile size must be at least %d pixels!\n", TILED_IMAGE_MIN_TILE_SIZE);
+        return false;
+    }
+
+    std::size_t width = src.getWidth();
+    std::size_t height = src.getHeight();
+    std::size_t channels = src.getChannels();
+    std::size_t bpc = src.getBytesPerChannel();
+    std::size_t pixelSize = channels * bpc;
+
+    std::size_t numberOfLevels = 1;
+    while (levelSize(width, numberOfLevels - 1) > 1 || levelSize(height, numberOfLevels - 1) > 1)
+        numberOfLevels++;
+
+    std::vector< std::vector<TileInfo> > tileIndex(numberOfLevels);
+    std::size_t numberOfTiles = 0;
+    for (std::size_t l = 0; l < numberOfLevels; l++)
+    {
+        std::size_t tilesX = (levelSize(width, l) + tileSize - 1) / tileSize;
+        std::size_t tilesY = (levelSize(height, l) + tileSize - 1) / tileSize;
+        tileIndex[l].resize(tilesX * tilesY);
+        numberOfTiles += tilesX * tilesY;
+    }
+
+    FILE * fp = nullptr;
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    if (fopen_s(&fp, filename.c_str(), "wb") != 0 || !fp)
+#else
+    fp = fopen(filename.c_str(), "wb");
+    if (fp == nullptr)
+#endif
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Can't create file '%s'!\n", filename.c_str());
+        return false;
+    }
+
+    unsigned int header[TILED_IMAGE_HEADER_FIELDS];
+    header[0] = TILED_IMAGE_VERSION;
+    header[1] = static_cast<unsigned int>(width);
+    header[2] = static_cast<unsigned int>(height);
+    header[3] = static_cast<unsigned int>(channels);
+    header[4] = static_cast<unsigned int>(bpc);
+    header[5] = static_cast<unsigned int>(tileSize);
+    header[6] = static_cast<unsigned int>(numberOfLevels);
+    header[7] = src.getPreferBGRImport() ? TILED_IMAGE_FLAG_BGR : 0;
+
+    //write header and reserve space for the index which is written last
+    std::vector<TileInfo> emptyIndex(numberOfTiles);
+    memset(emptyIndex.data(), 0, emptyIndex.size() * sizeof(TileInfo));
+    bool ok = fwrite(TILED_IMAGE_MAGIC, 1, TILED_IMAGE_MAGIC_LENGTH, fp) == TILED_IMAGE_MAGIC_LENGTH &&
+        fwrite(header, sizeof(unsigned int), TILED_IMAGE_HEADER_FIELDS, fp) == TILED_IMAGE_HEADER_FIELDS &&
+        fwrite(emptyIndex.data(), sizeof(TileInfo), numberOfTiles, fp) == numberOfTiles;
+
+    unsigned long long offset = TILED_IMAGE_MAGIC_LENGTH + sizeof(header) + numberOfTiles * sizeof(TileInfo);
+
+    std::vector<unsigned char> tileBuffer(tileSize * tileSize * pixelSize);
+    std::vector<unsigned char> compressedBuffer(compress ? compressBound(static_cast<uLong>(tileBuffer.size())) : 0);
+    std::vector<unsigned char> currentLevel;
+    std::vector<unsigned char> nextLevel;
+    const unsigned char * levelData = src.getData();
+
+    for (std::size_t l = 0; l < numberOfLevels && ok; l++)
+    {
+        std::size_t levelWidth = levelSize(width, l);
+        std::size_t levelHeight = levelSize(height, l);
+        std::size_t tilesX = (levelWidth + tileSize - 1) / tileSize;
+        std::size_t tilesY = (levelHeight + tileSize - 1) / tileSize;
+
+        for (std::size_t ty = 0; ty < tilesY && ok; ty++)
+            for (std::size_t tx = 0; tx < tilesX && ok; tx++)
+            {
+                std::size_t x = tx * tileSize;
+                std::size_t y = ty * tileSize;
+                std::size_t tileWidth = std::min(tileSize, levelWidth - x);
+                std::size_t tileHeight = std::min(tileSize, levelHeight - y);
+                std::size_t rowSize = tileWidth * pixelSize;
+                std::size_t rawSize = rowSize * tileHeight;
+
+                for (std::size_t r = 0; r < tileHeight; r++)
+                    memcpy(tileBuffer.data() + r * rowSize, levelData + ((y + r) * levelWidth + x) * pixelSize, rowSize);
+
+                TileInfo & info = tileIndex[l][ty * tilesX + tx];
+                info.mOffset = offset;
+                info.mEncoding = Tile_Raw;
+                info.mStoredSize = static_cast<unsigned int>(rawSize);
+                const unsigned char * storedData = tileBuffer.data();
+
+                if (compress)
+                {
+                    uLongf compressedSize = static_cast<uLongf>(compressedBuffer.size());
+                    if (compress2(compressedBuffer.data(), &compressedSize, tileBuffer.data(), static_cast<uLong>(rawSize), Z_DEFAULT_COMPRESSION) == Z_OK &&
+                        compressedSize < rawSize)
+                    {
+                        info.mEncoding = Tile_Deflate;
+                        info.mStoredSize = static_cast<unsigned int>(compressedSize);
+                        storedData = compressedBuffer.data();
+                    }
+                }
+
+                ok = fwrite(storedData, 1, info.mStoredSize, fp) == info.mStoredSize;
+                offset += info.mStoredSize;
+            }
+
+        //generate next mip level from this one
+        if (ok && l + 1 < numberOfLevels)
+        {
+            nextLevel.resize(levelSize(width, l + 1) * levelSize(height, l + 1) * pixelSize);
+            downsample(levelData, levelWidth, levelHeight, nextLevel.data(), channels, bpc);
+            currentLevel.swap(nextLevel);
+            levelData = currentLevel.data();
+        }
+    }
+
+    //write index
+    if (ok)
+    {
+        ok = seekFile(fp, TILED_IMAGE_MAGIC_LENGTH + sizeof(header));
+        for (std::size_t l = 0; l < numberOfLevels && ok; l++)
+            ok = fwrite(tileIndex[l].data(), sizeof(TileInfo), tileIndex[l].size(), fp) == tileIndex[l].size();
+    }
+
+    if (fclose(fp) != 0)
+        ok = false;
+
+    if (!ok)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Failed to write '%s'!\n", filename.c_str());
+        remove(filename.c_str());
+        return false;
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO, "TiledImage: Wrote %s (%dx%d, %d levels, %d tiles, %.1f MB) in %.2f ms.\n",
+        filename.c_str(), width, height, numberOfLevels, numberOfTiles, static_cast<double>(offset) / (1024.0 * 1024.0), (sgct::Engine::getTime() - t0)*1000.0);
+
+    return true;
+}
+
+/*!
+    Open a tiled image and read its header and tile index. No pixel data is read.
+*/
+bool sgct_core::TiledImage::open(const std::string & filename)
+{
+    close();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    if (fopen_s(&mFile, filename.c_str(), "rb") != 0 || !mFile)
+#else
+    mFile = fopen(filename.c_str(), "rb");
+    if (mFile == nullptr)
+#endif
+    {
+        mFile = nullptr;
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Can't open file '%s'!\n", filename.c_str());
+        return false;
+    }
+
+    char magic[TILED_IMAGE_MAGIC_LENGTH];
+    unsigned int header[TILED_IMAGE_HEADER_FIELDS];
+    if (fread(magic, 1, TILED_IMAGE_MAGIC_LENGTH, mFile) != TILED_IMAGE_MAGIC_LENGTH ||
+        memcmp(magic, TILED_IMAGE_MAGIC, TILED_IMAGE_MAGIC_LENGTH) != 0 ||
+        fread(header, sizeof(unsigned int), TILED_IMAGE_HEADER_FIELDS, mFile) != TILED_IMAGE_HEADER_FIELDS)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: '%s' is not a tiled image!\n", filename.c_str());
+        fclose(mFile);
+        mFile = nullptr;
+        return false;
+    }
+
+    //the levels go down to 1x1, which is floor(log2(max(width, height))) + 1 levels
+    unsigned int maxLevels = 1;
+    for (unsigned int size = std::max(header[1], header[2]); size > 1; size >>= 1)
+        maxLevels++;
+
+    if (header[0] != TILED_IMAGE_VERSION || header[1] == 0 || header[2] == 0 || header[3] == 0 || header[3] > 4 ||
+        header[4] == 0 || header[4] > 2 || header[5] < TILED_IMAGE_MIN_TILE_SIZE || header[6] == 0 || header[6] > maxLevels)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Unsupported version or invalid header in '%s'!\n", filename.c_str());
+        fclose(mFile);
+        mFile = nullptr;
+        return false;
+    }
+
+    mWidth = header[1];
+    mHeight = header[2];
+    mChannels = header[3];
+    mBytesPerChannel = header[4];
+    mTileSize = header[5];
+    mPreferBGR = (header[7] & TILED_IMAGE_FLAG_BGR) != 0;
+
+    //the tile index must fit in the file before it is allocated
+    unsigned long long indexOffset = TILED_IMAGE_MAGIC_LENGTH + sizeof(header);
+    unsigned long long fileSize = getFileSize(mFile);
+    unsigned long long numberOfTiles = 0;
+    for (std::size_t l = 0; l < header[6]; l++)
+        numberOfTiles += static_cast<unsigned long long>((levelSize(mWidth, l) + mTileSize - 1) / mTileSize) *
+            ((levelSize(mHeight, l) + mTileSize - 1) / mTileSize);
+
+    if (fileSize < indexOffset || numberOfTiles > (fileSize - indexOffset) / sizeof(TileInfo) || !seekFile(mFile, indexOffset))
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Truncated tile index in '%s'!\n", filename.c_str());
+        lock.unlock();
+        close();
+        return false;
+    }
+
+    mLevels.resize(header[6]);
+    for (std::size_t l = 0; l < mLevels.size(); l++)
+    {
+        LevelInfo & level = mLevels[l];
+        level.mTilesX = (levelSize(mWidth, l) + mTileSize - 1) / mTileSize;
+        level.mTilesY = (levelSize(mHeight, l) + mTileSize - 1) / mTileSize;
+        level.mTiles.resize(level.mTilesX * level.mTilesY);
+
+        if (fread(level.mTiles.data(), sizeof(TileInfo), level.mTiles.size(), mFile) != level.mTiles.size())
+        {
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Truncated tile index in '%s'!\n", filename.c_str());
+            lock.unlock();
+            close();
+            return false;
+        }
+
+        for (std::size_t i = 0; i < level.mTiles.size(); i++)
+        {
+            const TileInfo & info = level.mTiles[i];
+            if (info.mEncoding > Tile_Deflate || info.mOffset > fileSize || info.mStoredSize > fileSize - info.mOffset)
+            {
+                sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Tile %u at level %u is outside of '%s'!\n",
+                    static_cast<unsigned int>(i), static_cast<unsigned int>(l), filename.c_str());
+                lock.unlock();
+                close();
+                return false;
+            }
+        }
+    }
+
+    mFilename.assign(filename);
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "TiledImage: Opened %s (%dx%d, %d channels, %d-bit, %d levels, tile size %d).\n",
+        mFilename.c_str(), mWidth, mHeight, mChannels, mBytesPerChannel * 8, mLevels.size(), mTileSize);
+
+    return true;
+}
+
+void sgct_core::TiledImage::close()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (mFile)
+    {
+        fclose(mFile);
+        mFile = nullptr;
+    }
+
+    mLevels.clear();
+    mReadBuffer.clear();
+    mFilename.clear();
+}
+
+bool sgct_core::TiledImage::isOpen() const
+{
+    return mFile != nullptr;
+}
+
+std::size_t sgct_core::TiledImage::getTilesX(std::size_t level) const
+{
+    return level < mLevels.size() ? mLevels[level].mTilesX : 0;
+}
+
+std::size_t sgct_core::TiledImage::getTilesY(std::size_t level) const
+{
+    return level < mLevels.size() ? mLevels[level].mTilesY : 0;
+}
+
+/*!
+    Get the pixel rectangle covered by a tile. Tiles along the right and top edges may be smaller than the tile size.
+*/
+void sgct_core::TiledImage::getTileRect(std::size_t level, std::size_t tileX, std::size_t tileY, std::size_t & x, std::size_t & y, std::size_t & width, std::size_t & height) const
+{
+    x = tileX * mTileSize;
+    y = tileY * mTileSize;
+    width = std::min(mTileSize, getWidth(level) - std::min(x, getWidth(level)));
+    height = std::min(mTileSize, getHeight(level) - std::min(y, getHeight(level)));
+}
+
+/*!
+    Read and decode a single tile. This function is thread safe.
+
+    \param level the mip level
+    \param tileX the tile column
+    \param tileY the tile row (counted from the bottom)
+    \param buffer receives the tightly packed tile pixels
+    \returns true if the tile was read successfully
+*/
+bool sgct_core::TiledImage::readTile(std::size_t level, std::size_t tileX, std::size_t tileY, std::vector<unsigned char> & buffer)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    if (mFile == nullptr || level >= mLevels.size() || tileX >= mLevels[level].mTilesX || tileY >= mLevels[level].mTilesY)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Invalid tile %d,%d at level %d!\n", tileX, tileY, level);
+        return false;
+    }
+
+    std::size_t x, y, width, height;
+    getTileRect(level, tileX, tileY, x, y, width, height);
+    std::size_t rawSize = width * height * mChannels * mBytesPerChannel;
+    buffer.resize(rawSize);
+
+    const TileInfo & info = mLevels[level].mTiles[tileY * mLevels[level].mTilesX + tileX];
+    if (!seekFile(mFile, info.mOffset))
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Failed to seek to tile %d,%d at level %d in '%s'!\n", tileX, tileY, level, mFilename.c_str());
+        return false;
+    }
+
+    bool ok = false;
+    if (info.mEncoding == Tile_Raw)
+    {
+        ok = info.mStoredSize == rawSize && fread(buffer.data(), 1, rawSize, mFile) == rawSize;
+    }
+    else if (info.mEncoding == Tile_Deflate)
+    {
+        mReadBuffer.resize(info.mStoredSize);
+        uLongf decompressedSize = static_cast<uLongf>(rawSize);
+        ok = fread(mReadBuffer.data(), 1, info.mStoredSize, mFile) == info.mStoredSize &&
+            uncompress(buffer.data(), &decompressedSize, mReadBuffer.data(), static_cast<uLong>(info.mStoredSize)) == Z_OK &&
+            decompressedSize == rawSize;
+    }
+
+    if (!ok)
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Failed to read tile %d,%d at level %d in '%s'!\n", tileX, tileY, level, mFilename.c_str());
+
+    return ok;
+}
+
+/*!
+    Load a complete mip level into an image.
+*/
+bool sgct_core::TiledImage::loadLevel(std::size_t level, Image & img)
+{
+    if (level >= mLevels.size())
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Invalid level %d!\n", level);
+        return false;
+    }
+
+    return loadRegion(level, 0, 0, mLevels[level].mTilesX - 1, mLevels[level].mTilesY - 1, img);
+}
+
+/*!
+    Load an inclusive range of tiles at a mip level into an image. Only the requested tiles are read from disk.
+*/
+bool sgct_core::TiledImage::loadRegion(std::size_t level, std::size_t firstTileX, std::size_t firstTileY, std::size_t lastTileX, std::size_t lastTileY, Image & img)
+{
+    if (level >= mLevels.size() || firstTileX > lastTileX || firstTileY > lastTileY ||
+        lastTileX >= mLevels[level].mTilesX || lastTileY >= mLevels[level].mTilesY)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledImage: Invalid tile range at level %d!\n", level);
+        return false;
+    }
+
+    std::size_t x0, y0, x1, y1, w, h;
+    getTileRect(level, firstTileX, firstTileY, x0, y0, w, h);
+    getTileRect(level, lastTileX, lastTileY, x1, y1, w, h);
+    std::size_t width = x1 + w - x0;
+    std::size_t height = y1 + h - y0;
+    std::size_t pixelSize = mChannels * mBytesPerChannel;
+
+    img.setSize(width, height);
+    img.setChannels(mChannels);
+    img.setBytesPerChannel(mBytesPerChannel);
+    img.setPreferBGRImport(mPreferBGR);
+    if (!img.allocateOrResizeData())
+        return false;
+
+    std::vector<unsigned char> tile;
+    for (std::size_t ty = firstTileY; ty <= lastTileY; ty++)
+        for (std::size_t tx = firstTileX; tx <= lastTileX; tx++)
+        {
+            if (!readTile(level, tx, ty, tile))
+                return false;
+
+            std::size_t x, y;
+            getTileRect(level, tx, ty, x, y, w, h);
+            for (std::size_t r = 0; r < h; r++)
+                memcpy(img.getData() + ((y - y0 + r) * width + (x - x0)) * pixelSize, tile.data() + r * w * pixelSize, w * pixelSize);
+        }
+
+    return true;
+}
+
+void sgct_core::TiledImage::downsample(const unsigned char * src, std::size_t srcWidth, std::size_t srcHeight,
+    unsigned char * dst, std::size_t channels, std::size_t bpc)
+{
+    if (bpc == 2)
+        downsampleBox(reinterpret_cast<const unsigned short *>(src), srcWidth, srcHeight, reinterpret_cast<unsigned short *>(dst), channels);
+    else
+        downsampleBox(src, srcWidth, srcHeight, dst, channels);
+}
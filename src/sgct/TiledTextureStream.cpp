@@ -0,0 +1,153 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/TiledTextureStream.h>
+#include <sgct/MessageHandler.h>
+#include <utility>
+#include <new>
+
+sgct_core::TiledTextureStream::TiledTextureStream(const std::string & name, unsigned int texId, std::size_t tileBudget)
+{
+    mName.assign(name);
+    mTexId = texId;
+    mTileBudget = tileBudget > 0 ? tileBudget : 1;
+    mThreadPtr = nullptr;
+    mRunning = false;
+    mFailed = false;
+    mReaderDone = true;
+}
+
+sgct_core::TiledTextureStream::~TiledTextureStream()
+{
+    stop();
+}
+
+/*!
+    Start reading all tiles from firstLevel down to level 0 on a worker thread. Levels coarser than firstLevel
+    are expected to be uploaded already.
+*/
+void sgct_core::TiledTextureStream::start(std::size_t firstLevel)
+{
+    stop();
+
+    mPendingTiles.assign(mImage.getNumberOfLevels(), 0);
+    for (std::size_t l = 0; l <= firstLevel && l < mPendingTiles.size(); l++)
+        mPendingTiles[l] = mImage.getTilesX(l) * mImage.getTilesY(l);
+
+    mRunning = true;
+    mFailed = false;
+    mReaderDone = false;
+    mThreadPtr = new (std::nothrow) std::thread(&TiledTextureStream::readTiles, this, firstLevel);
+    if (mThreadPtr == nullptr)
+    {
+        mRunning = false;
+        mFailed = true;
+        mReaderDone = true;
+    }
+}
+
+/*!
+    Stop the worker thread and discard queued tiles.
+*/
+void sgct_core::TiledTextureStream::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mRunning = false;
+    }
+    mCondition.notify_all();
+
+    if (mThreadPtr)
+    {
+        mThreadPtr->join();
+        delete mThreadPtr;
+        mThreadPtr = nullptr;
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mQueue.clear();
+    mReaderDone = true;
+}
+
+/*!
+    Take the next decoded tile from the queue without blocking.
+    \returns false if no tile is ready
+*/
+bool sgct_core::TiledTextureStream::popTile(Tile & tile)
+{
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mQueue.empty())
+            return false;
+
+        tile = std::move(mQueue.front());
+        mQueue.pop_front();
+    }
+
+    mCondition.notify_all();
+    return true;
+}
+
+/*!
+    Register that a tile at a level has been uploaded.
+    \returns true if this completed the level
+*/
+bool sgct_core::TiledTextureStream::tileUploaded(std::size_t level)
+{
+    if (level >= mPendingTiles.size() || mPendingTiles[level] == 0)
+        return false;
+
+    return --mPendingTiles[level] == 0;
+}
+
+/*!
+    \returns true when the reader has finished and all queued tiles have been taken
+*/
+bool sgct_core::TiledTextureStream::isDone()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    return mReaderDone && mQueue.empty();
+}
+
+void sgct_core::TiledTextureStream::readTiles(std::size_t firstLevel)
+{
+    for (std::size_t l = firstLevel + 1; l-- > 0 && mRunning;)
+    {
+        std::size_t tilesX = mImage.getTilesX(l);
+        std::size_t tilesY = mImage.getTilesY(l);
+
+        for (std::size_t ty = 0; ty < tilesY && mRunning; ty++)
+            for (std::size_t tx = 0; tx < tilesX && mRunning; tx++)
+            {
+                Tile tile;
+                tile.mLevel = l;
+                tile.mX = tx;
+                tile.mY = ty;
+
+                //read outside the lock so that the render thread never waits on disk I/O
+                std::size_t x, y;
+                mImage.getTileRect(l, tx, ty, x, y, tile.mWidth, tile.mHeight);
+                if (!mImage.readTile(l, tx, ty, tile.mData))
+                {
+                    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "TiledTextureStream: Streaming of '%s' aborted!\n", mName.c_str());
+                    mFailed = true;
+                    mRunning = false;
+                    break;
+                }
+
+                std::unique_lock<std::mutex> lock(mMutex);
+                while (mRunning && mQueue.size() >= mTileBudget)
+                    mCondition.wait(lock);
+
+                if (mRunning)
+                    mQueue.push_back(std::move(tile));
+            }
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mReaderDone = true;
+}
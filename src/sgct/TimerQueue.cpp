@@ -0,0 +1,158 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/TimerQueue.h>
+
+sgct_core::TimerQueue::TimerQueue()
+{
+}
+
+/*!
+Add a timer, it is first due one interval after the given time. A timer with the same id is replaced.
+
+\param id is the unique id of the timer that is passed to the callback
+\param interval is the time between firings
+\param time is the current time, in the same clock as the time passed to popExpired
+\param fn is the callback
+*/
+void sgct_core::TimerQueue::add(std::size_t id, double interval, double time, Callback fn)
+{
+    remove(id);
+
+    std::size_t slot;
+    if (mFreeSlots.empty())
+    {
+        slot = mTimers.size();
+        mTimers.push_back(Timer());
+    }
+    else
+    {
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+
+    Timer & timer = mTimers[slot];
+    timer.mId = id;
+    timer.mInterval = interval;
+    timer.mDue = time + interval;
+    timer.mCallback = fn;
+    timer.mHeapIndex = mHeap.size();
+
+    mHeap.push_back(slot);
+    mSlots[id] = slot;
+    siftUp(timer.mHeapIndex);
+}
+
+/*!
+Remove a timer.
+
+\returns false if there is no timer with the id
+*/
+bool sgct_core::TimerQueue::remove(std::size_t id)
+{
+    std::unordered_map<std::size_t, std::size_t>::iterator it = mSlots.find(id);
+    if (it == mSlots.end())
+        return false;
+
+    std::size_t slot = it->second;
+    std::size_t index = mTimers[slot].mHeapIndex;
+    mSlots.erase(it);
+
+    //move the last timer of the heap to the hole and restore the order from there
+    std::size_t last = mHeap.size() - 1;
+    if (index != last)
+    {
+        swap(index, last);
+        mHeap.pop_back();
+        siftDown(index);
+        siftUp(index);
+    }
+    else
+        mHeap.pop_back();
+
+    mTimers[slot].mCallback = nullptr;
+    mFreeSlots.push_back(slot);
+    return true;
+}
+
+bool sgct_core::TimerQueue::contains(std::size_t id) const
+{
+    return mSlots.find(id) != mSlots.end();
+}
+
+/*!
+\returns the callback of a timer or nullptr if there is no timer with the id
+*/
+sgct_core::TimerQueue::Callback sgct_core::TimerQueue::getCallback(std::size_t id) const
+{
+    std::unordered_map<std::size_t, std::size_t>::const_iterator it = mSlots.find(id);
+    return it != mSlots.end() ? mTimers[it->second].mCallback : nullptr;
+}
+
+/*!
+Reschedules the timers that are due at the given time and adds their ids to the list, in the order they were due.
+The callbacks are not called, so that the caller can fire them after the queue is consistent again.
+*/
+void sgct_core::TimerQueue::popExpired(double time, std::vector<std::size_t> & ids)
+{
+    //a rescheduled timer is due after the time, so every timer is visited at most once
+    while (!mHeap.empty() && mTimers[mHeap[0]].mDue < time)
+    {
+        Timer & timer = mTimers[mHeap[0]];
+        ids.push_back(timer.mId);
+        timer.mDue = time + timer.mInterval;
+        siftDown(0);
+    }
+}
+
+void sgct_core::TimerQueue::clear()
+{
+    mTimers.clear();
+    mFreeSlots.clear();
+    mHeap.clear();
+    mSlots.clear();
+}
+
+void sgct_core::TimerQueue::siftUp(std::size_t index)
+{
+    while (index > 0)
+    {
+        std::size_t parent = (index - 1) / 2;
+        if (!isEarlier(index, parent))
+            break;
+        swap(index, parent);
+        index = parent;
+    }
+}
+
+void sgct_core::TimerQueue::siftDown(std::size_t index)
+{
+    std::size_t size = mHeap.size();
+    while (true)
+    {
+        std::size_t earliest = index;
+        std::size_t left = index * 2 + 1;
+        std::size_t right = left + 1;
+        if (left < size && isEarlier(left, earliest))
+            earliest = left;
+        if (right < size && isEarlier(right, earliest))
+            earliest = right;
+        if (earliest == index)
+            break;
+        swap(index, earliest);
+        index = earliest;
+    }
+}
+
+void sgct_core::TimerQueue::swap(std::size_t a, std::size_t b)
+{
+    std::size_t slot = mHeap[a];
+    mHeap[a] = mHeap[b];
+    mHeap[b] = slot;
+    mTimers[mHeap[a]].mHeapIndex = a;
+    mTimers[mHeap[b]].mHeapIndex = b;
+}
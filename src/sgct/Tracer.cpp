@@ -0,0 +1,524 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/Tracer.h>
+#include <sgct/Engine.h>
+#include <sgct/MessageHandler.h>
+#include <thread>
+#include <map>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#if defined(_MSC_VER) && (_MSC_VER < 1900) //thread_local is supported from visual studio 2015
+#define SGCT_THREAD_LOCAL __declspec(thread)
+#else
+#define SGCT_THREAD_LOCAL thread_local
+#endif
+
+#define TRACE_MAGIC "SGTR"
+#define TRACE_VERSION 1
+#define TRACE_DEFAULT_EVENTS_PER_THREAD 16384
+
+sgct_core::Tracer * sgct_core::Tracer::mInstance = nullptr;
+std::atomic<bool> sgct_core::Tracer::mEnabled(false);
+std::atomic<unsigned int> sgct_core::Tracer::mGeneration(0);
+
+namespace
+{
+    SGCT_THREAD_LOCAL void * tThreadBuffer = nullptr;
+    SGCT_THREAD_LOCAL unsigned int tGeneration = 0;
+
+    FILE * openFile(const std::string & filename, const char * mode)
+    {
+        FILE * fp = nullptr;
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+        if (fopen_s(&fp, filename.c_str(), mode) != 0)
+            fp = nullptr;
+#else
+        fp = fopen(filename.c_str(), mode);
+#endif
+        return fp;
+    }
+
+    template<class T> void write(std::vector<char> & buffer, const T & value)
+    {
+        std::size_t offset = buffer.size();
+        buffer.resize(offset + sizeof(T));
+        memcpy(&buffer[offset], &value, sizeof(T));
+    }
+
+    void writeString(std::vector<char> & buffer, const std::string & str)
+    {
+        write(buffer, static_cast<unsigned int>(str.size()));
+        buffer.insert(buffer.end(), str.begin(), str.end());
+    }
+
+    class Reader
+    {
+    public:
+        Reader(const char * data, std::size_t size) : mData(data), mSize(size), mPosition(0) {}
+
+        template<class T> bool read(T & value)
+        {
+            if (mSize - mPosition < sizeof(T))
+                return false;
+            memcpy(&value, mData + mPosition, sizeof(T));
+            mPosition += sizeof(T);
+            return true;
+        }
+
+        bool readString(std::string & str)
+        {
+            unsigned int length;
+            if (!read(length) || mSize - mPosition < length)
+                return false;
+            str.assign(mData + mPosition, length);
+            mPosition += length;
+            return true;
+        }
+
+    private:
+        const char * mData;
+        std::size_t mSize;
+        std::size_t mPosition;
+    };
+
+    void writeJsonString(FILE * fp, const std::string & str)
+    {
+        fputc('"', fp);
+        for (std::size_t i = 0; i < str.size(); i++)
+        {
+            unsigned char c = static_cast<unsigned char>(str[i]);
+            if (c == '"' || c == '\\')
+                fprintf(fp, "\\%c", c);
+            else if (c < 0x20)
+                fprintf(fp, "\\u%04x", c);
+            else
+                fputc(c, fp);
+        }
+        fputc('"', fp);
+    }
+}
+
+sgct_core::Tracer::Tracer()
+{
+    mPaused.store(false);
+    mDroppedEvents.store(0);
+    mEventsPerThread = TRACE_DEFAULT_EVENTS_PER_THREAD;
+    mNodeId = 0;
+    mGeneration++;
+}
+
+sgct_core::Tracer::~Tracer()
+{
+    mEnabled.store(false);
+
+    std::lock_guard<std::mutex> lock(mBuffersMutex);
+    for (std::size_t i = 0; i < mBuffers.size(); i++)
+        delete mBuffers[i];
+    mBuffers.clear();
+    mTracks.clear();
+}
+
+/*!
+\returns the time of the zones in seconds, the same clock as sgct::Engine::getTime
+*/
+double sgct_core::Tracer::getTime()
+{
+    return sgct::Engine::getTime();
+}
+
+/*!
+Start or stop recording zones. Events recorded earlier are kept.
+*/
+void sgct_core::Tracer::setEnabled(bool state)
+{
+    mEnabled.store(state);
+}
+
+/*!
+Set the size of the ring of every thread, rounded up to a power of two. Only threads that haven't recorded anything yet are affected, so set it before enabling tracing.
+*/
+void sgct_core::Tracer::setEventsPerThread(std::size_t numberOfEvents)
+{
+    std::size_t capacity = 1;
+    while (capacity < numberOfEvents)
+        capacity <<= 1;
+
+    std::lock_guard<std::mutex> lock(mBuffersMutex);
+    mEventsPerThread = capacity;
+}
+
+/*!
+Name the calling thread in the exported trace.
+*/
+void sgct_core::Tracer::setThreadName(const char * name)
+{
+    ThreadBuffer * buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(mBuffersMutex);
+    buffer->mName = name;
+}
+
+/*!
+Set the cluster node that the local events belong to.
+*/
+void sgct_core::Tracer::setNode(int nodeId, const std::string & name)
+{
+    std::lock_guard<std::mutex> lock(mBuffersMutex);
+    mNodeId = nodeId;
+    mNodeName = name;
+}
+
+/*!
+Record a zone of the calling thread. Doesn't lock or allocate once the thread has recorded its first event.
+
+\param name the name of the zone, must outlive the tracer
+\param start the start time from getTime()
+\param end the end time from getTime()
+\param argument an index shown with the zone, -1 if none
+*/
+void sgct_core::Tracer::record(const char * name, double start, double end, int argument)
+{
+    record(getThreadBuffer(), name, start, end, argument);
+}
+
+/*!
+Get a track for events that aren't timed by the recording thread, created the first time it is requested. A track
+must only be recorded on by one thread at a time.
+
+\param name the name of the track in the exported trace
+*/
+sgct_core::Tracer::ThreadBuffer * sgct_core::Tracer::getTrack(const char * name)
+{
+    {
+        std::lock_guard<std::mutex> lock(mBuffersMutex);
+        for (std::size_t i = 0; i < mTracks.size(); i++)
+            if (mTracks[i]->mName == name)
+                return mTracks[i];
+    }
+
+    ThreadBuffer * track = createBuffer();
+    std::lock_guard<std::mutex> lock(mBuffersMutex);
+    track->mName = name;
+    mTracks.push_back(track);
+    return track;
+}
+
+/*!
+Record a zone on a track from getTrack or on a thread ring.
+*/
+void sgct_core::Tracer::record(ThreadBuffer * buffer, const char * name, double start, double end, int argument)
+{
+    //snapshot() sets mPaused and then waits until no thread is writing
+    buffer->mWriting.store(true);
+    if (mPaused.load())
+    {
+        buffer->mWriting.store(false, std::memory_order_release);
+        mDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    std::size_t count = buffer->mCount.load(std::memory_order_relaxed);
+    Event & event = buffer->mEvents[count & (buffer->mEvents.size() - 1)];
+    event.mName = name;
+    event.mStart = start;
+    event.mDuration = static_cast<float>(end - start);
+    event.mArgument = argument;
+
+    buffer->mCount.store(count + 1, std::memory_order_release);
+    buffer->mWriting.store(false, std::memory_order_release);
+}
+
+/*!
+\returns the number of events that were dropped because they were recorded while a trace was collected
+*/
+unsigned long long sgct_core::Tracer::getNumberOfDroppedEvents()
+{
+    return mDroppedEvents.load();
+}
+
+/*!
+Write the local events so that they can be sent to another node and added there with addRemoteTrace.
+
+\param requestTime the local time when the other node's request was received, stored with the time of serialization
+to estimate the clock offset like NTP does
+*/
+void sgct_core::Tracer::serialize(std::vector<char> & buffer, double requestTime)
+{
+    NodeTrace trace;
+    snapshot(trace);
+
+    //zone names are sent once and referred to by index
+    std::map<std::string, unsigned int> nameIndices;
+    std::vector<const char *> names;
+    for (std::size_t i = 0; i < trace.mThreads.size(); i++)
+        for (std::size_t j = 0; j < trace.mThreads[i].mEvents.size(); j++)
+        {
+            const char * name = trace.mThreads[i].mEvents[j].mName;
+            if (nameIndices.insert(std::make_pair(std::string(name), static_cast<unsigned int>(names.size()))).second)
+                names.push_back(name);
+        }
+
+    buffer.clear();
+    buffer.insert(buffer.end(), TRACE_MAGIC, TRACE_MAGIC + 4);
+    write(buffer, static_cast<unsigned int>(TRACE_VERSION));
+    write(buffer, trace.mNodeId);
+    writeString(buffer, trace.mName);
+    write(buffer, requestTime);
+    write(buffer, getTime());
+
+    write(buffer, static_cast<unsigned int>(names.size()));
+    for (std::size_t i = 0; i < names.size(); i++)
+        writeString(buffer, names[i]);
+
+    write(buffer, static_cast<unsigned int>(trace.mThreads.size()));
+    for (std::size_t i = 0; i < trace.mThreads.size(); i++)
+    {
+        const ThreadTrace & thread = trace.mThreads[i];
+        write(buffer, thread.mThreadId);
+        writeString(buffer, thread.mName);
+        write(buffer, static_cast<unsigned int>(thread.mEvents.size()));
+        for (std::size_t j = 0; j < thread.mEvents.size(); j++)
+        {
+            const Event & event = thread.mEvents[j];
+            write(buffer, nameIndices[event.mName]);
+            write(buffer, event.mStart);
+            write(buffer, event.mDuration);
+            write(buffer, event.mArgument);
+        }
+    }
+}
+
+/*!
+Add the events of another node, replacing earlier events of the same node.
+
+\param data the output of serialize() on the other node
+\param size the size of the data in bytes
+\param requestTime the local time when the data was requested
+\param receiveTime the local time when the data was received
+
+The clock offset of the other node is estimated as ((t1 - t0) + (t2 - t3)) / 2 and subtracted from its times, where t0 is the request
+time, t1 and t2 the remote times when the request was received and the reply sent, and t3 the receive time. The
+error is at most half the difference between the network delays of the request and the reply.
+
+\returns false if the data is invalid
+*/
+bool sgct_core::Tracer::addRemoteTrace(const char * data, std::size_t size, double requestTime, double receiveTime)
+{
+    Reader reader(data, size);
+    char magic[4];
+    unsigned int version;
+    NodeTrace trace;
+    double remoteRequestTime, sendTime;
+    unsigned int numberOfNames;
+    if (!reader.read(magic) || memcmp(magic, TRACE_MAGIC, 4) != 0 || !reader.read(version) || version != TRACE_VERSION ||
+        !reader.read(trace.mNodeId) || !reader.readString(trace.mName) ||
+        !reader.read(remoteRequestTime) || !reader.read(sendTime) || !reader.read(numberOfNames))
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Tracer: Invalid trace received.\n");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mRemoteMutex);
+
+    std::vector<const char *> names;
+    for (unsigned int i = 0; i < numberOfNames; i++)
+    {
+        std::string name;
+        if (!reader.readString(name))
+        {
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Tracer: Invalid trace received.\n");
+            return false;
+        }
+        names.push_back(mRemoteNames.insert(name).first->c_str());
+    }
+
+    double offset = ((requestTime - remoteRequestTime) + (receiveTime - sendTime)) * 0.5;
+    unsigned int numberOfThreads;
+    bool valid = reader.read(numberOfThreads);
+    for (unsigned int i = 0; valid && i < numberOfThreads; i++)
+    {
+        ThreadTrace thread;
+        unsigned int numberOfEvents;
+        valid = reader.read(thread.mThreadId) && reader.readString(thread.mName) && reader.read(numberOfEvents);
+        for (unsigned int j = 0; valid && j < numberOfEvents; j++)
+        {
+            Event event;
+            unsigned int nameIndex;
+            valid = reader.read(nameIndex) && nameIndex < names.size() &&
+                reader.read(event.mStart) && reader.read(event.mDuration) && reader.read(event.mArgument);
+            if (valid)
+            {
+                event.mName = names[nameIndex];
+                event.mStart += offset;
+                thread.mEvents.push_back(event);
+            }
+        }
+        trace.mThreads.push_back(thread);
+    }
+
+    if (!valid)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Tracer: Invalid trace received from node %d.\n", trace.mNodeId);
+        return false;
+    }
+
+    for (std::size_t i = 0; i < mRemoteTraces.size(); i++)
+        if (mRemoteTraces[i].mNodeId == trace.mNodeId)
+        {
+            mRemoteTraces[i] = trace;
+            return true;
+        }
+    mRemoteTraces.push_back(trace);
+    return true;
+}
+
+void sgct_core::Tracer::clearRemoteTraces()
+{
+    std::lock_guard<std::mutex> lock(mRemoteMutex);
+    mRemoteTraces.clear();
+    mRemoteNames.clear();
+}
+
+/*!
+Write the local and remote events as a Chrome trace, with one process per cluster node.
+
+\returns false if the file couldn't be written
+*/
+bool sgct_core::Tracer::exportChromeTrace(const std::string & filename)
+{
+    std::vector<NodeTrace> traces(1);
+    snapshot(traces[0]);
+
+    std::lock_guard<std::mutex> lock(mRemoteMutex);
+    traces.insert(traces.end(), mRemoteTraces.begin(), mRemoteTraces.end());
+
+    FILE * fp = openFile(filename, "wb");
+    if (fp == nullptr)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Tracer: Failed to write '%s'.\n", filename.c_str());
+        return false;
+    }
+
+    std::size_t numberOfEvents = 0;
+    bool first = true;
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (std::size_t i = 0; i < traces.size(); i++)
+    {
+        const NodeTrace & node = traces[i];
+        char label[32];
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+        sprintf_s(label, sizeof(label), "Node %d ", node.mNodeId);
+#else
+        sprintf(label, "Node %d ", node.mNodeId);
+#endif
+        fprintf(fp, "%s{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,\"args\":{\"name\":", first ? "" : ",\n", node.mNodeId);
+        writeJsonString(fp, label + node.mName);
+        fprintf(fp, "}},\n{\"ph\":\"M\",\"name\":\"process_sort_index\",\"pid\":%d,\"args\":{\"sort_index\":%d}}", node.mNodeId, node.mNodeId);
+        first = false;
+
+        for (std::size_t j = 0; j < node.mThreads.size(); j++)
+        {
+            const ThreadTrace & thread = node.mThreads[j];
+            if (!thread.mName.empty())
+            {
+                fprintf(fp, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":", node.mNodeId, thread.mThreadId);
+                writeJsonString(fp, thread.mName);
+                fprintf(fp, "}}");
+            }
+
+            for (std::size_t k = 0; k < thread.mEvents.size(); k++)
+            {
+                const Event & event = thread.mEvents[k];
+                fprintf(fp, ",\n{\"ph\":\"X\",\"name\":");
+                writeJsonString(fp, event.mName);
+                fprintf(fp, ",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", node.mNodeId, thread.mThreadId,
+                    event.mStart * 1e6, static_cast<double>(event.mDuration) * 1e6);
+                if (event.mArgument >= 0)
+                    fprintf(fp, ",\"args\":{\"index\":%d}", event.mArgument);
+                fprintf(fp, "}");
+            }
+            numberOfEvents += thread.mEvents.size();
+        }
+    }
+    fprintf(fp, "\n]}\n");
+
+    if (fclose(fp) != 0)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "Tracer: Failed to write '%s'.\n", filename.c_str());
+        return false;
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_INFO, "Tracer: Wrote %u events of %u node(s) to '%s'.\n",
+        static_cast<unsigned int>(numberOfEvents), static_cast<unsigned int>(traces.size()), filename.c_str());
+    return true;
+}
+
+/*!
+\returns the ring of the calling thread, created the first time a thread records
+*/
+sgct_core::Tracer::ThreadBuffer * sgct_core::Tracer::getThreadBuffer()
+{
+    if (tThreadBuffer != nullptr && tGeneration == mGeneration.load(std::memory_order_relaxed))
+        return static_cast<ThreadBuffer *>(tThreadBuffer);
+
+    ThreadBuffer * buffer = createBuffer();
+    tThreadBuffer = buffer;
+    tGeneration = mGeneration.load(std::memory_order_relaxed);
+    return buffer;
+}
+
+/*!
+\returns a new empty ring that is included in the snapshots
+*/
+sgct_core::Tracer::ThreadBuffer * sgct_core::Tracer::createBuffer()
+{
+    ThreadBuffer * buffer = new ThreadBuffer();
+    buffer->mCount.store(0);
+    buffer->mWriting.store(false);
+
+    std::lock_guard<std::mutex> lock(mBuffersMutex);
+    buffer->mEvents.resize(mEventsPerThread);
+    buffer->mThreadId = static_cast<unsigned int>(mBuffers.size());
+    mBuffers.push_back(buffer);
+    return buffer;
+}
+
+/*!
+Copy the events of all threads, oldest first. Threads that record meanwhile drop their events instead of waiting.
+*/
+void sgct_core::Tracer::snapshot(NodeTrace & trace)
+{
+    std::lock_guard<std::mutex> lock(mBuffersMutex);
+    trace.mNodeId = mNodeId;
+    trace.mName = mNodeName;
+    trace.mThreads.clear();
+
+    mPaused.store(true);
+    for (std::size_t i = 0; i < mBuffers.size(); i++)
+        while (mBuffers[i]->mWriting.load())
+            std::this_thread::yield();
+
+    for (std::size_t i = 0; i < mBuffers.size(); i++)
+    {
+        const ThreadBuffer * buffer = mBuffers[i];
+        std::size_t capacity = buffer->mEvents.size();
+        std::size_t count = buffer->mCount.load(std::memory_order_acquire);
+        std::size_t first = count > capacity ? count - capacity : 0;
+
+        ThreadTrace thread;
+        thread.mThreadId = buffer->mThreadId;
+        thread.mName = buffer->mName;
+        thread.mEvents.reserve(count - first);
+        for (std::size_t j = first; j < count; j++)
+            thread.mEvents.push_back(buffer->mEvents[j & (capacity - 1)]);
+        trace.mThreads.push_back(thread);
+    }
+
+    mPaused.store(false);
+}
@@ -14,12 +14,21 @@ For conditions of distribution and use, see copyright notice in sgct.h
 #include <sgct/FisheyeProjection.h>
 #include <sgct/SphericalMirrorProjection.h>
 #include <sgct/SpoutOutputProjection.h>
+#include <sgct/Engine.h>
+#include <sgct/helpers/SGCTFileFunctions.h>
+#include <chrono>
 //#include <glm/gtc/matrix_transform.hpp>
 
 
 sgct_core::Viewport::Viewport()
 {
     mNonLinearProjection = nullptr;
+    mReloadMeshPtr = nullptr;
+    for (std::size_t i = 0; i < CORRECTION_MESH_DATA; i++)
+    {
+        mPreparedImages[i] = nullptr;
+        mReloadImages[i] = nullptr;
+    }
     reset(0.0f, 0.0f, 1.0f, 1.0f);
 }
 
@@ -29,6 +38,12 @@ sgct_core::Viewport::Viewport()
 sgct_core::Viewport::Viewport(float x, float y, float xSize, float ySize)
 {
     mNonLinearProjection = nullptr;
+    mReloadMeshPtr = nullptr;
+    for (std::size_t i = 0; i < CORRECTION_MESH_DATA; i++)
+    {
+        mPreparedImages[i] = nullptr;
+        mReloadImages[i] = nullptr;
+    }
     reset(x, y, xSize, ySize);
 }
 
@@ -52,7 +67,16 @@ sgct_core::Viewport::~Viewport()
     if (mBlackLevelMaskTextureIndex)
         glDeleteTextures(1, &mBlackLevelMaskTextureIndex);
 
-    delete mMpcdiWarpMeshData;
+    for (std::size_t i = 0; i < CORRECTION_MESH_DATA; i++)
+    {
+        if (mPreparedImages[i])
+            delete mPreparedImages[i];
+        if (mReloadImages[i])
+            delete mReloadImages[i];
+    }
+
+    if (mReloadMeshPtr)
+        delete mReloadMeshPtr;
 }
 
 void sgct_core::Viewport::configure(tinyxml2::XMLElement * element)
@@ -85,6 +109,12 @@ void sgct_core::Viewport::configure(tinyxml2::XMLElement * element)
     if (element->Attribute("tracked") != nullptr)
         setTracked(strcmp(element->Attribute("tracked"), "true") == 0 ? true : false);
 
+    if (element->Attribute("warpLookup") != nullptr)
+        setUseWarpLookup(strcmp(element->Attribute("warpLookup"), "true") == 0 ? true : false);
+
+    if (element->Attribute("fitFrustumToMesh") != nullptr)
+        setFitFrustumToMesh(strcmp(element->Attribute("fitFrustumToMesh"), "true") == 0 ? true : false);
+
     //get eye if set
     if (element->Attribute("eye") != nullptr)
     {
@@ -306,7 +336,19 @@ void sgct_core::Viewport::reset(float x, float y, float xSize, float ySize)
     mOverlayTextureIndex = GL_FALSE;
     mBlendMaskTextureIndex = GL_FALSE;
     mBlackLevelMaskTextureIndex = GL_FALSE;
+    for (std::size_t i = 0; i < NUMBER_OF_DATA_TYPES; i++)
+    {
+        mDataPrepared[i] = false;
+        mDataUploadTimes[i] = 0.0;
+        mDataStamps[i][0] = mDataStamps[i][1] = 0;
+        mReloadStamps[i][0] = mReloadStamps[i][1] = 0;
+    }
+    for (std::size_t i = 0; i < CORRECTION_MESH_DATA; i++)
+        mMpcdiMasks[i] = false;
+    mPreparedMeshStatus = false;
     mTracked = false;
+    mUseWarpLookup = false;
+    mFitFrustumToMesh = false;
     mEnabled = true;
     mName.assign("NoName");
     mUser = ClusterManager::instance()->getDefaultUserPtr();
@@ -626,11 +668,40 @@ void sgct_core::Viewport::setCorrectionMesh(const char * meshPath)
     mMeshFilename.assign(meshPath);
 }
 
-void sgct_core::Viewport::setMpcdiWarpMesh(const char* meshData, size_t size)
+/*!
+Take over a warp field decoded from an .mpcdi package, the grid passed in is left with the previous contents of this viewport.
+*/
+void sgct_core::Viewport::setMpcdiWarpGrid(MpcdiWarpGrid & grid)
+{
+    mMpcdiWarpGrid.swap(grid);
+}
+
+/*!
+Set a blend (alphaMap) or black level (betaMap) mask decoded from an .mpcdi package. The viewport takes ownership of
+the image, which is uploaded by loadData.
+
+\param type BLEND_MASK_DATA or BLACK_LEVEL_MASK_DATA
+\param imgPtr the decoded mask
+\param name the path of the mask inside the package, used for messages only since it isn't a file on disk
+*/
+void sgct_core::Viewport::setMpcdiMask(DataType type, Image * imgPtr, const std::string & name)
 {
-    mMpcdiWarpMeshData = new char[size];
-    memcpy(mMpcdiWarpMeshData, meshData, size);
-    mMpcdiWarpMeshSize = size;
+    if (type != BLEND_MASK_DATA && type != BLACK_LEVEL_MASK_DATA)
+    {
+        delete imgPtr;
+        return;
+    }
+
+    if (mPreparedImages[type])
+        delete mPreparedImages[type];
+    mPreparedImages[type] = imgPtr;
+    mDataPrepared[type] = true;
+    mMpcdiMasks[type] = true;
+
+    if (type == BLEND_MASK_DATA)
+        mBlendMaskFilename.assign(name);
+    else
+        mBlackLevelMaskFilename.assign(name);
 }
 
 void sgct_core::Viewport::setTracked(bool state)
@@ -638,28 +709,282 @@ void sgct_core::Viewport::setTracked(bool state)
     mTracked = state;
 }
 
+/*!
+Replace the warp mesh with a lookup texture baked when the mesh is loaded. Warping is then one texture fetch per
+pixel, which is cheaper for very dense meshes. Only used with the programmable pipeline and mono or active stereo.
+*/
+void sgct_core::Viewport::setUseWarpLookup(bool state)
+{
+    mUseWarpLookup = state;
+}
+
+/*!
+Narrow the view plane of SCISS and SkySkan meshes to the part of the image the mesh samples and stretch the
+texture coordinates to match. Fewer pixels are rendered that are never shown, at the same resolution.
+*/
+void sgct_core::Viewport::setFitFrustumToMesh(bool state)
+{
+    mFitFrustumToMesh = state;
+}
+
+/*!
+Recalculate the frustums of this viewport only, tracked viewports are updated every frame instead.
+*/
+void sgct_core::Viewport::updateFrustums(float nearClippingPlane, float farClippingPlane)
+{
+    if (mTracked)
+        return;
+
+    if (hasSubViewports())
+    {
+        mNonLinearProjection->updateFrustums(Frustum::MonoEye, nearClippingPlane, farClippingPlane);
+        mNonLinearProjection->updateFrustums(Frustum::StereoLeftEye, nearClippingPlane, farClippingPlane);
+        mNonLinearProjection->updateFrustums(Frustum::StereoRightEye, nearClippingPlane, farClippingPlane);
+    }
+    else
+    {
+        calculateFrustum(Frustum::MonoEye, nearClippingPlane, farClippingPlane);
+        calculateFrustum(Frustum::StereoLeftEye, nearClippingPlane, farClippingPlane);
+        calculateFrustum(Frustum::StereoRightEye, nearClippingPlane, farClippingPlane);
+    }
+}
+
+/*!
+\returns true if loadData has work to do for the data type, the correction mesh is always generated
+*/
+bool sgct_core::Viewport::hasData(DataType type)
+{
+    return type == CORRECTION_MESH_DATA || !getDataPath(type).empty();
+}
+
+/*!
+\returns the file loaded for the data type, empty if there is none
+*/
+std::string sgct_core::Viewport::getDataPath(DataType type)
+{
+    switch (type)
+    {
+    case OVERLAY_DATA:
+        return mOverlayFilename;
+    case BLEND_MASK_DATA:
+        return mBlendMaskFilename;
+    case BLACK_LEVEL_MASK_DATA:
+        return mBlackLevelMaskFilename;
+    case CORRECTION_MESH_DATA:
+        return hasMpcdiWarpGrid() ? std::string("mesh.mpcdi") : mMeshFilename;
+    default:
+        return std::string();
+    }
+}
+
+/*!
+Decode a texture or parse the correction mesh without using OpenGL. Different data types and viewports can
+be prepared in parallel, loadData then only uploads the result.
+
+\param type the data to prepare
+\param windowAspectRatio the aspect ratio of the window of this viewport
+\param framebufferResolution the framebuffer size of the window of this viewport
+\returns true if the data was loaded
+*/
+bool sgct_core::Viewport::prepareData(DataType type, float windowAspectRatio, const glm::ivec2 & framebufferResolution)
+{
+    if (type == CORRECTION_MESH_DATA)
+    {
+        if (hasMpcdiWarpGrid())
+            mPreparedMeshStatus = mCM.parseMesh("mesh.mpcdi", this, CorrectionMesh::parseHint("mpcdi"), windowAspectRatio, framebufferResolution);
+        else //the default mesh is used if mMeshFilename is empty
+            mPreparedMeshStatus = mCM.parseMesh(mMeshFilename, this, CorrectionMesh::parseHint(mMeshHint), windowAspectRatio, framebufferResolution);
+
+        mDataPrepared[type] = true;
+        return mPreparedMeshStatus;
+    }
+
+    //masks from an .mpcdi package are decoded when the configuration is read
+    if (mDataPrepared[type] && mPreparedImages[type])
+        return true;
+
+    if (mPreparedImages[type])
+    {
+        delete mPreparedImages[type];
+        mPreparedImages[type] = nullptr;
+    }
+
+    Image * imgPtr = new Image();
+    if (!imgPtr->load(getDataPath(type)) || imgPtr->getData() == nullptr)
+    {
+        delete imgPtr;
+        imgPtr = nullptr;
+    }
+
+    mPreparedImages[type] = imgPtr;
+    mDataPrepared[type] = true;
+    return imgPtr != nullptr;
+}
+
+/*!
+Upload overlay and mask textures and the correction mesh. Data that wasn't prepared by prepareData is loaded here.
+*/
 void sgct_core::Viewport::loadData()
 {
+    typedef std::chrono::high_resolution_clock Clock;
     sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "Viewport: loading GPU data for '%s'\n", mName.c_str());
-        
-    if( !mOverlayFilename.empty() )
-        sgct::TextureManager::instance()->loadUnManagedTexture(mOverlayTextureIndex, mOverlayFilename, true, 1);
 
-    if ( !mBlendMaskFilename.empty() )
-        sgct::TextureManager::instance()->loadUnManagedTexture(mBlendMaskTextureIndex, mBlendMaskFilename, true, 1);
+    unsigned int * textureIndices[] = { &mOverlayTextureIndex, &mBlendMaskTextureIndex, &mBlackLevelMaskTextureIndex };
+    for (std::size_t i = 0; i < CORRECTION_MESH_DATA; i++)
+    {
+        Clock::time_point t0 = Clock::now();
+        DataType type = static_cast<DataType>(i);
+
+        if (mDataPrepared[i])
+        {
+            //a texture that failed to decode isn't retried
+            if (mPreparedImages[i])
+            {
+                sgct::TextureManager::instance()->loadUnManagedTexture(*textureIndices[i], mPreparedImages[i], true, 1);
+                delete mPreparedImages[i];
+                mPreparedImages[i] = nullptr;
+            }
+            mDataPrepared[i] = false;
+        }
+        else if (hasData(type))
+            sgct::TextureManager::instance()->loadUnManagedTexture(*textureIndices[i], getDataPath(type), true, 1);
 
-    if ( !mBlackLevelMaskFilename.empty())
-        sgct::TextureManager::instance()->loadUnManagedTexture(mBlackLevelMaskTextureIndex, mBlackLevelMaskFilename, true, 1);
+        mDataUploadTimes[i] = std::chrono::duration<double>(Clock::now() - t0).count();
+        getDataStamp(type, mDataStamps[i]);
+    }
 
-    if ( mMpcdiWarpMeshData != nullptr )
+    //the mask mesh depends on the mask textures being loaded
+    Clock::time_point t0 = Clock::now();
+    if (!mDataPrepared[CORRECTION_MESH_DATA])
     {
-        mCorrectionMesh = mCM.readAndGenerateMesh("mesh.mpcdi", this, CorrectionMesh::parseHint("mpcdi"));
+        sgct::SGCTWindow * winPtr = sgct::Engine::instance()->getCurrentWindowPtr();
+        prepareData(CORRECTION_MESH_DATA, winPtr->getAspectRatio(),
+            glm::ivec2(winPtr->getXFramebufferResolution(), winPtr->getYFramebufferResolution()));
     }
-    else
+    mCorrectionMesh = mPreparedMeshStatus;
+    mCM.uploadMesh(this);
+    mDataPrepared[CORRECTION_MESH_DATA] = false;
+    mDataUploadTimes[CORRECTION_MESH_DATA] = std::chrono::duration<double>(Clock::now() - t0).count();
+    getDataStamp(CORRECTION_MESH_DATA, mDataStamps[CORRECTION_MESH_DATA]);
+}
+
+/*!
+Get the modification time and size of the file of a data type. Data from .mpcdi packages and the default mesh
+have no file of their own and can't be reloaded.
+\returns false if there is no such file
+*/
+bool sgct_core::Viewport::getDataStamp(DataType type, unsigned long long stamp[2])
+{
+    if (isMpcdiData(type))
+        return false;
+
+    std::string path = getDataPath(type);
+    return !path.empty() && sgct_helpers::getFileInfo(path, stamp[0], stamp[1]);
+}
+
+/*!
+\returns true if the file of the data type has changed since it was loaded
+*/
+bool sgct_core::Viewport::isDataChanged(DataType type)
+{
+    unsigned long long stamp[2];
+    if (!getDataStamp(type, stamp))
+        return false;
+
+    return stamp[0] != mDataStamps[type][0] || stamp[1] != mDataStamps[type][1];
+}
+
+/*!
+Reload the file of a data type without touching the data that is rendered, so it can be called from a background
+thread while the viewport is in use. Only masks and overlays that were loaded at startup are reloaded. The result
+is swapped in by applyReload.
+
+\param type the data to reload
+\param windowAspectRatio the aspect ratio of the window of this viewport
+\param framebufferResolution the framebuffer size of the window of this viewport
+\returns true if the data was reloaded
+*/
+bool sgct_core::Viewport::prepareReload(DataType type, float windowAspectRatio, const glm::ivec2 & framebufferResolution)
+{
+    //stamp before reading, a file that changes while it is read is reloaded again
+    if (!getDataStamp(type, mReloadStamps[type]))
+        return false;
+
+    if (type == CORRECTION_MESH_DATA)
+    {
+        if (mReloadMeshPtr)
+            delete mReloadMeshPtr;
+        mReloadMeshPtr = new CorrectionMesh();
+        if (!mReloadMeshPtr->parseMesh(mMeshFilename, this, CorrectionMesh::parseHint(mMeshHint), windowAspectRatio, framebufferResolution))
+        {
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING,
+                "Viewport: Failed to reload '%s', keeping the previous version.\n", mMeshFilename.c_str());
+            delete mReloadMeshPtr;
+            mReloadMeshPtr = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    const unsigned int textureIndices[] = { mOverlayTextureIndex, mBlendMaskTextureIndex, mBlackLevelMaskTextureIndex };
+    if (textureIndices[type] == GL_FALSE)
+        return false;
+
+    if (mReloadImages[type])
     {
-        //load default if mMeshFilename is empty
-        mCorrectionMesh = mCM.readAndGenerateMesh(mMeshFilename, this, CorrectionMesh::parseHint(mMeshHint));
+        delete mReloadImages[type];
+        mReloadImages[type] = nullptr;
+    }
+
+    Image * imgPtr = new Image();
+    if (!imgPtr->load(getDataPath(type)) || imgPtr->getData() == nullptr)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING,
+            "Viewport: Failed to reload '%s', keeping the previous version.\n", getDataPath(type).c_str());
+        delete imgPtr;
+        return false;
     }
+
+    mReloadImages[type] = imgPtr;
+    return true;
+}
+
+/*!
+Upload the data reloaded by prepareReload and release the data it replaces. Must be called with the context of
+the window current, between frames.
+\returns true if anything was replaced
+*/
+bool sgct_core::Viewport::applyReload()
+{
+    bool applied = false;
+
+    unsigned int * textureIndices[] = { &mOverlayTextureIndex, &mBlendMaskTextureIndex, &mBlackLevelMaskTextureIndex };
+    for (std::size_t i = 0; i < CORRECTION_MESH_DATA; i++)
+    {
+        if (mReloadImages[i])
+        {
+            sgct::TextureManager::instance()->loadUnManagedTexture(*textureIndices[i], mReloadImages[i], true, 1);
+            delete mReloadImages[i];
+            mReloadImages[i] = nullptr;
+            mDataStamps[i][0] = mReloadStamps[i][0];
+            mDataStamps[i][1] = mReloadStamps[i][1];
+            applied = true;
+        }
+    }
+
+    if (mReloadMeshPtr)
+    {
+        mReloadMeshPtr->uploadMesh(this);
+        mCM.swap(*mReloadMeshPtr);
+        delete mReloadMeshPtr; //releases the previous mesh
+        mReloadMeshPtr = nullptr;
+        mCorrectionMesh = true;
+        mDataStamps[CORRECTION_MESH_DATA][0] = mReloadStamps[CORRECTION_MESH_DATA][0];
+        mDataStamps[CORRECTION_MESH_DATA][1] = mReloadStamps[CORRECTION_MESH_DATA][1];
+        applied = true;
+    }
+
+    return applied;
 }
 
 /*!
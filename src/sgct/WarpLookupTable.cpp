@@ -0,0 +1,359 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/WarpLookupTable.h>
+#include <sgct/CorrectionMesh.h>
+#include <sgct/CorrectionMeshCache.h>
+#include <sgct/MappedFile.h>
+#include <sgct/MessageHandler.h>
+#include <sgct/Engine.h>
+#include <sgct/helpers/SGCTFileFunctions.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <functional>
+
+#define LOOKUP_CACHE_MAGIC "SGCTLUT1"
+#define LOOKUP_CACHE_MAGIC_LENGTH 8
+#define LOOKUP_CACHE_VERSION 1
+#define LOOKUP_CACHE_BYTE_ORDER 0x01020304
+#define LOOKUP_MIN_ROWS_PER_THREAD 16
+
+namespace
+{
+    //stored as is, the texels follow directly after the header
+    struct LookupCacheHeader
+    {
+        char mMagic[LOOKUP_CACHE_MAGIC_LENGTH];
+        uint32_t mVersion;
+        uint32_t mByteOrder;
+        int32_t mWidth;
+        int32_t mHeight;
+        uint64_t mCoveredTexels;
+        uint64_t mSourceSize;
+        uint64_t mSourceTime;
+        uint64_t mSourceHash;
+        uint64_t mParameterHash;
+    };
+
+    //vertex colors that differ more than this between channels can't be stored as an intensity
+    const float MaxColorDifference = 1.0f / 512.0f;
+
+    bool hashFile(const std::string & path, unsigned long long & hash)
+    {
+        sgct_core::MappedFile file;
+        if (!file.open(path))
+            return false;
+
+        hash = sgct_helpers::hashFNV1a(file.getData(), file.getSize());
+        return true;
+    }
+}
+
+sgct_core::WarpLookupTable::WarpLookupTable()
+{
+    mWidth = 0;
+    mHeight = 0;
+    mCoveredTexels = 0;
+}
+
+/*!
+    Rasterize a warping mesh into the table.
+
+    \param vertices the mesh with positions in normalized device coordinates of the window
+    \param numberOfVertices the number of vertices
+    \param indices the triangles of the mesh
+    \param numberOfIndices the number of indices
+    \param triangleStrip true if the indices form a triangle strip, otherwise they are a triangle list
+    \param area the part of the window covered by the table (x, y, width, height) in the range [0, 1]
+    \param width the number of texels in a row
+    \param height the number of rows
+    \param numberOfThreads number of worker threads, 0 uses all hardware threads
+    \returns false if the mesh can't be baked
+*/
+bool sgct_core::WarpLookupTable::bake(const CorrectionMeshVertex * vertices, unsigned int numberOfVertices, const unsigned int * indices,
+    unsigned int numberOfIndices, bool triangleStrip, const glm::vec4 & area, int width, int height, std::size_t numberOfThreads)
+{
+    clear();
+
+    if (vertices == nullptr || indices == nullptr || numberOfIndices < 3 || width <= 0 || height <= 0 || area.z <= 0.0f || area.w <= 0.0f)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "WarpLookupTable: Invalid mesh or table size!\n");
+        return false;
+    }
+
+    for (unsigned int i = 0; i < numberOfIndices; i++)
+        if (indices[i] >= numberOfVertices)
+        {
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_ERROR, "WarpLookupTable: Index %u is out of range!\n", indices[i]);
+            return false;
+        }
+
+    for (unsigned int i = 0; i < numberOfVertices; i++)
+    {
+        const CorrectionMeshVertex & v = vertices[i];
+        if (fabsf(v.r - v.g) > MaxColorDifference || fabsf(v.r - v.b) > MaxColorDifference)
+        {
+            sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING,
+                "WarpLookupTable: The mesh has colored vertices which can't be stored as an intensity.\n");
+            return false;
+        }
+    }
+
+    mData.assign(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4, 0.0f);
+    mWidth = width;
+    mHeight = height;
+
+    unsigned int numberOfTriangles = triangleStrip ? numberOfIndices - 2 : numberOfIndices / 3;
+
+    std::size_t rows = static_cast<std::size_t>(height);
+    if (numberOfThreads == 0)
+        numberOfThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    numberOfThreads = std::max<std::size_t>(std::min(numberOfThreads, rows / LOOKUP_MIN_ROWS_PER_THREAD), 1);
+
+    //each thread writes its own rows, a triangle spanning several bands is clipped by each of them
+    std::vector<std::size_t> coveredTexels(numberOfThreads, 0);
+    if (numberOfThreads == 1)
+        bakeRows(vertices, indices, numberOfTriangles, triangleStrip, area, 0, height, &coveredTexels[0]);
+    else
+    {
+        std::vector<std::thread> threads;
+        std::size_t rowsPerThread = (rows + numberOfThreads - 1) / numberOfThreads;
+        for (std::size_t first = 0, i = 0; first < rows; first += rowsPerThread, i++)
+            threads.push_back(std::thread(&WarpLookupTable::bakeRows, this, vertices, indices, numberOfTriangles, triangleStrip, area,
+                static_cast<int>(first), static_cast<int>(std::min(first + rowsPerThread, rows)), &coveredTexels[i]));
+
+        for (std::size_t i = 0; i < threads.size(); i++)
+            threads[i].join();
+    }
+
+    for (std::size_t i = 0; i < coveredTexels.size(); i++)
+        mCoveredTexels += coveredTexels[i];
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG,
+        "WarpLookupTable: Baked %u triangles into %dx%d texels (%.1f%% covered) using %u thread(s).\n", numberOfTriangles, width, height,
+        100.0 * static_cast<double>(mCoveredTexels) / static_cast<double>(rows * static_cast<std::size_t>(width)),
+        static_cast<unsigned int>(numberOfThreads));
+
+    return true;
+}
+
+void sgct_core::WarpLookupTable::bakeRows(const CorrectionMeshVertex * vertices, const unsigned int * indices, unsigned int numberOfTriangles,
+    bool triangleStrip, const glm::vec4 & area, int firstRow, int lastRow, std::size_t * coveredTexels)
+{
+    //normalized device coordinates to texels
+    double scaleX = 0.5 * static_cast<double>(mWidth) / static_cast<double>(area.z);
+    double offsetX = (0.5 - static_cast<double>(area.x)) * static_cast<double>(mWidth) / static_cast<double>(area.z);
+    double scaleY = 0.5 * static_cast<double>(mHeight) / static_cast<double>(area.w);
+    double offsetY = (0.5 - static_cast<double>(area.y)) * static_cast<double>(mHeight) / static_cast<double>(area.w);
+
+    std::vector<unsigned char> coverage(static_cast<std::size_t>(lastRow - firstRow) * static_cast<std::size_t>(mWidth), 0);
+    for (unsigned int tri = 0; tri < numberOfTriangles; tri++)
+    {
+        const unsigned int * triIndices = triangleStrip ? indices + tri : indices + tri * 3;
+        const CorrectionMeshVertex * v[3] = { &vertices[triIndices[0]], &vertices[triIndices[1]], &vertices[triIndices[2]] };
+
+        double px[3], py[3];
+        for (int i = 0; i < 3; i++)
+        {
+            px[i] = static_cast<double>(v[i]->x) * scaleX + offsetX;
+            py[i] = static_cast<double>(v[i]->y) * scaleY + offsetY;
+        }
+
+        //texel centers are at half coordinates, clamped before converting so that far away vertices can't overflow
+        double minY = std::max(static_cast<double>(firstRow), ceil(std::min(py[0], std::min(py[1], py[2])) - 0.5));
+        double maxY = std::min(static_cast<double>(lastRow - 1), floor(std::max(py[0], std::max(py[1], py[2])) - 0.5));
+        double minX = std::max(0.0, ceil(std::min(px[0], std::min(px[1], px[2])) - 0.5));
+        double maxX = std::min(static_cast<double>(mWidth - 1), floor(std::max(px[0], std::max(px[1], px[2])) - 0.5));
+        if (!(minY <= maxY && minX <= maxX))
+            continue;
+
+        //the winding varies between formats and along strips
+        double triangleArea = (px[1] - px[0]) * (py[2] - py[0]) - (py[1] - py[0]) * (px[2] - px[0]);
+        if (triangleArea == 0.0 || triangleArea != triangleArea)
+            continue;
+        double invArea = 1.0 / triangleArea;
+
+        for (int y = static_cast<int>(minY); y <= static_cast<int>(maxY); y++)
+        {
+            double cy = static_cast<double>(y) + 0.5;
+            float * row = &mData[static_cast<std::size_t>(y) * static_cast<std::size_t>(mWidth) * 4];
+
+            for (int x = static_cast<int>(minX); x <= static_cast<int>(maxX); x++)
+            {
+                double cx = static_cast<double>(x) + 0.5;
+                double w0 = ((px[2] - px[1]) * (cy - py[1]) - (py[2] - py[1]) * (cx - px[1])) * invArea;
+                double w1 = ((px[0] - px[2]) * (cy - py[2]) - (py[0] - py[2]) * (cx - px[2])) * invArea;
+                double w2 = 1.0 - w0 - w1;
+                if (w0 < 0.0 || w1 < 0.0 || w2 < 0.0)
+                    continue;
+
+                //a texel on an edge shared by two triangles gets the same value from both
+                float * texel = row + static_cast<std::size_t>(x) * 4;
+                coverage[static_cast<std::size_t>(y - firstRow) * static_cast<std::size_t>(mWidth) + static_cast<std::size_t>(x)] = 1;
+
+                texel[0] = static_cast<float>(w0 * v[0]->s + w1 * v[1]->s + w2 * v[2]->s);
+                texel[1] = static_cast<float>(w0 * v[0]->t + w1 * v[1]->t + w2 * v[2]->t);
+                texel[2] = static_cast<float>(w0 * (v[0]->r + v[0]->g + v[0]->b) + w1 * (v[1]->r + v[1]->g + v[1]->b) +
+                    w2 * (v[2]->r + v[2]->g + v[2]->b)) / 3.0f;
+                texel[3] = static_cast<float>(w0 * v[0]->a + w1 * v[1]->a + w2 * v[2]->a);
+            }
+        }
+    }
+
+    *coveredTexels = static_cast<std::size_t>(std::count(coverage.begin(), coverage.end(), static_cast<unsigned char>(1)));
+}
+
+/*!
+    Release the texels.
+*/
+void sgct_core::WarpLookupTable::clear()
+{
+    std::vector<float>().swap(mData);
+    mWidth = 0;
+    mHeight = 0;
+    mCoveredTexels = 0;
+}
+
+/*!
+    Exchange the contents with another table.
+*/
+void sgct_core::WarpLookupTable::swap(WarpLookupTable & other)
+{
+    mData.swap(other.mData);
+    std::swap(mWidth, other.mWidth);
+    std::swap(mHeight, other.mHeight);
+    std::swap(mCoveredTexels, other.mCoveredTexels);
+}
+
+/*!
+    Get the filename of a stored table for a source mesh.
+
+    \param cacheDirectory the cache directory, if empty the table is placed next to the source
+    \param source the path to the source mesh
+    \param parameterHash hash of the parameters the table is baked with
+*/
+std::string sgct_core::WarpLookupTable::getCacheFilename(const std::string & cacheDirectory, const std::string & source, unsigned long long parameterHash)
+{
+    //same location and naming as the compiled mesh
+    std::string filename = CorrectionMeshCache::getCacheFilename(cacheDirectory, source, parameterHash);
+    std::size_t found = filename.find_last_of(".");
+    return filename.substr(0, found).append(".sgctlut");
+}
+
+/*!
+    Read a stored table.
+    \returns false if there is no valid table for the current version of the source and parameters
+*/
+bool sgct_core::WarpLookupTable::load(const std::string & filename, const std::string & source, unsigned long long parameterHash)
+{
+    clear();
+
+    MappedFile file;
+    unsigned long long mtime, size;
+    if (!sgct_helpers::getFileInfo(source, mtime, size) || !file.open(filename) || file.getSize() < sizeof(LookupCacheHeader))
+        return false;
+
+    LookupCacheHeader header;
+    memcpy(&header, file.getData(), sizeof(LookupCacheHeader));
+
+    if (memcmp(header.mMagic, LOOKUP_CACHE_MAGIC, LOOKUP_CACHE_MAGIC_LENGTH) != 0 ||
+        header.mVersion != LOOKUP_CACHE_VERSION ||
+        header.mByteOrder != LOOKUP_CACHE_BYTE_ORDER ||
+        header.mParameterHash != parameterHash ||
+        header.mSourceSize != size ||
+        header.mWidth <= 0 || header.mHeight <= 0)
+        return false;
+
+    std::size_t numberOfFloats = static_cast<std::size_t>(header.mWidth) * static_cast<std::size_t>(header.mHeight) * 4;
+    if (file.getSize() < sizeof(LookupCacheHeader) + numberOfFloats * sizeof(float))
+        return false;
+
+    //a source with a new time stamp but the same contents is still valid
+    if (header.mSourceTime != mtime)
+    {
+        unsigned long long hash;
+        if (!hashFile(source, hash) || hash != header.mSourceHash)
+            return false;
+    }
+
+    mData.resize(numberOfFloats);
+    memcpy(mData.data(), file.getData() + sizeof(LookupCacheHeader), numberOfFloats * sizeof(float));
+    mWidth = header.mWidth;
+    mHeight = header.mHeight;
+    mCoveredTexels = static_cast<std::size_t>(header.mCoveredTexels);
+    return true;
+}
+
+/*!
+    Write the table to disk.
+    \returns false if the table couldn't be written
+*/
+bool sgct_core::WarpLookupTable::store(const std::string & filename, const std::string & source, unsigned long long parameterHash) const
+{
+    if (isEmpty())
+        return false;
+
+    LookupCacheHeader header;
+    memset(&header, 0, sizeof(LookupCacheHeader));
+
+    unsigned long long mtime, size, hash;
+    if (!sgct_helpers::getFileInfo(source, mtime, size) || !hashFile(source, hash))
+        return false;
+
+    memcpy(header.mMagic, LOOKUP_CACHE_MAGIC, LOOKUP_CACHE_MAGIC_LENGTH);
+    header.mVersion = LOOKUP_CACHE_VERSION;
+    header.mByteOrder = LOOKUP_CACHE_BYTE_ORDER;
+    header.mWidth = mWidth;
+    header.mHeight = mHeight;
+    header.mCoveredTexels = mCoveredTexels;
+    header.mSourceSize = size;
+    header.mSourceTime = mtime;
+    header.mSourceHash = hash;
+    header.mParameterHash = parameterHash;
+
+    //unique temporary name per process and thread, viewports sharing a mesh may be stored concurrently
+    char suffix[32];
+    unsigned long long id = std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+        static_cast<unsigned long long>(sgct::Engine::getTime() * 1000000.0) ^ static_cast<unsigned long long>(reinterpret_cast<std::size_t>(this));
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    sprintf_s(suffix, sizeof(suffix), ".%016llx.tmp", id);
+#else
+    sprintf(suffix, ".%016llx.tmp", id);
+#endif
+    std::string tmpFilename = filename + suffix;
+    FILE * fp = nullptr;
+#if (_MSC_VER >= 1400) //visual studio 2005 or later
+    if (fopen_s(&fp, tmpFilename.c_str(), "wb") != 0)
+        fp = nullptr;
+#else
+    fp = fopen(tmpFilename.c_str(), "wb");
+#endif
+    if (fp == nullptr)
+    {
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING, "WarpLookupTable: Failed to write '%s'!\n", filename.c_str());
+        return false;
+    }
+
+    bool success = fwrite(&header, sizeof(LookupCacheHeader), 1, fp) == 1;
+    if (success)
+        success = fwrite(mData.data(), sizeof(float), mData.size(), fp) == mData.size();
+    success = (fclose(fp) == 0) && success;
+
+    if (!success || !sgct_helpers::replaceFile(tmpFilename, filename))
+    {
+        remove(tmpFilename.c_str());
+        sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_WARNING, "WarpLookupTable: Failed to write '%s'!\n", filename.c_str());
+        return false;
+    }
+
+    sgct::MessageHandler::instance()->print(sgct::MessageHandler::NOTIFY_DEBUG, "WarpLookupTable: Stored '%s'.\n", filename.c_str());
+    return true;
+}
@@ -0,0 +1,111 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/CorrectionMeshDecimator.h>
+#include <sgct/MeshTextReader.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+/*
+    Usage: sgct_mesherrorreport <original.obj> <decimated.obj> <width> <height>
+
+    Compares the meshes written with exportWarpingMeshes="true" and a MeshDecimation setting: <mesh>_export.obj
+    is the parsed mesh and <mesh>_decimated_export.obj the decimated one. The width and height are the
+    framebuffer size of the window, the texture coordinate error is reported in pixels.
+*/
+
+namespace
+{
+    /*!
+        Reads an exported warping mesh where vertex i has position v i and texture coordinate vt i.
+    */
+    bool readExportedMesh(const char * path, std::vector<sgct_core::CorrectionMeshVertex> & vertices, std::vector<unsigned int> & indices)
+    {
+        sgct_core::MeshTextReader reader;
+        if (!reader.open(path))
+        {
+            fprintf(stderr, "Failed to open '%s'\n", path);
+            return false;
+        }
+
+        std::size_t numberOfCoords = 0;
+        while (reader.nextLine())
+        {
+            float x, y, s, t;
+            unsigned int a, b, c;
+            if (reader.restart() && reader.match("vt") && reader.readFloat(s) && reader.readFloat(t))
+            {
+                if (numberOfCoords < vertices.size())
+                {
+                    vertices[numberOfCoords].s = s;
+                    vertices[numberOfCoords].t = t;
+                }
+                numberOfCoords++;
+            }
+            else if (reader.restart() && reader.match("v ") && reader.readFloat(x) && reader.readFloat(y))
+            {
+                sgct_core::CorrectionMeshVertex vertex = { x, y, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+                vertices.push_back(vertex);
+            }
+            else if (reader.restart() && reader.match("f ") &&
+                reader.readUInt(a) && reader.match("/") && reader.skipInt() && reader.match("/") && reader.skipInt() &&
+                reader.readUInt(b) && reader.match("/") && reader.skipInt() && reader.match("/") && reader.skipInt() &&
+                reader.readUInt(c))
+            {
+                if (a == 0 || b == 0 || c == 0 || a > vertices.size() || b > vertices.size() || c > vertices.size())
+                {
+                    fprintf(stderr, "Invalid face in '%s'\n", path);
+                    return false;
+                }
+                indices.push_back(a - 1);
+                indices.push_back(b - 1);
+                indices.push_back(c - 1);
+            }
+        }
+
+        if (numberOfCoords != vertices.size() || indices.empty())
+        {
+            fprintf(stderr, "'%s' is not an exported warping mesh\n", path);
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    if (argc != 5)
+    {
+        fprintf(stderr, "Usage: %s <original.obj> <decimated.obj> <width> <height>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int width = atoi(argv[3]);
+    int height = atoi(argv[4]);
+    std::vector<sgct_core::CorrectionMeshVertex> vertices, decimatedVertices;
+    std::vector<unsigned int> indices, decimatedIndices;
+    if (width <= 0 || height <= 0 ||
+        !readExportedMesh(argv[1], vertices, indices) ||
+        !readExportedMesh(argv[2], decimatedVertices, decimatedIndices))
+        return EXIT_FAILURE;
+
+    sgct_core::CorrectionMeshDecimator::ErrorReport report = sgct_core::CorrectionMeshDecimator::measureError(
+        vertices.data(), static_cast<unsigned int>(vertices.size()), indices.data(), static_cast<unsigned int>(indices.size()),
+        decimatedVertices.data(), static_cast<unsigned int>(decimatedVertices.size()),
+        decimatedIndices.data(), static_cast<unsigned int>(decimatedIndices.size()), width, height);
+
+    printf("Vertices:  %zu -> %zu (%.1f%%)\n", vertices.size(), decimatedVertices.size(),
+        100.0 * static_cast<double>(decimatedVertices.size()) / static_cast<double>(vertices.size()));
+    printf("Triangles: %zu -> %zu (%.1f%%)\n", indices.size() / 3, decimatedIndices.size() / 3,
+        100.0 * static_cast<double>(decimatedIndices.size()) / static_cast<double>(indices.size()));
+    printf("Samples:   %zu (%zu outside the decimated mesh)\n", report.mSamples, report.mUncoveredSamples);
+    printf("Texture coordinate error at %dx%d: max %.4f px, mean %.4f px, p99 %.4f px\n",
+        width, height, report.mMaxError, report.mMeanError, report.mP99Error);
+
+    return report.mUncoveredSamples == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
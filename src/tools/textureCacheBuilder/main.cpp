@@ -0,0 +1,57 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/CompressedTextureCache.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+/*
+    Usage: sgct_texturecachebuilder <cache directory> [--mipmap-levels <levels>] <image> [<image> ...]
+
+    The image paths and mipmap levels must match the ones passed to sgct::TextureManager::loadTexture
+    for the cache entries to be found.
+*/
+int main(int argc, char * argv[])
+{
+    const char * cacheDirectory = nullptr;
+    int mipmapLevels = 8;
+    std::vector<const char *> images;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--mipmap-levels") == 0 && i + 1 < argc)
+            mipmapLevels = atoi(argv[++i]);
+        else if (cacheDirectory == nullptr)
+            cacheDirectory = argv[i];
+        else
+            images.push_back(argv[i]);
+    }
+
+    if (cacheDirectory == nullptr || images.empty())
+    {
+        fprintf(stderr, "Usage: %s <cache directory> [--mipmap-levels <levels>] <image> [<image> ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int failed = 0;
+    for (std::size_t i = 0; i < images.size(); i++)
+    {
+        sgct_core::CompressedTexture texture;
+        if (!sgct_core::CompressedTextureCache::load(cacheDirectory, images[i], mipmapLevels, texture) &&
+            !sgct_core::CompressedTextureCache::build(cacheDirectory, images[i], mipmapLevels, texture))
+        {
+            fprintf(stderr, "Failed to compress '%s'\n", images[i]);
+            failed++;
+        }
+        else
+            printf("%s -> %s\n", images[i], sgct_core::CompressedTextureCache::getCacheFilename(cacheDirectory, images[i], mipmapLevels).c_str());
+    }
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
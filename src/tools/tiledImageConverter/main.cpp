@@ -0,0 +1,60 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/Image.h>
+#include <sgct/TiledImage.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+    Usage: sgct_tiledimageconverter <input image> <output file> [--tile-size <pixels>] [--no-compression]
+*/
+int main(int argc, char * argv[])
+{
+    const char * input = nullptr;
+    const char * output = nullptr;
+    std::size_t tileSize = 256;
+    bool compress = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--tile-size") == 0 && i + 1 < argc)
+            tileSize = static_cast<std::size_t>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--no-compression") == 0)
+            compress = false;
+        else if (input == nullptr)
+            input = argv[i];
+        else if (output == nullptr)
+            output = argv[i];
+    }
+
+    if (input == nullptr || output == nullptr)
+    {
+        fprintf(stderr, "Usage: %s <input image> <output file> [--tile-size <pixels>] [--no-compression]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    sgct_core::Image img;
+    if (!img.load(input))
+        return EXIT_FAILURE;
+
+    if (!sgct_core::TiledImage::convert(img, output, tileSize, compress))
+        return EXIT_FAILURE;
+
+    //verify that the result can be opened
+    sgct_core::TiledImage tiledImage;
+    if (!tiledImage.open(output))
+        return EXIT_FAILURE;
+
+    printf("%s: %dx%d, %d channels, %d-bit, %d levels, tile size %d\n", output,
+        static_cast<int>(tiledImage.getWidth()), static_cast<int>(tiledImage.getHeight()),
+        static_cast<int>(tiledImage.getChannels()), static_cast<int>(tiledImage.getBytesPerChannel() * 8),
+        static_cast<int>(tiledImage.getNumberOfLevels()), static_cast<int>(tiledImage.getTileSize()));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,200 @@
+/*************************************************************************
+Copyright (c) 2012-2015 Miroslav Andel
+All rights reserved.
+
+For conditions of distribution and use, see copyright notice in sgct.h
+*************************************************************************/
+
+#include <sgct/WarpLookupTable.h>
+#include <sgct/CorrectionMesh.h>
+#include <sgct/MeshTextReader.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+/*
+    Usage: sgct_warplookupbaker <mesh_export.obj> <width> <height> [-viewport x y xSize ySize] [-threads n] [-o output.pfm]
+
+    Bakes a warping mesh written with exportWarpingMeshes="true" into a warp lookup table the same way as a
+    viewport with warpLookup="true", for a window with a framebuffer of width x height pixels. The table is
+    checked against the mesh and a single threaded bake, and can be written as a PFM image with the texture
+    coordinates in red and green and the intensity times alpha in blue.
+*/
+
+namespace
+{
+    /*!
+        Reads an exported warping mesh where vertex i has position v i and texture coordinate vt i.
+    */
+    bool readExportedMesh(const char * path, std::vector<sgct_core::CorrectionMeshVertex> & vertices, std::vector<unsigned int> & indices)
+    {
+        sgct_core::MeshTextReader reader;
+        if (!reader.open(path))
+        {
+            fprintf(stderr, "Failed to open '%s'\n", path);
+            return false;
+        }
+
+        std::size_t numberOfCoords = 0;
+        while (reader.nextLine())
+        {
+            float x, y, s, t;
+            unsigned int a, b, c;
+            if (reader.restart() && reader.match("vt") && reader.readFloat(s) && reader.readFloat(t))
+            {
+                if (numberOfCoords < vertices.size())
+                {
+                    vertices[numberOfCoords].s = s;
+                    vertices[numberOfCoords].t = t;
+                }
+                numberOfCoords++;
+            }
+            else if (reader.restart() && reader.match("v ") && reader.readFloat(x) && reader.readFloat(y))
+            {
+                sgct_core::CorrectionMeshVertex vertex = { x, y, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+                vertices.push_back(vertex);
+            }
+            else if (reader.restart() && reader.match("f ") &&
+                reader.readUInt(a) && reader.match("/") && reader.skipInt() && reader.match("/") && reader.skipInt() &&
+                reader.readUInt(b) && reader.match("/") && reader.skipInt() && reader.match("/") && reader.skipInt() &&
+                reader.readUInt(c))
+            {
+                if (a == 0 || b == 0 || c == 0 || a > vertices.size() || b > vertices.size() || c > vertices.size())
+                {
+                    fprintf(stderr, "Invalid face in '%s'\n", path);
+                    return false;
+                }
+                indices.push_back(a - 1);
+                indices.push_back(b - 1);
+                indices.push_back(c - 1);
+            }
+        }
+
+        if (numberOfCoords != vertices.size() || indices.empty())
+        {
+            fprintf(stderr, "'%s' is not an exported warping mesh\n", path);
+            return false;
+        }
+        return true;
+    }
+
+    bool writePFM(const char * path, const sgct_core::WarpLookupTable & table)
+    {
+        FILE * fp = fopen(path, "wb");
+        if (fp == NULL)
+        {
+            fprintf(stderr, "Failed to write '%s'\n", path);
+            return false;
+        }
+
+        //little endian, rows from the bottom like the table
+        fprintf(fp, "PF\n%d %d\n-1.0\n", table.getWidth(), table.getHeight());
+        std::vector<float> row(static_cast<std::size_t>(table.getWidth()) * 3);
+        bool success = true;
+        for (int y = 0; y < table.getHeight() && success; y++)
+        {
+            const float * texels = table.getData() + static_cast<std::size_t>(y) * table.getWidth() * 4;
+            for (int x = 0; x < table.getWidth(); x++)
+            {
+                row[x * 3] = texels[x * 4];
+                row[x * 3 + 1] = texels[x * 4 + 1];
+                row[x * 3 + 2] = texels[x * 4 + 2] * texels[x * 4 + 3];
+            }
+            success = fwrite(row.data(), sizeof(float), row.size(), fp) == row.size();
+        }
+
+        return (fclose(fp) == 0) && success;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    if (argc < 4)
+    {
+        fprintf(stderr, "Usage: %s <mesh_export.obj> <width> <height> [-viewport x y xSize ySize] [-threads n] [-o output.pfm]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int windowWidth = atoi(argv[2]);
+    int windowHeight = atoi(argv[3]);
+    float viewport[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+    std::size_t numberOfThreads = 0;
+    const char * outputPath = NULL;
+
+    for (int i = 4; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-viewport") == 0 && i + 4 < argc)
+        {
+            for (int j = 0; j < 4; j++)
+                viewport[j] = static_cast<float>(atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+            numberOfThreads = static_cast<std::size_t>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            outputPath = argv[++i];
+        else
+        {
+            fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    //the same size as a viewport bakes its table with
+    int width = static_cast<int>(floorf(viewport[2] * static_cast<float>(windowWidth) + 0.5f));
+    int height = static_cast<int>(floorf(viewport[3] * static_cast<float>(windowHeight) + 0.5f));
+    std::vector<sgct_core::CorrectionMeshVertex> vertices;
+    std::vector<unsigned int> indices;
+    if (width <= 0 || height <= 0 || !readExportedMesh(argv[1], vertices, indices))
+        return EXIT_FAILURE;
+
+    glm::vec4 area(viewport[0], viewport[1], viewport[2], viewport[3]);
+    sgct_core::WarpLookupTable table, reference;
+    if (!table.bake(vertices.data(), static_cast<unsigned int>(vertices.size()), indices.data(), static_cast<unsigned int>(indices.size()),
+            false, area, width, height, numberOfThreads) ||
+        !reference.bake(vertices.data(), static_cast<unsigned int>(vertices.size()), indices.data(), static_cast<unsigned int>(indices.size()),
+            false, area, width, height, 1))
+        return EXIT_FAILURE;
+
+    bool identical = memcmp(table.getData(), reference.getData(), static_cast<std::size_t>(width) * height * 4 * sizeof(float)) == 0;
+
+    //the texel closest to a vertex differs from the vertex by the texture coordinate gradient over half a texel at most
+    double maxError = 0.0;
+    std::size_t checkedVertices = 0;
+    std::size_t uncoveredVertices = 0;
+    for (std::size_t i = 0; i < vertices.size(); i++)
+    {
+        double px = ((vertices[i].x + 1.0) * 0.5 - area.x) / area.z * width;
+        double py = ((vertices[i].y + 1.0) * 0.5 - area.y) / area.w * height;
+        int x = static_cast<int>(floor(px));
+        int y = static_cast<int>(floor(py));
+        if (x < 0 || y < 0 || x >= width || y >= height)
+            continue;
+
+        const float * texel = table.getData() + (static_cast<std::size_t>(y) * width + x) * 4;
+        checkedVertices++;
+        if (texel[3] == 0.0f)
+        {
+            //vertices on the border of the mesh may lie outside the texel centers it covers
+            uncoveredVertices++;
+            continue;
+        }
+
+        double ds = (texel[0] - vertices[i].s) * windowWidth;
+        double dt = (texel[1] - vertices[i].t) * windowHeight;
+        maxError = std::max(maxError, sqrt(ds * ds + dt * dt));
+    }
+
+    printf("Table:     %dx%d texels, %.1f%% covered\n", width, height,
+        100.0 * static_cast<double>(table.getNumberOfCoveredTexels()) / (static_cast<double>(width) * height));
+    printf("Vertices:  %zu checked (%zu at uncovered texels)\n", checkedVertices, uncoveredVertices);
+    printf("Texture coordinate difference at the vertices: max %.4f px\n", maxError);
+    printf("Threaded bake %s the single threaded bake\n", identical ? "matches" : "DIFFERS FROM");
+
+    if (outputPath != NULL && !writePFM(outputPath, table))
+        return EXIT_FAILURE;
+
+    return identical ? EXIT_SUCCESS : EXIT_FAILURE;
+}